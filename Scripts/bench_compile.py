@@ -0,0 +1,395 @@
+import os
+import sys
+import hashlib
+import json
+import platform
+import subprocess
+import time
+
+#
+# Measures what the generated headers cost the code which includes them.
+#
+# Every PDB is dumped in each emission mode (full '*' dump and -j closures
+# of the --symbol types, combined with -e n/i/a, -m- and -p-), then every
+# header is compiled by each compiler with -fsyntax-only. For every pair
+# the fastest compile time, the peak memory of the compiler and the size
+# of the preprocessed translation unit are recorded.
+#
+# Modes are ranked by the extra compile time over the default mode
+# of the same target, results are written as JSON (sorted keys,
+# no timestamps), so two runs over the same inputs can be diffed.
+#
+
+PDBEX_CMD_TEMPLATE = '..\\Bin\\x86\\Release\\pdbex.exe "%(symbol)s" "%(file_pdb)s" -o "%(file_h)s" %(options)s'
+
+OUTPUT_DIRECTORY = 'BenchCompile'
+
+#
+# Variants of the emission, the first one is the baseline.
+#
+
+VARIANTS = [
+	('default',      ''),
+	('-e n',         '-e n'),
+	('-e a',         '-e a'),
+	('-m-',          '-m-'),
+	('-p-',          '-p-'),
+	('-m- -p-',      '-m- -p-'),
+	]
+
+#
+# Native types of the headers (without -i) are the MSVC ones.
+#
+
+PRELUDE = '''#include <stddef.h>
+#include <stdint.h>
+
+#ifndef _MSC_VER
+#define __int64 long long
+#endif
+
+typedef int BOOL;
+typedef long HRESULT;
+typedef double DATE;
+typedef unsigned short* BSTR;
+typedef struct { unsigned char Data[24]; } VARIANT;
+
+#include "%(file_h)s"
+'''
+
+VERBOSITY_LEVEL = 0 # 0, 1
+
+
+def run_command(command):
+	if VERBOSITY_LEVEL >= 1:
+		print('    ' + (' '.join(command) if isinstance(command, list) else command))
+
+	fnull = open(os.devnull, 'w')
+	result = subprocess.call(command, stdout=fnull, stderr=fnull, shell=not isinstance(command, list))
+	fnull.close()
+
+	return result
+
+
+def run_measured(command):
+	#
+	# Returns (exit code, elapsed seconds, peak memory in KiB or None).
+	#
+	# On POSIX the rusage of the reaped compiler includes its cc1 child.
+	# On Windows only the driver process is measured, run the compiler
+	# proper (e.g. clang -cc1) to get meaningful numbers.
+	#
+
+	fnull = open(os.devnull, 'w')
+	start = time.time()
+	process = subprocess.Popen(command, stdout=fnull, stderr=fnull)
+	peak = None
+
+	if hasattr(os, 'wait4'):
+		_, status, usage = os.wait4(process.pid, 0)
+		elapsed = time.time() - start
+		result = os.WEXITSTATUS(status) if os.WIFEXITED(status) else -1
+		process.returncode = result
+
+		#
+		# ru_maxrss is in bytes on macOS.
+		#
+
+		peak = usage.ru_maxrss // 1024 if sys.platform == 'darwin' else usage.ru_maxrss
+	else:
+		result = process.wait()
+		elapsed = time.time() - start
+		peak = windows_peak_memory(process)
+
+	fnull.close()
+
+	return result, elapsed, peak
+
+
+def windows_peak_memory(process):
+	try:
+		import ctypes
+		from ctypes import wintypes
+
+		class PROCESS_MEMORY_COUNTERS(ctypes.Structure):
+			_fields_ = [
+				('cb',                         wintypes.DWORD),
+				('PageFaultCount',             wintypes.DWORD),
+				('PeakWorkingSetSize',         ctypes.c_size_t),
+				('WorkingSetSize',             ctypes.c_size_t),
+				('QuotaPeakPagedPoolUsage',    ctypes.c_size_t),
+				('QuotaPagedPoolUsage',        ctypes.c_size_t),
+				('QuotaPeakNonPagedPoolUsage', ctypes.c_size_t),
+				('QuotaNonPagedPoolUsage',     ctypes.c_size_t),
+				('PagefileUsage',              ctypes.c_size_t),
+				('PeakPagefileUsage',          ctypes.c_size_t),
+				]
+
+		counters = PROCESS_MEMORY_COUNTERS()
+		counters.cb = ctypes.sizeof(counters)
+
+		if ctypes.windll.psapi.GetProcessMemoryInfo(int(process._handle), ctypes.byref(counters), counters.cb):
+			return counters.PeakWorkingSetSize // 1024
+	except Exception:
+		pass
+
+	return None
+
+
+def compiler_version(compiler):
+	try:
+		output = subprocess.check_output([compiler, '--version'], stderr=subprocess.STDOUT)
+		return output.decode('utf-8', 'replace').splitlines()[0].strip()
+	except Exception:
+		return None
+
+
+def file_sha256(path):
+	digest = hashlib.sha256()
+
+	with open(path, 'rb') as f:
+		for block in iter(lambda: f.read(1024 * 1024), b''):
+			digest.update(block)
+
+	return digest.hexdigest()
+
+
+def file_line_count(path):
+	with open(path, 'rb') as f:
+		return sum(1 for line in f)
+
+
+def dump_header(file_pdb, symbol, options, file_h):
+	command = PDBEX_CMD_TEMPLATE % {
+		'symbol'   : symbol,
+		'file_pdb' : file_pdb,
+		'file_h'   : file_h,
+		'options'  : options
+		}
+
+	return run_command(command) == 0 and os.path.isfile(file_h)
+
+
+def bench_compile(compiler, language, file_c, repeat):
+	#
+	# Size of the preprocessed translation unit.
+	#
+
+	file_i = file_c + '.i'
+	run_command([compiler, '-E', '-x', language, file_c, '-o', file_i])
+	preprocessed = os.path.getsize(file_i) if os.path.isfile(file_i) else None
+
+	best = None
+	peak = None
+	ok = True
+
+	for i in range(repeat):
+		result, elapsed, memory = run_measured([compiler, '-fsyntax-only', '-x', language, file_c])
+
+		if result != 0:
+			ok = False
+			break
+
+		if best is None or elapsed < best:
+			best = elapsed
+
+		if memory is not None:
+			peak = memory if peak is None else max(peak, memory)
+
+	return {
+		'ok'                 : ok,
+		'time_s'             : round(best, 4) if best is not None else None,
+		'peak_memory_kib'    : peak,
+		'preprocessed_bytes' : preprocessed,
+		}
+
+
+def process_pdb(pdb_index, file_pdb, symbols, compilers, language, repeat):
+	print('Processing "%s"' % file_pdb)
+
+	name = os.path.splitext(os.path.basename(file_pdb))[0]
+	targets = [('*', 'full')] + [(symbol, 'closure ' + symbol) for symbol in symbols]
+	results = []
+
+	for target_index, (symbol, target) in enumerate(targets):
+		for variant_index, (variant, options) in enumerate(VARIANTS):
+			#
+			# -j is the default, it is spelled out for the closures.
+			#
+
+			if symbol != '*':
+				options = (options + ' -j').strip()
+
+			mode = '%s, %s' % (target, variant)
+			stem = '%d_%s_%d_%d' % (pdb_index, name, target_index, variant_index)
+			file_h = stem + '.h'
+			file_c = stem + '.c'
+
+			if VERBOSITY_LEVEL >= 1:
+				print('  %s' % mode)
+
+			if not dump_header(file_pdb, symbol, options, file_h):
+				print('  %s: cannot be dumped' % mode)
+				continue
+
+			with open(file_c, 'w') as f:
+				f.write(PRELUDE % { 'file_h' : file_h })
+
+			entry = {
+				'pdb'           : pdb_index,
+				'target'        : target,
+				'variant'       : variant,
+				'options'       : options,
+				'header_bytes'  : os.path.getsize(file_h),
+				'header_lines'  : file_line_count(file_h),
+				'header_sha256' : file_sha256(file_h),
+				'compilers'     : {},
+				}
+
+			for compiler in compilers:
+				entry['compilers'][compiler] = bench_compile(compiler, language, file_c, repeat)
+
+			results.append(entry)
+
+	return results
+
+
+def rank(results, compilers):
+	#
+	# Extra cost of every mode over the default mode of the same target,
+	# averaged over the compilers which compiled both headers.
+	#
+
+	baselines = {}
+
+	for entry in results:
+		if entry['variant'] == VARIANTS[0][0]:
+			baselines[(entry['pdb'], entry['target'])] = entry
+
+	ranking = []
+
+	for entry in results:
+		baseline = baselines.get((entry['pdb'], entry['target']))
+
+		if baseline is None:
+			continue
+
+		deltas = []
+		ratios = []
+
+		for compiler in compilers:
+			current = entry['compilers'][compiler]
+			reference = baseline['compilers'][compiler]
+
+			if current['ok'] and reference['ok'] and reference['time_s']:
+				deltas.append(current['time_s'] - reference['time_s'])
+				ratios.append(current['time_s'] / reference['time_s'])
+
+		if not deltas:
+			continue
+
+		ranking.append({
+			'pdb'           : entry['pdb'],
+			'target'        : entry['target'],
+			'variant'       : entry['variant'],
+			'extra_time_s'  : round(sum(deltas) / len(deltas), 4),
+			'time_ratio'    : round(sum(ratios) / len(ratios), 3),
+			'header_ratio'  : round(float(entry['header_bytes']) / max(baseline['header_bytes'], 1), 3),
+			})
+
+	ranking.sort(key=lambda item: (-item['extra_time_s'], item['pdb'], item['target'], item['variant']))
+
+	return ranking
+
+
+def print_ranking(ranking):
+	print('')
+	print('%-4s %-28s %-10s %10s %8s %8s' % ('pdb', 'target', 'variant', 'extra [s]', 'time', 'size'))
+
+	for item in ranking:
+		print('%-4d %-28s %-10s %10.4f %7.2fx %7.2fx' % (
+			item['pdb'],
+			item['target'][:28],
+			item['variant'],
+			item['extra_time_s'],
+			item['time_ratio'],
+			item['header_ratio']
+			))
+
+
+def main():
+	import argparse
+	parser = argparse.ArgumentParser()
+	parser.add_argument('pdbs', type=str, nargs='*', help='PDB files')
+	parser.add_argument('-s', '--symbol', type=str, action='append', default=[], help='type whose -j closure is measured (repeatable)')
+	parser.add_argument('-c', '--compiler', type=str, action='append', default=[], help='compiler driver (repeatable, default gcc and clang)')
+	parser.add_argument('-x', '--language', type=str, default='c', help='language of the translation unit (c or c++)')
+	parser.add_argument('-r', '--repeat', type=int, default=5, help='count of compilations, the fastest one is taken')
+	parser.add_argument('-j', '--json', type=str, default='bench_compile.json', help='output file of the results')
+	parser.add_argument('-v', '--verbose', action='store_true', help='increase output verbosity')
+
+	args = parser.parse_args()
+
+	global VERBOSITY_LEVEL
+
+	if args.verbose:
+		VERBOSITY_LEVEL = 1
+
+	if not args.pdbs:
+		parser.print_help()
+		return
+
+	compilers = args.compiler or ['gcc', 'clang']
+	compilers = [compiler for compiler in compilers if compiler_version(compiler) is not None]
+
+	if not compilers:
+		print('Error: no compiler found')
+		return
+
+	pdbs = []
+
+	for pdb in args.pdbs:
+		pdb = os.path.abspath(pdb)
+
+		if os.path.isfile(pdb):
+			pdbs.append(pdb)
+		else:
+			print('Error: %s is not a file' % pdb)
+
+	json_path = os.path.abspath(args.json)
+
+	try:
+		os.chdir(OUTPUT_DIRECTORY)
+	except:
+		os.mkdir(OUTPUT_DIRECTORY)
+		os.chdir(OUTPUT_DIRECTORY)
+
+	results = []
+
+	for pdb_index, pdb in enumerate(pdbs):
+		results += process_pdb(pdb_index, pdb, args.symbol, compilers, args.language, args.repeat)
+
+	ranking = rank(results, compilers)
+	print_ranking(ranking)
+
+	report = {
+		'environment' : {
+			'platform'  : platform.platform(),
+			'compilers' : dict((compiler, compiler_version(compiler)) for compiler in compilers),
+			'language'  : args.language,
+			'repeat'    : args.repeat,
+			},
+		'pdbs'        : [{ 'file' : os.path.basename(pdb), 'sha256' : file_sha256(pdb) } for pdb in pdbs],
+		'results'     : results,
+		'ranking'     : ranking,
+		}
+
+	with open(json_path, 'w') as f:
+		json.dump(report, f, indent=1, sort_keys=True)
+		f.write('\n')
+
+	os.chdir('..')
+
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,134 @@
+import filecmp
+import os
+import sys
+import re
+import subprocess
+import time
+
+#
+# Compares the emitter specialized for the settings with the generic one
+# (--generic-emitter) on full-PDB dumps.
+#
+# Time of loading the PDB is measured by a run which does not print
+# definitions (-l-) and it is subtracted from both runs, so the result
+# is the time spent in the emitter itself, divided by the count of fields.
+#
+# Both emitters must produce the same header, the script fails otherwise.
+#
+
+PDBEX_CMD_TEMPLATE = '..\\Bin\\x86\\Release\\pdbex.exe "*" "%(file_pdb)s" -o "%(file_h)s" %(options)s'
+
+FILE_H         = 'bench_emitter.h'
+FILE_H_GENERIC = 'bench_emitter_generic.h'
+
+VERBOSITY_LEVEL = 0 # 0, 1
+
+
+def bench_run(file_pdb, file_h, options, repeat):
+	command = PDBEX_CMD_TEMPLATE % {
+		'file_pdb' : file_pdb,
+		'file_h'   : file_h,
+		'options'  : options
+		}
+
+	if VERBOSITY_LEVEL >= 1:
+		print('    ' + command)
+
+	best = None
+
+	for i in range(repeat):
+		start = time.time()
+		subprocess.call(command)
+		elapsed = time.time() - start
+
+		if best is None or elapsed < best:
+			best = elapsed
+
+	return best
+
+
+def count_fields(file_h):
+	#
+	# Every member (including padding members) ends with ';'
+	# and it is indented.
+	#
+
+	count = 0
+
+	with open(file_h) as f:
+		for line in f:
+			if re.match(r'^\s+[^\s}].*;', line):
+				count += 1
+
+	return count
+
+
+def process_pdb(file_pdb, options, repeat):
+	print('Processing "%s" (options: "%s")' % (file_pdb, options))
+
+	load      = bench_run(file_pdb, FILE_H, options + ' -l-', repeat)
+	generic   = bench_run(file_pdb, FILE_H_GENERIC, options + ' --generic-emitter', repeat)
+	special   = bench_run(file_pdb, FILE_H, options, repeat)
+	fields    = count_fields(FILE_H)
+
+	if not filecmp.cmp(FILE_H_GENERIC, FILE_H, shallow=False):
+		print('  Error: headers of the generic and the specialized emitter differ')
+		return False
+
+	generic_emit = max(generic - load, 0.0)
+	special_emit = max(special - load, 0.0)
+
+	print('  fields:      %d' % fields)
+	print('  load:        %.3f s' % load)
+	print('  generic:     %.3f s (%.1f ns/field)' % (generic_emit, generic_emit * 1e9 / max(fields, 1)))
+	print('  specialized: %.3f s (%.1f ns/field)' % (special_emit, special_emit * 1e9 / max(fields, 1)))
+
+	if generic_emit > 0:
+		print('  saved:       %.1f%%' % ((generic_emit - special_emit) * 100.0 / generic_emit))
+
+	return True
+
+
+def main():
+	import argparse
+	parser = argparse.ArgumentParser()
+	parser.add_argument('pdbs', type=str, nargs='*', help='PDB files')
+	parser.add_argument('-o', '--options', type=str, default='', help='additional pdbex options (e.g. "-e a -x-")')
+	parser.add_argument('-r', '--repeat', type=int, default=5, help='count of runs, the fastest one is taken')
+	parser.add_argument('-v', '--verbose', action='store_true', help='increase output verbosity')
+
+	args = parser.parse_args()
+
+	global VERBOSITY_LEVEL
+
+	if args.verbose:
+		VERBOSITY_LEVEL = 1
+
+	if not args.pdbs:
+		parser.print_help()
+		return
+
+	failed = False
+
+	for pdb in args.pdbs:
+		pdb = os.path.abspath(pdb)
+
+		if os.path.isfile(pdb):
+			if not process_pdb(pdb, args.options, args.repeat):
+				failed = True
+		else:
+			print('Error: %s is not a file' % pdb)
+			failed = True
+
+	for file_h in (FILE_H, FILE_H_GENERIC):
+		try:
+			os.remove(file_h)
+		except:
+			pass
+
+	if failed:
+		sys.exit(1)
+
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,638 @@
+#include "CrashDumpMemoryImage.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+	static const ULONGLONG PAGE_SIZE = 0x1000;
+
+	//
+	// Offsets in DUMP_HEADER32.
+	//
+	namespace Header32
+	{
+		static const ULONGLONG Size                = 0x1000;
+		static const ULONGLONG DirectoryTableBase  = 0x010;
+		static const ULONGLONG PfnDataBase         = 0x014;
+		static const ULONGLONG PsLoadedModuleList  = 0x018;
+		static const ULONGLONG PsActiveProcessHead = 0x01c;
+		static const ULONGLONG MachineImageType    = 0x020;
+		static const ULONGLONG PaeEnabled          = 0x05c;
+		static const ULONGLONG KdDebuggerDataBlock = 0x060;
+		static const ULONGLONG PhysicalMemoryBlock = 0x064;
+		static const ULONGLONG DumpType            = 0xf88;
+
+		//
+		// PHYSICAL_MEMORY_DESCRIPTOR32 ends at ContextRecord.
+		//
+		static const ULONGLONG PhysicalMemoryBlockEnd = 0x320;
+	}
+
+	//
+	// Offsets in DUMP_HEADER64.
+	//
+	namespace Header64
+	{
+		static const ULONGLONG Size                = 0x2000;
+		static const ULONGLONG DirectoryTableBase  = 0x010;
+		static const ULONGLONG PfnDataBase         = 0x018;
+		static const ULONGLONG PsLoadedModuleList  = 0x020;
+		static const ULONGLONG PsActiveProcessHead = 0x028;
+		static const ULONGLONG MachineImageType    = 0x030;
+		static const ULONGLONG KdDebuggerDataBlock = 0x080;
+		static const ULONGLONG PhysicalMemoryBlock = 0x088;
+		static const ULONGLONG DumpType            = 0xf98;
+
+		//
+		// PHYSICAL_MEMORY_DESCRIPTOR64 ends at ContextRecord.
+		//
+		static const ULONGLONG PhysicalMemoryBlockEnd = 0x348;
+	}
+
+	//
+	// Offsets in the header of bitmap dumps ("SDMP" or "FDMP"),
+	// which follows the dump header.
+	//
+	// SUMMARY_DUMP32 { ULONG Signature; ULONG ValidDump; ULONG DumpOptions;
+	//                  ULONG HeaderSize; ULONG BitmapSize; ULONG Pages;
+	//                  RTL_BITMAP32 { ULONG SizeOfBitMap; ULONG Buffer; }; }
+	//
+	namespace BitmapHeader32
+	{
+		static const ULONGLONG FirstPage         = 0x0c;
+		static const ULONGLONG TotalPresentPages = 0x14;
+		static const ULONGLONG Pages             = 0x18;
+		static const ULONGLONG Bitmap            = 0x20;
+	}
+
+	namespace BitmapHeader64
+	{
+		static const ULONGLONG FirstPage         = 0x20;
+		static const ULONGLONG TotalPresentPages = 0x28;
+		static const ULONGLONG Pages             = 0x30;
+		static const ULONGLONG Bitmap            = 0x38;
+	}
+
+	enum DumpType
+	{
+		DumpTypeFull         = 1,
+		DumpTypeKernel       = 2,
+		DumpTypeBitmapFull   = 5,
+		DumpTypeBitmapKernel = 6,
+	};
+
+	//
+	// Paging modes.
+	//
+
+	struct PagingLevel
+	{
+		DWORD Shift;
+		DWORD IndexBits;
+		bool AllowLargePage;
+	};
+
+	struct PagingMode
+	{
+		DWORD EntrySize;
+		ULONGLONG RootMask;
+		ULONGLONG FrameMask;
+		const PagingLevel* Levels;
+		size_t LevelCount;
+	};
+
+	static const ULONGLONG ENTRY_VALID      = 0x01;
+	static const ULONGLONG ENTRY_LARGE_PAGE = 0x80;
+
+	static const PagingLevel LEVELS_AMD64[] = { { 39, 9, false }, { 30, 9, true }, { 21, 9, true }, { 12, 9, false } };
+	static const PagingLevel LEVELS_PAE[]   = { { 30, 2, false }, { 21, 9, true }, { 12, 9, false } };
+	static const PagingLevel LEVELS_X86[]   = { { 22, 10, true }, { 12, 10, false } };
+
+	static const PagingMode PAGING_AMD64 = { 8, 0x000ffffffffff000ULL, 0x000ffffffffff000ULL, LEVELS_AMD64, _countof(LEVELS_AMD64) };
+	static const PagingMode PAGING_PAE   = { 8, 0x00000000ffffffe0ULL, 0x000ffffffffff000ULL, LEVELS_PAE,   _countof(LEVELS_PAE)   };
+	static const PagingMode PAGING_X86   = { 4, 0x00000000fffff000ULL, 0x00000000fffff000ULL, LEVELS_X86,   _countof(LEVELS_X86)   };
+
+	template <
+		typename T
+	>
+	bool
+	ReadFileValue(
+		MappedMemoryImage& File,
+		ULONGLONG Offset,
+		T& Value
+		)
+	{
+		return File.Read(Offset, &Value, sizeof(Value));
+	}
+
+	bool
+	HasBitmapSignature(
+		MappedMemoryImage& File,
+		ULONGLONG Offset
+		)
+	{
+		char Signature[8];
+
+		return File.Read(Offset, Signature, sizeof(Signature)) &&
+		       (memcmp(Signature, "SDMPDUMP", 8) == 0 || memcmp(Signature, "FDMPDUMP", 8) == 0);
+	}
+
+	ULONGLONG
+	CountBits(
+		ULONGLONG Value
+		)
+	{
+		Value = Value - ((Value >> 1) & 0x5555555555555555ULL);
+		Value = (Value & 0x3333333333333333ULL) + ((Value >> 2) & 0x3333333333333333ULL);
+		Value = (Value + (Value >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+
+		return (Value * 0x0101010101010101ULL) >> 56;
+	}
+}
+
+bool
+CrashDumpMemoryImage::IsCrashDump(
+	const char* Path
+	)
+{
+	std::ifstream DumpFile(Path, std::ios::in | std::ios::binary);
+	char Signature[8];
+
+	return DumpFile.read(Signature, sizeof(Signature)) &&
+	       (memcmp(Signature, "PAGEDU64", 8) == 0 || memcmp(Signature, "PAGEDUMP", 8) == 0);
+}
+
+bool
+CrashDumpMemoryImage::Open(
+	const char* Path
+	)
+{
+	m_Runs.clear();
+	m_Rank.clear();
+	m_Bitmap = nullptr;
+
+	if (!m_File.Open(Path, 0))
+	{
+		return false;
+	}
+
+	char Signature[8];
+
+	if (!m_File.Read(0, Signature, sizeof(Signature)))
+	{
+		return false;
+	}
+
+	if (memcmp(Signature, "PAGEDU64", 8) == 0)
+	{
+		return ParseHeader64();
+	}
+
+	if (memcmp(Signature, "PAGEDUMP", 8) == 0)
+	{
+		return ParseHeader32();
+	}
+
+	return false;
+}
+
+bool
+CrashDumpMemoryImage::ParseHeader32()
+{
+	DWORD DirectoryTableBase;
+	DWORD PfnDataBase;
+	DWORD PsLoadedModuleList;
+	DWORD PsActiveProcessHead;
+	DWORD KdDebuggerDataBlock;
+	DWORD Type;
+	BYTE PaeEnabled;
+
+	if (!ReadFileValue(m_File, Header32::DirectoryTableBase, DirectoryTableBase) ||
+	    !ReadFileValue(m_File, Header32::PfnDataBase, PfnDataBase) ||
+	    !ReadFileValue(m_File, Header32::PsLoadedModuleList, PsLoadedModuleList) ||
+	    !ReadFileValue(m_File, Header32::PsActiveProcessHead, PsActiveProcessHead) ||
+	    !ReadFileValue(m_File, Header32::MachineImageType, m_MachineType) ||
+	    !ReadFileValue(m_File, Header32::PaeEnabled, PaeEnabled) ||
+	    !ReadFileValue(m_File, Header32::KdDebuggerDataBlock, KdDebuggerDataBlock) ||
+	    !ReadFileValue(m_File, Header32::DumpType, Type))
+	{
+		return false;
+	}
+
+	m_DirectoryTableBase = DirectoryTableBase;
+	m_PfnDataBase = PfnDataBase;
+	m_PsLoadedModuleList = PsLoadedModuleList;
+	m_PsActiveProcessHead = PsActiveProcessHead;
+	m_KdDebuggerDataBlock = KdDebuggerDataBlock;
+	m_PaeEnabled = PaeEnabled != 0;
+
+	if (m_MachineType != IMAGE_FILE_MACHINE_I386)
+	{
+		return false;
+	}
+
+	if (Type != DumpTypeFull)
+	{
+		//
+		// Fields of the bitmap header are 32-bit.
+		//
+
+		DWORD FirstPageOffset;
+		DWORD PresentPageCount;
+		DWORD BitmapPageCount;
+
+		if (!HasBitmapSignature(m_File, Header32::Size) ||
+		    !ReadFileValue(m_File, Header32::Size + BitmapHeader32::FirstPage, FirstPageOffset) ||
+		    !ReadFileValue(m_File, Header32::Size + BitmapHeader32::TotalPresentPages, PresentPageCount) ||
+		    !ReadFileValue(m_File, Header32::Size + BitmapHeader32::Pages, BitmapPageCount))
+		{
+			return false;
+		}
+
+		m_FirstPageOffset = FirstPageOffset;
+		m_BitmapPageCount = BitmapPageCount;
+
+		return ParseBitmap(Header32::Size + BitmapHeader32::Bitmap, PresentPageCount);
+	}
+
+	//
+	// PHYSICAL_MEMORY_DESCRIPTOR32 { ULONG NumberOfRuns; ULONG NumberOfPages;
+	//                                { ULONG BasePage; ULONG PageCount; } Run[]; }
+	//
+
+	DWORD RunCount;
+
+	if (!ReadFileValue(m_File, Header32::PhysicalMemoryBlock, RunCount) ||
+	    Header32::PhysicalMemoryBlock + 8 + RunCount * 8ULL > Header32::PhysicalMemoryBlockEnd)
+	{
+		return false;
+	}
+
+	ULONGLONG FileOffset = Header32::Size;
+
+	for (DWORD Index = 0; Index < RunCount; Index++)
+	{
+		DWORD Run[2];
+
+		if (!ReadFileValue(m_File, Header32::PhysicalMemoryBlock + 8 + Index * 8, Run))
+		{
+			return false;
+		}
+
+		m_Runs.push_back({ Run[0], Run[1], FileOffset });
+		FileOffset += Run[1] * PAGE_SIZE;
+	}
+
+	return true;
+}
+
+bool
+CrashDumpMemoryImage::ParseHeader64()
+{
+	DWORD Type;
+
+	if (!ReadFileValue(m_File, Header64::DirectoryTableBase, m_DirectoryTableBase) ||
+	    !ReadFileValue(m_File, Header64::PfnDataBase, m_PfnDataBase) ||
+	    !ReadFileValue(m_File, Header64::PsLoadedModuleList, m_PsLoadedModuleList) ||
+	    !ReadFileValue(m_File, Header64::PsActiveProcessHead, m_PsActiveProcessHead) ||
+	    !ReadFileValue(m_File, Header64::MachineImageType, m_MachineType) ||
+	    !ReadFileValue(m_File, Header64::KdDebuggerDataBlock, m_KdDebuggerDataBlock) ||
+	    !ReadFileValue(m_File, Header64::DumpType, Type))
+	{
+		return false;
+	}
+
+	if (m_MachineType != IMAGE_FILE_MACHINE_AMD64)
+	{
+		return false;
+	}
+
+	if (Type != DumpTypeFull)
+	{
+		ULONGLONG PresentPageCount;
+
+		if (!HasBitmapSignature(m_File, Header64::Size) ||
+		    !ReadFileValue(m_File, Header64::Size + BitmapHeader64::FirstPage, m_FirstPageOffset) ||
+		    !ReadFileValue(m_File, Header64::Size + BitmapHeader64::TotalPresentPages, PresentPageCount) ||
+		    !ReadFileValue(m_File, Header64::Size + BitmapHeader64::Pages, m_BitmapPageCount))
+		{
+			return false;
+		}
+
+		return ParseBitmap(Header64::Size + BitmapHeader64::Bitmap, PresentPageCount);
+	}
+
+	//
+	// PHYSICAL_MEMORY_DESCRIPTOR64 { ULONG NumberOfRuns; ULONG64 NumberOfPages;
+	//                                { ULONG64 BasePage; ULONG64 PageCount; } Run[]; }
+	//
+
+	DWORD RunCount;
+
+	if (!ReadFileValue(m_File, Header64::PhysicalMemoryBlock, RunCount) ||
+	    Header64::PhysicalMemoryBlock + 16 + RunCount * 16ULL > Header64::PhysicalMemoryBlockEnd)
+	{
+		return false;
+	}
+
+	ULONGLONG FileOffset = Header64::Size;
+
+	for (DWORD Index = 0; Index < RunCount; Index++)
+	{
+		ULONGLONG Run[2];
+
+		if (!ReadFileValue(m_File, Header64::PhysicalMemoryBlock + 16 + Index * 16, Run))
+		{
+			return false;
+		}
+
+		m_Runs.push_back({ Run[0], Run[1], FileOffset });
+		FileOffset += Run[1] * PAGE_SIZE;
+	}
+
+	return true;
+}
+
+bool
+CrashDumpMemoryImage::ParseBitmap(
+	ULONGLONG BitmapOffset,
+	ULONGLONG PresentPageCount
+	)
+{
+	//
+	// The bitmap of 32-bit dumps is an array of ULONGs,
+	// its bits are in the same order as in the 64-bit words.
+	//
+
+	ULONGLONG WordCount = (m_BitmapPageCount + 63) / 64;
+
+	m_Bitmap = m_File.GetPointer(BitmapOffset, static_cast<size_t>(WordCount * 8));
+
+	if (m_Bitmap == nullptr)
+	{
+		return false;
+	}
+
+	//
+	// Rank of every word of the bitmap, the bits
+	// behind the last page are ignored.
+	//
+
+	m_Rank.resize(static_cast<size_t>(WordCount));
+
+	ULONGLONG Rank = 0;
+
+	for (ULONGLONG Word = 0; Word < WordCount; Word++)
+	{
+		ULONGLONG Bits;
+		memcpy(&Bits, m_Bitmap + Word * 8, sizeof(Bits));
+
+		if (Word == WordCount - 1 && m_BitmapPageCount % 64 != 0)
+		{
+			Bits &= (1ULL << (m_BitmapPageCount % 64)) - 1;
+		}
+
+		m_Rank[static_cast<size_t>(Word)] = Rank;
+		Rank += CountBits(Bits);
+	}
+
+	//
+	// Sanity check of the layout.
+	//
+
+	return Rank == PresentPageCount &&
+	       m_File.GetPointer(m_FirstPageOffset, static_cast<size_t>(PresentPageCount * PAGE_SIZE)) != nullptr;
+}
+
+const BYTE*
+CrashDumpMemoryImage::GetPhysicalPage(
+	ULONGLONG PageNumber
+	)
+{
+	if (m_Bitmap != nullptr)
+	{
+		if (PageNumber >= m_BitmapPageCount)
+		{
+			return nullptr;
+		}
+
+		ULONGLONG Word = PageNumber / 64;
+		ULONGLONG Bit = PageNumber % 64;
+
+		ULONGLONG Bits;
+		memcpy(&Bits, m_Bitmap + Word * 8, sizeof(Bits));
+
+		if ((Bits & (1ULL << Bit)) == 0)
+		{
+			return nullptr;
+		}
+
+		ULONGLONG Index = m_Rank[static_cast<size_t>(Word)] + CountBits(Bits & ((1ULL << Bit) - 1));
+
+		return m_File.GetPointer(m_FirstPageOffset + Index * PAGE_SIZE, static_cast<size_t>(PAGE_SIZE));
+	}
+
+	//
+	// Runs are sorted by their base pages.
+	//
+
+	auto RunIterator = std::upper_bound(m_Runs.begin(), m_Runs.end(), PageNumber, [](ULONGLONG Value, const MemoryRun& Run) {
+		return Value < Run.BasePage;
+	});
+
+	if (RunIterator == m_Runs.begin())
+	{
+		return nullptr;
+	}
+
+	--RunIterator;
+
+	if (PageNumber - RunIterator->BasePage >= RunIterator->PageCount)
+	{
+		return nullptr;
+	}
+
+	return m_File.GetPointer(
+		RunIterator->FileOffset + (PageNumber - RunIterator->BasePage) * PAGE_SIZE,
+		static_cast<size_t>(PAGE_SIZE)
+		);
+}
+
+bool
+CrashDumpMemoryImage::ReadPhysicalEntry(
+	ULONGLONG PhysicalAddress,
+	DWORD EntrySize,
+	ULONGLONG& Entry
+	)
+{
+	const BYTE* Page = GetPhysicalPage(PhysicalAddress / PAGE_SIZE);
+
+	if (Page == nullptr)
+	{
+		return false;
+	}
+
+	Entry = 0;
+	memcpy(&Entry, Page + PhysicalAddress % PAGE_SIZE, EntrySize);
+
+	return true;
+}
+
+bool
+CrashDumpMemoryImage::TranslateAddress(
+	ULONGLONG VirtualAddress,
+	ULONGLONG& PhysicalAddress
+	)
+{
+	const PagingMode& Mode = m_MachineType == IMAGE_FILE_MACHINE_AMD64
+		? PAGING_AMD64
+		: m_PaeEnabled
+			? PAGING_PAE
+			: PAGING_X86;
+
+	if (m_MachineType != IMAGE_FILE_MACHINE_AMD64)
+	{
+		VirtualAddress &= 0xffffffff;
+	}
+
+	ULONGLONG Table = m_DirectoryTableBase & Mode.RootMask;
+
+	for (size_t Level = 0; Level < Mode.LevelCount; Level++)
+	{
+		const PagingLevel& CurrentLevel = Mode.Levels[Level];
+
+		ULONGLONG Index = (VirtualAddress >> CurrentLevel.Shift) & ((1ULL << CurrentLevel.IndexBits) - 1);
+		ULONGLONG Entry;
+
+		if (!ReadPhysicalEntry(Table + Index * Mode.EntrySize, Mode.EntrySize, Entry) ||
+		    (Entry & ENTRY_VALID) == 0)
+		{
+			return false;
+		}
+
+		if (CurrentLevel.AllowLargePage && (Entry & ENTRY_LARGE_PAGE) != 0)
+		{
+			ULONGLONG LargePageMask = (1ULL << CurrentLevel.Shift) - 1;
+
+			PhysicalAddress = (Entry & Mode.FrameMask & ~LargePageMask) + (VirtualAddress & LargePageMask);
+			return true;
+		}
+
+		Table = Entry & Mode.FrameMask;
+	}
+
+	PhysicalAddress = Table + (VirtualAddress & (PAGE_SIZE - 1));
+	return true;
+}
+
+const BYTE*
+CrashDumpMemoryImage::GetPointer(
+	ULONGLONG Address,
+	size_t Size
+	)
+{
+	ULONGLONG PhysicalAddress;
+
+	if (!TranslateAddress(Address, PhysicalAddress))
+	{
+		return nullptr;
+	}
+
+	const BYTE* Page = GetPhysicalPage(PhysicalAddress / PAGE_SIZE);
+
+	if (Page == nullptr)
+	{
+		return nullptr;
+	}
+
+	const BYTE* Pointer = Page + PhysicalAddress % PAGE_SIZE;
+
+	//
+	// Ranges which cross pages are continuous only
+	// if the following pages follow in the file.
+	//
+
+	for (ULONGLONG PageAddress = (Address & ~(PAGE_SIZE - 1)) + PAGE_SIZE;
+	     PageAddress < Address + Size;
+	     PageAddress += PAGE_SIZE)
+	{
+		ULONGLONG NextPhysicalAddress;
+
+		if (!TranslateAddress(PageAddress, NextPhysicalAddress) ||
+		    GetPhysicalPage(NextPhysicalAddress / PAGE_SIZE) != Pointer + (PageAddress - Address))
+		{
+			return nullptr;
+		}
+	}
+
+	return Pointer;
+}
+
+bool
+CrashDumpMemoryImage::Read(
+	ULONGLONG Address,
+	void* Buffer,
+	size_t Size
+	)
+{
+	BYTE* Destination = static_cast<BYTE*>(Buffer);
+
+	while (Size != 0)
+	{
+		ULONGLONG PhysicalAddress;
+
+		if (!TranslateAddress(Address, PhysicalAddress))
+		{
+			return false;
+		}
+
+		const BYTE* Page = GetPhysicalPage(PhysicalAddress / PAGE_SIZE);
+
+		if (Page == nullptr)
+		{
+			return false;
+		}
+
+		size_t PageOffset = static_cast<size_t>(PhysicalAddress % PAGE_SIZE);
+		size_t Length = (std::min)(Size, static_cast<size_t>(PAGE_SIZE) - PageOffset);
+
+		memcpy(Destination, Page + PageOffset, Length);
+
+		Destination += Length;
+		Address += Length;
+		Size -= Length;
+	}
+
+	return true;
+}
+
+bool
+CrashDumpMemoryImage::FindSymbol(
+	const std::string& Name,
+	ULONGLONG& Address
+	)
+{
+	const struct
+	{
+		const char* Name;
+		ULONGLONG Address;
+	} SYMBOLS[] = {
+		{ "PsActiveProcessHead", m_PsActiveProcessHead },
+		{ "PsLoadedModuleList",  m_PsLoadedModuleList  },
+		{ "KdDebuggerDataBlock", m_KdDebuggerDataBlock },
+		{ "MmPfnDatabase",       m_PfnDataBase         },
+	};
+
+	for (auto&& CurrentSymbol : SYMBOLS)
+	{
+		if (Name == CurrentSymbol.Name && CurrentSymbol.Address != 0)
+		{
+			Address = CurrentSymbol.Address;
+			return true;
+		}
+	}
+
+	return false;
+}
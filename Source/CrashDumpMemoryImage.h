@@ -0,0 +1,154 @@
+#pragma once
+#include "MemoryImage.h"
+
+#include <vector>
+
+//
+// Kernel crash dump (MEMORY.DMP) addressed by kernel virtual addresses.
+//
+// Supported are 32-bit (DUMP_HEADER32, "PAGEDUMP") and 64-bit
+// (DUMP_HEADER64, "PAGEDU64") dumps of x86 and AMD64 systems:
+//
+//   - full dumps, physical pages are stored in the order
+//     of the physical memory runs of the header,
+//   - kernel, bitmap full and bitmap kernel dumps, present physical
+//     pages are marked in the bitmap which follows the header
+//     and stored in the order of the bitmap.
+//
+// The dump is mapped into memory, physical page number is translated
+// to the offset in the file by the rank index of the bitmap (count
+// of present pages before every 64-bit word of the bitmap), or by
+// the binary search in the handful of the memory runs.
+//
+// Virtual addresses are translated by the page tables of the dump
+// (DirectoryTableBase of the header); only valid entries are followed.
+//
+class CrashDumpMemoryImage
+	: public MemoryImage
+{
+	public:
+		CrashDumpMemoryImage() = default;
+
+		CrashDumpMemoryImage(const CrashDumpMemoryImage&) = delete;
+		CrashDumpMemoryImage& operator=(const CrashDumpMemoryImage&) = delete;
+
+		//
+		// Returns true if the file starts with the signature of the crash dump.
+		//
+		static
+		bool
+		IsCrashDump(
+			const char* Path
+			);
+
+		//
+		// Returns false if the file cannot be mapped
+		// or it is not a supported crash dump.
+		//
+		bool
+		Open(
+			const char* Path
+			);
+
+		const BYTE*
+		GetPointer(
+			ULONGLONG Address,
+			size_t Size
+			) override;
+
+		bool
+		Read(
+			ULONGLONG Address,
+			void* Buffer,
+			size_t Size
+			) override;
+
+		//
+		// Knows PsActiveProcessHead, PsLoadedModuleList,
+		// KdDebuggerDataBlock and MmPfnDatabase.
+		//
+		bool
+		FindSymbol(
+			const std::string& Name,
+			ULONGLONG& Address
+			) override;
+
+		//
+		// Returns false if the virtual address is not mapped.
+		//
+		bool
+		TranslateAddress(
+			ULONGLONG VirtualAddress,
+			ULONGLONG& PhysicalAddress
+			);
+
+		//
+		// Returns nullptr if the physical page is not in the dump.
+		//
+		const BYTE*
+		GetPhysicalPage(
+			ULONGLONG PageNumber
+			);
+
+		DWORD
+		GetMachineType() const
+		{
+			return m_MachineType;
+		}
+
+	private:
+		struct MemoryRun
+		{
+			ULONGLONG BasePage;
+			ULONGLONG PageCount;
+			ULONGLONG FileOffset;
+		};
+
+		bool
+		ParseHeader32();
+
+		bool
+		ParseHeader64();
+
+		//
+		// m_FirstPageOffset and m_BitmapPageCount are read
+		// from the bitmap header by the caller.
+		//
+		bool
+		ParseBitmap(
+			ULONGLONG BitmapOffset,
+			ULONGLONG PresentPageCount
+			);
+
+		bool
+		ReadPhysicalEntry(
+			ULONGLONG PhysicalAddress,
+			DWORD EntrySize,
+			ULONGLONG& Entry
+			);
+
+	private:
+		MappedMemoryImage m_File;
+
+		DWORD m_MachineType = 0;
+		bool m_PaeEnabled = false;
+
+		ULONGLONG m_DirectoryTableBase = 0;
+		ULONGLONG m_PsActiveProcessHead = 0;
+		ULONGLONG m_PsLoadedModuleList = 0;
+		ULONGLONG m_KdDebuggerDataBlock = 0;
+		ULONGLONG m_PfnDataBase = 0;
+
+		//
+		// Full dumps.
+		//
+		std::vector<MemoryRun> m_Runs;
+
+		//
+		// Bitmap dumps.
+		//
+		const BYTE* m_Bitmap = nullptr;
+		ULONGLONG m_BitmapPageCount = 0;
+		ULONGLONG m_FirstPageOffset = 0;
+		std::vector<ULONGLONG> m_Rank;
+};
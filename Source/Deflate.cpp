@@ -0,0 +1,1263 @@
+#include "Deflate.h"
+
+#include <algorithm>
+#include <cstring>
+#include <queue>
+
+namespace
+{
+	//
+	// Base values and count of extra bits of the length codes (257..285)
+	// and distance codes (0..29).
+	//
+
+	static const WORD LengthBase[29] = {
+		3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+		35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+	};
+
+	static const BYTE LengthExtra[29] = {
+		0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+		3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+	};
+
+	static const WORD DistanceBase[30] = {
+		1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+		257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+	};
+
+	static const BYTE DistanceExtra[30] = {
+		0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+		7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+	};
+
+	//
+	// Order in which lengths of the code length codes are stored.
+	//
+
+	static const BYTE CodeLengthOrder[19] = {
+		16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+	};
+
+	static const int LiteralLengthCodeCount = 286;
+	static const int DistanceCodeCount      = 30;
+	static const int CodeLengthCodeCount    = 19;
+
+	static const int MinimumMatch = 3;
+	static const int MaximumMatch = 258;
+
+	//
+	// Compression parameters - length of the hash chains which are searched
+	// and the length of the match which is taken without lazy evaluation.
+	//
+
+	static const int MaximumChainLength = 128;
+	static const int LazyMatchThreshold = 32;
+
+	static const int HashBits = 15;
+
+	//
+	// Count of tokens in one block.
+	//
+
+	static const size_t BlockTokenCount = 64 * 1024;
+
+	struct CodeTables
+	{
+		CodeTables()
+		{
+			for (int Code = 0; Code < 29; Code++)
+			{
+				for (int Length = LengthBase[Code]; Length < LengthBase[Code] + (1 << LengthExtra[Code]) && Length <= MaximumMatch; Length++)
+				{
+					LengthCode[Length] = static_cast<BYTE>(Code);
+				}
+			}
+
+			for (int Code = 0; Code < 30; Code++)
+			{
+				for (int Distance = DistanceBase[Code] - 1; Distance < DistanceBase[Code] - 1 + (1 << DistanceExtra[Code]); Distance++)
+				{
+					if (Distance < 256)
+					{
+						DistanceCodeSmall[Distance] = static_cast<BYTE>(Code);
+					}
+					else
+					{
+						DistanceCodeLarge[Distance >> 7] = static_cast<BYTE>(Code);
+					}
+				}
+			}
+
+			for (ULONG n = 0; n < 256; n++)
+			{
+				ULONG c = n;
+
+				for (int k = 0; k < 8; k++)
+				{
+					c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : (c >> 1);
+				}
+
+				Crc32[n] = c;
+			}
+		}
+
+		int
+		GetDistanceCode(
+			int Distance
+			) const
+		{
+			return Distance <= 256
+				? DistanceCodeSmall[Distance - 1]
+				: DistanceCodeLarge[(Distance - 1) >> 7];
+		}
+
+		BYTE LengthCode[MaximumMatch + 1];
+		BYTE DistanceCodeSmall[256];
+		BYTE DistanceCodeLarge[256];
+
+		ULONG Crc32[256];
+	};
+
+	static const CodeTables Tables;
+
+	//
+	// Literal (Distance == 0) or match.
+	//
+
+	struct Token
+	{
+		WORD LiteralOrLength;
+		WORD Distance;
+	};
+
+	class BitWriter
+	{
+		public:
+			BitWriter(
+				std::vector<BYTE>& Output
+				)
+				: m_Output(Output)
+			{
+
+			}
+
+			void
+			Put(
+				ULONG Value,
+				int Count
+				)
+			{
+				m_Bits |= static_cast<ULONGLONG>(Value) << m_Count;
+				m_Count += Count;
+
+				while (m_Count >= 8)
+				{
+					m_Output.push_back(static_cast<BYTE>(m_Bits));
+					m_Bits >>= 8;
+					m_Count -= 8;
+				}
+			}
+
+			void
+			Align()
+			{
+				if (m_Count > 0)
+				{
+					m_Output.push_back(static_cast<BYTE>(m_Bits));
+					m_Bits = 0;
+					m_Count = 0;
+				}
+			}
+
+		private:
+			std::vector<BYTE>& m_Output;
+
+			ULONGLONG m_Bits = 0;
+			int m_Count = 0;
+	};
+
+	WORD
+	ReverseBits(
+		WORD Code,
+		int Length
+		)
+	{
+		WORD Result = 0;
+
+		for (int i = 0; i < Length; i++)
+		{
+			Result = (Result << 1) | (Code & 1);
+			Code >>= 1;
+		}
+
+		return Result;
+	}
+
+	//
+	// Builds Huffman code lengths limited to MaximumLength bits.
+	//
+	void
+	BuildCodeLengths(
+		const ULONG* Frequencies,
+		int Count,
+		int MaximumLength,
+		BYTE* Lengths
+		)
+	{
+		memset(Lengths, 0, Count);
+
+		std::vector<int> Symbols;
+
+		for (int Symbol = 0; Symbol < Count; Symbol++)
+		{
+			if (Frequencies[Symbol] != 0)
+			{
+				Symbols.push_back(Symbol);
+			}
+		}
+
+		//
+		// Codes with less than 2 symbols are completed by a dummy symbol,
+		// some decoders reject incomplete codes.
+		//
+
+		if (Symbols.size() < 2)
+		{
+			int Symbol = Symbols.empty() ? 0 : Symbols[0];
+
+			Lengths[Symbol] = 1;
+			Lengths[Symbol == 0 ? 1 : 0] = 1;
+			return;
+		}
+
+		//
+		// Build the Huffman tree.
+		//
+
+		struct Node
+		{
+			ULONG Frequency;
+			int Left;
+			int Right;
+		};
+
+		std::vector<Node> Nodes;
+		std::priority_queue<std::pair<ULONG, int>, std::vector<std::pair<ULONG, int>>, std::greater<std::pair<ULONG, int>>> Queue;
+
+		for (auto&& Symbol : Symbols)
+		{
+			Queue.push(std::make_pair(Frequencies[Symbol], static_cast<int>(Nodes.size())));
+			Nodes.push_back({ Frequencies[Symbol], -1, Symbol });
+		}
+
+		while (Queue.size() > 1)
+		{
+			auto Lhs = Queue.top(); Queue.pop();
+			auto Rhs = Queue.top(); Queue.pop();
+
+			Queue.push(std::make_pair(Lhs.first + Rhs.first, static_cast<int>(Nodes.size())));
+			Nodes.push_back({ Lhs.first + Rhs.first, Lhs.second, Rhs.second });
+		}
+
+		//
+		// Compute depths of the leaves and count them per length.
+		//
+
+		int LengthCounts[64] = { 0 };
+		int MaximumDepth = 0;
+
+		std::vector<std::pair<int, int>> Stack;
+		Stack.push_back(std::make_pair(Queue.top().second, 0));
+
+		while (!Stack.empty())
+		{
+			auto Current = Stack.back();
+			Stack.pop_back();
+
+			const Node& CurrentNode = Nodes[Current.first];
+
+			if (CurrentNode.Left < 0)
+			{
+				int Depth = (std::min)(Current.second, 63);
+				LengthCounts[Depth] += 1;
+				MaximumDepth = (std::max)(MaximumDepth, Depth);
+			}
+			else
+			{
+				Stack.push_back(std::make_pair(CurrentNode.Left, Current.second + 1));
+				Stack.push_back(std::make_pair(CurrentNode.Right, Current.second + 1));
+			}
+		}
+
+		//
+		// Limit the lengths - move all leaves which are too deep
+		// to the maximum length and then restore the Kraft equality
+		// by splitting shorter leaves.
+		//
+
+		if (MaximumDepth > MaximumLength)
+		{
+			for (int Length = MaximumLength + 1; Length <= MaximumDepth; Length++)
+			{
+				LengthCounts[MaximumLength] += LengthCounts[Length];
+				LengthCounts[Length] = 0;
+			}
+
+			ULONG Total = 0;
+
+			for (int Length = 1; Length <= MaximumLength; Length++)
+			{
+				Total += static_cast<ULONG>(LengthCounts[Length]) << (MaximumLength - Length);
+			}
+
+			while (Total != (1UL << MaximumLength))
+			{
+				LengthCounts[MaximumLength] -= 1;
+
+				for (int Length = MaximumLength - 1; Length > 0; Length--)
+				{
+					if (LengthCounts[Length] != 0)
+					{
+						LengthCounts[Length] -= 1;
+						LengthCounts[Length + 1] += 2;
+						break;
+					}
+				}
+
+				Total -= 1;
+			}
+		}
+
+		//
+		// The most frequent symbols get the shortest codes.
+		//
+
+		std::stable_sort(Symbols.begin(), Symbols.end(), [Frequencies](int Lhs, int Rhs) {
+			return Frequencies[Lhs] > Frequencies[Rhs];
+		});
+
+		size_t SymbolIndex = 0;
+
+		for (int Length = 1; Length <= MaximumLength; Length++)
+		{
+			for (int i = 0; i < LengthCounts[Length]; i++)
+			{
+				Lengths[Symbols[SymbolIndex++]] = static_cast<BYTE>(Length);
+			}
+		}
+	}
+
+	//
+	// Assigns canonical codes, already bit-reversed for the BitWriter.
+	//
+	void
+	BuildCodes(
+		const BYTE* Lengths,
+		int Count,
+		WORD* Codes
+		)
+	{
+		int LengthCounts[16] = { 0 };
+		WORD NextCode[16] = { 0 };
+
+		for (int Symbol = 0; Symbol < Count; Symbol++)
+		{
+			LengthCounts[Lengths[Symbol]] += 1;
+		}
+
+		LengthCounts[0] = 0;
+
+		WORD Code = 0;
+
+		for (int Length = 1; Length < 16; Length++)
+		{
+			Code = (Code + LengthCounts[Length - 1]) << 1;
+			NextCode[Length] = Code;
+		}
+
+		for (int Symbol = 0; Symbol < Count; Symbol++)
+		{
+			if (Lengths[Symbol] != 0)
+			{
+				Codes[Symbol] = ReverseBits(NextCode[Lengths[Symbol]]++, Lengths[Symbol]);
+			}
+		}
+	}
+
+	void
+	WriteBlock(
+		BitWriter& Writer,
+		const std::vector<Token>& Tokens
+		)
+	{
+		ULONG LiteralLengthFrequencies[LiteralLengthCodeCount] = { 0 };
+		ULONG DistanceFrequencies[DistanceCodeCount] = { 0 };
+
+		for (auto&& CurrentToken : Tokens)
+		{
+			if (CurrentToken.Distance == 0)
+			{
+				LiteralLengthFrequencies[CurrentToken.LiteralOrLength] += 1;
+			}
+			else
+			{
+				LiteralLengthFrequencies[257 + Tables.LengthCode[CurrentToken.LiteralOrLength]] += 1;
+				DistanceFrequencies[Tables.GetDistanceCode(CurrentToken.Distance)] += 1;
+			}
+		}
+
+		LiteralLengthFrequencies[256] = 1;
+
+		BYTE LiteralLengthLengths[LiteralLengthCodeCount];
+		BYTE DistanceLengths[DistanceCodeCount];
+		WORD LiteralLengthCodes[LiteralLengthCodeCount];
+		WORD DistanceCodes[DistanceCodeCount];
+
+		BuildCodeLengths(LiteralLengthFrequencies, LiteralLengthCodeCount, 15, LiteralLengthLengths);
+		BuildCodeLengths(DistanceFrequencies, DistanceCodeCount, 15, DistanceLengths);
+		BuildCodes(LiteralLengthLengths, LiteralLengthCodeCount, LiteralLengthCodes);
+		BuildCodes(DistanceLengths, DistanceCodeCount, DistanceCodes);
+
+		int LiteralLengthCount = LiteralLengthCodeCount;
+		while (LiteralLengthCount > 257 && LiteralLengthLengths[LiteralLengthCount - 1] == 0)
+		{
+			LiteralLengthCount--;
+		}
+
+		int DistanceCount = DistanceCodeCount;
+		while (DistanceCount > 1 && DistanceLengths[DistanceCount - 1] == 0)
+		{
+			DistanceCount--;
+		}
+
+		//
+		// Run-length encode the code lengths.
+		//
+
+		std::vector<BYTE> AllLengths(LiteralLengthLengths, LiteralLengthLengths + LiteralLengthCount);
+		AllLengths.insert(AllLengths.end(), DistanceLengths, DistanceLengths + DistanceCount);
+
+		std::vector<std::pair<BYTE, BYTE>> CodeLengthSymbols;
+		ULONG CodeLengthFrequencies[CodeLengthCodeCount] = { 0 };
+
+		auto EmitCodeLength = [&CodeLengthSymbols, &CodeLengthFrequencies](BYTE Symbol, BYTE Extra) {
+			CodeLengthSymbols.push_back(std::make_pair(Symbol, Extra));
+			CodeLengthFrequencies[Symbol] += 1;
+		};
+
+		size_t Index = 0;
+
+		while (Index < AllLengths.size())
+		{
+			BYTE Length = AllLengths[Index];
+			size_t Run = 1;
+
+			while (Index + Run < AllLengths.size() && AllLengths[Index + Run] == Length)
+			{
+				Run++;
+			}
+
+			if (Length == 0 && Run >= 3)
+			{
+				size_t Repeat = (std::min)(Run, static_cast<size_t>(138));
+
+				if (Repeat >= 11)
+				{
+					EmitCodeLength(18, static_cast<BYTE>(Repeat - 11));
+				}
+				else
+				{
+					EmitCodeLength(17, static_cast<BYTE>(Repeat - 3));
+				}
+
+				Index += Repeat;
+				continue;
+			}
+
+			EmitCodeLength(Length, 0);
+			Index += 1;
+			Run -= 1;
+
+			if (Length != 0)
+			{
+				while (Run >= 3)
+				{
+					size_t Repeat = (std::min)(Run, static_cast<size_t>(6));
+
+					EmitCodeLength(16, static_cast<BYTE>(Repeat - 3));
+					Index += Repeat;
+					Run -= Repeat;
+				}
+			}
+		}
+
+		BYTE CodeLengthLengths[CodeLengthCodeCount];
+		WORD CodeLengthCodes[CodeLengthCodeCount];
+
+		BuildCodeLengths(CodeLengthFrequencies, CodeLengthCodeCount, 7, CodeLengthLengths);
+		BuildCodes(CodeLengthLengths, CodeLengthCodeCount, CodeLengthCodes);
+
+		int CodeLengthCount = CodeLengthCodeCount;
+		while (CodeLengthCount > 4 && CodeLengthLengths[CodeLengthOrder[CodeLengthCount - 1]] == 0)
+		{
+			CodeLengthCount--;
+		}
+
+		//
+		// Block header.
+		//
+
+		Writer.Put(0, 1); // BFINAL
+		Writer.Put(2, 2); // BTYPE = dynamic Huffman codes
+		Writer.Put(LiteralLengthCount - 257, 5);
+		Writer.Put(DistanceCount - 1, 5);
+		Writer.Put(CodeLengthCount - 4, 4);
+
+		for (int i = 0; i < CodeLengthCount; i++)
+		{
+			Writer.Put(CodeLengthLengths[CodeLengthOrder[i]], 3);
+		}
+
+		static const BYTE CodeLengthExtra[3] = { 2, 3, 7 };
+
+		for (auto&& Symbol : CodeLengthSymbols)
+		{
+			Writer.Put(CodeLengthCodes[Symbol.first], CodeLengthLengths[Symbol.first]);
+
+			if (Symbol.first >= 16)
+			{
+				Writer.Put(Symbol.second, CodeLengthExtra[Symbol.first - 16]);
+			}
+		}
+
+		//
+		// Block data.
+		//
+
+		for (auto&& CurrentToken : Tokens)
+		{
+			if (CurrentToken.Distance == 0)
+			{
+				Writer.Put(LiteralLengthCodes[CurrentToken.LiteralOrLength], LiteralLengthLengths[CurrentToken.LiteralOrLength]);
+			}
+			else
+			{
+				int LengthCode = Tables.LengthCode[CurrentToken.LiteralOrLength];
+				int DistanceCode = Tables.GetDistanceCode(CurrentToken.Distance);
+
+				Writer.Put(LiteralLengthCodes[257 + LengthCode], LiteralLengthLengths[257 + LengthCode]);
+				Writer.Put(CurrentToken.LiteralOrLength - LengthBase[LengthCode], LengthExtra[LengthCode]);
+
+				Writer.Put(DistanceCodes[DistanceCode], DistanceLengths[DistanceCode]);
+				Writer.Put(CurrentToken.Distance - DistanceBase[DistanceCode], DistanceExtra[DistanceCode]);
+			}
+		}
+
+		Writer.Put(LiteralLengthCodes[256], LiteralLengthLengths[256]);
+	}
+}
+
+const size_t Deflate::WindowSize;
+
+void
+Deflate::CompressChunk(
+	const BYTE* Data,
+	size_t DictionarySize,
+	size_t Size,
+	std::vector<BYTE>& Output
+	)
+{
+	BitWriter Writer(Output);
+
+	std::vector<int> Head(1 << HashBits, -1);
+	std::vector<int> Previous(Size, -1);
+
+	auto Hash = [Data](size_t Position) {
+		ULONG Value = (Data[Position] << 16) | (Data[Position + 1] << 8) | Data[Position + 2];
+		return static_cast<ULONG>(Value * 0x9E3779B1) >> (32 - HashBits);
+	};
+
+	size_t NextInsert = 0;
+
+	auto InsertUpTo = [&](size_t Position) {
+		for (; NextInsert < Position && NextInsert + MinimumMatch <= Size; NextInsert++)
+		{
+			ULONG HashValue = Hash(NextInsert);
+			Previous[NextInsert] = Head[HashValue];
+			Head[HashValue] = static_cast<int>(NextInsert);
+		}
+	};
+
+	auto FindMatch = [&](size_t Position, int& Distance) {
+		if (Position + MinimumMatch > Size)
+		{
+			return 0;
+		}
+
+		int MaximumLength = static_cast<int>((std::min)(static_cast<size_t>(MaximumMatch), Size - Position));
+		int BestLength = MinimumMatch - 1;
+		int ChainLength = MaximumChainLength;
+
+		for (int Candidate = Head[Hash(Position)];
+		     Candidate >= 0 && Position - Candidate <= WindowSize && ChainLength-- > 0;
+		     Candidate = Previous[Candidate])
+		{
+			const BYTE* Lhs = Data + Candidate;
+			const BYTE* Rhs = Data + Position;
+
+			if (Lhs[BestLength] != Rhs[BestLength] || Lhs[0] != Rhs[0] || Lhs[1] != Rhs[1])
+			{
+				continue;
+			}
+
+			int Length = 0;
+			while (Length < MaximumLength && Lhs[Length] == Rhs[Length])
+			{
+				Length++;
+			}
+
+			if (Length > BestLength)
+			{
+				BestLength = Length;
+				Distance = static_cast<int>(Position - Candidate);
+
+				if (Length >= MaximumLength)
+				{
+					break;
+				}
+			}
+		}
+
+		return BestLength >= MinimumMatch ? BestLength : 0;
+	};
+
+	std::vector<Token> Tokens;
+	Tokens.reserve(BlockTokenCount);
+
+	size_t Position = DictionarySize;
+
+	while (Position < Size)
+	{
+		int Distance = 0;
+
+		InsertUpTo(Position);
+		int Length = FindMatch(Position, Distance);
+
+		//
+		// Lazy evaluation - prefer a literal followed by a longer match.
+		//
+
+		if (Length != 0 && Length < LazyMatchThreshold)
+		{
+			int NextDistance = 0;
+
+			InsertUpTo(Position + 1);
+
+			if (FindMatch(Position + 1, NextDistance) > Length)
+			{
+				Length = 0;
+			}
+		}
+
+		if (Length != 0)
+		{
+			Tokens.push_back({ static_cast<WORD>(Length), static_cast<WORD>(Distance) });
+			Position += Length;
+		}
+		else
+		{
+			Tokens.push_back({ Data[Position], 0 });
+			Position += 1;
+		}
+
+		if (Tokens.size() >= BlockTokenCount)
+		{
+			WriteBlock(Writer, Tokens);
+			Tokens.clear();
+		}
+	}
+
+	if (!Tokens.empty())
+	{
+		WriteBlock(Writer, Tokens);
+	}
+
+	//
+	// Empty stored block aligns the output to the byte boundary.
+	//
+
+	Writer.Put(0, 1); // BFINAL
+	Writer.Put(0, 2); // BTYPE = stored
+	Writer.Align();
+
+	Output.push_back(0x00);
+	Output.push_back(0x00);
+	Output.push_back(0xFF);
+	Output.push_back(0xFF);
+}
+
+void
+Deflate::WriteFinalBlock(
+	std::vector<BYTE>& Output
+	)
+{
+	BitWriter Writer(Output);
+
+	Writer.Put(1, 1); // BFINAL
+	Writer.Put(1, 2); // BTYPE = fixed Huffman codes
+	Writer.Put(0, 7); // End of block
+	Writer.Align();
+}
+
+Inflate::Inflate(
+	std::istream& Input
+	)
+	: m_Input(Input)
+	, m_InputBuffer(64 * 1024)
+{
+
+}
+
+bool
+Inflate::Decompress(
+	std::ostream& Output,
+	ULONG& Crc32,
+	ULONGLONG& Size
+	)
+{
+	static Huffman FixedLengthTable;
+	static Huffman FixedDistanceTable;
+	static bool FixedTablesBuilt = false;
+
+	if (!FixedTablesBuilt)
+	{
+		BYTE Lengths[288];
+
+		memset(Lengths +   0, 8, 144);
+		memset(Lengths + 144, 9, 112);
+		memset(Lengths + 256, 7,  24);
+		memset(Lengths + 280, 8,   8);
+		Build(FixedLengthTable, Lengths, 288);
+
+		memset(Lengths, 5, 30);
+		Build(FixedDistanceTable, Lengths, 30);
+
+		FixedTablesBuilt = true;
+	}
+
+	m_Output = &Output;
+	m_Crc32 = Crc32;
+	m_Size = Size;
+	m_Error = false;
+
+	m_Window.clear();
+	m_Window.reserve(8 * Deflate::WindowSize);
+
+	ULONG Final;
+
+	do
+	{
+		Final = GetBits(1);
+		ULONG Type = GetBits(2);
+
+		switch (Type)
+		{
+			case 0:
+				DecompressStored();
+				break;
+
+			case 1:
+				DecompressCodes(FixedLengthTable, FixedDistanceTable);
+				break;
+
+			case 2:
+			{
+				Huffman LengthTable;
+				Huffman DistanceTable;
+
+				if (ReadDynamicTables(LengthTable, DistanceTable))
+				{
+					DecompressCodes(LengthTable, DistanceTable);
+				}
+				break;
+			}
+
+			default:
+				m_Error = true;
+				break;
+		}
+	} while (!m_Error && !Final);
+
+	if (m_Error)
+	{
+		return false;
+	}
+
+	FlushWindow(true);
+
+	//
+	// Data behind the stream start at the byte boundary.
+	//
+
+	m_BitBuffer >>= m_BitCount % 8;
+	m_BitCount -= m_BitCount % 8;
+
+	Crc32 = m_Crc32;
+	Size = m_Size;
+
+	return true;
+}
+
+bool
+Inflate::ReadByte(
+	BYTE& Value
+	)
+{
+	if (m_BitCount / 8 > m_Overrun)
+	{
+		Value = static_cast<BYTE>(m_BitBuffer);
+		m_BitBuffer >>= 8;
+		m_BitCount -= 8;
+		return true;
+	}
+
+	if (m_Overrun != 0)
+	{
+		return false;
+	}
+
+	if (m_InputPosition == m_InputSize)
+	{
+		m_Input.read(m_InputBuffer.data(), m_InputBuffer.size());
+		m_InputSize = static_cast<size_t>(m_Input.gcount());
+		m_InputPosition = 0;
+
+		if (m_InputSize == 0)
+		{
+			return false;
+		}
+	}
+
+	Value = static_cast<BYTE>(m_InputBuffer[m_InputPosition++]);
+	return true;
+}
+
+bool
+Inflate::Build(
+	Huffman& Table,
+	const BYTE* Lengths,
+	int Count
+	)
+{
+	memset(Table.Counts, 0, sizeof(Table.Counts));
+	memset(Table.Fast, 0, sizeof(Table.Fast));
+
+	for (int Symbol = 0; Symbol < Count; Symbol++)
+	{
+		Table.Counts[Lengths[Symbol]] += 1;
+	}
+
+	Table.Counts[0] = 0;
+
+	//
+	// Check for over-subscribed code.
+	//
+
+	int Left = 1;
+
+	for (int Length = 1; Length < 16; Length++)
+	{
+		Left <<= 1;
+		Left -= Table.Counts[Length];
+
+		if (Left < 0)
+		{
+			return false;
+		}
+	}
+
+	WORD Offsets[16];
+	WORD NextCode[16];
+	WORD Code = 0;
+
+	Offsets[1] = 0;
+	NextCode[0] = 0;
+
+	for (int Length = 1; Length < 16; Length++)
+	{
+		if (Length < 15)
+		{
+			Offsets[Length + 1] = Offsets[Length] + Table.Counts[Length];
+		}
+
+		Code = (Code + Table.Counts[Length - 1]) << 1;
+		NextCode[Length] = Code;
+	}
+
+	Table.Symbols.assign(Count, 0);
+
+	for (int Symbol = 0; Symbol < Count; Symbol++)
+	{
+		int Length = Lengths[Symbol];
+
+		if (Length == 0)
+		{
+			continue;
+		}
+
+		Table.Symbols[Offsets[Length]++] = static_cast<WORD>(Symbol);
+
+		WORD SymbolCode = NextCode[Length]++;
+
+		if (Length <= Huffman::FastBits)
+		{
+			WORD Reversed = ReverseBits(SymbolCode, Length);
+
+			for (int Fill = Reversed; Fill < (1 << Huffman::FastBits); Fill += 1 << Length)
+			{
+				Table.Fast[Fill] = static_cast<WORD>((Symbol << 4) | Length);
+			}
+		}
+	}
+
+	return true;
+}
+
+int
+Inflate::DecodeSymbol(
+	const Huffman& Table
+	)
+{
+	NeedBits(Huffman::FastBits);
+
+	WORD Entry = Table.Fast[m_BitBuffer & ((1 << Huffman::FastBits) - 1)];
+
+	if (Entry != 0)
+	{
+		int Length = Entry & 15;
+
+		m_BitBuffer >>= Length;
+		m_BitCount -= Length;
+
+		return Entry >> 4;
+	}
+
+	//
+	// Slow path for long codes.
+	//
+
+	int Code = 0;
+	int First = 0;
+	int Index = 0;
+
+	for (int Length = 1; Length < 16; Length++)
+	{
+		Code |= GetBits(1);
+
+		int Count = Table.Counts[Length];
+
+		if (Code - Count < First)
+		{
+			return Table.Symbols[Index + (Code - First)];
+		}
+
+		Index += Count;
+		First += Count;
+		First <<= 1;
+		Code <<= 1;
+	}
+
+	m_Error = true;
+	return -1;
+}
+
+bool
+Inflate::NeedBits(
+	int Count
+	)
+{
+	while (m_BitCount < Count)
+	{
+		BYTE Value = 0;
+
+		if (m_InputPosition == m_InputSize)
+		{
+			m_Input.read(m_InputBuffer.data(), m_InputBuffer.size());
+			m_InputSize = static_cast<size_t>(m_Input.gcount());
+			m_InputPosition = 0;
+		}
+
+		if (m_InputPosition < m_InputSize)
+		{
+			Value = static_cast<BYTE>(m_InputBuffer[m_InputPosition++]);
+		}
+		else
+		{
+			//
+			// Allow reading few bytes behind the end, the decoder
+			// peeks more bits than it may actually need.
+			//
+
+			if (++m_Overrun > 8)
+			{
+				m_Error = true;
+				return false;
+			}
+		}
+
+		m_BitBuffer |= static_cast<ULONGLONG>(Value) << m_BitCount;
+		m_BitCount += 8;
+	}
+
+	return true;
+}
+
+ULONG
+Inflate::GetBits(
+	int Count
+	)
+{
+	if (Count == 0 || !NeedBits(Count))
+	{
+		return 0;
+	}
+
+	ULONG Value = static_cast<ULONG>(m_BitBuffer & ((1ULL << Count) - 1));
+
+	m_BitBuffer >>= Count;
+	m_BitCount -= Count;
+
+	return Value;
+}
+
+bool
+Inflate::DecompressStored()
+{
+	m_BitBuffer >>= m_BitCount % 8;
+	m_BitCount -= m_BitCount % 8;
+
+	ULONG Length = GetBits(16);
+	ULONG LengthComplement = GetBits(16);
+
+	if (Length != (~LengthComplement & 0xFFFF))
+	{
+		m_Error = true;
+		return false;
+	}
+
+	while (Length-- > 0 && !m_Error)
+	{
+		m_Window.push_back(static_cast<BYTE>(GetBits(8)));
+	}
+
+	FlushWindow(false);
+
+	return !m_Error;
+}
+
+bool
+Inflate::DecompressCodes(
+	const Huffman& LengthTable,
+	const Huffman& DistanceTable
+	)
+{
+	while (!m_Error)
+	{
+		int Symbol = DecodeSymbol(LengthTable);
+
+		if (Symbol < 0)
+		{
+			break;
+		}
+		else if (Symbol < 256)
+		{
+			m_Window.push_back(static_cast<BYTE>(Symbol));
+		}
+		else if (Symbol == 256)
+		{
+			return true;
+		}
+		else
+		{
+			Symbol -= 257;
+
+			if (Symbol >= 29)
+			{
+				m_Error = true;
+				break;
+			}
+
+			size_t Length = LengthBase[Symbol] + GetBits(LengthExtra[Symbol]);
+
+			int DistanceSymbol = DecodeSymbol(DistanceTable);
+
+			if (DistanceSymbol < 0 || DistanceSymbol >= 30)
+			{
+				m_Error = true;
+				break;
+			}
+
+			size_t Distance = DistanceBase[DistanceSymbol] + GetBits(DistanceExtra[DistanceSymbol]);
+
+			if (Distance > m_Window.size())
+			{
+				m_Error = true;
+				break;
+			}
+
+			size_t From = m_Window.size() - Distance;
+
+			for (size_t i = 0; i < Length; i++)
+			{
+				m_Window.push_back(m_Window[From + i]);
+			}
+		}
+
+		if (m_Window.size() >= 4 * Deflate::WindowSize)
+		{
+			FlushWindow(false);
+		}
+	}
+
+	return false;
+}
+
+bool
+Inflate::ReadDynamicTables(
+	Huffman& LengthTable,
+	Huffman& DistanceTable
+	)
+{
+	int LiteralLengthCount = GetBits(5) + 257;
+	int DistanceCount = GetBits(5) + 1;
+	int CodeLengthCount = GetBits(4) + 4;
+
+	if (LiteralLengthCount > LiteralLengthCodeCount || DistanceCount > DistanceCodeCount)
+	{
+		m_Error = true;
+		return false;
+	}
+
+	BYTE Lengths[LiteralLengthCodeCount + DistanceCodeCount] = { 0 };
+
+	for (int i = 0; i < CodeLengthCount; i++)
+	{
+		Lengths[CodeLengthOrder[i]] = static_cast<BYTE>(GetBits(3));
+	}
+
+	Huffman CodeLengthTable;
+
+	if (!Build(CodeLengthTable, Lengths, CodeLengthCodeCount))
+	{
+		m_Error = true;
+		return false;
+	}
+
+	int Index = 0;
+
+	while (Index < LiteralLengthCount + DistanceCount && !m_Error)
+	{
+		int Symbol = DecodeSymbol(CodeLengthTable);
+
+		if (Symbol < 0)
+		{
+			break;
+		}
+
+		if (Symbol < 16)
+		{
+			Lengths[Index++] = static_cast<BYTE>(Symbol);
+			continue;
+		}
+
+		BYTE Length = 0;
+		int Repeat;
+
+		if (Symbol == 16)
+		{
+			if (Index == 0)
+			{
+				m_Error = true;
+				break;
+			}
+
+			Length = Lengths[Index - 1];
+			Repeat = 3 + GetBits(2);
+		}
+		else if (Symbol == 17)
+		{
+			Repeat = 3 + GetBits(3);
+		}
+		else
+		{
+			Repeat = 11 + GetBits(7);
+		}
+
+		if (Index + Repeat > LiteralLengthCount + DistanceCount)
+		{
+			m_Error = true;
+			break;
+		}
+
+		while (Repeat-- > 0)
+		{
+			Lengths[Index++] = Length;
+		}
+	}
+
+	if (m_Error || Lengths[256] == 0)
+	{
+		m_Error = true;
+		return false;
+	}
+
+	if (!Build(LengthTable, Lengths, LiteralLengthCount) ||
+	    !Build(DistanceTable, Lengths + LiteralLengthCount, DistanceCount))
+	{
+		m_Error = true;
+		return false;
+	}
+
+	return true;
+}
+
+void
+Inflate::FlushWindow(
+	bool All
+	)
+{
+	size_t Keep = All ? 0 : Deflate::WindowSize;
+
+	if (m_Window.size() <= Keep)
+	{
+		return;
+	}
+
+	size_t Count = m_Window.size() - Keep;
+
+	m_Output->write(reinterpret_cast<const char*>(m_Window.data()), Count);
+	m_Crc32 = Crc32Update(m_Crc32, m_Window.data(), Count);
+	m_Size += Count;
+
+	m_Window.erase(m_Window.begin(), m_Window.begin() + Count);
+}
+
+ULONG
+Crc32Update(
+	ULONG Crc32,
+	const void* Data,
+	size_t Size
+	)
+{
+	const BYTE* Bytes = static_cast<const BYTE*>(Data);
+
+	Crc32 = ~Crc32;
+
+	for (size_t i = 0; i < Size; i++)
+	{
+		Crc32 = Tables.Crc32[(Crc32 ^ Bytes[i]) & 0xFF] ^ (Crc32 >> 8);
+	}
+
+	return ~Crc32;
+}
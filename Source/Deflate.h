@@ -0,0 +1,173 @@
+#pragma once
+#include <windows.h>
+
+#include <iostream>
+#include <vector>
+
+//
+// Minimal implementation of the DEFLATE format (RFC 1951).
+//
+
+class Deflate
+{
+	public:
+		//
+		// Compresses Data[DictionarySize, Size) into DEFLATE blocks
+		// with dynamic Huffman codes. Data[0, DictionarySize) is used
+		// only as a history for matches, so consecutive chunks
+		// can be compressed independently (and in parallel)
+		// with the end of the previous chunk as the dictionary.
+		//
+		// The output is terminated by an empty stored block,
+		// which aligns it to the byte boundary. It is not final,
+		// therefore outputs of consecutive chunks can be concatenated.
+		// The stream must be terminated by WriteFinalBlock().
+		//
+		static
+		void
+		CompressChunk(
+			const BYTE* Data,
+			size_t DictionarySize,
+			size_t Size,
+			std::vector<BYTE>& Output
+			);
+
+		//
+		// Writes an empty final block.
+		//
+		static
+		void
+		WriteFinalBlock(
+			std::vector<BYTE>& Output
+			);
+
+		//
+		// Maximum distance of a match.
+		//
+		static const size_t WindowSize = 32 * 1024;
+};
+
+class Inflate
+{
+	public:
+		Inflate(
+			std::istream& Input
+			);
+
+		//
+		// Decompresses one DEFLATE stream into the output.
+		// CRC-32 and the size of the decompressed data are updated.
+		//
+		// Returns false if the data are corrupted.
+		//
+		bool
+		Decompress(
+			std::ostream& Output,
+			ULONG& Crc32,
+			ULONGLONG& Size
+			);
+
+		//
+		// Reads one byte behind the end of the DEFLATE stream.
+		//
+		// Returns false at the end of the input.
+		//
+		bool
+		ReadByte(
+			BYTE& Value
+			);
+
+	private:
+		struct Huffman
+		{
+			static const int FastBits = 9;
+
+			WORD Counts[16];
+			std::vector<WORD> Symbols;
+
+			//
+			// Symbol << 4 | Length, for codes not longer than FastBits,
+			// or 0 for longer codes.
+			//
+			WORD Fast[1 << FastBits];
+		};
+
+		bool
+		Build(
+			Huffman& Table,
+			const BYTE* Lengths,
+			int Count
+			);
+
+		int
+		DecodeSymbol(
+			const Huffman& Table
+			);
+
+		bool
+		NeedBits(
+			int Count
+			);
+
+		ULONG
+		GetBits(
+			int Count
+			);
+
+		bool
+		DecompressStored();
+
+		bool
+		DecompressCodes(
+			const Huffman& LengthTable,
+			const Huffman& DistanceTable
+			);
+
+		bool
+		ReadDynamicTables(
+			Huffman& LengthTable,
+			Huffman& DistanceTable
+			);
+
+		void
+		FlushWindow(
+			bool All
+			);
+
+	private:
+		std::istream& m_Input;
+
+		std::vector<char> m_InputBuffer;
+		size_t m_InputPosition = 0;
+		size_t m_InputSize = 0;
+
+		ULONGLONG m_BitBuffer = 0;
+		int m_BitCount = 0;
+
+		//
+		// Count of bytes which were read behind the end of the input.
+		//
+		int m_Overrun = 0;
+
+		bool m_Error = false;
+
+		//
+		// Decompressed data, the last WindowSize bytes
+		// are kept for back-references.
+		//
+		std::vector<BYTE> m_Window;
+
+		std::ostream* m_Output = nullptr;
+		ULONG m_Crc32 = 0;
+		ULONGLONG m_Size = 0;
+};
+
+//
+// Updates CRC-32 (as used by gzip) with the provided data.
+//
+ULONG
+Crc32Update(
+	ULONG Crc32,
+	const void* Data,
+	size_t Size
+	);
@@ -0,0 +1,3537 @@
+#include "DwarfTypeLoader.h"
+#include "Deflate.h"
+#include "WorkerThreads.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifndef IMAGE_FILE_MACHINE_ARMNT
+#define IMAGE_FILE_MACHINE_ARMNT 0x01c4
+#endif
+
+#ifndef IMAGE_FILE_MACHINE_ARM64
+#define IMAGE_FILE_MACHINE_ARM64 0xaa64
+#endif
+
+namespace
+{
+	static DwarfTypeLoader::Settings DefaultSettings;
+
+	static const ULONGLONG FNV_OFFSET_BASIS = 14695981039346656037ull;
+	static const ULONGLONG FNV_PRIME        = 1099511628211ull;
+
+	//
+	// ELF.
+	//
+
+	static const WORD  ELF_ET_REL            = 1;
+
+	static const WORD  ELF_EM_386            = 3;
+	static const WORD  ELF_EM_ARM            = 40;
+	static const WORD  ELF_EM_X86_64         = 62;
+	static const WORD  ELF_EM_AARCH64        = 183;
+
+	static const DWORD ELF_SHT_RELA          = 4;
+	static const DWORD ELF_SHT_NOBITS        = 8;
+	static const DWORD ELF_SHT_REL           = 9;
+
+	static const ULONGLONG ELF_SHF_COMPRESSED = 0x800;
+	static const DWORD ELF_COMPRESS_ZLIB     = 1;
+
+	static const WORD  ELF_SHN_XINDEX        = 0xffff;
+
+	//
+	// DWARF.
+	//
+
+	enum : WORD
+	{
+		DW_TAG_array_type             = 0x01,
+		DW_TAG_class_type             = 0x02,
+		DW_TAG_enumeration_type       = 0x04,
+		DW_TAG_formal_parameter       = 0x05,
+		DW_TAG_member                 = 0x0d,
+		DW_TAG_pointer_type           = 0x0f,
+		DW_TAG_reference_type         = 0x10,
+		DW_TAG_compile_unit           = 0x11,
+		DW_TAG_structure_type         = 0x13,
+		DW_TAG_subroutine_type        = 0x15,
+		DW_TAG_typedef                = 0x16,
+		DW_TAG_union_type             = 0x17,
+		DW_TAG_ptr_to_member_type     = 0x1f,
+		DW_TAG_subrange_type          = 0x21,
+		DW_TAG_base_type              = 0x24,
+		DW_TAG_const_type             = 0x26,
+		DW_TAG_enumerator             = 0x28,
+		DW_TAG_packed_type            = 0x2d,
+		DW_TAG_subprogram             = 0x2e,
+		DW_TAG_volatile_type          = 0x35,
+		DW_TAG_restrict_type          = 0x37,
+		DW_TAG_namespace              = 0x39,
+		DW_TAG_unspecified_type       = 0x3b,
+		DW_TAG_partial_unit           = 0x3c,
+		DW_TAG_shared_type            = 0x40,
+		DW_TAG_type_unit              = 0x41,
+		DW_TAG_rvalue_reference_type  = 0x42,
+		DW_TAG_atomic_type            = 0x47,
+		DW_TAG_skeleton_unit          = 0x4a,
+		DW_TAG_immutable_type         = 0x4b,
+	};
+
+	enum : WORD
+	{
+		DW_AT_sibling                 = 0x01,
+		DW_AT_name                    = 0x03,
+		DW_AT_byte_size               = 0x0b,
+		DW_AT_bit_offset              = 0x0c,
+		DW_AT_bit_size                = 0x0d,
+		DW_AT_language                = 0x13,
+		DW_AT_const_value             = 0x1c,
+		DW_AT_lower_bound             = 0x22,
+		DW_AT_upper_bound             = 0x2f,
+		DW_AT_artificial              = 0x34,
+		DW_AT_count                   = 0x37,
+		DW_AT_data_member_location    = 0x38,
+		DW_AT_declaration             = 0x3c,
+		DW_AT_encoding                = 0x3e,
+		DW_AT_external                = 0x3f,
+		DW_AT_specification           = 0x47,
+		DW_AT_type                    = 0x49,
+		DW_AT_signature               = 0x69,
+		DW_AT_data_bit_offset         = 0x6b,
+		DW_AT_str_offsets_base        = 0x72,
+		DW_AT_dwo_name                = 0x76,
+		DW_AT_GNU_dwo_name            = 0x2130,
+	};
+
+	enum : WORD
+	{
+		DW_FORM_addr                  = 0x01,
+		DW_FORM_block2                = 0x03,
+		DW_FORM_block4                = 0x04,
+		DW_FORM_data2                 = 0x05,
+		DW_FORM_data4                 = 0x06,
+		DW_FORM_data8                 = 0x07,
+		DW_FORM_string                = 0x08,
+		DW_FORM_block                 = 0x09,
+		DW_FORM_block1                = 0x0a,
+		DW_FORM_data1                 = 0x0b,
+		DW_FORM_flag                  = 0x0c,
+		DW_FORM_sdata                 = 0x0d,
+		DW_FORM_strp                  = 0x0e,
+		DW_FORM_udata                 = 0x0f,
+		DW_FORM_ref_addr              = 0x10,
+		DW_FORM_ref1                  = 0x11,
+		DW_FORM_ref2                  = 0x12,
+		DW_FORM_ref4                  = 0x13,
+		DW_FORM_ref8                  = 0x14,
+		DW_FORM_ref_udata             = 0x15,
+		DW_FORM_indirect              = 0x16,
+		DW_FORM_sec_offset            = 0x17,
+		DW_FORM_exprloc               = 0x18,
+		DW_FORM_flag_present          = 0x19,
+		DW_FORM_strx                  = 0x1a,
+		DW_FORM_addrx                 = 0x1b,
+		DW_FORM_ref_sup4              = 0x1c,
+		DW_FORM_strp_sup              = 0x1d,
+		DW_FORM_data16                = 0x1e,
+		DW_FORM_line_strp             = 0x1f,
+		DW_FORM_ref_sig8              = 0x20,
+		DW_FORM_implicit_const        = 0x21,
+		DW_FORM_loclistx              = 0x22,
+		DW_FORM_rnglistx              = 0x23,
+		DW_FORM_ref_sup8              = 0x24,
+		DW_FORM_strx1                 = 0x25,
+		DW_FORM_strx2                 = 0x26,
+		DW_FORM_strx3                 = 0x27,
+		DW_FORM_strx4                 = 0x28,
+		DW_FORM_addrx1                = 0x29,
+		DW_FORM_addrx2                = 0x2a,
+		DW_FORM_addrx3                = 0x2b,
+		DW_FORM_addrx4                = 0x2c,
+		DW_FORM_GNU_addr_index        = 0x1f01,
+		DW_FORM_GNU_str_index         = 0x1f02,
+		DW_FORM_GNU_ref_alt           = 0x1f20,
+		DW_FORM_GNU_strp_alt          = 0x1f21,
+	};
+
+	enum : BYTE
+	{
+		DW_UT_compile                 = 0x01,
+		DW_UT_type                    = 0x02,
+		DW_UT_partial                 = 0x03,
+		DW_UT_skeleton                = 0x04,
+		DW_UT_split_compile           = 0x05,
+		DW_UT_split_type              = 0x06,
+	};
+
+	enum : BYTE
+	{
+		DW_ATE_address                = 0x01,
+		DW_ATE_boolean                = 0x02,
+		DW_ATE_float                  = 0x04,
+		DW_ATE_signed                 = 0x05,
+		DW_ATE_signed_char            = 0x06,
+		DW_ATE_unsigned               = 0x07,
+		DW_ATE_unsigned_char          = 0x08,
+		DW_ATE_UTF                    = 0x10,
+	};
+
+	enum : BYTE
+	{
+		DW_OP_constu                  = 0x10,
+		DW_OP_plus_uconst             = 0x23,
+		DW_OP_lit0                    = 0x30,
+		DW_OP_lit31                   = 0x4f,
+	};
+
+	static const WORD CxxLanguages[] = {
+		0x04, // DW_LANG_C_plus_plus
+		0x19, // DW_LANG_C_plus_plus_03
+		0x1a, // DW_LANG_C_plus_plus_11
+		0x21, // DW_LANG_C_plus_plus_14
+		0x2a, // DW_LANG_C_plus_plus_17
+		0x2b, // DW_LANG_C_plus_plus_20
+	};
+
+	static const char UnnamedTagName[] = "<unnamed-tag>";
+	static const char AnonymousNamespaceName[] = "`anonymous namespace'";
+
+	inline
+	ULONGLONG
+	ReadLittleEndian(
+		const BYTE* Data,
+		size_t Size
+		)
+	{
+		ULONGLONG Value = 0;
+
+		//
+		// Only the low 8 bytes of DW_FORM_data16 are kept.
+		//
+
+		for (size_t i = 0; i < Size && i < sizeof(Value); i++)
+		{
+			Value |= static_cast<ULONGLONG>(Data[i]) << (i * 8);
+		}
+
+		return Value;
+	}
+
+	inline
+	LONGLONG
+	SignExtend(
+		ULONGLONG Value,
+		size_t Size
+		)
+	{
+		if (Size == 0 || Size >= sizeof(Value))
+		{
+			return static_cast<LONGLONG>(Value);
+		}
+
+		ULONGLONG SignBit = 1ull << (Size * 8 - 1);
+
+		return static_cast<LONGLONG>((Value ^ SignBit) - SignBit);
+	}
+
+	//
+	// Bounds-checked reader of the DWARF data,
+	// Failed is set when the data are truncated.
+	//
+	struct Reader
+	{
+		const BYTE* Position;
+		const BYTE* End;
+		bool Failed;
+
+		Reader(
+			const BYTE* Begin,
+			const BYTE* End
+			)
+			: Position(Begin)
+			, End(End)
+			, Failed(false)
+		{
+
+		}
+
+		bool
+		Has(
+			ULONGLONG Size
+			)
+		{
+			if (static_cast<ULONGLONG>(End - Position) < Size)
+			{
+				Position = End;
+				Failed = true;
+				return false;
+			}
+
+			return true;
+		}
+
+		ULONGLONG
+		Fixed(
+			size_t Size
+			)
+		{
+			if (!Has(Size))
+			{
+				return 0;
+			}
+
+			ULONGLONG Value = ReadLittleEndian(Position, Size);
+			Position += Size;
+
+			return Value;
+		}
+
+		void
+		Skip(
+			ULONGLONG Size
+			)
+		{
+			if (Has(Size))
+			{
+				Position += Size;
+			}
+		}
+
+		ULONGLONG
+		Uleb()
+		{
+			ULONGLONG Value = 0;
+			DWORD Shift = 0;
+
+			while (Position < End)
+			{
+				BYTE Byte = *Position++;
+
+				if (Shift < 64)
+				{
+					Value |= static_cast<ULONGLONG>(Byte & 0x7f) << Shift;
+				}
+
+				Shift += 7;
+
+				if (!(Byte & 0x80))
+				{
+					return Value;
+				}
+			}
+
+			Failed = true;
+			return Value;
+		}
+
+		LONGLONG
+		Sleb()
+		{
+			ULONGLONG Value = 0;
+			DWORD Shift = 0;
+
+			while (Position < End)
+			{
+				BYTE Byte = *Position++;
+
+				if (Shift < 64)
+				{
+					Value |= static_cast<ULONGLONG>(Byte & 0x7f) << Shift;
+				}
+
+				Shift += 7;
+
+				if (!(Byte & 0x80))
+				{
+					if (Shift < 64 && (Byte & 0x40))
+					{
+						Value |= ~0ull << Shift;
+					}
+
+					return static_cast<LONGLONG>(Value);
+				}
+			}
+
+			Failed = true;
+			return static_cast<LONGLONG>(Value);
+		}
+
+		const char*
+		String()
+		{
+			const BYTE* Terminator = static_cast<const BYTE*>(memchr(Position, 0, End - Position));
+
+			if (Terminator == nullptr)
+			{
+				Position = End;
+				Failed = true;
+				return nullptr;
+			}
+
+			const char* Result = reinterpret_cast<const char*>(Position);
+			Position = Terminator + 1;
+
+			return Result;
+		}
+	};
+
+	//
+	// FNV-1a hash of the structure of the type.
+	//
+	struct Hasher
+	{
+		ULONGLONG Value = FNV_OFFSET_BASIS;
+
+		void
+		AddBytes(
+			const void* Data,
+			size_t Size
+			)
+		{
+			const BYTE* Bytes = static_cast<const BYTE*>(Data);
+
+			for (size_t i = 0; i < Size; i++)
+			{
+				Value = (Value ^ Bytes[i]) * FNV_PRIME;
+			}
+		}
+
+		void
+		AddNumber(
+			ULONGLONG Number
+			)
+		{
+			AddBytes(&Number, sizeof(Number));
+		}
+
+		void
+		AddString(
+			const char* Text
+			)
+		{
+			if (Text != nullptr)
+			{
+				AddBytes(Text, strlen(Text) + 1);
+			}
+			else
+			{
+				AddNumber(0);
+			}
+		}
+	};
+
+	struct AbbrevAttribute
+	{
+		WORD Name;
+		WORD Form;
+		LONGLONG ImplicitConst;
+	};
+
+	struct Abbrev
+	{
+		WORD Tag = 0;
+		bool HasChildren = false;
+
+		DWORD FirstAttribute = 0;
+		DWORD AttributeCount = 0;
+
+		//
+		// Size of all attributes if all of them have the fixed size, otherwise -1.
+		//
+		LONGLONG FixedSize = -1;
+	};
+
+	struct AbbrevTable
+	{
+		//
+		// Codes are usually assigned sequentially from 1.
+		//
+		std::vector<Abbrev> Abbrevs;
+		std::unordered_map<ULONGLONG, Abbrev> SparseAbbrevs;
+
+		std::vector<AbbrevAttribute> Attributes;
+
+		const Abbrev*
+		Find(
+			ULONGLONG Code
+			) const
+		{
+			if (Code < Abbrevs.size())
+			{
+				return Abbrevs[Code].Tag != 0 ? &Abbrevs[Code] : nullptr;
+			}
+
+			auto It = SparseAbbrevs.find(Code);
+			return It != SparseAbbrevs.end() ? &It->second : nullptr;
+		}
+	};
+
+	struct AttributeValue
+	{
+		enum class Kind
+		{
+			None,
+			Constant,
+			SignedConstant,
+			Reference,
+			Signature,
+			String,
+			Flag,
+			Block,
+		};
+
+		Kind Class;
+		ULONGLONG Value;
+
+		//
+		// Size of the DW_FORM_dataN.
+		//
+		BYTE Size;
+
+		const char* String;
+		const BYTE* Block;
+		size_t BlockSize;
+	};
+
+	//
+	// Returns size of the attribute of the form, or -1 if the size is variable.
+	//
+	LONGLONG
+	GetFixedFormSize(
+		WORD Form,
+		BYTE AddressSize,
+		BYTE OffsetSize,
+		WORD Version
+		)
+	{
+		switch (Form)
+		{
+			case DW_FORM_flag_present:
+			case DW_FORM_implicit_const:
+				return 0;
+
+			case DW_FORM_data1:
+			case DW_FORM_ref1:
+			case DW_FORM_flag:
+			case DW_FORM_strx1:
+			case DW_FORM_addrx1:
+				return 1;
+
+			case DW_FORM_data2:
+			case DW_FORM_ref2:
+			case DW_FORM_strx2:
+			case DW_FORM_addrx2:
+				return 2;
+
+			case DW_FORM_strx3:
+			case DW_FORM_addrx3:
+				return 3;
+
+			case DW_FORM_data4:
+			case DW_FORM_ref4:
+			case DW_FORM_ref_sup4:
+			case DW_FORM_strx4:
+			case DW_FORM_addrx4:
+				return 4;
+
+			case DW_FORM_data8:
+			case DW_FORM_ref8:
+			case DW_FORM_ref_sig8:
+			case DW_FORM_ref_sup8:
+				return 8;
+
+			case DW_FORM_data16:
+				return 16;
+
+			case DW_FORM_addr:
+				return AddressSize;
+
+			case DW_FORM_ref_addr:
+				return Version <= 2 ? AddressSize : OffsetSize;
+
+			case DW_FORM_strp:
+			case DW_FORM_sec_offset:
+			case DW_FORM_line_strp:
+			case DW_FORM_strp_sup:
+			case DW_FORM_GNU_ref_alt:
+			case DW_FORM_GNU_strp_alt:
+				return OffsetSize;
+
+			default:
+				return -1;
+		}
+	}
+
+	inline
+	bool
+	IsUdtTag(
+		WORD Tag
+		)
+	{
+		return Tag == DW_TAG_structure_type || Tag == DW_TAG_class_type || Tag == DW_TAG_union_type;
+	}
+
+	inline
+	bool
+	IsUdtOrEnumTag(
+		WORD Tag
+		)
+	{
+		return IsUdtTag(Tag) || Tag == DW_TAG_enumeration_type;
+	}
+
+	//
+	// Types which are resolved to their underlying type.
+	//
+	inline
+	bool
+	IsTransparentTag(
+		WORD Tag
+		)
+	{
+		switch (Tag)
+		{
+			case DW_TAG_typedef:
+			case DW_TAG_restrict_type:
+			case DW_TAG_atomic_type:
+			case DW_TAG_immutable_type:
+			case DW_TAG_packed_type:
+			case DW_TAG_shared_type:
+				return true;
+
+			default:
+				return false;
+		}
+	}
+
+	inline
+	bool
+	IsTypeTag(
+		WORD Tag
+		)
+	{
+		switch (Tag)
+		{
+			case DW_TAG_array_type:
+			case DW_TAG_class_type:
+			case DW_TAG_enumeration_type:
+			case DW_TAG_pointer_type:
+			case DW_TAG_reference_type:
+			case DW_TAG_structure_type:
+			case DW_TAG_subroutine_type:
+			case DW_TAG_union_type:
+			case DW_TAG_ptr_to_member_type:
+			case DW_TAG_base_type:
+			case DW_TAG_const_type:
+			case DW_TAG_volatile_type:
+			case DW_TAG_unspecified_type:
+			case DW_TAG_rvalue_reference_type:
+				return true;
+
+			default:
+				return IsTransparentTag(Tag);
+		}
+	}
+
+	//
+	// Members, enumerators, subranges of arrays and parameters of function types.
+	//
+	inline
+	bool
+	IsChildTag(
+		WORD Tag
+		)
+	{
+		return Tag == DW_TAG_member || Tag == DW_TAG_enumerator ||
+		       Tag == DW_TAG_subrange_type || Tag == DW_TAG_formal_parameter;
+	}
+
+	inline
+	bool
+	IsUnitTag(
+		WORD Tag
+		)
+	{
+		return Tag == DW_TAG_compile_unit || Tag == DW_TAG_partial_unit ||
+		       Tag == DW_TAG_type_unit || Tag == DW_TAG_skeleton_unit;
+	}
+
+	//
+	// Builds the key of the hash-consed symbol from its kind and properties.
+	//
+	std::string
+	MakeSymbolKey(
+		char Kind,
+		std::initializer_list<ULONGLONG> Properties
+		)
+	{
+		std::string Key(1, Kind);
+
+		for (auto&& Property : Properties)
+		{
+			Key.append(reinterpret_cast<const char*>(&Property), sizeof(Property));
+		}
+
+		return Key;
+	}
+
+	bool
+	Uncompress(
+		const BYTE* Data,
+		size_t Size,
+		std::vector<BYTE>& Output
+		)
+	{
+		//
+		// zlib header (RFC 1950), only the DEFLATE method is defined.
+		//
+
+		if (Size < 2 || (Data[0] & 0x0f) != 8)
+		{
+			return false;
+		}
+
+		std::istringstream Input(std::string(reinterpret_cast<const char*>(Data + 2), Size - 2));
+		std::ostringstream Decompressed;
+
+		ULONG Crc32 = 0;
+		ULONGLONG DecompressedSize = 0;
+
+		Inflate Decompressor(Input);
+
+		if (!Decompressor.Decompress(Decompressed, Crc32, DecompressedSize))
+		{
+			return false;
+		}
+
+		std::string Result = Decompressed.str();
+		Output.assign(Result.begin(), Result.end());
+
+		return true;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// UnitDecoder
+//
+
+class DwarfTypeLoader::UnitDecoder
+{
+	public:
+		UnitDecoder(
+			DwarfTypeLoader* Loader,
+			DWORD UnitIndex
+			);
+
+		void
+		Decode();
+
+	private:
+		struct Scope
+		{
+			//
+			// Index of the struct/union/enum/array/function node whose
+			// children are collected, or None.
+			//
+			DWORD NodeIndex;
+			DWORD LastChild;
+
+			size_t ScopeNameLength;
+
+			//
+			// Set inside of functions and unknown entries.
+			//
+			bool IsSkipped;
+		};
+
+		struct EntryAttributes
+		{
+			const char* Name;
+
+			ULONGLONG Type;
+			bool IsTypeSignature;
+
+			ULONGLONG Sibling;
+			ULONGLONG Specification;
+			ULONGLONG StrOffsetsBase;
+
+			ULONGLONG ByteSize;
+			ULONGLONG BitSize;
+			ULONGLONG BitOffset;
+			ULONGLONG DataBitOffset;
+			ULONGLONG Language;
+
+			LONGLONG MemberLocation;
+			LONGLONG LowerBound;
+			LONGLONG UpperBound;
+			LONGLONG Count;
+
+			AttributeValue ConstValue;
+
+			BYTE Encoding;
+
+			bool HasByteSize;
+			bool HasBitOffset;
+			bool HasDataBitOffset;
+			bool HasMemberLocation;
+			bool HasUpperBound;
+			bool HasCount;
+			bool HasLanguage;
+			bool HasStrOffsetsBase;
+			bool HasConstValue;
+			bool HasDwoName;
+
+			bool IsDeclaration;
+			bool IsExternal;
+			bool IsArtificial;
+		};
+
+		bool
+		ReadAbbrevTable();
+
+		bool
+		ReadAttribute(
+			Reader& EntryReader,
+			WORD Form,
+			LONGLONG ImplicitConst,
+			AttributeValue& Value
+			) const;
+
+		void
+		SkipAttributes(
+			Reader& EntryReader,
+			const Abbrev& EntryAbbrev
+			) const;
+
+		void
+		ReadAttributes(
+			Reader& EntryReader,
+			const Abbrev& EntryAbbrev,
+			EntryAttributes& Attributes
+			) const;
+
+		const char*
+		GetString(
+			const Section& StringSection,
+			ULONGLONG Offset
+			) const;
+
+		void
+		ReadEntries();
+
+		DWORD
+		AddNode(
+			ULONGLONG Key,
+			WORD Tag,
+			const EntryAttributes& Attributes,
+			const std::string& ScopeName
+			);
+
+		DWORD
+		FindNode(
+			ULONGLONG Key
+			) const;
+
+		void
+		NameUnnamedTypes();
+
+		ULONGLONG
+		HashDefinition(
+			DWORD Index
+			);
+
+		void
+		HashType(
+			Hasher& TypeHasher,
+			ULONGLONG Key,
+			bool IsTypeSignature,
+			bool IsPointerTarget
+			);
+
+		void
+		RetainDefinition(
+			DWORD Index
+			);
+
+		void
+		RetainType(
+			ULONGLONG Key,
+			bool IsTypeSignature
+			);
+
+		void
+		Compact();
+
+	private:
+		DwarfTypeLoader* m_Loader;
+		DWORD m_UnitIndex;
+		Unit& m_Unit;
+
+		AbbrevTable m_Abbrevs;
+		ULONGLONG m_StrOffsetsBase;
+
+		std::vector<Node> m_Nodes;
+		std::deque<std::string> m_Strings;
+};
+
+DwarfTypeLoader::UnitDecoder::UnitDecoder(
+	DwarfTypeLoader* Loader,
+	DWORD UnitIndex
+	)
+	: m_Loader(Loader)
+	, m_UnitIndex(UnitIndex)
+	, m_Unit(Loader->m_Units[UnitIndex])
+{
+	//
+	// The first contribution of the .debug_str_offsets starts behind its header,
+	// DW_AT_str_offsets_base of the unit overrides it.
+	//
+
+	m_StrOffsetsBase = m_Unit.OffsetSize == 8 ? 16 : 8;
+}
+
+void
+DwarfTypeLoader::UnitDecoder::Decode()
+{
+	if (!ReadAbbrevTable())
+	{
+		return;
+	}
+
+	ReadEntries();
+	NameUnnamedTypes();
+
+	for (DWORD i = 0; i < m_Nodes.size(); i++)
+	{
+		Node& Definition = m_Nodes[i];
+
+		if (IsUdtOrEnumTag(Definition.Tag) && !(Definition.Flags & (Node::IsDeclaration | Node::IsTypeSignature)))
+		{
+			HashDefinition(i);
+			m_Loader->ClaimDefinition(m_UnitIndex, Definition);
+		}
+	}
+
+	for (DWORD i = 0; i < m_Nodes.size(); i++)
+	{
+		if (m_Nodes[i].Flags & Node::IsClaimed)
+		{
+			RetainDefinition(i);
+		}
+	}
+
+	//
+	// Type units are referenced by their signature.
+	//
+
+	if (m_Unit.TypeKey != 0)
+	{
+		RetainType(m_Unit.TypeKey, false);
+	}
+
+	Compact();
+}
+
+bool
+DwarfTypeLoader::UnitDecoder::ReadAbbrevTable()
+{
+	const Section& AbbrevSection = m_Loader->m_Sections[DebugAbbrev];
+
+	if (m_Unit.AbbrevOffset >= AbbrevSection.Size)
+	{
+		return false;
+	}
+
+	Reader AbbrevReader(AbbrevSection.Data + m_Unit.AbbrevOffset, AbbrevSection.Data + AbbrevSection.Size);
+
+	for (;;)
+	{
+		ULONGLONG Code = AbbrevReader.Uleb();
+
+		if (AbbrevReader.Failed)
+		{
+			return false;
+		}
+
+		if (Code == 0)
+		{
+			break;
+		}
+
+		Abbrev Entry;
+		Entry.Tag = static_cast<WORD>(AbbrevReader.Uleb());
+		Entry.HasChildren = AbbrevReader.Fixed(1) != 0;
+		Entry.FirstAttribute = static_cast<DWORD>(m_Abbrevs.Attributes.size());
+		Entry.FixedSize = 0;
+
+		for (;;)
+		{
+			AbbrevAttribute Attribute;
+			Attribute.Name = static_cast<WORD>(AbbrevReader.Uleb());
+			Attribute.Form = static_cast<WORD>(AbbrevReader.Uleb());
+			Attribute.ImplicitConst = Attribute.Form == DW_FORM_implicit_const ? AbbrevReader.Sleb() : 0;
+
+			if (AbbrevReader.Failed)
+			{
+				return false;
+			}
+
+			if (Attribute.Name == 0 && Attribute.Form == 0)
+			{
+				break;
+			}
+
+			LONGLONG Size = GetFixedFormSize(Attribute.Form, m_Unit.AddressSize, m_Unit.OffsetSize, m_Unit.Version);
+
+			Entry.FixedSize = (Size < 0 || Entry.FixedSize < 0) ? -1 : Entry.FixedSize + Size;
+
+			m_Abbrevs.Attributes.push_back(Attribute);
+		}
+
+		Entry.AttributeCount = static_cast<DWORD>(m_Abbrevs.Attributes.size()) - Entry.FirstAttribute;
+
+		if (Entry.Tag == 0)
+		{
+			continue;
+		}
+
+		if (Code < 64 * 1024)
+		{
+			if (Code >= m_Abbrevs.Abbrevs.size())
+			{
+				m_Abbrevs.Abbrevs.resize(static_cast<size_t>(Code) + 1);
+			}
+
+			m_Abbrevs.Abbrevs[static_cast<size_t>(Code)] = Entry;
+		}
+		else
+		{
+			m_Abbrevs.SparseAbbrevs[Code] = Entry;
+		}
+	}
+
+	return true;
+}
+
+const char*
+DwarfTypeLoader::UnitDecoder::GetString(
+	const Section& StringSection,
+	ULONGLONG Offset
+	) const
+{
+	if (Offset >= StringSection.Size)
+	{
+		return nullptr;
+	}
+
+	const char* String = reinterpret_cast<const char*>(StringSection.Data + Offset);
+
+	//
+	// The string must be terminated inside of the section.
+	//
+
+	return memchr(String, 0, static_cast<size_t>(StringSection.Size - Offset)) ? String : nullptr;
+}
+
+bool
+DwarfTypeLoader::UnitDecoder::ReadAttribute(
+	Reader& EntryReader,
+	WORD Form,
+	LONGLONG ImplicitConst,
+	AttributeValue& Value
+	) const
+{
+	Value.Class = AttributeValue::Kind::None;
+	Value.Value = 0;
+	Value.Size = 0;
+
+	switch (Form)
+	{
+		case DW_FORM_data1:
+		case DW_FORM_data2:
+		case DW_FORM_data4:
+		case DW_FORM_data8:
+			Value.Size = Form == DW_FORM_data1 ? 1 : Form == DW_FORM_data2 ? 2 : Form == DW_FORM_data4 ? 4 : 8;
+			Value.Class = AttributeValue::Kind::Constant;
+			Value.Value = EntryReader.Fixed(Value.Size);
+			break;
+
+		case DW_FORM_udata:
+			Value.Class = AttributeValue::Kind::Constant;
+			Value.Value = EntryReader.Uleb();
+			break;
+
+		case DW_FORM_sdata:
+			Value.Class = AttributeValue::Kind::SignedConstant;
+			Value.Value = static_cast<ULONGLONG>(EntryReader.Sleb());
+			break;
+
+		case DW_FORM_implicit_const:
+			Value.Class = AttributeValue::Kind::SignedConstant;
+			Value.Value = static_cast<ULONGLONG>(ImplicitConst);
+			break;
+
+		case DW_FORM_ref1:
+		case DW_FORM_ref2:
+		case DW_FORM_ref4:
+		case DW_FORM_ref8:
+			Value.Class = AttributeValue::Kind::Reference;
+			Value.Value = m_Unit.Key + EntryReader.Fixed(Form == DW_FORM_ref1 ? 1 : Form == DW_FORM_ref2 ? 2 : Form == DW_FORM_ref4 ? 4 : 8);
+			break;
+
+		case DW_FORM_ref_udata:
+			Value.Class = AttributeValue::Kind::Reference;
+			Value.Value = m_Unit.Key + EntryReader.Uleb();
+			break;
+
+		case DW_FORM_ref_addr:
+			//
+			// Offset in the .debug_info, even if the unit is in the .debug_types.
+			//
+			Value.Class = AttributeValue::Kind::Reference;
+			Value.Value = EntryReader.Fixed(m_Unit.Version <= 2 ? m_Unit.AddressSize : m_Unit.OffsetSize);
+			break;
+
+		case DW_FORM_ref_sig8:
+			Value.Class = AttributeValue::Kind::Signature;
+			Value.Value = EntryReader.Fixed(8);
+			break;
+
+		case DW_FORM_string:
+			Value.Class = AttributeValue::Kind::String;
+			Value.String = EntryReader.String();
+			break;
+
+		case DW_FORM_strp:
+		case DW_FORM_line_strp:
+		{
+			const Section& StringSection = m_Loader->m_Sections[Form == DW_FORM_strp ? DebugStr : DebugLineStr];
+
+			Value.Class = AttributeValue::Kind::String;
+			Value.String = GetString(StringSection, EntryReader.Fixed(m_Unit.OffsetSize));
+			break;
+		}
+
+		case DW_FORM_strx:
+		case DW_FORM_GNU_str_index:
+		case DW_FORM_strx1:
+		case DW_FORM_strx2:
+		case DW_FORM_strx3:
+		case DW_FORM_strx4:
+		{
+			ULONGLONG Index =
+				Form == DW_FORM_strx1 ? EntryReader.Fixed(1) :
+				Form == DW_FORM_strx2 ? EntryReader.Fixed(2) :
+				Form == DW_FORM_strx3 ? EntryReader.Fixed(3) :
+				Form == DW_FORM_strx4 ? EntryReader.Fixed(4) :
+				                        EntryReader.Uleb();
+
+			const Section& OffsetsSection = m_Loader->m_Sections[DebugStrOffsets];
+			ULONGLONG Offset = m_StrOffsetsBase + Index * m_Unit.OffsetSize;
+
+			Value.Class = AttributeValue::Kind::String;
+			Value.String = Offset + m_Unit.OffsetSize <= OffsetsSection.Size
+				? GetString(m_Loader->m_Sections[DebugStr], ReadLittleEndian(OffsetsSection.Data + Offset, m_Unit.OffsetSize))
+				: nullptr;
+			break;
+		}
+
+		case DW_FORM_flag:
+			Value.Class = AttributeValue::Kind::Flag;
+			Value.Value = EntryReader.Fixed(1);
+			break;
+
+		case DW_FORM_flag_present:
+			Value.Class = AttributeValue::Kind::Flag;
+			Value.Value = 1;
+			break;
+
+		case DW_FORM_block1:
+		case DW_FORM_block2:
+		case DW_FORM_block4:
+		case DW_FORM_block:
+		case DW_FORM_exprloc:
+			Value.Class = AttributeValue::Kind::Block;
+			Value.BlockSize = static_cast<size_t>(
+				Form == DW_FORM_block1 ? EntryReader.Fixed(1) :
+				Form == DW_FORM_block2 ? EntryReader.Fixed(2) :
+				Form == DW_FORM_block4 ? EntryReader.Fixed(4) :
+				                         EntryReader.Uleb());
+			Value.Block = EntryReader.Position;
+			EntryReader.Skip(Value.BlockSize);
+			break;
+
+		case DW_FORM_indirect:
+		{
+			WORD IndirectForm = static_cast<WORD>(EntryReader.Uleb());
+
+			if (IndirectForm == DW_FORM_indirect || IndirectForm == DW_FORM_implicit_const)
+			{
+				return false;
+			}
+
+			return ReadAttribute(EntryReader, IndirectForm, 0, Value);
+		}
+
+		case DW_FORM_addrx:
+		case DW_FORM_loclistx:
+		case DW_FORM_rnglistx:
+		case DW_FORM_GNU_addr_index:
+			EntryReader.Uleb();
+			break;
+
+		default:
+		{
+			//
+			// Addresses, section offsets and references to the supplementary files.
+			//
+
+			LONGLONG Size = GetFixedFormSize(Form, m_Unit.AddressSize, m_Unit.OffsetSize, m_Unit.Version);
+
+			if (Size < 0)
+			{
+				return false;
+			}
+
+			Value.Value = EntryReader.Fixed(static_cast<size_t>(Size));
+			break;
+		}
+	}
+
+	return !EntryReader.Failed;
+}
+
+void
+DwarfTypeLoader::UnitDecoder::SkipAttributes(
+	Reader& EntryReader,
+	const Abbrev& EntryAbbrev
+	) const
+{
+	if (EntryAbbrev.FixedSize >= 0)
+	{
+		EntryReader.Skip(EntryAbbrev.FixedSize);
+		return;
+	}
+
+	AttributeValue Value;
+
+	for (DWORD i = 0; i < EntryAbbrev.AttributeCount && !EntryReader.Failed; i++)
+	{
+		const AbbrevAttribute& Attribute = m_Abbrevs.Attributes[EntryAbbrev.FirstAttribute + i];
+
+		switch (Attribute.Form)
+		{
+			case DW_FORM_string:
+				EntryReader.String();
+				break;
+
+			case DW_FORM_udata:
+			case DW_FORM_sdata:
+			case DW_FORM_ref_udata:
+			case DW_FORM_strx:
+			case DW_FORM_addrx:
+			case DW_FORM_loclistx:
+			case DW_FORM_rnglistx:
+			case DW_FORM_GNU_addr_index:
+			case DW_FORM_GNU_str_index:
+				EntryReader.Uleb();
+				break;
+
+			default:
+			{
+				LONGLONG Size = GetFixedFormSize(Attribute.Form, m_Unit.AddressSize, m_Unit.OffsetSize, m_Unit.Version);
+
+				if (Size >= 0)
+				{
+					EntryReader.Skip(Size);
+				}
+				else if (!ReadAttribute(EntryReader, Attribute.Form, Attribute.ImplicitConst, Value))
+				{
+					EntryReader.Failed = true;
+				}
+				break;
+			}
+		}
+	}
+}
+
+void
+DwarfTypeLoader::UnitDecoder::ReadAttributes(
+	Reader& EntryReader,
+	const Abbrev& EntryAbbrev,
+	EntryAttributes& Attributes
+	) const
+{
+	memset(&Attributes, 0, sizeof(Attributes));
+
+	AttributeValue Value;
+
+	//
+	// data_member_location, upper_bound etc. may be a constant or an expression.
+	// DW_FORM_dataN does not say whether the constant is signed, offsets
+	// are unsigned and bounds of the arrays are signed.
+	//
+
+	auto GetConstant = [&Value](LONGLONG& Result, bool IsSigned) {
+		switch (Value.Class)
+		{
+			case AttributeValue::Kind::Constant:
+				Result = IsSigned ? SignExtend(Value.Value, Value.Size) : static_cast<LONGLONG>(Value.Value);
+				return true;
+
+			case AttributeValue::Kind::SignedConstant:
+				Result = static_cast<LONGLONG>(Value.Value);
+				return true;
+
+			case AttributeValue::Kind::Block:
+			{
+				//
+				// DW_OP_plus_uconst <offset>, used by DWARF 2 and 3 for member locations.
+				//
+
+				Reader Expression(Value.Block, Value.Block + Value.BlockSize);
+
+				if (Value.BlockSize == 0)
+				{
+					return false;
+				}
+
+				BYTE Operation = static_cast<BYTE>(Expression.Fixed(1));
+
+				if (Operation == DW_OP_plus_uconst || Operation == DW_OP_constu)
+				{
+					Result = static_cast<LONGLONG>(Expression.Uleb());
+				}
+				else if (Operation >= DW_OP_lit0 && Operation <= DW_OP_lit31)
+				{
+					Result = Operation - DW_OP_lit0;
+				}
+				else
+				{
+					return false;
+				}
+
+				return !Expression.Failed && Expression.Position == Expression.End;
+			}
+
+			default:
+				return false;
+		}
+	};
+
+	for (DWORD i = 0; i < EntryAbbrev.AttributeCount; i++)
+	{
+		const AbbrevAttribute& Attribute = m_Abbrevs.Attributes[EntryAbbrev.FirstAttribute + i];
+
+		if (!ReadAttribute(EntryReader, Attribute.Form, Attribute.ImplicitConst, Value))
+		{
+			EntryReader.Failed = true;
+			return;
+		}
+
+		bool IsConstant = Value.Class == AttributeValue::Kind::Constant ||
+		                  Value.Class == AttributeValue::Kind::SignedConstant;
+
+		switch (Attribute.Name)
+		{
+			case DW_AT_name:
+				Attributes.Name = Value.Class == AttributeValue::Kind::String ? Value.String : nullptr;
+				break;
+
+			case DW_AT_type:
+			case DW_AT_signature:
+				if (Value.Class == AttributeValue::Kind::Reference || Value.Class == AttributeValue::Kind::Signature)
+				{
+					Attributes.Type = Value.Value;
+					Attributes.IsTypeSignature = Value.Class == AttributeValue::Kind::Signature;
+				}
+				break;
+
+			case DW_AT_sibling:
+				Attributes.Sibling = Value.Class == AttributeValue::Kind::Reference ? Value.Value : 0;
+				break;
+
+			case DW_AT_specification:
+				Attributes.Specification = Value.Class == AttributeValue::Kind::Reference ? Value.Value : 0;
+				break;
+
+			case DW_AT_str_offsets_base:
+				Attributes.StrOffsetsBase = Value.Value;
+				Attributes.HasStrOffsetsBase = true;
+				break;
+
+			case DW_AT_byte_size:
+				Attributes.ByteSize = Value.Value;
+				Attributes.HasByteSize = IsConstant;
+				break;
+
+			case DW_AT_bit_size:
+				Attributes.BitSize = IsConstant ? Value.Value : 0;
+				break;
+
+			case DW_AT_bit_offset:
+				Attributes.BitOffset = Value.Value;
+				Attributes.HasBitOffset = IsConstant;
+				break;
+
+			case DW_AT_data_bit_offset:
+				Attributes.DataBitOffset = Value.Value;
+				Attributes.HasDataBitOffset = IsConstant;
+				break;
+
+			case DW_AT_language:
+				Attributes.Language = Value.Value;
+				Attributes.HasLanguage = IsConstant;
+				break;
+
+			case DW_AT_dwo_name:
+			case DW_AT_GNU_dwo_name:
+				Attributes.HasDwoName = true;
+				break;
+
+			case DW_AT_encoding:
+				Attributes.Encoding = static_cast<BYTE>(Value.Value);
+				break;
+
+			case DW_AT_data_member_location:
+				Attributes.HasMemberLocation = GetConstant(Attributes.MemberLocation, false);
+				break;
+
+			case DW_AT_lower_bound:
+				GetConstant(Attributes.LowerBound, true);
+				break;
+
+			case DW_AT_upper_bound:
+				Attributes.HasUpperBound = GetConstant(Attributes.UpperBound, true);
+				break;
+
+			case DW_AT_count:
+				Attributes.HasCount = GetConstant(Attributes.Count, false);
+				break;
+
+			case DW_AT_const_value:
+				Attributes.ConstValue = Value;
+				Attributes.HasConstValue = IsConstant;
+				break;
+
+			case DW_AT_declaration:
+				Attributes.IsDeclaration = Value.Value != 0;
+				break;
+
+			case DW_AT_external:
+				Attributes.IsExternal = Value.Value != 0;
+				break;
+
+			case DW_AT_artificial:
+				Attributes.IsArtificial = Value.Value != 0;
+				break;
+		}
+	}
+}
+
+void
+DwarfTypeLoader::UnitDecoder::ReadEntries()
+{
+	Reader EntryReader(m_Unit.FirstEntry, m_Unit.End);
+
+	std::vector<Scope> Scopes;
+	std::string ScopeName;
+
+	EntryAttributes Attributes;
+
+	while (EntryReader.Position < EntryReader.End && !EntryReader.Failed)
+	{
+		ULONGLONG Key = m_Unit.Key + static_cast<ULONGLONG>(EntryReader.Position - m_Unit.Begin);
+		ULONGLONG Code = EntryReader.Uleb();
+
+		if (Code == 0)
+		{
+			//
+			// End of the children (or padding at the end of the unit).
+			//
+
+			if (!Scopes.empty())
+			{
+				ScopeName.resize(Scopes.back().ScopeNameLength);
+				Scopes.pop_back();
+			}
+
+			continue;
+		}
+
+		const Abbrev* EntryAbbrev = m_Abbrevs.Find(Code);
+
+		if (EntryAbbrev == nullptr)
+		{
+			break;
+		}
+
+		WORD Tag = EntryAbbrev->Tag;
+
+		Scope* Parent = Scopes.empty() ? nullptr : &Scopes.back();
+		bool IsSkipped = Parent != nullptr && Parent->IsSkipped;
+
+		bool IsChild = IsChildTag(Tag) && Parent != nullptr && Parent->NodeIndex != Node::None;
+		bool IsNode = !IsSkipped && (IsTypeTag(Tag) || IsChild);
+		bool IsScope = !IsSkipped && (IsUnitTag(Tag) || Tag == DW_TAG_namespace || Tag == DW_TAG_subprogram);
+
+		if (!IsNode && !IsScope)
+		{
+			SkipAttributes(EntryReader, *EntryAbbrev);
+
+			if (EntryAbbrev->HasChildren)
+			{
+				Scopes.push_back({ Node::None, Node::None, ScopeName.size(), true });
+			}
+
+			continue;
+		}
+
+		ReadAttributes(EntryReader, *EntryAbbrev, Attributes);
+
+		if (EntryReader.Failed)
+		{
+			break;
+		}
+
+		if (IsUnitTag(Tag))
+		{
+			if (Attributes.HasLanguage)
+			{
+				m_Unit.IsCxx = std::find(std::begin(CxxLanguages), std::end(CxxLanguages), Attributes.Language) != std::end(CxxLanguages);
+			}
+
+			if (Attributes.HasStrOffsetsBase)
+			{
+				m_StrOffsetsBase = Attributes.StrOffsetsBase;
+			}
+
+			//
+			// Skeleton units of the split DWARF (DWARF 5 or the GNU extension
+			// of DWARF 4) only name the .dwo file with the types.
+			//
+
+			if (Tag == DW_TAG_skeleton_unit || Attributes.HasDwoName)
+			{
+				m_Unit.IsSkeleton = true;
+			}
+
+			if (EntryAbbrev->HasChildren)
+			{
+				Scopes.push_back({ Node::None, Node::None, ScopeName.size(), false });
+			}
+
+			continue;
+		}
+
+		if (Tag == DW_TAG_namespace)
+		{
+			if (EntryAbbrev->HasChildren)
+			{
+				Scopes.push_back({ Node::None, Node::None, ScopeName.size(), false });
+
+				if (m_Unit.IsCxx)
+				{
+					ScopeName += Attributes.Name ? Attributes.Name : AnonymousNamespaceName;
+					ScopeName += "::";
+				}
+			}
+
+			continue;
+		}
+
+		if (Tag == DW_TAG_subprogram)
+		{
+			//
+			// Types declared inside of the function are not loaded,
+			// its children are skipped at once if the sibling is known.
+			//
+
+			if (EntryAbbrev->HasChildren)
+			{
+				if (Attributes.Sibling > Key && Attributes.Sibling < m_Unit.EndKey)
+				{
+					EntryReader.Position = m_Unit.Begin + (Attributes.Sibling - m_Unit.Key);
+				}
+				else
+				{
+					Scopes.push_back({ Node::None, Node::None, ScopeName.size(), true });
+				}
+			}
+
+			continue;
+		}
+
+		DWORD Index = AddNode(Key, Tag, Attributes, ScopeName);
+
+		if (IsChild)
+		{
+			if (Parent->LastChild == Node::None)
+			{
+				m_Nodes[Parent->NodeIndex].FirstChild = Index;
+			}
+			else
+			{
+				m_Nodes[Parent->LastChild].NextSibling = Index;
+			}
+
+			Parent->LastChild = Index;
+		}
+
+		if (EntryAbbrev->HasChildren)
+		{
+			bool IsContainer = IsUdtOrEnumTag(Tag) || Tag == DW_TAG_array_type || Tag == DW_TAG_subroutine_type;
+
+			Scopes.push_back({ IsContainer ? Index : Node::None, Node::None, ScopeName.size(), false });
+
+			if (IsUdtTag(Tag) && m_Unit.IsCxx && Attributes.Name)
+			{
+				ScopeName += Attributes.Name;
+				ScopeName += "::";
+			}
+		}
+	}
+}
+
+DWORD
+DwarfTypeLoader::UnitDecoder::AddNode(
+	ULONGLONG Key,
+	WORD Tag,
+	const EntryAttributes& Attributes,
+	const std::string& ScopeName
+	)
+{
+	DWORD Index = static_cast<DWORD>(m_Nodes.size());
+
+	m_Nodes.emplace_back();
+	Node& Entry = m_Nodes.back();
+
+	memset(&Entry, 0, sizeof(Entry));
+
+	Entry.Key = Key;
+	Entry.Tag = Tag;
+	Entry.Name = Attributes.Name;
+	Entry.Type = Attributes.Type;
+	Entry.Size = static_cast<DWORD>(Attributes.ByteSize);
+	Entry.Encoding = Attributes.Encoding;
+	Entry.FirstChild = Node::None;
+	Entry.NextSibling = Node::None;
+
+	if (Attributes.IsTypeSignature)
+	{
+		Entry.Flags |= Node::IsTypeSignature;
+	}
+
+	switch (Tag)
+	{
+		case DW_TAG_member:
+			//
+			// Static members are declarations (DWARF 4) or DW_TAG_variable (DWARF 5).
+			//
+
+			if (Attributes.IsExternal || Attributes.IsDeclaration)
+			{
+				Entry.Flags |= Node::IsStaticMember;
+			}
+
+			if (Attributes.IsArtificial)
+			{
+				Entry.Flags |= Node::IsArtificial;
+			}
+
+			if (Attributes.HasMemberLocation)
+			{
+				Entry.Value = Attributes.MemberLocation;
+				Entry.Flags |= Node::HasMemberLocation;
+			}
+
+			Entry.BitSize = static_cast<DWORD>(Attributes.BitSize);
+
+			if (Attributes.HasDataBitOffset)
+			{
+				Entry.BitOffset = Attributes.DataBitOffset;
+				Entry.Flags |= Node::HasDataBitOffset;
+			}
+			else if (Attributes.HasBitOffset)
+			{
+				Entry.BitOffset = Attributes.BitOffset;
+				Entry.Flags |= Node::HasBitOffset;
+			}
+			break;
+
+		case DW_TAG_enumerator:
+			if (Attributes.HasConstValue)
+			{
+				Entry.Value = static_cast<LONGLONG>(Attributes.ConstValue.Value);
+				Entry.ValueSize = Attributes.ConstValue.Size;
+
+				if (Attributes.ConstValue.Class == AttributeValue::Kind::SignedConstant)
+				{
+					Entry.Flags |= Node::IsSignedValue;
+				}
+			}
+			break;
+
+		case DW_TAG_subrange_type:
+			if (Attributes.HasCount)
+			{
+				Entry.Value = Attributes.Count;
+				Entry.Flags |= Node::HasCount;
+			}
+			else if (Attributes.HasUpperBound && Attributes.UpperBound >= Attributes.LowerBound)
+			{
+				//
+				// Zero-length arrays have the upper bound -1.
+				//
+
+				Entry.Value = Attributes.UpperBound - Attributes.LowerBound + 1;
+				Entry.Flags |= Node::HasCount;
+			}
+			break;
+
+		default:
+			if (IsUdtOrEnumTag(Tag))
+			{
+				if (Attributes.IsDeclaration)
+				{
+					Entry.Flags |= Node::IsDeclaration;
+				}
+
+				if (Attributes.Specification != 0)
+				{
+					Entry.Value = static_cast<LONGLONG>(Attributes.Specification);
+					Entry.Flags |= Node::HasSpecification;
+				}
+			}
+
+			//
+			// Names of the types are qualified by the namespaces and classes.
+			//
+
+			if (Entry.Name != nullptr && !ScopeName.empty() && Tag != DW_TAG_base_type)
+			{
+				m_Strings.push_back(ScopeName + Entry.Name);
+
+				Entry.Name = m_Strings.back().c_str();
+				Entry.Flags |= Node::HasLocalName;
+			}
+			break;
+	}
+
+	return Index;
+}
+
+DWORD
+DwarfTypeLoader::UnitDecoder::FindNode(
+	ULONGLONG Key
+	) const
+{
+	auto It = std::lower_bound(m_Nodes.begin(), m_Nodes.end(), Key, [](const Node& Entry, ULONGLONG Key) {
+		return Entry.Key < Key;
+	});
+
+	return It != m_Nodes.end() && It->Key == Key ? static_cast<DWORD>(It - m_Nodes.begin()) : Node::None;
+}
+
+void
+DwarfTypeLoader::UnitDecoder::NameUnnamedTypes()
+{
+	//
+	// Out-of-class definitions (struct A::B { ... }) take the name of the declaration.
+	//
+
+	for (auto&& Entry : m_Nodes)
+	{
+		if ((Entry.Flags & Node::HasSpecification) && Entry.Name == nullptr)
+		{
+			DWORD Index = FindNode(static_cast<ULONGLONG>(Entry.Value));
+
+			if (Index != Node::None && m_Nodes[Index].Name != nullptr)
+			{
+				Entry.Name = m_Nodes[Index].Name;
+				Entry.Flags |= m_Nodes[Index].Flags & Node::HasLocalName;
+			}
+		}
+	}
+
+	//
+	// typedef struct { ... } foo_t;
+	//
+
+	for (auto&& Entry : m_Nodes)
+	{
+		if (Entry.Tag != DW_TAG_typedef || Entry.Name == nullptr)
+		{
+			continue;
+		}
+
+		if (Entry.Flags & Node::IsTypeSignature)
+		{
+			m_Unit.SignatureTypedefs.emplace_back(Entry.Type, Entry.Name);
+			continue;
+		}
+
+		DWORD Index = FindNode(Entry.Type);
+
+		if (Index == Node::None)
+		{
+			continue;
+		}
+
+		Node& Type = m_Nodes[Index];
+
+		if (IsUdtOrEnumTag(Type.Tag) && Type.Name == nullptr && !(Type.Flags & Node::IsDeclaration))
+		{
+			Type.Name = Entry.Name;
+			Type.Flags |= Node::HasTypedefName | (Entry.Flags & Node::HasLocalName);
+		}
+	}
+}
+
+ULONGLONG
+DwarfTypeLoader::UnitDecoder::HashDefinition(
+	DWORD Index
+	)
+{
+	Node& Definition = m_Nodes[Index];
+
+	if (Definition.Flags & Node::IsHashed)
+	{
+		return Definition.Hash;
+	}
+
+	//
+	// Set before the members are hashed, malformed types may contain themselves.
+	//
+
+	Definition.Flags |= Node::IsHashed;
+	Definition.Hash = 0;
+
+	Hasher TypeHasher;
+	TypeHasher.AddNumber(Definition.Tag);
+	TypeHasher.AddString(Definition.Name);
+	TypeHasher.AddNumber(Definition.Size);
+
+	if (Definition.Tag == DW_TAG_enumeration_type)
+	{
+		HashType(TypeHasher, Definition.Type, (Definition.Flags & Node::IsTypeSignature) != 0, false);
+	}
+
+	for (DWORD ChildIndex = Definition.FirstChild; ChildIndex != Node::None; ChildIndex = m_Nodes[ChildIndex].NextSibling)
+	{
+		const Node& Child = m_Nodes[ChildIndex];
+
+		TypeHasher.AddNumber(Child.Tag);
+		TypeHasher.AddString(Child.Name);
+		TypeHasher.AddNumber(static_cast<ULONGLONG>(Child.Value));
+		TypeHasher.AddNumber(Child.Flags & (Node::HasMemberLocation | Node::HasDataBitOffset | Node::HasBitOffset |
+		                                    Node::IsSignedValue | Node::IsStaticMember | Node::IsArtificial));
+
+		if (Child.Tag == DW_TAG_member)
+		{
+			TypeHasher.AddNumber(Child.BitOffset);
+			TypeHasher.AddNumber(Child.BitSize);
+			TypeHasher.AddNumber(Child.Size);
+
+			HashType(TypeHasher, Child.Type, (Child.Flags & Node::IsTypeSignature) != 0, false);
+		}
+	}
+
+	m_Nodes[Index].Hash = TypeHasher.Value;
+
+	return TypeHasher.Value;
+}
+
+void
+DwarfTypeLoader::UnitDecoder::HashType(
+	Hasher& TypeHasher,
+	ULONGLONG Key,
+	bool IsTypeSignature,
+	bool IsPointerTarget
+	)
+{
+	//
+	// Named structs behind pointers are hashed by their names only,
+	// the same way as the symbol graph refers to them.
+	//
+
+	for (DWORD Depth = 0; ; Depth++)
+	{
+		if (Depth > 64)
+		{
+			TypeHasher.AddNumber('!');
+			return;
+		}
+
+		if (IsTypeSignature)
+		{
+			TypeHasher.AddNumber('G');
+			TypeHasher.AddNumber(Key);
+			return;
+		}
+
+		if (Key == 0)
+		{
+			TypeHasher.AddNumber('V');
+			return;
+		}
+
+		DWORD Index = FindNode(Key);
+
+		if (Index == Node::None)
+		{
+			//
+			// Reference to another unit.
+			//
+
+			TypeHasher.AddNumber('X');
+			TypeHasher.AddNumber(Key);
+			return;
+		}
+
+		const Node& Type = m_Nodes[Index];
+
+		IsTypeSignature = (Type.Flags & Node::IsTypeSignature) != 0;
+
+		if (IsTransparentTag(Type.Tag))
+		{
+			Key = Type.Type;
+			continue;
+		}
+
+		TypeHasher.AddNumber(Type.Tag);
+
+		switch (Type.Tag)
+		{
+			case DW_TAG_const_type:
+			case DW_TAG_volatile_type:
+				Key = Type.Type;
+				continue;
+
+			case DW_TAG_base_type:
+				TypeHasher.AddNumber(Type.Encoding);
+				TypeHasher.AddNumber(Type.Size);
+				TypeHasher.AddString(Type.Name);
+				return;
+
+			case DW_TAG_unspecified_type:
+				TypeHasher.AddString(Type.Name);
+				return;
+
+			case DW_TAG_pointer_type:
+			case DW_TAG_reference_type:
+			case DW_TAG_rvalue_reference_type:
+			case DW_TAG_ptr_to_member_type:
+				TypeHasher.AddNumber(Type.Size);
+				Key = Type.Type;
+				IsPointerTarget = true;
+				continue;
+
+			case DW_TAG_array_type:
+				for (DWORD ChildIndex = Type.FirstChild; ChildIndex != Node::None; ChildIndex = m_Nodes[ChildIndex].NextSibling)
+				{
+					TypeHasher.AddNumber(static_cast<ULONGLONG>(m_Nodes[ChildIndex].Value));
+					TypeHasher.AddNumber(m_Nodes[ChildIndex].Flags & Node::HasCount);
+				}
+
+				Key = Type.Type;
+				continue;
+
+			case DW_TAG_subroutine_type:
+				for (DWORD ChildIndex = Type.FirstChild; ChildIndex != Node::None; ChildIndex = m_Nodes[ChildIndex].NextSibling)
+				{
+					HashType(TypeHasher, m_Nodes[ChildIndex].Type, (m_Nodes[ChildIndex].Flags & Node::IsTypeSignature) != 0, false);
+				}
+
+				TypeHasher.AddNumber('R');
+				Key = Type.Type;
+				IsPointerTarget = false;
+				continue;
+
+			default:
+				//
+				// Struct, class, union or enum.
+				//
+
+				if (IsTypeSignature)
+				{
+					Key = Type.Type;
+					continue;
+				}
+
+				if ((IsPointerTarget || (Type.Flags & Node::IsDeclaration)) && Type.Name != nullptr)
+				{
+					TypeHasher.AddString(Type.Name);
+				}
+				else if (Type.Flags & Node::IsDeclaration)
+				{
+					TypeHasher.AddNumber('D');
+				}
+				else
+				{
+					TypeHasher.AddNumber(HashDefinition(Index));
+				}
+				return;
+		}
+	}
+}
+
+void
+DwarfTypeLoader::UnitDecoder::RetainDefinition(
+	DWORD Index
+	)
+{
+	m_Nodes[Index].Flags |= Node::IsRetained;
+
+	if (m_Nodes[Index].Tag == DW_TAG_enumeration_type)
+	{
+		RetainType(m_Nodes[Index].Type, (m_Nodes[Index].Flags & Node::IsTypeSignature) != 0);
+	}
+
+	for (DWORD ChildIndex = m_Nodes[Index].FirstChild; ChildIndex != Node::None; ChildIndex = m_Nodes[ChildIndex].NextSibling)
+	{
+		m_Nodes[ChildIndex].Flags |= Node::IsRetained;
+
+		RetainType(m_Nodes[ChildIndex].Type, (m_Nodes[ChildIndex].Flags & Node::IsTypeSignature) != 0);
+	}
+}
+
+void
+DwarfTypeLoader::UnitDecoder::RetainType(
+	ULONGLONG Key,
+	bool IsTypeSignature
+	)
+{
+	while (!IsTypeSignature && Key != 0)
+	{
+		DWORD Index = FindNode(Key);
+
+		if (Index == Node::None || (m_Nodes[Index].Flags & Node::IsRetained))
+		{
+			return;
+		}
+
+		Node& Type = m_Nodes[Index];
+		Type.Flags |= Node::IsRetained;
+
+		//
+		// Only the header of the struct/union/enum is needed,
+		// its definition is found by the hash or by the name.
+		//
+
+		if (IsUdtOrEnumTag(Type.Tag))
+		{
+			return;
+		}
+
+		for (DWORD ChildIndex = Type.FirstChild; ChildIndex != Node::None; ChildIndex = m_Nodes[ChildIndex].NextSibling)
+		{
+			m_Nodes[ChildIndex].Flags |= Node::IsRetained;
+
+			RetainType(m_Nodes[ChildIndex].Type, (m_Nodes[ChildIndex].Flags & Node::IsTypeSignature) != 0);
+		}
+
+		Key = Type.Type;
+		IsTypeSignature = (Type.Flags & Node::IsTypeSignature) != 0;
+	}
+}
+
+void
+DwarfTypeLoader::UnitDecoder::Compact()
+{
+	std::vector<DWORD> NewIndices(m_Nodes.size(), Node::None);
+	DWORD RetainedCount = 0;
+
+	for (DWORD i = 0; i < m_Nodes.size(); i++)
+	{
+		if (m_Nodes[i].Flags & Node::IsRetained)
+		{
+			NewIndices[i] = RetainedCount++;
+		}
+	}
+
+	auto NextRetained = [this, &NewIndices](DWORD Index) {
+		while (Index != Node::None && NewIndices[Index] == Node::None)
+		{
+			Index = m_Nodes[Index].NextSibling;
+		}
+
+		return Index != Node::None ? NewIndices[Index] : Node::None;
+	};
+
+	m_Unit.Nodes.reserve(RetainedCount);
+
+	for (DWORD i = 0; i < m_Nodes.size(); i++)
+	{
+		if (NewIndices[i] == Node::None)
+		{
+			continue;
+		}
+
+		Node Entry = m_Nodes[i];
+
+		Entry.FirstChild = NextRetained(Entry.FirstChild);
+		Entry.NextSibling = NextRetained(Entry.NextSibling);
+
+		if (Entry.Flags & Node::HasLocalName)
+		{
+			m_Unit.Strings.push_back(Entry.Name);
+			Entry.Name = m_Unit.Strings.back().c_str();
+		}
+
+		m_Unit.Nodes.push_back(Entry);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// DwarfTypeLoader
+//
+
+const DWORD DwarfTypeLoader::Node::None;
+const DWORD DwarfTypeLoader::ClaimShardCount;
+const ULONGLONG DwarfTypeLoader::TypesSectionKey;
+
+DwarfTypeLoader::DwarfTypeLoader(
+	Settings* LoaderSettings
+	)
+{
+	m_Settings = LoaderSettings ? LoaderSettings : &DefaultSettings;
+}
+
+bool
+DwarfTypeLoader::IsElfFile(
+	const char* Path
+	)
+{
+	std::ifstream File(Path, std::ios::in | std::ios::binary);
+
+	char Signature[4];
+
+	return File.read(Signature, sizeof(Signature)) && memcmp(Signature, "\x7f" "ELF", sizeof(Signature)) == 0;
+}
+
+bool
+DwarfTypeLoader::Load(
+	const char* Path,
+	SymbolMap& Symbols,
+	SymbolNameMap& SymbolNames,
+	SymbolSet& AllSymbols,
+	SymbolNameArena& Names
+	)
+{
+	MappedMemoryImage Image;
+
+	m_Error = PDB::OpenError::NotFound;
+
+	if (!Image.Open(Path, 0) || !ReadSections(Image))
+	{
+		return false;
+	}
+
+	m_Error = PDB::OpenError::NoDebugInfo;
+
+	if (!ReadUnitHeaders())
+	{
+		return false;
+	}
+
+	//
+	// Every worker decodes a contiguous range of the units.
+	//
+
+	WorkerThreads::RunRanges(m_Units.size(), m_Settings->ThreadCount, [this](DWORD, size_t Begin, size_t End) {
+		for (size_t i = Begin; i < End; i++)
+		{
+			UnitDecoder Decoder(this, static_cast<DWORD>(i));
+			Decoder.Decode();
+		}
+	});
+
+	NameTypeUnitTypes();
+
+	for (DWORD UnitIndex = 0; UnitIndex < m_Units.size(); UnitIndex++)
+	{
+		const Unit& CurrentUnit = m_Units[UnitIndex];
+
+		if (CurrentUnit.IsCxx)
+		{
+			m_Language = CV_CFL_CXX;
+		}
+
+		for (DWORD NodeIndex = 0; NodeIndex < CurrentUnit.Nodes.size(); NodeIndex++)
+		{
+			if (CurrentUnit.Nodes[NodeIndex].Flags & Node::IsClaimed)
+			{
+				m_Definitions[CurrentUnit.Nodes[NodeIndex].Hash] = { UnitIndex, NodeIndex };
+			}
+		}
+	}
+
+	//
+	// Symbols are created in the order of the first occurrence
+	// of the definitions, regardless of which unit has won the claim.
+	//
+
+	std::vector<Claim> Claims;
+
+	for (auto&& Shard : m_ClaimShards)
+	{
+		for (auto&& e : Shard.Claims)
+		{
+			Claims.push_back(e.second);
+		}
+	}
+
+	std::sort(Claims.begin(), Claims.end(), [](const Claim& Left, const Claim& Right) {
+		return Left.FirstKey < Right.FirstKey;
+	});
+
+	//
+	// Objects compiled with -gsplit-dwarf keep the types in the .dwo files,
+	// which are not loaded.
+	//
+
+	bool HasSkeletonUnit = std::any_of(m_Units.begin(), m_Units.end(), [](const Unit& CurrentUnit) {
+		return CurrentUnit.IsSkeleton;
+	});
+
+	if (Claims.empty() && HasSkeletonUnit)
+	{
+		m_Error = PDB::OpenError::SplitDwarf;
+		return false;
+	}
+
+	m_Error = PDB::OpenError::None;
+
+	m_Symbols = &Symbols;
+	m_SymbolNames = &SymbolNames;
+	m_Names = &Names;
+	m_AllSymbols = &AllSymbols;
+
+	for (auto&& DefinitionClaim : Claims)
+	{
+		auto It = m_Definitions.find(DefinitionClaim.Hash);
+
+		if (It != m_Definitions.end())
+		{
+			const NodeLocation& Location = It->second;
+
+			GetUdtSymbol(Location.UnitIndex, &m_Units[Location.UnitIndex].Nodes[Location.NodeIndex], FALSE);
+		}
+	}
+
+	//
+	// Members are resolved after all struct symbols exist,
+	// so that chains of pointers do not recurse.
+	//
+
+	for (size_t i = 0; i < m_PendingUdts.size(); i++)
+	{
+		PendingUdt Pending = m_PendingUdts[i];
+
+		InitUdtSymbol(Pending.UnitIndex, Pending.Definition, Pending.Symbol);
+	}
+
+	return true;
+}
+
+DWORD
+DwarfTypeLoader::GetMachineType() const
+{
+	return m_MachineType;
+}
+
+CV_CFL_LANG
+DwarfTypeLoader::GetLanguage() const
+{
+	return m_Language;
+}
+
+PDB::OpenError
+DwarfTypeLoader::GetError() const
+{
+	return m_Error;
+}
+
+bool
+DwarfTypeLoader::ReadSections(
+	MemoryImage& Image
+	)
+{
+	const BYTE* Identification = Image.GetPointer(0, 16);
+
+	//
+	// Only little-endian files are supported.
+	//
+
+	if (Identification == nullptr || memcmp(Identification, "\x7f" "ELF", 4) != 0 ||
+	    (Identification[4] != 1 && Identification[4] != 2) || Identification[5] != 1)
+	{
+		return false;
+	}
+
+	bool Is64Bit = Identification[4] == 2;
+
+	const BYTE* Header = Image.GetPointer(0, Is64Bit ? 64 : 52);
+
+	if (Header == nullptr)
+	{
+		return false;
+	}
+
+	WORD FileType = static_cast<WORD>(ReadLittleEndian(Header + 16, 2));
+	WORD Machine = static_cast<WORD>(ReadLittleEndian(Header + 18, 2));
+
+	ULONGLONG SectionTableOffset = Is64Bit ? ReadLittleEndian(Header + 40, 8) : ReadLittleEndian(Header + 32, 4);
+	size_t SectionHeaderSize = static_cast<size_t>(ReadLittleEndian(Header + (Is64Bit ? 58 : 46), 2));
+	ULONGLONG SectionHeaderCount = ReadLittleEndian(Header + (Is64Bit ? 60 : 48), 2);
+	ULONGLONG StringTableIndex = ReadLittleEndian(Header + (Is64Bit ? 62 : 50), 2);
+
+	switch (Machine)
+	{
+		case ELF_EM_386:     m_MachineType = IMAGE_FILE_MACHINE_I386;  break;
+		case ELF_EM_X86_64:  m_MachineType = IMAGE_FILE_MACHINE_AMD64; break;
+		case ELF_EM_ARM:     m_MachineType = IMAGE_FILE_MACHINE_ARMNT; break;
+		case ELF_EM_AARCH64: m_MachineType = IMAGE_FILE_MACHINE_ARM64; break;
+		default:             m_MachineType = 0;                        break;
+	}
+
+	struct SectionHeader
+	{
+		ULONGLONG Name;
+		ULONGLONG Type;
+		ULONGLONG Flags;
+		ULONGLONG Offset;
+		ULONGLONG Size;
+		ULONGLONG Link;
+		ULONGLONG Info;
+		ULONGLONG EntrySize;
+	};
+
+	auto ReadSectionHeader = [&](ULONGLONG Index, SectionHeader& Result) {
+		const BYTE* Data = Image.GetPointer(SectionTableOffset + Index * SectionHeaderSize, Is64Bit ? 64 : 40);
+
+		if (Data == nullptr)
+		{
+			return false;
+		}
+
+		Result.Name      = ReadLittleEndian(Data + 0, 4);
+		Result.Type      = ReadLittleEndian(Data + 4, 4);
+		Result.Flags     = Is64Bit ? ReadLittleEndian(Data + 8,  8) : ReadLittleEndian(Data + 8,  4);
+		Result.Offset    = Is64Bit ? ReadLittleEndian(Data + 24, 8) : ReadLittleEndian(Data + 16, 4);
+		Result.Size      = Is64Bit ? ReadLittleEndian(Data + 32, 8) : ReadLittleEndian(Data + 20, 4);
+		Result.Link      = Is64Bit ? ReadLittleEndian(Data + 40, 4) : ReadLittleEndian(Data + 24, 4);
+		Result.Info      = Is64Bit ? ReadLittleEndian(Data + 44, 4) : ReadLittleEndian(Data + 28, 4);
+		Result.EntrySize = Is64Bit ? ReadLittleEndian(Data + 56, 8) : ReadLittleEndian(Data + 36, 4);
+
+		return true;
+	};
+
+	if (SectionTableOffset == 0 || SectionHeaderSize < (Is64Bit ? 64u : 40u))
+	{
+		return false;
+	}
+
+	//
+	// Files with too many sections keep the count and the index
+	// of the string table in the first section header.
+	//
+
+	SectionHeader FirstSection;
+
+	if (!ReadSectionHeader(0, FirstSection))
+	{
+		return false;
+	}
+
+	if (SectionHeaderCount == 0)
+	{
+		SectionHeaderCount = FirstSection.Size;
+	}
+
+	if (StringTableIndex == ELF_SHN_XINDEX)
+	{
+		StringTableIndex = FirstSection.Link;
+	}
+
+	std::vector<SectionHeader> Sections(static_cast<size_t>(SectionHeaderCount));
+
+	for (ULONGLONG i = 0; i < SectionHeaderCount; i++)
+	{
+		if (!ReadSectionHeader(i, Sections[static_cast<size_t>(i)]))
+		{
+			return false;
+		}
+	}
+
+	if (StringTableIndex >= SectionHeaderCount)
+	{
+		return false;
+	}
+
+	const SectionHeader& StringTable = Sections[static_cast<size_t>(StringTableIndex)];
+	const BYTE* SectionNames = Image.GetPointer(StringTable.Offset, static_cast<size_t>(StringTable.Size));
+
+	if (SectionNames == nullptr)
+	{
+		return false;
+	}
+
+	static const struct
+	{
+		const char* Name;
+		SectionIndex Index;
+	} DebugSections[] = {
+		{ "info",        DebugInfo       },
+		{ "types",       DebugTypes      },
+		{ "abbrev",      DebugAbbrev     },
+		{ "str",         DebugStr        },
+		{ "line_str",    DebugLineStr    },
+		{ "str_offsets", DebugStrOffsets },
+	};
+
+	//
+	// Relocatable files contain one .debug_info or .debug_types section
+	// per COMDAT group, the parts are concatenated.
+	//
+
+	struct SectionPart
+	{
+		ULONGLONG ElfIndex;
+		SectionIndex Index;
+		size_t BaseOffset;
+	};
+
+	std::vector<SectionPart> SectionParts;
+
+	for (ULONGLONG i = 1; i < Sections.size(); i++)
+	{
+		const SectionHeader& Current = Sections[static_cast<size_t>(i)];
+
+		if (Current.Name >= StringTable.Size || Current.Type == ELF_SHT_NOBITS)
+		{
+			continue;
+		}
+
+		const char* Name = reinterpret_cast<const char*>(SectionNames + Current.Name);
+		size_t NameLength = strnlen(Name, static_cast<size_t>(StringTable.Size - Current.Name));
+
+		//
+		// .debug_* sections, or .zdebug_* sections compressed by the GNU tools.
+		//
+
+		bool IsGnuCompressed = NameLength > 8 && strncmp(Name, ".zdebug_", 8) == 0;
+
+		if (!IsGnuCompressed && !(NameLength > 7 && strncmp(Name, ".debug_", 7) == 0))
+		{
+			continue;
+		}
+
+		std::string ShortName(Name + (IsGnuCompressed ? 8 : 7), Name + NameLength);
+
+		auto DebugSection = std::find_if(std::begin(DebugSections), std::end(DebugSections), [&ShortName](decltype(DebugSections[0])& Entry) {
+			return ShortName == Entry.Name;
+		});
+
+		if (DebugSection == std::end(DebugSections))
+		{
+			continue;
+		}
+
+		const BYTE* Data = Image.GetPointer(Current.Offset, static_cast<size_t>(Current.Size));
+		size_t Size = static_cast<size_t>(Current.Size);
+
+		if (Data == nullptr)
+		{
+			continue;
+		}
+
+		std::vector<BYTE> Decompressed;
+		bool IsCompressed = (Current.Flags & ELF_SHF_COMPRESSED) || IsGnuCompressed;
+
+		if (Current.Flags & ELF_SHF_COMPRESSED)
+		{
+			//
+			// Elf_Chdr: type, (reserved,) size, alignment.
+			//
+
+			size_t CompressionHeaderSize = Is64Bit ? 24 : 12;
+
+			if (Size < CompressionHeaderSize || ReadLittleEndian(Data, 4) != ELF_COMPRESS_ZLIB ||
+			    !Uncompress(Data + CompressionHeaderSize, Size - CompressionHeaderSize, Decompressed))
+			{
+				return false;
+			}
+		}
+		else if (IsGnuCompressed)
+		{
+			//
+			// "ZLIB" and the big-endian size of the uncompressed data.
+			//
+
+			if (Size < 12 || memcmp(Data, "ZLIB", 4) != 0 ||
+			    !Uncompress(Data + 12, Size - 12, Decompressed))
+			{
+				return false;
+			}
+		}
+
+		if (IsCompressed)
+		{
+			Data = Decompressed.data();
+			Size = Decompressed.size();
+		}
+
+		Section& Target = m_Sections[DebugSection->Index];
+
+		SectionParts.push_back({ i, DebugSection->Index, Target.Size });
+
+		if (Target.Data == nullptr && !IsCompressed)
+		{
+			Target.Data = Data;
+			Target.Size = Size;
+		}
+		else
+		{
+			if (Target.Buffer.empty())
+			{
+				Target.Buffer.assign(Target.Data, Target.Data + Target.Size);
+			}
+
+			Target.Buffer.insert(Target.Buffer.end(), Data, Data + Size);
+			Target.Data = Target.Buffer.data();
+			Target.Size = Target.Buffer.size();
+		}
+	}
+
+	if (m_Sections[DebugAbbrev].Data == nullptr ||
+	    (m_Sections[DebugInfo].Data == nullptr && m_Sections[DebugTypes].Data == nullptr))
+	{
+		m_Error = PDB::OpenError::NoDebugInfo;
+		return false;
+	}
+
+	//
+	// Relocatable files (objects, kernel modules) store the offsets
+	// to the other sections in the relocations.
+	//
+
+	if (FileType != ELF_ET_REL)
+	{
+		return true;
+	}
+
+	for (auto&& Relocations : Sections)
+	{
+		if (Relocations.Type != ELF_SHT_RELA && Relocations.Type != ELF_SHT_REL)
+		{
+			continue;
+		}
+
+		auto Target = std::find_if(SectionParts.begin(), SectionParts.end(), [&Relocations](const SectionPart& Part) {
+			return Part.ElfIndex == Relocations.Info;
+		});
+
+		if (Target == SectionParts.end() || Relocations.Link >= Sections.size())
+		{
+			continue;
+		}
+
+		Section& TargetSection = m_Sections[Target->Index];
+		const SectionHeader& SymbolTable = Sections[static_cast<size_t>(Relocations.Link)];
+
+		const BYTE* RelocationData = Image.GetPointer(Relocations.Offset, static_cast<size_t>(Relocations.Size));
+		const BYTE* SymbolData = Image.GetPointer(SymbolTable.Offset, static_cast<size_t>(SymbolTable.Size));
+
+		if (RelocationData == nullptr || SymbolData == nullptr)
+		{
+			continue;
+		}
+
+		if (TargetSection.Buffer.empty())
+		{
+			TargetSection.Buffer.assign(TargetSection.Data, TargetSection.Data + TargetSection.Size);
+			TargetSection.Data = TargetSection.Buffer.data();
+		}
+
+		bool HasAddend = Relocations.Type == ELF_SHT_RELA;
+		size_t EntrySize = Is64Bit ? (HasAddend ? 24 : 16) : (HasAddend ? 12 : 8);
+		size_t SymbolSize = Is64Bit ? 24 : 16;
+
+		for (size_t Offset = 0; Offset + EntrySize <= Relocations.Size; Offset += EntrySize)
+		{
+			const BYTE* Entry = RelocationData + Offset;
+
+			ULONGLONG Address = Target->BaseOffset + ReadLittleEndian(Entry, Is64Bit ? 8 : 4);
+			ULONGLONG Info = ReadLittleEndian(Entry + (Is64Bit ? 8 : 4), Is64Bit ? 8 : 4);
+			ULONGLONG SymbolIndex = Is64Bit ? Info >> 32 : Info >> 8;
+			DWORD Type = static_cast<DWORD>(Is64Bit ? Info & 0xffffffff : Info & 0xff);
+
+			//
+			// Only absolute relocations are used by the debugging information.
+			//
+
+			size_t Size =
+				(Machine == ELF_EM_X86_64  && Type == 1)                 ? 8 : // R_X86_64_64
+				(Machine == ELF_EM_X86_64  && (Type == 10 || Type == 11)) ? 4 : // R_X86_64_32, R_X86_64_32S
+				(Machine == ELF_EM_386     && Type == 1)                 ? 4 : // R_386_32
+				(Machine == ELF_EM_AARCH64 && Type == 257)               ? 8 : // R_AARCH64_ABS64
+				(Machine == ELF_EM_AARCH64 && Type == 258)               ? 4 : // R_AARCH64_ABS32
+				(Machine == ELF_EM_ARM     && Type == 2)                 ? 4 : // R_ARM_ABS32
+				                                                           0;
+
+			if (Size == 0 || Address + Size > TargetSection.Size || (SymbolIndex + 1) * SymbolSize > SymbolTable.Size)
+			{
+				continue;
+			}
+
+			BYTE* Field = TargetSection.Buffer.data() + Address;
+
+			ULONGLONG SymbolValue = ReadLittleEndian(SymbolData + SymbolIndex * SymbolSize + (Is64Bit ? 8 : 4), Is64Bit ? 8 : 4);
+			ULONGLONG Addend = HasAddend
+				? ReadLittleEndian(Entry + (Is64Bit ? 16 : 8), Is64Bit ? 8 : 4)
+				: ReadLittleEndian(Field, Size);
+
+			ULONGLONG Value = SymbolValue + Addend;
+
+			for (size_t i = 0; i < Size; i++)
+			{
+				Field[i] = static_cast<BYTE>(Value >> (i * 8));
+			}
+		}
+	}
+
+	return true;
+}
+
+bool
+DwarfTypeLoader::ReadUnitHeaders()
+{
+	for (SectionIndex Index : { DebugInfo, DebugTypes })
+	{
+		const Section& UnitSection = m_Sections[Index];
+
+		if (UnitSection.Data == nullptr)
+		{
+			continue;
+		}
+
+		Reader HeaderReader(UnitSection.Data, UnitSection.Data + UnitSection.Size);
+
+		while (HeaderReader.Position < HeaderReader.End)
+		{
+			Unit CurrentUnit;
+			CurrentUnit.Begin = HeaderReader.Position;
+			CurrentUnit.TypeSignature = 0;
+			CurrentUnit.TypeKey = 0;
+			CurrentUnit.IsCxx = false;
+			CurrentUnit.IsSkeleton = false;
+
+			ULONGLONG Length = HeaderReader.Fixed(4);
+			CurrentUnit.OffsetSize = 4;
+
+			if (Length == 0xffffffff)
+			{
+				Length = HeaderReader.Fixed(8);
+				CurrentUnit.OffsetSize = 8;
+			}
+
+			if (HeaderReader.Failed || !HeaderReader.Has(Length))
+			{
+				break;
+			}
+
+			CurrentUnit.End = HeaderReader.Position + Length;
+			CurrentUnit.Version = static_cast<WORD>(HeaderReader.Fixed(2));
+
+			if (CurrentUnit.Version >= 5)
+			{
+				CurrentUnit.UnitType = static_cast<BYTE>(HeaderReader.Fixed(1));
+				CurrentUnit.AddressSize = static_cast<BYTE>(HeaderReader.Fixed(1));
+				CurrentUnit.AbbrevOffset = HeaderReader.Fixed(CurrentUnit.OffsetSize);
+			}
+			else
+			{
+				CurrentUnit.UnitType = Index == DebugTypes ? DW_UT_type : DW_UT_compile;
+				CurrentUnit.AbbrevOffset = HeaderReader.Fixed(CurrentUnit.OffsetSize);
+				CurrentUnit.AddressSize = static_cast<BYTE>(HeaderReader.Fixed(1));
+			}
+
+			ULONGLONG TypeOffset = 0;
+
+			switch (CurrentUnit.UnitType)
+			{
+				case DW_UT_type:
+				case DW_UT_split_type:
+					CurrentUnit.TypeSignature = HeaderReader.Fixed(8);
+					TypeOffset = HeaderReader.Fixed(CurrentUnit.OffsetSize);
+					break;
+
+				case DW_UT_skeleton:
+					CurrentUnit.IsSkeleton = true;
+					HeaderReader.Fixed(8);
+					break;
+
+				case DW_UT_split_compile:
+					HeaderReader.Fixed(8);
+					break;
+			}
+
+			CurrentUnit.FirstEntry = HeaderReader.Position;
+			CurrentUnit.Key = static_cast<ULONGLONG>(CurrentUnit.Begin - UnitSection.Data) | (Index == DebugTypes ? TypesSectionKey : 0);
+			CurrentUnit.EndKey = CurrentUnit.Key + static_cast<ULONGLONG>(CurrentUnit.End - CurrentUnit.Begin);
+
+			HeaderReader.Position = CurrentUnit.End;
+
+			if (CurrentUnit.Version < 2 || CurrentUnit.Version > 5 || CurrentUnit.FirstEntry > CurrentUnit.End ||
+			    (CurrentUnit.AddressSize != 4 && CurrentUnit.AddressSize != 8))
+			{
+				continue;
+			}
+
+			if (TypeOffset != 0)
+			{
+				CurrentUnit.TypeKey = CurrentUnit.Key + TypeOffset;
+				m_TypeUnits.emplace(CurrentUnit.TypeSignature, static_cast<DWORD>(m_Units.size()));
+			}
+
+			m_Units.push_back(std::move(CurrentUnit));
+		}
+	}
+
+	return !m_Units.empty();
+}
+
+ULONGLONG
+DwarfTypeLoader::HashName(
+	const std::string& Name
+	)
+{
+	Hasher NameHasher;
+	NameHasher.AddBytes(Name.data(), Name.size());
+
+	return NameHasher.Value;
+}
+
+void
+DwarfTypeLoader::ClaimDefinition(
+	DWORD UnitIndex,
+	Node& Definition
+	)
+{
+	//
+	// The first unit which claims the hash keeps the definition, the key
+	// of the first occurrence in the file decides the order of the symbols.
+	//
+
+	{
+		ClaimShard& Shard = m_ClaimShards[Definition.Hash % ClaimShardCount];
+		std::lock_guard<std::mutex> Lock(Shard.Lock);
+
+		auto Result = Shard.Claims.emplace(Definition.Hash, Claim{ Definition.Key, Definition.Hash, UnitIndex });
+
+		if (Result.second)
+		{
+			Definition.Flags |= Node::IsClaimed;
+		}
+		else if (Definition.Key < Result.first->second.FirstKey)
+		{
+			Result.first->second.FirstKey = Definition.Key;
+		}
+	}
+
+	if (Definition.Name == nullptr)
+	{
+		return;
+	}
+
+	//
+	// Pointers to structs (and declarations) refer to the first definition of the name.
+	//
+
+	std::string Name = (Definition.Tag == DW_TAG_enumeration_type ? "e" : "s") + std::string(Definition.Name);
+
+	ClaimShard& Shard = m_ClaimShards[HashName(Name) % ClaimShardCount];
+	std::lock_guard<std::mutex> Lock(Shard.Lock);
+
+	auto Result = Shard.Names.emplace(Name, Claim{ Definition.Key, Definition.Hash, UnitIndex });
+
+	if (!Result.second && Definition.Key < Result.first->second.FirstKey)
+	{
+		Result.first->second = Claim{ Definition.Key, Definition.Hash, UnitIndex };
+	}
+}
+
+void
+DwarfTypeLoader::NameTypeUnitTypes()
+{
+	//
+	// The first typedef in the order of the units wins.
+	//
+
+	for (auto&& CurrentUnit : m_Units)
+	{
+		for (auto&& Typedef : CurrentUnit.SignatureTypedefs)
+		{
+			auto It = m_TypeUnits.find(Typedef.first);
+
+			if (It == m_TypeUnits.end())
+			{
+				continue;
+			}
+
+			Unit& TypeUnit = m_Units[It->second];
+
+			auto Root = std::lower_bound(TypeUnit.Nodes.begin(), TypeUnit.Nodes.end(), TypeUnit.TypeKey, [](const Node& Entry, ULONGLONG Key) {
+				return Entry.Key < Key;
+			});
+
+			if (Root == TypeUnit.Nodes.end() || Root->Key != TypeUnit.TypeKey || !IsUdtOrEnumTag(Root->Tag) ||
+			    Root->Name != nullptr || (Root->Flags & (Node::IsDeclaration | Node::IsTypeSignature)))
+			{
+				continue;
+			}
+
+			TypeUnit.Strings.push_back(Typedef.second);
+
+			Root->Name = TypeUnit.Strings.back().c_str();
+			Root->Flags |= Node::HasTypedefName | Node::HasLocalName;
+
+			ClaimDefinition(It->second, *Root);
+		}
+
+		CurrentUnit.SignatureTypedefs.clear();
+	}
+}
+
+const DwarfTypeLoader::Node*
+DwarfTypeLoader::FindNode(
+	DWORD& UnitIndex,
+	ULONGLONG Key,
+	BOOL IsTypeSignature
+	) const
+{
+	if (IsTypeSignature)
+	{
+		auto It = m_TypeUnits.find(Key);
+
+		if (It == m_TypeUnits.end())
+		{
+			return nullptr;
+		}
+
+		UnitIndex = It->second;
+		Key = m_Units[UnitIndex].TypeKey;
+	}
+
+	if (Key == 0)
+	{
+		return nullptr;
+	}
+
+	const Unit* KeyUnit = &m_Units[UnitIndex];
+
+	if (Key < KeyUnit->Key || Key >= KeyUnit->EndKey)
+	{
+		auto It = std::upper_bound(m_Units.begin(), m_Units.end(), Key, [](ULONGLONG Key, const Unit& Entry) {
+			return Key < Entry.Key;
+		});
+
+		if (It == m_Units.begin() || Key >= (--It)->EndKey)
+		{
+			return nullptr;
+		}
+
+		UnitIndex = static_cast<DWORD>(It - m_Units.begin());
+		KeyUnit = &*It;
+	}
+
+	auto It = std::lower_bound(KeyUnit->Nodes.begin(), KeyUnit->Nodes.end(), Key, [](const Node& Entry, ULONGLONG Key) {
+		return Entry.Key < Key;
+	});
+
+	return It != KeyUnit->Nodes.end() && It->Key == Key ? &*It : nullptr;
+}
+
+const DwarfTypeLoader::Node*
+DwarfTypeLoader::ResolveType(
+	DWORD& UnitIndex,
+	ULONGLONG Key,
+	BOOL IsTypeSignature,
+	BOOL& IsConst,
+	BOOL& IsVolatile
+	) const
+{
+	for (DWORD Depth = 0; Depth < 64; Depth++)
+	{
+		const Node* Type = FindNode(UnitIndex, Key, IsTypeSignature);
+
+		if (Type == nullptr)
+		{
+			return nullptr;
+		}
+
+		if (Type->Tag == DW_TAG_const_type)
+		{
+			IsConst = TRUE;
+		}
+		else if (Type->Tag == DW_TAG_volatile_type)
+		{
+			IsVolatile = TRUE;
+		}
+		else if (!IsTransparentTag(Type->Tag))
+		{
+			return Type;
+		}
+
+		Key = Type->Type;
+		IsTypeSignature = (Type->Flags & Node::IsTypeSignature) != 0;
+	}
+
+	return nullptr;
+}
+
+const DwarfTypeLoader::Node*
+DwarfTypeLoader::FindDefinition(
+	DWORD& UnitIndex,
+	const Node* Type,
+	BOOL ByName
+	) const
+{
+	//
+	// Declaration of the struct defined in the type unit.
+	//
+
+	if (Type->Flags & Node::IsTypeSignature)
+	{
+		Type = FindNode(UnitIndex, Type->Type, TRUE);
+
+		if (Type == nullptr || !IsUdtOrEnumTag(Type->Tag) || (Type->Flags & Node::IsTypeSignature))
+		{
+			return nullptr;
+		}
+	}
+
+	auto GetDefinition = [this, &UnitIndex](ULONGLONG Hash) -> const Node* {
+		auto It = m_Definitions.find(Hash);
+
+		if (It == m_Definitions.end())
+		{
+			return nullptr;
+		}
+
+		UnitIndex = It->second.UnitIndex;
+		return &m_Units[UnitIndex].Nodes[It->second.NodeIndex];
+	};
+
+	if (Type->Name != nullptr && (ByName || (Type->Flags & Node::IsDeclaration)))
+	{
+		std::string Name = (Type->Tag == DW_TAG_enumeration_type ? "e" : "s") + std::string(Type->Name);
+
+		const ClaimShard& Shard = m_ClaimShards[HashName(Name) % ClaimShardCount];
+		auto It = Shard.Names.find(Name);
+
+		if (It != Shard.Names.end())
+		{
+			if (const Node* Definition = GetDefinition(It->second.Hash))
+			{
+				return Definition;
+			}
+		}
+	}
+
+	return (Type->Flags & Node::IsDeclaration) ? nullptr : GetDefinition(Type->Hash);
+}
+
+SYMBOL*
+DwarfTypeLoader::NewSymbol(
+	enum SymTagEnum Tag,
+	DWORD Size
+	)
+{
+	SYMBOL* Symbol = new SYMBOL();
+
+	Symbol->Tag = Tag;
+	Symbol->BaseType = btNoType;
+	Symbol->TypeId = m_NextTypeId++;
+	Symbol->Size = Size;
+	Symbol->IsConst = FALSE;
+	Symbol->IsVolatile = FALSE;
+	Symbol->Name = nullptr;
+
+	(*m_Symbols)[Symbol->TypeId] = Symbol;
+	m_AllSymbols->insert(Symbol);
+
+	return Symbol;
+}
+
+SYMBOL*
+DwarfTypeLoader::GetTypeSymbol(
+	DWORD UnitIndex,
+	ULONGLONG Key,
+	BOOL IsTypeSignature,
+	BOOL IsPointerTarget
+	)
+{
+	BOOL IsConst = FALSE;
+	BOOL IsVolatile = FALSE;
+
+	const Node* Type = ResolveType(UnitIndex, Key, IsTypeSignature, IsConst, IsVolatile);
+
+	if (Type == nullptr)
+	{
+		return GetQualifiedSymbol(GetVoidSymbol(), IsConst, IsVolatile);
+	}
+
+	const Unit& TypeUnit = m_Units[UnitIndex];
+	SYMBOL* Symbol;
+
+	switch (Type->Tag)
+	{
+		case DW_TAG_base_type:
+			Symbol = GetBaseTypeSymbol(Type);
+			break;
+
+		case DW_TAG_pointer_type:
+		case DW_TAG_reference_type:
+		case DW_TAG_rvalue_reference_type:
+		{
+			SYMBOL* TargetSymbol = GetTypeSymbol(UnitIndex, Type->Type, (Type->Flags & Node::IsTypeSignature) != 0, TRUE);
+
+			DWORD Size = Type->Size ? Type->Size : TypeUnit.AddressSize;
+			BOOL IsReference = Type->Tag != DW_TAG_pointer_type;
+
+			std::string SymbolKey = MakeSymbolKey('P', { reinterpret_cast<ULONGLONG>(TargetSymbol), Size, static_cast<ULONGLONG>(IsReference) });
+			SYMBOL*& PointerSymbol = m_DerivedSymbols[SymbolKey];
+
+			if (PointerSymbol == nullptr)
+			{
+				PointerSymbol = NewSymbol(SymTagPointerType, Size);
+				PointerSymbol->u.Pointer.Type = TargetSymbol;
+				PointerSymbol->u.Pointer.IsReference = IsReference;
+			}
+
+			Symbol = PointerSymbol;
+			break;
+		}
+
+		case DW_TAG_ptr_to_member_type:
+		{
+			//
+			// Pointers to member functions are two pointers wide in the Itanium C++ ABI.
+			//
+
+			BOOL IsDummyConst = FALSE;
+			DWORD TargetUnitIndex = UnitIndex;
+			const Node* Target = ResolveType(TargetUnitIndex, Type->Type, (Type->Flags & Node::IsTypeSignature) != 0, IsDummyConst, IsDummyConst);
+
+			DWORD Size = Type->Size
+				? Type->Size
+				: (Target && Target->Tag == DW_TAG_subroutine_type ? 2 : 1) * TypeUnit.AddressSize;
+
+			Symbol = GetByteArraySymbol(Size);
+			break;
+		}
+
+		case DW_TAG_array_type:
+		{
+			SYMBOL* ElementSymbol = GetTypeSymbol(UnitIndex, Type->Type, (Type->Flags & Node::IsTypeSignature) != 0);
+
+			std::vector<DWORD> Dimensions;
+
+			for (DWORD ChildIndex = Type->FirstChild; ChildIndex != Node::None; ChildIndex = TypeUnit.Nodes[ChildIndex].NextSibling)
+			{
+				const Node& Subrange = TypeUnit.Nodes[ChildIndex];
+
+				if (Subrange.Tag == DW_TAG_subrange_type)
+				{
+					Dimensions.push_back((Subrange.Flags & Node::HasCount) ? static_cast<DWORD>(Subrange.Value) : 0);
+				}
+			}
+
+			if (Dimensions.empty())
+			{
+				Dimensions.push_back(0);
+			}
+
+			//
+			// int x[2][3] is an array of 2 arrays of 3 ints.
+			//
+
+			for (auto It = Dimensions.rbegin(); It != Dimensions.rend(); ++It)
+			{
+				ElementSymbol = GetArraySymbol(ElementSymbol, *It);
+			}
+
+			Symbol = ElementSymbol;
+			break;
+		}
+
+		case DW_TAG_subroutine_type:
+		{
+			SYMBOL* ReturnSymbol = GetTypeSymbol(UnitIndex, Type->Type, (Type->Flags & Node::IsTypeSignature) != 0);
+
+			std::vector<SYMBOL*> ArgumentSymbols;
+			std::string SymbolKey = MakeSymbolKey('F', { reinterpret_cast<ULONGLONG>(ReturnSymbol) });
+
+			for (DWORD ChildIndex = Type->FirstChild; ChildIndex != Node::None; ChildIndex = TypeUnit.Nodes[ChildIndex].NextSibling)
+			{
+				const Node& Parameter = TypeUnit.Nodes[ChildIndex];
+
+				if (Parameter.Tag != DW_TAG_formal_parameter)
+				{
+					continue;
+				}
+
+				SYMBOL* ParameterSymbol = GetTypeSymbol(UnitIndex, Parameter.Type, (Parameter.Flags & Node::IsTypeSignature) != 0);
+				SYMBOL*& ArgumentSymbol = m_DerivedSymbols[MakeSymbolKey('G', { reinterpret_cast<ULONGLONG>(ParameterSymbol) })];
+
+				if (ArgumentSymbol == nullptr)
+				{
+					ArgumentSymbol = NewSymbol(SymTagFunctionArgType, 0);
+					ArgumentSymbol->u.FunctionArg.Type = ParameterSymbol;
+				}
+
+				ArgumentSymbols.push_back(ArgumentSymbol);
+				SymbolKey += MakeSymbolKey(',', { reinterpret_cast<ULONGLONG>(ArgumentSymbol) });
+			}
+
+			SYMBOL*& FunctionSymbol = m_DerivedSymbols[SymbolKey];
+
+			if (FunctionSymbol == nullptr)
+			{
+				FunctionSymbol = NewSymbol(SymTagFunctionType, 0);
+				FunctionSymbol->u.Function.ReturnType = ReturnSymbol;
+				FunctionSymbol->u.Function.CallingConvention = CV_CALL_NEAR_C;
+				FunctionSymbol->u.Function.ArgumentCount = static_cast<DWORD>(ArgumentSymbols.size());
+				FunctionSymbol->u.Function.Arguments = new SYMBOL*[ArgumentSymbols.size() + 1];
+
+				std::copy(ArgumentSymbols.begin(), ArgumentSymbols.end(), FunctionSymbol->u.Function.Arguments);
+			}
+
+			Symbol = FunctionSymbol;
+			break;
+		}
+
+		case DW_TAG_class_type:
+		case DW_TAG_structure_type:
+		case DW_TAG_union_type:
+		case DW_TAG_enumeration_type:
+			Symbol = GetUdtSymbol(UnitIndex, Type, IsPointerTarget);
+			break;
+
+		default:
+			Symbol = GetVoidSymbol();
+			break;
+	}
+
+	return GetQualifiedSymbol(Symbol, IsConst, IsVolatile);
+}
+
+SYMBOL*
+DwarfTypeLoader::GetBaseTypeSymbol(
+	const Node* Type
+	)
+{
+	BasicType BaseType;
+
+	switch (Type->Encoding)
+	{
+		case DW_ATE_boolean:
+			BaseType = btBool;
+			break;
+
+		case DW_ATE_float:
+			BaseType = btFloat;
+			break;
+
+		case DW_ATE_signed:
+			BaseType = btInt;
+			break;
+
+		case DW_ATE_signed_char:
+			BaseType = Type->Size == 1 ? btChar : btInt;
+			break;
+
+		case DW_ATE_address:
+		case DW_ATE_unsigned:
+		case DW_ATE_unsigned_char:
+			BaseType = btUInt;
+			break;
+
+		case DW_ATE_UTF:
+			//
+			// char16_t is not wchar_t, which is 4 bytes long on Linux.
+			//
+
+			BaseType = Type->Size == 1 ? btChar : btUInt;
+			break;
+
+		default:
+			BaseType = btNoType;
+			break;
+	}
+
+	//
+	// Types without an equivalent (__int128, 16-byte long double, complex numbers)
+	// are represented as arrays of bytes of the same size.
+	//
+
+	if (BaseType == btNoType || PDB::GetBasicTypeString(BaseType, Type->Size) == nullptr)
+	{
+		return GetByteArraySymbol(Type->Size);
+	}
+
+	SYMBOL*& Symbol = m_DerivedSymbols[MakeSymbolKey('B', { static_cast<ULONGLONG>(BaseType), Type->Size })];
+
+	if (Symbol == nullptr)
+	{
+		Symbol = NewSymbol(SymTagBaseType, Type->Size);
+		Symbol->BaseType = BaseType;
+	}
+
+	return Symbol;
+}
+
+SYMBOL*
+DwarfTypeLoader::GetArraySymbol(
+	SYMBOL* ElementType,
+	DWORD ElementCount
+	)
+{
+	SYMBOL*& Symbol = m_DerivedSymbols[MakeSymbolKey('A', { reinterpret_cast<ULONGLONG>(ElementType), ElementCount })];
+
+	if (Symbol == nullptr)
+	{
+		Symbol = NewSymbol(SymTagArrayType, ElementType->Size * ElementCount);
+		Symbol->u.Array.ElementType = ElementType;
+		Symbol->u.Array.ElementCount = ElementCount;
+	}
+
+	return Symbol;
+}
+
+SYMBOL*
+DwarfTypeLoader::GetByteArraySymbol(
+	DWORD Size
+	)
+{
+	SYMBOL*& ByteSymbol = m_DerivedSymbols[MakeSymbolKey('B', { static_cast<ULONGLONG>(btUInt), 1 })];
+
+	if (ByteSymbol == nullptr)
+	{
+		ByteSymbol = NewSymbol(SymTagBaseType, 1);
+		ByteSymbol->BaseType = btUInt;
+	}
+
+	return GetArraySymbol(ByteSymbol, Size);
+}
+
+SYMBOL*
+DwarfTypeLoader::GetVoidSymbol()
+{
+	SYMBOL*& Symbol = m_DerivedSymbols[MakeSymbolKey('B', { static_cast<ULONGLONG>(btVoid), 0 })];
+
+	if (Symbol == nullptr)
+	{
+		Symbol = NewSymbol(SymTagBaseType, 0);
+		Symbol->BaseType = btVoid;
+	}
+
+	return Symbol;
+}
+
+SYMBOL*
+DwarfTypeLoader::GetQualifiedSymbol(
+	SYMBOL* Symbol,
+	BOOL IsConst,
+	BOOL IsVolatile
+	)
+{
+	//
+	// Structs are shared by all their uses, their qualifiers are dropped.
+	//
+
+	if ((!IsConst && !IsVolatile) || (Symbol->Tag != SymTagBaseType && Symbol->Tag != SymTagPointerType))
+	{
+		return Symbol;
+	}
+
+	SYMBOL*& QualifiedSymbol = m_DerivedSymbols[MakeSymbolKey('Q', {
+		reinterpret_cast<ULONGLONG>(Symbol), static_cast<ULONGLONG>(IsConst), static_cast<ULONGLONG>(IsVolatile)
+	})];
+
+	if (QualifiedSymbol == nullptr)
+	{
+		QualifiedSymbol = NewSymbol(Symbol->Tag, Symbol->Size);
+		QualifiedSymbol->BaseType = Symbol->BaseType;
+		QualifiedSymbol->IsConst = IsConst;
+		QualifiedSymbol->IsVolatile = IsVolatile;
+		QualifiedSymbol->u = Symbol->u;
+	}
+
+	return QualifiedSymbol;
+}
+
+SYMBOL*
+DwarfTypeLoader::GetUdtSymbol(
+	DWORD UnitIndex,
+	const Node* Type,
+	BOOL IsPointerTarget
+	)
+{
+	const Node* Definition = FindDefinition(UnitIndex, Type, IsPointerTarget);
+	enum SymTagEnum Tag = Type->Tag == DW_TAG_enumeration_type ? SymTagEnum : SymTagUDT;
+
+	SYMBOL* Symbol;
+
+	if (Definition == nullptr)
+	{
+		//
+		// Struct which is only declared (struct foo;), one symbol per name.
+		//
+
+		const char* Name = Type->Name ? Type->Name : UnnamedTagName;
+
+		SYMBOL*& DeclarationSymbol = m_DerivedSymbols[MakeSymbolKey('D', { Type->Tag }) + Name];
+
+		if (DeclarationSymbol == nullptr)
+		{
+			DeclarationSymbol = NewSymbol(Tag, 0);
+			DeclarationSymbol->Name = m_Names->Add(Name);
+
+			if (Tag == SymTagUDT)
+			{
+				DeclarationSymbol->u.Udt.Kind = Type->Tag == DW_TAG_union_type ? UdtUnion : Type->Tag == DW_TAG_class_type ? UdtClass : UdtStruct;
+				DeclarationSymbol->u.Udt.Fields = new SYMBOL_UDT_FIELD[1];
+			}
+			else
+			{
+				DeclarationSymbol->BaseType = btInt;
+			}
+
+			(*m_SymbolNames)[Name] = DeclarationSymbol;
+		}
+
+		return DeclarationSymbol;
+	}
+
+	auto It = m_DefinitionSymbols.find(Definition->Hash);
+
+	if (It != m_DefinitionSymbols.end())
+	{
+		return It->second;
+	}
+
+	Symbol = NewSymbol(Tag, Definition->Size);
+	Symbol->Name = m_Names->Add(Definition->Name ? Definition->Name : UnnamedTagName);
+
+	m_DefinitionSymbols[Definition->Hash] = Symbol;
+	(*m_SymbolNames)[Symbol->Name] = Symbol;
+
+	if (Tag == SymTagEnum)
+	{
+		InitEnumSymbol(UnitIndex, Definition, Symbol);
+	}
+	else
+	{
+		Symbol->u.Udt.Kind = Definition->Tag == DW_TAG_union_type ? UdtUnion : Definition->Tag == DW_TAG_class_type ? UdtClass : UdtStruct;
+
+		m_PendingUdts.push_back({ UnitIndex, Definition, Symbol });
+	}
+
+	return Symbol;
+}
+
+void
+DwarfTypeLoader::InitEnumSymbol(
+	DWORD UnitIndex,
+	const Node* Definition,
+	SYMBOL* Symbol
+	)
+{
+	const Unit& DefinitionUnit = m_Units[UnitIndex];
+
+	//
+	// Enumerators of the enums without the underlying type (DWARF 2)
+	// are signed unless they are encoded as unsigned constants.
+	//
+
+	BOOL IsConst = FALSE;
+	DWORD TypeUnitIndex = UnitIndex;
+	const Node* UnderlyingType = ResolveType(TypeUnitIndex, Definition->Type, (Definition->Flags & Node::IsTypeSignature) != 0, IsConst, IsConst);
+
+	bool IsSigned = UnderlyingType == nullptr ||
+	                UnderlyingType->Encoding == DW_ATE_signed ||
+	                UnderlyingType->Encoding == DW_ATE_signed_char;
+
+	Symbol->BaseType = IsSigned ? btInt : btUInt;
+
+	DWORD FieldCount = 0;
+
+	for (DWORD ChildIndex = Definition->FirstChild; ChildIndex != Node::None; ChildIndex = DefinitionUnit.Nodes[ChildIndex].NextSibling)
+	{
+		FieldCount++;
+	}
+
+	Symbol->u.Enum.FieldCount = FieldCount;
+	Symbol->u.Enum.Fields = new SYMBOL_ENUM_FIELD[FieldCount + 1];
+
+	SYMBOL_ENUM_FIELD* Field = Symbol->u.Enum.Fields;
+
+	for (DWORD ChildIndex = Definition->FirstChild; ChildIndex != Node::None; ChildIndex = DefinitionUnit.Nodes[ChildIndex].NextSibling)
+	{
+		const Node& Enumerator = DefinitionUnit.Nodes[ChildIndex];
+
+		LONGLONG Value = Enumerator.Value;
+
+		if (IsSigned && !(Enumerator.Flags & Node::IsSignedValue))
+		{
+			Value = SignExtend(static_cast<ULONGLONG>(Value), Enumerator.ValueSize);
+		}
+
+		//
+		// Values are printed in decimal, large unsigned values in hexadecimal.
+		//
+
+		bool IsNegative = (IsSigned || (Enumerator.Flags & Node::IsSignedValue)) && Value < 0;
+
+		if (IsNegative ? Value >= -0x80000000ll : static_cast<ULONGLONG>(Value) <= 0x7fffffff)
+		{
+			Field->Value.vt = VT_I4;
+			Field->Value.lVal = static_cast<LONG>(Value);
+		}
+		else if (!IsNegative && static_cast<ULONGLONG>(Value) <= 0xffffffff)
+		{
+			Field->Value.vt = VT_UI4;
+			Field->Value.ulVal = static_cast<ULONG>(Value);
+		}
+		else if (IsNegative)
+		{
+			Field->Value.vt = VT_I8;
+			Field->Value.llVal = Value;
+		}
+		else
+		{
+			Field->Value.vt = VT_UI8;
+			Field->Value.ullVal = static_cast<ULONGLONG>(Value);
+		}
+
+		Field->Name = m_Names->Add(Enumerator.Name ? Enumerator.Name : "");
+		Field->Parent = Symbol;
+		Field++;
+	}
+}
+
+void
+DwarfTypeLoader::InitUdtSymbol(
+	DWORD UnitIndex,
+	const Node* Definition,
+	SYMBOL* Symbol
+	)
+{
+	std::vector<SYMBOL_UDT_FIELD> Fields;
+
+	CollectUdtFields(UnitIndex, Definition, 0, Fields);
+
+	//
+	// One more field for the padding.
+	//
+
+	Symbol->u.Udt.FieldCount = static_cast<DWORD>(Fields.size());
+	Symbol->u.Udt.Fields = new SYMBOL_UDT_FIELD[Fields.size() + 1];
+
+	for (size_t i = 0; i < Fields.size(); i++)
+	{
+		Symbol->u.Udt.Fields[i] = Fields[i];
+		Symbol->u.Udt.Fields[i].Parent = Symbol;
+	}
+}
+
+void
+DwarfTypeLoader::CollectUdtFields(
+	DWORD UnitIndex,
+	const Node* Definition,
+	ULONGLONG BaseOffset,
+	std::vector<SYMBOL_UDT_FIELD>& Fields
+	)
+{
+	const Unit& DefinitionUnit = m_Units[UnitIndex];
+
+	for (DWORD ChildIndex = Definition->FirstChild; ChildIndex != Node::None; ChildIndex = DefinitionUnit.Nodes[ChildIndex].NextSibling)
+	{
+		const Node& Member = DefinitionUnit.Nodes[ChildIndex];
+
+		if (Member.Tag != DW_TAG_member || (Member.Flags & (Node::IsStaticMember | Node::IsArtificial)))
+		{
+			continue;
+		}
+
+		ULONGLONG ByteOffset = BaseOffset + ((Member.Flags & Node::HasMemberLocation) ? Member.Value : 0);
+		BOOL IsTypeSignature = (Member.Flags & Node::IsTypeSignature) != 0;
+
+		if (Member.Name == nullptr)
+		{
+			//
+			// Anonymous struct or union, unnamed bitfields are padding.
+			//
+
+			BOOL IsConst = FALSE;
+			DWORD TypeUnitIndex = UnitIndex;
+			const Node* Type = ResolveType(TypeUnitIndex, Member.Type, IsTypeSignature, IsConst, IsConst);
+
+			if (Type != nullptr && IsUdtTag(Type->Tag) && Member.BitSize == 0)
+			{
+				if (const Node* AnonymousDefinition = FindDefinition(TypeUnitIndex, Type, FALSE))
+				{
+					CollectUdtFields(TypeUnitIndex, AnonymousDefinition, ByteOffset, Fields);
+				}
+			}
+
+			continue;
+		}
+
+		SYMBOL_UDT_FIELD Field;
+		Field.Name = m_Names->Add(Member.Name);
+		Field.Type = GetTypeSymbol(UnitIndex, Member.Type, IsTypeSignature);
+		Field.Offset = static_cast<DWORD>(ByteOffset);
+		Field.Bits = 0;
+		Field.BitPosition = 0;
+		Field.Parent = nullptr;
+
+		if (Member.BitSize != 0)
+		{
+			//
+			// Bitfields are placed in the storage unit of the size of their type,
+			// DW_AT_bit_offset (DWARF 2, 3) counts from the most significant bit.
+			//
+
+			DWORD UnitSize = Field.Type->Size ? Field.Type->Size : 4;
+			ULONGLONG BitOffset = ByteOffset * 8;
+
+			if (Member.Flags & Node::HasDataBitOffset)
+			{
+				BitOffset += Member.BitOffset;
+			}
+			else if (Member.Flags & Node::HasBitOffset)
+			{
+				ULONGLONG StorageBits = (Member.Size ? Member.Size : UnitSize) * 8ull;
+
+				if (Member.BitOffset + Member.BitSize <= StorageBits)
+				{
+					BitOffset += StorageBits - Member.BitOffset - Member.BitSize;
+				}
+			}
+
+			Field.Offset = static_cast<DWORD>(BitOffset / (UnitSize * 8ull) * UnitSize);
+			Field.BitPosition = static_cast<DWORD>(BitOffset - Field.Offset * 8ull);
+			Field.Bits = Member.BitSize;
+		}
+
+		Fields.push_back(Field);
+	}
+}
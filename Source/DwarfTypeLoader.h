@@ -0,0 +1,444 @@
+#pragma once
+#include "PDB.h"
+#include "MemoryImage.h"
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//
+// Loads types from the DWARF debugging information (DWARF 2 - 5,
+// .debug_info, .debug_types, .debug_abbrev, .debug_str) of an ELF file
+// into the same SYMBOL graph which is built from the PDB, so that
+// the header reconstructor and all other generators work unchanged.
+//
+// Compilation units are decoded in parallel directly from the mapped file.
+// Every unit contains its own copy of the types of included headers,
+// definitions are therefore identified by the structural hash (name,
+// size, members and their types) and only the first copy of each
+// definition is kept:
+//
+//   unit 1     struct list_head { ... }   -> hash A, kept
+//   unit 2     struct list_head { ... }   -> hash A, dropped
+//   unit 2     struct foo { ... }         -> hash B, kept
+//
+// The SYMBOL graph follows what DIA reports for the PDB:
+//
+//   - typedefs, restrict and atomic qualifiers are resolved to the
+//     underlying types, const and volatile are kept only for the base
+//     types and pointers,
+//   - members of anonymous structs and unions are flattened into the parent
+//     with their offsets rebased, the header reconstructor restores them
+//     from the offsets,
+//   - base classes and artificial members (vtable pointers) are omitted,
+//   - unnamed types are named "<unnamed-tag>", unless they are named
+//     by a typedef (typedef struct { ... } foo_t;),
+//   - types declared inside of the functions are not loaded.
+//
+class DwarfTypeLoader
+{
+	public:
+		struct Settings
+		{
+			//
+			// Count of worker threads, 0 means count of CPUs.
+			//
+			DWORD ThreadCount = 0;
+		};
+
+		DwarfTypeLoader(
+			Settings* LoaderSettings = nullptr
+			);
+
+		//
+		// Returns true if the file starts with the ELF signature.
+		//
+		static
+		bool
+		IsElfFile(
+			const char* Path
+			);
+
+		//
+		// Loads all types of the file. Symbols are allocated the same way as
+		// the symbols of the PDB (arrays by new[], names in the Names arena)
+		// and they are owned by the caller.
+		//
+		// Returns false if the file is not a little-endian ELF file
+		// or if it does not contain the DWARF debugging information,
+		// GetError tells which.
+		//
+		bool
+		Load(
+			const char* Path,
+			SymbolMap& Symbols,
+			SymbolNameMap& SymbolNames,
+			SymbolSet& AllSymbols,
+			SymbolNameArena& Names
+			);
+
+		//
+		// IMAGE_FILE_MACHINE_* value of the ELF machine.
+		//
+		DWORD
+		GetMachineType() const;
+
+		CV_CFL_LANG
+		GetLanguage() const;
+
+		//
+		// Reason of the failure of Load.
+		//
+		PDB::OpenError
+		GetError() const;
+
+	private:
+		struct Section
+		{
+			const BYTE* Data = nullptr;
+			size_t Size = 0;
+
+			//
+			// Decompressed or relocated contents of the section.
+			//
+			std::vector<BYTE> Buffer;
+		};
+
+		enum SectionIndex
+		{
+			DebugInfo,
+			DebugTypes,
+			DebugAbbrev,
+			DebugStr,
+			DebugLineStr,
+			DebugStrOffsets,
+			SectionCount,
+		};
+
+		//
+		// Debugging information entry which describes a type, a member,
+		// an enumerator, a subrange of an array or a parameter.
+		//
+		struct Node
+		{
+			static const DWORD None = static_cast<DWORD>(-1);
+
+			enum : WORD
+			{
+				IsDeclaration     = 0x0001,
+				IsTypeSignature   = 0x0002,
+				HasMemberLocation = 0x0004,
+				HasDataBitOffset  = 0x0008,
+				HasBitOffset      = 0x0010,
+				IsSignedValue     = 0x0020,
+				IsStaticMember    = 0x0040,
+				IsArtificial      = 0x0080,
+				IsHashed          = 0x0100,
+				IsClaimed         = 0x0200,
+				IsRetained        = 0x0400,
+				HasCount          = 0x0800,
+				HasSpecification  = 0x1000,
+				HasLocalName      = 0x2000,
+				HasTypedefName    = 0x4000,
+			};
+
+			//
+			// Key of the entry: offset in the .debug_info, or offset
+			// in the .debug_types with the TypesSectionKey bit set.
+			//
+			ULONGLONG Key;
+
+			//
+			// Key of the DW_AT_type, or the type signature if IsTypeSignature is set.
+			//
+			ULONGLONG Type;
+
+			//
+			// Structural hash of the definition of the struct/class/union/enum.
+			//
+			ULONGLONG Hash;
+
+			//
+			// Member location, enumerator value, count of the subrange
+			// or key of the DW_AT_specification of the type.
+			//
+			LONGLONG Value;
+
+			ULONGLONG BitOffset;
+
+			//
+			// Name qualified by the namespaces and classes.
+			// Unnamed types named by the typedef have the name of the typedef.
+			//
+			const char* Name;
+
+			DWORD Size;
+			DWORD BitSize;
+
+			DWORD FirstChild;
+			DWORD NextSibling;
+
+			WORD Tag;
+			WORD Flags;
+
+			BYTE Encoding;
+
+			//
+			// Size of the DW_FORM_dataN of the enumerator value.
+			//
+			BYTE ValueSize;
+		};
+
+		struct Unit
+		{
+			ULONGLONG Key;
+			ULONGLONG EndKey;
+
+			const BYTE* Begin;
+			const BYTE* FirstEntry;
+			const BYTE* End;
+
+			ULONGLONG AbbrevOffset;
+			ULONGLONG TypeSignature;
+			ULONGLONG TypeKey;
+
+			WORD Version;
+			BYTE UnitType;
+			BYTE AddressSize;
+			BYTE OffsetSize;
+
+			bool IsCxx;
+			bool IsSkeleton;
+
+			//
+			// Retained nodes sorted by their keys.
+			//
+			std::vector<Node> Nodes;
+
+			//
+			// Storage of the qualified names.
+			//
+			std::deque<std::string> Strings;
+
+			//
+			// Typedefs of the types in the type units (signature, name).
+			//
+			std::vector<std::pair<ULONGLONG, std::string>> SignatureTypedefs;
+		};
+
+		//
+		// Location of the retained node.
+		//
+		struct NodeLocation
+		{
+			DWORD UnitIndex;
+			DWORD NodeIndex;
+		};
+
+		//
+		// First definition of the structural hash or of the name.
+		//
+		struct Claim
+		{
+			ULONGLONG FirstKey;
+			ULONGLONG Hash;
+			DWORD UnitIndex;
+		};
+
+		struct ClaimShard
+		{
+			std::mutex Lock;
+			std::unordered_map<ULONGLONG, Claim> Claims;
+			std::unordered_map<std::string, Claim> Names;
+		};
+
+		static const DWORD ClaimShardCount = 64;
+		static const ULONGLONG TypesSectionKey = 1ull << 63;
+
+		//
+		// Decodes one unit, computes structural hashes of its definitions
+		// and retains only the definitions claimed by the unit.
+		//
+		class UnitDecoder;
+
+		struct PendingUdt
+		{
+			DWORD UnitIndex;
+			const Node* Definition;
+			SYMBOL* Symbol;
+		};
+
+		bool
+		ReadSections(
+			MemoryImage& Image
+			);
+
+		bool
+		ReadUnitHeaders();
+
+		void
+		ClaimDefinition(
+			DWORD UnitIndex,
+			Node& Definition
+			);
+
+		//
+		// Names unnamed types of the type units after the typedefs
+		// in the other units (typedef struct { ... } foo_t;).
+		//
+		void
+		NameTypeUnitTypes();
+
+		//
+		// Symbol graph.
+		//
+
+		const Node*
+		FindNode(
+			DWORD& UnitIndex,
+			ULONGLONG Key,
+			BOOL IsTypeSignature
+			) const;
+
+		//
+		// Skips typedefs and qualifiers.
+		//
+		const Node*
+		ResolveType(
+			DWORD& UnitIndex,
+			ULONGLONG Key,
+			BOOL IsTypeSignature,
+			BOOL& IsConst,
+			BOOL& IsVolatile
+			) const;
+
+		//
+		// Pointers refer to the definition of the same name,
+		// members to the definition of the same structural hash.
+		//
+		const Node*
+		FindDefinition(
+			DWORD& UnitIndex,
+			const Node* Type,
+			BOOL ByName
+			) const;
+
+		SYMBOL*
+		NewSymbol(
+			enum SymTagEnum Tag,
+			DWORD Size
+			);
+
+		SYMBOL*
+		GetTypeSymbol(
+			DWORD UnitIndex,
+			ULONGLONG Key,
+			BOOL IsTypeSignature,
+			BOOL IsPointerTarget = FALSE
+			);
+
+		SYMBOL*
+		GetBaseTypeSymbol(
+			const Node* Type
+			);
+
+		SYMBOL*
+		GetArraySymbol(
+			SYMBOL* ElementType,
+			DWORD ElementCount
+			);
+
+		SYMBOL*
+		GetByteArraySymbol(
+			DWORD Size
+			);
+
+		SYMBOL*
+		GetVoidSymbol();
+
+		SYMBOL*
+		GetUdtSymbol(
+			DWORD UnitIndex,
+			const Node* Type,
+			BOOL IsPointerTarget
+			);
+
+		SYMBOL*
+		GetQualifiedSymbol(
+			SYMBOL* Symbol,
+			BOOL IsConst,
+			BOOL IsVolatile
+			);
+
+		void
+		InitUdtSymbol(
+			DWORD UnitIndex,
+			const Node* Definition,
+			SYMBOL* Symbol
+			);
+
+		void
+		InitEnumSymbol(
+			DWORD UnitIndex,
+			const Node* Definition,
+			SYMBOL* Symbol
+			);
+
+		static
+		ULONGLONG
+		HashName(
+			const std::string& Name
+			);
+
+		void
+		CollectUdtFields(
+			DWORD UnitIndex,
+			const Node* Definition,
+			ULONGLONG BaseOffset,
+			std::vector<SYMBOL_UDT_FIELD>& Fields
+			);
+
+	private:
+		Settings* m_Settings;
+
+		DWORD m_MachineType = 0;
+		CV_CFL_LANG m_Language = CV_CFL_C;
+		PDB::OpenError m_Error = PDB::OpenError::None;
+
+		Section m_Sections[SectionCount];
+		std::vector<Unit> m_Units;
+
+		//
+		// Signature of the type unit -> index of the unit.
+		//
+		std::unordered_map<ULONGLONG, DWORD> m_TypeUnits;
+
+		ClaimShard m_ClaimShards[ClaimShardCount];
+
+		//
+		// Structural hash -> retained definition.
+		//
+		std::unordered_map<ULONGLONG, NodeLocation> m_Definitions;
+
+		//
+		// Output of the Load().
+		//
+		SymbolMap* m_Symbols = nullptr;
+		SymbolNameMap* m_SymbolNames = nullptr;
+		SymbolSet* m_AllSymbols = nullptr;
+		SymbolNameArena* m_Names = nullptr;
+		DWORD m_NextTypeId = 1;
+
+		//
+		// Hash-consed symbols, the key is built from the properties of the type.
+		//
+		std::unordered_map<ULONGLONG, SYMBOL*> m_DefinitionSymbols;
+		std::unordered_map<std::string, SYMBOL*> m_DerivedSymbols;
+
+		//
+		// Definitions of structs/classes/unions which are not initialized yet.
+		//
+		std::vector<PendingUdt> m_PendingUdts;
+};
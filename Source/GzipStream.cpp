@@ -0,0 +1,338 @@
+#include "GzipStream.h"
+#include "WorkerThreads.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	static GzipStreamBuffer::Settings DefaultSettings;
+
+	//
+	// Flags of the gzip member header.
+	//
+
+	static const BYTE GzipFlagHeaderCrc = 0x02;
+	static const BYTE GzipFlagExtra     = 0x04;
+	static const BYTE GzipFlagName      = 0x08;
+	static const BYTE GzipFlagComment   = 0x10;
+
+	void
+	WriteLittleEndian(
+		std::ostream& OutputFile,
+		ULONG Value
+		)
+	{
+		char Bytes[4] = {
+			static_cast<char>(Value),
+			static_cast<char>(Value >> 8),
+			static_cast<char>(Value >> 16),
+			static_cast<char>(Value >> 24),
+		};
+
+		OutputFile.write(Bytes, sizeof(Bytes));
+	}
+}
+
+GzipStreamBuffer::GzipStreamBuffer(
+	Settings* GzipSettings
+	)
+{
+	m_Settings = GzipSettings ? GzipSettings : &DefaultSettings;
+
+	m_ThreadCount = WorkerThreads::GetCount(m_Settings->ThreadCount);
+
+	m_Buffer.resize(Deflate::WindowSize + m_Settings->ChunkSize);
+}
+
+GzipStreamBuffer::~GzipStreamBuffer()
+{
+	Close();
+}
+
+bool
+GzipStreamBuffer::Open(
+	const char* Filename
+	)
+{
+	m_OutputFile.open(Filename, std::ios::binary);
+
+	if (!m_OutputFile.is_open())
+	{
+		return false;
+	}
+
+	//
+	// ID1, ID2, CM = deflate, FLG, MTIME, XFL, OS = unknown
+	//
+
+	static const char Header[10] = {
+		'\x1F', '\x8B', '\x08', '\x00', '\x00', '\x00', '\x00', '\x00', '\x00', '\xFF'
+	};
+
+	m_OutputFile.write(Header, sizeof(Header));
+
+	m_DictionarySize = 0;
+	m_Crc32 = 0;
+	m_Size = 0;
+
+	setp(reinterpret_cast<char*>(m_Buffer.data()),
+	     reinterpret_cast<char*>(m_Buffer.data()) + m_Settings->ChunkSize);
+
+	return m_OutputFile.good();
+}
+
+bool
+GzipStreamBuffer::Close()
+{
+	if (!m_OutputFile.is_open())
+	{
+		return false;
+	}
+
+	if (pptr() != pbase())
+	{
+		CompressChunk();
+	}
+
+	WritePendingChunks(0);
+
+	std::vector<BYTE> FinalBlock;
+	Deflate::WriteFinalBlock(FinalBlock);
+
+	m_OutputFile.write(reinterpret_cast<const char*>(FinalBlock.data()), FinalBlock.size());
+
+	WriteLittleEndian(m_OutputFile, m_Crc32);
+	WriteLittleEndian(m_OutputFile, static_cast<ULONG>(m_Size));
+
+	bool Result = m_OutputFile.good();
+
+	m_OutputFile.close();
+	setp(nullptr, nullptr);
+
+	return Result;
+}
+
+GzipStreamBuffer::int_type
+GzipStreamBuffer::overflow(
+	int_type Character
+	)
+{
+	if (!m_OutputFile.is_open())
+	{
+		return traits_type::eof();
+	}
+
+	CompressChunk();
+
+	if (!traits_type::eq_int_type(Character, traits_type::eof()))
+	{
+		*pptr() = traits_type::to_char_type(Character);
+		pbump(1);
+	}
+
+	return traits_type::not_eof(Character);
+}
+
+int
+GzipStreamBuffer::sync()
+{
+	//
+	// Chunks are compressed only when they are full,
+	// std::endl would otherwise produce tiny blocks.
+	//
+	return 0;
+}
+
+void
+GzipStreamBuffer::CompressChunk()
+{
+	size_t ChunkSize = pptr() - pbase();
+	size_t TotalSize = m_DictionarySize + ChunkSize;
+
+	m_Crc32 = Crc32Update(m_Crc32, m_Buffer.data() + m_DictionarySize, ChunkSize);
+	m_Size += ChunkSize;
+
+	WritePendingChunks(m_ThreadCount - 1);
+
+	std::vector<BYTE> Data(m_Buffer.begin(), m_Buffer.begin() + TotalSize);
+	size_t DictionarySize = m_DictionarySize;
+
+	m_PendingChunks.push_back(std::async(std::launch::async, [](std::vector<BYTE> Data, size_t DictionarySize) {
+		std::vector<BYTE> Output;
+		Deflate::CompressChunk(Data.data(), DictionarySize, Data.size(), Output);
+		return Output;
+	}, std::move(Data), DictionarySize));
+
+	//
+	// The end of this chunk is the dictionary of the next one.
+	//
+
+	m_DictionarySize = (std::min)(TotalSize, Deflate::WindowSize);
+	memmove(m_Buffer.data(), m_Buffer.data() + TotalSize - m_DictionarySize, m_DictionarySize);
+
+	setp(reinterpret_cast<char*>(m_Buffer.data()) + m_DictionarySize,
+	     reinterpret_cast<char*>(m_Buffer.data()) + m_DictionarySize + m_Settings->ChunkSize);
+}
+
+void
+GzipStreamBuffer::WritePendingChunks(
+	size_t MaximumPending
+	)
+{
+	while (m_PendingChunks.size() > MaximumPending)
+	{
+		std::vector<BYTE> Output = m_PendingChunks.front().get();
+		m_PendingChunks.pop_front();
+
+		m_OutputFile.write(reinterpret_cast<const char*>(Output.data()), Output.size());
+	}
+}
+
+GzipOutputStream::GzipOutputStream(
+	GzipStreamBuffer::Settings* GzipSettings
+	)
+	: std::ostream(&m_StreamBuffer)
+	, m_StreamBuffer(GzipSettings)
+{
+
+}
+
+bool
+GzipOutputStream::Open(
+	const char* Filename
+	)
+{
+	if (!m_StreamBuffer.Open(Filename))
+	{
+		setstate(std::ios::failbit);
+		return false;
+	}
+
+	return true;
+}
+
+bool
+GzipOutputStream::Close()
+{
+	if (!m_StreamBuffer.Close())
+	{
+		setstate(std::ios::failbit);
+		return false;
+	}
+
+	return true;
+}
+
+bool
+GzipDecompress(
+	std::istream& Input,
+	std::ostream& Output
+	)
+{
+	Inflate Decompressor(Input);
+
+	auto ReadBytes = [&Decompressor](BYTE* Bytes, size_t Count) {
+		for (size_t i = 0; i < Count; i++)
+		{
+			if (!Decompressor.ReadByte(Bytes[i]))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	};
+
+	auto SkipString = [&Decompressor]() {
+		BYTE Character;
+
+		do
+		{
+			if (!Decompressor.ReadByte(Character))
+			{
+				return false;
+			}
+		} while (Character != 0);
+
+		return true;
+	};
+
+	for (bool FirstMember = true; ; FirstMember = false)
+	{
+		BYTE Header[10];
+
+		//
+		// Concatenated gzip files are valid gzip files.
+		//
+
+		if (!Decompressor.ReadByte(Header[0]))
+		{
+			return !FirstMember;
+		}
+
+		if (!ReadBytes(Header + 1, sizeof(Header) - 1) ||
+		    Header[0] != 0x1F || Header[1] != 0x8B || Header[2] != 0x08)
+		{
+			return false;
+		}
+
+		BYTE Flags = Header[3];
+
+		if (Flags & GzipFlagExtra)
+		{
+			BYTE ExtraLength[2];
+
+			if (!ReadBytes(ExtraLength, sizeof(ExtraLength)))
+			{
+				return false;
+			}
+
+			std::vector<BYTE> Extra(ExtraLength[0] | (ExtraLength[1] << 8));
+
+			if (!ReadBytes(Extra.data(), Extra.size()))
+			{
+				return false;
+			}
+		}
+
+		if (((Flags & GzipFlagName) && !SkipString()) ||
+		    ((Flags & GzipFlagComment) && !SkipString()))
+		{
+			return false;
+		}
+
+		if (Flags & GzipFlagHeaderCrc)
+		{
+			BYTE HeaderCrc[2];
+
+			if (!ReadBytes(HeaderCrc, sizeof(HeaderCrc)))
+			{
+				return false;
+			}
+		}
+
+		ULONG Crc32 = 0;
+		ULONGLONG Size = 0;
+
+		if (!Decompressor.Decompress(Output, Crc32, Size))
+		{
+			return false;
+		}
+
+		BYTE Trailer[8];
+
+		if (!ReadBytes(Trailer, sizeof(Trailer)))
+		{
+			return false;
+		}
+
+		ULONG ExpectedCrc32 = Trailer[0] | (Trailer[1] << 8) | (Trailer[2] << 16) | (static_cast<ULONG>(Trailer[3]) << 24);
+		ULONG ExpectedSize  = Trailer[4] | (Trailer[5] << 8) | (Trailer[6] << 16) | (static_cast<ULONG>(Trailer[7]) << 24);
+
+		if (Crc32 != ExpectedCrc32 || static_cast<ULONG>(Size) != ExpectedSize)
+		{
+			return false;
+		}
+	}
+}
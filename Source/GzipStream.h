@@ -0,0 +1,118 @@
+#pragma once
+#include "Deflate.h"
+
+#include <deque>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//
+// Output stream buffer which writes a gzip file (RFC 1952).
+//
+// The data are split into chunks which are compressed
+// in parallel, each chunk uses the end of the previous one
+// as the dictionary. Compressed chunks are written in order,
+// so the output is one ordinary gzip member.
+//
+class GzipStreamBuffer
+	: public std::streambuf
+{
+	public:
+		struct Settings
+		{
+			//
+			// Size of the chunk which is compressed by one task.
+			//
+			size_t ChunkSize = 128 * 1024;
+
+			//
+			// Maximum count of chunks being compressed at once,
+			// 0 = count of CPUs.
+			//
+			DWORD ThreadCount = 0;
+		};
+
+		GzipStreamBuffer(
+			Settings* GzipSettings = nullptr
+			);
+
+		~GzipStreamBuffer();
+
+		bool
+		Open(
+			const char* Filename
+			);
+
+		bool
+		Close();
+
+	protected:
+		int_type
+		overflow(
+			int_type Character
+			) override;
+
+		int
+		sync() override;
+
+	private:
+		void
+		CompressChunk();
+
+		void
+		WritePendingChunks(
+			size_t MaximumPending
+			);
+
+	private:
+		Settings* m_Settings;
+
+		std::ofstream m_OutputFile;
+
+		//
+		// Dictionary (the end of the previous chunk)
+		// followed by the current chunk.
+		//
+		std::vector<BYTE> m_Buffer;
+		size_t m_DictionarySize = 0;
+
+		std::deque<std::future<std::vector<BYTE>>> m_PendingChunks;
+		DWORD m_ThreadCount;
+
+		ULONG m_Crc32 = 0;
+		ULONGLONG m_Size = 0;
+};
+
+class GzipOutputStream
+	: public std::ostream
+{
+	public:
+		GzipOutputStream(
+			GzipStreamBuffer::Settings* GzipSettings = nullptr
+			);
+
+		bool
+		Open(
+			const char* Filename
+			);
+
+		bool
+		Close();
+
+	private:
+		GzipStreamBuffer m_StreamBuffer;
+};
+
+//
+// Decompresses a gzip file (possibly with more members)
+// into the output.
+//
+// Returns false if the file is corrupted.
+//
+bool
+GzipDecompress(
+	std::istream& Input,
+	std::ostream& Output
+	);
@@ -0,0 +1,643 @@
+#include "HeaderFileSystem.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cwctype>
+
+namespace
+{
+	//
+	// Subset of projectedfslib.h (Windows SDK 10.0.17763),
+	// the project targets an older SDK.
+	//
+
+	typedef struct PRJ_NAMESPACE_VIRTUALIZATION_CONTEXT_* PRJ_NAMESPACE_VIRTUALIZATION_CONTEXT;
+	typedef struct PRJ_DIR_ENTRY_BUFFER_HANDLE_* PRJ_DIR_ENTRY_BUFFER_HANDLE;
+
+	static const UINT32 PRJ_PLACEHOLDER_ID_LENGTH = 128;
+
+	static const UINT32 PRJ_CB_DATA_FLAG_ENUM_RESTART_SCAN = 0x00000001;
+
+	static const UINT32 PRJ_NOTIFY_PRE_DELETE = 0x00000010;
+	static const UINT32 PRJ_NOTIFY_PRE_RENAME = 0x00000020;
+	static const UINT32 PRJ_NOTIFY_PRE_SET_HARDLINK = 0x00000040;
+	static const UINT32 PRJ_NOTIFY_FILE_PRE_CONVERT_TO_FULL = 0x00001000;
+
+	typedef struct PRJ_PLACEHOLDER_VERSION_INFO
+	{
+		UINT8 ProviderID[PRJ_PLACEHOLDER_ID_LENGTH];
+		UINT8 ContentID[PRJ_PLACEHOLDER_ID_LENGTH];
+	} PRJ_PLACEHOLDER_VERSION_INFO;
+
+	typedef struct PRJ_FILE_BASIC_INFO
+	{
+		BOOLEAN IsDirectory;
+		INT64 FileSize;
+		LARGE_INTEGER CreationTime;
+		LARGE_INTEGER LastAccessTime;
+		LARGE_INTEGER LastWriteTime;
+		LARGE_INTEGER ChangeTime;
+		UINT32 FileAttributes;
+	} PRJ_FILE_BASIC_INFO;
+
+	typedef struct PRJ_PLACEHOLDER_INFO
+	{
+		PRJ_FILE_BASIC_INFO FileBasicInfo;
+
+		struct
+		{
+			UINT32 EaBufferSize;
+			UINT32 OffsetToFirstEa;
+		} EaInformation;
+
+		struct
+		{
+			UINT32 SecurityBufferSize;
+			UINT32 OffsetToSecurityDescriptor;
+		} SecurityInformation;
+
+		struct
+		{
+			UINT32 StreamsInfoBufferSize;
+			UINT32 OffsetToFirstStreamInfo;
+		} StreamsInformation;
+
+		PRJ_PLACEHOLDER_VERSION_INFO VersionInfo;
+		UINT8 VariableData[ANYSIZE_ARRAY];
+	} PRJ_PLACEHOLDER_INFO;
+
+	typedef struct PRJ_CALLBACK_DATA
+	{
+		UINT32 Size;
+		UINT32 Flags;
+		PRJ_NAMESPACE_VIRTUALIZATION_CONTEXT NamespaceVirtualizationContext;
+		INT32 CommandId;
+		GUID FileId;
+		GUID DataStreamId;
+		PCWSTR FilePathName;
+		PRJ_PLACEHOLDER_VERSION_INFO* VersionInfo;
+		UINT32 TriggeringProcessId;
+		PCWSTR TriggeringProcessImageFileName;
+		void* InstanceContext;
+	} PRJ_CALLBACK_DATA;
+
+	typedef HRESULT (CALLBACK PRJ_START_DIRECTORY_ENUMERATION_CB)(const PRJ_CALLBACK_DATA*, const GUID*);
+	typedef HRESULT (CALLBACK PRJ_END_DIRECTORY_ENUMERATION_CB)(const PRJ_CALLBACK_DATA*, const GUID*);
+	typedef HRESULT (CALLBACK PRJ_GET_DIRECTORY_ENUMERATION_CB)(const PRJ_CALLBACK_DATA*, const GUID*, PCWSTR, PRJ_DIR_ENTRY_BUFFER_HANDLE);
+	typedef HRESULT (CALLBACK PRJ_GET_PLACEHOLDER_INFO_CB)(const PRJ_CALLBACK_DATA*);
+	typedef HRESULT (CALLBACK PRJ_GET_FILE_DATA_CB)(const PRJ_CALLBACK_DATA*, UINT64, UINT32);
+	typedef HRESULT (CALLBACK PRJ_QUERY_FILE_NAME_CB)(const PRJ_CALLBACK_DATA*);
+	typedef HRESULT (CALLBACK PRJ_NOTIFICATION_CB)(const PRJ_CALLBACK_DATA*, BOOLEAN, UINT32, PCWSTR, void*);
+	typedef void (CALLBACK PRJ_CANCEL_COMMAND_CB)(const PRJ_CALLBACK_DATA*);
+
+	typedef struct PRJ_CALLBACKS
+	{
+		PRJ_START_DIRECTORY_ENUMERATION_CB* StartDirectoryEnumerationCallback;
+		PRJ_END_DIRECTORY_ENUMERATION_CB* EndDirectoryEnumerationCallback;
+		PRJ_GET_DIRECTORY_ENUMERATION_CB* GetDirectoryEnumerationCallback;
+		PRJ_GET_PLACEHOLDER_INFO_CB* GetPlaceholderInfoCallback;
+		PRJ_GET_FILE_DATA_CB* GetFileDataCallback;
+		PRJ_QUERY_FILE_NAME_CB* QueryFileNameCallback;
+		PRJ_NOTIFICATION_CB* NotificationCallback;
+		PRJ_CANCEL_COMMAND_CB* CancelCommandCallback;
+	} PRJ_CALLBACKS;
+
+	typedef struct PRJ_NOTIFICATION_MAPPING
+	{
+		UINT32 NotificationBitMask;
+		PCWSTR NotificationRoot;
+	} PRJ_NOTIFICATION_MAPPING;
+
+	typedef struct PRJ_STARTVIRTUALIZING_OPTIONS
+	{
+		UINT32 Flags;
+		UINT32 PoolThreadCount;
+		UINT32 ConcurrentThreadCount;
+		PRJ_NOTIFICATION_MAPPING* NotificationMappings;
+		UINT32 NotificationMappingsCount;
+	} PRJ_STARTVIRTUALIZING_OPTIONS;
+
+	struct ProjectedFileSystemLibrary
+	{
+		HRESULT (WINAPI* PrjMarkDirectoryAsPlaceholder)(PCWSTR, PCWSTR, const PRJ_PLACEHOLDER_VERSION_INFO*, const GUID*);
+		HRESULT (WINAPI* PrjStartVirtualizing)(PCWSTR, const PRJ_CALLBACKS*, const void*, const PRJ_STARTVIRTUALIZING_OPTIONS*, PRJ_NAMESPACE_VIRTUALIZATION_CONTEXT*);
+		void    (WINAPI* PrjStopVirtualizing)(PRJ_NAMESPACE_VIRTUALIZATION_CONTEXT);
+		HRESULT (WINAPI* PrjFillDirEntryBuffer)(PCWSTR, PRJ_FILE_BASIC_INFO*, PRJ_DIR_ENTRY_BUFFER_HANDLE);
+		HRESULT (WINAPI* PrjWritePlaceholderInfo)(PRJ_NAMESPACE_VIRTUALIZATION_CONTEXT, PCWSTR, const PRJ_PLACEHOLDER_INFO*, UINT32);
+		HRESULT (WINAPI* PrjWriteFileData)(PRJ_NAMESPACE_VIRTUALIZATION_CONTEXT, const GUID*, void*, UINT64, UINT32);
+		void*   (WINAPI* PrjAllocateAlignedBuffer)(PRJ_NAMESPACE_VIRTUALIZATION_CONTEXT, size_t);
+		void    (WINAPI* PrjFreeAlignedBuffer)(void*);
+		BOOLEAN (WINAPI* PrjFileNameMatch)(PCWSTR, PCWSTR);
+		int     (WINAPI* PrjFileNameCompare)(PCWSTR, PCWSTR);
+	};
+
+	static ProjectedFileSystemLibrary Prj;
+
+	template <typename T>
+	bool
+	LoadFunction(
+		HMODULE Library,
+		const char* Name,
+		T& Function
+		)
+	{
+		Function = reinterpret_cast<T>(GetProcAddress(Library, Name));
+		return Function != nullptr;
+	}
+
+	inline
+	std::string
+	GetGuidKey(
+		const GUID* Guid
+		)
+	{
+		return std::string(reinterpret_cast<const char*>(Guid), sizeof(GUID));
+	}
+
+	inline
+	std::wstring
+	ToWideString(
+		const std::string& String
+		)
+	{
+		std::wstring Result(String.size(), L'\0');
+
+		int Length = MultiByteToWideChar(CP_ACP, 0, String.c_str(), static_cast<int>(String.size()), &Result[0], static_cast<int>(Result.size()));
+		Result.resize(static_cast<size_t>((std::max)(Length, 0)));
+
+		return Result;
+	}
+}
+
+//
+// ProjFS callbacks, InstanceContext is the HeaderFileSystem.
+// Exceptions must not leave them.
+//
+
+struct HeaderFileSystemCallbacks
+{
+	static
+	HeaderFileSystem*
+	GetFileSystem(
+		const PRJ_CALLBACK_DATA* CallbackData
+		)
+	{
+		return static_cast<HeaderFileSystem*>(CallbackData->InstanceContext);
+	}
+
+	static
+	HRESULT CALLBACK
+	StartDirectoryEnumeration(
+		const PRJ_CALLBACK_DATA* CallbackData,
+		const GUID* EnumerationId
+		)
+	{
+		HeaderFileSystem* FileSystem = GetFileSystem(CallbackData);
+
+		size_t Directory = FileSystem->FindEntry(CallbackData->FilePathName);
+
+		if (Directory == HeaderFileSystem::npos || !FileSystem->m_Entries[Directory].IsDirectory)
+		{
+			return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+		}
+
+		try
+		{
+			std::lock_guard<std::mutex> Lock(FileSystem->m_EnumerationsLock);
+			FileSystem->m_Enumerations[GetGuidKey(EnumerationId)] = { Directory, 0, std::wstring() };
+		}
+		catch (...)
+		{
+			return E_OUTOFMEMORY;
+		}
+
+		return S_OK;
+	}
+
+	static
+	HRESULT CALLBACK
+	EndDirectoryEnumeration(
+		const PRJ_CALLBACK_DATA* CallbackData,
+		const GUID* EnumerationId
+		)
+	{
+		HeaderFileSystem* FileSystem = GetFileSystem(CallbackData);
+
+		std::lock_guard<std::mutex> Lock(FileSystem->m_EnumerationsLock);
+		FileSystem->m_Enumerations.erase(GetGuidKey(EnumerationId));
+
+		return S_OK;
+	}
+
+	static
+	HRESULT CALLBACK
+	GetDirectoryEnumeration(
+		const PRJ_CALLBACK_DATA* CallbackData,
+		const GUID* EnumerationId,
+		PCWSTR SearchExpression,
+		PRJ_DIR_ENTRY_BUFFER_HANDLE DirEntryBufferHandle
+		)
+	{
+		HeaderFileSystem* FileSystem = GetFileSystem(CallbackData);
+
+		std::lock_guard<std::mutex> Lock(FileSystem->m_EnumerationsLock);
+
+		//
+		// Sizes of the files may be changed by the rendering.
+		//
+
+		std::lock_guard<std::mutex> RenderLock(FileSystem->m_RenderLock);
+
+		auto It = FileSystem->m_Enumerations.find(GetGuidKey(EnumerationId));
+
+		if (It == FileSystem->m_Enumerations.end())
+		{
+			return E_INVALIDARG;
+		}
+
+		HeaderFileSystem::Enumeration& CurrentEnumeration = It->second;
+
+		//
+		// The search expression is given by the first call of the scan.
+		//
+
+		if (CallbackData->Flags & PRJ_CB_DATA_FLAG_ENUM_RESTART_SCAN)
+		{
+			CurrentEnumeration.Position = 0;
+			CurrentEnumeration.Filter.clear();
+		}
+
+		if (CurrentEnumeration.Position == 0 && CurrentEnumeration.Filter.empty())
+		{
+			CurrentEnumeration.Filter = SearchExpression && *SearchExpression ? SearchExpression : L"*";
+		}
+
+		const auto& Children = FileSystem->m_Entries[CurrentEnumeration.Directory].Children;
+		size_t FilledCount = 0;
+
+		for (; CurrentEnumeration.Position < Children.size(); CurrentEnumeration.Position++)
+		{
+			const HeaderFileSystem::Entry& Child = FileSystem->m_Entries[Children[CurrentEnumeration.Position]];
+
+			if (!Prj.PrjFileNameMatch(Child.Name.c_str(), CurrentEnumeration.Filter.c_str()))
+			{
+				continue;
+			}
+
+			//
+			// Files which have not been rendered yet are listed with zero size,
+			// the real size is reported when they are opened.
+			//
+
+			PRJ_FILE_BASIC_INFO BasicInfo = { 0 };
+			BasicInfo.IsDirectory = Child.IsDirectory;
+			BasicInfo.FileSize = static_cast<INT64>(Child.Contents.size());
+			BasicInfo.FileAttributes = Child.IsDirectory ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_READONLY;
+
+			HRESULT Result = Prj.PrjFillDirEntryBuffer(Child.Name.c_str(), &BasicInfo, DirEntryBufferHandle);
+
+			if (FAILED(Result))
+			{
+				//
+				// The buffer is full, the rest is returned by the next call.
+				//
+
+				return FilledCount == 0 ? Result : S_OK;
+			}
+
+			FilledCount++;
+		}
+
+		return S_OK;
+	}
+
+	static
+	HRESULT CALLBACK
+	GetPlaceholderInfo(
+		const PRJ_CALLBACK_DATA* CallbackData
+		)
+	{
+		HeaderFileSystem* FileSystem = GetFileSystem(CallbackData);
+
+		size_t Index = FileSystem->FindEntry(CallbackData->FilePathName);
+
+		if (Index == HeaderFileSystem::npos)
+		{
+			return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+		}
+
+		const HeaderFileSystem::Entry& CurrentEntry = FileSystem->m_Entries[Index];
+
+		PRJ_PLACEHOLDER_INFO PlaceholderInfo;
+		memset(&PlaceholderInfo, 0, sizeof(PlaceholderInfo));
+
+		PlaceholderInfo.FileBasicInfo.IsDirectory = CurrentEntry.IsDirectory;
+		PlaceholderInfo.FileBasicInfo.FileAttributes = CurrentEntry.IsDirectory ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_READONLY;
+
+		if (!CurrentEntry.IsDirectory)
+		{
+			try
+			{
+				PlaceholderInfo.FileBasicInfo.FileSize = static_cast<INT64>(FileSystem->GetContents(Index).size());
+			}
+			catch (...)
+			{
+				return E_FAIL;
+			}
+		}
+
+		//
+		// The placeholder gets the case of the name as it was added.
+		//
+
+		return Prj.PrjWritePlaceholderInfo(
+			CallbackData->NamespaceVirtualizationContext,
+			CurrentEntry.Path.c_str(),
+			&PlaceholderInfo,
+			sizeof(PlaceholderInfo)
+			);
+	}
+
+	static
+	HRESULT CALLBACK
+	GetFileData(
+		const PRJ_CALLBACK_DATA* CallbackData,
+		UINT64 ByteOffset,
+		UINT32 Length
+		)
+	{
+		HeaderFileSystem* FileSystem = GetFileSystem(CallbackData);
+
+		size_t Index = FileSystem->FindEntry(CallbackData->FilePathName);
+
+		if (Index == HeaderFileSystem::npos || FileSystem->m_Entries[Index].IsDirectory)
+		{
+			return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+		}
+
+		const std::string* Contents;
+
+		try
+		{
+			Contents = &FileSystem->GetContents(Index);
+		}
+		catch (...)
+		{
+			return E_FAIL;
+		}
+
+		if (ByteOffset > Contents->size() || Length > Contents->size() - ByteOffset)
+		{
+			return E_INVALIDARG;
+		}
+
+		void* Buffer = Prj.PrjAllocateAlignedBuffer(CallbackData->NamespaceVirtualizationContext, Length);
+
+		if (Buffer == nullptr)
+		{
+			return E_OUTOFMEMORY;
+		}
+
+		memcpy(Buffer, Contents->data() + ByteOffset, Length);
+
+		HRESULT Result = Prj.PrjWriteFileData(
+			CallbackData->NamespaceVirtualizationContext,
+			&CallbackData->DataStreamId,
+			Buffer,
+			ByteOffset,
+			Length
+			);
+
+		Prj.PrjFreeAlignedBuffer(Buffer);
+
+		return Result;
+	}
+
+	static
+	HRESULT CALLBACK
+	Notification(
+		const PRJ_CALLBACK_DATA* CallbackData,
+		BOOLEAN IsDirectory,
+		UINT32 NotificationType,
+		PCWSTR DestinationFileName,
+		void* OperationParameters
+		)
+	{
+		//
+		// Only the operations which would modify the directory
+		// are subscribed, deny all of them.
+		//
+
+		return HRESULT_FROM_WIN32(ERROR_ACCESS_DENIED);
+	}
+};
+
+HeaderFileSystem::HeaderFileSystem()
+{
+	m_Entries.emplace_back();
+	m_Entries.back().IsDirectory = true;
+
+	m_Paths[std::wstring()] = 0;
+}
+
+HeaderFileSystem::~HeaderFileSystem()
+{
+	Unmount();
+
+	if (m_Library != nullptr)
+	{
+		FreeLibrary(m_Library);
+	}
+}
+
+void
+HeaderFileSystem::AddFile(
+	const std::string& Path,
+	RenderCallback Render
+	)
+{
+	size_t Index = AddEntry(ToWideString(Path), false);
+
+	m_Entries[Index].Render = std::move(Render);
+}
+
+bool
+HeaderFileSystem::Mount(
+	const char* Directory
+	)
+{
+	if (m_Library == nullptr)
+	{
+		m_Library = LoadLibraryA("ProjectedFSLib.dll");
+
+		if (m_Library == nullptr ||
+		    !LoadFunction(m_Library, "PrjMarkDirectoryAsPlaceholder", Prj.PrjMarkDirectoryAsPlaceholder) ||
+		    !LoadFunction(m_Library, "PrjStartVirtualizing", Prj.PrjStartVirtualizing) ||
+		    !LoadFunction(m_Library, "PrjStopVirtualizing", Prj.PrjStopVirtualizing) ||
+		    !LoadFunction(m_Library, "PrjFillDirEntryBuffer", Prj.PrjFillDirEntryBuffer) ||
+		    !LoadFunction(m_Library, "PrjWritePlaceholderInfo", Prj.PrjWritePlaceholderInfo) ||
+		    !LoadFunction(m_Library, "PrjWriteFileData", Prj.PrjWriteFileData) ||
+		    !LoadFunction(m_Library, "PrjAllocateAlignedBuffer", Prj.PrjAllocateAlignedBuffer) ||
+		    !LoadFunction(m_Library, "PrjFreeAlignedBuffer", Prj.PrjFreeAlignedBuffer) ||
+		    !LoadFunction(m_Library, "PrjFileNameMatch", Prj.PrjFileNameMatch) ||
+		    !LoadFunction(m_Library, "PrjFileNameCompare", Prj.PrjFileNameCompare))
+		{
+			return false;
+		}
+	}
+
+	//
+	// Enumerations must be returned in the order of PrjFileNameCompare().
+	//
+
+	for (auto&& CurrentEntry : m_Entries)
+	{
+		std::sort(CurrentEntry.Children.begin(), CurrentEntry.Children.end(), [this](size_t Left, size_t Right) {
+			return Prj.PrjFileNameCompare(m_Entries[Left].Name.c_str(), m_Entries[Right].Name.c_str()) < 0;
+		});
+	}
+
+	if (CreateDirectoryA(Directory, nullptr) == FALSE &&
+	    GetLastError() != ERROR_ALREADY_EXISTS)
+	{
+		return false;
+	}
+
+	std::wstring RootPath = ToWideString(Directory);
+
+	//
+	// Directory which has been mounted before is already marked,
+	// the marking fails then and it is not an error.
+	//
+
+	GUID InstanceId;
+
+	if (FAILED(CoCreateGuid(&InstanceId)))
+	{
+		return false;
+	}
+
+	Prj.PrjMarkDirectoryAsPlaceholder(RootPath.c_str(), nullptr, nullptr, &InstanceId);
+
+	PRJ_CALLBACKS Callbacks = { 0 };
+	Callbacks.StartDirectoryEnumerationCallback = &HeaderFileSystemCallbacks::StartDirectoryEnumeration;
+	Callbacks.EndDirectoryEnumerationCallback   = &HeaderFileSystemCallbacks::EndDirectoryEnumeration;
+	Callbacks.GetDirectoryEnumerationCallback   = &HeaderFileSystemCallbacks::GetDirectoryEnumeration;
+	Callbacks.GetPlaceholderInfoCallback        = &HeaderFileSystemCallbacks::GetPlaceholderInfo;
+	Callbacks.GetFileDataCallback               = &HeaderFileSystemCallbacks::GetFileData;
+	Callbacks.NotificationCallback              = &HeaderFileSystemCallbacks::Notification;
+
+	PRJ_NOTIFICATION_MAPPING NotificationMapping;
+	NotificationMapping.NotificationBitMask =
+		PRJ_NOTIFY_PRE_DELETE |
+		PRJ_NOTIFY_PRE_RENAME |
+		PRJ_NOTIFY_PRE_SET_HARDLINK |
+		PRJ_NOTIFY_FILE_PRE_CONVERT_TO_FULL;
+	NotificationMapping.NotificationRoot = L"";
+
+	PRJ_STARTVIRTUALIZING_OPTIONS Options = { 0 };
+	Options.NotificationMappings = &NotificationMapping;
+	Options.NotificationMappingsCount = 1;
+
+	PRJ_NAMESPACE_VIRTUALIZATION_CONTEXT VirtualizationContext = nullptr;
+
+	if (FAILED(Prj.PrjStartVirtualizing(RootPath.c_str(), &Callbacks, this, &Options, &VirtualizationContext)))
+	{
+		return false;
+	}
+
+	m_VirtualizationContext = VirtualizationContext;
+
+	return true;
+}
+
+void
+HeaderFileSystem::Unmount()
+{
+	if (m_VirtualizationContext != nullptr)
+	{
+		Prj.PrjStopVirtualizing(static_cast<PRJ_NAMESPACE_VIRTUALIZATION_CONTEXT>(m_VirtualizationContext));
+		m_VirtualizationContext = nullptr;
+	}
+}
+
+size_t
+HeaderFileSystem::AddEntry(
+	const std::wstring& Path,
+	bool IsDirectory
+	)
+{
+	auto It = m_Paths.find(GetPathKey(Path));
+
+	if (It != m_Paths.end())
+	{
+		return It->second;
+	}
+
+	size_t Separator = Path.find_last_of(L'\\');
+
+	size_t Parent = Separator != std::wstring::npos
+		? AddEntry(Path.substr(0, Separator), true)
+		: 0;
+
+	size_t Index = m_Entries.size();
+
+	m_Entries.emplace_back();
+	m_Entries.back().Name = Separator != std::wstring::npos ? Path.substr(Separator + 1) : Path;
+	m_Entries.back().Path = Path;
+	m_Entries.back().IsDirectory = IsDirectory;
+
+	m_Entries[Parent].Children.push_back(Index);
+	m_Paths[GetPathKey(Path)] = Index;
+
+	return Index;
+}
+
+size_t
+HeaderFileSystem::FindEntry(
+	const wchar_t* Path
+	) const
+{
+	auto It = m_Paths.find(GetPathKey(Path ? Path : L""));
+
+	return It != m_Paths.end()
+		? It->second
+		: npos;
+}
+
+const std::string&
+HeaderFileSystem::GetContents(
+	size_t Index
+	)
+{
+	std::lock_guard<std::mutex> Lock(m_RenderLock);
+
+	Entry& CurrentEntry = m_Entries[Index];
+
+	if (!CurrentEntry.IsRendered)
+	{
+		CurrentEntry.Render(CurrentEntry.Contents);
+		CurrentEntry.IsRendered = true;
+	}
+
+	return CurrentEntry.Contents;
+}
+
+std::wstring
+HeaderFileSystem::GetPathKey(
+	const std::wstring& Path
+	)
+{
+	//
+	// Paths are case-insensitive.
+	//
+
+	std::wstring Key = Path;
+
+	for (auto&& Character : Key)
+	{
+		Character = static_cast<wchar_t>(towupper(Character));
+	}
+
+	return Key;
+}
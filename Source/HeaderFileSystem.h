@@ -0,0 +1,139 @@
+#pragma once
+#include <windows.h>
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//
+// Read-only directory of files rendered on demand, projected
+// by the Windows Projected File System (ProjFS, Windows 10 1809+).
+//
+// Files are registered with a callback which renders their contents.
+// The callback runs when the file is opened for the first time,
+// the contents are kept in memory and Windows keeps the hydrated
+// file in the directory, so every file is rendered at most once:
+//
+//   ntkrnlmp\3844DBB920174967BE7AA4A2C20430FA2\_EPROCESS.h
+//                                              ^ rendered on open
+//
+// ProjectedFSLib.dll is loaded at runtime, so the rest
+// of the program works where ProjFS is not enabled.
+//
+class HeaderFileSystem
+{
+	public:
+		using RenderCallback = std::function<void(std::string& Contents)>;
+
+		HeaderFileSystem();
+
+		~HeaderFileSystem();
+
+		//
+		// Path is relative to the root, directories are separated by '\'
+		// and are created implicitly.
+		//
+		void
+		AddFile(
+			const std::string& Path,
+			RenderCallback Render
+			);
+
+		//
+		// Returns false if ProjFS is not available
+		// or the directory cannot be virtualized.
+		//
+		bool
+		Mount(
+			const char* Directory
+			);
+
+		void
+		Unmount();
+
+	private:
+		friend struct HeaderFileSystemCallbacks;
+
+		struct Entry
+		{
+			std::wstring Name;
+
+			//
+			// Path relative to the root in the case it was added.
+			//
+			std::wstring Path;
+
+			bool IsDirectory;
+
+			//
+			// Children sorted in the order of PrjFileNameCompare().
+			//
+			std::vector<size_t> Children;
+
+			RenderCallback Render;
+
+			bool IsRendered = false;
+			std::string Contents;
+		};
+
+		struct Enumeration
+		{
+			size_t Directory;
+			size_t Position;
+			std::wstring Filter;
+		};
+
+		size_t
+		AddEntry(
+			const std::wstring& Path,
+			bool IsDirectory
+			);
+
+		//
+		// Returns npos if there is no such entry.
+		//
+		size_t
+		FindEntry(
+			const wchar_t* Path
+			) const;
+
+		//
+		// Renders the file if it has not been rendered yet.
+		//
+		const std::string&
+		GetContents(
+			size_t Index
+			);
+
+		static
+		std::wstring
+		GetPathKey(
+			const std::wstring& Path
+			);
+
+	private:
+		static const size_t npos = static_cast<size_t>(-1);
+
+		//
+		// Entry 0 is the root directory.
+		//
+		std::vector<Entry> m_Entries;
+		std::map<std::wstring, size_t> m_Paths;
+
+		//
+		// Directory enumerations in progress, keyed by their GUIDs.
+		//
+		std::map<std::string, Enumeration> m_Enumerations;
+		std::mutex m_EnumerationsLock;
+
+		//
+		// Rendering shares the state of the caller
+		// (e.g. the header reconstructor), one file at a time.
+		//
+		std::mutex m_RenderLock;
+
+		HMODULE m_Library = nullptr;
+		void* m_VirtualizationContext = nullptr;
+};
@@ -0,0 +1,142 @@
+#include "MemoryImage.h"
+
+#include <cstring>
+
+bool
+MemoryImage::Read(
+	ULONGLONG Address,
+	void* Buffer,
+	size_t Size
+	)
+{
+	const BYTE* Pointer = GetPointer(Address, Size);
+
+	if (Pointer == nullptr)
+	{
+		return false;
+	}
+
+	memcpy(Buffer, Pointer, Size);
+	return true;
+}
+
+bool
+MemoryImage::ReadPointer(
+	ULONGLONG Address,
+	DWORD PointerSize,
+	ULONGLONG& Value
+	)
+{
+	if (PointerSize == 4)
+	{
+		DWORD Value32;
+
+		if (!Read(Address, &Value32, sizeof(Value32)))
+		{
+			return false;
+		}
+
+		Value = Value32;
+		return true;
+	}
+
+	return Read(Address, &Value, sizeof(Value));
+}
+
+MappedMemoryImage::~MappedMemoryImage()
+{
+	Close();
+}
+
+bool
+MappedMemoryImage::Open(
+	const char* Path,
+	ULONGLONG BaseAddress
+	)
+{
+	Close();
+
+	m_FileHandle = CreateFileA(
+		Path,
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		nullptr
+		);
+
+	if (m_FileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER FileSize;
+
+	if (GetFileSizeEx(m_FileHandle, &FileSize) == FALSE || FileSize.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+
+	m_MappingHandle = CreateFileMappingA(m_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (m_MappingHandle == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	m_View = static_cast<const BYTE*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+
+	if (m_View == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	m_Size = static_cast<ULONGLONG>(FileSize.QuadPart);
+	m_BaseAddress = BaseAddress;
+
+	return true;
+}
+
+void
+MappedMemoryImage::Close()
+{
+	if (m_View != nullptr)
+	{
+		UnmapViewOfFile(m_View);
+		m_View = nullptr;
+	}
+
+	if (m_MappingHandle != nullptr)
+	{
+		CloseHandle(m_MappingHandle);
+		m_MappingHandle = nullptr;
+	}
+
+	if (m_FileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_FileHandle);
+		m_FileHandle = INVALID_HANDLE_VALUE;
+	}
+
+	m_Size = 0;
+}
+
+const BYTE*
+MappedMemoryImage::GetPointer(
+	ULONGLONG Address,
+	size_t Size
+	)
+{
+	if (Address < m_BaseAddress ||
+	    Address - m_BaseAddress > m_Size ||
+	    Size > m_Size - (Address - m_BaseAddress))
+	{
+		return nullptr;
+	}
+
+	return m_View + (Address - m_BaseAddress);
+}
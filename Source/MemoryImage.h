@@ -0,0 +1,131 @@
+#pragma once
+#include <windows.h>
+
+#include <string>
+#include <vector>
+
+//
+// Memory of the inspected system, addressed by the addresses
+// the objects have in that system.
+//
+class MemoryImage
+{
+	public:
+		struct Range
+		{
+			ULONGLONG Address;
+			size_t Size;
+		};
+
+		virtual
+		~MemoryImage() = default;
+
+		//
+		// Returns pointer to Size bytes at the Address,
+		// if they are continuously mapped into our address space.
+		//
+		// Returns nullptr otherwise (the data can be still
+		// available through Read()).
+		//
+		virtual
+		const BYTE*
+		GetPointer(
+			ULONGLONG Address,
+			size_t Size
+			)
+		{
+			return nullptr;
+		}
+
+		//
+		// Copies Size bytes at the Address into the Buffer.
+		//
+		// Returns false if any part of the range is not available.
+		//
+		virtual
+		bool
+		Read(
+			ULONGLONG Address,
+			void* Buffer,
+			size_t Size
+			);
+
+		//
+		// Hints that the ranges are going to be read,
+		// so the image can fetch them in as few requests as possible.
+		//
+		virtual
+		void
+		Prefetch(
+			const std::vector<Range>& Ranges
+			)
+		{
+
+		}
+
+		//
+		// Resolves well-known addresses the image knows about
+		// (e.g. "PsActiveProcessHead" stored in crash dumps).
+		//
+		virtual
+		bool
+		FindSymbol(
+			const std::string& Name,
+			ULONGLONG& Address
+			)
+		{
+			return false;
+		}
+
+		//
+		// Reads pointer of the inspected system.
+		//
+		bool
+		ReadPointer(
+			ULONGLONG Address,
+			DWORD PointerSize,
+			ULONGLONG& Value
+			);
+};
+
+//
+// Raw snapshot of a continuous range of memory mapped from a file,
+// the first byte of the file is at BaseAddress.
+//
+class MappedMemoryImage
+	: public MemoryImage
+{
+	public:
+		MappedMemoryImage() = default;
+
+		~MappedMemoryImage() override;
+
+		MappedMemoryImage(const MappedMemoryImage&) = delete;
+		MappedMemoryImage& operator=(const MappedMemoryImage&) = delete;
+
+		//
+		// Returns false if the file cannot be mapped.
+		//
+		bool
+		Open(
+			const char* Path,
+			ULONGLONG BaseAddress
+			);
+
+		void
+		Close();
+
+		const BYTE*
+		GetPointer(
+			ULONGLONG Address,
+			size_t Size
+			) override;
+
+	private:
+		HANDLE m_FileHandle = INVALID_HANDLE_VALUE;
+		HANDLE m_MappingHandle = nullptr;
+
+		const BYTE* m_View = nullptr;
+		ULONGLONG m_Size = 0;
+		ULONGLONG m_BaseAddress = 0;
+};
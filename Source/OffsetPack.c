@@ -0,0 +1,300 @@
+#include "OffsetPack.h"
+
+#include <string.h>
+
+static
+const OFFSET_PACK_HEADER*
+GetHeader(
+	const void* Pack
+	)
+{
+	return (const OFFSET_PACK_HEADER*)Pack;
+}
+
+static
+const void*
+GetPart(
+	const void* Pack,
+	uint32_t Offset
+	)
+{
+	return (const uint8_t*)Pack + Offset;
+}
+
+//
+// Returns non-zero value if Count items of ItemSize bytes
+// at the Offset fit into the Size.
+//
+static
+int
+IsInBounds(
+	uint32_t Offset,
+	uint32_t Count,
+	uint32_t ItemSize,
+	uint32_t Size
+	)
+{
+	return Offset <= Size && (uint64_t)Count * ItemSize <= Size - Offset;
+}
+
+//
+// Parts are read by aligned loads.
+//
+static
+int
+IsAligned(
+	uint32_t Offset
+	)
+{
+	return (Offset & 3) == 0;
+}
+
+//
+// Checks the header and bounds of the parts of the fixed size,
+// does not walk the groups and the layout indices.
+//
+static
+int
+IsHeaderValid(
+	const void* Pack,
+	size_t PackSize
+	)
+{
+	const OFFSET_PACK_HEADER* Header = GetHeader(Pack);
+
+	if (((uintptr_t)Pack & 3) != 0 ||
+	    PackSize < sizeof(OFFSET_PACK_HEADER) ||
+	    Header->Magic != OFFSET_PACK_MAGIC ||
+	    Header->Version != OFFSET_PACK_VERSION ||
+	    Header->Size > PackSize)
+	{
+		return 0;
+	}
+
+	if (!IsAligned(Header->FieldsOffset) ||
+	    !IsAligned(Header->GroupsOffset) ||
+	    !IsAligned(Header->BuildsOffset) ||
+	    !IsAligned(Header->LayoutIndicesOffset))
+	{
+		return 0;
+	}
+
+	return IsInBounds(Header->FieldsOffset, Header->FieldCount, sizeof(OFFSET_PACK_FIELD), Header->Size) &&
+	       IsInBounds(Header->GroupsOffset, Header->GroupCount, sizeof(OFFSET_PACK_GROUP), Header->Size) &&
+	       IsInBounds(Header->BuildsOffset, Header->BuildCount, sizeof(OFFSET_PACK_BUILD), Header->Size) &&
+	       (uint64_t)Header->BuildCount * Header->GroupCount <= 0xFFFFFFFF &&
+	       IsInBounds(Header->LayoutIndicesOffset, Header->BuildCount * Header->GroupCount, sizeof(uint16_t), Header->Size);
+}
+
+uint32_t
+OffsetPackHashModuleName(
+	const char* ModuleName
+	)
+{
+	const char* Begin = ModuleName;
+	const char* End = NULL;
+	const char* Position;
+	uint32_t Hash = 2166136261u;
+
+	//
+	// Strip the directory and the extension.
+	//
+
+	for (Position = ModuleName; *Position; Position++)
+	{
+		if (*Position == '\\' || *Position == '/' || *Position == ':')
+		{
+			Begin = Position + 1;
+			End = NULL;
+		}
+		else if (*Position == '.')
+		{
+			End = Position;
+		}
+	}
+
+	if (End == NULL)
+	{
+		End = Position;
+	}
+
+	for (Position = Begin; Position < End; Position++)
+	{
+		uint8_t Character = (uint8_t)*Position;
+
+		if (Character >= 'A' && Character <= 'Z')
+		{
+			Character += 'a' - 'A';
+		}
+
+		Hash = (Hash ^ Character) * 16777619u;
+	}
+
+	return Hash;
+}
+
+int
+OffsetPackCompareBuild(
+	const OFFSET_PACK_BUILD* Left,
+	const OFFSET_PACK_BUILD* Right
+	)
+{
+	int Result;
+
+	if (Left->ModuleHash != Right->ModuleHash)
+	{
+		return Left->ModuleHash < Right->ModuleHash ? -1 : 1;
+	}
+
+	Result = memcmp(Left->Guid, Right->Guid, sizeof(Left->Guid));
+
+	if (Result != 0)
+	{
+		return Result;
+	}
+
+	if (Left->Age != Right->Age)
+	{
+		return Left->Age < Right->Age ? -1 : 1;
+	}
+
+	return 0;
+}
+
+int
+OffsetPackValidate(
+	const void* Pack,
+	size_t PackSize
+	)
+{
+	const OFFSET_PACK_HEADER* Header = GetHeader(Pack);
+	const OFFSET_PACK_FIELD* Fields;
+	const OFFSET_PACK_GROUP* Groups;
+	const uint16_t* LayoutIndices;
+	uint32_t Index;
+
+	if (!IsHeaderValid(Pack, PackSize))
+	{
+		return 0;
+	}
+
+	Fields = (const OFFSET_PACK_FIELD*)GetPart(Pack, Header->FieldsOffset);
+	Groups = (const OFFSET_PACK_GROUP*)GetPart(Pack, Header->GroupsOffset);
+
+	for (Index = 0; Index < Header->GroupCount; Index++)
+	{
+		if (!IsAligned(Groups[Index].LayoutsOffset) ||
+		    (uint64_t)Groups[Index].LayoutCount * Groups[Index].FieldCount > 0xFFFFFFFF ||
+		    !IsInBounds(Groups[Index].LayoutsOffset, Groups[Index].LayoutCount * Groups[Index].FieldCount, sizeof(uint32_t), Header->Size))
+		{
+			return 0;
+		}
+	}
+
+	for (Index = 0; Index < Header->FieldCount; Index++)
+	{
+		if (Fields[Index].Group >= Header->GroupCount ||
+		    Fields[Index].Index >= Groups[Fields[Index].Group].FieldCount)
+		{
+			return 0;
+		}
+	}
+
+	LayoutIndices = (const uint16_t*)GetPart(Pack, Header->LayoutIndicesOffset);
+
+	for (Index = 0; Index < Header->BuildCount * Header->GroupCount; Index++)
+	{
+		if (LayoutIndices[Index] >= Groups[Index % Header->GroupCount].LayoutCount)
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+const OFFSET_PACK_BUILD*
+OffsetPackFindBuild(
+	const void* Pack,
+	size_t PackSize,
+	const char* ModuleName,
+	const uint8_t Guid[16],
+	uint32_t Age
+	)
+{
+	const OFFSET_PACK_HEADER* Header = GetHeader(Pack);
+	const OFFSET_PACK_BUILD* Builds;
+	OFFSET_PACK_BUILD Key;
+	uint32_t Low;
+	uint32_t High;
+
+	//
+	// The rest of the pack is checked once by OffsetPackValidate().
+	//
+
+	if (!IsHeaderValid(Pack, PackSize))
+	{
+		return NULL;
+	}
+
+	Key.ModuleHash = OffsetPackHashModuleName(ModuleName);
+	memcpy(Key.Guid, Guid, sizeof(Key.Guid));
+	Key.Age = Age;
+
+	Builds = (const OFFSET_PACK_BUILD*)GetPart(Pack, Header->BuildsOffset);
+
+	Low = 0;
+	High = Header->BuildCount;
+
+	while (Low < High)
+	{
+		uint32_t Middle = Low + (High - Low) / 2;
+		int Result = OffsetPackCompareBuild(&Builds[Middle], &Key);
+
+		if (Result == 0)
+		{
+			return &Builds[Middle];
+		}
+
+		if (Result < 0)
+		{
+			Low = Middle + 1;
+		}
+		else
+		{
+			High = Middle;
+		}
+	}
+
+	return NULL;
+}
+
+uint32_t
+OffsetPackGetOffset(
+	const void* Pack,
+	const OFFSET_PACK_BUILD* Build,
+	uint32_t FieldIndex
+	)
+{
+	const OFFSET_PACK_HEADER* Header = GetHeader(Pack);
+	const OFFSET_PACK_FIELD* Field;
+	const OFFSET_PACK_GROUP* Group;
+	const uint16_t* LayoutIndices;
+	const uint32_t* Layouts;
+	uint32_t BuildIndex;
+
+	if (FieldIndex >= Header->FieldCount)
+	{
+		return OFFSET_PACK_MISSING;
+	}
+
+	Field = (const OFFSET_PACK_FIELD*)GetPart(Pack, Header->FieldsOffset) + FieldIndex;
+	Group = (const OFFSET_PACK_GROUP*)GetPart(Pack, Header->GroupsOffset) + Field->Group;
+
+	BuildIndex = (uint32_t)(Build - (const OFFSET_PACK_BUILD*)GetPart(Pack, Header->BuildsOffset));
+
+	LayoutIndices = (const uint16_t*)GetPart(Pack, Header->LayoutIndicesOffset);
+	Layouts = (const uint32_t*)GetPart(Pack, Group->LayoutsOffset);
+
+	return Layouts[LayoutIndices[BuildIndex * Header->GroupCount + Field->Group] * Group->FieldCount + Field->Index];
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+//
+// Offset pack - field offsets of many builds of modules,
+// written by pdbex --offset-pack, read by this C reader.
+//
+// The reader does not allocate, does not depend on the C runtime
+// (except of memcmp and memcpy) and can be copied into drivers and agents.
+//
+// Layout (little-endian, every part aligned to 4 bytes):
+//
+//   OFFSET_PACK_HEADER
+//   OFFSET_PACK_FIELD   Fields[FieldCount]        order of the fields file
+//   OFFSET_PACK_GROUP   Groups[GroupCount]        one group per type
+//   OFFSET_PACK_BUILD   Builds[BuildCount]        sorted by the key
+//   uint16_t            LayoutIndices[BuildCount][GroupCount]
+//   uint32_t            Layouts[...]              [LayoutCount][FieldCount] of every group
+//
+// Builds which share the layout of a type share one row of the Layouts,
+// so a new build usually adds only its key and the layout indices.
+//
+// Usage:
+//
+//   if (!OffsetPackValidate(Pack, PackSize))       once, when the pack is loaded
+//   {
+//     return;
+//   }
+//
+//   const OFFSET_PACK_BUILD* Build = OffsetPackFindBuild(Pack, PackSize, "ntkrnlmp", Guid, Age);
+//
+//   if (Build != NULL)
+//   {
+//     uint32_t ActiveProcessLinks = OffsetPackGetOffset(Pack, Build, 0);
+//   }
+//
+// Module name, Guid and Age are the ones of the CodeView (RSDS) record
+// in the debug directory of the loaded module.
+//
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OFFSET_PACK_MAGIC     0x4B505850 // "PXPK"
+#define OFFSET_PACK_VERSION   1
+
+//
+// Offset of the field which is not present in the build.
+//
+#define OFFSET_PACK_MISSING   0xFFFFFFFF
+
+typedef struct _OFFSET_PACK_HEADER
+{
+	uint32_t Magic;
+	uint32_t Version;
+
+	//
+	// Size of the whole pack in bytes.
+	//
+	uint32_t Size;
+
+	uint32_t FieldCount;
+	uint32_t GroupCount;
+	uint32_t BuildCount;
+
+	//
+	// Offsets of the parts from the beginning of the pack.
+	//
+	uint32_t FieldsOffset;
+	uint32_t GroupsOffset;
+	uint32_t BuildsOffset;
+	uint32_t LayoutIndicesOffset;
+
+} OFFSET_PACK_HEADER;
+
+typedef struct _OFFSET_PACK_FIELD
+{
+	//
+	// Group of the type of the field and the position in the group.
+	//
+	uint32_t Group;
+	uint32_t Index;
+
+} OFFSET_PACK_FIELD;
+
+typedef struct _OFFSET_PACK_GROUP
+{
+	uint32_t FieldCount;
+	uint32_t LayoutCount;
+
+	//
+	// Offset of uint32_t[LayoutCount][FieldCount].
+	//
+	uint32_t LayoutsOffset;
+
+} OFFSET_PACK_GROUP;
+
+typedef struct _OFFSET_PACK_BUILD
+{
+	//
+	// OffsetPackHashModuleName() of the module name.
+	//
+	uint32_t ModuleHash;
+
+	uint8_t  Guid[16];
+	uint32_t Age;
+
+} OFFSET_PACK_BUILD;
+
+//
+// FNV-1a of the lowercase module name without directory and extension,
+// so the PDB path of the CodeView record can be passed directly:
+//
+//   "ntkrnlmp", "ntkrnlmp.pdb" and "d:\\symbols\\ntkrnlmp.pdb" are equal.
+//
+uint32_t
+OffsetPackHashModuleName(
+	const char* ModuleName
+	);
+
+//
+// Returns negative, zero or positive value, as memcmp().
+//
+int
+OffsetPackCompareBuild(
+	const OFFSET_PACK_BUILD* Left,
+	const OFFSET_PACK_BUILD* Right
+	);
+
+//
+// Checks the header, alignment and bounds of all parts of the pack
+// and all layout indices. The check walks the whole pack, call it
+// once when the pack is loaded, before any other function.
+//
+// The pack must be aligned to 4 bytes.
+//
+// Returns non-zero value if the pack is valid.
+//
+int
+OffsetPackValidate(
+	const void* Pack,
+	size_t PackSize
+	);
+
+//
+// Binary search of the build in the pack checked by OffsetPackValidate(),
+// only the header and the bounds of the builds are checked again.
+//
+// Returns NULL if the header is not valid or the build is not in the pack.
+//
+const OFFSET_PACK_BUILD*
+OffsetPackFindBuild(
+	const void* Pack,
+	size_t PackSize,
+	const char* ModuleName,
+	const uint8_t Guid[16],
+	uint32_t Age
+	);
+
+//
+// Returns OFFSET_PACK_MISSING if the field is not present in the build.
+//
+uint32_t
+OffsetPackGetOffset(
+	const void* Pack,
+	const OFFSET_PACK_BUILD* Build,
+	uint32_t FieldIndex
+	);
+
+#ifdef __cplusplus
+}
+#endif
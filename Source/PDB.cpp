@@ -1,8 +1,11 @@
 #include "PDB.h"
+#include "DwarfTypeLoader.h"
 
 #include <dia2.h>       // IDia* interfaces
 
+#include <algorithm>
 #include <cassert>
+#include <cctype>
 
 //
 // For string converting:
@@ -17,6 +20,18 @@
 namespace
 {
 	static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> string_converter;
+
+	std::string
+	ToLowerCase(
+		std::string Text
+		)
+	{
+		std::transform(Text.begin(), Text.end(), Text.begin(), [](unsigned char c) {
+			return static_cast<char>(tolower(c));
+		});
+
+		return Text;
+	}
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -156,12 +171,19 @@ class SymbolModule
 
 		BOOL
 		Open(
-			IN const CHAR* Path
+			IN const CHAR* Path,
+			IN DWORD ThreadCount
 			);
 
 		BOOL
 		IsOpened() const;
 
+		PDB::OpenError
+		GetOpenError() const;
+
+		BOOL
+		IsElfFile() const;
+
 		const CHAR*
 		GetPath() const;
 
@@ -174,6 +196,17 @@ class SymbolModule
 		CV_CFL_LANG
 		GetLanguage() const;
 
+		BOOL
+		GetSignature(
+			OUT GUID& Guid,
+			OUT DWORD& Age
+			) const;
+
+		BOOL
+		GetName(
+			OUT std::string& Name
+			) const;
+
 		SYMBOL*
 		GetSymbolByName(
 			IN const CHAR* SymbolName
@@ -205,10 +238,59 @@ class SymbolModule
 		const SymbolMap&
 		GetSymbolMap() const;
 
-		const SymbolNameMap&
-		GetSymbolNameMap() const;
+		const SymbolNameIndex&
+		GetSymbolNameIndex() const;
+
+		BOOL
+		GetModuleSymbols(
+			IN const CHAR* ModuleName,
+			OUT SymbolList& Symbols
+			);
+
+		BOOL
+		GetLines(
+			OUT std::vector<SYMBOL_LINE>& Lines,
+			OUT std::vector<std::string>& FileNames
+			);
+
+		BOOL
+		GetFrameData(
+			OUT std::vector<SYMBOL_FRAME_DATA>& FrameData
+			);
+
+		BOOL
+		GetCodeSymbols(
+			OUT std::vector<SYMBOL_CODE>& CodeSymbols
+			);
 
 	private:
+		//
+		// Enums and UDTs referenced by one compiland.
+		//
+		struct ModuleTypes
+		{
+			std::string Name;
+			std::string LibraryName;
+			std::vector<SYMBOL*> Types;
+		};
+
+		VOID
+		BuildModuleTypeMap();
+
+		VOID
+		CollectScopeTypes(
+			IN IDiaSymbol* DiaScopeSymbol,
+			IN ModuleTypes& Module,
+			IN std::unordered_set<DWORD>& VisitedTypeIds
+			);
+
+		VOID
+		CollectType(
+			IN IDiaSymbol* DiaTypeSymbol,
+			IN ModuleTypes& Module,
+			IN std::unordered_set<DWORD>& VisitedTypeIds
+			);
+
 		VOID
 		InitSymbol(
 			IN IDiaSymbol* DiaSymbol,
@@ -268,14 +350,32 @@ class SymbolModule
 			IN SYMBOL* Symbol
 			);
 
+		VOID
+		AddPaddingField(
+			IN SYMBOL* Symbol
+			);
+
 	private:
 		std::string   m_Path;
 		SymbolMap     m_SymbolMap;
-		SymbolNameMap m_SymbolNameMap;
+		SymbolNameIndex m_SymbolNameIndex;
+		SymbolNameArena m_SymbolNames;
+		std::vector<CHAR> m_SymbolNameBuffer;
 		SymbolSet     m_SymbolSet;
 
 		DWORD         m_MachineType;
 		CV_CFL_LANG   m_Language;
+
+		std::vector<ModuleTypes> m_Modules;
+		BOOL                     m_ModuleTypeMapBuilt = FALSE;
+
+		//
+		// Types are loaded from the DWARF of the ELF file,
+		// there is no DIA session.
+		//
+		BOOL                     m_IsElfFile = FALSE;
+
+		PDB::OpenError           m_OpenError = PDB::OpenError::None;
 };
 
 SymbolModule::SymbolModule()
@@ -290,18 +390,77 @@ SymbolModule::~SymbolModule()
 
 BOOL
 SymbolModule::Open(
-	IN const CHAR* Path
+	IN const CHAR* Path,
+	IN DWORD ThreadCount
 	)
 {
 	BOOL Result;
 
+	m_OpenError = PDB::OpenError::None;
+
+	if (DwarfTypeLoader::IsElfFile(Path))
+	{
+		DwarfTypeLoader::Settings LoaderSettings;
+		LoaderSettings.ThreadCount = ThreadCount;
+
+		DwarfTypeLoader Loader(&LoaderSettings);
+
+		SymbolNameMap SymbolNames;
+
+		if (!Loader.Load(Path, m_SymbolMap, SymbolNames, m_SymbolSet, m_SymbolNames))
+		{
+			Close();
+			m_OpenError = Loader.GetError();
+			return FALSE;
+		}
+
+		for (auto&& e : SymbolNames)
+		{
+			m_SymbolNameIndex.Insert(e.first, e.second);
+		}
+
+		SymbolNameMap().swap(SymbolNames);
+		m_SymbolNameIndex.Compact();
+		m_SymbolNames.Compact();
+
+		m_MachineType = Loader.GetMachineType();
+		m_Language = Loader.GetLanguage();
+
+		//
+		// Padding symbols are inserted into the m_SymbolSet.
+		//
+
+		std::vector<SYMBOL*> UdtSymbols;
+
+		for (auto&& e : m_SymbolMap)
+		{
+			if (e.second->Tag == SymTagUDT)
+			{
+				UdtSymbols.push_back(e.second);
+			}
+		}
+
+		for (auto&& Symbol : UdtSymbols)
+		{
+			AddPaddingField(Symbol);
+		}
+
+		m_Path = Path;
+		m_IsElfFile = TRUE;
+
+		return TRUE;
+	}
+
 	Result = SymbolModuleBase::Open(Path);
 
 	if (Result == FALSE)
 	{
+		m_OpenError = PDB::OpenError::NotFound;
 		return FALSE;
 	}
 
+	m_Path = Path;
+
 	m_GlobalSymbol->get_machineType(&m_MachineType);
 
 	DWORD Language;
@@ -310,13 +469,33 @@ SymbolModule::Open(
 
 	BuildSymbolMap();
 
+	//
+	// Names of C++ templates are long and they are stored
+	// in the m_SymbolNames already, the index keeps them front-coded.
+	//
+
+	m_SymbolNameIndex.Compact();
+	m_SymbolNames.Compact();
+
 	return TRUE;
 }
 
 BOOL
 SymbolModule::IsOpened() const
 {
-	return SymbolModuleBase::IsOpened();
+	return m_IsElfFile || SymbolModuleBase::IsOpened();
+}
+
+PDB::OpenError
+SymbolModule::GetOpenError() const
+{
+	return m_OpenError;
+}
+
+BOOL
+SymbolModule::IsElfFile() const
+{
+	return m_IsElfFile;
 }
 
 const CHAR*
@@ -338,8 +517,14 @@ SymbolModule::Close()
 
 	m_Path.clear();
 	m_SymbolMap.clear();
-	m_SymbolNameMap.clear();
+	m_SymbolNameIndex.Clear();
+	m_SymbolNames.Clear();
 	m_SymbolSet.clear();
+
+	m_Modules.clear();
+	m_ModuleTypeMapBuilt = FALSE;
+
+	m_IsElfFile = FALSE;
 }
 
 DWORD
@@ -354,6 +539,40 @@ SymbolModule::GetLanguage() const
 	return m_Language;
 }
 
+BOOL
+SymbolModule::GetSignature(
+	OUT GUID& Guid,
+	OUT DWORD& Age
+	) const
+{
+	if (m_GlobalSymbol == nullptr)
+	{
+		return FALSE;
+	}
+
+	return m_GlobalSymbol->get_guid(&Guid) == S_OK &&
+	       m_GlobalSymbol->get_age(&Age) == S_OK;
+}
+
+BOOL
+SymbolModule::GetName(
+	OUT std::string& Name
+	) const
+{
+	BSTR NameBstr;
+
+	if (m_GlobalSymbol == nullptr ||
+	    m_GlobalSymbol->get_name(&NameBstr) != S_OK)
+	{
+		return FALSE;
+	}
+
+	Name = string_converter.to_bytes(NameBstr);
+	SysFreeString(NameBstr);
+
+	return !Name.empty();
+}
+
 CHAR*
 SymbolModule::GetSymbolName(
 	IN IDiaSymbol* DiaSymbol
@@ -374,14 +593,19 @@ SymbolModule::GetSymbolName(
 	// BSTR is essentially a wide char string.
 	// Since we work in multibyte character set,
 	// we need to convert it.
+	// The converted name is copied into the arena,
+	// the symbols of the module share its copies.
 	//
 
-	CHAR*  SymbolNameMb;
 	size_t SymbolNameLength;
 
-	SymbolNameLength = SysStringLen(SymbolNameBstr) + 1;
-	SymbolNameMb = new CHAR[SymbolNameLength];
-	wcstombs(SymbolNameMb, SymbolNameBstr, SymbolNameLength);
+	m_SymbolNameBuffer.resize(SysStringLen(SymbolNameBstr) * MB_CUR_MAX + 1);
+	SymbolNameLength = wcstombs(m_SymbolNameBuffer.data(), SymbolNameBstr, m_SymbolNameBuffer.size());
+
+	if (SymbolNameLength == static_cast<size_t>(-1))
+	{
+		SymbolNameLength = 0;
+	}
 
 	//
 	// BSTR is supposed to be freed by this call.
@@ -389,7 +613,7 @@ SymbolModule::GetSymbolName(
 
 	SysFreeString(SymbolNameBstr);
 
-	return SymbolNameMb;
+	return m_SymbolNames.Add(m_SymbolNameBuffer.data(), SymbolNameLength);
 }
 
 SYMBOL*
@@ -397,8 +621,7 @@ SymbolModule::GetSymbolByName(
 	IN const CHAR* SymbolName
 	)
 {
-	auto it = m_SymbolNameMap.find(SymbolName);
-	return it == m_SymbolNameMap.end() ? nullptr : it->second;
+	return m_SymbolNameIndex.Find(SymbolName);
 }
 
 SYMBOL*
@@ -434,7 +657,7 @@ SymbolModule::GetSymbol(
 
 	if (Symbol->Name)
 	{
-		m_SymbolNameMap[Symbol->Name] = Symbol;
+		m_SymbolNameIndex.Insert(Symbol->Name, Symbol);
 	}
 
 	return Symbol;
@@ -476,10 +699,559 @@ SymbolModule::GetSymbolMap() const
 	return m_SymbolMap;
 }
 
-const SymbolNameMap&
-SymbolModule::GetSymbolNameMap() const
+const SymbolNameIndex&
+SymbolModule::GetSymbolNameIndex() const
+{
+	return m_SymbolNameIndex;
+}
+
+BOOL
+SymbolModule::GetModuleSymbols(
+	IN const CHAR* ModuleName,
+	OUT SymbolList& Symbols
+	)
+{
+	if (m_GlobalSymbol == nullptr)
+	{
+		return FALSE;
+	}
+
+	if (!m_ModuleTypeMapBuilt)
+	{
+		BuildModuleTypeMap();
+	}
+
+	auto FileName = [](const std::string& Path) {
+		return Path.substr(Path.find_last_of("\\/") + 1);
+	};
+
+	std::string Name = ToLowerCase(ModuleName);
+
+	BOOL Found = FALSE;
+	std::unordered_set<const SYMBOL*> CollectedSymbols;
+
+	Symbols.clear();
+
+	for (auto&& Module : m_Modules)
+	{
+		if (Name != Module.Name && Name != FileName(Module.Name) &&
+		    Name != Module.LibraryName && Name != FileName(Module.LibraryName))
+		{
+			continue;
+		}
+
+		Found = TRUE;
+
+		for (auto&& Symbol : Module.Types)
+		{
+			if (CollectedSymbols.insert(Symbol).second)
+			{
+				Symbols.push_back(Symbol);
+			}
+		}
+	}
+
+	return Found;
+}
+
+BOOL
+SymbolModule::GetLines(
+	OUT std::vector<SYMBOL_LINE>& Lines,
+	OUT std::vector<std::string>& FileNames
+	)
 {
-	return m_SymbolNameMap;
+	Lines.clear();
+	FileNames.clear();
+
+	if (m_GlobalSymbol == nullptr)
+	{
+		return FALSE;
+	}
+
+	//
+	// Lines are stored per module (C13 line subsections),
+	// source files are referenced by their unique ID
+	// (offset in the file checksum subsection).
+	//
+
+	std::unordered_map<DWORD, DWORD> FileIndices;
+
+	IDiaEnumSymbols* DiaSymbolEnumerator;
+
+	if (FAILED(m_GlobalSymbol->findChildren(SymTagCompiland, NULL, nsNone, &DiaSymbolEnumerator)))
+	{
+		return FALSE;
+	}
+
+	IDiaSymbol* DiaCompilandSymbol;
+	ULONG FetchedSymbolCount = 0;
+
+	while (SUCCEEDED(DiaSymbolEnumerator->Next(1, &DiaCompilandSymbol, &FetchedSymbolCount)) && (FetchedSymbolCount == 1))
+	{
+		IDiaEnumSourceFiles* DiaSourceFileEnumerator;
+
+		if (FAILED(m_Session->findFile(DiaCompilandSymbol, NULL, nsNone, &DiaSourceFileEnumerator)))
+		{
+			DiaCompilandSymbol->Release();
+			continue;
+		}
+
+		IDiaSourceFile* DiaSourceFile;
+		ULONG FetchedFileCount = 0;
+
+		while (SUCCEEDED(DiaSourceFileEnumerator->Next(1, &DiaSourceFile, &FetchedFileCount)) && (FetchedFileCount == 1))
+		{
+			DWORD FileId;
+			DiaSourceFile->get_uniqueId(&FileId);
+
+			auto FileIterator = FileIndices.find(FileId);
+
+			if (FileIterator == FileIndices.end())
+			{
+				BSTR FileNameBstr;
+				std::string FileName;
+
+				if (DiaSourceFile->get_fileName(&FileNameBstr) == S_OK)
+				{
+					FileName = string_converter.to_bytes(FileNameBstr);
+					SysFreeString(FileNameBstr);
+				}
+
+				FileIterator = FileIndices.emplace(FileId, static_cast<DWORD>(FileNames.size())).first;
+				FileNames.push_back(FileName);
+			}
+
+			IDiaEnumLineNumbers* DiaLineEnumerator;
+
+			if (SUCCEEDED(m_Session->findLines(DiaCompilandSymbol, DiaSourceFile, &DiaLineEnumerator)))
+			{
+				//
+				// Fetch lines in batches, one call per line
+				// is the dominant cost for large PDBs.
+				//
+
+				IDiaLineNumber* DiaLines[256];
+				ULONG FetchedLineCount = 0;
+
+				while (SUCCEEDED(DiaLineEnumerator->Next(_countof(DiaLines), DiaLines, &FetchedLineCount)) && (FetchedLineCount > 0))
+				{
+					for (ULONG Index = 0; Index < FetchedLineCount; Index++)
+					{
+						SYMBOL_LINE Line;
+						DiaLines[Index]->get_relativeVirtualAddress(&Line.RelativeVirtualAddress);
+						DiaLines[Index]->get_length(&Line.Length);
+						DiaLines[Index]->get_lineNumber(&Line.LineNumber);
+						Line.FileIndex = FileIterator->second;
+
+						Lines.push_back(Line);
+
+						DiaLines[Index]->Release();
+					}
+				}
+
+				DiaLineEnumerator->Release();
+			}
+
+			DiaSourceFile->Release();
+		}
+
+		DiaSourceFileEnumerator->Release();
+		DiaCompilandSymbol->Release();
+	}
+
+	DiaSymbolEnumerator->Release();
+
+	return !Lines.empty();
+}
+
+BOOL
+SymbolModule::GetFrameData(
+	OUT std::vector<SYMBOL_FRAME_DATA>& FrameData
+	)
+{
+	FrameData.clear();
+
+	if (m_GlobalSymbol == nullptr)
+	{
+		return FALSE;
+	}
+
+	//
+	// Both FPO and FrameData streams are exposed
+	// by the table which implements IDiaEnumFrameData.
+	//
+
+	IDiaEnumTables* DiaTableEnumerator;
+
+	if (FAILED(m_Session->getEnumTables(&DiaTableEnumerator)))
+	{
+		return FALSE;
+	}
+
+	IDiaTable* DiaTable;
+	ULONG FetchedTableCount = 0;
+
+	while (SUCCEEDED(DiaTableEnumerator->Next(1, &DiaTable, &FetchedTableCount)) && (FetchedTableCount == 1))
+	{
+		IDiaEnumFrameData* DiaFrameDataEnumerator;
+
+		if (SUCCEEDED(DiaTable->QueryInterface(__uuidof(IDiaEnumFrameData), (void**)&DiaFrameDataEnumerator)))
+		{
+			IDiaFrameData* DiaFrameData;
+			ULONG FetchedFrameDataCount = 0;
+
+			while (SUCCEEDED(DiaFrameDataEnumerator->Next(1, &DiaFrameData, &FetchedFrameDataCount)) && (FetchedFrameDataCount == 1))
+			{
+				SYMBOL_FRAME_DATA Record;
+
+				DiaFrameData->get_relativeVirtualAddress(&Record.RelativeVirtualAddress);
+				DiaFrameData->get_lengthBlock(&Record.Length);
+				DiaFrameData->get_lengthLocals(&Record.LocalsLength);
+				DiaFrameData->get_lengthParams(&Record.ParamsLength);
+				DiaFrameData->get_lengthSavedRegisters(&Record.SavedRegistersLength);
+				DiaFrameData->get_lengthProlog(&Record.PrologLength);
+				DiaFrameData->get_type(&Record.Type);
+				DiaFrameData->get_allocatesBasePointer(&Record.AllocatesBasePointer);
+
+				BSTR ProgramBstr;
+
+				if (DiaFrameData->get_program(&ProgramBstr) == S_OK)
+				{
+					Record.Program = string_converter.to_bytes(ProgramBstr);
+					SysFreeString(ProgramBstr);
+				}
+
+				FrameData.push_back(std::move(Record));
+
+				DiaFrameData->Release();
+			}
+
+			DiaFrameDataEnumerator->Release();
+		}
+
+		DiaTable->Release();
+	}
+
+	DiaTableEnumerator->Release();
+
+	return !FrameData.empty();
+}
+
+BOOL
+SymbolModule::GetCodeSymbols(
+	OUT std::vector<SYMBOL_CODE>& CodeSymbols
+	)
+{
+	CodeSymbols.clear();
+
+	if (m_GlobalSymbol == nullptr)
+	{
+		return FALSE;
+	}
+
+	//
+	// UNDNAME_NAME_ONLY, only the name of the public symbol is kept
+	// (without the return type, the calling convention and the parameters).
+	//
+
+	static const DWORD UndecorateNameOnly = 0x1000;
+
+	auto AddCodeSymbol = [&CodeSymbols](IDiaSymbol* DiaSymbol, BOOL IsPublic) {
+		SYMBOL_CODE CodeSymbol;
+		ULONGLONG Length = 0;
+
+		if (DiaSymbol->get_relativeVirtualAddress(&CodeSymbol.RelativeVirtualAddress) != S_OK)
+		{
+			return;
+		}
+
+		DiaSymbol->get_length(&Length);
+		CodeSymbol.Length = static_cast<DWORD>(Length);
+		CodeSymbol.IsPublic = IsPublic;
+
+		BSTR NameBstr;
+
+		if ((IsPublic && DiaSymbol->get_undecoratedNameEx(UndecorateNameOnly, &NameBstr) == S_OK) ||
+		    DiaSymbol->get_name(&NameBstr) == S_OK)
+		{
+			CodeSymbol.Name = string_converter.to_bytes(NameBstr);
+			SysFreeString(NameBstr);
+		}
+
+		CodeSymbols.push_back(std::move(CodeSymbol));
+	};
+
+	IDiaEnumSymbols* DiaSymbolEnumerator;
+	IDiaSymbol* DiaSymbols[256];
+	ULONG FetchedSymbolCount = 0;
+
+	//
+	// Functions are children of their compilands.
+	//
+
+	if (SUCCEEDED(m_GlobalSymbol->findChildren(SymTagCompiland, NULL, nsNone, &DiaSymbolEnumerator)))
+	{
+		IDiaSymbol* DiaCompilandSymbol;
+		ULONG FetchedCompilandCount = 0;
+
+		while (SUCCEEDED(DiaSymbolEnumerator->Next(1, &DiaCompilandSymbol, &FetchedCompilandCount)) && (FetchedCompilandCount == 1))
+		{
+			IDiaEnumSymbols* DiaFunctionEnumerator;
+
+			if (SUCCEEDED(DiaCompilandSymbol->findChildren(SymTagFunction, NULL, nsNone, &DiaFunctionEnumerator)))
+			{
+				while (SUCCEEDED(DiaFunctionEnumerator->Next(_countof(DiaSymbols), DiaSymbols, &FetchedSymbolCount)) && (FetchedSymbolCount > 0))
+				{
+					for (ULONG Index = 0; Index < FetchedSymbolCount; Index++)
+					{
+						AddCodeSymbol(DiaSymbols[Index], FALSE);
+						DiaSymbols[Index]->Release();
+					}
+				}
+
+				DiaFunctionEnumerator->Release();
+			}
+
+			DiaCompilandSymbol->Release();
+		}
+
+		DiaSymbolEnumerator->Release();
+	}
+
+	//
+	// Public symbols cover also the modules without private symbols,
+	// only the public symbols of the code are collected.
+	//
+
+	if (SUCCEEDED(m_GlobalSymbol->findChildren(SymTagPublicSymbol, NULL, nsNone, &DiaSymbolEnumerator)))
+	{
+		while (SUCCEEDED(DiaSymbolEnumerator->Next(_countof(DiaSymbols), DiaSymbols, &FetchedSymbolCount)) && (FetchedSymbolCount > 0))
+		{
+			for (ULONG Index = 0; Index < FetchedSymbolCount; Index++)
+			{
+				BOOL IsCode = FALSE;
+
+				if (DiaSymbols[Index]->get_code(&IsCode) == S_OK && IsCode)
+				{
+					AddCodeSymbol(DiaSymbols[Index], TRUE);
+				}
+
+				DiaSymbols[Index]->Release();
+			}
+		}
+
+		DiaSymbolEnumerator->Release();
+	}
+
+	return !CodeSymbols.empty();
+}
+
+VOID
+SymbolModule::BuildModuleTypeMap()
+{
+	//
+	// Every compiland (module of the DBI stream) is one object file,
+	// its children are the records of the module symbol stream.
+	//
+
+	m_ModuleTypeMapBuilt = TRUE;
+
+	IDiaEnumSymbols* DiaSymbolEnumerator;
+
+	if (FAILED(m_GlobalSymbol->findChildren(SymTagCompiland, NULL, nsNone, &DiaSymbolEnumerator)))
+	{
+		return;
+	}
+
+	IDiaSymbol* DiaCompilandSymbol;
+	ULONG FetchedSymbolCount = 0;
+
+	while (SUCCEEDED(DiaSymbolEnumerator->Next(1, &DiaCompilandSymbol, &FetchedSymbolCount)) && (FetchedSymbolCount == 1))
+	{
+		ModuleTypes Module;
+
+		CHAR* CompilandName = GetSymbolName(DiaCompilandSymbol);
+
+		if (CompilandName)
+		{
+			Module.Name = CompilandName;
+		}
+
+		BSTR LibraryNameBstr;
+
+		if (DiaCompilandSymbol->get_libraryName(&LibraryNameBstr) == S_OK)
+		{
+			Module.LibraryName = string_converter.to_bytes(LibraryNameBstr);
+			SysFreeString(LibraryNameBstr);
+		}
+
+		Module.Name = ToLowerCase(Module.Name);
+		Module.LibraryName = ToLowerCase(Module.LibraryName);
+
+		std::unordered_set<DWORD> VisitedTypeIds;
+		CollectScopeTypes(DiaCompilandSymbol, Module, VisitedTypeIds);
+
+		//
+		// Forward declaration and definition of the same type
+		// are collected as one symbol, keep the first occurrence
+		// and keep the index compact.
+		//
+
+		std::unordered_set<SYMBOL*> CollectedSymbols;
+
+		Module.Types.erase(std::remove_if(Module.Types.begin(), Module.Types.end(), [&CollectedSymbols](SYMBOL* Symbol) {
+			return !CollectedSymbols.insert(Symbol).second;
+		}), Module.Types.end());
+
+		Module.Types.shrink_to_fit();
+		m_Modules.push_back(std::move(Module));
+
+		DiaCompilandSymbol->Release();
+	}
+
+	DiaSymbolEnumerator->Release();
+}
+
+VOID
+SymbolModule::CollectScopeTypes(
+	IN IDiaSymbol* DiaScopeSymbol,
+	IN ModuleTypes& Module,
+	IN std::unordered_set<DWORD>& VisitedTypeIds
+	)
+{
+	IDiaEnumSymbols* DiaSymbolEnumerator;
+
+	if (FAILED(DiaScopeSymbol->findChildren(SymTagNull, NULL, nsNone, &DiaSymbolEnumerator)))
+	{
+		return;
+	}
+
+	IDiaSymbol* DiaChildSymbol;
+	ULONG FetchedSymbolCount = 0;
+
+	while (SUCCEEDED(DiaSymbolEnumerator->Next(1, &DiaChildSymbol, &FetchedSymbolCount)) && (FetchedSymbolCount == 1))
+	{
+		DWORD Tag;
+		DiaChildSymbol->get_symTag(&Tag);
+
+		IDiaSymbol* DiaTypeSymbol;
+
+		switch (Tag)
+		{
+			case SymTagUDT:
+			case SymTagEnum:
+				CollectType(DiaChildSymbol, Module, VisitedTypeIds);
+				break;
+
+			case SymTagFunction:
+			case SymTagBlock:
+			case SymTagData:
+			case SymTagTypedef:
+				if (DiaChildSymbol->get_type(&DiaTypeSymbol) == S_OK)
+				{
+					CollectType(DiaTypeSymbol, Module, VisitedTypeIds);
+					DiaTypeSymbol->Release();
+				}
+
+				//
+				// Locals, parameters and nested blocks.
+				//
+
+				if (Tag == SymTagFunction || Tag == SymTagBlock)
+				{
+					CollectScopeTypes(DiaChildSymbol, Module, VisitedTypeIds);
+				}
+				break;
+
+			default:
+				break;
+		}
+
+		DiaChildSymbol->Release();
+	}
+
+	DiaSymbolEnumerator->Release();
+}
+
+VOID
+SymbolModule::CollectType(
+	IN IDiaSymbol* DiaTypeSymbol,
+	IN ModuleTypes& Module,
+	IN std::unordered_set<DWORD>& VisitedTypeIds
+	)
+{
+	DWORD TypeId;
+	DiaTypeSymbol->get_symIndexId(&TypeId);
+
+	if (!VisitedTypeIds.insert(TypeId).second)
+	{
+		return;
+	}
+
+	DWORD Tag;
+	DiaTypeSymbol->get_symTag(&Tag);
+
+	IDiaSymbol* DiaUnderlyingSymbol;
+
+	switch (Tag)
+	{
+		case SymTagUDT:
+		case SymTagEnum:
+			{
+				//
+				// Pointers usually refer to the forward declaration,
+				// prefer the definition of the same name.
+				//
+
+				CHAR* Name = GetSymbolName(DiaTypeSymbol);
+				SYMBOL* Symbol = Name ? GetSymbolByName(Name) : nullptr;
+
+				if (Symbol == nullptr)
+				{
+					Symbol = GetSymbol(DiaTypeSymbol);
+				}
+
+				Module.Types.push_back(Symbol);
+			}
+			break;
+
+		case SymTagFunctionType:
+			{
+				IDiaEnumSymbols* DiaSymbolEnumerator;
+
+				if (SUCCEEDED(DiaTypeSymbol->findChildren(SymTagNull, NULL, nsNone, &DiaSymbolEnumerator)))
+				{
+					IDiaSymbol* DiaArgumentSymbol;
+					ULONG FetchedSymbolCount = 0;
+
+					while (SUCCEEDED(DiaSymbolEnumerator->Next(1, &DiaArgumentSymbol, &FetchedSymbolCount)) && (FetchedSymbolCount == 1))
+					{
+						CollectType(DiaArgumentSymbol, Module, VisitedTypeIds);
+						DiaArgumentSymbol->Release();
+					}
+
+					DiaSymbolEnumerator->Release();
+				}
+			}
+
+			//
+			// Return type.
+			//
+
+		case SymTagPointerType:
+		case SymTagArrayType:
+		case SymTagTypedef:
+		case SymTagFunctionArgType:
+			if (DiaTypeSymbol->get_type(&DiaUnderlyingSymbol) == S_OK)
+			{
+				CollectType(DiaUnderlyingSymbol, Module, VisitedTypeIds);
+				DiaUnderlyingSymbol->Release();
+			}
+			break;
+
+		default:
+			break;
+	}
 }
 
 VOID
@@ -771,14 +1543,20 @@ SymbolModule::ProcessSymbolUdt(
 
 	DiaSymbolEnumerator->Release();
 
-	//
-	// Padding.
-	//
+	AddPaddingField(Symbol);
+}
+
+VOID
+SymbolModule::AddPaddingField(
+	IN SYMBOL* Symbol
+	)
+{
 	if (Symbol->u.Udt.Kind == UdtStruct && Symbol->u.Udt.FieldCount > 0 && Symbol->u.Udt.Fields[Symbol->u.Udt.FieldCount - 1].Type != nullptr)
 	{
 		SYMBOL_UDT_FIELD* LastUdtField = &Symbol->u.Udt.Fields[Symbol->u.Udt.FieldCount - 1];
 		SYMBOL_UDT_FIELD* PaddingUdtField = &Symbol->u.Udt.Fields[Symbol->u.Udt.FieldCount];
-		DWORD PaddingSize = Symbol->Size - (LastUdtField->Offset + LastUdtField->Type->Size);
+		DWORD LastUdtFieldEnd = LastUdtField->Offset + LastUdtField->Type->Size;
+		DWORD PaddingSize = LastUdtFieldEnd < Symbol->Size ? Symbol->Size - LastUdtFieldEnd : 0;
 
 		if (PaddingSize > 0)
 		{
@@ -803,7 +1581,7 @@ SymbolModule::ProcessSymbolUdt(
 			PaddingSymbolArray->u.Array.ElementType = PaddingSymbolArrayElement;
 			PaddingSymbolArray->u.Array.ElementCount = PaddingSymbolArrayElement->BaseType == btLong ? PaddingSize / 4 : PaddingSize;
 
-			PaddingUdtField->Name = new CHAR[64];
+			PaddingUdtField->Name = m_SymbolNames.Add("__PADDING__");
 			PaddingUdtField->Type = PaddingSymbolArray;
 			PaddingUdtField->Offset = LastUdtField->Offset + LastUdtField->Type->Size;
 
@@ -811,8 +1589,6 @@ SymbolModule::ProcessSymbolUdt(
 			PaddingUdtField->BitPosition = 0;
 			PaddingUdtField->Parent = Symbol;
 
-			strcpy(PaddingUdtField->Name, "__PADDING__");
-
 			Symbol->u.Udt.FieldCount++;
 
 			m_SymbolSet.insert(PaddingSymbolArray);
@@ -825,25 +1601,17 @@ void SymbolModule::DestroySymbol(
 	IN SYMBOL* Symbol
 	)
 {
-	delete[] Symbol->Name;
+	//
+	// Names are owned by the m_SymbolNames.
+	//
 
 	switch (Symbol->Tag)
 	{
 		case SymTagUDT:
-			for (DWORD i = 0; i < Symbol->u.Udt.FieldCount; i++)
-			{
-				delete[] Symbol->u.Udt.Fields[i].Name;
-			}
-
 			delete[] Symbol->u.Udt.Fields;
 			break;
 
 		case SymTagEnum:
-			for (DWORD i = 0; i < Symbol->u.Enum.FieldCount; i++)
-			{
-				delete[] Symbol->u.Enum.Fields[i].Name;
-			}
-
 			delete[] Symbol->u.Enum.Fields;
 			break;
 
@@ -925,6 +1693,41 @@ BasicTypeMapElement BasicTypeMapStdInt[] = {
 	{ (BasicType)0,   0,  nullptr,            nullptr            },
 };
 
+//
+// Native types of the same size on every target
+// (ELF files are mostly LP64, where long is 8 bytes long).
+//
+
+BasicTypeMapElement BasicTypeMapPortable[] = {
+	{ btNoType,       0,  "btNoType",         nullptr              },
+	{ btVoid,         0,  "btVoid",           "void"               },
+	{ btChar,         1,  "btChar",           "char"               },
+	{ btWChar,        2,  "btWChar",          "wchar_t"            },
+	{ btInt,          1,  "btInt",            "char"               },
+	{ btInt,          2,  "btInt",            "short"              },
+	{ btInt,          4,  "btInt",            "int"                },
+	{ btInt,          8,  "btInt",            "long long"          },
+	{ btUInt,         1,  "btUInt",           "unsigned char"      },
+	{ btUInt,         2,  "btUInt",           "unsigned short"     },
+	{ btUInt,         4,  "btUInt",           "unsigned int"       },
+	{ btUInt,         8,  "btUInt",           "unsigned long long" },
+	{ btFloat,        4,  "btFloat",          "float"              },
+	{ btFloat,        8,  "btFloat",          "double"             },
+	{ btFloat,       10,  "btFloat",          "long double"        }, // 80-bit float
+	{ btBCD,          0,  "btBCD",            "BCD"                },
+	{ btBool,         0,  "btBool",           "BOOL"               },
+	{ btLong,         4,  "btLong",           "int"                },
+	{ btULong,        4,  "btULong",          "unsigned int"       },
+	{ btCurrency,     0,  "btCurrency",       nullptr              },
+	{ btDate,         0,  "btDate",           "DATE"               },
+	{ btVariant,      0,  "btVariant",        "VARIANT"            },
+	{ btComplex,      0,  "btComplex",        nullptr              },
+	{ btBit,          0,  "btBit",            nullptr              },
+	{ btBSTR,         0,  "btBSTR",           "BSTR"               },
+	{ btHresult,      4,  "btHresult",        "HRESULT"            },
+	{ (BasicType)0,   0,  nullptr,            nullptr              },
+};
+
 PDB::PDB()
 {
 	m_Impl = new SymbolModule();
@@ -935,7 +1738,7 @@ PDB::PDB(
 	)
 {
 	m_Impl = new SymbolModule();
-	m_Impl->Open(Path);
+	m_Impl->Open(Path, 0);
 }
 
 PDB::~PDB()
@@ -945,10 +1748,11 @@ PDB::~PDB()
 
 BOOL
 PDB::Open(
-	IN const CHAR* Path
+	IN const CHAR* Path,
+	IN DWORD ThreadCount
 	)
 {
-	return m_Impl->Open(Path);
+	return m_Impl->Open(Path, ThreadCount);
 }
 
 BOOL
@@ -957,6 +1761,18 @@ PDB::IsOpened() const
 	return m_Impl->IsOpened();
 }
 
+PDB::OpenError
+PDB::GetOpenError() const
+{
+	return m_Impl->GetOpenError();
+}
+
+BOOL
+PDB::IsElfFile() const
+{
+	return m_Impl->IsElfFile();
+}
+
 const CHAR*
 PDB::GetPath() const
 {
@@ -981,6 +1797,23 @@ PDB::GetLanguage() const
 	return m_Impl->GetLanguage();
 }
 
+BOOL
+PDB::GetSignature(
+	OUT GUID& Guid,
+	OUT DWORD& Age
+	) const
+{
+	return m_Impl->GetSignature(Guid, Age);
+}
+
+BOOL
+PDB::GetName(
+	OUT std::string& Name
+	) const
+{
+	return m_Impl->GetName(Name);
+}
+
 const SYMBOL*
 PDB::GetSymbolByName(
 	IN const CHAR* SymbolName
@@ -1003,20 +1836,57 @@ PDB::GetSymbolMap() const
 	return m_Impl->GetSymbolMap();
 }
 
-const SymbolNameMap&
-PDB::GetSymbolNameMap() const
+const SymbolNameIndex&
+PDB::GetSymbolNameIndex() const
+{
+	return m_Impl->GetSymbolNameIndex();
+}
+
+BOOL
+PDB::GetModuleSymbols(
+	IN const CHAR* ModuleName,
+	OUT SymbolList& Symbols
+	)
+{
+	return m_Impl->GetModuleSymbols(ModuleName, Symbols);
+}
+
+BOOL
+PDB::GetLines(
+	OUT std::vector<SYMBOL_LINE>& Lines,
+	OUT std::vector<std::string>& FileNames
+	)
+{
+	return m_Impl->GetLines(Lines, FileNames);
+}
+
+BOOL
+PDB::GetFrameData(
+	OUT std::vector<SYMBOL_FRAME_DATA>& FrameData
+	)
+{
+	return m_Impl->GetFrameData(FrameData);
+}
+
+BOOL
+PDB::GetCodeSymbols(
+	OUT std::vector<SYMBOL_CODE>& CodeSymbols
+	)
 {
-	return m_Impl->GetSymbolNameMap();
+	return m_Impl->GetCodeSymbols(CodeSymbols);
 }
 
 const CHAR*
 PDB::GetBasicTypeString(
 	IN BasicType BaseType,
 	IN DWORD Size,
-	IN BOOL UseStdInt
+	IN BOOL UseStdInt,
+	IN BOOL UsePortableTypes
 	)
 {
-	BasicTypeMapElement* TypeMap = UseStdInt ? BasicTypeMapStdInt : BasicTypeMapMSVC;
+	BasicTypeMapElement* TypeMap = UseStdInt        ? BasicTypeMapStdInt   :
+	                               UsePortableTypes ? BasicTypeMapPortable :
+	                                                  BasicTypeMapMSVC;
 
 	for (int n = 0; TypeMap[n].BasicTypeString != nullptr; n++)
 	{
@@ -1036,10 +1906,11 @@ PDB::GetBasicTypeString(
 const CHAR*
 PDB::GetBasicTypeString(
 	IN const SYMBOL* Symbol,
-	IN BOOL UseStdInt
+	IN BOOL UseStdInt,
+	IN BOOL UsePortableTypes
 	)
 {
-	return GetBasicTypeString(Symbol->BaseType, Symbol->Size, UseStdInt);
+	return GetBasicTypeString(Symbol->BaseType, Symbol->Size, UseStdInt, UsePortableTypes);
 }
 
 const CHAR*
@@ -4,8 +4,12 @@
 
 #include <dia2.h>
 
+#include "SymbolNameIndex.h"
+
+#include <string>
 #include <unordered_set>
 #include <unordered_map>
+#include <vector>
 
 typedef struct _SYMBOL SYMBOL, *PSYMBOL;
 
@@ -277,15 +281,133 @@ struct _SYMBOL
 	} u;
 };
 
+//
+// Range of the code generated for one line of the source file.
+//
+typedef struct _SYMBOL_LINE
+{
+	//
+	// Relative virtual address of the first byte of the code.
+	//
+	DWORD                RelativeVirtualAddress;
+
+	//
+	// Size of the code in bytes.
+	//
+	DWORD                Length;
+
+	//
+	// Line number in the source file.
+	//
+	DWORD                LineNumber;
+
+	//
+	// Index of the source file in the list of file names.
+	//
+	DWORD                FileIndex;
+
+} SYMBOL_LINE, *PSYMBOL_LINE;
+
+//
+// Layout of the stack frame of a range of the code
+// (FPO_DATA or FRAMEDATA record, 32-bit x86 only).
+//
+typedef struct _SYMBOL_FRAME_DATA
+{
+	//
+	// Relative virtual address of the first byte of the range.
+	//
+	DWORD                RelativeVirtualAddress;
+
+	//
+	// Size of the range in bytes.
+	//
+	DWORD                Length;
+
+	//
+	// Sizes of the parts of the frame in bytes.
+	//
+	DWORD                LocalsLength;
+	DWORD                ParamsLength;
+	DWORD                SavedRegistersLength;
+	DWORD                PrologLength;
+
+	//
+	// FrameTypeFPO or FrameTypeFrameData (or other StackFrameTypeEnum).
+	//
+	DWORD                Type;
+
+	//
+	// Specifies if the function uses EBP as the frame pointer.
+	//
+	BOOL                 AllocatesBasePointer;
+
+	//
+	// Postfix program which computes registers of the caller,
+	// e.g. "$T0 .raSearch = $eip $T0 ^ = $esp $T0 4 + =".
+	// Empty for FPO records.
+	//
+	std::string          Program;
+
+} SYMBOL_FRAME_DATA, *PSYMBOL_FRAME_DATA;
+
+//
+// Function or public code symbol.
+//
+typedef struct _SYMBOL_CODE
+{
+	//
+	// Relative virtual address of the first byte of the code.
+	//
+	DWORD                RelativeVirtualAddress;
+
+	//
+	// Size of the code in bytes, 0 if it is not known
+	// (public symbols of modules without private symbols).
+	//
+	DWORD                Length;
+
+	//
+	// Specifies if the record comes from the public symbols.
+	//
+	BOOL                 IsPublic;
+
+	//
+	// Name of the function, undecorated for public symbols.
+	//
+	std::string          Name;
+
+} SYMBOL_CODE, *PSYMBOL_CODE;
+
 class SymbolModule;
 
 using SymbolMap     = std::unordered_map<DWORD, SYMBOL*>;
 using SymbolNameMap = std::unordered_map<std::string, SYMBOL*>;
 using SymbolSet     = std::unordered_set<SYMBOL*>;
+using SymbolList    = std::vector<const SYMBOL*>;
 
 class PDB
 {
 	public:
+		//
+		// Reason why the file could not be opened.
+		//
+		enum class OpenError
+		{
+			None,
+			NotFound,
+
+			//
+			// ELF file without the DWARF debugging information (stripped).
+			//
+			NoDebugInfo,
+
+			//
+			// ELF file whose types are in the .dwo files of the split DWARF.
+			//
+			SplitDwarf,
+		};
+
 		//
 		// Default constructor.
 		//
@@ -305,12 +427,15 @@ class PDB
 
 		//
 		// Opens particular PDB file and parses it.
+		// ELF files are loaded from their DWARF debugging
+		// information, see DwarfTypeLoader.
 		//
 		// Returns non-zero value on success.
 		//
 		BOOL
 		Open(
-			IN const CHAR* Path
+			IN const CHAR* Path,
+			IN DWORD ThreadCount = 0
 			);
 
 		//
@@ -319,6 +444,18 @@ class PDB
 		BOOL
 		IsOpened() const;
 
+		//
+		// Returns the reason of the failure of the last Open.
+		//
+		OpenError
+		GetOpenError() const;
+
+		//
+		// Returns TRUE if the opened file is an ELF file.
+		//
+		BOOL
+		IsElfFile() const;
+
 		//
 		// Returns path of the currently opened PDB file.
 		//
@@ -337,6 +474,30 @@ class PDB
 		DWORD
 		GetMachineType() const;
 
+		//
+		// Get GUID and age of the PDB, the same values are stored
+		// in the CodeView record of the debug directory of the image.
+		//
+		// Returns non-zero value on success.
+		//
+		BOOL
+		GetSignature(
+			OUT GUID& Guid,
+			OUT DWORD& Age
+			) const;
+
+		//
+		// Get name of the PDB recorded in the PDB itself (name
+		// of the global scope), it does not change when the file
+		// is renamed or stored in a symbol store.
+		//
+		// Returns non-zero value on success.
+		//
+		BOOL
+		GetName(
+			OUT std::string& Name
+			) const;
+
 		//
 		// Get language type of the global symbol.
 		//
@@ -370,14 +531,66 @@ class PDB
 		GetSymbolMap() const;
 
 		//
-		// Returns collection of all named symbols.
+		// Returns index of all named symbols.
+		//
+		const SymbolNameIndex&
+		GetSymbolNameIndex() const;
+
+		//
+		// Collects enums and UDTs referenced by the symbols (functions,
+		// their blocks and locals, data and typedefs) of the module.
+		// The module is matched by the full path or the file name
+		// of either the object file or the library (case-insensitive).
+		//
+		// The index of all modules is built by the first call.
+		//
+		// Returns FALSE if no module matches.
+		//
+		BOOL
+		GetModuleSymbols(
+			IN const CHAR* ModuleName,
+			OUT SymbolList& Symbols
+			);
+
+		//
+		// Collects line records of all modules (unsorted)
+		// and names of their source files. Every source file
+		// is listed once, even if more modules refer to it.
+		//
+		// Returns FALSE if the PDB contains no line information.
+		//
+		BOOL
+		GetLines(
+			OUT std::vector<SYMBOL_LINE>& Lines,
+			OUT std::vector<std::string>& FileNames
+			);
+
+		//
+		// Collects records of the FPO and FrameData streams (unsorted).
 		//
-		const SymbolNameMap&
-		GetSymbolNameMap() const;
+		// Returns FALSE if the PDB contains no frame data.
+		//
+		BOOL
+		GetFrameData(
+			OUT std::vector<SYMBOL_FRAME_DATA>& FrameData
+			);
+
+		//
+		// Collects functions of all modules and public code symbols
+		// (unsorted, a function and its public symbol are both listed).
+		//
+		// Returns FALSE if the PDB contains no code symbols.
+		//
+		BOOL
+		GetCodeSymbols(
+			OUT std::vector<SYMBOL_CODE>& CodeSymbols
+			);
 
 		//
 		// Returns C-like name of the type of provided symbol.
 		// The symbol must be BaseType.
+		// Portable types (int, long long) have the same size on every
+		// target, the MSVC types (long, __int64) are used otherwise.
 		//
 		// Returns non-NULL value on success.
 		//
@@ -386,7 +599,8 @@ class PDB
 		GetBasicTypeString(
 			IN BasicType BaseType,
 			IN DWORD Size,
-			IN BOOL UseStdInt = FALSE
+			IN BOOL UseStdInt = FALSE,
+			IN BOOL UsePortableTypes = FALSE
 			);
 
 		//
@@ -399,7 +613,8 @@ class PDB
 		const CHAR*
 		GetBasicTypeString(
 			IN const SYMBOL* Symbol,
-			IN BOOL UseStdInt = FALSE
+			IN BOOL UseStdInt = FALSE,
+			IN BOOL UsePortableTypes = FALSE
 			);
 
 		//
@@ -0,0 +1,591 @@
+#include "PDBEnumTableGenerator.h"
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <set>
+
+namespace
+{
+	static PDBEnumTableGenerator::Settings DefaultSettings;
+
+	//
+	// Count of multipliers tried for each size of the perfect hash table.
+	//
+	static const DWORD PerfectHashAttempts = 256;
+
+	//
+	// The perfect hash table may be at most 2^PerfectHashExtraBits
+	// times larger than the smallest power of 2 >= count of values.
+	//
+	static const DWORD PerfectHashExtraBits = 2;
+
+	//
+	// Names of the generated tables and functions are prefixed
+	// by the name of the enum, which may be qualified (A::B)
+	// or contain template arguments.
+	//
+	std::string
+	GetIdentifier(
+		const std::string& Name
+		)
+	{
+		std::string Identifier;
+
+		for (auto&& Character : Name)
+		{
+			Identifier += isalnum(static_cast<unsigned char>(Character))
+				? Character
+				: '_';
+		}
+
+		return Identifier;
+	}
+
+	//
+	// Values of 64-bit enums (enum E : long long) which
+	// cannot be represented by 32 bits.
+	//
+	bool
+	IsWideValue(
+		const VARIANT* Value
+		)
+	{
+		switch (Value->vt)
+		{
+			case VT_I8:
+				return Value->llVal < INT_MIN || Value->llVal > UINT_MAX;
+
+			case VT_UI8:
+				return Value->ullVal > UINT_MAX;
+
+			default:
+				return false;
+		}
+	}
+}
+
+PDBEnumTableGenerator::PDBEnumTableGenerator(
+	Settings* EnumTableSettings
+	)
+{
+	m_Settings = EnumTableSettings ? EnumTableSettings : &DefaultSettings;
+}
+
+void
+PDBEnumTableGenerator::Write(
+	std::ostream& OutputFile,
+	const SYMBOL* Symbol,
+	const std::string& Name
+	)
+{
+	std::vector<Entry> Entries = GetEntries(Symbol);
+
+	//
+	// The generated functions take int, truncated values
+	// would be looked up as different enumerators.
+	//
+
+	const SYMBOL_ENUM_FIELD* WideField = nullptr;
+
+	for (DWORD i = 0; i < Symbol->u.Enum.FieldCount && WideField == nullptr; i++)
+	{
+		if (IsWideValue(&Symbol->u.Enum.Fields[i].Value))
+		{
+			WideField = &Symbol->u.Enum.Fields[i];
+		}
+	}
+
+	if (Entries.empty() && WideField == nullptr)
+	{
+		return;
+	}
+
+	OutputFile << "/*" << std::endl;
+	OutputFile << " * " << Name << std::endl;
+	OutputFile << " */" << std::endl;
+	OutputFile << std::endl;
+
+	if (WideField)
+	{
+		OutputFile << "/* " << WideField->Name << " does not fit into 32 bits, no table is generated */" << std::endl;
+		OutputFile << std::endl;
+		return;
+	}
+
+	std::string Identifier = GetIdentifier(Name);
+
+	ULONG Multiplier;
+	DWORD Bits;
+
+	switch (ChooseTableKind(Entries, Multiplier, Bits))
+	{
+		case TableKind::Dense:
+			WriteDenseTable(OutputFile, Entries, Identifier);
+			break;
+
+		case TableKind::PerfectHash:
+			WritePerfectHashTable(OutputFile, Entries, Identifier, Multiplier, Bits);
+			break;
+
+		case TableKind::BinarySearch:
+			WriteBinarySearchTable(OutputFile, Entries, Identifier);
+			break;
+	}
+
+	if (m_Settings->DecodeFlags && IsFlagEnum(Entries))
+	{
+		WriteFlagDecoder(OutputFile, Entries, Identifier);
+	}
+}
+
+PDBEnumTableGenerator::TableKind
+PDBEnumTableGenerator::GetTableKind(
+	const SYMBOL* Symbol
+	)
+{
+	ULONG Multiplier;
+	DWORD Bits;
+
+	return ChooseTableKind(GetEntries(Symbol), Multiplier, Bits);
+}
+
+bool
+PDBEnumTableGenerator::IsFlagEnum(
+	const SYMBOL* Symbol
+	)
+{
+	return IsFlagEnum(GetEntries(Symbol));
+}
+
+std::vector<PDBEnumTableGenerator::Entry>
+PDBEnumTableGenerator::GetEntries(
+	const SYMBOL* Symbol
+	)
+{
+	std::vector<Entry> Entries;
+	std::set<LONG> Values;
+
+	if (Symbol->Tag != SymTagEnum)
+	{
+		return Entries;
+	}
+
+	for (DWORD i = 0; i < Symbol->u.Enum.FieldCount; i++)
+	{
+		const SYMBOL_ENUM_FIELD* EnumField = &Symbol->u.Enum.Fields[i];
+
+		LONG Value;
+
+		if (!GetValue(&EnumField->Value, Value))
+		{
+			continue;
+		}
+
+		//
+		// The first enumerator of the value wins,
+		// the following ones are usually aliases (XYZ_MAX, ...).
+		//
+
+		if (Values.insert(Value).second)
+		{
+			Entries.push_back({ Value, EnumField->Name });
+		}
+	}
+
+	std::sort(Entries.begin(), Entries.end(), [](const Entry& Lhs, const Entry& Rhs) {
+		return Lhs.Value < Rhs.Value;
+	});
+
+	return Entries;
+}
+
+bool
+PDBEnumTableGenerator::GetValue(
+	const VARIANT* Value,
+	LONG& Result
+	)
+{
+	switch (Value->vt)
+	{
+		case VT_I1:
+			Result = static_cast<LONG>(Value->cVal);
+			return true;
+
+		case VT_UI1:
+			Result = static_cast<LONG>(Value->bVal);
+			return true;
+
+		case VT_I2:
+			Result = static_cast<LONG>(Value->iVal);
+			return true;
+
+		case VT_UI2:
+			Result = static_cast<LONG>(Value->uiVal);
+			return true;
+
+		case VT_INT:
+		case VT_I4:
+		case VT_UINT:
+		case VT_UI4:
+			Result = Value->lVal;
+			return true;
+
+		case VT_I8:
+		case VT_UI8:
+			if (IsWideValue(Value))
+			{
+				return false;
+			}
+
+			Result = static_cast<LONG>(Value->llVal);
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+std::string
+PDBEnumTableGenerator::FormatValue(
+	LONG Value
+	)
+{
+	//
+	// -2147483648 is not a valid literal of int.
+	//
+
+	if (Value == LONG_MIN)
+	{
+		return "(-2147483647 - 1)";
+	}
+
+	return std::to_string(Value);
+}
+
+PDBEnumTableGenerator::TableKind
+PDBEnumTableGenerator::ChooseTableKind(
+	const std::vector<Entry>& Entries,
+	ULONG& Multiplier,
+	DWORD& Bits
+	)
+{
+	ULONGLONG Range = static_cast<ULONGLONG>(
+		static_cast<LONGLONG>(Entries.back().Value) - Entries.front().Value + 1
+		);
+
+	if (Range <= static_cast<ULONGLONG>(m_Settings->DenseFactor) * Entries.size())
+	{
+		return TableKind::Dense;
+	}
+
+	if (Entries.size() >= m_Settings->PerfectHashThreshold &&
+	    FindPerfectHash(Entries, Multiplier, Bits))
+	{
+		return TableKind::PerfectHash;
+	}
+
+	return TableKind::BinarySearch;
+}
+
+bool
+PDBEnumTableGenerator::IsFlagEnum(
+	const std::vector<Entry>& Entries
+	)
+{
+	ULONG SingleBits = 0;
+	DWORD SingleBitCount = 0;
+	DWORD NonZeroCount = 0;
+
+	for (auto&& CurrentEntry : Entries)
+	{
+		ULONG Value = static_cast<ULONG>(CurrentEntry.Value);
+
+		if (Value == 0)
+		{
+			continue;
+		}
+
+		NonZeroCount += 1;
+
+		if ((Value & (Value - 1)) == 0)
+		{
+			SingleBits |= Value;
+			SingleBitCount += 1;
+		}
+	}
+
+	if (SingleBitCount < 3 || SingleBitCount * 2 < NonZeroCount)
+	{
+		return false;
+	}
+
+	//
+	// Masks must be combinations of the flags.
+	//
+
+	for (auto&& CurrentEntry : Entries)
+	{
+		if ((static_cast<ULONG>(CurrentEntry.Value) & ~SingleBits) != 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool
+PDBEnumTableGenerator::FindPerfectHash(
+	const std::vector<Entry>& Entries,
+	ULONG& Multiplier,
+	DWORD& Bits
+	)
+{
+	DWORD MinimumBits = 1;
+
+	while ((1ULL << MinimumBits) < Entries.size())
+	{
+		MinimumBits += 1;
+	}
+
+	std::vector<bool> Slots;
+
+	for (Bits = MinimumBits; Bits <= MinimumBits + PerfectHashExtraBits && Bits < 32; Bits++)
+	{
+		//
+		// Multipliers are generated by an LCG, so the output
+		// is the same for every run.
+		//
+
+		ULONG State = 0x9E3779B9;
+
+		for (DWORD Attempt = 0; Attempt < PerfectHashAttempts; Attempt++)
+		{
+			State = State * 1664525 + 1013904223;
+			Multiplier = State | 1;
+
+			Slots.assign(static_cast<size_t>(1) << Bits, false);
+
+			bool Collision = false;
+
+			for (auto&& CurrentEntry : Entries)
+			{
+				ULONG Index = static_cast<ULONG>(static_cast<ULONG>(CurrentEntry.Value) * Multiplier) >> (32 - Bits);
+
+				if (Slots[Index])
+				{
+					Collision = true;
+					break;
+				}
+
+				Slots[Index] = true;
+			}
+
+			if (!Collision)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void
+PDBEnumTableGenerator::WriteDenseTable(
+	std::ostream& OutputFile,
+	const std::vector<Entry>& Entries,
+	const std::string& Name
+	)
+{
+	LONG Minimum = Entries.front().Value;
+	ULONG Count = static_cast<ULONG>(Entries.back().Value - Minimum) + 1;
+
+	OutputFile << "static const char* const " << Name << "_Names[" << Count << "] =" << std::endl;
+	OutputFile << "{" << std::endl;
+
+	auto It = Entries.begin();
+
+	for (ULONG Index = 0; Index < Count; Index++)
+	{
+		if (It != Entries.end() && static_cast<ULONG>(It->Value - Minimum) == Index)
+		{
+			OutputFile << "  \"" << It->Name << "\"," << std::endl;
+			++It;
+		}
+		else
+		{
+			OutputFile << "  0," << std::endl;
+		}
+	}
+
+	OutputFile << "};" << std::endl;
+	OutputFile << std::endl;
+
+	OutputFile << "static __inline const char* " << Name << "_ToString(int Value)" << std::endl;
+	OutputFile << "{" << std::endl;
+	OutputFile << "  unsigned int Index = (unsigned int)Value - (unsigned int)" << FormatValue(Minimum) << ";" << std::endl;
+	OutputFile << "  return Index < " << Count << " ? " << Name << "_Names[Index] : 0;" << std::endl;
+	OutputFile << "}" << std::endl;
+	OutputFile << std::endl;
+}
+
+void
+PDBEnumTableGenerator::WritePerfectHashTable(
+	std::ostream& OutputFile,
+	const std::vector<Entry>& Entries,
+	const std::string& Name,
+	ULONG Multiplier,
+	DWORD Bits
+	)
+{
+	std::vector<const Entry*> Slots(static_cast<size_t>(1) << Bits, nullptr);
+
+	for (auto&& CurrentEntry : Entries)
+	{
+		ULONG Index = static_cast<ULONG>(static_cast<ULONG>(CurrentEntry.Value) * Multiplier) >> (32 - Bits);
+		Slots[Index] = &CurrentEntry;
+	}
+
+	char MultiplierString[16];
+	sprintf_s(MultiplierString, "0x%08Xu", static_cast<unsigned int>(Multiplier));
+
+	OutputFile << "static const struct { int Value; const char* Name; } " << Name << "_Hash[" << Slots.size() << "] =" << std::endl;
+	OutputFile << "{" << std::endl;
+
+	for (auto&& Slot : Slots)
+	{
+		if (Slot)
+		{
+			OutputFile << "  { " << FormatValue(Slot->Value) << ", \"" << Slot->Name << "\" }," << std::endl;
+		}
+		else
+		{
+			OutputFile << "  { 0, 0 }," << std::endl;
+		}
+	}
+
+	OutputFile << "};" << std::endl;
+	OutputFile << std::endl;
+
+	OutputFile << "static __inline const char* " << Name << "_ToString(int Value)" << std::endl;
+	OutputFile << "{" << std::endl;
+	OutputFile << "  unsigned int Index = ((unsigned int)Value * " << MultiplierString << ") >> " << (32 - Bits) << ";" << std::endl;
+	OutputFile << "  return " << Name << "_Hash[Index].Value == Value ? " << Name << "_Hash[Index].Name : 0;" << std::endl;
+	OutputFile << "}" << std::endl;
+	OutputFile << std::endl;
+}
+
+void
+PDBEnumTableGenerator::WriteBinarySearchTable(
+	std::ostream& OutputFile,
+	const std::vector<Entry>& Entries,
+	const std::string& Name
+	)
+{
+	OutputFile << "static const struct { int Value; const char* Name; } " << Name << "_Values[" << Entries.size() << "] =" << std::endl;
+	OutputFile << "{" << std::endl;
+
+	for (auto&& CurrentEntry : Entries)
+	{
+		OutputFile << "  { " << FormatValue(CurrentEntry.Value) << ", \"" << CurrentEntry.Name << "\" }," << std::endl;
+	}
+
+	OutputFile << "};" << std::endl;
+	OutputFile << std::endl;
+
+	OutputFile << "static __inline const char* " << Name << "_ToString(int Value)" << std::endl;
+	OutputFile << "{" << std::endl;
+	OutputFile << "  unsigned int Low = 0;" << std::endl;
+	OutputFile << "  unsigned int High = " << Entries.size() << ";" << std::endl;
+	OutputFile << std::endl;
+	OutputFile << "  while (Low < High)" << std::endl;
+	OutputFile << "  {" << std::endl;
+	OutputFile << "    unsigned int Middle = (Low + High) / 2;" << std::endl;
+	OutputFile << std::endl;
+	OutputFile << "    if (" << Name << "_Values[Middle].Value < Value)" << std::endl;
+	OutputFile << "      Low = Middle + 1;" << std::endl;
+	OutputFile << "    else" << std::endl;
+	OutputFile << "      High = Middle;" << std::endl;
+	OutputFile << "  }" << std::endl;
+	OutputFile << std::endl;
+	OutputFile << "  return Low < " << Entries.size() << " && " << Name << "_Values[Low].Value == Value ? " << Name << "_Values[Low].Name : 0;" << std::endl;
+	OutputFile << "}" << std::endl;
+	OutputFile << std::endl;
+}
+
+void
+PDBEnumTableGenerator::WriteFlagDecoder(
+	std::ostream& OutputFile,
+	const std::vector<Entry>& Entries,
+	const std::string& Name
+	)
+{
+	const CHAR* FlagNames[32] = { nullptr };
+
+	for (auto&& CurrentEntry : Entries)
+	{
+		ULONG Value = static_cast<ULONG>(CurrentEntry.Value);
+
+		if (Value != 0 && (Value & (Value - 1)) == 0)
+		{
+			DWORD Bit = 0;
+
+			while ((Value >> Bit) != 1)
+			{
+				Bit += 1;
+			}
+
+			FlagNames[Bit] = CurrentEntry.Name;
+		}
+	}
+
+	OutputFile << "static const char* const " << Name << "_FlagNames[32] =" << std::endl;
+	OutputFile << "{" << std::endl;
+
+	for (auto&& FlagName : FlagNames)
+	{
+		if (FlagName)
+		{
+			OutputFile << "  \"" << FlagName << "\"," << std::endl;
+		}
+		else
+		{
+			OutputFile << "  0," << std::endl;
+		}
+	}
+
+	OutputFile << "};" << std::endl;
+	OutputFile << std::endl;
+
+	//
+	// Names of the set flags are stored into Names (up to MaximumCount),
+	// the count of set flags is returned. Bits without a name
+	// are stored into RemainingBits.
+	//
+
+	OutputFile << "static __inline unsigned int " << Name << "_DecodeFlags(unsigned int Value, const char** Names, unsigned int MaximumCount, unsigned int* RemainingBits)" << std::endl;
+	OutputFile << "{" << std::endl;
+	OutputFile << "  unsigned int Count = 0;" << std::endl;
+	OutputFile << "  unsigned int Bit;" << std::endl;
+	OutputFile << std::endl;
+	OutputFile << "  for (Bit = 0; Bit < 32 && (Value >> Bit) != 0; Bit++)" << std::endl;
+	OutputFile << "  {" << std::endl;
+	OutputFile << "    if (((Value >> Bit) & 1) && " << Name << "_FlagNames[Bit])" << std::endl;
+	OutputFile << "    {" << std::endl;
+	OutputFile << "      if (Count < MaximumCount)" << std::endl;
+	OutputFile << "        Names[Count] = " << Name << "_FlagNames[Bit];" << std::endl;
+	OutputFile << std::endl;
+	OutputFile << "      Count += 1;" << std::endl;
+	OutputFile << "      Value &= ~(1u << Bit);" << std::endl;
+	OutputFile << "    }" << std::endl;
+	OutputFile << "  }" << std::endl;
+	OutputFile << std::endl;
+	OutputFile << "  if (RemainingBits)" << std::endl;
+	OutputFile << "    *RemainingBits = Value;" << std::endl;
+	OutputFile << std::endl;
+	OutputFile << "  return Count;" << std::endl;
+	OutputFile << "}" << std::endl;
+	OutputFile << std::endl;
+}
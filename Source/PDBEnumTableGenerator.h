@@ -0,0 +1,174 @@
+#pragma once
+#include "PDB.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+//
+// Generates reverse lookup of enumerations - functions
+// returning the name of the enumerator for its value
+// and decoders of flag words.
+//
+//   static __inline const char* XYZ_ToString(int Value);
+//   static __inline unsigned int XYZ_DecodeFlags(unsigned int Value,
+//     const char** Names, unsigned int MaximumCount, unsigned int* RemainingBits);
+//
+// Values are looked up in the table chosen by the distribution
+// of the enumerators:
+//
+//   Dense         array indexed by (Value - Minimum), for compact ranges
+//   PerfectHash   collision-free multiplicative hash, for large sparse enums
+//   BinarySearch  sorted array, for small sparse enums (or when
+//                 no perfect hash was found)
+//
+// Values are treated as 32-bit, as enums of MSVC are. Enums with
+// a value which does not fit into 32 bits get only a comment.
+// Names of the tables and functions are the name of the enum
+// with the characters not valid in identifiers replaced by '_'.
+//
+class PDBEnumTableGenerator
+{
+	public:
+		enum class TableKind
+		{
+			Dense,
+			PerfectHash,
+			BinarySearch,
+		};
+
+		struct Settings
+		{
+			//
+			// Range of the dense table may be at most DenseFactor times
+			// larger than the count of the enumerators.
+			//
+			DWORD DenseFactor = 2;
+
+			//
+			// Minimum count of enumerators of the perfect hash table.
+			//
+			DWORD PerfectHashThreshold = 8;
+
+			//
+			// Generate flag decoders for flag-like enums.
+			//
+			bool DecodeFlags = true;
+		};
+
+		PDBEnumTableGenerator(
+			Settings* EnumTableSettings = nullptr
+			);
+
+		//
+		// Writes the lookup table and functions of the enum.
+		// Name is the (corrected) name of the enum.
+		//
+		void
+		Write(
+			std::ostream& OutputFile,
+			const SYMBOL* Symbol,
+			const std::string& Name
+			);
+
+		TableKind
+		GetTableKind(
+			const SYMBOL* Symbol
+			);
+
+		//
+		// Returns true if the enum looks like a set of flags -
+		// at least 3 single-bit values, which are at least half
+		// of the non-zero values, and the remaining values
+		// are combinations of them.
+		//
+		static
+		bool
+		IsFlagEnum(
+			const SYMBOL* Symbol
+			);
+
+	private:
+		struct Entry
+		{
+			LONG Value;
+			const CHAR* Name;
+		};
+
+		//
+		// Returns enumerators sorted by their value, aliases
+		// (enumerators with already seen value) are omitted.
+		//
+		static
+		std::vector<Entry>
+		GetEntries(
+			const SYMBOL* Symbol
+			);
+
+		static
+		bool
+		GetValue(
+			const VARIANT* Value,
+			LONG& Result
+			);
+
+		static
+		std::string
+		FormatValue(
+			LONG Value
+			);
+
+		TableKind
+		ChooseTableKind(
+			const std::vector<Entry>& Entries,
+			ULONG& Multiplier,
+			DWORD& Bits
+			);
+
+		static
+		bool
+		IsFlagEnum(
+			const std::vector<Entry>& Entries
+			);
+
+		static
+		bool
+		FindPerfectHash(
+			const std::vector<Entry>& Entries,
+			ULONG& Multiplier,
+			DWORD& Bits
+			);
+
+		void
+		WriteDenseTable(
+			std::ostream& OutputFile,
+			const std::vector<Entry>& Entries,
+			const std::string& Name
+			);
+
+		void
+		WritePerfectHashTable(
+			std::ostream& OutputFile,
+			const std::vector<Entry>& Entries,
+			const std::string& Name,
+			ULONG Multiplier,
+			DWORD Bits
+			);
+
+		void
+		WriteBinarySearchTable(
+			std::ostream& OutputFile,
+			const std::vector<Entry>& Entries,
+			const std::string& Name
+			);
+
+		void
+		WriteFlagDecoder(
+			std::ostream& OutputFile,
+			const std::vector<Entry>& Entries,
+			const std::string& Name
+			);
+
+	private:
+		Settings* m_Settings;
+};
@@ -4,8 +4,14 @@
 #include "PDBSymbolSorter.h"
 #include "UdtFieldDefinition.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cstdarg>
+#include <deque>
 #include <iostream>
 #include <fstream>
+#include <set>
+#include <sstream>
 #include <stdexcept>
 
 namespace
@@ -48,9 +54,84 @@ namespace
 	static const char* MESSAGE_FILE_NOT_FOUND =
 		"File not found";
 
+	static const char* MESSAGE_NO_DEBUG_INFO =
+		"ELF file does not contain the debugging information";
+
+	static const char* MESSAGE_SPLIT_DWARF =
+		"Types are in the split DWARF (.dwo) files, which are not supported";
+
 	static const char* MESSAGE_SYMBOL_NOT_FOUND =
 		"Symbol not found";
 
+	static const char* MESSAGE_SYMBOL_NOT_REORDERABLE =
+		"Symbol is not a structure which can be reordered";
+
+	static const char* MESSAGE_BINDINGS_NOT_FOUND =
+		"Bindings file not found";
+
+	static const char* MESSAGE_TRACE_NOT_FOUND =
+		"Trace file not found";
+
+	static const char* MESSAGE_CANNOT_CREATE_DIRECTORY =
+		"Cannot create directory";
+
+	static const char* MESSAGE_CANNOT_CREATE_FILE =
+		"Cannot create file";
+
+	static const char* MESSAGE_UNSUPPORTED_COMPRESSION =
+		"Unsupported compression, use .gz";
+
+	static const char* MESSAGE_CORRUPTED_FILE =
+		"Compressed file is corrupted";
+
+	static const char* MESSAGE_CANNOT_OPEN_IMAGE =
+		"Cannot open memory image";
+
+	static const char* MESSAGE_CANNOT_OPEN_PROCESS =
+		"Cannot open process";
+
+	static const char* MESSAGE_UNSUPPORTED_CRASH_DUMP =
+		"Unsupported crash dump";
+
+	static const char* MESSAGE_OBJECTS_NOT_FOUND =
+		"Objects file not found";
+
+	static const char* MESSAGE_LINK_NOT_FOUND =
+		"Link field not found";
+
+	static const char* MESSAGE_INVALID_QUERY =
+		"Invalid query";
+
+	static const char* MESSAGE_MODULE_NOT_FOUND =
+		"Module not found";
+
+	static const char* MESSAGE_ADDRESSES_NOT_FOUND =
+		"Addresses file not found";
+
+	static const char* MESSAGE_NO_LINE_INFORMATION =
+		"PDB does not contain line information";
+
+	static const char* MESSAGE_CONTEXTS_NOT_FOUND =
+		"Contexts file not found";
+
+	static const char* MESSAGE_NO_FRAME_DATA =
+		"PDB does not contain frame data of x86 code";
+
+	static const char* MESSAGE_FIELDS_NOT_FOUND =
+		"Fields file not found";
+
+	static const char* MESSAGE_PDB_LIST_NOT_FOUND =
+		"PDB list file not found";
+
+	static const char* MESSAGE_SOURCES_NOT_FOUND =
+		"Source file not found";
+
+	static const char* MESSAGE_MODULE_LIST_NOT_FOUND =
+		"Module list file not found";
+
+	static const char* MESSAGE_CANNOT_MOUNT =
+		"Cannot mount the directory (Projected File System is not enabled?)";
+
 	//
 	// Our exception class.
 	//
@@ -65,6 +146,60 @@ namespace
 
 			}
 	};
+
+	//
+	// Name of the PDB directory in the symbol store,
+	// e.g. 3844DBB920174967BE7AA4A2C20430FA2.
+	//
+	std::string
+	GetSymbolStoreSignature(
+		const GUID& Guid,
+		DWORD Age
+		)
+	{
+		char Signature[64];
+		sprintf_s(
+			Signature, "%08X%04X%04X%02X%02X%02X%02X%02X%02X%02X%02X%X",
+			Guid.Data1, Guid.Data2, Guid.Data3,
+			Guid.Data4[0], Guid.Data4[1], Guid.Data4[2], Guid.Data4[3],
+			Guid.Data4[4], Guid.Data4[5], Guid.Data4[6], Guid.Data4[7],
+			Age
+			);
+
+		return Signature;
+	}
+
+	//
+	// sprintf() into a string, corrected names of C++ types
+	// do not fit into any fixed buffer.
+	//
+	std::string
+	FormatString(
+		const char* Format,
+		...
+		)
+	{
+		va_list ArgPtr;
+
+		va_start(ArgPtr, Format);
+		int Length = _vscprintf(Format, ArgPtr);
+		va_end(ArgPtr);
+
+		if (Length <= 0)
+		{
+			return std::string();
+		}
+
+		std::string Result(static_cast<size_t>(Length) + 1, '\0');
+
+		va_start(ArgPtr, Format);
+		vsprintf_s(&Result[0], Result.size(), Format, ArgPtr);
+		va_end(ArgPtr);
+
+		Result.resize(static_cast<size_t>(Length));
+
+		return Result;
+	}
 }
 
 int
@@ -78,20 +213,80 @@ PDBExtractor::Run(
 	try
 	{
 		ParseParameters(argc, argv);
-		OpenPDBFile();
 
-		PrintTestHeader();
-
-		if (m_Settings.SymbolName == "*")
+		if (m_Settings.CatFilename)
 		{
-			DumpAllSymbols();
+			DecompressFile();
 		}
-		else
+		else if (m_Settings.OffsetPackFilename)
 		{
-			DumpOneSymbol();
+			WriteOffsetPack();
 		}
+		else if (m_Settings.MountDirectory)
+		{
+			MountHeaders();
+		}
+		else if (m_Settings.SymbolizeFilename)
+		{
+			PrintSymbols();
+		}
+		else if (m_Settings.PrintIdentities)
+		{
+			PrintIdentities();
+		}
+		else if (m_Settings.BrowseDirectory)
+		{
+			WriteTypeBrowser();
+		}
+		else
+		{
+			OpenPDBFile();
+
+			PrintTestHeader();
+
+			if (m_Settings.OptimizeLayout)
+			{
+				OptimizeLayout();
+			}
+			else if (m_Settings.Diff)
+			{
+				PrintStructureDiff();
+			}
+			else if (m_Settings.Crawl)
+			{
+				PrintObjectGraph();
+			}
+			else if (m_Settings.QueryExpression)
+			{
+				PrintQuery();
+			}
+			else if (m_Settings.HeatmapTraceFilename)
+			{
+				PrintFieldHeatmap();
+			}
+			else if (m_Settings.LinesFilename)
+			{
+				PrintLines();
+			}
+			else if (m_Settings.ContextsFilename)
+			{
+				PrintStacks();
+			}
+			else if (m_Settings.ModulesDirectory)
+			{
+				DumpModules();
+			}
+			else if (m_Settings.SymbolName == "*")
+			{
+				DumpAllSymbols();
+			}
+			else
+			{
+				DumpOneSymbol();
+			}
 
-		PrintTestFooter();
+			PrintTestFooter();
+		}
 	}
 	catch (PDBDumperException& e)
 	{
@@ -113,11 +308,30 @@ PDBExtractor::PrintUsage()
 	printf("pdbex <symbol> <path> [-o <filename>] [-t <filename>] [-e <type>]\n");
 	printf("                     [-u <prefix>] [-s prefix] [-r prefix] [-g suffix]\n");
 	printf("                     [-p] [-x] [-m] [-b] [-d] [-i] [-l]\n");
+	printf("pdbex --cat <filename> [-o <filename>]\n");
+	printf("pdbex <symbol> <path> --diff --image <old> --image <new>\n");
+	printf("                     [--objects <filename>] [--walk <head>:<field>]\n");
+	printf("pdbex <symbol> <path> --crawl --image <filename> [--root <address>]\n");
+	printf("                     [--objects <filename>] [--dot]\n");
+	printf("pdbex <symbol> <path> --query <expression> --image <filename>\n");
+	printf("                     [--objects <filename>] [--walk <head>:<field>]\n");
+	printf("                     [--select <field>,...]\n");
+	printf("pdbex * <path> --lines <filename>\n");
+	printf("pdbex * <path> --unwind <filename> --image <filename>\n");
+	printf("                     [--module-base <address>]\n");
+	printf("pdbex --offset-pack <filename> --fields <filename> --pdb-list <filename>\n");
+	printf("                     [-o <filename>]\n");
+	printf("pdbex --mount <directory> --pdb-list <filename> [-e <type>] [-i] ...\n");
+	printf("pdbex --symbolize <filename> --module-list <filename> [-o <filename>]\n");
+	printf("pdbex --identities --pdb-list <filename> [-o <filename>]\n");
+	printf("pdbex --browse <directory> --pdb-list <filename> [-o <filename>]\n");
 	printf("\n");
 	printf("<symbol>             Symbol name to extract or '*' if all symbol should\n");
 	printf("                     be extracted.\n");
-	printf("<path>               Path to the PDB file.\n");
+	printf("<path>               Path to the PDB file, or to the ELF file\n");
+	printf("                     with the DWARF debugging information.\n");
 	printf(" -o filename         Specifies the output file.                       (stdout)\n");
+	printf("                     Output into *.gz file is compressed.\n");
 	printf(" -t filename         Specifies the output test file.                  (off)\n");
 	printf(" -e [n,i,a]          Specifies expansion of nested structures/unions. (i)\n");
 	printf("                       n = none            Only top-most type is printed.\n");
@@ -141,6 +355,111 @@ PDBExtractor::PrintUsage()
 	printf(" -n                  Print declarations.                              (T)\n");
 	printf(" -l                  Print definitions.                               (T)\n");
 	printf("\n");
+	printf("Miscellaneous:\n");
+	printf(" --generic-emitter   Do not use emitter specialized for the settings.\n");
+	printf(" --cat filename      Decompress the *.gz file into the output.\n");
+	printf(" --enum-tables       Print value-to-name lookup functions of enums\n");
+	printf("                     and decoders of flag enums.\n");
+	printf(" --reflection        Print field metadata tables of UDTs and\n");
+	printf("                     the index of types sorted by name.\n");
+	printf(" --threads count     Count of worker threads.                        (CPUs)\n");
+	printf("\n");
+	printf("Modules:\n");
+	printf(" --modules directory Write sharded headers, umbrella header and\n");
+	printf("                     module.modulemap into the directory.\n");
+	printf(" --shard-size count  Maximum count of types in one shard.            (256)\n");
+	printf(" --module name       Extract only the types used by the object file\n");
+	printf("                     or library (e.g. foo.obj), <symbol> must be '*'.\n");
+	printf(" --scan path         Extract only the types referenced by C/C++ sources\n");
+	printf("                     of the file or directory (repeatable),\n");
+	printf("                     <symbol> must be '*'.\n");
+	printf("\n");
+	printf("Layout optimization:\n");
+	printf(" --optimize-layout   Print reordered definition of <symbol> with\n");
+	printf("                     minimal padding and cache line splits.\n");
+	printf("                     If <symbol> is '*', rank all structures.\n");
+	printf(" --pin field         Place the field at the beginning (repeatable).\n");
+	printf(" --group f1,f2,...   Keep fields on one cache line (repeatable).\n");
+	printf(" --cache-line bytes  Size of the cache line.                         (64)\n");
+	printf(" --top count         Count of ranked structures.                     (20)\n");
+	printf("\n");
+	printf("Field heatmap:\n");
+	printf(" --heatmap filename  Attribute sampled addresses from the trace file\n");
+	printf("                     to fields and print annotated definitions.\n");
+	printf("                     If <symbol> is not '*', print only <symbol>.\n");
+	printf(" --bindings filename Object bindings, lines of '<base> <type>'.\n");
+	printf("\n");
+	printf("Structure diff:\n");
+	printf(" --diff              Print fields of objects which differ between\n");
+	printf("                     two memory images.\n");
+	printf(" --image filename    Raw memory image (repeatable, old first),\n");
+	printf("                     'pid:<id>' reads memory of the live process,\n");
+	printf("                     crash dumps (MEMORY.DMP) are detected.\n");
+	printf(" --image-base addr   Address of the first byte of the images.         (0)\n");
+	printf(" --objects filename  Objects to compare, lines of '<base> <type>'.\n");
+	printf(" --walk head:field   Compare <symbol> objects linked by the LIST_ENTRY\n");
+	printf("                     field, head is the address of the list head\n");
+	printf("                     or PsActiveProcessHead, PsLoadedModuleList\n");
+	printf("                     of crash dumps.\n");
+	printf("\n");
+	printf("Object graph:\n");
+	printf(" --crawl             Print objects reachable by typed pointers from\n");
+	printf("                     the roots in the memory image.\n");
+	printf(" --root address      Root of the type <symbol> (repeatable).\n");
+	printf("                     Roots are also read from --objects.\n");
+	printf(" --max-depth count   Maximum distance from the roots.                 (8)\n");
+	printf(" --max-nodes count   Maximum count of objects.                  (1048576)\n");
+	printf(" --dot               Print the graph in the DOT language.\n");
+	printf("\n");
+	printf("Query:\n");
+	printf(" --query expression  Print <symbol> objects from --objects or --walk\n");
+	printf("                     which match the expression, e.g.\n");
+	printf("                       Flags & 0x4 != 0 && (Name ^= \"svc\" || Id < 8)\n");
+	printf("                     Operators: == != < <= > >= and ^= (prefix).\n");
+	printf(" --select f1,f2,...  Print values of the fields of matched objects.\n");
+	printf("\n");
+	printf("Source lines:\n");
+	printf(" --lines filename    Print file:line of every RVA in the file\n");
+	printf("                     (hexadecimal, one per line).\n");
+	printf("\n");
+	printf("Stack unwinding (x86):\n");
+	printf(" --unwind filename   Unwind stacks of the thread contexts in the file,\n");
+	printf("                     lines of '<eip> <esp> <ebp> [<ebx> <esi> <edi>]',\n");
+	printf("                     by FPO and FrameData records of the PDB.\n");
+	printf(" --module-base addr  Address the module is loaded at.                (0)\n");
+	printf(" --max-frames count  Maximum count of frames of one stack.         (256)\n");
+	printf("\n");
+	printf("Offset pack:\n");
+	printf(" --offset-pack file  Write field offsets of all PDBs of the list into\n");
+	printf("                     the binary pack read by OffsetPack.c, print\n");
+	printf("                     the enum of field indices into the output.\n");
+	printf(" --fields filename   Fields of the pack, lines of '<type>.<path>'\n");
+	printf("                     or '<type>' for the size of the type.\n");
+	printf(" --pdb-list filename PDB files of --offset-pack, --mount, --identities\n");
+	printf("                     or --browse, one per line.\n");
+	printf("\n");
+	printf("Symbolization:\n");
+	printf(" --symbolize file    Print module!symbol+offset of every absolute\n");
+	printf("                     address in the file (hexadecimal, one per line).\n");
+	printf(" --module-list file  Loaded modules, lines of '<base> <size> <pdb>'\n");
+	printf("                     (size 0 means the extent of the symbols).\n");
+	printf("\n");
+	printf("Identities:\n");
+	printf(" --identities        Print '<GUIDAGE> <path>' of all PDBs of --pdb-list,\n");
+	printf("                     read from the MSF headers without DIA.\n");
+	printf(" --in-flight count   Maximum count of files with pending reads.    (256)\n");
+	printf("\n");
+	printf("Header file system:\n");
+	printf(" --mount directory   Project headers of all PDBs of --pdb-list into\n");
+	printf("                     the directory as <module>\\<GUIDAGE>\\<type>.h,\n");
+	printf("                     every header is rendered when it is first opened.\n");
+	printf("                     Requires Windows Projected File System.\n");
+	printf("\n");
+	printf("Type browser:\n");
+	printf(" --browse directory  Write the HTML site of the types of all PDBs\n");
+	printf("                     of --pdb-list into the directory, pages of types\n");
+	printf("                     which are the same in more builds are shared.\n");
+	printf("\n");
 }
 
 void
@@ -167,9 +486,7 @@ PDBExtractor::ParseParameters(
 	}
 
 	int ArgumentPointer = 0;
-
-	m_Settings.SymbolName = argv[++ArgumentPointer];
-	m_Settings.PdbPath = argv[++ArgumentPointer];
+	int PositionalArgumentCount = 0;
 
 	while (++ArgumentPointer < argc)
 	{
@@ -184,6 +501,39 @@ PDBExtractor::ParseParameters(
 			? strlen(CurrentArgument)
 			: 0;
 
+		//
+		// Handling of <symbol> and <path>.
+		//
+
+		if (CurrentArgument[0] != '-' || CurrentArgumentLength == 1)
+		{
+			switch (PositionalArgumentCount++)
+			{
+				case 0:
+					m_Settings.SymbolName = CurrentArgument;
+					break;
+
+				case 1:
+					m_Settings.PdbPath = CurrentArgument;
+					break;
+
+				default:
+					throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			continue;
+		}
+
+		//
+		// Handling of --long-switches.
+		//
+
+		if (CurrentArgument[1] == '-')
+		{
+			ParseLongParameter(CurrentArgument, NextArgument, ArgumentPointer);
+			continue;
+		}
+
 		//
 		// Handling of -X- switches.
 		//
@@ -211,10 +561,6 @@ PDBExtractor::ParseParameters(
 
 				++ArgumentPointer;
 				m_Settings.OutputFilename = NextArgument;
-				m_Settings.PdbHeaderReconstructorSettings.OutputFile = new std::ofstream(
-					NextArgument,
-					std::ios::out
-					);
 				break;
 
 			case 't':
@@ -325,6 +671,7 @@ PDBExtractor::ParseParameters(
 
 			case 'i':
 				m_Settings.UdtFieldDefinitionSettings.UseStdInt = !OffSwitch;
+				m_Settings.PdbHeaderReconstructorSettings.UseStdInt = !OffSwitch;
 				break;
 
 			case 'j':
@@ -348,182 +695,2443 @@ PDBExtractor::ParseParameters(
 		}
 	}
 
-	m_HeaderReconstructor = std::make_unique<PDBHeaderReconstructor>(
-		&m_Settings.PdbHeaderReconstructorSettings
-		);
-
-	m_SymbolVisitor = std::make_unique<PDBSymbolVisitor<UdtFieldDefinition>>(
-		m_HeaderReconstructor.get(),
-		&m_Settings.UdtFieldDefinitionSettings
-		);
-
-	m_SymbolSorter = std::make_unique<PDBSymbolSorter>();
-}
-
-void
-PDBExtractor::OpenPDBFile()
-{
-	if (m_PDB.Open(m_Settings.PdbPath.c_str()) == FALSE)
-	{
-		throw PDBDumperException(MESSAGE_FILE_NOT_FOUND);
-	}
-}
+	//
+	// Decompression does not need <symbol> and <path>.
+	//
 
-void
-PDBExtractor::PrintTestHeader()
-{
-	if (m_Settings.PdbHeaderReconstructorSettings.TestFile != nullptr)
+	if (m_Settings.CatFilename)
 	{
-		static char TEST_FILE_HEADER_FORMATTED[16 * 1024];
-		sprintf_s(
-			TEST_FILE_HEADER_FORMATTED, TEST_FILE_HEADER,
-			m_Settings.OutputFilename
-			);
+		if (PositionalArgumentCount != 0 || m_Settings.TestFilename)
+		{
+			throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+		}
 
-		(*m_Settings.PdbHeaderReconstructorSettings.TestFile) << TEST_FILE_HEADER_FORMATTED;
+		OpenOutputFile();
+		return;
 	}
-}
 
-void
-PDBExtractor::PrintTestFooter()
-{
-	if (m_Settings.PdbHeaderReconstructorSettings.TestFile != nullptr)
-	{
-		(*m_Settings.PdbHeaderReconstructorSettings.TestFile) << TEST_FILE_FOOTER;
-	}
-}
+	//
+	// Offset pack reads its own list of PDB files.
+	//
 
-void
-PDBExtractor::PrintPDBHeader()
-{
-	if (m_Settings.PrintHeader)
+	if (m_Settings.OffsetPackFilename)
 	{
-		static const char* const ArchitectureString =
-			m_PDB.GetMachineType() == IMAGE_FILE_MACHINE_I386  ? "x86" :
-			m_PDB.GetMachineType() == IMAGE_FILE_MACHINE_AMD64 ? "x64" :
-			m_PDB.GetMachineType() == IMAGE_FILE_MACHINE_IA64  ? "ia64" :
-			                                                     "Unknown";
-
-		static char HEADER_FILE_HEADER_FORMATTED[16 * 1024];
-
-		sprintf_s(
-			HEADER_FILE_HEADER_FORMATTED, HEADER_FILE_HEADER,
-			m_Settings.PdbPath.c_str(),
-			ArchitectureString
-			);
+		if (PositionalArgumentCount != 0 || m_Settings.TestFilename ||
+		    !m_Settings.OffsetPackFieldsFilename || !m_Settings.PdbListFilename)
+		{
+			throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+		}
 
-		(*m_Settings.PdbHeaderReconstructorSettings.OutputFile) << HEADER_FILE_HEADER_FORMATTED;
+		OpenOutputFile();
+		return;
 	}
-}
 
-void
-PDBExtractor::PrintPDBDeclarations()
-{
 	//
-	// Write declarations.
+	// Mounted headers are rendered from the PDBs of the list.
 	//
 
-	if (m_Settings.PrintDeclarations)
+	if (m_Settings.MountDirectory)
 	{
-		for (auto&& e : m_SymbolSorter->GetSortedSymbols())
+		if (PositionalArgumentCount != 0 || m_Settings.TestFilename ||
+		    !m_Settings.PdbListFilename)
 		{
-			if (e->Tag == SymTagUDT && !PDB::IsUnnamedSymbol(e))
-			{
-				*m_Settings.PdbHeaderReconstructorSettings.OutputFile
-					<< PDB::GetUdtKindString(e->u.Udt.Kind)
-					<< " " << m_HeaderReconstructor->GetCorrectedSymbolName(e) << ";"
-					<< std::endl;
-			}
+			throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
 		}
 
-		*m_Settings.PdbHeaderReconstructorSettings.OutputFile << std::endl;
+		OpenOutputFile();
+		CreateSymbolVisitor();
+		return;
 	}
-}
 
-void
-PDBExtractor::PrintPDBDefinitions()
-{
 	//
-	// Write definitions.
+	// Symbolization opens PDBs of all modules of the list.
 	//
 
-	if (m_Settings.PrintDefinitions)
+	if (m_Settings.SymbolizeFilename)
 	{
-		for (auto&& e : m_SymbolSorter->GetSortedSymbols())
+		if (PositionalArgumentCount != 0 || m_Settings.TestFilename ||
+		    !m_Settings.ModuleListFilename)
 		{
-			bool Expand = true;
+			throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+		}
 
-			//
-			// Do not expand unnamed types, if they will be inlined.
-			//
+		OpenOutputFile();
+		return;
+	}
 
-			if (m_Settings.PdbHeaderReconstructorSettings.MemberStructExpansion == PDBHeaderReconstructor::MemberStructExpansionType::InlineUnnamed &&
-				  (e->Tag == SymTagEnum || e->Tag == SymTagUDT) &&
-				  PDB::IsUnnamedSymbol(e))
-			{
-				Expand = false;
-			}
+	//
+	// Identities are read from the PDBs of the list.
+	//
 
-			if (Expand)
-			{
-				m_SymbolVisitor->Run(e);
-			}
+	if (m_Settings.PrintIdentities)
+	{
+		if (PositionalArgumentCount != 0 || m_Settings.TestFilename ||
+		    !m_Settings.PdbListFilename)
+		{
+			throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
 		}
+
+		OpenOutputFile();
+		return;
 	}
-}
 
-void
-PDBExtractor::DumpAllSymbols()
-{
 	//
-	// We are going to print all symbols.
+	// Type browser renders the PDBs of the list.
 	//
 
-	PrintPDBHeader();
+	if (m_Settings.BrowseDirectory)
+	{
+		if (PositionalArgumentCount != 0 || m_Settings.TestFilename ||
+		    !m_Settings.PdbListFilename)
+		{
+			throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+		}
 
-	for (auto&& e : m_PDB.GetSymbolMap())
+		OpenOutputFile();
+		return;
+	}
+
+	if (PositionalArgumentCount != 2)
 	{
-		m_SymbolSorter->Visit(e.second);
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
 	}
 
-	PrintPDBDeclarations();
-	PrintPDBDefinitions();
-}
+	if (m_Settings.HeatmapTraceFilename && !m_Settings.HeatmapBindingsFilename)
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
 
-void
-PDBExtractor::DumpOneSymbol()
-{
-	const SYMBOL* Symbol = m_PDB.GetSymbolByName(m_Settings.SymbolName.c_str());
+	if (m_Settings.Diff &&
+	    (m_Settings.ImageFilenames.size() != 2 ||
+	     (!m_Settings.ObjectsFilename && !m_Settings.WalkSpecification)))
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
 
-	if (Symbol == nullptr)
+	if (m_Settings.QueryExpression &&
+	    (m_Settings.ImageFilenames.size() != 1 ||
+	     (!m_Settings.ObjectsFilename && !m_Settings.WalkSpecification)))
 	{
-		throw PDBDumperException(MESSAGE_SYMBOL_NOT_FOUND);
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
 	}
 
-	PrintPDBHeader();
+	if (m_Settings.ContextsFilename && m_Settings.ImageFilenames.size() != 1)
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	if (m_Settings.Crawl &&
+	    (m_Settings.ImageFilenames.size() != 1 ||
+	     (!m_Settings.ObjectsFilename && m_Settings.RootAddresses.empty())))
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
 
 	//
-	// InlineAll supresses PrintReferencedTypes.
+	// Modules are written into their own files.
 	//
 
-	if (m_Settings.PrintReferencedTypes &&
-	    m_Settings.PdbHeaderReconstructorSettings.MemberStructExpansion != PDBHeaderReconstructor::MemberStructExpansionType::InlineAll)
+	if (m_Settings.ModulesDirectory && (m_Settings.OutputFilename || m_Settings.TestFilename))
 	{
-		m_SymbolSorter->Visit(Symbol);
-
-		//
-		// Print header only when PrintReferencedTypes == true.
-		//
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
 
-		PrintPDBDefinitions();
+	if (m_Settings.ModuleName && m_Settings.SymbolName != "*")
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	if (!m_Settings.ScanPaths.empty() && (m_Settings.SymbolName != "*" || m_Settings.ModuleName))
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	OpenOutputFile();
+	CreateSymbolVisitor();
+
+	m_SymbolSorter = std::make_unique<PDBSymbolSorter>();
+}
+
+void
+PDBExtractor::ParseLongParameter(
+	const char* CurrentArgument,
+	const char* NextArgument,
+	int& ArgumentPointer
+	)
+{
+	//
+	// Switches without value.
+	//
+
+	if (strcmp(CurrentArgument, "--optimize-layout") == 0)
+	{
+		m_Settings.OptimizeLayout = true;
+		return;
+	}
+
+	if (strcmp(CurrentArgument, "--generic-emitter") == 0)
+	{
+		m_Settings.SpecializeEmitter = false;
+		return;
+	}
+
+	if (strcmp(CurrentArgument, "--enum-tables") == 0)
+	{
+		m_Settings.PrintEnumTables = true;
+		return;
+	}
+
+	if (strcmp(CurrentArgument, "--reflection") == 0)
+	{
+		m_Settings.PrintReflectionTables = true;
+		return;
+	}
+
+	if (strcmp(CurrentArgument, "--diff") == 0)
+	{
+		m_Settings.Diff = true;
+		return;
+	}
+
+	if (strcmp(CurrentArgument, "--crawl") == 0)
+	{
+		m_Settings.Crawl = true;
+		return;
+	}
+
+	if (strcmp(CurrentArgument, "--dot") == 0)
+	{
+		m_Settings.PrintDot = true;
+		return;
+	}
+
+	if (strcmp(CurrentArgument, "--identities") == 0)
+	{
+		m_Settings.PrintIdentities = true;
+		return;
+	}
+
+	//
+	// Switches with value.
+	//
+
+	if (!NextArgument)
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	++ArgumentPointer;
+
+	if (strcmp(CurrentArgument, "--pin") == 0)
+	{
+		m_Settings.PdbLayoutOptimizerSettings.PinnedFields.push_back(NextArgument);
+	}
+	else if (strcmp(CurrentArgument, "--group") == 0)
+	{
+		std::vector<std::string> FieldGroup;
+		std::string FieldList = NextArgument;
+
+		size_t Begin = 0;
+		while (Begin <= FieldList.size())
+		{
+			size_t End = FieldList.find(',', Begin);
+			if (End == std::string::npos)
+			{
+				End = FieldList.size();
+			}
+
+			if (End > Begin)
+			{
+				FieldGroup.push_back(FieldList.substr(Begin, End - Begin));
+			}
+
+			Begin = End + 1;
+		}
+
+		m_Settings.PdbLayoutOptimizerSettings.FieldGroups.push_back(FieldGroup);
+	}
+	else if (strcmp(CurrentArgument, "--cache-line") == 0)
+	{
+		int CacheLineSize = atoi(NextArgument);
+
+		if (CacheLineSize <= 0)
+		{
+			throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+		}
+
+		m_Settings.PdbLayoutOptimizerSettings.CacheLineSize = static_cast<DWORD>(CacheLineSize);
+		m_Settings.PdbFieldHeatmapSettings.CacheLineSize = static_cast<DWORD>(CacheLineSize);
+		m_Settings.PdbStructureDiffSettings.CacheLineSize = static_cast<DWORD>(CacheLineSize);
+	}
+	else if (strcmp(CurrentArgument, "--top") == 0)
+	{
+		m_Settings.OptimizeLayoutTop = static_cast<DWORD>(atoi(NextArgument));
+	}
+	else if (strcmp(CurrentArgument, "--heatmap") == 0)
+	{
+		m_Settings.HeatmapTraceFilename = NextArgument;
+	}
+	else if (strcmp(CurrentArgument, "--bindings") == 0)
+	{
+		m_Settings.HeatmapBindingsFilename = NextArgument;
+	}
+	else if (strcmp(CurrentArgument, "--modules") == 0)
+	{
+		m_Settings.ModulesDirectory = NextArgument;
+	}
+	else if (strcmp(CurrentArgument, "--module") == 0)
+	{
+		m_Settings.ModuleName = NextArgument;
+	}
+	else if (strcmp(CurrentArgument, "--scan") == 0)
+	{
+		m_Settings.ScanPaths.push_back(NextArgument);
+	}
+	else if (strcmp(CurrentArgument, "--shard-size") == 0)
+	{
+		int ShardSize = atoi(NextArgument);
+
+		if (ShardSize <= 0)
+		{
+			throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+		}
+
+		m_Settings.PdbModuleMapSettings.ShardSize = static_cast<DWORD>(ShardSize);
+	}
+	else if (strcmp(CurrentArgument, "--threads") == 0)
+	{
+		m_Settings.PdbFieldHeatmapSettings.ThreadCount = static_cast<DWORD>(atoi(NextArgument));
+		m_Settings.GzipStreamSettings.ThreadCount = static_cast<DWORD>(atoi(NextArgument));
+		m_Settings.PdbStructureDiffSettings.ThreadCount = static_cast<DWORD>(atoi(NextArgument));
+		m_Settings.PdbObjectGraphSettings.ThreadCount = static_cast<DWORD>(atoi(NextArgument));
+		m_Settings.PdbLineTableSettings.ThreadCount = static_cast<DWORD>(atoi(NextArgument));
+		m_Settings.PdbStackUnwinderSettings.ThreadCount = static_cast<DWORD>(atoi(NextArgument));
+		m_Settings.PdbSourceScannerSettings.ThreadCount = static_cast<DWORD>(atoi(NextArgument));
+		m_Settings.PdbSymbolSessionSettings.ThreadCount = static_cast<DWORD>(atoi(NextArgument));
+		m_Settings.PdbIdentityScannerSettings.ThreadCount = static_cast<DWORD>(atoi(NextArgument));
+		m_Settings.PdbTypeBrowserSettings.ThreadCount = static_cast<DWORD>(atoi(NextArgument));
+		m_Settings.DwarfThreadCount = static_cast<DWORD>(atoi(NextArgument));
+	}
+	else if (strcmp(CurrentArgument, "--cat") == 0)
+	{
+		m_Settings.CatFilename = NextArgument;
+	}
+	else if (strcmp(CurrentArgument, "--image") == 0)
+	{
+		m_Settings.ImageFilenames.push_back(NextArgument);
+	}
+	else if (strcmp(CurrentArgument, "--image-base") == 0)
+	{
+		m_Settings.ImageBaseAddress = _strtoui64(NextArgument, nullptr, 16);
+	}
+	else if (strcmp(CurrentArgument, "--objects") == 0)
+	{
+		m_Settings.ObjectsFilename = NextArgument;
+	}
+	else if (strcmp(CurrentArgument, "--walk") == 0)
+	{
+		if (strchr(NextArgument, ':') == nullptr)
+		{
+			throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+		}
+
+		m_Settings.WalkSpecification = NextArgument;
+	}
+	else if (strcmp(CurrentArgument, "--query") == 0)
+	{
+		m_Settings.QueryExpression = NextArgument;
+	}
+	else if (strcmp(CurrentArgument, "--select") == 0)
+	{
+		m_Settings.SelectFields = NextArgument;
+	}
+	else if (strcmp(CurrentArgument, "--lines") == 0)
+	{
+		m_Settings.LinesFilename = NextArgument;
+	}
+	else if (strcmp(CurrentArgument, "--unwind") == 0)
+	{
+		m_Settings.ContextsFilename = NextArgument;
+	}
+	else if (strcmp(CurrentArgument, "--module-base") == 0)
+	{
+		m_Settings.ModuleBaseAddress = _strtoui64(NextArgument, nullptr, 16);
+	}
+	else if (strcmp(CurrentArgument, "--max-frames") == 0)
+	{
+		int MaximumFrameCount = atoi(NextArgument);
+
+		if (MaximumFrameCount <= 0)
+		{
+			throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+		}
+
+		m_Settings.PdbStackUnwinderSettings.MaximumFrameCount = static_cast<DWORD>(MaximumFrameCount);
+	}
+	else if (strcmp(CurrentArgument, "--offset-pack") == 0)
+	{
+		m_Settings.OffsetPackFilename = NextArgument;
+	}
+	else if (strcmp(CurrentArgument, "--fields") == 0)
+	{
+		m_Settings.OffsetPackFieldsFilename = NextArgument;
+	}
+	else if (strcmp(CurrentArgument, "--pdb-list") == 0)
+	{
+		m_Settings.PdbListFilename = NextArgument;
+	}
+	else if (strcmp(CurrentArgument, "--mount") == 0)
+	{
+		m_Settings.MountDirectory = NextArgument;
+	}
+	else if (strcmp(CurrentArgument, "--symbolize") == 0)
+	{
+		m_Settings.SymbolizeFilename = NextArgument;
+	}
+	else if (strcmp(CurrentArgument, "--module-list") == 0)
+	{
+		m_Settings.ModuleListFilename = NextArgument;
+	}
+	else if (strcmp(CurrentArgument, "--browse") == 0)
+	{
+		m_Settings.BrowseDirectory = NextArgument;
+	}
+	else if (strcmp(CurrentArgument, "--in-flight") == 0)
+	{
+		int MaximumFileCount = atoi(NextArgument);
+
+		if (MaximumFileCount <= 0)
+		{
+			throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+		}
+
+		m_Settings.PdbIdentityScannerSettings.MaximumFileCount = static_cast<DWORD>(MaximumFileCount);
+	}
+	else if (strcmp(CurrentArgument, "--root") == 0)
+	{
+		m_Settings.RootAddresses.push_back(_strtoui64(NextArgument, nullptr, 16));
+	}
+	else if (strcmp(CurrentArgument, "--max-depth") == 0)
+	{
+		m_Settings.PdbObjectGraphSettings.MaximumDepth = static_cast<DWORD>(atoi(NextArgument));
+	}
+	else if (strcmp(CurrentArgument, "--max-nodes") == 0)
+	{
+		int MaximumNodeCount = atoi(NextArgument);
+
+		if (MaximumNodeCount <= 0)
+		{
+			throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+		}
+
+		m_Settings.PdbObjectGraphSettings.MaximumNodeCount = static_cast<DWORD>(MaximumNodeCount);
 	}
 	else
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+}
+
+void
+PDBExtractor::OpenOutputFile()
+{
+	if (!m_Settings.OutputFilename)
+	{
+		return;
+	}
+
+	//
+	// Output file is opened after all parameters are parsed,
+	// because the compressor depends on --threads.
+	//
+
+	std::string Filename = m_Settings.OutputFilename;
+
+	auto HasExtension = [&Filename](const char* Extension) {
+		size_t ExtensionLength = strlen(Extension);
+
+		return Filename.size() >= ExtensionLength &&
+		       _stricmp(Filename.c_str() + Filename.size() - ExtensionLength, Extension) == 0;
+	};
+
+	if (HasExtension(".gz"))
+	{
+		GzipOutputStream* OutputFile = new GzipOutputStream(&m_Settings.GzipStreamSettings);
+		m_Settings.PdbHeaderReconstructorSettings.OutputFile = OutputFile;
+
+		if (!OutputFile->Open(m_Settings.OutputFilename))
+		{
+			throw PDBDumperException(MESSAGE_CANNOT_CREATE_FILE);
+		}
+	}
+	else if (HasExtension(".zst"))
 	{
 		//
-		// Print only the specified symbol.
+		// The output would not be readable by --cat.
 		//
 
-		m_SymbolVisitor->Run(Symbol);
+		m_Settings.OutputFilename = nullptr;
+		throw PDBDumperException(MESSAGE_UNSUPPORTED_COMPRESSION);
+	}
+	else
+	{
+		m_Settings.PdbHeaderReconstructorSettings.OutputFile = new std::ofstream(
+			m_Settings.OutputFilename,
+			std::ios::out
+			);
+	}
+}
+
+void
+PDBExtractor::CreateSymbolVisitor()
+{
+	//
+	// Pick the emitter instantiated for the parsed settings,
+	// so the hot paths do not test them for every field.
+	//
+
+	m_HeaderReconstructor = PDBHeaderReconstructor::Create(
+		&m_Settings.PdbHeaderReconstructorSettings,
+		m_Settings.SpecializeEmitter
+		);
+
+	if (!m_Settings.SpecializeEmitter)
+	{
+		m_SymbolVisitor = std::make_unique<PDBSymbolVisitor<UdtFieldDefinition>>(
+			m_HeaderReconstructor.get(),
+			&m_Settings.UdtFieldDefinitionSettings
+			);
+	}
+	else if (m_Settings.UdtFieldDefinitionSettings.UseStdInt)
+	{
+		m_SymbolVisitor = std::make_unique<PDBSymbolVisitor<UdtFieldDefinitionSpecialized<true>>>(
+			m_HeaderReconstructor.get(),
+			&m_Settings.UdtFieldDefinitionSettings
+			);
+	}
+	else
+	{
+		m_SymbolVisitor = std::make_unique<PDBSymbolVisitor<UdtFieldDefinitionSpecialized<false>>>(
+			m_HeaderReconstructor.get(),
+			&m_Settings.UdtFieldDefinitionSettings
+			);
+	}
+}
+
+void
+PDBExtractor::OpenPDBFile()
+{
+	if (m_PDB.Open(m_Settings.PdbPath.c_str(), m_Settings.DwarfThreadCount) == FALSE)
+	{
+		switch (m_PDB.GetOpenError())
+		{
+			case PDB::OpenError::NoDebugInfo:
+				throw PDBDumperException(MESSAGE_NO_DEBUG_INFO);
+
+			case PDB::OpenError::SplitDwarf:
+				throw PDBDumperException(MESSAGE_SPLIT_DWARF);
+
+			default:
+				throw PDBDumperException(MESSAGE_FILE_NOT_FOUND);
+		}
+	}
+
+	//
+	// long is 8 bytes long and __int64 is unknown to the compilers
+	// of the ELF targets, their headers use the portable types.
+	//
+
+	if (m_PDB.IsElfFile())
+	{
+		m_Settings.UdtFieldDefinitionSettings.UsePortableTypes = true;
+		m_Settings.PdbHeaderReconstructorSettings.UsePortableTypes = true;
+	}
+}
+
+void
+PDBExtractor::PrintTestHeader()
+{
+	if (m_Settings.PdbHeaderReconstructorSettings.TestFile != nullptr)
+	{
+		static char TEST_FILE_HEADER_FORMATTED[16 * 1024];
+		sprintf_s(
+			TEST_FILE_HEADER_FORMATTED, TEST_FILE_HEADER,
+			m_Settings.OutputFilename
+			);
+
+		(*m_Settings.PdbHeaderReconstructorSettings.TestFile) << TEST_FILE_HEADER_FORMATTED;
+	}
+}
+
+void
+PDBExtractor::PrintTestFooter()
+{
+	if (m_Settings.PdbHeaderReconstructorSettings.TestFile != nullptr)
+	{
+		(*m_Settings.PdbHeaderReconstructorSettings.TestFile) << TEST_FILE_FOOTER;
+	}
+}
+
+void
+PDBExtractor::PrintPDBHeader(
+	const PDB* Pdb
+	)
+{
+	if (Pdb == nullptr)
+	{
+		Pdb = &m_PDB;
+	}
+
+	if (m_Settings.PrintHeader)
+	{
+		const char* const ArchitectureString =
+			Pdb->GetMachineType() == IMAGE_FILE_MACHINE_I386  ? "x86" :
+			Pdb->GetMachineType() == IMAGE_FILE_MACHINE_AMD64 ? "x64" :
+			Pdb->GetMachineType() == IMAGE_FILE_MACHINE_IA64  ? "ia64" :
+			                                                    "Unknown";
+
+		static char HEADER_FILE_HEADER_FORMATTED[16 * 1024];
+
+		sprintf_s(
+			HEADER_FILE_HEADER_FORMATTED, HEADER_FILE_HEADER,
+			Pdb->GetPath(),
+			ArchitectureString
+			);
+
+		(*m_Settings.PdbHeaderReconstructorSettings.OutputFile) << HEADER_FILE_HEADER_FORMATTED;
+	}
+}
+
+void
+PDBExtractor::PrintPDBDeclarations(
+	PDBSymbolSorter* SymbolSorter
+	)
+{
+	if (SymbolSorter == nullptr)
+	{
+		SymbolSorter = m_SymbolSorter.get();
+	}
+
+	//
+	// Write declarations.
+	//
+
+	if (m_Settings.PrintDeclarations)
+	{
+		for (auto&& e : SymbolSorter->GetSortedSymbols())
+		{
+			if (e->Tag == SymTagUDT && !PDB::IsUnnamedSymbol(e))
+			{
+				*m_Settings.PdbHeaderReconstructorSettings.OutputFile
+					<< PDB::GetUdtKindString(e->u.Udt.Kind)
+					<< " " << m_HeaderReconstructor->GetCorrectedSymbolName(e) << ";"
+					<< std::endl;
+			}
+		}
+
+		*m_Settings.PdbHeaderReconstructorSettings.OutputFile << std::endl;
+	}
+}
+
+void
+PDBExtractor::PrintPDBDefinitions()
+{
+	//
+	// Write definitions.
+	//
+
+	if (m_Settings.PrintDefinitions)
+	{
+		for (auto&& e : m_SymbolSorter->GetSortedSymbols())
+		{
+			bool Expand = true;
+
+			//
+			// Do not expand unnamed types, if they will be inlined.
+			//
+
+			if (m_Settings.PdbHeaderReconstructorSettings.MemberStructExpansion == PDBHeaderReconstructor::MemberStructExpansionType::InlineUnnamed &&
+				  (e->Tag == SymTagEnum || e->Tag == SymTagUDT) &&
+				  PDB::IsUnnamedSymbol(e))
+			{
+				Expand = false;
+			}
+
+			if (Expand)
+			{
+				m_SymbolVisitor->Visit(e);
+			}
+		}
+	}
+}
+
+void
+PDBExtractor::PrintEnumTables(
+	const SYMBOL* Symbol
+	)
+{
+	if (!m_Settings.PrintEnumTables)
+	{
+		return;
+	}
+
+	PDBEnumTableGenerator EnumTableGenerator(&m_Settings.PdbEnumTableGeneratorSettings);
+
+	//
+	// Tables of the provided symbol or of all sorted symbols.
+	// Unnamed enums have no name the functions could be named after.
+	//
+
+	std::vector<const SYMBOL*> Symbols;
+
+	if (Symbol)
+	{
+		Symbols.push_back(Symbol);
+	}
+	else
+	{
+		Symbols = m_SymbolSorter->GetSortedSymbols();
+	}
+
+	for (auto&& e : Symbols)
+	{
+		if (e->Tag == SymTagEnum && !PDB::IsUnnamedSymbol(e))
+		{
+			EnumTableGenerator.Write(
+				*m_Settings.PdbHeaderReconstructorSettings.OutputFile,
+				e,
+				m_HeaderReconstructor->GetCorrectedSymbolName(e)
+				);
+		}
+	}
+}
+
+void
+PDBExtractor::PrintReflectionTables(
+	const SYMBOL* Symbol
+	)
+{
+	if (!m_Settings.PrintReflectionTables)
+	{
+		return;
+	}
+
+	PDBReflectionGenerator ReflectionGenerator(&m_Settings.PdbReflectionGeneratorSettings, m_HeaderReconstructor.get());
+
+	if (Symbol)
+	{
+		ReflectionGenerator.Add(Symbol, m_HeaderReconstructor->GetCorrectedSymbolName(Symbol));
+	}
+	else
+	{
+		for (auto&& e : m_SymbolSorter->GetSortedSymbols())
+		{
+			ReflectionGenerator.Add(e, m_HeaderReconstructor->GetCorrectedSymbolName(e));
+		}
+	}
+
+	ReflectionGenerator.Write(*m_Settings.PdbHeaderReconstructorSettings.OutputFile);
+}
+
+void
+PDBExtractor::VisitAllSymbols()
+{
+	if (!m_Settings.ScanPaths.empty())
+	{
+		VisitScannedSymbols();
+		return;
+	}
+
+	if (m_Settings.ModuleName == nullptr)
+	{
+		for (auto&& e : m_PDB.GetSymbolMap())
+		{
+			m_SymbolSorter->Visit(e.second);
+		}
+
+		return;
+	}
+
+	//
+	// Only types referenced by the module (and types they contain).
+	//
+
+	SymbolList ModuleSymbols;
+
+	if (!m_PDB.GetModuleSymbols(m_Settings.ModuleName, ModuleSymbols))
+	{
+		throw PDBDumperException(MESSAGE_MODULE_NOT_FOUND);
+	}
+
+	for (auto&& Symbol : ModuleSymbols)
+	{
+		m_SymbolSorter->Visit(Symbol);
+	}
+}
+
+void
+PDBExtractor::VisitScannedSymbols()
+{
+	//
+	// Only types referenced by the sources (and types they contain),
+	// named as they are printed.
+	//
+
+	m_Settings.PdbSourceScannerSettings.SymbolPrefix = m_Settings.PdbHeaderReconstructorSettings.SymbolPrefix;
+	m_Settings.PdbSourceScannerSettings.SymbolSuffix = m_Settings.PdbHeaderReconstructorSettings.SymbolSuffix;
+	m_Settings.PdbSourceScannerSettings.MicrosoftTypedefs = m_Settings.PdbHeaderReconstructorSettings.MicrosoftTypedefs;
+
+	PDBSourceScanner SourceScanner(&m_PDB, &m_Settings.PdbSourceScannerSettings);
+
+	for (auto&& ScanPath : m_Settings.ScanPaths)
+	{
+		if (!SourceScanner.AddPath(ScanPath))
+		{
+			throw PDBDumperException(MESSAGE_SOURCES_NOT_FOUND);
+		}
+	}
+
+	SymbolList ScannedSymbols;
+
+	if (!SourceScanner.Scan(ScannedSymbols))
+	{
+		throw PDBDumperException(MESSAGE_SOURCES_NOT_FOUND);
+	}
+
+	for (auto&& Symbol : ScannedSymbols)
+	{
+		m_SymbolSorter->Visit(Symbol);
+	}
+}
+
+void
+PDBExtractor::DumpAllSymbols()
+{
+	//
+	// We are going to print all symbols.
+	//
+
+	PrintPDBHeader();
+
+	VisitAllSymbols();
+
+	PrintPDBDeclarations();
+	PrintPDBDefinitions();
+	PrintEnumTables();
+	PrintReflectionTables();
+}
+
+void
+PDBExtractor::DumpOneSymbol()
+{
+	const SYMBOL* Symbol = m_PDB.GetSymbolByName(m_Settings.SymbolName.c_str());
+
+	if (Symbol == nullptr)
+	{
+		throw PDBDumperException(MESSAGE_SYMBOL_NOT_FOUND);
+	}
+
+	PrintPDBHeader();
+
+	//
+	// InlineAll supresses PrintReferencedTypes.
+	//
+
+	if (m_Settings.PrintReferencedTypes &&
+	    m_Settings.PdbHeaderReconstructorSettings.MemberStructExpansion != PDBHeaderReconstructor::MemberStructExpansionType::InlineAll)
+	{
+		m_SymbolSorter->Visit(Symbol);
+
+		//
+		// Print header only when PrintReferencedTypes == true.
+		//
+
+		PrintPDBDefinitions();
+		PrintEnumTables();
+		PrintReflectionTables();
+	}
+	else
+	{
+		//
+		// Print only the specified symbol.
+		//
+
+		m_SymbolVisitor->Visit(Symbol);
+		PrintEnumTables(Symbol);
+		PrintReflectionTables(Symbol);
+	}
+}
+
+void
+PDBExtractor::DumpModules()
+{
+	if (m_Settings.SymbolName == "*")
+	{
+		VisitAllSymbols();
+	}
+	else
+	{
+		const SYMBOL* Symbol = m_PDB.GetSymbolByName(m_Settings.SymbolName.c_str());
+
+		if (Symbol == nullptr)
+		{
+			throw PDBDumperException(MESSAGE_SYMBOL_NOT_FOUND);
+		}
+
+		m_SymbolSorter->Visit(Symbol);
+	}
+
+	//
+	// Module is named after the PDB file (without extension).
+	//
+
+	std::string ModuleName = m_Settings.PdbPath;
+	ModuleName = ModuleName.substr(ModuleName.find_last_of("\\/") + 1);
+	ModuleName = ModuleName.substr(0, ModuleName.find_last_of('.'));
+
+	m_Settings.PdbModuleMapSettings.ModuleName = PDBModuleMap::GetModuleName(ModuleName);
+	m_Settings.PdbModuleMapSettings.InlineUnnamed =
+		m_Settings.PdbHeaderReconstructorSettings.MemberStructExpansion == PDBHeaderReconstructor::MemberStructExpansionType::InlineUnnamed;
+
+	PDBModuleMap ModuleMap(&m_Settings.PdbModuleMapSettings);
+	ModuleMap.Build(m_SymbolSorter.get());
+
+	if (CreateDirectoryA(m_Settings.ModulesDirectory, nullptr) == FALSE &&
+	    GetLastError() != ERROR_ALREADY_EXISTS)
+	{
+		throw PDBDumperException(MESSAGE_CANNOT_CREATE_DIRECTORY);
+	}
+
+	auto OpenFile = [this](const std::string& FileName) {
+		std::string Path = std::string(m_Settings.ModulesDirectory) + "\\" + FileName;
+		std::unique_ptr<std::ofstream> File = std::make_unique<std::ofstream>(Path, std::ios::out);
+
+		if (!File->is_open())
+		{
+			throw PDBDumperException(MESSAGE_CANNOT_CREATE_FILE);
+		}
+
+		return File;
+	};
+
+	//
+	// Printing functions write into the OutputFile,
+	// point it to each of the files in turn.
+	//
+
+	std::ostream* OutputFile = m_Settings.PdbHeaderReconstructorSettings.OutputFile;
+
+	try
+	{
+		auto DeclarationsFile = OpenFile(ModuleMap.GetDeclarationsFileName());
+		m_Settings.PdbHeaderReconstructorSettings.OutputFile = DeclarationsFile.get();
+
+		PrintPDBHeader();
+		*DeclarationsFile << "#pragma once" << std::endl << std::endl;
+		PrintPDBDeclarations();
+
+		for (auto&& Shard : ModuleMap.GetShards())
+		{
+			auto ShardFile = OpenFile(Shard.FileName);
+			m_Settings.PdbHeaderReconstructorSettings.OutputFile = ShardFile.get();
+
+			PrintPDBHeader();
+			ModuleMap.WriteShardPrologue(*ShardFile, Shard);
+
+			for (auto&& e : Shard.Symbols)
+			{
+				m_SymbolVisitor->Visit(e);
+			}
+		}
+
+		m_Settings.PdbHeaderReconstructorSettings.OutputFile = OutputFile;
+	}
+	catch (...)
+	{
+		m_Settings.PdbHeaderReconstructorSettings.OutputFile = OutputFile;
+		throw;
+	}
+
+	ModuleMap.WriteUmbrellaHeader(*OpenFile(ModuleMap.GetUmbrellaFileName()));
+	ModuleMap.WriteModuleMap(*OpenFile("module.modulemap"));
+}
+
+void
+PDBExtractor::OptimizeLayout()
+{
+	PDBLayoutOptimizer Optimizer(&m_Settings.PdbLayoutOptimizerSettings);
+
+	PrintPDBHeader();
+
+	std::deque<PDBLayoutOptimizer::Result> Results;
+	std::vector<const PDBLayoutOptimizer::Result*> Ranking;
+
+	if (m_Settings.SymbolName != "*")
+	{
+		const SYMBOL* Symbol = m_PDB.GetSymbolByName(m_Settings.SymbolName.c_str());
+
+		if (Symbol == nullptr)
+		{
+			throw PDBDumperException(MESSAGE_SYMBOL_NOT_FOUND);
+		}
+
+		Results.emplace_back();
+
+		if (!Optimizer.Optimize(Symbol, Results.back()))
+		{
+			throw PDBDumperException(MESSAGE_SYMBOL_NOT_REORDERABLE);
+		}
+
+		Ranking.push_back(&Results.back());
+	}
+	else
+	{
+		//
+		// Optimize all named structures (each name only once,
+		// see PDBSymbolSorter::HasBeenVisited())
+		// and rank them by the count of saved bytes and cache line splits.
+		//
+
+		std::set<std::string> VisitedSymbols;
+
+		for (auto&& e : m_PDB.GetSymbolMap())
+		{
+			const SYMBOL* Symbol = e.second;
+
+			if (Symbol->Tag != SymTagUDT ||
+			    PDB::IsUnnamedSymbol(Symbol) ||
+			    VisitedSymbols.insert(Symbol->Name).second == false)
+			{
+				continue;
+			}
+
+			Results.emplace_back();
+
+			if (!Optimizer.Optimize(Symbol, Results.back()) ||
+			    (!Results.back().IsConstrained && Results.back().GetSavedBytes() <= 0 && Results.back().GetSavedSplits() <= 0))
+			{
+				Results.pop_back();
+				continue;
+			}
+
+			Ranking.push_back(&Results.back());
+		}
+
+		std::sort(Ranking.begin(), Ranking.end(), [](const PDBLayoutOptimizer::Result* Lhs, const PDBLayoutOptimizer::Result* Rhs) {
+			if (Lhs->GetSavedBytes() != Rhs->GetSavedBytes())
+			{
+				return Lhs->GetSavedBytes() > Rhs->GetSavedBytes();
+			}
+
+			if (Lhs->GetSavedSplits() != Rhs->GetSavedSplits())
+			{
+				return Lhs->GetSavedSplits() > Rhs->GetSavedSplits();
+			}
+
+			return strcmp(Lhs->Symbol->Name, Rhs->Symbol->Name) < 0;
+		});
+
+		if (Ranking.size() > m_Settings.OptimizeLayoutTop)
+		{
+			Ranking.resize(m_Settings.OptimizeLayoutTop);
+		}
+
+		std::ostream& OutputFile = *m_Settings.PdbHeaderReconstructorSettings.OutputFile;
+
+		OutputFile << FormatString(
+			"/*\n"
+			" * Layout optimization ranking (%u-byte cache lines)\n"
+			" *\n"
+			" *   saved   size              lines     splits    type\n"
+			" *   ------  ----------------  --------  --------  ----\n",
+			m_Settings.PdbLayoutOptimizerSettings.CacheLineSize
+			);
+
+		for (auto&& OptimizeResult : Ranking)
+		{
+			OutputFile << FormatString(
+				" *   %6i  0x%04x -> 0x%04x  %3u -> %-3u %3u -> %-3u %s\n",
+				OptimizeResult->GetSavedBytes(),
+				OptimizeResult->Original.Size,
+				OptimizeResult->Optimized.Size,
+				OptimizeResult->Original.CacheLineCount,
+				OptimizeResult->Optimized.CacheLineCount,
+				OptimizeResult->Original.CacheLineSplits,
+				OptimizeResult->Optimized.CacheLineSplits,
+				OptimizeResult->Symbol->Name
+				);
+		}
+
+		OutputFile << " */" << std::endl << std::endl;
+	}
+
+	//
+	// Reordered symbols are freed at the end, because the header
+	// reconstructor caches corrected names by the symbol address.
+	//
+
+	std::vector<SYMBOL*> ReorderedSymbols;
+
+	for (auto&& OptimizeResult : Ranking)
+	{
+		PrintOptimizedLayout(*OptimizeResult);
+
+		ReorderedSymbols.push_back(Optimizer.CreateReorderedSymbol(*OptimizeResult));
+		m_SymbolVisitor->Visit(ReorderedSymbols.back());
+	}
+
+	for (auto&& ReorderedSymbol : ReorderedSymbols)
+	{
+		PDBLayoutOptimizer::DestroyReorderedSymbol(ReorderedSymbol);
+	}
+}
+
+void
+PDBExtractor::PrintOptimizedLayout(
+	const PDBLayoutOptimizer::Result& OptimizeResult
+	)
+{
+	std::ostream& OutputFile = *m_Settings.PdbHeaderReconstructorSettings.OutputFile;
+
+	//
+	// Pinned and grouped fields are placed as requested,
+	// even if it costs more than the original layout.
+	//
+
+	OutputFile << FormatString(
+		"/*\n"
+		" * %s layout of %s %s (%u-byte cache lines)\n"
+		" *\n"
+		" *                original  %s\n"
+		" *   size:        0x%04x    0x%04x\n"
+		" *   padding:     0x%04x    0x%04x\n"
+		" *   cache lines: %-8u  %u\n"
+		" *   line splits: %-8u  %u\n",
+		OptimizeResult.IsConstrained ? "Constrained" : "Optimized",
+		PDB::GetUdtKindString(OptimizeResult.Symbol->u.Udt.Kind),
+		m_HeaderReconstructor->GetCorrectedSymbolName(OptimizeResult.Symbol).c_str(),
+		m_Settings.PdbLayoutOptimizerSettings.CacheLineSize,
+		OptimizeResult.IsConstrained ? "constrained" : "optimized",
+		OptimizeResult.Original.Size,
+		OptimizeResult.Optimized.Size,
+		OptimizeResult.Original.PaddingSize,
+		OptimizeResult.Optimized.PaddingSize,
+		OptimizeResult.Original.CacheLineCount,
+		OptimizeResult.Optimized.CacheLineCount,
+		OptimizeResult.Original.CacheLineSplits,
+		OptimizeResult.Optimized.CacheLineSplits
+		);
+
+	if (OptimizeResult.IsConstrained &&
+	    (OptimizeResult.GetSavedBytes() < 0 ||
+	     (OptimizeResult.GetSavedBytes() == 0 && OptimizeResult.GetSavedSplits() < 0)))
+	{
+		OutputFile << " *\n";
+		OutputFile << " *   pinned and grouped fields make the layout worse than the original\n";
+	}
+
+	OutputFile << " */\n";
+}
+
+void
+PDBExtractor::PrintFieldHeatmap()
+{
+	PDBFieldHeatmap Heatmap(&m_PDB, &m_Settings.PdbFieldHeatmapSettings);
+
+	if (!Heatmap.LoadBindings(m_Settings.HeatmapBindingsFilename))
+	{
+		throw PDBDumperException(MESSAGE_BINDINGS_NOT_FOUND);
+	}
+
+	if (!Heatmap.ProcessTrace(m_Settings.HeatmapTraceFilename))
+	{
+		throw PDBDumperException(MESSAGE_TRACE_NOT_FOUND);
+	}
+
+	const SYMBOL* Symbol = nullptr;
+
+	if (m_Settings.SymbolName != "*")
+	{
+		Symbol = PDBFieldLayout::GetUnderlyingType(m_PDB.GetSymbolByName(m_Settings.SymbolName.c_str()));
+
+		if (Symbol == nullptr)
+		{
+			throw PDBDumperException(MESSAGE_SYMBOL_NOT_FOUND);
+		}
+	}
+
+	if (Heatmap.GetUnknownBindingCount() != 0)
+	{
+		std::cerr << "Warning: " << Heatmap.GetUnknownBindingCount()
+		          << " bindings refer to unknown types" << std::endl;
+	}
+
+	PrintPDBHeader();
+
+	//
+	// Hottest types go first.
+	//
+
+	std::vector<const PDBFieldHeatmap::TypeHeatmap*> Ranking;
+
+	for (auto&& TypeHeatmap : Heatmap.GetTypeHeatmaps())
+	{
+		if (TypeHeatmap.TotalCount != 0 && (Symbol == nullptr || TypeHeatmap.Symbol == Symbol))
+		{
+			Ranking.push_back(&TypeHeatmap);
+		}
+	}
+
+	std::sort(Ranking.begin(), Ranking.end(), [](const PDBFieldHeatmap::TypeHeatmap* Lhs, const PDBFieldHeatmap::TypeHeatmap* Rhs) {
+		return Lhs->TotalCount > Rhs->TotalCount;
+	});
+
+
+	*m_Settings.PdbHeaderReconstructorSettings.OutputFile << FormatString(
+		"/*\n"
+		" * Field heatmap (%u-byte cache lines)\n"
+		" *\n"
+		" *   unbound accesses: %llu\n"
+		" */\n\n",
+		m_Settings.PdbFieldHeatmapSettings.CacheLineSize,
+		Heatmap.GetUnboundCount()
+		);
+
+	std::map<const SYMBOL_UDT_FIELD*, std::string> FieldComments;
+
+	for (auto&& TypeHeatmap : Ranking)
+	{
+		PrintTypeHeatmap(*TypeHeatmap);
+
+		PDBFieldHeatmap::BuildFieldComments(*TypeHeatmap, FieldComments);
+
+		m_Settings.PdbHeaderReconstructorSettings.FieldComments = &FieldComments;
+		m_SymbolVisitor->Visit(TypeHeatmap->Symbol);
+		m_Settings.PdbHeaderReconstructorSettings.FieldComments = nullptr;
+	}
+}
+
+void
+PDBExtractor::PrintTypeHeatmap(
+	const PDBFieldHeatmap::TypeHeatmap& Heatmap
+	)
+{
+	//
+	// Count of the hottest leaf fields listed in the summary.
+	//
+
+	static const size_t HottestFieldCount = 16;
+
+	std::ostream& OutputFile = *m_Settings.PdbHeaderReconstructorSettings.OutputFile;
+	DWORD CacheLineSize = m_Settings.PdbFieldHeatmapSettings.CacheLineSize;
+	double TotalCount = static_cast<double>(Heatmap.TotalCount);
+
+	OutputFile << FormatString(
+		"/*\n"
+		" * Heatmap of %s %s: %llu accesses in %llu objects\n"
+		" *\n"
+		" *   line  range            accesses              share\n"
+		" *   ----  ---------------  --------------------  -------\n",
+		PDB::GetUdtKindString(Heatmap.Symbol->u.Udt.Kind),
+		m_HeaderReconstructor->GetCorrectedSymbolName(Heatmap.Symbol).c_str(),
+		Heatmap.TotalCount,
+		Heatmap.ObjectCount
+		);
+
+	for (DWORD CacheLine = 0; CacheLine < Heatmap.CacheLineCounts.size(); CacheLine++)
+	{
+		OutputFile << FormatString(
+			" *   %-4u  0x%04x - 0x%04x  %-20llu  %6.2f%%\n",
+			CacheLine,
+			CacheLine * CacheLineSize,
+			(std::min)((CacheLine + 1) * CacheLineSize, Heatmap.Symbol->Size) - 1,
+			Heatmap.CacheLineCounts[CacheLine],
+			100.0 * static_cast<double>(Heatmap.CacheLineCounts[CacheLine]) / TotalCount
+			);
+	}
+
+	OutputFile << FormatString(
+		" *\n"
+		" *   padding: %llu (%.2f%%)\n"
+		" *\n"
+		" *   offset  accesses              share    field\n"
+		" *   ------  --------------------  -------  -----\n",
+		Heatmap.PaddingCount,
+		100.0 * static_cast<double>(Heatmap.PaddingCount) / TotalCount
+		);
+
+	auto& Fields = Heatmap.Layout->GetFields();
+	std::vector<DWORD> HottestFields;
+
+	for (DWORD Index = 0; Index < Fields.size(); Index++)
+	{
+		if (Fields[Index].IsLeaf && Heatmap.FieldCounts[Index] != 0)
+		{
+			HottestFields.push_back(Index);
+		}
+	}
+
+	std::stable_sort(HottestFields.begin(), HottestFields.end(), [&Heatmap](DWORD Lhs, DWORD Rhs) {
+		return Heatmap.FieldCounts[Lhs] > Heatmap.FieldCounts[Rhs];
+	});
+
+	if (HottestFields.size() > HottestFieldCount)
+	{
+		HottestFields.resize(HottestFieldCount);
+	}
+
+	for (auto&& Index : HottestFields)
+	{
+		OutputFile << FormatString(
+			" *   0x%04x  %-20llu  %6.2f%%  %s\n",
+			Fields[Index].Offset,
+			Heatmap.FieldCounts[Index],
+			100.0 * static_cast<double>(Heatmap.FieldCounts[Index]) / TotalCount,
+			Fields[Index].Path.c_str()
+			);
+	}
+
+	OutputFile << " */" << std::endl;
+}
+
+void
+PDBExtractor::PrintStructureDiff()
+{
+	std::unique_ptr<MemoryImage> OldImage = OpenMemoryImage(m_Settings.ImageFilenames[0]);
+	std::unique_ptr<MemoryImage> NewImage = OpenMemoryImage(m_Settings.ImageFilenames[1]);
+
+	PDBObjectList ObjectList(&m_PDB);
+	LoadObjectList(ObjectList, { OldImage.get(), NewImage.get() });
+
+	PDBStructureDiff StructureDiff(OldImage.get(), NewImage.get(), &m_Settings.PdbStructureDiffSettings);
+	StructureDiff.Compare(ObjectList.GetObjects());
+
+	PrintPDBHeader();
+
+	std::ostream& OutputFile = *m_Settings.PdbHeaderReconstructorSettings.OutputFile;
+
+	OutputFile << FormatString(
+		"/*\n"
+		" * Structure diff (%u-byte cache lines)\n"
+		" *\n"
+		" *   compared objects:   %llu\n"
+		" *   changed objects:    %llu\n"
+		" *   unreadable objects: %llu\n"
+		" */\n\n",
+		m_Settings.PdbStructureDiffSettings.CacheLineSize,
+		StructureDiff.GetComparedCount(),
+		StructureDiff.GetChangedCount(),
+		StructureDiff.GetUnreadableCount()
+		);
+
+	for (auto&& Diff : StructureDiff.GetDiffs())
+	{
+		OutputFile << FormatString(
+			"/*\n"
+			" * %s %s @ 0x%llx%s\n",
+			PDB::GetUdtKindString(Diff.Type->u.Udt.Kind),
+			m_HeaderReconstructor->GetCorrectedSymbolName(Diff.Type).c_str(),
+			Diff.Address,
+			Diff.Readable ? "" : " is not readable"
+			);
+
+		if (!Diff.Changes.empty())
+		{
+			OutputFile << " *\n";
+		}
+
+		auto& Fields = StructureDiff.GetLayout(Diff.Type).GetFields();
+
+		for (auto&& Change : Diff.Changes)
+		{
+			const PDBFieldLayout::Field& ChangedField = Fields[Change.FieldIndex];
+
+			if (ChangedField.Size <= sizeof(ULONGLONG))
+			{
+				OutputFile << FormatString(
+					" *   0x%04x  %-40s  0x%llx -> 0x%llx\n",
+					ChangedField.Offset,
+					ChangedField.Path.c_str(),
+					Change.OldValue,
+					Change.NewValue
+					);
+			}
+			else
+			{
+				OutputFile << FormatString(
+					" *   0x%04x  %-40s  (%u bytes)\n",
+					ChangedField.Offset,
+					ChangedField.Path.c_str(),
+					ChangedField.Size
+					);
+			}
+		}
+
+		OutputFile << " */\n\n";
+	}
+}
+
+std::unique_ptr<MemoryImage>
+PDBExtractor::OpenMemoryImage(
+	const char* ImageName
+	)
+{
+	//
+	// "pid:<id>" is the memory of the live process.
+	//
+
+	if (strncmp(ImageName, "pid:", 4) == 0)
+	{
+		auto Image = std::make_unique<ProcessMemoryImage>(&m_Settings.ProcessMemoryImageSettings);
+
+		if (!Image->Open(static_cast<DWORD>(strtoul(ImageName + 4, nullptr, 0))))
+		{
+			throw PDBDumperException(MESSAGE_CANNOT_OPEN_PROCESS);
+		}
+
+		return std::move(Image);
+	}
+
+	//
+	// Crash dumps are addressed by virtual addresses.
+	//
+
+	if (CrashDumpMemoryImage::IsCrashDump(ImageName))
+	{
+		auto Image = std::make_unique<CrashDumpMemoryImage>();
+
+		if (!Image->Open(ImageName))
+		{
+			throw PDBDumperException(MESSAGE_UNSUPPORTED_CRASH_DUMP);
+		}
+
+		return std::move(Image);
+	}
+
+	auto Image = std::make_unique<MappedMemoryImage>();
+
+	if (!Image->Open(ImageName, m_Settings.ImageBaseAddress))
+	{
+		throw PDBDumperException(MESSAGE_CANNOT_OPEN_IMAGE);
+	}
+
+	return std::move(Image);
+}
+
+void
+PDBExtractor::LoadObjectList(
+	PDBObjectList& ObjectList,
+	const std::vector<MemoryImage*>& Images
+	)
+{
+	if (m_Settings.ObjectsFilename && !ObjectList.LoadBindings(m_Settings.ObjectsFilename))
+	{
+		throw PDBDumperException(MESSAGE_OBJECTS_NOT_FOUND);
+	}
+
+	if (m_Settings.WalkSpecification)
+	{
+		const SYMBOL* Symbol = PDBFieldLayout::GetUnderlyingType(m_PDB.GetSymbolByName(m_Settings.SymbolName.c_str()));
+
+		if (Symbol == nullptr || Symbol->Tag != SymTagUDT)
+		{
+			throw PDBDumperException(MESSAGE_SYMBOL_NOT_FOUND);
+		}
+
+		std::string WalkSpecification = m_Settings.WalkSpecification;
+		size_t Separator = WalkSpecification.find(':');
+
+		std::string HeadName = WalkSpecification.substr(0, Separator);
+		std::string LinkPath = WalkSpecification.substr(Separator + 1);
+
+		//
+		// Objects inserted or removed between snapshots
+		// are linked only in some of the images.
+		//
+
+		for (auto&& Image : Images)
+		{
+			//
+			// Crash dumps know the well-known list heads.
+			//
+
+			ULONGLONG Head;
+
+			if (!Image->FindSymbol(HeadName, Head))
+			{
+				Head = _strtoui64(HeadName.c_str(), nullptr, 16);
+			}
+
+			if (!ObjectList.WalkList(Image, Head, Symbol, LinkPath, GetPointerSize()))
+			{
+				throw PDBDumperException(MESSAGE_LINK_NOT_FOUND);
+			}
+		}
+	}
+
+	if (ObjectList.GetUnknownBindingCount() != 0)
+	{
+		std::cerr << "Warning: " << ObjectList.GetUnknownBindingCount()
+		          << " objects refer to unknown types" << std::endl;
+	}
+
+	ObjectList.Sort();
+}
+
+void
+PDBExtractor::PrintQuery()
+{
+	std::unique_ptr<MemoryImage> Image = OpenMemoryImage(m_Settings.ImageFilenames[0]);
+
+	const SYMBOL* Symbol = PDBFieldLayout::GetUnderlyingType(m_PDB.GetSymbolByName(m_Settings.SymbolName.c_str()));
+
+	if (Symbol == nullptr || Symbol->Tag != SymTagUDT)
+	{
+		throw PDBDumperException(MESSAGE_SYMBOL_NOT_FOUND);
+	}
+
+	PDBObjectQuery ObjectQuery(Symbol, &m_Settings.PdbObjectQuerySettings);
+	std::string Error;
+
+	if (!ObjectQuery.Compile(
+		m_Settings.QueryExpression,
+		m_Settings.SelectFields ? m_Settings.SelectFields : "",
+		Error))
+	{
+		std::cerr << "Query: " << Error << std::endl;
+		throw PDBDumperException(MESSAGE_INVALID_QUERY);
+	}
+
+	PDBObjectList ObjectList(&m_PDB);
+	LoadObjectList(ObjectList, { Image.get() });
+
+	//
+	// Candidates of other types are ignored.
+	//
+
+	std::vector<ULONGLONG> Addresses;
+
+	for (auto&& CurrentObject : ObjectList.GetObjects())
+	{
+		if (CurrentObject.Type == Symbol)
+		{
+			Addresses.push_back(CurrentObject.Address);
+		}
+	}
+
+	ObjectQuery.Execute(Image.get(), Addresses);
+
+	PrintPDBHeader();
+
+	std::ostream& OutputFile = *m_Settings.PdbHeaderReconstructorSettings.OutputFile;
+
+	OutputFile << FormatString(
+		"/*\n"
+		" * Query of %s %s\n"
+		" *\n"
+		" *   candidates: %llu\n"
+		" *   matches:    %llu\n"
+		" *   unreadable: %llu\n"
+		" */\n\n",
+		PDB::GetUdtKindString(Symbol->u.Udt.Kind),
+		m_HeaderReconstructor->GetCorrectedSymbolName(Symbol).c_str(),
+		static_cast<ULONGLONG>(Addresses.size()),
+		static_cast<ULONGLONG>(ObjectQuery.GetMatches().size()),
+		ObjectQuery.GetUnreadableCount()
+		);
+
+	auto& Fields = ObjectQuery.GetLayout().GetFields();
+
+	for (auto&& CurrentMatch : ObjectQuery.GetMatches())
+	{
+		OutputFile << FormatString("0x%llx", CurrentMatch.Address);
+
+		for (auto&& CurrentProjection : ObjectQuery.GetProjections())
+		{
+			const PDBFieldLayout::Field& ProjectedField = Fields[CurrentProjection.FieldIndex];
+			const BYTE* FieldData = CurrentMatch.Values.data() + CurrentProjection.ValueOffset;
+
+			OutputFile << "  " << ProjectedField.Path << "=";
+
+			//
+			// Arrays of characters are printed as strings.
+			//
+
+			if (ProjectedField.Type->Tag == SymTagArrayType &&
+			    ProjectedField.Type->u.Array.ElementType->Tag == SymTagBaseType &&
+			    ProjectedField.Type->u.Array.ElementType->Size == 1)
+			{
+				const char* String = reinterpret_cast<const char*>(FieldData);
+
+				OutputFile << '"';
+
+				for (DWORD Index = 0; Index < ProjectedField.Size && String[Index] != '\0'; Index++)
+				{
+					OutputFile << (isprint(static_cast<unsigned char>(String[Index])) ? String[Index] : '?');
+				}
+
+				OutputFile << '"';
+			}
+			else if (ProjectedField.Size <= sizeof(ULONGLONG))
+			{
+				OutputFile << FormatString("0x%llx", PDBObjectQuery::GetFieldValue(ProjectedField, FieldData));
+			}
+			else
+			{
+				OutputFile << FormatString("(%u bytes)", ProjectedField.Size);
+			}
+		}
+
+		OutputFile << std::endl;
+	}
+}
+
+void
+PDBExtractor::PrintObjectGraph()
+{
+	std::unique_ptr<MemoryImage> Image = OpenMemoryImage(m_Settings.ImageFilenames[0]);
+
+	PDBObjectList ObjectList(&m_PDB);
+
+	if (m_Settings.ObjectsFilename && !ObjectList.LoadBindings(m_Settings.ObjectsFilename))
+	{
+		throw PDBDumperException(MESSAGE_OBJECTS_NOT_FOUND);
+	}
+
+	if (!m_Settings.RootAddresses.empty())
+	{
+		const SYMBOL* Symbol = PDBFieldLayout::GetUnderlyingType(m_PDB.GetSymbolByName(m_Settings.SymbolName.c_str()));
+
+		if (Symbol == nullptr || Symbol->Tag != SymTagUDT)
+		{
+			throw PDBDumperException(MESSAGE_SYMBOL_NOT_FOUND);
+		}
+
+		for (auto&& RootAddress : m_Settings.RootAddresses)
+		{
+			ObjectList.AddObject(RootAddress, Symbol);
+		}
+	}
+
+	if (ObjectList.GetUnknownBindingCount() != 0)
+	{
+		std::cerr << "Warning: " << ObjectList.GetUnknownBindingCount()
+		          << " objects refer to unknown types" << std::endl;
+	}
+
+	m_Settings.PdbObjectGraphSettings.PointerSize = GetPointerSize();
+
+	PDBObjectGraph ObjectGraph(Image.get(), &m_Settings.PdbObjectGraphSettings);
+
+	for (auto&& Root : ObjectList.GetObjects())
+	{
+		if (!ObjectGraph.AddRoot(Root.Address, Root.Type))
+		{
+			std::cerr << "Warning: root 0x" << std::hex << Root.Address << std::dec
+			          << " is not readable" << std::endl;
+		}
+	}
+
+	ObjectGraph.Crawl();
+
+	PrintPDBHeader();
+
+	std::ostream& OutputFile = *m_Settings.PdbHeaderReconstructorSettings.OutputFile;
+
+	OutputFile << FormatString(
+		"/*\n"
+		" * Object graph (maximum depth %u)\n"
+		" *\n"
+		" *   objects:  %llu%s\n"
+		" *   pointers: %llu\n"
+		" */\n\n",
+		m_Settings.PdbObjectGraphSettings.MaximumDepth,
+		static_cast<ULONGLONG>(ObjectGraph.GetNodes().size()),
+		ObjectGraph.IsTruncated() ? " (truncated)" : "",
+		static_cast<ULONGLONG>(ObjectGraph.GetEdges().size())
+		);
+
+	auto& Nodes = ObjectGraph.GetNodes();
+	auto& Edges = ObjectGraph.GetEdges();
+
+	//
+	// Edges are sorted by their source objects.
+	//
+
+	std::vector<DWORD> SortedEdges(Edges.size());
+
+	for (DWORD Index = 0; Index < Edges.size(); Index++)
+	{
+		SortedEdges[Index] = Index;
+	}
+
+	std::stable_sort(SortedEdges.begin(), SortedEdges.end(), [&Edges](DWORD Lhs, DWORD Rhs) {
+		return Edges[Lhs].From < Edges[Rhs].From;
+	});
+
+	if (m_Settings.PrintDot)
+	{
+		OutputFile << "digraph pdbex {\n";
+		OutputFile << "\tnode [shape=box, fontname=\"monospace\"];\n\n";
+
+		for (DWORD Index = 0; Index < Nodes.size(); Index++)
+		{
+			OutputFile << FormatString(
+				"\tn%u [label=\"%s\\n0x%llx\"];\n",
+				Index,
+				m_HeaderReconstructor->GetCorrectedSymbolName(Nodes[Index].Type).c_str(),
+				Nodes[Index].Address
+				);
+		}
+
+		OutputFile << "\n";
+
+		for (auto&& EdgeIndex : SortedEdges)
+		{
+			const PDBObjectGraph::Edge& CurrentEdge = Edges[EdgeIndex];
+
+			OutputFile << FormatString(
+				"\tn%u -> n%u [label=\"%s\"];\n",
+				CurrentEdge.From,
+				CurrentEdge.To,
+				ObjectGraph.GetLayout(Nodes[CurrentEdge.From].Type).GetFields()[CurrentEdge.FieldIndex].Path.c_str()
+				);
+		}
+
+		OutputFile << "}\n";
+		return;
+	}
+
+	auto EdgeIterator = SortedEdges.begin();
+
+	for (DWORD Index = 0; Index < Nodes.size(); Index++)
+	{
+		OutputFile << FormatString(
+			"0x%llx  %s  (depth %u)\n",
+			Nodes[Index].Address,
+			m_HeaderReconstructor->GetCorrectedSymbolName(Nodes[Index].Type).c_str(),
+			Nodes[Index].Depth
+			);
+
+		for (; EdgeIterator != SortedEdges.end() && Edges[*EdgeIterator].From == Index; ++EdgeIterator)
+		{
+			const PDBObjectGraph::Edge& CurrentEdge = Edges[*EdgeIterator];
+			const PDBFieldLayout::Field& PointerField = ObjectGraph.GetLayout(Nodes[Index].Type).GetFields()[CurrentEdge.FieldIndex];
+
+			OutputFile << FormatString(
+				"    +0x%04x  %-40s  -> 0x%llx  %s\n",
+				PointerField.Offset,
+				PointerField.Path.c_str(),
+				Nodes[CurrentEdge.To].Address,
+				m_HeaderReconstructor->GetCorrectedSymbolName(Nodes[CurrentEdge.To].Type).c_str()
+				);
+		}
+	}
+}
+
+void
+PDBExtractor::PrintLines()
+{
+	PDBLineTable LineTable(&m_Settings.PdbLineTableSettings);
+
+	if (!LineTable.Build(&m_PDB))
+	{
+		throw PDBDumperException(MESSAGE_NO_LINE_INFORMATION);
+	}
+
+	std::vector<DWORD> Addresses;
+
+	if (!PDBLineTable::LoadAddresses(m_Settings.LinesFilename, Addresses))
+	{
+		throw PDBDumperException(MESSAGE_ADDRESSES_NOT_FOUND);
+	}
+
+	std::vector<PDBLineTable::Location> Locations;
+	LineTable.ResolveBatch(Addresses, Locations);
+
+	//
+	// Output is collected into larger pieces,
+	// the stream would be the bottleneck otherwise.
+	//
+
+	std::ostream& OutputFile = *m_Settings.PdbHeaderReconstructorSettings.OutputFile;
+	std::string Output;
+	char Line[32];
+
+	for (size_t Index = 0; Index < Addresses.size(); Index++)
+	{
+		const PDBLineTable::Location& CurrentLocation = Locations[Index];
+
+		sprintf_s(Line, "%08x ", Addresses[Index]);
+		Output += Line;
+
+		if (CurrentLocation.FileIndex == PDBLineTable::None)
+		{
+			Output += "?\n";
+		}
+		else
+		{
+			sprintf_s(Line, ":%u\n", CurrentLocation.LineNumber);
+			Output += LineTable.GetFileName(CurrentLocation.FileIndex);
+			Output += Line;
+		}
+
+		if (Output.size() >= 1024 * 1024)
+		{
+			OutputFile.write(Output.data(), Output.size());
+			Output.clear();
+		}
+	}
+
+	OutputFile.write(Output.data(), Output.size());
+}
+
+void
+PDBExtractor::PrintStacks()
+{
+	if (GetPointerSize() != 4)
+	{
+		throw PDBDumperException(MESSAGE_NO_FRAME_DATA);
+	}
+
+	PDBStackUnwinder StackUnwinder(&m_Settings.PdbStackUnwinderSettings);
+
+	if (!StackUnwinder.Build(&m_PDB, static_cast<DWORD>(m_Settings.ModuleBaseAddress)))
+	{
+		throw PDBDumperException(MESSAGE_NO_FRAME_DATA);
+	}
+
+	std::vector<PDBStackUnwinder::Context> Contexts;
+
+	if (!PDBStackUnwinder::LoadContexts(m_Settings.ContextsFilename, Contexts))
+	{
+		throw PDBDumperException(MESSAGE_CONTEXTS_NOT_FOUND);
+	}
+
+	std::unique_ptr<MemoryImage> Image = OpenMemoryImage(m_Settings.ImageFilenames[0]);
+
+	std::vector<std::vector<PDBStackUnwinder::Context>> Stacks;
+	StackUnwinder.UnwindBatch(Image.get(), Contexts, Stacks);
+
+	//
+	// Frames of the module are annotated by source lines, if there are any.
+	//
+
+	PDBLineTable LineTable(&m_Settings.PdbLineTableSettings);
+	bool HasLines = LineTable.Build(&m_PDB);
+
+	std::ostream& OutputFile = *m_Settings.PdbHeaderReconstructorSettings.OutputFile;
+	char Line[128];
+
+	for (size_t ThreadIndex = 0; ThreadIndex < Stacks.size(); ThreadIndex++)
+	{
+		sprintf_s(Line, "Thread %u\n", static_cast<DWORD>(ThreadIndex));
+		OutputFile << Line;
+
+		for (size_t FrameIndex = 0; FrameIndex < Stacks[ThreadIndex].size(); FrameIndex++)
+		{
+			const PDBStackUnwinder::Context& Frame = Stacks[ThreadIndex][FrameIndex];
+
+			sprintf_s(
+				Line,
+				"  %02u  eip %08x  esp %08x  ebp %08x",
+				static_cast<DWORD>(FrameIndex),
+				Frame.Eip,
+				Frame.Esp,
+				Frame.Ebp
+				);
+
+			OutputFile << Line;
+
+			PDBLineTable::Location FrameLocation = { PDBLineTable::None, 0, 0 };
+
+			if (HasLines && Frame.Eip >= m_Settings.ModuleBaseAddress)
+			{
+				FrameLocation = LineTable.Resolve(static_cast<DWORD>(Frame.Eip - m_Settings.ModuleBaseAddress));
+			}
+
+			if (FrameLocation.FileIndex != PDBLineTable::None)
+			{
+				OutputFile << "  " << LineTable.GetFileName(FrameLocation.FileIndex) << ":" << FrameLocation.LineNumber;
+			}
+
+			OutputFile << "\n";
+		}
+
+		OutputFile << "\n";
+	}
+}
+
+DWORD
+PDBExtractor::GetPointerSize()
+{
+	return m_PDB.GetMachineType() == IMAGE_FILE_MACHINE_AMD64 ||
+	       m_PDB.GetMachineType() == IMAGE_FILE_MACHINE_IA64
+		? 8
+		: 4;
+}
+
+void
+PDBExtractor::LoadPdbList(
+	std::vector<std::string>& PdbPaths
+	)
+{
+	std::ifstream PdbListFile(m_Settings.PdbListFilename);
+
+	if (!PdbListFile.is_open())
+	{
+		throw PDBDumperException(MESSAGE_PDB_LIST_NOT_FOUND);
+	}
+
+	std::string PdbPath;
+
+	while (std::getline(PdbListFile, PdbPath))
+	{
+		PdbPath.erase(0, PdbPath.find_first_not_of(" \t"));
+		PdbPath.erase(PdbPath.find_last_not_of(" \t\r") + 1);
+
+		if (!PdbPath.empty() && PdbPath[0] != '#')
+		{
+			PdbPaths.push_back(PdbPath);
+		}
+	}
+}
+
+void
+PDBExtractor::WriteOffsetPack()
+{
+	PDBOffsetPack OffsetPack;
+
+	if (!OffsetPack.LoadFields(m_Settings.OffsetPackFieldsFilename))
+	{
+		throw PDBDumperException(MESSAGE_FIELDS_NOT_FOUND);
+	}
+
+	std::vector<std::string> PdbPaths;
+	LoadPdbList(PdbPaths);
+
+	//
+	// PDB files which could not be added are reported,
+	// but they do not stop the rest of the list.
+	//
+
+	std::string Report;
+
+	for (auto&& PdbPath : PdbPaths)
+	{
+		PDB Pdb;
+		DWORD MissingFieldCount = 0;
+
+		if (!Pdb.Open(PdbPath.c_str()))
+		{
+			Report += " * " + PdbPath + ": cannot be opened\n";
+		}
+		else if (!OffsetPack.AddBuild(&Pdb, PdbPath.c_str(), MissingFieldCount))
+		{
+			Report += " * " + PdbPath + ": skipped (duplicate build)\n";
+		}
+		else if (MissingFieldCount != 0)
+		{
+			Report += " * " + PdbPath + ": " + std::to_string(MissingFieldCount) + " missing fields\n";
+		}
+	}
+
+	std::vector<BYTE> Pack;
+	OffsetPack.Serialize(Pack);
+
+	std::ofstream PackFile(m_Settings.OffsetPackFilename, std::ios::out | std::ios::binary);
+
+	if (!PackFile.is_open() ||
+	    !PackFile.write(reinterpret_cast<const char*>(Pack.data()), Pack.size()))
+	{
+		throw PDBDumperException(MESSAGE_CANNOT_CREATE_FILE);
+	}
+
+	//
+	// Indices of the fields are printed as an enum
+	// for the code which reads the pack.
+	//
+
+	std::ostream& OutputFile = *m_Settings.PdbHeaderReconstructorSettings.OutputFile;
+
+	OutputFile << "/*\n";
+	OutputFile << " * Offset pack: " << m_Settings.OffsetPackFilename << "\n";
+	OutputFile << " * Builds: " << OffsetPack.GetBuildCount()
+	           << ", types: " << OffsetPack.GetGroupCount()
+	           << ", layouts: " << OffsetPack.GetLayoutCount()
+	           << ", size: " << Pack.size() << " bytes\n";
+
+	if (!Report.empty())
+	{
+		OutputFile << " *\n" << Report;
+	}
+
+	OutputFile << " *\n";
+	OutputFile << " * Dumped by pdbex tool v" PDBEX_VERSION_STRING ", by wbenny\n";
+	OutputFile << " */\n\n";
+
+	OutputFile << "enum OFFSET_PACK_FIELD_INDEX\n";
+	OutputFile << "{\n";
+
+	const auto& Fields = OffsetPack.GetFields();
+
+	for (size_t Index = 0; Index < Fields.size(); Index++)
+	{
+		std::string Name = "OFFSET_PACK_" + Fields[Index].TypeName;
+
+		if (!Fields[Index].Path.empty())
+		{
+			Name += "_" + Fields[Index].Path;
+		}
+		else
+		{
+			Name += "_SIZE";
+		}
+
+		for (auto&& Character : Name)
+		{
+			if (!isalnum(static_cast<unsigned char>(Character)))
+			{
+				Character = '_';
+			}
+		}
+
+		OutputFile << "\t" << Name << " = " << Index << ",\n";
+	}
+
+	OutputFile << "};\n";
+}
+
+void
+PDBExtractor::MountHeaders()
+{
+	std::vector<std::string> PdbPaths;
+	LoadPdbList(PdbPaths);
+
+	//
+	// PDBs stay opened and sorted while the directory is mounted,
+	// only the headers are rendered on demand.
+	//
+
+	struct MountedModule
+	{
+		PDB Pdb;
+		PDBSymbolSorter SymbolSorter;
+		PDBModuleMap::Settings ModuleMapSettings;
+		std::unique_ptr<PDBModuleMap> ModuleMap;
+	};
+
+	std::vector<std::unique_ptr<MountedModule>> Modules;
+	std::set<std::string> ModuleDirectories;
+
+	HeaderFileSystem FileSystem;
+	std::string Report;
+
+	//
+	// Printing functions write into the OutputFile,
+	// point it to the rendered file.
+	//
+
+	auto RenderFile = [this](const std::function<void(std::ostream&)>& Print, std::string& Contents) {
+		std::ostringstream RenderedFile;
+		std::ostream* OutputFile = m_Settings.PdbHeaderReconstructorSettings.OutputFile;
+
+		m_Settings.PdbHeaderReconstructorSettings.OutputFile = &RenderedFile;
+		m_HeaderReconstructor->Clear();
+
+		try
+		{
+			Print(RenderedFile);
+		}
+		catch (...)
+		{
+			m_Settings.PdbHeaderReconstructorSettings.OutputFile = OutputFile;
+			throw;
+		}
+
+		m_Settings.PdbHeaderReconstructorSettings.OutputFile = OutputFile;
+		Contents = RenderedFile.str();
+	};
+
+	for (auto&& PdbPath : PdbPaths)
+	{
+		auto Module = std::make_unique<MountedModule>();
+
+		GUID Guid;
+		DWORD Age;
+
+		if (!Module->Pdb.Open(PdbPath.c_str()) || !Module->Pdb.GetSignature(Guid, Age))
+		{
+			Report += " * " + PdbPath + ": cannot be opened\n";
+			continue;
+		}
+
+		//
+		// Directories are named as in the symbol store,
+		// e.g. ntkrnlmp\3844DBB920174967BE7AA4A2C20430FA2.
+		//
+
+		std::string ModuleName = PdbPath.substr(PdbPath.find_last_of("\\/") + 1);
+		ModuleName = ModuleName.substr(0, ModuleName.find_last_of('.'));
+
+		std::string Directory = ModuleName + "\\" + GetSymbolStoreSignature(Guid, Age);
+		std::string DirectoryKey = Directory;
+
+		std::transform(DirectoryKey.begin(), DirectoryKey.end(), DirectoryKey.begin(), ::tolower);
+
+		if (!ModuleDirectories.insert(DirectoryKey).second)
+		{
+			Report += " * " + PdbPath + ": skipped (duplicate build)\n";
+			continue;
+		}
+
+		for (auto&& e : Module->Pdb.GetSymbolMap())
+		{
+			Module->SymbolSorter.Visit(e.second);
+		}
+
+		Module->ModuleMapSettings.ModuleName = PDBModuleMap::GetModuleName(ModuleName);
+		Module->ModuleMapSettings.ShardPerSymbol = true;
+		Module->ModuleMapSettings.InlineUnnamed =
+			m_Settings.PdbHeaderReconstructorSettings.MemberStructExpansion == PDBHeaderReconstructor::MemberStructExpansionType::InlineUnnamed;
+
+		Module->ModuleMap = std::make_unique<PDBModuleMap>(&Module->ModuleMapSettings);
+		Module->ModuleMap->Build(&Module->SymbolSorter);
+
+		MountedModule* CurrentModule = Module.get();
+
+		FileSystem.AddFile(Directory + "\\" + CurrentModule->ModuleMap->GetDeclarationsFileName(), [this, CurrentModule, RenderFile](std::string& Contents) {
+			RenderFile([this, CurrentModule](std::ostream& OutputFile) {
+				PrintPDBHeader(&CurrentModule->Pdb);
+				OutputFile << "#pragma once" << std::endl << std::endl;
+				PrintPDBDeclarations(&CurrentModule->SymbolSorter);
+			}, Contents);
+		});
+
+		for (auto&& Shard : CurrentModule->ModuleMap->GetShards())
+		{
+			const PDBModuleMap::Shard* CurrentShard = &Shard;
+
+			FileSystem.AddFile(Directory + "\\" + Shard.FileName, [this, CurrentModule, CurrentShard, RenderFile](std::string& Contents) {
+				RenderFile([this, CurrentModule, CurrentShard](std::ostream& OutputFile) {
+					PrintPDBHeader(&CurrentModule->Pdb);
+					CurrentModule->ModuleMap->WriteShardPrologue(OutputFile, *CurrentShard);
+
+					for (auto&& e : CurrentShard->Symbols)
+					{
+						m_SymbolVisitor->Visit(e);
+					}
+				}, Contents);
+			});
+		}
+
+		FileSystem.AddFile(Directory + "\\" + CurrentModule->ModuleMap->GetUmbrellaFileName(), [CurrentModule, RenderFile](std::string& Contents) {
+			RenderFile([CurrentModule](std::ostream& OutputFile) {
+				CurrentModule->ModuleMap->WriteUmbrellaHeader(OutputFile);
+			}, Contents);
+		});
+
+		FileSystem.AddFile(Directory + "\\module.modulemap", [CurrentModule, RenderFile](std::string& Contents) {
+			RenderFile([CurrentModule](std::ostream& OutputFile) {
+				CurrentModule->ModuleMap->WriteModuleMap(OutputFile);
+			}, Contents);
+		});
+
+		Report += " * " + PdbPath + ": " + Directory + " (" + std::to_string(CurrentModule->ModuleMap->GetShards().size()) + " types)\n";
+
+		Modules.push_back(std::move(Module));
+	}
+
+	if (!FileSystem.Mount(m_Settings.MountDirectory))
+	{
+		throw PDBDumperException(MESSAGE_CANNOT_MOUNT);
+	}
+
+	std::ostream& OutputFile = *m_Settings.PdbHeaderReconstructorSettings.OutputFile;
+
+	OutputFile << "Mounted " << Modules.size() << " PDB files into " << m_Settings.MountDirectory << ":" << std::endl;
+	OutputFile << Report << std::endl;
+
+	printf("Press Enter to unmount.\n");
+	getchar();
+
+	FileSystem.Unmount();
+}
+
+void
+PDBExtractor::PrintSymbols()
+{
+	std::ifstream ModuleListFile(m_Settings.ModuleListFilename);
+
+	if (!ModuleListFile.is_open())
+	{
+		throw PDBDumperException(MESSAGE_MODULE_LIST_NOT_FOUND);
+	}
+
+	PDBSymbolSession SymbolSession(&m_Settings.PdbSymbolSessionSettings);
+
+	//
+	// Modules which could not be added are reported as comments,
+	// their addresses stay unresolved.
+	//
+
+	std::ostream& OutputFile = *m_Settings.PdbHeaderReconstructorSettings.OutputFile;
+	std::string Line;
+
+	while (std::getline(ModuleListFile, Line))
+	{
+		std::istringstream LineStream(Line);
+		ULONGLONG BaseAddress;
+		ULONGLONG Size;
+		std::string PdbPath;
+
+		if (!(LineStream >> std::hex >> BaseAddress >> Size) || !std::getline(LineStream >> std::ws, PdbPath))
+		{
+			continue;
+		}
+
+		PdbPath.erase(PdbPath.find_last_not_of(" \t\r") + 1);
+
+		//
+		// Module is named after its PDB (ntkrnlmp.pdb -> ntkrnlmp).
+		//
+
+		std::string ModuleName = PdbPath.substr(PdbPath.find_last_of("\\/") + 1);
+		ModuleName = ModuleName.substr(0, ModuleName.find_last_of('.'));
+
+		if (!SymbolSession.AddModule(ModuleName.c_str(), BaseAddress, Size, PdbPath.c_str()))
+		{
+			OutputFile << "# " << PdbPath << ": cannot be added\n";
+		}
+	}
+
+	std::vector<ULONGLONG> Addresses;
+
+	if (!PDBLineTable::LoadAddresses(m_Settings.SymbolizeFilename, Addresses))
+	{
+		throw PDBDumperException(MESSAGE_ADDRESSES_NOT_FOUND);
+	}
+
+	std::vector<PDBSymbolSession::Symbol> Symbols;
+	SymbolSession.ResolveBatch(Addresses, Symbols);
+
+	//
+	// Output is collected into larger pieces,
+	// the stream would be the bottleneck otherwise.
+	//
+
+	std::string Output;
+	char Number[32];
+
+	for (size_t Index = 0; Index < Addresses.size(); Index++)
+	{
+		const PDBSymbolSession::Symbol& CurrentSymbol = Symbols[Index];
+
+		sprintf_s(Number, "%016llx ", Addresses[Index]);
+		Output += Number;
+
+		if (CurrentSymbol.ModuleIndex == PDBSymbolSession::None)
+		{
+			Output += "?\n";
+		}
+		else
+		{
+			Output += SymbolSession.GetModuleName(CurrentSymbol.ModuleIndex);
+
+			if (CurrentSymbol.SymbolIndex != PDBSymbolSession::None)
+			{
+				Output += '!';
+				Output += SymbolSession.GetSymbolName(CurrentSymbol.ModuleIndex, CurrentSymbol.SymbolIndex);
+			}
+
+			sprintf_s(Number, "+0x%llx\n", CurrentSymbol.Displacement);
+			Output += Number;
+		}
+
+		if (Output.size() >= 1024 * 1024)
+		{
+			OutputFile.write(Output.data(), Output.size());
+			Output.clear();
+		}
+	}
+
+	OutputFile.write(Output.data(), Output.size());
+}
+
+void
+PDBExtractor::PrintIdentities()
+{
+	std::vector<std::string> PdbPaths;
+	LoadPdbList(PdbPaths);
+
+	PDBIdentityScanner IdentityScanner(&m_Settings.PdbIdentityScannerSettings);
+
+	std::vector<PDBIdentityScanner::Identity> Identities;
+	PDBIdentityScanner::Statistics Stats = IdentityScanner.Scan(PdbPaths, Identities);
+
+	//
+	// Identities are formatted as the directories of the symbol store,
+	// PDB files which could not be read are reported as comments.
+	//
+
+	std::ostream& OutputFile = *m_Settings.PdbHeaderReconstructorSettings.OutputFile;
+	std::string Output;
+	size_t FailedCount = 0;
+
+	for (size_t Index = 0; Index < PdbPaths.size(); Index++)
+	{
+		const PDBIdentityScanner::Identity& CurrentIdentity = Identities[Index];
+
+		if (CurrentIdentity.Result != PDBIdentityScanner::Status::Ok)
+		{
+			Output += "# " + PdbPaths[Index] + ": " + PDBIdentityScanner::GetStatusString(CurrentIdentity.Result) + "\n";
+			FailedCount++;
+			continue;
+		}
+
+		Output += GetSymbolStoreSignature(CurrentIdentity.Guid, CurrentIdentity.Age);
+		Output += ' ';
+		Output += PdbPaths[Index];
+		Output += '\n';
+
+		if (Output.size() >= 1024 * 1024)
+		{
+			OutputFile.write(Output.data(), Output.size());
+			Output.clear();
+		}
+	}
+
+	OutputFile.write(Output.data(), Output.size());
+
+	char Summary[256];
+	sprintf_s(
+		Summary, "# %zu files (%zu failed), %zu reads, %.0f files/s (%s)\n",
+		Stats.FileCount, FailedCount, Stats.ReadCount,
+		Stats.Seconds > 0 ? Stats.FileCount / Stats.Seconds : 0.0,
+		Stats.UsedCompletionPort ? "completion port" : "blocking reads"
+		);
+
+	OutputFile << Summary;
+}
+
+void
+PDBExtractor::WriteTypeBrowser()
+{
+	std::vector<std::string> PdbPaths;
+	LoadPdbList(PdbPaths);
+
+	PDBTypeBrowser TypeBrowser(m_Settings.BrowseDirectory, &m_Settings.PdbTypeBrowserSettings);
+
+	//
+	// Identities are read without DIA first, builds which are
+	// already in the site (listed in the manifests) are not opened.
+	// Files which are not MSF (e.g. ELF files) are opened to get
+	// their signature.
+	//
+
+	PDBIdentityScanner IdentityScanner(&m_Settings.PdbIdentityScannerSettings);
+
+	std::vector<PDBIdentityScanner::Identity> Identities;
+	IdentityScanner.Scan(PdbPaths, Identities);
+
+	//
+	// PDBs are opened one at a time, the browser keeps
+	// only hashes of their types for the index pages.
+	// PDB files which could not be added are reported as comments.
+	//
+
+	std::ostream& OutputFile = *m_Settings.PdbHeaderReconstructorSettings.OutputFile;
+	std::set<std::string> Builds;
+
+	for (size_t Index = 0; Index < PdbPaths.size(); Index++)
+	{
+		const std::string& PdbPath = PdbPaths[Index];
+
+		std::string ModuleName = PdbPath.substr(PdbPath.find_last_of("\\/") + 1);
+		ModuleName = ModuleName.substr(0, ModuleName.find_last_of('.'));
+
+		std::transform(ModuleName.begin(), ModuleName.end(), ModuleName.begin(), ::tolower);
+
+		PDB Pdb;
+		GUID Guid;
+		DWORD Age;
+
+		if (Identities[Index].Result == PDBIdentityScanner::Status::Ok)
+		{
+			Guid = Identities[Index].Guid;
+			Age = Identities[Index].Age;
+		}
+		else if (!Pdb.Open(PdbPath.c_str()) || !Pdb.GetSignature(Guid, Age))
+		{
+			OutputFile << "# " << PdbPath << ": cannot be opened\n";
+			continue;
+		}
+
+		std::string Signature = GetSymbolStoreSignature(Guid, Age);
+
+		if (!Builds.insert(ModuleName + "\\" + Signature).second)
+		{
+			OutputFile << "# " << PdbPath << ": skipped (duplicate build)\n";
+			continue;
+		}
+
+		if (TypeBrowser.HasBuild(ModuleName, Signature))
+		{
+			continue;
+		}
+
+		if (!Pdb.IsOpened() && !Pdb.Open(PdbPath.c_str()))
+		{
+			OutputFile << "# " << PdbPath << ": cannot be opened\n";
+			continue;
+		}
+
+		PDBSymbolSorter SymbolSorter;
+
+		for (auto&& e : Pdb.GetSymbolMap())
+		{
+			SymbolSorter.Visit(e.second);
+		}
+
+		if (!TypeBrowser.AddBuild(ModuleName, Signature, PdbPath, &SymbolSorter))
+		{
+			throw PDBDumperException(MESSAGE_CANNOT_CREATE_FILE);
+		}
+	}
+
+	if (!TypeBrowser.WriteIndex())
+	{
+		throw PDBDumperException(MESSAGE_CANNOT_CREATE_FILE);
+	}
+
+	const PDBTypeBrowser::Statistics& Stats = TypeBrowser.GetStatistics();
+
+	if (Stats.IgnoredManifestCount != 0)
+	{
+		OutputFile << "# " << Stats.IgnoredManifestCount << " manifests not valid or of another version, "
+		           << "their builds must be listed again\n";
+	}
+
+	OutputFile << "# " << Stats.BuildCount << " builds added ("
+	           << Stats.KeptBuildCount << " kept), "
+	           << Stats.TypeCount << " types, "
+	           << Stats.PageCount << " type pages ("
+	           << Stats.WrittenPageCount << " written)\n";
+}
+
+void
+PDBExtractor::DecompressFile()
+{
+	std::ifstream InputFile(m_Settings.CatFilename, std::ios::in | std::ios::binary);
+
+	if (!InputFile.is_open())
+	{
+		throw PDBDumperException(MESSAGE_FILE_NOT_FOUND);
+	}
+
+	if (!GzipDecompress(InputFile, *m_Settings.PdbHeaderReconstructorSettings.OutputFile))
+	{
+		throw PDBDumperException(MESSAGE_CORRUPTED_FILE);
 	}
 }
 
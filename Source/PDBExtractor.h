@@ -1,11 +1,32 @@
 #pragma once
 #include "PDBSymbolSorter.h"
 #include "PDBHeaderReconstructor.h"
+#include "CrashDumpMemoryImage.h"
+#include "HeaderFileSystem.h"
+#include "GzipStream.h"
+#include "PDBEnumTableGenerator.h"
+#include "PDBFieldHeatmap.h"
+#include "PDBIdentityScanner.h"
+#include "PDBLayoutOptimizer.h"
+#include "PDBLineTable.h"
+#include "PDBModuleMap.h"
+#include "PDBObjectGraph.h"
+#include "PDBObjectList.h"
+#include "PDBObjectQuery.h"
+#include "PDBOffsetPack.h"
+#include "PDBReflectionGenerator.h"
+#include "PDBSourceScanner.h"
+#include "PDBStackUnwinder.h"
+#include "PDBStructureDiff.h"
+#include "PDBSymbolSession.h"
+#include "PDBTypeBrowser.h"
 #include "PDBSymbolVisitor.h"
+#include "ProcessMemoryImage.h"
 #include "UdtFieldDefinition.h"
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #define PDBEX_VERSION_MAJOR 0
 #define PDBEX_VERSION_MINOR 1
@@ -19,10 +40,31 @@ class PDBExtractor
 		{
 			PDBHeaderReconstructor::Settings PdbHeaderReconstructorSettings;
 			UdtFieldDefinition::Settings UdtFieldDefinitionSettings;
+			PDBLayoutOptimizer::Settings PdbLayoutOptimizerSettings;
+			PDBFieldHeatmap::Settings PdbFieldHeatmapSettings;
+			PDBModuleMap::Settings PdbModuleMapSettings;
+			GzipStreamBuffer::Settings GzipStreamSettings;
+			PDBEnumTableGenerator::Settings PdbEnumTableGeneratorSettings;
+			PDBReflectionGenerator::Settings PdbReflectionGeneratorSettings;
+			PDBStructureDiff::Settings PdbStructureDiffSettings;
+			PDBObjectGraph::Settings PdbObjectGraphSettings;
+			PDBObjectQuery::Settings PdbObjectQuerySettings;
+			ProcessMemoryImage::Settings ProcessMemoryImageSettings;
+			PDBLineTable::Settings PdbLineTableSettings;
+			PDBStackUnwinder::Settings PdbStackUnwinderSettings;
+			PDBSourceScanner::Settings PdbSourceScannerSettings;
+			PDBSymbolSession::Settings PdbSymbolSessionSettings;
+			PDBIdentityScanner::Settings PdbIdentityScannerSettings;
+			PDBTypeBrowser::Settings PdbTypeBrowserSettings;
 
 			std::string SymbolName;
 			std::string PdbPath;
 
+			//
+			// Count of threads decoding the DWARF of ELF files.
+			//
+			DWORD DwarfThreadCount = 0;
+
 			const char* OutputFilename = nullptr;
 			const char* TestFilename = nullptr;
 
@@ -30,6 +72,57 @@ class PDBExtractor
 			bool PrintHeader = true;
 			bool PrintDeclarations = true;
 			bool PrintDefinitions = true;
+
+			bool SpecializeEmitter = true;
+
+			bool PrintEnumTables = false;
+			bool PrintReflectionTables = false;
+
+			bool OptimizeLayout = false;
+			DWORD OptimizeLayoutTop = 20;
+
+			const char* HeatmapTraceFilename = nullptr;
+			const char* HeatmapBindingsFilename = nullptr;
+
+			const char* ModulesDirectory = nullptr;
+			const char* ModuleName = nullptr;
+
+			std::vector<const char*> ScanPaths;
+
+			const char* CatFilename = nullptr;
+
+			std::vector<const char*> ImageFilenames;
+			ULONGLONG ImageBaseAddress = 0;
+
+			bool Diff = false;
+			const char* ObjectsFilename = nullptr;
+			const char* WalkSpecification = nullptr;
+
+			bool Crawl = false;
+			std::vector<ULONGLONG> RootAddresses;
+			bool PrintDot = false;
+
+			const char* QueryExpression = nullptr;
+			const char* SelectFields = nullptr;
+
+			const char* LinesFilename = nullptr;
+
+			const char* ContextsFilename = nullptr;
+			ULONGLONG ModuleBaseAddress = 0;
+
+			const char* PdbListFilename = nullptr;
+
+			const char* OffsetPackFilename = nullptr;
+			const char* OffsetPackFieldsFilename = nullptr;
+
+			const char* MountDirectory = nullptr;
+
+			const char* SymbolizeFilename = nullptr;
+			const char* ModuleListFilename = nullptr;
+
+			bool PrintIdentities = false;
+
+			const char* BrowseDirectory = nullptr;
 		};
 
 		int Run(
@@ -47,6 +140,19 @@ class PDBExtractor
 			char** argv
 			);
 
+		void
+		ParseLongParameter(
+			const char* CurrentArgument,
+			const char* NextArgument,
+			int& ArgumentPointer
+			);
+
+		void
+		OpenOutputFile();
+
+		void
+		CreateSymbolVisitor();
+
 		void
 		OpenPDBFile();
 
@@ -57,20 +163,111 @@ class PDBExtractor
 		PrintTestFooter();
 
 		void
-		PrintPDBHeader();
+		PrintPDBHeader(
+			const PDB* Pdb = nullptr
+			);
 
 		void
-		PrintPDBDeclarations();
+		PrintPDBDeclarations(
+			PDBSymbolSorter* SymbolSorter = nullptr
+			);
 
 		void
 		PrintPDBDefinitions();
 
+		void
+		PrintEnumTables(
+			const SYMBOL* Symbol = nullptr
+			);
+
+		void
+		PrintReflectionTables(
+			const SYMBOL* Symbol = nullptr
+			);
+
+		void
+		VisitAllSymbols();
+
+		void
+		VisitScannedSymbols();
+
 		void
 		DumpAllSymbols();
 
 		void
 		DumpOneSymbol();
 
+		void
+		DumpModules();
+
+		void
+		OptimizeLayout();
+
+		void
+		PrintOptimizedLayout(
+			const PDBLayoutOptimizer::Result& OptimizeResult
+			);
+
+		void
+		PrintFieldHeatmap();
+
+		void
+		PrintTypeHeatmap(
+			const PDBFieldHeatmap::TypeHeatmap& Heatmap
+			);
+
+		void
+		PrintStructureDiff();
+
+		std::unique_ptr<MemoryImage>
+		OpenMemoryImage(
+			const char* ImageName
+			);
+
+		void
+		LoadObjectList(
+			PDBObjectList& ObjectList,
+			const std::vector<MemoryImage*>& Images
+			);
+
+		void
+		PrintQuery();
+
+		void
+		PrintObjectGraph();
+
+		void
+		PrintLines();
+
+		void
+		PrintStacks();
+
+		void
+		LoadPdbList(
+			std::vector<std::string>& PdbPaths
+			);
+
+		void
+		WriteOffsetPack();
+
+		void
+		MountHeaders();
+
+		void
+		PrintSymbols();
+
+		void
+		PrintIdentities();
+
+		void
+		WriteTypeBrowser();
+
+		DWORD
+		GetPointerSize();
+
+		void
+		DecompressFile();
+
 		void
 		CloseOpenedFiles();
 
@@ -80,6 +277,6 @@ class PDBExtractor
 
 		std::unique_ptr<PDBSymbolSorter> m_SymbolSorter;
 		std::unique_ptr<PDBHeaderReconstructor> m_HeaderReconstructor;
-		std::unique_ptr<PDBSymbolVisitor<UdtFieldDefinition>> m_SymbolVisitor;
+		std::unique_ptr<PDBSymbolVisitorBase> m_SymbolVisitor;
 };
 
@@ -0,0 +1,459 @@
+#include "PDBFieldHeatmap.h"
+#include "WorkerThreads.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	//
+	// Size of the part of the trace file which is read at once
+	// and split between worker threads.
+	//
+	static const size_t TRACE_CHUNK_SIZE = 64 * 1024 * 1024;
+
+	static PDBFieldHeatmap::Settings DefaultSettings;
+
+	inline
+	bool
+	IsSpace(
+		char Character
+		)
+	{
+		return Character == ' ' || Character == '\t' || Character == '\r';
+	}
+
+	inline
+	int
+	HexDigitValue(
+		char Character
+		)
+	{
+		if (Character >= '0' && Character <= '9') return Character - '0';
+		if (Character >= 'a' && Character <= 'f') return Character - 'a' + 10;
+		if (Character >= 'A' && Character <= 'F') return Character - 'A' + 10;
+		return -1;
+	}
+
+	//
+	// Parses hexadecimal number with optional "0x" prefix
+	// (and optional '`' separator used by WinDbg).
+	//
+	// Returns false if there is no number at the position.
+	//
+	inline
+	bool
+	ParseHexNumber(
+		const char*& Position,
+		const char* End,
+		ULONGLONG& Value
+		)
+	{
+		if (End - Position > 2 && Position[0] == '0' && (Position[1] == 'x' || Position[1] == 'X'))
+		{
+			Position += 2;
+		}
+
+		const char* Begin = Position;
+		Value = 0;
+
+		for (; Position < End; Position++)
+		{
+			if (*Position == '`')
+			{
+				continue;
+			}
+
+			int Digit = HexDigitValue(*Position);
+
+			if (Digit < 0)
+			{
+				break;
+			}
+
+			Value = (Value << 4) | static_cast<ULONGLONG>(Digit);
+		}
+
+		return Position != Begin;
+	}
+
+	inline
+	bool
+	ParseDecimalNumber(
+		const char*& Position,
+		const char* End,
+		ULONGLONG& Value
+		)
+	{
+		const char* Begin = Position;
+		Value = 0;
+
+		for (; Position < End && *Position >= '0' && *Position <= '9'; Position++)
+		{
+			Value = Value * 10 + static_cast<ULONGLONG>(*Position - '0');
+		}
+
+		return Position != Begin;
+	}
+}
+
+PDBFieldHeatmap::PDBFieldHeatmap(
+	PDB* Pdb,
+	Settings* HeatmapSettings
+	)
+{
+	m_PDB = Pdb;
+	m_Settings = HeatmapSettings ? HeatmapSettings : &DefaultSettings;
+}
+
+bool
+PDBFieldHeatmap::LoadBindings(
+	const char* Path
+	)
+{
+	std::ifstream BindingsFile(Path, std::ios::in);
+
+	if (!BindingsFile.is_open())
+	{
+		return false;
+	}
+
+	std::string Line;
+
+	while (std::getline(BindingsFile, Line))
+	{
+		const char* Position = Line.c_str();
+		const char* End = Position + Line.size();
+
+		while (Position < End && IsSpace(*Position))
+		{
+			Position++;
+		}
+
+		ULONGLONG Base;
+
+		if (Position == End || *Position == '#' || !ParseHexNumber(Position, End, Base))
+		{
+			continue;
+		}
+
+		std::string TypeName;
+		std::istringstream(std::string(Position, End)) >> TypeName;
+
+		const SYMBOL* Symbol = m_PDB->GetSymbolByName(TypeName.c_str());
+		Symbol = PDBFieldLayout::GetUnderlyingType(Symbol);
+
+		if (Symbol == nullptr || Symbol->Tag != SymTagUDT || Symbol->Size == 0)
+		{
+			m_UnknownBindingCount += 1;
+			continue;
+		}
+
+		Object NewObject;
+		NewObject.Base      = Base;
+		NewObject.End       = Base + Symbol->Size;
+		NewObject.TypeIndex = GetTypeIndex(Symbol);
+
+		m_Objects.push_back(NewObject);
+		m_TypeHeatmaps[NewObject.TypeIndex].ObjectCount += 1;
+	}
+
+	std::sort(m_Objects.begin(), m_Objects.end(), [](const Object& Lhs, const Object& Rhs) {
+		return Lhs.Base < Rhs.Base;
+	});
+
+	//
+	// Lay out the counters of all types.
+	//
+
+	m_CounterBases.clear();
+	m_CounterCount = 0;
+
+	for (auto&& Heatmap : m_TypeHeatmaps)
+	{
+		m_CounterBases.push_back(m_CounterCount);
+		m_CounterCount += Heatmap.FieldCounts.size() + Heatmap.CacheLineCounts.size() + 1;
+	}
+
+	return true;
+}
+
+bool
+PDBFieldHeatmap::ProcessTrace(
+	const char* Path
+	)
+{
+	std::ifstream TraceFile(Path, std::ios::in | std::ios::binary);
+
+	if (!TraceFile.is_open())
+	{
+		return false;
+	}
+
+	std::vector<char> Buffer(TRACE_CHUNK_SIZE);
+	size_t Carry = 0;
+
+	for (;;)
+	{
+		TraceFile.read(Buffer.data() + Carry, Buffer.size() - Carry);
+		size_t BufferSize = Carry + static_cast<size_t>(TraceFile.gcount());
+
+		if (BufferSize == 0)
+		{
+			break;
+		}
+
+		//
+		// Process only complete lines, the rest
+		// is moved to the beginning of the next chunk.
+		//
+
+		size_t Processed = BufferSize;
+
+		if (!TraceFile.eof())
+		{
+			while (Processed > 0 && Buffer[Processed - 1] != '\n')
+			{
+				Processed--;
+			}
+
+			if (Processed == 0)
+			{
+				//
+				// Line longer than the whole chunk, this is not a trace.
+				//
+
+				Processed = BufferSize;
+			}
+		}
+
+		ProcessBuffer(Buffer.data(), Buffer.data() + Processed);
+
+		Carry = BufferSize - Processed;
+		std::copy(Buffer.begin() + Processed, Buffer.begin() + BufferSize, Buffer.begin());
+
+		if (TraceFile.eof() && Carry == 0)
+		{
+			break;
+		}
+	}
+
+	//
+	// Propagate counts of leaves to their parents.
+	//
+
+	for (auto&& Heatmap : m_TypeHeatmaps)
+	{
+		auto& Fields = Heatmap.Layout->GetFields();
+
+		for (size_t Index = Fields.size(); Index-- > 0; )
+		{
+			if (Fields[Index].ParentIndex != PDBFieldLayout::None)
+			{
+				Heatmap.FieldCounts[Fields[Index].ParentIndex] += Heatmap.FieldCounts[Index];
+			}
+		}
+	}
+
+	return true;
+}
+
+void
+PDBFieldHeatmap::ProcessBuffer(
+	const char* Begin,
+	const char* End
+	)
+{
+	DWORD ThreadCount = WorkerThreads::GetCount(m_Settings->ThreadCount);
+
+	//
+	// Split the buffer on line boundaries, boundaries inside
+	// of a line are moved to the start of the next line.
+	//
+
+	auto AlignToLine = [Begin, End](const char* Boundary) {
+		while (Boundary > Begin && Boundary < End && Boundary[-1] != '\n')
+		{
+			Boundary++;
+		}
+
+		return Boundary;
+	};
+
+	std::vector<std::vector<ULONGLONG>> Counters(ThreadCount, std::vector<ULONGLONG>(m_CounterCount));
+	std::vector<ULONGLONG> UnboundCounts(ThreadCount);
+
+	WorkerThreads::RunRanges(End - Begin, ThreadCount, [&](DWORD ThreadIndex, size_t RangeBegin, size_t RangeEnd) {
+		ProcessChunk(AlignToLine(Begin + RangeBegin), AlignToLine(Begin + RangeEnd), Counters[ThreadIndex], UnboundCounts[ThreadIndex]);
+	});
+
+	//
+	// Merge counters of the workers.
+	//
+
+	for (DWORD i = 0; i < ThreadCount; i++)
+	{
+		m_UnboundCount += UnboundCounts[i];
+
+		for (DWORD TypeIndex = 0; TypeIndex < m_TypeHeatmaps.size(); TypeIndex++)
+		{
+			TypeHeatmap& Heatmap = m_TypeHeatmaps[TypeIndex];
+			const ULONGLONG* Counter = &Counters[i][m_CounterBases[TypeIndex]];
+
+			for (auto&& FieldCount : Heatmap.FieldCounts)
+			{
+				FieldCount += *Counter++;
+			}
+
+			for (auto&& CacheLineCount : Heatmap.CacheLineCounts)
+			{
+				Heatmap.TotalCount += *Counter;
+				CacheLineCount += *Counter++;
+			}
+
+			Heatmap.PaddingCount += *Counter;
+		}
+	}
+}
+
+void
+PDBFieldHeatmap::ProcessChunk(
+	const char* Begin,
+	const char* End,
+	std::vector<ULONGLONG>& Counters,
+	ULONGLONG& UnboundCount
+	) const
+{
+	const char* Position = Begin;
+
+	while (Position < End)
+	{
+		const char* LineEnd = std::find(Position, End, '\n');
+
+		while (Position < LineEnd && IsSpace(*Position))
+		{
+			Position++;
+		}
+
+		ULONGLONG Address;
+		ULONGLONG Count = 1;
+
+		if (Position < LineEnd && *Position != '#' && ParseHexNumber(Position, LineEnd, Address))
+		{
+			while (Position < LineEnd && IsSpace(*Position))
+			{
+				Position++;
+			}
+
+			ULONGLONG SampleCount;
+
+			if (ParseDecimalNumber(Position, LineEnd, SampleCount))
+			{
+				Count = SampleCount;
+			}
+
+			//
+			// Find the last object which starts at or before the address.
+			//
+
+			auto It = std::upper_bound(m_Objects.begin(), m_Objects.end(), Address, [](ULONGLONG Value, const Object& Rhs) {
+				return Value < Rhs.Base;
+			});
+
+			if (It != m_Objects.begin() && Address < (--It)->End)
+			{
+				const TypeHeatmap& Heatmap = m_TypeHeatmaps[It->TypeIndex];
+				ULONGLONG* Counter = &Counters[m_CounterBases[It->TypeIndex]];
+
+				DWORD Offset = static_cast<DWORD>(Address - It->Base);
+				DWORD FieldIndex = Heatmap.Layout->FindFieldIndexByOffset(Offset);
+
+				if (FieldIndex != PDBFieldLayout::None)
+				{
+					Counter[FieldIndex] += Count;
+				}
+				else
+				{
+					Counter[Heatmap.FieldCounts.size() + Heatmap.CacheLineCounts.size()] += Count;
+				}
+
+				Counter[Heatmap.FieldCounts.size() + Offset / m_Settings->CacheLineSize] += Count;
+			}
+			else
+			{
+				UnboundCount += Count;
+			}
+		}
+
+		Position = LineEnd + 1;
+	}
+}
+
+DWORD
+PDBFieldHeatmap::GetTypeIndex(
+	const SYMBOL* Symbol
+	)
+{
+	auto It = m_TypeIndices.find(Symbol);
+
+	if (It != m_TypeIndices.end())
+	{
+		return It->second;
+	}
+
+	DWORD TypeIndex = static_cast<DWORD>(m_TypeHeatmaps.size());
+	m_TypeIndices[Symbol] = TypeIndex;
+
+	m_TypeHeatmaps.emplace_back();
+
+	TypeHeatmap& Heatmap = m_TypeHeatmaps.back();
+	Heatmap.Symbol = Symbol;
+	Heatmap.Layout = std::make_unique<PDBFieldLayout>(Symbol);
+	Heatmap.FieldCounts.resize(Heatmap.Layout->GetFields().size());
+	Heatmap.CacheLineCounts.resize((Symbol->Size + m_Settings->CacheLineSize - 1) / m_Settings->CacheLineSize);
+
+	return TypeIndex;
+}
+
+void
+PDBFieldHeatmap::BuildFieldComments(
+	const TypeHeatmap& Heatmap,
+	std::map<const SYMBOL_UDT_FIELD*, std::string>& FieldComments
+	)
+{
+	//
+	// Elements of arrays (and fields of nested UDTs of the same type)
+	// share their SYMBOL_UDT_FIELD, therefore their counts are summed.
+	//
+
+	std::map<const SYMBOL_UDT_FIELD*, ULONGLONG> UdtFieldCounts;
+
+	auto& Fields = Heatmap.Layout->GetFields();
+
+	for (size_t Index = 0; Index < Fields.size(); Index++)
+	{
+		UdtFieldCounts[Fields[Index].UdtField] += Heatmap.FieldCounts[Index];
+	}
+
+	FieldComments.clear();
+
+	for (auto&& e : UdtFieldCounts)
+	{
+		if (e.second == 0)
+		{
+			continue;
+		}
+
+		char Comment[64];
+
+		sprintf_s(
+			Comment,
+			"heat: %5.2f%% (%llu)",
+			100.0 * static_cast<double>(e.second) / static_cast<double>(Heatmap.TotalCount),
+			e.second
+			);
+
+		FieldComments[e.first] = Comment;
+	}
+}
@@ -0,0 +1,184 @@
+#pragma once
+#include "PDB.h"
+#include "PDBFieldLayout.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+//
+// Attributes sampled data addresses to the fields of UDTs.
+//
+// Bindings file maps objects in the memory to their types,
+// one object per line (addresses are hexadecimal):
+//
+//   # base              type
+//   ffffa3014f2c6080    _EPROCESS
+//   ffffa3014f2c6580    _ETHREAD
+//
+// Trace file contains the sampled addresses, one per line,
+// optionally followed by the count of the samples (decimal):
+//
+//   ffffa3014f2c6528
+//   ffffa3014f2c6530    12
+//
+// Every address is resolved to the object which contains it
+// and then to the leaf field through the PDBFieldLayout of its type.
+// The trace is processed in chunks which are split between
+// worker threads, each of them aggregates into its own counters.
+//
+class PDBFieldHeatmap
+{
+	public:
+		struct Settings
+		{
+			//
+			// Size of the cache line in bytes.
+			// Cache lines are counted relative to the start of the object.
+			//
+			DWORD CacheLineSize = 64;
+
+			//
+			// Count of worker threads, 0 means count of CPUs.
+			//
+			DWORD ThreadCount = 0;
+		};
+
+		struct TypeHeatmap
+		{
+			const SYMBOL* Symbol = nullptr;
+			std::unique_ptr<PDBFieldLayout> Layout;
+
+			//
+			// Count of objects of this type in the bindings.
+			//
+			ULONGLONG ObjectCount = 0;
+
+			//
+			// Count of accesses of each field of the layout.
+			// Counts of non-leaf fields include counts of their children.
+			//
+			std::vector<ULONGLONG> FieldCounts;
+
+			//
+			// Count of accesses of each cache line of the object.
+			//
+			std::vector<ULONGLONG> CacheLineCounts;
+
+			//
+			// Count of accesses which hit padding.
+			//
+			ULONGLONG PaddingCount = 0;
+
+			ULONGLONG TotalCount = 0;
+		};
+
+		PDBFieldHeatmap(
+			PDB* Pdb,
+			Settings* HeatmapSettings = nullptr
+			);
+
+		//
+		// Loads object-to-type bindings.
+		//
+		// Returns false if the file cannot be opened.
+		//
+		bool
+		LoadBindings(
+			const char* Path
+			);
+
+		//
+		// Processes the trace file.
+		//
+		// Returns false if the file cannot be opened.
+		//
+		bool
+		ProcessTrace(
+			const char* Path
+			);
+
+		const std::vector<TypeHeatmap>&
+		GetTypeHeatmaps() const
+		{
+			return m_TypeHeatmaps;
+		}
+
+		//
+		// Count of bindings which refer to unknown types.
+		//
+		ULONGLONG
+		GetUnknownBindingCount() const
+		{
+			return m_UnknownBindingCount;
+		}
+
+		//
+		// Count of accesses which do not hit any bound object.
+		//
+		ULONGLONG
+		GetUnboundCount() const
+		{
+			return m_UnboundCount;
+		}
+
+		//
+		// Creates comments for PDBHeaderReconstructor::Settings::FieldComments.
+		//
+		static
+		void
+		BuildFieldComments(
+			const TypeHeatmap& Heatmap,
+			std::map<const SYMBOL_UDT_FIELD*, std::string>& FieldComments
+			);
+
+	private:
+		struct Object
+		{
+			ULONGLONG Base;
+			ULONGLONG End;
+			DWORD TypeIndex;
+		};
+
+		void
+		ProcessChunk(
+			const char* Begin,
+			const char* End,
+			std::vector<ULONGLONG>& Counters,
+			ULONGLONG& UnboundCount
+			) const;
+
+		void
+		ProcessBuffer(
+			const char* Begin,
+			const char* End
+			);
+
+		DWORD
+		GetTypeIndex(
+			const SYMBOL* Symbol
+			);
+
+	private:
+		PDB* m_PDB;
+		Settings* m_Settings;
+
+		std::vector<TypeHeatmap> m_TypeHeatmaps;
+		std::map<const SYMBOL*, DWORD> m_TypeIndices;
+
+		//
+		// Objects sorted by their base address.
+		//
+		std::vector<Object> m_Objects;
+
+		//
+		// Each type owns a continuous range of counters:
+		// one counter per field, one per cache line and one for padding.
+		//
+		std::vector<size_t> m_CounterBases;
+		size_t m_CounterCount = 0;
+
+		ULONGLONG m_UnknownBindingCount = 0;
+		ULONGLONG m_UnboundCount = 0;
+};
@@ -0,0 +1,195 @@
+#include "PDBFieldLayout.h"
+
+#include <algorithm>
+
+namespace
+{
+	//
+	// Arrays of UDTs with more elements than this limit
+	// are not expanded and they are treated as leaves.
+	//
+	static const DWORD MAXIMUM_EXPANDED_ARRAY_ELEMENTS = 16;
+}
+
+const DWORD PDBFieldLayout::None;
+
+PDBFieldLayout::PDBFieldLayout(
+	const SYMBOL* Symbol
+	)
+	: m_Symbol(Symbol)
+{
+	AddFields(Symbol, std::string(), 0, None);
+	BuildIntervalIndex();
+}
+
+DWORD
+PDBFieldLayout::FindFieldIndexByOffset(
+	DWORD Offset
+	) const
+{
+	auto It = std::upper_bound(m_IntervalStarts.begin(), m_IntervalStarts.end(), Offset);
+
+	if (It == m_IntervalStarts.begin())
+	{
+		return None;
+	}
+
+	return m_IntervalFields[It - m_IntervalStarts.begin() - 1];
+}
+
+DWORD
+PDBFieldLayout::FindFieldIndexByPath(
+	const std::string& Path
+	) const
+{
+	for (DWORD Index = 0; Index < m_Fields.size(); Index++)
+	{
+		if (m_Fields[Index].Path == Path)
+		{
+			return Index;
+		}
+	}
+
+	return None;
+}
+
+const SYMBOL*
+PDBFieldLayout::GetUnderlyingType(
+	const SYMBOL* Symbol
+	)
+{
+	while (Symbol != nullptr && Symbol->Tag == SymTagTypedef)
+	{
+		Symbol = Symbol->u.Typedef.Type;
+	}
+
+	return Symbol;
+}
+
+void
+PDBFieldLayout::AddFields(
+	const SYMBOL* Symbol,
+	const std::string& PathPrefix,
+	DWORD BaseOffset,
+	DWORD ParentIndex
+	)
+{
+	for (DWORD i = 0; i < Symbol->u.Udt.FieldCount; i++)
+	{
+		const SYMBOL_UDT_FIELD* UdtField = &Symbol->u.Udt.Fields[i];
+
+		if (UdtField->Name == nullptr || UdtField->Type == nullptr)
+		{
+			continue;
+		}
+
+		AddField(
+			UdtField,
+			GetUnderlyingType(UdtField->Type),
+			PathPrefix + UdtField->Name,
+			BaseOffset + UdtField->Offset,
+			ParentIndex
+			);
+	}
+}
+
+void
+PDBFieldLayout::AddField(
+	const SYMBOL_UDT_FIELD* UdtField,
+	const SYMBOL* Type,
+	const std::string& Path,
+	DWORD Offset,
+	DWORD ParentIndex
+	)
+{
+	DWORD Index = static_cast<DWORD>(m_Fields.size());
+
+	Field NewField;
+	NewField.Path        = Path;
+	NewField.UdtField    = UdtField;
+	NewField.Type        = Type;
+	NewField.ParentIndex = ParentIndex;
+	NewField.Offset      = Offset;
+	NewField.Size        = Type->Size;
+	NewField.Bits        = UdtField->Bits;
+	NewField.BitPosition = UdtField->BitPosition;
+	NewField.IsLeaf      = true;
+
+	m_Fields.push_back(NewField);
+
+	if (Type->Tag == SymTagUDT && Type->u.Udt.FieldCount > 0)
+	{
+		m_Fields[Index].IsLeaf = false;
+		AddFields(Type, Path + ".", Offset, Index);
+	}
+	else if (Type->Tag == SymTagArrayType)
+	{
+		const SYMBOL* ElementType = GetUnderlyingType(Type->u.Array.ElementType);
+
+		if (ElementType->Tag == SymTagUDT &&
+		    ElementType->u.Udt.FieldCount > 0 &&
+		    Type->u.Array.ElementCount > 0 &&
+		    Type->u.Array.ElementCount <= MAXIMUM_EXPANDED_ARRAY_ELEMENTS)
+		{
+			m_Fields[Index].IsLeaf = false;
+
+			for (DWORD Element = 0; Element < Type->u.Array.ElementCount; Element++)
+			{
+				AddField(
+					UdtField,
+					ElementType,
+					Path + "[" + std::to_string(Element) + "]",
+					Offset + Element * ElementType->Size,
+					Index
+					);
+			}
+		}
+	}
+}
+
+void
+PDBFieldLayout::BuildIntervalIndex()
+{
+	//
+	// Assign each byte of the UDT to the first leaf which covers it
+	// and then compress runs of bytes into intervals.
+	//
+
+	std::vector<DWORD> ByteMap(m_Symbol->Size, None);
+
+	for (DWORD Index = 0; Index < m_Fields.size(); Index++)
+	{
+		const Field& CurrentField = m_Fields[Index];
+
+		if (!CurrentField.IsLeaf)
+		{
+			continue;
+		}
+
+		DWORD End = (std::min)(CurrentField.Offset + CurrentField.Size, m_Symbol->Size);
+
+		for (DWORD Offset = CurrentField.Offset; Offset < End; Offset++)
+		{
+			if (ByteMap[Offset] == None)
+			{
+				ByteMap[Offset] = Index;
+			}
+		}
+	}
+
+	for (DWORD Offset = 0; Offset < ByteMap.size(); Offset++)
+	{
+		if (m_IntervalFields.empty() || m_IntervalFields.back() != ByteMap[Offset])
+		{
+			m_IntervalStarts.push_back(Offset);
+			m_IntervalFields.push_back(ByteMap[Offset]);
+		}
+	}
+
+	//
+	// Everything behind the end of the UDT is a hole.
+	//
+
+	m_IntervalStarts.push_back(m_Symbol->Size);
+	m_IntervalFields.push_back(None);
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include "PDB.h"
+
+#include <string>
+#include <vector>
+
+//
+// Flattened layout of the UDT.
+//
+// All fields of the UDT, including fields of nested UDTs
+// and elements of small arrays of UDTs, are listed in pre-order
+// with their offsets relative to the start of the root UDT:
+//
+//   Index  Parent  Offset  Size  Path
+//   ----------------------------------------------------
+//   0      -       0x0000  0x18  Header
+//   1      0       0x0000  0x01  Header.Type
+//   2      0       0x0001  0x01  Header.Signaled
+//   ...
+//   7      -       0x0018  0x10  ProfileListHead
+//   8      7       0x0018  0x08  ProfileListHead.Flink
+//   9      7       0x0020  0x08  ProfileListHead.Blink
+//
+// Fields which are not UDTs (or arrays of UDTs) are leaves.
+// Leaves are indexed by intervals of their offsets, so any offset
+// inside of the UDT can be resolved to the field in O(log n).
+//
+class PDBFieldLayout
+{
+	public:
+		static const DWORD None = (DWORD)-1;
+
+		struct Field
+		{
+			//
+			// Full path of the field, e.g. "Pcb.Header.Type" or "ApcState[1].Process".
+			//
+			std::string Path;
+
+			//
+			// The field in the (possibly nested) UDT.
+			// Elements of arrays share the UdtField of the array.
+			//
+			const SYMBOL_UDT_FIELD* UdtField;
+
+			//
+			// Type of the field (or type of the array element).
+			//
+			const SYMBOL* Type;
+
+			//
+			// Index of the parent field, or None for top-level fields.
+			//
+			DWORD ParentIndex;
+
+			//
+			// Offset relative to the start of the root UDT.
+			//
+			DWORD Offset;
+			DWORD Size;
+
+			DWORD Bits;
+			DWORD BitPosition;
+
+			bool IsLeaf;
+		};
+
+		PDBFieldLayout(
+			const SYMBOL* Symbol
+			);
+
+		const SYMBOL*
+		GetSymbol() const
+		{
+			return m_Symbol;
+		}
+
+		const std::vector<Field>&
+		GetFields() const
+		{
+			return m_Fields;
+		}
+
+		//
+		// Returns index of the leaf field which covers the provided offset.
+		// Overlapping fields (members of unions, bitfields) are resolved
+		// to the first one in the order of declaration.
+		//
+		// Returns None if the offset falls into padding
+		// or outside of the UDT.
+		//
+		DWORD
+		FindFieldIndexByOffset(
+			DWORD Offset
+			) const;
+
+		//
+		// Returns index of the field with the provided path.
+		//
+		// Returns None if there is no such field.
+		//
+		DWORD
+		FindFieldIndexByPath(
+			const std::string& Path
+			) const;
+
+		//
+		// Returns the underlying type with typedefs stripped.
+		//
+		static
+		const SYMBOL*
+		GetUnderlyingType(
+			const SYMBOL* Symbol
+			);
+
+	private:
+		void
+		AddFields(
+			const SYMBOL* Symbol,
+			const std::string& PathPrefix,
+			DWORD BaseOffset,
+			DWORD ParentIndex
+			);
+
+		void
+		AddField(
+			const SYMBOL_UDT_FIELD* UdtField,
+			const SYMBOL* Type,
+			const std::string& Path,
+			DWORD Offset,
+			DWORD ParentIndex
+			);
+
+		void
+		BuildIntervalIndex();
+
+	private:
+		const SYMBOL* m_Symbol;
+
+		std::vector<Field> m_Fields;
+
+		//
+		// Sorted starts of the intervals and indices of the leaves
+		// which cover them (or None for holes).
+		//
+		std::vector<DWORD> m_IntervalStarts;
+		std::vector<DWORD> m_IntervalFields;
+};
@@ -1,9 +1,11 @@
 #include "PDBHeaderReconstructor.h"
+#include "PDBSpecializedHeaderReconstructor.h"
 
 #pragma once
 #include "PDBReconstructorBase.h"
 
 #include <iostream>
+#include <algorithm>
 #include <numeric> // std::accumulate
 #include <string>
 #include <map>
@@ -25,10 +27,100 @@ PDBHeaderReconstructor::PDBHeaderReconstructor(
 	m_Settings = VisitorSettings;
 }
 
+namespace
+{
+	using MemberStructExpansionType = PDBHeaderReconstructor::MemberStructExpansionType;
+
+	template <
+		typename TRAITS
+	>
+	std::unique_ptr<PDBHeaderReconstructor>
+	CreateSpecialized(
+		PDBHeaderReconstructor::Settings* VisitorSettings
+		)
+	{
+		return std::make_unique<PDBSpecializedHeaderReconstructor<TRAITS>>(VisitorSettings);
+	}
+
+	struct Specialization
+	{
+		bool                      ShowOffsets;
+		bool                      CreatePaddingMembers;
+		bool                      MicrosoftTypedefs;
+		bool                      AllowAnonymousDataTypes;
+		MemberStructExpansionType MemberStructExpansion;
+
+		std::unique_ptr<PDBHeaderReconstructor> (*Create)(PDBHeaderReconstructor::Settings*);
+	};
+
+#define PDBEX_SPECIALIZATION(ShowOffsets, CreatePaddingMembers, MicrosoftTypedefs, AllowAnonymousDataTypes, MemberStructExpansion) \
+	{                                                                                                                              \
+		ShowOffsets, CreatePaddingMembers, MicrosoftTypedefs, AllowAnonymousDataTypes,                                               \
+		MemberStructExpansionType::MemberStructExpansion,                                                                            \
+		&CreateSpecialized<PDBHeaderReconstructorStaticTraits<                                                                       \
+			ShowOffsets, CreatePaddingMembers, MicrosoftTypedefs, AllowAnonymousDataTypes,                                             \
+			MemberStructExpansionType::MemberStructExpansion>>                                                                         \
+	}
+
+	//
+	// Combinations of settings which are instantiated at compile time:
+	// all expansion types with offsets and padding members on and off,
+	// Microsoft typedefs and anonymous data types left at their defaults.
+	//
+	static const Specialization Specializations[] = {
+		PDBEX_SPECIALIZATION(true,  true,  true, true, InlineUnnamed),
+		PDBEX_SPECIALIZATION(true,  false, true, true, InlineUnnamed),
+		PDBEX_SPECIALIZATION(false, true,  true, true, InlineUnnamed),
+		PDBEX_SPECIALIZATION(false, false, true, true, InlineUnnamed),
+		PDBEX_SPECIALIZATION(true,  true,  true, true, InlineAll),
+		PDBEX_SPECIALIZATION(true,  false, true, true, InlineAll),
+		PDBEX_SPECIALIZATION(false, true,  true, true, InlineAll),
+		PDBEX_SPECIALIZATION(false, false, true, true, InlineAll),
+		PDBEX_SPECIALIZATION(true,  true,  true, true, None),
+		PDBEX_SPECIALIZATION(true,  false, true, true, None),
+		PDBEX_SPECIALIZATION(false, true,  true, true, None),
+		PDBEX_SPECIALIZATION(false, false, true, true, None),
+	};
+
+#undef PDBEX_SPECIALIZATION
+}
+
+std::unique_ptr<PDBHeaderReconstructor>
+PDBHeaderReconstructor::Create(
+	Settings* VisitorSettings,
+	bool Specialize
+	)
+{
+	static Settings DefaultSettings;
+
+	if (VisitorSettings == nullptr)
+	{
+		VisitorSettings = &DefaultSettings;
+	}
+
+	if (Specialize)
+	{
+		for (auto&& e : Specializations)
+		{
+			if (e.ShowOffsets             == VisitorSettings->ShowOffsets             &&
+			    e.CreatePaddingMembers    == VisitorSettings->CreatePaddingMembers    &&
+			    e.MicrosoftTypedefs       == VisitorSettings->MicrosoftTypedefs       &&
+			    e.AllowAnonymousDataTypes == VisitorSettings->AllowAnonymousDataTypes &&
+			    e.MemberStructExpansion   == VisitorSettings->MemberStructExpansion)
+			{
+				return e.Create(VisitorSettings);
+			}
+		}
+	}
+
+	return CreateSpecialized<PDBHeaderReconstructorRuntimeTraits>(VisitorSettings);
+}
+
 void
 PDBHeaderReconstructor::Clear()
 {
 	assert(m_Depth == 0);
+	assert(m_SubtreeFrames.empty());
 
 	m_AnonymousDataTypeCounter = 0;
 	m_PaddingMemberCounter = 0;
@@ -36,6 +128,7 @@ PDBHeaderReconstructor::Clear()
 	m_UnnamedSymbols.clear();
 	m_CorrectedSymbolNames.clear();
 	m_VisitedSymbols.clear();
+	m_VisitOrder.clear();
 }
 
 const std::string&
@@ -43,6 +136,19 @@ PDBHeaderReconstructor::GetCorrectedSymbolName(
 	const SYMBOL* Symbol
 	) const
 {
+	//
+	// Names of unnamed symbols are numbered in the order
+	// they are reached, so they cannot be reused by the subtree cache.
+	//
+
+	if (!m_SubtreeFrames.empty() && PDB::IsUnnamedSymbol(Symbol))
+	{
+		for (auto&& Frame : m_SubtreeFrames)
+		{
+			Frame.IsCacheable = false;
+		}
+	}
+
 	auto CorrectedNameIt = m_CorrectedSymbolNames.find(Symbol);
 	if (CorrectedNameIt == m_CorrectedSymbolNames.end())
 	{
@@ -84,76 +190,6 @@ PDBHeaderReconstructor::GetCorrectedSymbolName(
 	return m_CorrectedSymbolNames[Symbol];
 }
 
-bool
-PDBHeaderReconstructor::OnEnumType(
-	const SYMBOL* Symbol
-	)
-{
-	std::string CorrectedName = GetCorrectedSymbolName(Symbol);
-
-	bool Expand = ShouldExpand(Symbol);
-
-	MarkAsVisited(Symbol);
-
-	if (!Expand)
-	{
-		Write("enum %s", CorrectedName.c_str());
-	}
-
-	return Expand;
-}
-
-void
-PDBHeaderReconstructor::OnEnumTypeBegin(
-	const SYMBOL* Symbol
-	)
-{
-	std::string CorrectedName = GetCorrectedSymbolName(Symbol);
-
-	//
-	// Handle begin of the typedef.
-	//
-
-	WriteTypedefBegin(Symbol);
-
-	Write("enum");
-
-	if (PDB::IsUnnamedSymbol(Symbol) && m_Depth != 0)
-	{
-		Write(" //");
-	}
-
-	Write(" %s", CorrectedName.c_str());
-	Write("\n");
-	
-	WriteIndent();
-	Write("{\n");
-	
-	m_Depth += 1;
-}
-
-void
-PDBHeaderReconstructor::OnEnumTypeEnd(
-	const SYMBOL* Symbol
-	)
-{
-	m_Depth -= 1;
-	
-	WriteIndent();
-	Write("}");
-
-	//
-	// Handle end of the typedef.
-	//
-
-	WriteTypedefEnd(Symbol);
-
-	if (m_Depth == 0)
-	{
-		Write(";\n\n");
-	}
-}
-
 void
 PDBHeaderReconstructor::OnEnumField(
 	const SYMBOL_ENUM_FIELD* EnumField
@@ -166,124 +202,6 @@ PDBHeaderReconstructor::OnEnumField(
 	Write(",\n");
 }
 
-bool
-PDBHeaderReconstructor::OnUdt(
-	const SYMBOL* Symbol
-	)
-{
-	bool Expand = ShouldExpand(Symbol);
-
-	MarkAsVisited(Symbol);
-
-	if (!Expand)
-	{
-		std::string CorrectedName = GetCorrectedSymbolName(Symbol);
-
-		WriteConstAndVolatile(Symbol);
-
-		Write("%s %s", PDB::GetUdtKindString(Symbol->u.Udt.Kind), CorrectedName.c_str());
-
-		//
-		// If we're not expanding the type at the root level,
-		// OnUdtEnd() won't be called, so print the semicolon here.
-		//
-
-		if (m_Depth == 0)
-		{
-			Write(";\n\n");
-		}
-	}
-
-	return Expand;
-}
-
-void
-PDBHeaderReconstructor::OnUdtBegin(
-	const SYMBOL* Symbol
-	)
-{
-	//
-	// Handle begin of the typedef.
-	//
-
-	WriteTypedefBegin(Symbol);
-
-	WriteConstAndVolatile(Symbol);
-
-	Write("%s", PDB::GetUdtKindString(Symbol->u.Udt.Kind));
-	
-	if (PDB::IsUnnamedSymbol(Symbol) && m_Depth != 0)
-	{
-		Write(" //");
-	}
-
-	std::string CorrectedName = GetCorrectedSymbolName(Symbol);
-	Write(" %s", CorrectedName.c_str());
-
-	Write("\n");
-
-	WriteIndent();
-	Write("{\n");
-
-	m_Depth += 1;
-}
-
-void
-PDBHeaderReconstructor::OnUdtEnd(
-	const SYMBOL* Symbol
-	)
-{
-	m_Depth -= 1;
-
-	WriteIndent();
-	Write("}");
-
-	//
-	// Handle end of the typedef.
-	//
-
-	WriteTypedefEnd(Symbol);
-
-	if (m_Depth == 0)
-	{
-		Write(";");
-	}
-
-	Write(" /* size: 0x%04x */", Symbol->Size);
-
-	if (m_Depth == 0)
-	{
-		Write("\n\n");
-	}
-}
-
-void
-PDBHeaderReconstructor::OnUdtFieldBegin(
-	const SYMBOL_UDT_FIELD* UdtField
-	)
-{
-	WriteIndent();
-
-	//
-	// Do not show offsets for members which will be expanded.
-	//
-
-	if (UdtField->Type->Tag != SymTagUDT ||
-	    ShouldExpand(UdtField->Type) == false)
-	{
-		WriteOffset(UdtField, GetParentOffset());
-	}
-
-	AppendToTest(UdtField);
-
-	//
-	// Push current offset in case we will be expanding
-	// some UDT field.
-	//
-
-	m_OffsetStack.push_back(UdtField->Offset);
-}
-
 void
 PDBHeaderReconstructor::OnUdtFieldEnd(
 	const SYMBOL_UDT_FIELD* UdtField
@@ -320,6 +238,16 @@ PDBHeaderReconstructor::OnUdtField(
 		Write(" /* bit position: %i */", UdtField->BitPosition);
 	}
 
+	if (m_Settings->FieldComments != nullptr)
+	{
+		auto It = m_Settings->FieldComments->find(UdtField);
+
+		if (It != m_Settings->FieldComments->end())
+		{
+			Write(" /* %s */", It->second.c_str());
+		}
+	}
+
 	Write("\n");
 }
 
@@ -338,27 +266,6 @@ PDBHeaderReconstructor::OnAnonymousUdtBegin(
 	m_Depth += 1;
 }
 
-void
-PDBHeaderReconstructor::OnAnonymousUdtEnd(
-	UdtKind Kind,
-	const SYMBOL_UDT_FIELD* FirstUdtField,
-	const SYMBOL_UDT_FIELD* LastUdtField,
-	DWORD Size
-	)
-{
-	m_Depth -= 1;
-	WriteIndent();
-	Write("}");
-
-	WriteUnnamedDataType(Kind);
-
-	Write(";");
-
-	Write(" /* size: 0x%04x */", Size);
-
-	Write("\n");
-}
-
 void
 PDBHeaderReconstructor::OnUdtFieldBitFieldBegin(
 	const SYMBOL_UDT_FIELD* FirstUdtFieldBitField,
@@ -402,57 +309,112 @@ PDBHeaderReconstructor::OnUdtFieldBitFieldEnd(
 }
 
 void
-PDBHeaderReconstructor::OnPaddingMember(
-	const SYMBOL_UDT_FIELD* UdtField,
-	BasicType PaddingBasicType,
-	DWORD PaddingBasicTypeSize,
-	DWORD PaddingSize
+PDBHeaderReconstructor::Write(
+	const char* Format,
+	...
 	)
 {
-	if (m_Settings->CreatePaddingMembers)
-	{
-		WriteIndent();
+	char TempBuffer[16 * 1024];
 
-		WriteOffset(UdtField, -((int)PaddingSize * (int)PaddingBasicTypeSize));
+	va_list ArgPtr;
+	va_start(ArgPtr, Format);
+	vsprintf_s(TempBuffer, Format, ArgPtr);
+	va_end(ArgPtr);
 
-		Write(
-			"%s %s%u",
-			PDB::GetBasicTypeString(PaddingBasicType, PaddingBasicTypeSize),
-			m_Settings->PaddingMemberPrefix.c_str(),
-			m_PaddingMemberCounter++
-			);
+	WriteText(TempBuffer, strlen(TempBuffer));
+}
+
+void
+PDBHeaderReconstructor::WriteText(
+	const char* Text,
+	size_t Length
+	)
+{
+	m_Settings->OutputFile->write(Text, Length);
 
-		if (PaddingSize > 1)
+	if (!m_SubtreeFrames.empty())
+	{
+		if (m_SubtreeSegments.size() > m_SubtreeSegmentsFloor &&
+		    m_SubtreeSegments.back().SegmentKind == SubtreeSegment::Kind::Text)
+		{
+			m_SubtreeSegments.back().Text.append(Text, Length);
+		}
+		else
 		{
-			Write("[%u]", PaddingSize);
+			m_SubtreeSegments.push_back({ SubtreeSegment::Kind::Text, std::string(Text, Length), 0 });
 		}
+	}
+}
+
+void
+PDBHeaderReconstructor::WriteIndent()
+{
+	WriteIndent(m_Depth);
+}
+
+void
+PDBHeaderReconstructor::WriteIndent(
+	DWORD Depth
+	)
+{
+	static const char Spaces[] = "                                                                ";
+
+	for (DWORD Remaining = Depth * 2; Remaining > 0; )
+	{
+		DWORD Length = (std::min)(Remaining, static_cast<DWORD>(sizeof(Spaces) - 1));
+
+		m_Settings->OutputFile->write(Spaces, Length);
+		Remaining -= Length;
+	}
 
-		Write(";\n");
+	if (!m_SubtreeFrames.empty())
+	{
+		m_SubtreeSegments.push_back({ SubtreeSegment::Kind::Indent, std::string(), Depth });
 	}
 }
 
 void
-PDBHeaderReconstructor::Write(
-	const char* Format,
-	...
+PDBHeaderReconstructor::WriteFieldOffset(
+	const SYMBOL_UDT_FIELD* UdtField
 	)
 {
-	char TempBuffer[16 * 1024];
+	WriteOffsetValue(UdtField->Offset + GetParentOffset());
+}
 
-	va_list ArgPtr;
-	va_start(ArgPtr, Format);
-	vsprintf_s(TempBuffer, Format, ArgPtr);
-	va_end(ArgPtr);
+void
+PDBHeaderReconstructor::WriteOffsetValue(
+	DWORD Offset
+	)
+{
+	char TempBuffer[32];
+	sprintf_s(TempBuffer, "/* 0x%04x */ ", Offset);
 
 	m_Settings->OutputFile->write(TempBuffer, strlen(TempBuffer));
+
+	if (!m_SubtreeFrames.empty())
+	{
+		m_SubtreeSegments.push_back({ SubtreeSegment::Kind::Offset, std::string(), Offset });
+	}
 }
 
 void
-PDBHeaderReconstructor::WriteIndent()
+PDBHeaderReconstructor::WritePaddingMemberName()
 {
-	for (DWORD i = 0; i < m_Depth; i++)
+	WritePaddingMemberName(m_PaddingMemberCounter++);
+}
+
+void
+PDBHeaderReconstructor::WritePaddingMemberName(
+	DWORD Index
+	)
+{
+	std::string Name = m_Settings->PaddingMemberPrefix + std::to_string(Index);
+
+	m_Settings->OutputFile->write(Name.c_str(), Name.size());
+
+	if (!m_SubtreeFrames.empty())
 	{
-		Write("  ");
+		m_SubtreeSegments.push_back({ SubtreeSegment::Kind::Padding, std::string(), Index });
 	}
 }
 
@@ -488,118 +450,232 @@ PDBHeaderReconstructor::WriteVariant(
 		case VT_UI4:
 			Write("0x%x", (UINT)v->lVal);
 			break;
+
+		case VT_I8:
+			Write("%lld", (LONGLONG)v->llVal);
+			break;
+
+		case VT_UI8:
+			Write("0x%llx", (ULONGLONG)v->ullVal);
+			break;
 	}
 }
 
 void
-PDBHeaderReconstructor::WriteUnnamedDataType(
-	UdtKind Kind
+PDBHeaderReconstructor::WriteConstAndVolatile(
+	const SYMBOL* Symbol
 	)
 {
-	if (m_Settings->AllowAnonymousDataTypes == false)
+	if (m_Depth != 0)
 	{
-		switch (Kind)
-		{
-			case UdtStruct:
-			case UdtClass:
-				Write(" %s", m_Settings->AnonymousStructPrefix.c_str());
-				break;
-
-			case UdtUnion:
-				Write(" %s", m_Settings->AnonymousUnionPrefix.c_str());
-				break;
+		//
+		// Allow only non-root UDTs to be "const" and/or "volatile".
+		//
 
-			default:
-				assert(0);
-				break;
+		if (Symbol->IsConst)
+		{
+			Write("const ");
 		}
 
-		if (m_AnonymousDataTypeCounter++ > 0)
+		if (Symbol->IsVolatile)
 		{
-			Write("%u", m_AnonymousDataTypeCounter);
+			Write("volatile ");
 		}
 	}
 }
 
-void
-PDBHeaderReconstructor::WriteTypedefBegin(
+bool
+PDBHeaderReconstructor::HasBeenVisited(
 	const SYMBOL* Symbol
-	)
+	) const
 {
-	std::string CorrectedName = GetCorrectedSymbolName(Symbol);
-	bool UseTypedef = m_Settings->MicrosoftTypedefs && CorrectedName[0] == '_';
-
-	if (UseTypedef && m_Depth == 0)
-	{
-		Write("typedef ");
-	}
+	return HasBeenVisited(GetCorrectedSymbolName(Symbol));
 }
 
 void
-PDBHeaderReconstructor::WriteTypedefEnd(
+PDBHeaderReconstructor::MarkAsVisited(
 	const SYMBOL* Symbol
 	)
 {
-	std::string CorrectedName = GetCorrectedSymbolName(Symbol);
-	bool UseTypedef = m_Settings->MicrosoftTypedefs && CorrectedName[0] == '_';
-
-	if (UseTypedef && m_Depth == 0)
-	{
-		Write(" %s, *P%s", &CorrectedName[1], &CorrectedName[1]);
-	}
+	MarkAsVisited(GetCorrectedSymbolName(Symbol));
 }
 
-void
-PDBHeaderReconstructor::WriteConstAndVolatile(
-	const SYMBOL* Symbol
-	)
+bool
+PDBHeaderReconstructor::HasBeenVisited(
+	const std::string& CorrectedName
+	) const
 {
-	if (m_Depth != 0)
+	auto It = m_VisitedSymbols.find(CorrectedName);
+
+	if (It == m_VisitedSymbols.end())
 	{
-		//
-		// Allow only non-root UDTs to be "const" and/or "volatile".
-		//
+		return false;
+	}
 
-		if (Symbol->IsConst)
-		{
-			Write("const ");
-		}
+	//
+	// Subtrees which started after the symbol was visited
+	// would be rendered differently without it.
+	//
 
-		if (Symbol->IsVolatile)
+	for (auto&& Frame : m_SubtreeFrames)
+	{
+		if (It->second < Frame.FirstVisitedSymbol)
 		{
-			Write("volatile ");
+			Frame.IsCacheable = false;
 		}
 	}
+
+	return true;
 }
 
 void
-PDBHeaderReconstructor::WriteOffset(
-	const SYMBOL_UDT_FIELD* UdtField,
-	int PaddingOffset
+PDBHeaderReconstructor::MarkAsVisited(
+	const std::string& CorrectedName
 	)
 {
-	if (m_Settings->ShowOffsets)
+	if (m_VisitedSymbols.emplace(CorrectedName, static_cast<DWORD>(m_VisitOrder.size())).second)
 	{
-		Write("/* 0x%04x */ ", UdtField->Offset + PaddingOffset);
+		m_VisitOrder.push_back(CorrectedName);
 	}
 }
 
 bool
-PDBHeaderReconstructor::HasBeenVisited(
+PDBHeaderReconstructor::CanCacheSubtree() const
+{
+	//
+	// Comments of fields may change between outputs.
+	//
+
+	return m_Depth != 0 && m_Settings->FieldComments == nullptr;
+}
+
+void
+PDBHeaderReconstructor::BeginSubtree(
 	const SYMBOL* Symbol
-	) const
+	)
 {
-	std::string CorrectedName = GetCorrectedSymbolName(Symbol);
-	return m_VisitedSymbols.find(CorrectedName) != m_VisitedSymbols.end();
+	SubtreeFrame Frame;
+
+	Frame.Symbol = Symbol;
+	Frame.Depth = m_Depth;
+	Frame.ParentOffset = GetParentOffset();
+	Frame.PaddingMemberCounter = m_PaddingMemberCounter;
+	Frame.AnonymousDataTypeCounter = m_AnonymousDataTypeCounter;
+	Frame.FirstSegment = m_SubtreeSegments.size();
+	Frame.FirstVisitedSymbol = m_VisitOrder.size();
+	Frame.IsCacheable = m_SubtreeCache.find(Symbol) == m_SubtreeCache.end();
+
+	m_SubtreeFrames.push_back(Frame);
+	m_SubtreeSegmentsFloor = m_SubtreeSegments.size();
 }
 
 void
-PDBHeaderReconstructor::MarkAsVisited(
+PDBHeaderReconstructor::EndSubtree(
+	const SYMBOL* Symbol
+	)
+{
+	if (m_SubtreeFrames.empty() ||
+	    m_SubtreeFrames.back().Symbol != Symbol ||
+	    m_SubtreeFrames.back().Depth != m_Depth)
+	{
+		return;
+	}
+
+	SubtreeFrame Frame = m_SubtreeFrames.back();
+	m_SubtreeFrames.pop_back();
+
+	//
+	// Anonymous data types are numbered through the whole output.
+	//
+
+	if (Frame.IsCacheable && Frame.AnonymousDataTypeCounter == m_AnonymousDataTypeCounter)
+	{
+		RenderedSubtree& Subtree = m_SubtreeCache[Symbol];
+
+		Subtree.Segments.assign(m_SubtreeSegments.begin() + Frame.FirstSegment, m_SubtreeSegments.end());
+		Subtree.VisitedSymbols.assign(m_VisitOrder.begin() + Frame.FirstVisitedSymbol, m_VisitOrder.end());
+		Subtree.PaddingMemberCount = m_PaddingMemberCounter - Frame.PaddingMemberCounter;
+
+		for (auto&& Segment : Subtree.Segments)
+		{
+			switch (Segment.SegmentKind)
+			{
+				case SubtreeSegment::Kind::Indent:
+					Segment.Value -= Frame.Depth;
+					break;
+
+				case SubtreeSegment::Kind::Offset:
+					Segment.Value -= Frame.ParentOffset;
+					break;
+
+				case SubtreeSegment::Kind::Padding:
+					Segment.Value -= Frame.PaddingMemberCounter;
+					break;
+			}
+		}
+	}
+
+	if (m_SubtreeFrames.empty())
+	{
+		m_SubtreeSegments.clear();
+		m_SubtreeSegmentsFloor = 0;
+	}
+}
+
+bool
+PDBHeaderReconstructor::WriteCachedSubtree(
 	const SYMBOL* Symbol
 	)
 {
-	std::string CorrectedName = GetCorrectedSymbolName(Symbol);
-	m_VisitedSymbols.insert(CorrectedName);
+	auto It = m_SubtreeCache.find(Symbol);
+
+	if (It == m_SubtreeCache.end())
+	{
+		return false;
+	}
+
+	const RenderedSubtree& Subtree = It->second;
+
+	for (auto&& CorrectedName : Subtree.VisitedSymbols)
+	{
+		if (HasBeenVisited(CorrectedName))
+		{
+			return false;
+		}
+	}
+
+	DWORD ParentOffset = GetParentOffset();
+
+	for (auto&& Segment : Subtree.Segments)
+	{
+		switch (Segment.SegmentKind)
+		{
+			case SubtreeSegment::Kind::Text:
+				WriteText(Segment.Text.c_str(), Segment.Text.size());
+				break;
+
+			case SubtreeSegment::Kind::Indent:
+				WriteIndent(m_Depth + Segment.Value);
+				break;
+
+			case SubtreeSegment::Kind::Offset:
+				WriteOffsetValue(ParentOffset + Segment.Value);
+				break;
+
+			case SubtreeSegment::Kind::Padding:
+				WritePaddingMemberName(m_PaddingMemberCounter + Segment.Value);
+				break;
+		}
+	}
+
+	for (auto&& CorrectedName : Subtree.VisitedSymbols)
+	{
+		MarkAsVisited(CorrectedName);
+	}
+
+	m_PaddingMemberCounter += Subtree.PaddingMemberCount;
+
+	return true;
 }
 
 DWORD
@@ -709,30 +785,3 @@ PDBHeaderReconstructor::AppendToTest(
 		(*m_Settings->TestFile) << FormattedStringBuffer << std::endl;
 	}
 }
-
-bool
-PDBHeaderReconstructor::ShouldExpand(
-	const SYMBOL* Symbol
-	) const
-{
-	bool Expand = false;
-
-	switch (m_Settings->MemberStructExpansion)
-	{
-		default:
-		case MemberStructExpansionType::None:
-			Expand = m_Depth == 0;
-			break;
-
-		case MemberStructExpansionType::InlineUnnamed:
-			Expand = m_Depth == 0 || PDB::IsUnnamedSymbol(Symbol);
-			break;
-
-		case MemberStructExpansionType::InlineAll:
-			Expand = !HasBeenVisited(Symbol);
-			break;
-	}
-
-	return Expand && Symbol->Size > 0;
-}
-
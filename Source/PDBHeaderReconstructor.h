@@ -2,10 +2,12 @@
 #include "PDBReconstructorBase.h"
 
 #include <iostream>
+#include <memory>
 #include <numeric> // std::accumulate
 #include <string>
 #include <map>
 #include <set>
+#include <vector>
 
 #include <cassert>
 
@@ -47,6 +49,9 @@ class PDBHeaderReconstructor
 				MicrosoftTypedefs       = true;
 				AllowBitFieldsInUnion   = false;
 				AllowAnonymousDataTypes = true;
+				UseStdInt               = false;
+				UsePortableTypes        = false;
+				FieldComments           = nullptr;
 			}
 
 			MemberStructExpansionType MemberStructExpansion;
@@ -63,12 +68,39 @@ class PDBHeaderReconstructor
 			bool                      MicrosoftTypedefs       : 1;
 			bool                      AllowBitFieldsInUnion   : 1;
 			bool                      AllowAnonymousDataTypes : 1;
+
+			//
+			// Types of the padding members,
+			// see PDB::GetBasicTypeString.
+			//
+			bool                      UseStdInt               : 1;
+			bool                      UsePortableTypes        : 1;
+
+			//
+			// Optional comments appended to the definitions of fields
+			// (e.g. access counts of the field heatmap).
+			//
+			const std::map<const SYMBOL_UDT_FIELD*, std::string>* FieldComments;
 		};
 
-		PDBHeaderReconstructor(
-			Settings* VisitorSettings = nullptr
+		//
+		// Creates the reconstructor specialized for the provided settings.
+		// Common combinations of settings are instantiated at compile time
+		// (see PDBSpecializedHeaderReconstructor), others (or all of them,
+		// if Specialize is false) are handled by the generic instantiation
+		// which tests the settings at runtime.
+		//
+		static
+		std::unique_ptr<PDBHeaderReconstructor>
+		Create(
+			Settings* VisitorSettings = nullptr,
+			bool Specialize = true
 			);
 
+		//
+		// Resets the state of the output (visited symbols, counters
+		// and names of unnamed symbols). Rendered subtrees stay cached.
+		//
 		void
 		Clear();
 
@@ -78,46 +110,15 @@ class PDBHeaderReconstructor
 			) const;
 
 	protected:
-		bool
-		OnEnumType(
-			const SYMBOL* Symbol
-			) override;
-
-		void
-		OnEnumTypeBegin(
-			const SYMBOL* Symbol
-			) override;
-
-		void
-		OnEnumTypeEnd(
-			const SYMBOL* Symbol
-			) override;
+		PDBHeaderReconstructor(
+			Settings* VisitorSettings = nullptr
+			);
 
 		void
 		OnEnumField(
 			const SYMBOL_ENUM_FIELD* EnumField
 			) override;
 
-		bool
-		OnUdt(
-			const SYMBOL* Symbol
-			) override;
-
-		void
-		OnUdtBegin(
-			const SYMBOL* Symbol
-			) override;
-
-		void
-		OnUdtEnd(
-			const SYMBOL* Symbol
-			) override;
-
-		void
-		OnUdtFieldBegin(
-			const SYMBOL_UDT_FIELD* UdtField
-			) override;
-
 		void
 		OnUdtFieldEnd(
 			const SYMBOL_UDT_FIELD* UdtField
@@ -135,14 +136,6 @@ class PDBHeaderReconstructor
 			const SYMBOL_UDT_FIELD* FirstUdtField
 			);
 
-		void
-		OnAnonymousUdtEnd(
-			UdtKind Kind,
-			const SYMBOL_UDT_FIELD* FirstUdtField,
-			const SYMBOL_UDT_FIELD* LastUdtField,
-			DWORD Size
-			) override;
-
 		void
 		OnUdtFieldBitFieldBegin(
 			const SYMBOL_UDT_FIELD* FirstUdtFieldBitField,
@@ -155,42 +148,52 @@ class PDBHeaderReconstructor
 			const SYMBOL_UDT_FIELD* LastUdtFieldBitField
 			) override;
 
-		void
-		OnPaddingMember(
-			const SYMBOL_UDT_FIELD* UdtField,
-			BasicType PaddingBasicType,
-			DWORD PaddingBasicTypeSize,
-			DWORD PaddingSize
-			) override;
-
-	private:
+	protected:
 		void
 		Write(
 			const char* Format,
 			...
 			);
 
+		void
+		WriteText(
+			const char* Text,
+			size_t Length
+			);
+
 		void
 		WriteIndent();
 
 		void
-		WriteVariant(
-			const VARIANT* v
+		WriteIndent(
+			DWORD Depth
 			);
 
+		//
+		// Writes the offset of the field of the current UDT,
+		// rebased by the offset of the parent member.
+		//
 		void
-		WriteUnnamedDataType(
-			UdtKind Kind
+		WriteFieldOffset(
+			const SYMBOL_UDT_FIELD* UdtField
 			);
 
 		void
-		WriteTypedefBegin(
-			const SYMBOL* Symbol
+		WriteOffsetValue(
+			DWORD Offset
 			);
 
 		void
-		WriteTypedefEnd(
-			const SYMBOL* Symbol
+		WritePaddingMemberName();
+
+		void
+		WritePaddingMemberName(
+			DWORD Index
+			);
+
+		void
+		WriteVariant(
+			const VARIANT* v
 			);
 
 		void
@@ -198,19 +201,48 @@ class PDBHeaderReconstructor
 			const SYMBOL* Symbol
 			);
 
+		bool
+		HasBeenVisited(
+			const SYMBOL* Symbol
+			) const;
+
 		void
-		WriteOffset(
-			const SYMBOL_UDT_FIELD* UdtField,
-			int PaddingOffset
+		MarkAsVisited(
+			const SYMBOL* Symbol
 			);
 
 		bool
 		HasBeenVisited(
-			const SYMBOL* Symbol
+			const std::string& CorrectedName
 			) const;
 
 		void
 		MarkAsVisited(
+			const std::string& CorrectedName
+			);
+
+		//
+		// Subtree cache (see m_SubtreeCache).
+		//
+		// BeginSubtree()/EndSubtree() record the output
+		// of the expanded nested UDT, WriteCachedSubtree() writes
+		// the recorded output instead of visiting the UDT again.
+		//
+		bool
+		CanCacheSubtree() const;
+
+		void
+		BeginSubtree(
+			const SYMBOL* Symbol
+			);
+
+		void
+		EndSubtree(
+			const SYMBOL* Symbol
+			);
+
+		bool
+		WriteCachedSubtree(
 			const SYMBOL* Symbol
 			);
 
@@ -222,12 +254,7 @@ class PDBHeaderReconstructor
 			const SYMBOL_UDT_FIELD* UdtField
 			);
 
-		bool
-		ShouldExpand(
-			const SYMBOL* Symbol
-			) const;
-
-	private:
+	protected:
 		//
 		// Settings for this visitor.
 		//
@@ -277,6 +304,87 @@ class PDBHeaderReconstructor
 		//
 		// See PDBVisitorSorter::HasBeenVisited() for more information.
 		//
-		std::set<std::string> m_VisitedSymbols;
+		// Symbols are mapped to their index in m_VisitOrder,
+		// so subtrees can tell the symbols visited before them.
+		//
+		std::map<std::string, DWORD> m_VisitedSymbols;
+		std::vector<std::string> m_VisitOrder;
+
+		//
+		// Output of the subtree with everything which depends
+		// on the position of the subtree stored relatively:
+		//
+		//   Indent  - depth relative to the depth of the subtree
+		//   Offset  - offset relative to the offset of the parent member
+		//   Padding - index of the padding member relative
+		//             to the counter at the beginning of the subtree
+		//
+		// Recorded values are absolute until the subtree ends.
+		//
+		struct SubtreeSegment
+		{
+			enum class Kind
+			{
+				Text,
+				Indent,
+				Offset,
+				Padding,
+			};
+
+			Kind SegmentKind;
+			std::string Text;
+			DWORD Value;
+		};
+
+		struct RenderedSubtree
+		{
+			std::vector<SubtreeSegment> Segments;
+
+			//
+			// Corrected names of the symbols visited by the subtree,
+			// the subtree is reused only when none of them
+			// has been visited yet.
+			//
+			std::vector<std::string> VisitedSymbols;
+
+			DWORD PaddingMemberCount;
+		};
+
+		struct SubtreeFrame
+		{
+			const SYMBOL* Symbol;
+
+			DWORD Depth;
+			DWORD ParentOffset;
+			DWORD PaddingMemberCounter;
+			DWORD AnonymousDataTypeCounter;
+
+			size_t FirstSegment;
+			size_t FirstVisitedSymbol;
+
+			//
+			// Cleared when the output depends on the state outside
+			// of the subtree (symbols visited before the subtree,
+			// names of unnamed symbols).
+			//
+			bool IsCacheable;
+		};
+
+		//
+		// With InlineAll expansion, every nested UDT is expanded
+		// when it is first reached after Clear(). Outputs which
+		// are rendered after Clear() one by one (e.g. headers of --mount)
+		// would render the same subtrees (_LIST_ENTRY, _DISPATCHER_HEADER, ...)
+		// over and over again, so they are cached per symbol instead
+		// and spliced at the new depth, offset and padding counter.
+		//
+		std::map<const SYMBOL*, RenderedSubtree> m_SubtreeCache;
+
+		//
+		// Subtrees being recorded, innermost last, and their output.
+		//
+		mutable std::vector<SubtreeFrame> m_SubtreeFrames;
+		std::vector<SubtreeSegment> m_SubtreeSegments;
+		size_t m_SubtreeSegmentsFloor = 0;
 };
 
@@ -0,0 +1,739 @@
+#include "PDBIdentityScanner.h"
+#include "WorkerThreads.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+	static const BYTE MSF_SIGNATURE[] = "Microsoft C/C++ MSF 7.00\r\n\x1a" "DS\0\0";
+
+	//
+	// Layout of the super block.
+	//
+	static const DWORD MSF_SIGNATURE_SIZE = 32;
+	static const DWORD MSF_BLOCK_SIZE_OFFSET = 32;
+	static const DWORD MSF_BLOCK_COUNT_OFFSET = 40;
+	static const DWORD MSF_DIRECTORY_SIZE_OFFSET = 44;
+	static const DWORD MSF_BLOCK_MAP_OFFSET = 52;
+	static const DWORD MSF_SUPER_BLOCK_SIZE = 56;
+
+	//
+	// Size of the stream which has no blocks.
+	//
+	static const DWORD MSF_NIL_STREAM_SIZE = 0xFFFFFFFF;
+
+	//
+	// Version, signature, age and GUID of the info stream.
+	//
+	static const DWORD INFO_STREAM_HEADER_SIZE = 28;
+
+	//
+	// Version signature, version and age of the DBI stream.
+	//
+	static const DWORD DBI_STREAM_HEADER_SIZE = 12;
+	static const DWORD DBI_VERSION_SIGNATURE = 0xFFFFFFFF;
+
+	static const DWORD INFO_STREAM = 1;
+	static const DWORD DBI_STREAM = 3;
+
+	static PDBIdentityScanner::Settings DefaultSettings;
+
+	DWORD
+	ReadDword(
+		const BYTE* Data
+		)
+	{
+		DWORD Value;
+		memcpy(&Value, Data, sizeof(Value));
+
+		return Value;
+	}
+
+	DWORD
+	GetStreamBlockCount(
+		DWORD StreamSize,
+		DWORD BlockSize
+		)
+	{
+		if (StreamSize == MSF_NIL_STREAM_SIZE)
+		{
+			return 0;
+		}
+
+		return static_cast<DWORD>((static_cast<ULONGLONG>(StreamSize) + BlockSize - 1) / BlockSize);
+	}
+}
+
+PDBIdentityScanner::PDBIdentityScanner(
+	Settings* ScannerSettings
+	)
+{
+	m_Settings = ScannerSettings ? ScannerSettings : &DefaultSettings;
+}
+
+PDBIdentityScanner::Statistics
+PDBIdentityScanner::Scan(
+	const std::vector<std::string>& Paths,
+	std::vector<Identity>& Identities
+	)
+{
+	Statistics Stats;
+	Stats.FileCount = Paths.size();
+
+	Identities.assign(Paths.size(), Identity());
+
+	if (Paths.empty())
+	{
+		return Stats;
+	}
+
+	DWORD ThreadCount = WorkerThreads::GetCount(m_Settings->ThreadCount);
+
+	auto StartTime = std::chrono::steady_clock::now();
+
+	HANDLE CompletionPort = m_Settings->UseCompletionPort
+		? CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, ThreadCount)
+		: nullptr;
+
+	if (CompletionPort != nullptr)
+	{
+		ScanWithCompletionPort(CompletionPort, Paths, Identities, ThreadCount, Stats);
+		CloseHandle(CompletionPort);
+
+		Stats.UsedCompletionPort = true;
+	}
+	else
+	{
+		ScanWithBlockingReads(Paths, Identities, ThreadCount, Stats);
+	}
+
+	Stats.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+	return Stats;
+}
+
+const char*
+PDBIdentityScanner::GetStatusString(
+	Status Result
+	)
+{
+	switch (Result)
+	{
+		case Status::Ok:          return "ok";
+		case Status::CannotOpen:  return "cannot be opened";
+		case Status::ReadError:   return "cannot be read";
+		case Status::NotMsf:      return "not an MSF 7.00 file";
+		case Status::Corrupted:   return "corrupted";
+		default:                  return "unknown";
+	}
+}
+
+void
+PDBIdentityScanner::Start(
+	FileScan& Scan
+	)
+{
+	Scan.CurrentStage = Stage::SuperBlock;
+	Scan.Reads.clear();
+
+	AddRead(Scan, 0, Scan.Header, MSF_SUPER_BLOCK_SIZE);
+}
+
+bool
+PDBIdentityScanner::Advance(
+	FileScan& Scan
+	)
+{
+	//
+	// Failed reads do not tell anything about the file,
+	// short reads mean the file ends before the referenced block.
+	//
+
+	for (auto&& CurrentRead : Scan.Reads)
+	{
+		if (CurrentRead.Error != ERROR_SUCCESS)
+		{
+			return Finish(Scan, Status::ReadError);
+		}
+	}
+
+	for (auto&& CurrentRead : Scan.Reads)
+	{
+		if (CurrentRead.BytesRead != CurrentRead.Size)
+		{
+			return Finish(Scan, Scan.CurrentStage == Stage::SuperBlock ? Status::NotMsf : Status::Corrupted);
+		}
+	}
+
+	Scan.Reads.clear();
+
+	switch (Scan.CurrentStage)
+	{
+		case Stage::SuperBlock:
+		{
+			if (memcmp(Scan.Header, MSF_SIGNATURE, MSF_SIGNATURE_SIZE) != 0)
+			{
+				return Finish(Scan, Status::NotMsf);
+			}
+
+			Scan.BlockSize = ReadDword(Scan.Header + MSF_BLOCK_SIZE_OFFSET);
+			Scan.BlockCount = ReadDword(Scan.Header + MSF_BLOCK_COUNT_OFFSET);
+			Scan.DirectorySize = ReadDword(Scan.Header + MSF_DIRECTORY_SIZE_OFFSET);
+
+			DWORD BlockMapBlock = ReadDword(Scan.Header + MSF_BLOCK_MAP_OFFSET);
+
+			if (Scan.BlockSize < 512 || Scan.BlockSize > 65536 ||
+			    (Scan.BlockSize & (Scan.BlockSize - 1)) != 0 ||
+			    Scan.DirectorySize == 0 ||
+			    BlockMapBlock >= Scan.BlockCount)
+			{
+				return Finish(Scan, Status::Corrupted);
+			}
+
+			//
+			// Indices of the directory blocks fit into one block.
+			//
+
+			DWORD DirectoryBlockCount = GetStreamBlockCount(Scan.DirectorySize, Scan.BlockSize);
+
+			if (DirectoryBlockCount > Scan.BlockSize / sizeof(DWORD))
+			{
+				return Finish(Scan, Status::Corrupted);
+			}
+
+			Scan.DirectoryBlocks.resize(DirectoryBlockCount);
+
+			AddRead(
+				Scan,
+				static_cast<ULONGLONG>(BlockMapBlock) * Scan.BlockSize,
+				reinterpret_cast<BYTE*>(Scan.DirectoryBlocks.data()),
+				DirectoryBlockCount * sizeof(DWORD)
+				);
+
+			Scan.CurrentStage = Stage::BlockMap;
+			return true;
+		}
+
+		case Stage::BlockMap:
+		{
+			for (DWORD Block : Scan.DirectoryBlocks)
+			{
+				if (Block >= Scan.BlockCount)
+				{
+					return Finish(Scan, Status::Corrupted);
+				}
+			}
+
+			Scan.Directory.resize(Scan.BlockSize);
+
+			AddRead(
+				Scan,
+				static_cast<ULONGLONG>(Scan.DirectoryBlocks[0]) * Scan.BlockSize,
+				Scan.Directory.data(),
+				Scan.BlockSize
+				);
+
+			Scan.CurrentStage = Stage::Directory;
+			return true;
+		}
+
+		case Stage::Directory:
+		{
+			//
+			// Sizes of the streams 0 - 3 are in the first block, the first
+			// block of every stream follows the blocks of the previous ones.
+			//
+
+			DWORD StreamCount = ReadDword(Scan.Directory.data());
+
+			if (StreamCount <= INFO_STREAM)
+			{
+				return Finish(Scan, Status::Corrupted);
+			}
+
+			DWORD DirectoryEnd = (std::min)(Scan.DirectorySize, static_cast<DWORD>(Scan.DirectoryBlocks.size()) * Scan.BlockSize);
+			DWORD LastStream = StreamCount > DBI_STREAM ? DBI_STREAM : INFO_STREAM;
+
+			ULONGLONG StreamBlockOffset = sizeof(DWORD) + static_cast<ULONGLONG>(StreamCount) * sizeof(DWORD);
+
+			for (DWORD Stream = 0; Stream <= LastStream; Stream++)
+			{
+				if (StreamBlockOffset + sizeof(DWORD) > DirectoryEnd)
+				{
+					//
+					// Only the missing DBI stream is tolerated.
+					//
+
+					if (Stream <= INFO_STREAM)
+					{
+						return Finish(Scan, Status::Corrupted);
+					}
+
+					break;
+				}
+
+				if (Stream == INFO_STREAM)
+				{
+					Scan.InfoStreamBlockOffset = static_cast<DWORD>(StreamBlockOffset);
+					Scan.DbiStreamBlockOffset = 0;
+				}
+				else if (Stream == DBI_STREAM)
+				{
+					Scan.DbiStreamBlockOffset = static_cast<DWORD>(StreamBlockOffset);
+				}
+
+				DWORD StreamSize = ReadDword(Scan.Directory.data() + sizeof(DWORD) + Stream * sizeof(DWORD));
+				StreamBlockOffset += static_cast<ULONGLONG>(GetStreamBlockCount(StreamSize, Scan.BlockSize)) * sizeof(DWORD);
+			}
+
+			DWORD LastBlockOffset = (std::max)(Scan.InfoStreamBlockOffset, Scan.DbiStreamBlockOffset);
+			DWORD NeededBlockCount = GetStreamBlockCount(LastBlockOffset + sizeof(DWORD), Scan.BlockSize);
+
+			if (NeededBlockCount == 1)
+			{
+				return ReadStreams(Scan);
+			}
+
+			Scan.Directory.resize(static_cast<size_t>(NeededBlockCount) * Scan.BlockSize);
+
+			for (DWORD Index = 1; Index < NeededBlockCount; Index++)
+			{
+				AddRead(
+					Scan,
+					static_cast<ULONGLONG>(Scan.DirectoryBlocks[Index]) * Scan.BlockSize,
+					Scan.Directory.data() + static_cast<size_t>(Index) * Scan.BlockSize,
+					Scan.BlockSize
+					);
+			}
+
+			Scan.CurrentStage = Stage::DirectoryTail;
+			return true;
+		}
+
+		case Stage::DirectoryTail:
+		{
+			return ReadStreams(Scan);
+		}
+
+		case Stage::Streams:
+		{
+			Identity* Result = Scan.Result;
+
+			Result->Version = ReadDword(Scan.Header);
+			Result->Signature = ReadDword(Scan.Header + 4);
+			Result->Age = ReadDword(Scan.Header + 8);
+			memcpy(&Result->Guid, Scan.Header + 12, sizeof(GUID));
+
+			if (Scan.DbiStreamBlockOffset != 0)
+			{
+				if (ReadDword(Scan.DbiHeader) != DBI_VERSION_SIGNATURE)
+				{
+					return Finish(Scan, Status::Corrupted);
+				}
+
+				Result->Age = ReadDword(Scan.DbiHeader + 8);
+			}
+
+			return Finish(Scan, Status::Ok);
+		}
+
+		default:
+		{
+			return Finish(Scan, Status::Corrupted);
+		}
+	}
+}
+
+void
+PDBIdentityScanner::AddRead(
+	FileScan& Scan,
+	ULONGLONG Offset,
+	BYTE* Buffer,
+	DWORD Size
+	)
+{
+	Read NewRead;
+	memset(static_cast<OVERLAPPED*>(&NewRead), 0, sizeof(OVERLAPPED));
+
+	NewRead.Offset = static_cast<DWORD>(Offset);
+	NewRead.OffsetHigh = static_cast<DWORD>(Offset >> 32);
+	NewRead.Owner = &Scan;
+	NewRead.Buffer = Buffer;
+	NewRead.Size = Size;
+	NewRead.BytesRead = 0;
+	NewRead.Error = ERROR_SUCCESS;
+
+	Scan.Reads.push_back(NewRead);
+}
+
+bool
+PDBIdentityScanner::ReadStreams(
+	FileScan& Scan
+	)
+{
+	DWORD InfoStreamSize = ReadDword(Scan.Directory.data() + sizeof(DWORD) + INFO_STREAM * sizeof(DWORD));
+	DWORD InfoStreamBlock = ReadDword(Scan.Directory.data() + Scan.InfoStreamBlockOffset);
+
+	if (InfoStreamSize == MSF_NIL_STREAM_SIZE ||
+	    InfoStreamSize < INFO_STREAM_HEADER_SIZE ||
+	    InfoStreamBlock >= Scan.BlockCount)
+	{
+		return Finish(Scan, Status::Corrupted);
+	}
+
+	AddRead(
+		Scan,
+		static_cast<ULONGLONG>(InfoStreamBlock) * Scan.BlockSize,
+		Scan.Header,
+		INFO_STREAM_HEADER_SIZE
+		);
+
+	//
+	// The DBI stream may be missing (or empty),
+	// the age of the info stream is used then.
+	//
+
+	if (Scan.DbiStreamBlockOffset != 0)
+	{
+		DWORD DbiStreamSize = ReadDword(Scan.Directory.data() + sizeof(DWORD) + DBI_STREAM * sizeof(DWORD));
+		DWORD DbiStreamBlock = ReadDword(Scan.Directory.data() + Scan.DbiStreamBlockOffset);
+
+		if (DbiStreamSize == MSF_NIL_STREAM_SIZE ||
+		    DbiStreamSize < DBI_STREAM_HEADER_SIZE)
+		{
+			Scan.DbiStreamBlockOffset = 0;
+		}
+		else if (DbiStreamBlock >= Scan.BlockCount)
+		{
+			return Finish(Scan, Status::Corrupted);
+		}
+		else
+		{
+			AddRead(
+				Scan,
+				static_cast<ULONGLONG>(DbiStreamBlock) * Scan.BlockSize,
+				Scan.DbiHeader,
+				DBI_STREAM_HEADER_SIZE
+				);
+		}
+	}
+
+	Scan.CurrentStage = Stage::Streams;
+	return true;
+}
+
+bool
+PDBIdentityScanner::Finish(
+	FileScan& Scan,
+	Status Result
+	)
+{
+	Scan.Result->Result = Result;
+	Scan.CurrentStage = Stage::Done;
+	Scan.Reads.clear();
+
+	//
+	// Directories of large PDBs are not kept for the next file.
+	//
+
+	std::vector<DWORD>().swap(Scan.DirectoryBlocks);
+	std::vector<BYTE>().swap(Scan.Directory);
+
+	return false;
+}
+
+void
+PDBIdentityScanner::ScanWithCompletionPort(
+	HANDLE CompletionPort,
+	const std::vector<std::string>& Paths,
+	std::vector<Identity>& Identities,
+	DWORD ThreadCount,
+	Statistics& Stats
+	)
+{
+	//
+	// Every slot is the scan of one file, the slot is reused
+	// for the next path when its file is finished. Completions
+	// of one slot are never processed concurrently, the reads
+	// of the next stage are issued after all reads of the current
+	// stage are completed.
+	//
+
+	std::vector<FileScan> Slots((std::max)(
+		static_cast<size_t>(1),
+		(std::min)(static_cast<size_t>(m_Settings->MaximumFileCount), Paths.size())
+		));
+
+	std::atomic<size_t> NextPath(0);
+	std::atomic<size_t> FinishedCount(0);
+	std::atomic<size_t> ReadCount(0);
+	std::atomic<ULONGLONG> ByteCount(0);
+
+	auto FinishFile = [&]() {
+		if (++FinishedCount == Paths.size())
+		{
+			for (DWORD i = 0; i < ThreadCount; i++)
+			{
+				PostQueuedCompletionStatus(CompletionPort, 0, 0, nullptr);
+			}
+		}
+	};
+
+	//
+	// The count of pending reads holds one more reference while the reads
+	// are being issued, a worker cannot advance the scan before that.
+	// Returns true if all reads are already completed, the caller then
+	// advances the scan. Reads which fail immediately are completed
+	// through the port as well, with their error.
+	//
+
+	auto IssueReads = [&](FileScan& Scan) {
+		Scan.PendingReadCount = static_cast<LONG>(Scan.Reads.size()) + 1;
+
+		for (auto&& CurrentRead : Scan.Reads)
+		{
+			if (!ReadFile(Scan.File, CurrentRead.Buffer, CurrentRead.Size, nullptr, &CurrentRead))
+			{
+				DWORD Error = GetLastError();
+
+				if (Error != ERROR_IO_PENDING)
+				{
+					CurrentRead.Error = Error != ERROR_HANDLE_EOF ? Error : ERROR_SUCCESS;
+					PostQueuedCompletionStatus(CompletionPort, 0, 0, &CurrentRead);
+				}
+			}
+		}
+
+		return InterlockedDecrement(&Scan.PendingReadCount) == 0;
+	};
+
+	//
+	// Returns true if the reads of the started file are already completed.
+	//
+
+	auto StartFile = [&](FileScan& Scan) {
+		for (;;)
+		{
+			size_t PathIndex = NextPath++;
+
+			if (PathIndex >= Paths.size())
+			{
+				return false;
+			}
+
+			Scan.Result = &Identities[PathIndex];
+			Scan.File = CreateFileA(
+				Paths[PathIndex].c_str(),
+				GENERIC_READ,
+				FILE_SHARE_READ,
+				nullptr,
+				OPEN_EXISTING,
+				FILE_FLAG_OVERLAPPED,
+				nullptr
+				);
+
+			if (Scan.File == INVALID_HANDLE_VALUE)
+			{
+				Scan.Result->Result = Status::CannotOpen;
+				FinishFile();
+				continue;
+			}
+
+			if (CreateIoCompletionPort(Scan.File, CompletionPort, 0, 0) == nullptr)
+			{
+				CloseHandle(Scan.File);
+				Scan.Result->Result = Status::ReadError;
+				FinishFile();
+				continue;
+			}
+
+			Start(Scan);
+			return IssueReads(Scan);
+		}
+	};
+
+	//
+	// Advances the scan whose reads are all completed, loops instead
+	// of recursing when the reads of the next stage (or of the next file)
+	// are completed before IssueReads returns.
+	//
+
+	auto CompleteStage = [&](FileScan& Scan) {
+		for (;;)
+		{
+			for (auto&& CurrentRead : Scan.Reads)
+			{
+				ReadCount++;
+				ByteCount += CurrentRead.BytesRead;
+			}
+
+			bool Completed;
+
+			if (Advance(Scan))
+			{
+				Completed = IssueReads(Scan);
+			}
+			else
+			{
+				CloseHandle(Scan.File);
+				FinishFile();
+
+				Completed = StartFile(Scan);
+			}
+
+			if (!Completed)
+			{
+				return;
+			}
+		}
+	};
+
+	auto Worker = [&]() {
+		for (;;)
+		{
+			DWORD BytesTransferred = 0;
+			ULONG_PTR CompletionKey = 0;
+			OVERLAPPED* Overlapped = nullptr;
+
+			BOOL Success = GetQueuedCompletionStatus(CompletionPort, &BytesTransferred, &CompletionKey, &Overlapped, INFINITE);
+
+			if (Overlapped == nullptr)
+			{
+				//
+				// All files are finished (or the port is gone).
+				//
+
+				return;
+			}
+
+			Read* CompletedRead = static_cast<Read*>(Overlapped);
+			CompletedRead->BytesRead = Success ? BytesTransferred : 0;
+
+			if (!Success)
+			{
+				DWORD Error = GetLastError();
+				CompletedRead->Error = Error != ERROR_HANDLE_EOF ? Error : ERROR_SUCCESS;
+			}
+
+			FileScan& Scan = *CompletedRead->Owner;
+
+			if (InterlockedDecrement(&Scan.PendingReadCount) == 0)
+			{
+				CompleteStage(Scan);
+			}
+		}
+	};
+
+	//
+	// Every thread is one worker, the first one
+	// starts the files of all slots before that.
+	//
+
+	WorkerThreads::RunRanges(ThreadCount, ThreadCount, [&](DWORD ThreadIndex, size_t, size_t) {
+		if (ThreadIndex == 0)
+		{
+			for (auto&& Slot : Slots)
+			{
+				if (StartFile(Slot))
+				{
+					CompleteStage(Slot);
+				}
+			}
+		}
+
+		Worker();
+	});
+
+	Stats.ReadCount = ReadCount;
+	Stats.ByteCount = ByteCount;
+}
+
+void
+PDBIdentityScanner::ScanWithBlockingReads(
+	const std::vector<std::string>& Paths,
+	std::vector<Identity>& Identities,
+	DWORD ThreadCount,
+	Statistics& Stats
+	)
+{
+	//
+	// The reads are blocking, more threads than the count of files
+	// in flight would only wait.
+	//
+
+	ThreadCount = static_cast<DWORD>((std::min)(
+		static_cast<size_t>(ThreadCount),
+		(std::min)(static_cast<size_t>((std::max)(m_Settings->MaximumFileCount, static_cast<DWORD>(1))), Paths.size())
+		));
+
+	std::atomic<size_t> NextPath(0);
+	std::atomic<size_t> ReadCount(0);
+	std::atomic<ULONGLONG> ByteCount(0);
+
+	auto Worker = [&]() {
+		FileScan Scan;
+
+		for (;;)
+		{
+			size_t PathIndex = NextPath++;
+
+			if (PathIndex >= Paths.size())
+			{
+				return;
+			}
+
+			Scan.Result = &Identities[PathIndex];
+			Scan.File = CreateFileA(
+				Paths[PathIndex].c_str(),
+				GENERIC_READ,
+				FILE_SHARE_READ,
+				nullptr,
+				OPEN_EXISTING,
+				FILE_ATTRIBUTE_NORMAL,
+				nullptr
+				);
+
+			if (Scan.File == INVALID_HANDLE_VALUE)
+			{
+				Scan.Result->Result = Status::CannotOpen;
+				continue;
+			}
+
+			Start(Scan);
+
+			do
+			{
+				//
+				// Offsets of the synchronous reads are taken
+				// from the OVERLAPPED structures.
+				//
+
+				for (auto&& CurrentRead : Scan.Reads)
+				{
+					if (!ReadFile(Scan.File, CurrentRead.Buffer, CurrentRead.Size, &CurrentRead.BytesRead, &CurrentRead))
+					{
+						DWORD Error = GetLastError();
+
+						CurrentRead.BytesRead = 0;
+						CurrentRead.Error = Error != ERROR_HANDLE_EOF ? Error : ERROR_SUCCESS;
+					}
+
+					ReadCount++;
+					ByteCount += CurrentRead.BytesRead;
+				}
+			} while (Advance(Scan));
+
+			CloseHandle(Scan.File);
+		}
+	};
+
+	WorkerThreads::RunRanges(ThreadCount, ThreadCount, [&](DWORD, size_t, size_t) {
+		Worker();
+	});
+
+	Stats.ReadCount = ReadCount;
+	Stats.ByteCount = ByteCount;
+}
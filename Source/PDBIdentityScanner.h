@@ -0,0 +1,233 @@
+#pragma once
+#include <windows.h>
+
+#include <string>
+#include <vector>
+
+//
+// Reads identities (GUID and signature of the PDB info stream, age
+// of the DBI stream) of many PDB files without opening them by DIA.
+//
+// Every file is a small chain of dependent reads of the MSF 7.00 file:
+//
+//   SuperBlock      block size, size of the stream directory and the
+//                   block which lists the blocks of the directory
+//   BlockMap        blocks of the stream directory
+//   Directory       first block of the directory: count of streams,
+//                   their sizes, followed by the blocks of the streams
+//   DirectoryTail   rest of the directory up to the blocks of stream 3
+//                   (all missing blocks are read at once)
+//   Streams         headers of the PDB info stream (stream 1) and of
+//                   the DBI stream (stream 3), read at once
+//
+// The age is the one of the DBI header, as returned by DIA and used
+// in the symbol store paths. It can differ from the age of the info
+// stream, which is used only if the PDB has no DBI stream.
+//
+// The latency of one file is the sum of 4 - 5 reads, the scanner
+// therefore keeps MaximumFileCount files in flight and advances
+// the state of each file when all reads of its stage are completed.
+//
+// Reads are overlapped and completed through the I/O completion
+// port drained by the worker threads. If the port cannot be created
+// (or UseCompletionPort is false), worker threads scan one file
+// at a time by blocking reads.
+//
+class PDBIdentityScanner
+{
+	public:
+		struct Settings
+		{
+			//
+			// Count of worker threads, 0 means count of CPUs.
+			//
+			DWORD ThreadCount = 0;
+
+			//
+			// Count of files with reads in flight.
+			//
+			DWORD MaximumFileCount = 256;
+
+			bool UseCompletionPort = true;
+		};
+
+		enum class Status
+		{
+			Ok,
+			CannotOpen,
+			ReadError,
+			NotMsf,
+			Corrupted,
+		};
+
+		struct Identity
+		{
+			Status Result = Status::ReadError;
+
+			GUID Guid = {};
+
+			//
+			// Age of the DBI stream.
+			//
+			DWORD Age = 0;
+			DWORD Signature = 0;
+			DWORD Version = 0;
+		};
+
+		struct Statistics
+		{
+			size_t FileCount = 0;
+			size_t ReadCount = 0;
+			ULONGLONG ByteCount = 0;
+			double Seconds = 0;
+
+			//
+			// False if the blocking reads were used.
+			//
+			bool UsedCompletionPort = false;
+		};
+
+		PDBIdentityScanner(
+			Settings* ScannerSettings = nullptr
+			);
+
+		//
+		// Identities[i] is the identity of Paths[i].
+		//
+		Statistics
+		Scan(
+			const std::vector<std::string>& Paths,
+			std::vector<Identity>& Identities
+			);
+
+		static
+		const char*
+		GetStatusString(
+			Status Result
+			);
+
+	private:
+		enum class Stage
+		{
+			SuperBlock,
+			BlockMap,
+			Directory,
+			DirectoryTail,
+			Streams,
+			Done,
+		};
+
+		struct FileScan;
+
+		struct Read
+			: OVERLAPPED
+		{
+			FileScan* Owner;
+			BYTE* Buffer;
+			DWORD Size;
+			DWORD BytesRead;
+
+			//
+			// GetLastError() of the failed read, reads which end
+			// at the end of the file are short, not failed.
+			//
+			DWORD Error;
+		};
+
+		struct FileScan
+		{
+			Identity* Result;
+			HANDLE File;
+			Stage CurrentStage;
+
+			//
+			// Reads of the current stage, all of them are issued at once.
+			//
+			std::vector<Read> Reads;
+			volatile LONG PendingReadCount;
+
+			DWORD BlockSize;
+			DWORD BlockCount;
+			DWORD DirectorySize;
+
+			std::vector<DWORD> DirectoryBlocks;
+			std::vector<BYTE> Directory;
+
+			//
+			// Offsets of the first blocks of stream 1 and stream 3
+			// in the directory, DbiStreamBlockOffset is 0 if the PDB
+			// has no DBI stream.
+			//
+			DWORD InfoStreamBlockOffset;
+			DWORD DbiStreamBlockOffset;
+
+			BYTE Header[64];
+			BYTE DbiHeader[12];
+		};
+
+		//
+		// Prepares reads of the first stage.
+		//
+		static
+		void
+		Start(
+			FileScan& Scan
+			);
+
+		//
+		// Parses data of the completed stage and prepares reads
+		// of the next one. Returns false when the scan of the file
+		// is finished (Result is set).
+		//
+		static
+		bool
+		Advance(
+			FileScan& Scan
+			);
+
+		static
+		void
+		AddRead(
+			FileScan& Scan,
+			ULONGLONG Offset,
+			BYTE* Buffer,
+			DWORD Size
+			);
+
+		//
+		// Prepares the reads of the headers of the info stream and
+		// of the DBI stream, the directory is read up to their blocks.
+		//
+		static
+		bool
+		ReadStreams(
+			FileScan& Scan
+			);
+
+		static
+		bool
+		Finish(
+			FileScan& Scan,
+			Status Result
+			);
+
+		void
+		ScanWithCompletionPort(
+			HANDLE CompletionPort,
+			const std::vector<std::string>& Paths,
+			std::vector<Identity>& Identities,
+			DWORD ThreadCount,
+			Statistics& Stats
+			);
+
+		void
+		ScanWithBlockingReads(
+			const std::vector<std::string>& Paths,
+			std::vector<Identity>& Identities,
+			DWORD ThreadCount,
+			Statistics& Stats
+			);
+
+	private:
+		Settings* m_Settings;
+};
@@ -0,0 +1,948 @@
+#include "PDBLayoutOptimizer.h"
+#include "PDBReconstructorBase.h"
+#include "PDBSymbolVisitor.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+	//
+	// Exhaustive search is used only when the count
+	// of movable blocks is below this limit.
+	//
+	static const size_t EXHAUSTIVE_SEARCH_LIMIT = 8;
+
+	//
+	// Name of the padding member which is appended
+	// by the PDB loader at the end of structures.
+	//
+	static const char PADDING_FIELD_NAME[] = "__PADDING__";
+
+	DWORD
+	AlignUp(
+		DWORD Value,
+		DWORD Alignment
+		)
+	{
+		return Alignment > 1
+			? (Value + Alignment - 1) / Alignment * Alignment
+			: Value;
+	}
+
+	//
+	// Reconstructor which does not print anything,
+	// it only records top-level layout units of the visited UDT.
+	//
+	// Nested anonymous unions/structs and runs of bitfields are
+	// detected by the PDBSymbolVisitor the same way as they
+	// are detected when the header is printed.
+	//
+
+	class LayoutUnitCollector
+		: public PDBReconstructorBase
+	{
+		public:
+			std::vector<PDBLayoutOptimizer::LayoutUnit> Units;
+
+		protected:
+			bool
+			OnUdt(
+				const SYMBOL* Symbol
+				) override
+			{
+				//
+				// Expand only the root UDT.
+				//
+
+				return m_Depth == 0;
+			}
+
+			void
+			OnUdtBegin(
+				const SYMBOL* Symbol
+				) override
+			{
+				m_Depth += 1;
+			}
+
+			void
+			OnUdtEnd(
+				const SYMBOL* Symbol
+				) override
+			{
+				m_Depth -= 1;
+			}
+
+			void
+			OnUdtField(
+				const SYMBOL_UDT_FIELD* UdtField,
+				UdtFieldDefinitionBase* MemberDefinition
+				) override
+			{
+				if (m_AnonymousUdtDepth == 0 && !m_InBitField)
+				{
+					AddUnit(UdtField, UdtField);
+				}
+			}
+
+			void
+			OnAnonymousUdtBegin(
+				UdtKind Kind,
+				const SYMBOL_UDT_FIELD* FirstUdtField
+				) override
+			{
+				m_AnonymousUdtDepth += 1;
+			}
+
+			void
+			OnAnonymousUdtEnd(
+				UdtKind Kind,
+				const SYMBOL_UDT_FIELD* FirstUdtField,
+				const SYMBOL_UDT_FIELD* LastUdtField,
+				DWORD Size
+				) override
+			{
+				if (--m_AnonymousUdtDepth == 0)
+				{
+					AddUnit(FirstUdtField, LastUdtField);
+				}
+			}
+
+			void
+			OnUdtFieldBitFieldBegin(
+				const SYMBOL_UDT_FIELD* FirstUdtFieldBitField,
+				const SYMBOL_UDT_FIELD* LastUdtFieldBitField
+				) override
+			{
+				if (m_AnonymousUdtDepth == 0)
+				{
+					m_InBitField = true;
+				}
+			}
+
+			void
+			OnUdtFieldBitFieldEnd(
+				const SYMBOL_UDT_FIELD* FirstUdtFieldBitField,
+				const SYMBOL_UDT_FIELD* LastUdtFieldBitField
+				) override
+			{
+				if (m_AnonymousUdtDepth == 0)
+				{
+					m_InBitField = false;
+					AddUnit(FirstUdtFieldBitField, LastUdtFieldBitField);
+				}
+			}
+
+		private:
+			void
+			AddUnit(
+				const SYMBOL_UDT_FIELD* FirstUdtField,
+				const SYMBOL_UDT_FIELD* LastUdtField
+				)
+			{
+				//
+				// Anonymous UDT may end with a member which is placed
+				// before its first member (union of structs).
+				//
+
+				if (LastUdtField < FirstUdtField)
+				{
+					std::swap(FirstUdtField, LastUdtField);
+				}
+
+				PDBLayoutOptimizer::LayoutUnit Unit;
+				Unit.FirstUdtField = FirstUdtField;
+				Unit.LastUdtField  = LastUdtField;
+				Unit.Offset        = FirstUdtField->Offset;
+				Unit.Size          = 0;
+				Unit.Alignment     = 1;
+				Unit.Group         = PDBLayoutOptimizer::LayoutUnit::None;
+				Unit.PinIndex      = PDBLayoutOptimizer::LayoutUnit::None;
+
+				Units.push_back(Unit);
+			}
+
+			DWORD m_Depth = 0;
+			DWORD m_AnonymousUdtDepth = 0;
+			bool m_InBitField = false;
+	};
+}
+
+PDBLayoutOptimizer::PDBLayoutOptimizer(
+	Settings* OptimizerSettings
+	)
+{
+	static Settings DefaultSettings;
+
+	if (OptimizerSettings == nullptr)
+	{
+		OptimizerSettings = &DefaultSettings;
+	}
+
+	m_Settings = OptimizerSettings;
+}
+
+bool
+PDBLayoutOptimizer::Optimize(
+	const SYMBOL* Symbol,
+	Result& OptimizeResult
+	)
+{
+	//
+	// Reordering of unions does not make sense.
+	//
+
+	if (Symbol->Tag != SymTagUDT ||
+	    Symbol->u.Udt.Kind == UdtUnion ||
+	    Symbol->u.Udt.FieldCount == 0 ||
+	    Symbol->Size == 0)
+	{
+		return false;
+	}
+
+	OptimizeResult = Result();
+	OptimizeResult.Symbol = Symbol;
+
+	CollectLayoutUnits(Symbol, OptimizeResult.Units);
+
+	if (OptimizeResult.Units.empty())
+	{
+		return false;
+	}
+
+	OptimizeResult.IsConstrained = ApplyConstraints(OptimizeResult.Units);
+	EvaluateOriginalLayout(Symbol, OptimizeResult.Units, OptimizeResult.Original);
+
+	std::vector<Block> Blocks;
+	BuildBlocks(OptimizeResult.Units, Blocks);
+
+	//
+	// Pinned blocks go first, in the order they were specified.
+	// The rest of blocks is sorted by the alignment and the size,
+	// which gives a good starting point for the search.
+	//
+
+	BlockList Order;
+	for (auto&& B : Blocks)
+	{
+		Order.push_back(&B);
+	}
+
+	std::stable_sort(Order.begin(), Order.end(), [](const Block* Lhs, const Block* Rhs) {
+		if (Lhs->PinIndex != Rhs->PinIndex)
+		{
+			return Lhs->PinIndex < Rhs->PinIndex;
+		}
+
+		if (Lhs->Alignment != Rhs->Alignment)
+		{
+			return Lhs->Alignment > Rhs->Alignment;
+		}
+
+		return Lhs->Size > Rhs->Size;
+	});
+
+	size_t FirstMovableBlock = 0;
+	while (FirstMovableBlock < Order.size() &&
+	       Order[FirstMovableBlock]->PinIndex != LayoutUnit::None)
+	{
+		FirstMovableBlock += 1;
+	}
+
+	//
+	// Zero-sized members (zero-length arrays) must stay
+	// at the end of the structure.
+	//
+
+	BlockList TailBlocks;
+	for (auto It = Order.begin() + FirstMovableBlock; It != Order.end(); )
+	{
+		if ((*It)->Size == 0)
+		{
+			TailBlocks.push_back(*It);
+			It = Order.erase(It);
+		}
+		else
+		{
+			++It;
+		}
+	}
+
+	BlockList BestOrder = Order;
+	Layout& BestLayout = OptimizeResult.Optimized;
+	EvaluateLayout(BestOrder, BestLayout);
+
+	if (Order.size() - FirstMovableBlock <= EXHAUSTIVE_SEARCH_LIMIT)
+	{
+		SearchExhaustive(Order, FirstMovableBlock, BestOrder, BestLayout);
+	}
+	else
+	{
+		SearchGreedy(Order, FirstMovableBlock, BestOrder, BestLayout);
+		ImproveBySwapping(BestOrder, FirstMovableBlock, BestLayout);
+	}
+
+	if (!TailBlocks.empty())
+	{
+		BestOrder.insert(BestOrder.end(), TailBlocks.begin(), TailBlocks.end());
+		EvaluateLayout(BestOrder, BestLayout);
+	}
+
+	//
+	// Do not suggest a layout which is not better than the original one,
+	// unless the user asked for pinned or grouped fields.
+	//
+
+	if (!OptimizeResult.IsConstrained && !IsBetterLayout(BestLayout, OptimizeResult.Original))
+	{
+		BestLayout = OptimizeResult.Original;
+	}
+
+	return true;
+}
+
+SYMBOL*
+PDBLayoutOptimizer::CreateReorderedSymbol(
+	const Result& OptimizeResult
+	)
+{
+	const SYMBOL* Symbol = OptimizeResult.Symbol;
+	const Layout& OptimizedLayout = OptimizeResult.Optimized;
+
+	SYMBOL* ReorderedSymbol = new SYMBOL(*Symbol);
+	ReorderedSymbol->Size = OptimizedLayout.Size;
+
+	//
+	// Reserve one more field for the padding at the end of the structure.
+	//
+
+	DWORD FieldCount = 0;
+	for (auto&& Unit : OptimizedLayout.Units)
+	{
+		FieldCount += static_cast<DWORD>(Unit->LastUdtField - Unit->FirstUdtField + 1);
+	}
+
+	SYMBOL_UDT_FIELD* Fields = new SYMBOL_UDT_FIELD[FieldCount + 1];
+	SYMBOL_UDT_FIELD* Field = Fields;
+	DWORD EndOfLastField = 0;
+
+	for (size_t i = 0; i < OptimizedLayout.Units.size(); i++)
+	{
+		const LayoutUnit* Unit = OptimizedLayout.Units[i];
+		DWORD NewOffset = OptimizedLayout.Offsets[i];
+
+		for (const SYMBOL_UDT_FIELD* UdtField = Unit->FirstUdtField;
+		     UdtField <= Unit->LastUdtField;
+		     UdtField++, Field++)
+		{
+			*Field = *UdtField;
+			Field->Offset = UdtField->Offset - Unit->Offset + NewOffset;
+			Field->Parent = ReorderedSymbol;
+		}
+
+		EndOfLastField = (std::max)(EndOfLastField, NewOffset + Unit->Size);
+	}
+
+	if (EndOfLastField < ReorderedSymbol->Size)
+	{
+		//
+		// Fill the space at the end of the structure the same way
+		// the PDB loader does.
+		//
+
+		DWORD PaddingSize = ReorderedSymbol->Size - EndOfLastField;
+
+		SYMBOL* PaddingSymbolArrayElement = new SYMBOL();
+		PaddingSymbolArrayElement->Tag = SymTagBaseType;
+		PaddingSymbolArrayElement->BaseType = btChar;
+		PaddingSymbolArrayElement->Size = 1;
+
+		SYMBOL* PaddingSymbolArray = new SYMBOL();
+		PaddingSymbolArray->Tag = SymTagArrayType;
+		PaddingSymbolArray->BaseType = btNoType;
+		PaddingSymbolArray->Size = PaddingSize;
+		PaddingSymbolArray->u.Array.ElementType = PaddingSymbolArrayElement;
+		PaddingSymbolArray->u.Array.ElementCount = PaddingSize;
+
+		Field->Name = const_cast<CHAR*>(PADDING_FIELD_NAME);
+		Field->Type = PaddingSymbolArray;
+		Field->Offset = EndOfLastField;
+		Field->Bits = 0;
+		Field->BitPosition = 0;
+		Field->Parent = ReorderedSymbol;
+
+		FieldCount += 1;
+	}
+
+	ReorderedSymbol->u.Udt.Fields = Fields;
+	ReorderedSymbol->u.Udt.FieldCount = FieldCount;
+
+	return ReorderedSymbol;
+}
+
+void
+PDBLayoutOptimizer::DestroyReorderedSymbol(
+	SYMBOL* Symbol
+	)
+{
+	//
+	// Field names and types are borrowed from the original symbol,
+	// except the padding member we have created.
+	//
+
+	SYMBOL_UDT_FIELD* LastUdtField = &Symbol->u.Udt.Fields[Symbol->u.Udt.FieldCount - 1];
+
+	if (LastUdtField->Name == PADDING_FIELD_NAME)
+	{
+		delete LastUdtField->Type->u.Array.ElementType;
+		delete LastUdtField->Type;
+	}
+
+	delete[] Symbol->u.Udt.Fields;
+	delete Symbol;
+}
+
+DWORD
+PDBLayoutOptimizer::GetAlignment(
+	const SYMBOL* Symbol
+	)
+{
+	switch (Symbol->Tag)
+	{
+		case SymTagBaseType:
+		case SymTagEnum:
+		case SymTagPointerType:
+		{
+			//
+			// Natural alignment is the biggest power of 2
+			// which divides the size (80-bit floats are aligned to 2).
+			//
+
+			DWORD Alignment = 1;
+			while (Alignment < 8 && Symbol->Size % (Alignment * 2) == 0)
+			{
+				Alignment *= 2;
+			}
+
+			return Alignment;
+		}
+
+		case SymTagTypedef:
+			return GetAlignment(Symbol->u.Typedef.Type);
+
+		case SymTagArrayType:
+			return GetAlignment(Symbol->u.Array.ElementType);
+
+		case SymTagUDT:
+		{
+			auto AlignmentIt = m_UdtAlignments.find(Symbol);
+			if (AlignmentIt != m_UdtAlignments.end())
+			{
+				return AlignmentIt->second;
+			}
+
+			//
+			// Prevent infinite recursion on malformed PDBs.
+			//
+
+			m_UdtAlignments[Symbol] = 1;
+
+			DWORD Alignment = 1;
+			for (DWORD i = 0; i < Symbol->u.Udt.FieldCount; i++)
+			{
+				Alignment = (std::max)(Alignment, GetAlignment(Symbol->u.Udt.Fields[i].Type));
+			}
+
+			//
+			// Natural alignment is only the upper bound, #pragma pack
+			// (common in Windows headers) lowers it.
+			//
+
+			while (Alignment > 1 && !IsPackedTo(Symbol, Alignment))
+			{
+				Alignment /= 2;
+			}
+
+			m_UdtAlignments[Symbol] = Alignment;
+			return Alignment;
+		}
+
+		default:
+			return 1;
+	}
+}
+
+void
+PDBLayoutOptimizer::CollectLayoutUnits(
+	const SYMBOL* Symbol,
+	std::vector<LayoutUnit>& Units
+	)
+{
+	LayoutUnitCollector Collector;
+	PDBSymbolVisitor<UdtFieldDefinitionBase> Visitor(&Collector);
+	Visitor.Run(Symbol);
+
+	//
+	// Fields of packed structures are aligned
+	// at most to the alignment of the structure.
+	//
+
+	DWORD MaximumAlignment = GetAlignment(Symbol);
+
+	//
+	// Compute sizes and alignments of the collected units
+	// and merge units which overlap each other.
+	// That may happen when the heuristics of the visitor
+	// do not recognize the whole anonymous union.
+	//
+
+	for (auto&& Unit : Collector.Units)
+	{
+		DWORD EndOfUnit = Unit.Offset;
+
+		for (const SYMBOL_UDT_FIELD* UdtField = Unit.FirstUdtField;
+		     UdtField <= Unit.LastUdtField;
+		     UdtField++)
+		{
+			Unit.Offset = (std::min)(Unit.Offset, UdtField->Offset);
+			EndOfUnit = (std::max)(EndOfUnit, UdtField->Offset + UdtField->Type->Size);
+			Unit.Alignment = (std::max)(Unit.Alignment, GetAlignment(UdtField->Type));
+		}
+
+		Unit.Alignment = (std::min)(Unit.Alignment, MaximumAlignment);
+
+		Unit.Size = EndOfUnit - Unit.Offset;
+
+		if (!Units.empty() &&
+		     Units.back().Offset + Units.back().Size > Unit.Offset)
+		{
+			LayoutUnit& PreviousUnit = Units.back();
+			DWORD EndOfPreviousUnit = PreviousUnit.Offset + PreviousUnit.Size;
+
+			PreviousUnit.LastUdtField = Unit.LastUdtField;
+			PreviousUnit.Size = (std::max)(EndOfPreviousUnit, EndOfUnit) - PreviousUnit.Offset;
+			PreviousUnit.Alignment = (std::max)(PreviousUnit.Alignment, Unit.Alignment);
+		}
+		else
+		{
+			Units.push_back(Unit);
+		}
+	}
+
+	//
+	// The padding member at the end of the structure is not a real field.
+	//
+
+	if (!Units.empty() &&
+	     Units.back().FirstUdtField == Units.back().LastUdtField &&
+	     Units.back().FirstUdtField->Name != nullptr &&
+	     strcmp(Units.back().FirstUdtField->Name, PADDING_FIELD_NAME) == 0)
+	{
+		Units.pop_back();
+	}
+}
+
+bool
+PDBLayoutOptimizer::ApplyConstraints(
+	std::vector<LayoutUnit>& Units
+	)
+{
+	bool IsConstrained = false;
+
+	auto FindUnit = [&Units](const std::string& FieldName) -> LayoutUnit* {
+		for (auto&& Unit : Units)
+		{
+			for (const SYMBOL_UDT_FIELD* UdtField = Unit.FirstUdtField;
+			     UdtField <= Unit.LastUdtField;
+			     UdtField++)
+			{
+				if (UdtField->Name != nullptr && FieldName == UdtField->Name)
+				{
+					return &Unit;
+				}
+			}
+		}
+
+		return nullptr;
+	};
+
+	DWORD PinIndex = 0;
+	for (auto&& FieldName : m_Settings->PinnedFields)
+	{
+		LayoutUnit* Unit = FindUnit(FieldName);
+
+		if (Unit != nullptr && Unit->PinIndex == LayoutUnit::None)
+		{
+			Unit->PinIndex = PinIndex++;
+			IsConstrained = true;
+		}
+	}
+
+	DWORD GroupIndex = 0;
+	for (auto&& FieldGroup : m_Settings->FieldGroups)
+	{
+		for (auto&& FieldName : FieldGroup)
+		{
+			LayoutUnit* Unit = FindUnit(FieldName);
+
+			if (Unit != nullptr && Unit->PinIndex == LayoutUnit::None)
+			{
+				Unit->Group = GroupIndex;
+				IsConstrained = true;
+			}
+		}
+
+		GroupIndex += 1;
+	}
+
+	return IsConstrained;
+}
+
+bool
+PDBLayoutOptimizer::IsPackedTo(
+	const SYMBOL* Symbol,
+	DWORD Alignment
+	)
+{
+	//
+	// With #pragma pack(Alignment), every field is aligned to the smaller
+	// of its own alignment and Alignment, and so is the size.
+	//
+
+	if (Symbol->Size % Alignment != 0)
+	{
+		return false;
+	}
+
+	for (DWORD i = 0; i < Symbol->u.Udt.FieldCount; i++)
+	{
+		const SYMBOL_UDT_FIELD* UdtField = &Symbol->u.Udt.Fields[i];
+		DWORD FieldAlignment = (std::min)(Alignment, GetAlignment(UdtField->Type));
+
+		if (UdtField->Offset % FieldAlignment != 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void
+PDBLayoutOptimizer::BuildBlocks(
+	const std::vector<LayoutUnit>& Units,
+	std::vector<Block>& Blocks
+	) const
+{
+	std::map<DWORD, size_t> GroupBlocks;
+
+	//
+	// Blocks vector must not reallocate after pointers
+	// to its elements are taken.
+	//
+
+	Blocks.reserve(Units.size());
+
+	for (auto&& Unit : Units)
+	{
+		Block* B;
+
+		if (Unit.Group != LayoutUnit::None &&
+		    GroupBlocks.find(Unit.Group) != GroupBlocks.end())
+		{
+			B = &Blocks[GroupBlocks[Unit.Group]];
+		}
+		else
+		{
+			Blocks.emplace_back();
+			B = &Blocks.back();
+			B->PinIndex = Unit.PinIndex;
+
+			if (Unit.Group != LayoutUnit::None)
+			{
+				GroupBlocks[Unit.Group] = Blocks.size() - 1;
+			}
+		}
+
+		B->Units.push_back(&Unit);
+	}
+
+	for (auto&& B : Blocks)
+	{
+		//
+		// Units inside of the group are sorted by the alignment,
+		// so the group itself contains as few holes as possible.
+		//
+
+		std::stable_sort(B.Units.begin(), B.Units.end(), [](const LayoutUnit* Lhs, const LayoutUnit* Rhs) {
+			return Lhs->Alignment > Rhs->Alignment;
+		});
+
+		DWORD Offset = 0;
+		for (auto&& Unit : B.Units)
+		{
+			Offset = AlignUp(Offset, Unit->Alignment) + Unit->Size;
+			B.Alignment = (std::max)(B.Alignment, Unit->Alignment);
+		}
+
+		B.Size = Offset;
+		B.KeepOnOneLine = B.Units.size() > 1 && B.Size <= m_Settings->CacheLineSize;
+	}
+}
+
+void
+PDBLayoutOptimizer::EvaluateLayout(
+	const BlockList& Order,
+	Layout& UnitLayout
+	) const
+{
+	const DWORD CacheLineSize = m_Settings->CacheLineSize;
+
+	UnitLayout.Units.clear();
+	UnitLayout.Offsets.clear();
+	UnitLayout.CacheLineSplits = 0;
+
+	DWORD Offset = 0;
+	DWORD Alignment = 1;
+	DWORD UsedSize = 0;
+
+	for (auto&& B : Order)
+	{
+		Offset = AlignUp(Offset, B->Alignment);
+
+		if (B->KeepOnOneLine &&
+		    Offset / CacheLineSize != (Offset + B->Size - 1) / CacheLineSize)
+		{
+			Offset = AlignUp(Offset, CacheLineSize);
+		}
+
+		for (auto&& Unit : B->Units)
+		{
+			Offset = AlignUp(Offset, Unit->Alignment);
+
+			UnitLayout.Units.push_back(Unit);
+			UnitLayout.Offsets.push_back(Offset);
+
+			if (Unit->Size > 0 &&
+			    Unit->Size <= CacheLineSize &&
+			    Offset / CacheLineSize != (Offset + Unit->Size - 1) / CacheLineSize)
+			{
+				UnitLayout.CacheLineSplits += 1;
+			}
+
+			Offset += Unit->Size;
+			UsedSize += Unit->Size;
+		}
+
+		Alignment = (std::max)(Alignment, B->Alignment);
+	}
+
+	UnitLayout.Size = AlignUp(Offset, Alignment);
+	UnitLayout.PaddingSize = UnitLayout.Size - UsedSize;
+	UnitLayout.CacheLineCount = (UnitLayout.Size + CacheLineSize - 1) / CacheLineSize;
+}
+
+void
+PDBLayoutOptimizer::EvaluateOriginalLayout(
+	const SYMBOL* Symbol,
+	const std::vector<LayoutUnit>& Units,
+	Layout& UnitLayout
+	) const
+{
+	const DWORD CacheLineSize = m_Settings->CacheLineSize;
+
+	DWORD UsedSize = 0;
+
+	for (auto&& Unit : Units)
+	{
+		UnitLayout.Units.push_back(&Unit);
+		UnitLayout.Offsets.push_back(Unit.Offset);
+
+		if (Unit.Size > 0 &&
+		    Unit.Size <= CacheLineSize &&
+		    Unit.Offset / CacheLineSize != (Unit.Offset + Unit.Size - 1) / CacheLineSize)
+		{
+			UnitLayout.CacheLineSplits += 1;
+		}
+
+		UsedSize += Unit.Size;
+	}
+
+	UnitLayout.Size = Symbol->Size;
+	UnitLayout.PaddingSize = Symbol->Size > UsedSize ? Symbol->Size - UsedSize : 0;
+	UnitLayout.CacheLineCount = (UnitLayout.Size + CacheLineSize - 1) / CacheLineSize;
+}
+
+bool
+PDBLayoutOptimizer::IsBetterLayout(
+	const Layout& Lhs,
+	const Layout& Rhs
+	) const
+{
+	//
+	// Size has the priority - smaller structures
+	// occupy less cache lines in arrays and allocations.
+	//
+
+	if (Lhs.Size != Rhs.Size)
+	{
+		return Lhs.Size < Rhs.Size;
+	}
+
+	return Lhs.CacheLineSplits < Rhs.CacheLineSplits;
+}
+
+void
+PDBLayoutOptimizer::SearchExhaustive(
+	BlockList& Order,
+	size_t FirstMovableBlock,
+	BlockList& BestOrder,
+	Layout& BestLayout
+	) const
+{
+	//
+	// Try all permutations of movable blocks.
+	// std::next_permutation needs the range to be sorted first.
+	//
+
+	auto First = Order.begin() + FirstMovableBlock;
+	std::sort(First, Order.end());
+
+	Layout CurrentLayout;
+
+	do
+	{
+		EvaluateLayout(Order, CurrentLayout);
+
+		if (IsBetterLayout(CurrentLayout, BestLayout))
+		{
+			BestLayout = CurrentLayout;
+			BestOrder = Order;
+		}
+	} while (std::next_permutation(First, Order.end()));
+}
+
+void
+PDBLayoutOptimizer::SearchGreedy(
+	BlockList& Order,
+	size_t FirstMovableBlock,
+	BlockList& BestOrder,
+	Layout& BestLayout
+	) const
+{
+	//
+	// Build the layout block by block. At each step, pick the block
+	// which introduces the least padding and does not straddle
+	// a cache line. Ties are resolved in favor of the initial order
+	// (bigger alignment first).
+	//
+
+	const DWORD CacheLineSize = m_Settings->CacheLineSize;
+
+	BlockList Remaining(Order.begin() + FirstMovableBlock, Order.end());
+	BlockList GreedyOrder(Order.begin(), Order.begin() + FirstMovableBlock);
+
+	Layout CurrentLayout;
+	EvaluateLayout(GreedyOrder, CurrentLayout);
+
+	DWORD Offset = 0;
+	if (!CurrentLayout.Units.empty())
+	{
+		Offset = CurrentLayout.Offsets.back() + CurrentLayout.Units.back()->Size;
+	}
+
+	while (!Remaining.empty())
+	{
+		size_t BestIndex = 0;
+		DWORD BestPadding = (DWORD)-1;
+		bool BestSplits = true;
+
+		for (size_t i = 0; i < Remaining.size(); i++)
+		{
+			const Block* B = Remaining[i];
+
+			DWORD Start = AlignUp(Offset, B->Alignment);
+			DWORD Padding = Start - Offset;
+			bool Splits =
+				B->Size <= CacheLineSize &&
+				Start / CacheLineSize != (Start + B->Size - 1) / CacheLineSize;
+
+			if (Padding < BestPadding ||
+			   (Padding == BestPadding && BestSplits && !Splits))
+			{
+				BestIndex = i;
+				BestPadding = Padding;
+				BestSplits = Splits;
+			}
+		}
+
+		const Block* B = Remaining[BestIndex];
+		Remaining.erase(Remaining.begin() + BestIndex);
+		GreedyOrder.push_back(B);
+
+		Offset = AlignUp(Offset, B->Alignment);
+		if (B->KeepOnOneLine && Offset / CacheLineSize != (Offset + B->Size - 1) / CacheLineSize)
+		{
+			Offset = AlignUp(Offset, CacheLineSize);
+		}
+
+		Offset += B->Size;
+	}
+
+	EvaluateLayout(GreedyOrder, CurrentLayout);
+
+	if (IsBetterLayout(CurrentLayout, BestLayout))
+	{
+		BestLayout = CurrentLayout;
+		BestOrder = GreedyOrder;
+	}
+}
+
+void
+PDBLayoutOptimizer::ImproveBySwapping(
+	BlockList& Order,
+	size_t FirstMovableBlock,
+	Layout& BestLayout
+	) const
+{
+	//
+	// Local search - swap pairs of blocks as long as it improves the layout.
+	// The count of rounds is bounded, because each round is O(n^3).
+	//
+
+	static const int MAXIMUM_ROUNDS = 4;
+
+	Layout CurrentLayout;
+
+	for (int Round = 0; Round < MAXIMUM_ROUNDS; Round++)
+	{
+		bool Improved = false;
+
+		for (size_t i = FirstMovableBlock; i < Order.size(); i++)
+		{
+			for (size_t j = i + 1; j < Order.size(); j++)
+			{
+				std::swap(Order[i], Order[j]);
+				EvaluateLayout(Order, CurrentLayout);
+
+				if (IsBetterLayout(CurrentLayout, BestLayout))
+				{
+					BestLayout = CurrentLayout;
+					Improved = true;
+				}
+				else
+				{
+					std::swap(Order[i], Order[j]);
+				}
+			}
+		}
+
+		if (!Improved)
+		{
+			break;
+		}
+	}
+
+	EvaluateLayout(Order, BestLayout);
+}
@@ -0,0 +1,250 @@
+#pragma once
+#include "PDB.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+class PDBLayoutOptimizer
+{
+	public:
+		struct Settings
+		{
+			//
+			// Size of the cache line in bytes.
+			//
+			DWORD CacheLineSize = 64;
+
+			//
+			// Fields which will be placed at the beginning
+			// of the structure, in the specified order.
+			//
+			std::vector<std::string> PinnedFields;
+
+			//
+			// Groups of fields which should be placed together
+			// on one cache line.
+			//
+			std::vector<std::vector<std::string>> FieldGroups;
+		};
+
+		//
+		// Layout unit is the smallest piece of the UDT which can be moved
+		// without breaking its meaning - a single field, a run of bitfields
+		// sharing one storage unit or a whole anonymous union/struct.
+		//
+		struct LayoutUnit
+		{
+			//
+			// First and last field of this unit in the original UDT.
+			//
+			const SYMBOL_UDT_FIELD* FirstUdtField;
+			const SYMBOL_UDT_FIELD* LastUdtField;
+
+			//
+			// Offset of the unit in the original UDT.
+			//
+			DWORD Offset;
+
+			DWORD Size;
+			DWORD Alignment;
+
+			//
+			// Units of one group are placed next to each other
+			// and they are not allowed to straddle a cache line.
+			//
+			DWORD Group;
+
+			//
+			// Units which are pinned are placed first.
+			//
+			DWORD PinIndex;
+
+			static const DWORD None = (DWORD)-1;
+		};
+
+		struct Layout
+		{
+			//
+			// Units in the order in which they are placed
+			// and their offsets in the UDT.
+			//
+			std::vector<const LayoutUnit*> Units;
+			std::vector<DWORD> Offsets;
+
+			DWORD Size = 0;
+			DWORD PaddingSize = 0;
+
+			//
+			// Count of cache lines the UDT occupies.
+			//
+			DWORD CacheLineCount = 0;
+
+			//
+			// Count of units which straddle a cache line boundary.
+			//
+			DWORD CacheLineSplits = 0;
+		};
+
+		struct Result
+		{
+			const SYMBOL* Symbol = nullptr;
+			std::vector<LayoutUnit> Units;
+			Layout Original;
+			Layout Optimized;
+
+			//
+			// Optimized layout honors pinned or grouped fields, it is kept
+			// even if it is worse than the original one.
+			//
+			bool IsConstrained = false;
+
+			int
+			GetSavedBytes() const
+			{
+				return (int)Original.Size - (int)Optimized.Size;
+			}
+
+			int
+			GetSavedSplits() const
+			{
+				return (int)Original.CacheLineSplits - (int)Optimized.CacheLineSplits;
+			}
+		};
+
+		PDBLayoutOptimizer(
+			Settings* OptimizerSettings = nullptr
+			);
+
+		//
+		// Searches for the order of fields which minimizes the padding
+		// and the count of cache line splits of the provided UDT.
+		//
+		// Returns false if the symbol cannot be reordered.
+		//
+		bool
+		Optimize(
+			const SYMBOL* Symbol,
+			Result& OptimizeResult
+			);
+
+		//
+		// Creates a copy of the optimized UDT with reordered fields.
+		// The returned symbol must be freed by DestroyReorderedSymbol().
+		//
+		SYMBOL*
+		CreateReorderedSymbol(
+			const Result& OptimizeResult
+			);
+
+		static
+		void
+		DestroyReorderedSymbol(
+			SYMBOL* Symbol
+			);
+
+		//
+		// Returns alignment of the provided type. Alignment of UDTs
+		// is lowered by #pragma pack to the biggest one which the offsets
+		// of their fields and their size respect.
+		//
+		DWORD
+		GetAlignment(
+			const SYMBOL* Symbol
+			);
+
+	private:
+		//
+		// Block is a sequence of units which is placed as a whole.
+		// It is either a single unit or all units of one group.
+		//
+		struct Block
+		{
+			std::vector<const LayoutUnit*> Units;
+
+			DWORD Size = 0;
+			DWORD Alignment = 1;
+			DWORD PinIndex = LayoutUnit::None;
+
+			//
+			// Groups are not allowed to straddle a cache line,
+			// if they fit into one.
+			//
+			bool KeepOnOneLine = false;
+		};
+
+		using BlockList = std::vector<const Block*>;
+
+		void
+		CollectLayoutUnits(
+			const SYMBOL* Symbol,
+			std::vector<LayoutUnit>& Units
+			);
+
+		bool
+		ApplyConstraints(
+			std::vector<LayoutUnit>& Units
+			);
+
+		bool
+		IsPackedTo(
+			const SYMBOL* Symbol,
+			DWORD Alignment
+			);
+
+		void
+		BuildBlocks(
+			const std::vector<LayoutUnit>& Units,
+			std::vector<Block>& Blocks
+			) const;
+
+		void
+		EvaluateLayout(
+			const BlockList& Order,
+			Layout& UnitLayout
+			) const;
+
+		void
+		EvaluateOriginalLayout(
+			const SYMBOL* Symbol,
+			const std::vector<LayoutUnit>& Units,
+			Layout& UnitLayout
+			) const;
+
+		bool
+		IsBetterLayout(
+			const Layout& Lhs,
+			const Layout& Rhs
+			) const;
+
+		void
+		SearchExhaustive(
+			BlockList& Order,
+			size_t FirstMovableBlock,
+			BlockList& BestOrder,
+			Layout& BestLayout
+			) const;
+
+		void
+		SearchGreedy(
+			BlockList& Order,
+			size_t FirstMovableBlock,
+			BlockList& BestOrder,
+			Layout& BestLayout
+			) const;
+
+		void
+		ImproveBySwapping(
+			BlockList& Order,
+			size_t FirstMovableBlock,
+			Layout& BestLayout
+			) const;
+
+	private:
+		Settings* m_Settings;
+
+		//
+		// Cache of computed alignments of UDTs.
+		//
+		std::map<const SYMBOL*, DWORD> m_UdtAlignments;
+};
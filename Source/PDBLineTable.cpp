@@ -0,0 +1,311 @@
+#include "PDBLineTable.h"
+#include "WorkerThreads.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+	//
+	// Smaller batches are not worth starting the threads.
+	//
+	static const size_t MINIMUM_THREAD_BATCH_SIZE = 64 * 1024;
+
+	static PDBLineTable::Settings DefaultSettings;
+
+	inline
+	int
+	HexDigitValue(
+		char Character
+		)
+	{
+		if (Character >= '0' && Character <= '9') return Character - '0';
+		if (Character >= 'a' && Character <= 'f') return Character - 'a' + 10;
+		if (Character >= 'A' && Character <= 'F') return Character - 'A' + 10;
+		return -1;
+	}
+
+	template <typename T>
+	bool
+	LoadHexValues(
+		const char* Path,
+		std::vector<T>& Addresses
+		)
+	{
+		std::ifstream AddressFile(Path, std::ios::in | std::ios::binary);
+
+		if (!AddressFile.is_open())
+		{
+			return false;
+		}
+
+		std::vector<char> Buffer(
+			(std::istreambuf_iterator<char>(AddressFile)),
+			std::istreambuf_iterator<char>()
+			);
+
+		const char* Position = Buffer.data();
+		const char* End = Buffer.data() + Buffer.size();
+
+		while (Position < End)
+		{
+			while (Position < End && (*Position == ' ' || *Position == '\t'))
+			{
+				Position++;
+			}
+
+			if (End - Position > 2 && Position[0] == '0' && (Position[1] == 'x' || Position[1] == 'X'))
+			{
+				Position += 2;
+			}
+
+			const char* Begin = Position;
+			ULONGLONG Value = 0;
+
+			for (; Position < End; Position++)
+			{
+				//
+				// Separator used by WinDbg.
+				//
+
+				if (*Position == '`')
+				{
+					continue;
+				}
+
+				int Digit = HexDigitValue(*Position);
+
+				if (Digit < 0)
+				{
+					break;
+				}
+
+				Value = (Value << 4) | static_cast<ULONGLONG>(Digit);
+			}
+
+			if (Position != Begin)
+			{
+				Addresses.push_back(static_cast<T>(Value));
+			}
+
+			//
+			// Skip the rest of the line (comments, carriage return).
+			//
+
+			while (Position < End && *Position++ != '\n')
+			{
+				;
+			}
+		}
+
+		return true;
+	}
+}
+
+const DWORD PDBLineTable::None;
+const size_t PDBLineTable::BLOCK_SIZE;
+
+PDBLineTable::PDBLineTable(
+	Settings* LineTableSettings
+	)
+{
+	m_Settings = LineTableSettings ? LineTableSettings : &DefaultSettings;
+}
+
+bool
+PDBLineTable::Build(
+	PDB* Pdb
+	)
+{
+	std::vector<SYMBOL_LINE> Lines;
+
+	if (!Pdb->GetLines(Lines, m_FileNames))
+	{
+		return false;
+	}
+
+	//
+	// Zero-length lines cover no code, they are removed first,
+	// so they cannot displace a real line of the same address.
+	// Lines of the same address (e.g. of inlined code
+	// in more modules) are kept only once.
+	//
+
+	Lines.erase(std::remove_if(Lines.begin(), Lines.end(), [](const SYMBOL_LINE& Line) {
+		return Line.Length == 0;
+	}), Lines.end());
+
+	std::stable_sort(Lines.begin(), Lines.end(), [](const SYMBOL_LINE& Left, const SYMBOL_LINE& Right) {
+		return Left.RelativeVirtualAddress < Right.RelativeVirtualAddress;
+	});
+
+	Lines.erase(std::unique(Lines.begin(), Lines.end(), [](const SYMBOL_LINE& Left, const SYMBOL_LINE& Right) {
+		return Left.RelativeVirtualAddress == Right.RelativeVirtualAddress;
+	}), Lines.end());
+
+	m_Addresses.clear();
+	m_Ends.clear();
+	m_LineNumbers.clear();
+	m_FileIndices.clear();
+	m_BlockAddresses.clear();
+
+	m_Addresses.reserve(Lines.size());
+	m_Ends.reserve(Lines.size());
+	m_LineNumbers.reserve(Lines.size());
+	m_FileIndices.reserve(Lines.size());
+
+	for (auto&& Line : Lines)
+	{
+		m_Addresses.push_back(Line.RelativeVirtualAddress);
+		m_Ends.push_back(Line.RelativeVirtualAddress + Line.Length);
+		m_LineNumbers.push_back(Line.LineNumber);
+		m_FileIndices.push_back(Line.FileIndex);
+	}
+
+	for (size_t Index = 0; Index < m_Addresses.size(); Index += BLOCK_SIZE)
+	{
+		m_BlockAddresses.push_back(m_Addresses[Index]);
+	}
+
+	return true;
+}
+
+PDBLineTable::Location
+PDBLineTable::Resolve(
+	DWORD Address
+	) const
+{
+	return GetLocation(FindLine(Address), Address);
+}
+
+void
+PDBLineTable::ResolveBatch(
+	const std::vector<DWORD>& Addresses,
+	std::vector<Location>& Locations
+	) const
+{
+	Locations.resize(Addresses.size());
+
+	//
+	// Sort the addresses together with their positions in the batch,
+	// one 64-bit key per address keeps the sort fast.
+	//
+
+	std::vector<ULONGLONG> Keys(Addresses.size());
+
+	for (size_t Index = 0; Index < Addresses.size(); Index++)
+	{
+		Keys[Index] = (static_cast<ULONGLONG>(Addresses[Index]) << 32) | Index;
+	}
+
+	std::sort(Keys.begin(), Keys.end());
+
+	DWORD ThreadCount = WorkerThreads::GetCount(m_Settings->ThreadCount);
+
+	ThreadCount = static_cast<DWORD>((std::min)(
+		static_cast<size_t>(ThreadCount),
+		Keys.size() / MINIMUM_THREAD_BATCH_SIZE + 1
+		));
+
+	//
+	// Every worker writes different Locations.
+	//
+
+	WorkerThreads::RunRanges(Keys.size(), ThreadCount, [this, &Keys, &Locations](DWORD, size_t Begin, size_t End) {
+		ResolveRange(Keys.data() + Begin, Keys.data() + End, Locations);
+	});
+}
+
+bool
+PDBLineTable::LoadAddresses(
+	const char* Path,
+	std::vector<DWORD>& Addresses
+	)
+{
+	return LoadHexValues(Path, Addresses);
+}
+
+bool
+PDBLineTable::LoadAddresses(
+	const char* Path,
+	std::vector<ULONGLONG>& Addresses
+	)
+{
+	return LoadHexValues(Path, Addresses);
+}
+
+DWORD
+PDBLineTable::FindLine(
+	DWORD Address
+	) const
+{
+	if (m_Addresses.empty() || Address < m_Addresses[0])
+	{
+		return None;
+	}
+
+	size_t Block = std::upper_bound(m_BlockAddresses.begin(), m_BlockAddresses.end(), Address) - m_BlockAddresses.begin() - 1;
+
+	auto Begin = m_Addresses.begin() + Block * BLOCK_SIZE;
+	auto End = m_Addresses.begin() + (std::min)((Block + 1) * BLOCK_SIZE, m_Addresses.size());
+
+	return static_cast<DWORD>(std::upper_bound(Begin, End, Address) - m_Addresses.begin() - 1);
+}
+
+PDBLineTable::Location
+PDBLineTable::GetLocation(
+	DWORD LineIndex,
+	DWORD Address
+	) const
+{
+	if (LineIndex == None || Address >= m_Ends[LineIndex])
+	{
+		return { None, 0, 0 };
+	}
+
+	return { m_FileIndices[LineIndex], m_LineNumbers[LineIndex], Address - m_Addresses[LineIndex] };
+}
+
+void
+PDBLineTable::ResolveRange(
+	const ULONGLONG* Begin,
+	const ULONGLONG* End,
+	std::vector<Location>& Locations
+	) const
+{
+	DWORD LineIndex = None;
+
+	for (const ULONGLONG* Key = Begin; Key != End; Key++)
+	{
+		DWORD Address = static_cast<DWORD>(*Key >> 32);
+		size_t Index = static_cast<size_t>(*Key & 0xFFFFFFFF);
+
+		if (LineIndex == None)
+		{
+			LineIndex = FindLine(Address);
+		}
+		else
+		{
+			//
+			// Addresses are sorted, gallop forward from the previous
+			// line and finish by the binary search of the last step.
+			//
+
+			size_t Low = LineIndex;
+			size_t Step = 1;
+
+			while (Low + Step < m_Addresses.size() && m_Addresses[Low + Step] <= Address)
+			{
+				Low += Step;
+				Step *= 2;
+			}
+
+			auto High = m_Addresses.begin() + (std::min)(Low + Step, m_Addresses.size());
+
+			LineIndex = static_cast<DWORD>(std::upper_bound(m_Addresses.begin() + Low, High, Address) - m_Addresses.begin() - 1);
+		}
+
+		Locations[Index] = GetLocation(LineIndex, Address);
+	}
+}
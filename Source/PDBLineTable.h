@@ -0,0 +1,151 @@
+#pragma once
+#include "PDB.h"
+
+#include <string>
+#include <vector>
+
+//
+// Sorted index of the line records of all modules,
+// resolves relative virtual addresses to file:line.
+//
+// Line records are stored in parallel arrays sorted by the address:
+//
+//   m_Addresses     first byte of the code of the line
+//   m_Ends          first byte after the code of the line
+//   m_LineNumbers
+//   m_FileIndices   index into the interned file names
+//
+// The address is resolved in two steps: the top-level array contains
+// every BLOCK_SIZE-th address (small enough to stay in the cache),
+// the second binary search is limited to one block of m_Addresses.
+//
+// Batches are sorted first and resolved by one forward sweep through
+// the arrays, the sorted batch is split between worker threads.
+//
+class PDBLineTable
+{
+	public:
+		struct Settings
+		{
+			//
+			// Count of worker threads, 0 means count of CPUs.
+			//
+			DWORD ThreadCount = 0;
+		};
+
+		struct Location
+		{
+			//
+			// None if the address is not covered by any line.
+			//
+			DWORD FileIndex;
+			DWORD LineNumber;
+
+			//
+			// Distance of the address from the beginning of the line.
+			//
+			DWORD Displacement;
+		};
+
+		static const DWORD None = static_cast<DWORD>(-1);
+
+		PDBLineTable(
+			Settings* LineTableSettings = nullptr
+			);
+
+		//
+		// Returns false if the PDB has no line information.
+		//
+		bool
+		Build(
+			PDB* Pdb
+			);
+
+		Location
+		Resolve(
+			DWORD Address
+			) const;
+
+		void
+		ResolveBatch(
+			const std::vector<DWORD>& Addresses,
+			std::vector<Location>& Locations
+			) const;
+
+		const std::string&
+		GetFileName(
+			DWORD FileIndex
+			) const
+		{
+			return m_FileNames[FileIndex];
+		}
+
+		size_t
+		GetLineCount() const
+		{
+			return m_Addresses.size();
+		}
+
+		//
+		// Reads hexadecimal addresses, one per line, with optional "0x"
+		// prefix (empty lines and lines starting with '#' are skipped).
+		//
+		// Returns false if the file cannot be opened.
+		//
+		static
+		bool
+		LoadAddresses(
+			const char* Path,
+			std::vector<DWORD>& Addresses
+			);
+
+		static
+		bool
+		LoadAddresses(
+			const char* Path,
+			std::vector<ULONGLONG>& Addresses
+			);
+
+	private:
+		static const size_t BLOCK_SIZE = 64;
+
+		//
+		// Returns index of the last line which starts at or before
+		// the Address, or None if there is no such line.
+		//
+		DWORD
+		FindLine(
+			DWORD Address
+			) const;
+
+		Location
+		GetLocation(
+			DWORD LineIndex,
+			DWORD Address
+			) const;
+
+		//
+		// Resolves sorted keys (address << 32 | index into Locations).
+		//
+		void
+		ResolveRange(
+			const ULONGLONG* Begin,
+			const ULONGLONG* End,
+			std::vector<Location>& Locations
+			) const;
+
+	private:
+		Settings* m_Settings;
+
+		std::vector<DWORD> m_Addresses;
+		std::vector<DWORD> m_Ends;
+		std::vector<DWORD> m_LineNumbers;
+		std::vector<DWORD> m_FileIndices;
+
+		//
+		// m_Addresses[0], m_Addresses[BLOCK_SIZE], ...
+		//
+		std::vector<DWORD> m_BlockAddresses;
+
+		std::vector<std::string> m_FileNames;
+};
@@ -0,0 +1,238 @@
+#include "PDBModuleMap.h"
+
+#include <cassert>
+#include <cctype>
+
+namespace
+{
+	static PDBModuleMap::Settings DefaultSettings;
+}
+
+PDBModuleMap::PDBModuleMap(
+	Settings* ModuleMapSettings
+	)
+{
+	m_Settings = ModuleMapSettings ? ModuleMapSettings : &DefaultSettings;
+}
+
+void
+PDBModuleMap::Build(
+	PDBSymbolSorter* SymbolSorter
+	)
+{
+	m_SymbolSorter = SymbolSorter;
+
+	m_Shards.clear();
+	m_SymbolShards.clear();
+
+	//
+	// Shards named after symbols must not collide
+	// with the umbrella and declarations headers.
+	//
+
+	std::set<std::string> UsedNames = {
+		m_Settings->ModuleName,
+		m_Settings->ModuleName + "_decls",
+	};
+
+	for (auto&& Symbol : SymbolSorter->GetSortedSymbols())
+	{
+		if (IsInlined(Symbol))
+		{
+			continue;
+		}
+
+		if (m_Settings->ShardPerSymbol)
+		{
+			m_Shards.emplace_back();
+			m_Shards.back().Name     = GetSymbolShardName(Symbol, UsedNames);
+			m_Shards.back().FileName = m_Shards.back().Name + ".h";
+		}
+		else if (m_Shards.empty() || m_Shards.back().Symbols.size() >= m_Settings->ShardSize)
+		{
+			char ShardNumber[16];
+			sprintf_s(ShardNumber, "%03u", static_cast<unsigned>(m_Shards.size()));
+
+			m_Shards.emplace_back();
+			m_Shards.back().Name     = std::string("shard_") + ShardNumber;
+			m_Shards.back().FileName = m_Settings->ModuleName + "_" + ShardNumber + ".h";
+		}
+
+		m_Shards.back().Symbols.push_back(Symbol);
+		m_SymbolShards[Symbol] = m_Shards.size() - 1;
+	}
+
+	for (size_t ShardIndex = 0; ShardIndex < m_Shards.size(); ShardIndex++)
+	{
+		for (auto&& Symbol : m_Shards[ShardIndex].Symbols)
+		{
+			AddDependencies(ShardIndex, Symbol);
+		}
+	}
+}
+
+std::string
+PDBModuleMap::GetDeclarationsFileName() const
+{
+	return m_Settings->ModuleName + "_decls.h";
+}
+
+std::string
+PDBModuleMap::GetUmbrellaFileName() const
+{
+	return m_Settings->ModuleName + ".h";
+}
+
+void
+PDBModuleMap::WriteShardPrologue(
+	std::ostream& OutputFile,
+	const Shard& CurrentShard
+	) const
+{
+	OutputFile << "#pragma once" << std::endl;
+	OutputFile << std::endl;
+	OutputFile << "#include \"" << GetDeclarationsFileName() << "\"" << std::endl;
+
+	for (auto&& ShardIndex : CurrentShard.Dependencies)
+	{
+		OutputFile << "#include \"" << m_Shards[ShardIndex].FileName << "\"" << std::endl;
+	}
+
+	OutputFile << std::endl;
+}
+
+void
+PDBModuleMap::WriteUmbrellaHeader(
+	std::ostream& OutputFile
+	) const
+{
+	OutputFile << "#pragma once" << std::endl;
+	OutputFile << std::endl;
+	OutputFile << "#include \"" << GetDeclarationsFileName() << "\"" << std::endl;
+
+	for (auto&& CurrentShard : m_Shards)
+	{
+		OutputFile << "#include \"" << CurrentShard.FileName << "\"" << std::endl;
+	}
+}
+
+void
+PDBModuleMap::WriteModuleMap(
+	std::ostream& OutputFile
+	) const
+{
+	//
+	// module ntkrnlmp {
+	//   header "ntkrnlmp.h"
+	//   export *
+	//
+	//   module decls {
+	//     header "ntkrnlmp_decls.h"
+	//     export *
+	//   }
+	//
+	//   module shard_000 {
+	//     header "ntkrnlmp_000.h"
+	//     export *
+	//   }
+	// }
+	//
+
+	OutputFile << "module " << m_Settings->ModuleName << " {" << std::endl;
+	OutputFile << "  header \"" << GetUmbrellaFileName() << "\"" << std::endl;
+	OutputFile << "  export *" << std::endl;
+	OutputFile << std::endl;
+	OutputFile << "  module decls {" << std::endl;
+	OutputFile << "    header \"" << GetDeclarationsFileName() << "\"" << std::endl;
+	OutputFile << "    export *" << std::endl;
+	OutputFile << "  }" << std::endl;
+
+	for (auto&& CurrentShard : m_Shards)
+	{
+		OutputFile << std::endl;
+		OutputFile << "  module " << CurrentShard.Name << " {" << std::endl;
+		OutputFile << "    header \"" << CurrentShard.FileName << "\"" << std::endl;
+		OutputFile << "    export *" << std::endl;
+		OutputFile << "  }" << std::endl;
+	}
+
+	OutputFile << "}" << std::endl;
+}
+
+std::string
+PDBModuleMap::GetModuleName(
+	const std::string& Name
+	)
+{
+	std::string ModuleName;
+
+	for (auto&& Character : Name)
+	{
+		ModuleName += isalnum(static_cast<unsigned char>(Character))
+			? Character
+			: '_';
+	}
+
+	if (ModuleName.empty() || isdigit(static_cast<unsigned char>(ModuleName[0])))
+	{
+		ModuleName = "_" + ModuleName;
+	}
+
+	return ModuleName;
+}
+
+std::string
+PDBModuleMap::GetSymbolShardName(
+	const SYMBOL* Symbol,
+	std::set<std::string>& UsedNames
+	) const
+{
+	std::string BaseName = GetModuleName(Symbol->Name ? Symbol->Name : "");
+	std::string Name = BaseName;
+
+	for (DWORD Suffix = 1; !UsedNames.insert(Name).second; Suffix++)
+	{
+		Name = BaseName + "_" + std::to_string(Suffix);
+	}
+
+	return Name;
+}
+
+bool
+PDBModuleMap::IsInlined(
+	const SYMBOL* Symbol
+	) const
+{
+	return m_Settings->InlineUnnamed &&
+	       (Symbol->Tag == SymTagEnum || Symbol->Tag == SymTagUDT) &&
+	       PDB::IsUnnamedSymbol(Symbol);
+}
+
+void
+PDBModuleMap::AddDependencies(
+	size_t ShardIndex,
+	const SYMBOL* Symbol
+	)
+{
+	for (auto&& Dependency : m_SymbolSorter->GetDependencies(Symbol))
+	{
+		//
+		// Dependencies of inlined types are dependencies
+		// of the type they are inlined in.
+		//
+
+		if (IsInlined(Dependency))
+		{
+			AddDependencies(ShardIndex, Dependency);
+			continue;
+		}
+
+		auto It = m_SymbolShards.find(Dependency);
+
+		if (It != m_SymbolShards.end() && It->second != ShardIndex)
+		{
+			assert(It->second < ShardIndex);
+			m_Shards[ShardIndex].Dependencies.insert(It->second);
+		}
+	}
+}
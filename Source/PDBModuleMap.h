@@ -0,0 +1,142 @@
+#pragma once
+#include "PDB.h"
+#include "PDBSymbolSorter.h"
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+//
+// Splits sorted symbols into shards - headers which can be compiled
+// once as Clang modules (module.modulemap) or C++20 header units.
+//
+// Shards are consecutive runs of PDBSymbolSorter::GetSortedSymbols(),
+// therefore every shard depends only on the preceding ones:
+//
+//   ntkrnlmp_decls.h    forward declarations of all UDTs
+//   ntkrnlmp_000.h      #include "ntkrnlmp_decls.h"
+//   ntkrnlmp_001.h      #include "ntkrnlmp_decls.h"
+//                       #include "ntkrnlmp_000.h"
+//   ...
+//   ntkrnlmp.h          umbrella header including all shards
+//   module.modulemap    module ntkrnlmp { module shard_000 { ... } ... }
+//
+class PDBModuleMap
+{
+	public:
+		struct Settings
+		{
+			//
+			// Name of the top-level module and prefix of the shard headers.
+			//
+			std::string ModuleName = "pdbex";
+
+			//
+			// Maximum count of symbols in one shard.
+			//
+			DWORD ShardSize = 256;
+
+			//
+			// Every symbol has its own shard named after the symbol
+			// (e.g. _EPROCESS.h), ShardSize is ignored.
+			//
+			bool ShardPerSymbol = false;
+
+			//
+			// Unnamed types are printed inside of their parents,
+			// therefore they do not belong to any shard.
+			//
+			bool InlineUnnamed = true;
+		};
+
+		struct Shard
+		{
+			std::string Name;
+			std::string FileName;
+
+			std::vector<const SYMBOL*> Symbols;
+
+			//
+			// Indices of the shards this shard depends on.
+			//
+			std::set<size_t> Dependencies;
+		};
+
+		PDBModuleMap(
+			Settings* ModuleMapSettings = nullptr
+			);
+
+		void
+		Build(
+			PDBSymbolSorter* SymbolSorter
+			);
+
+		const std::vector<Shard>&
+		GetShards() const
+		{
+			return m_Shards;
+		}
+
+		std::string
+		GetDeclarationsFileName() const;
+
+		std::string
+		GetUmbrellaFileName() const;
+
+		//
+		// Writes the includes which must precede definitions
+		// of the symbols of the shard.
+		//
+		void
+		WriteShardPrologue(
+			std::ostream& OutputFile,
+			const Shard& CurrentShard
+			) const;
+
+		void
+		WriteUmbrellaHeader(
+			std::ostream& OutputFile
+			) const;
+
+		void
+		WriteModuleMap(
+			std::ostream& OutputFile
+			) const;
+
+		//
+		// Replaces characters which are not allowed in module names.
+		//
+		static
+		std::string
+		GetModuleName(
+			const std::string& Name
+			);
+
+	private:
+		std::string
+		GetSymbolShardName(
+			const SYMBOL* Symbol,
+			std::set<std::string>& UsedNames
+			) const;
+
+		bool
+		IsInlined(
+			const SYMBOL* Symbol
+			) const;
+
+		void
+		AddDependencies(
+			size_t ShardIndex,
+			const SYMBOL* Symbol
+			);
+
+	private:
+		Settings* m_Settings;
+
+		PDBSymbolSorter* m_SymbolSorter = nullptr;
+
+		std::vector<Shard> m_Shards;
+		std::map<const SYMBOL*, size_t> m_SymbolShards;
+};
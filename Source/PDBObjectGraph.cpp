@@ -0,0 +1,234 @@
+#include "PDBObjectGraph.h"
+#include "WorkerThreads.h"
+
+#include <algorithm>
+
+namespace
+{
+	static PDBObjectGraph::Settings DefaultSettings;
+
+	//
+	// Levels are not split between threads below this count of objects.
+	//
+	static const DWORD MINIMUM_NODES_PER_THREAD = 256;
+
+	//
+	// Count of objects passed to MemoryImage::Prefetch at once.
+	//
+	static const DWORD PREFETCH_NODE_COUNT = 256;
+}
+
+PDBObjectGraph::PDBObjectGraph(
+	MemoryImage* Image,
+	Settings* GraphSettings
+	)
+{
+	m_Image = Image;
+	m_Settings = GraphSettings ? GraphSettings : &DefaultSettings;
+}
+
+bool
+PDBObjectGraph::AddRoot(
+	ULONGLONG Address,
+	const SYMBOL* Type
+	)
+{
+	PrepareType(Type);
+
+	if (!IsReadable(Address, Type))
+	{
+		return false;
+	}
+
+	if (m_Visited.find({ Address, Type }) == m_Visited.end())
+	{
+		AddNode(Address, Type, 0);
+	}
+
+	return true;
+}
+
+void
+PDBObjectGraph::Crawl()
+{
+	DWORD LevelBegin = 0;
+
+	while (LevelBegin < m_Nodes.size())
+	{
+		DWORD LevelEnd = static_cast<DWORD>(m_Nodes.size());
+
+		if (m_Nodes[LevelBegin].Depth >= m_Settings->MaximumDepth)
+		{
+			break;
+		}
+
+		DWORD ThreadCount = WorkerThreads::GetCount(m_Settings->ThreadCount);
+
+		ThreadCount = (std::max)((std::min)(ThreadCount, (LevelEnd - LevelBegin) / MINIMUM_NODES_PER_THREAD), 1u);
+
+		//
+		// Every thread expands a continuous range of the level,
+		// the visited set is not modified until all threads finish.
+		//
+
+		std::vector<std::vector<Target>> ThreadTargets(ThreadCount);
+
+		WorkerThreads::RunRanges(LevelEnd - LevelBegin, ThreadCount, [this, LevelBegin, &ThreadTargets](DWORD ThreadIndex, size_t RangeBegin, size_t RangeEnd) {
+			ExpandRange(LevelBegin + static_cast<DWORD>(RangeBegin), LevelBegin + static_cast<DWORD>(RangeEnd), ThreadTargets[ThreadIndex]);
+		});
+
+		DWORD Depth = m_Nodes[LevelBegin].Depth + 1;
+
+		for (auto&& Targets : ThreadTargets)
+		{
+			for (auto&& CurrentTarget : Targets)
+			{
+				auto VisitedIterator = m_Visited.find({ CurrentTarget.Address, CurrentTarget.Type });
+
+				if (VisitedIterator != m_Visited.end())
+				{
+					m_Edges.push_back({ CurrentTarget.From, VisitedIterator->second, CurrentTarget.FieldIndex });
+					continue;
+				}
+
+				if (m_Nodes.size() >= m_Settings->MaximumNodeCount)
+				{
+					m_Truncated = true;
+					continue;
+				}
+
+				PrepareType(CurrentTarget.Type);
+
+				m_Edges.push_back({ CurrentTarget.From, static_cast<DWORD>(m_Nodes.size()), CurrentTarget.FieldIndex });
+				AddNode(CurrentTarget.Address, CurrentTarget.Type, Depth);
+			}
+		}
+
+		LevelBegin = LevelEnd;
+	}
+}
+
+void
+PDBObjectGraph::PrepareType(
+	const SYMBOL* Type
+	)
+{
+	if (m_TypeInfos.find(Type) != m_TypeInfos.end())
+	{
+		return;
+	}
+
+	TypeInfo& Info = m_TypeInfos[Type];
+	Info.Layout = std::make_unique<PDBFieldLayout>(Type);
+
+	const auto& Fields = Info.Layout->GetFields();
+
+	for (DWORD Index = 0; Index < Fields.size(); Index++)
+	{
+		if (!Fields[Index].IsLeaf ||
+		    Fields[Index].Type->Tag != SymTagPointerType ||
+		    Fields[Index].Size != m_Settings->PointerSize)
+		{
+			continue;
+		}
+
+		const SYMBOL* PointeeType = PDBFieldLayout::GetUnderlyingType(Fields[Index].Type->u.Pointer.Type);
+
+		if (PointeeType != nullptr && PointeeType->Tag == SymTagUDT && PointeeType->Size != 0)
+		{
+			Info.PointerFields.push_back(std::make_pair(Index, PointeeType));
+		}
+	}
+}
+
+bool
+PDBObjectGraph::IsReadable(
+	ULONGLONG Address,
+	const SYMBOL* Type
+	) const
+{
+	if (m_Image->GetPointer(Address, Type->Size) != nullptr)
+	{
+		return true;
+	}
+
+	//
+	// Images without direct access are probed at both ends.
+	//
+
+	BYTE Probe;
+
+	return m_Image->Read(Address, &Probe, sizeof(Probe)) &&
+	       m_Image->Read(Address + Type->Size - 1, &Probe, sizeof(Probe));
+}
+
+void
+PDBObjectGraph::ExpandRange(
+	DWORD Begin,
+	DWORD End,
+	std::vector<Target>& Targets
+	) const
+{
+	std::vector<MemoryImage::Range> Ranges;
+
+	for (DWORD NodeIndex = Begin; NodeIndex < End; NodeIndex++)
+	{
+		//
+		// Live images fetch the following objects at once.
+		//
+
+		if ((NodeIndex - Begin) % PREFETCH_NODE_COUNT == 0)
+		{
+			Ranges.clear();
+
+			for (DWORD PrefetchedIndex = NodeIndex;
+			     PrefetchedIndex < End && PrefetchedIndex - NodeIndex < PREFETCH_NODE_COUNT;
+			     PrefetchedIndex++)
+			{
+				Ranges.push_back({ m_Nodes[PrefetchedIndex].Address, m_Nodes[PrefetchedIndex].Type->Size });
+			}
+
+			m_Image->Prefetch(Ranges);
+		}
+
+		const Node& CurrentNode = m_Nodes[NodeIndex];
+		const TypeInfo& Info = m_TypeInfos.at(CurrentNode.Type);
+
+		for (auto&& PointerField : Info.PointerFields)
+		{
+			ULONGLONG Pointer;
+
+			if (!m_Image->ReadPointer(
+				CurrentNode.Address + Info.Layout->GetFields()[PointerField.first].Offset,
+				m_Settings->PointerSize,
+				Pointer) || Pointer == 0)
+			{
+				continue;
+			}
+
+			//
+			// Edges to visited objects are kept,
+			// new objects must be readable.
+			//
+
+			if (m_Visited.find({ Pointer, PointerField.second }) == m_Visited.end() &&
+			    !IsReadable(Pointer, PointerField.second))
+			{
+				continue;
+			}
+
+			Targets.push_back({ Pointer, PointerField.second, NodeIndex, PointerField.first });
+		}
+	}
+}
+
+void
+PDBObjectGraph::AddNode(
+	ULONGLONG Address,
+	const SYMBOL* Type,
+	DWORD Depth
+	)
+{
+	m_Visited[{ Address, Type }] = static_cast<DWORD>(m_Nodes.size());
+	m_Nodes.push_back({ Address, Type, Depth });
+}
@@ -0,0 +1,197 @@
+#pragma once
+#include "PDB.h"
+#include "MemoryImage.h"
+#include "PDBFieldLayout.h"
+
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+//
+// Graph of typed objects reachable from the roots.
+//
+// Pointer fields of every UDT are taken from its PDBFieldLayout
+// (leaves of SymTagPointerType which point to UDTs). The crawler
+// visits the objects breadth-first, one level at a time:
+//
+//   - worker threads read pointer fields of the objects of the level
+//     and drop targets which are not readable (visited objects
+//     are not probed again),
+//   - new targets are merged into the visited set (keyed by address
+//     and type) in the order of the level, so node indices do not
+//     depend on the count of threads.
+//
+class PDBObjectGraph
+{
+	public:
+		struct Settings
+		{
+			//
+			// Objects at this depth (roots are at 0) are not expanded.
+			//
+			DWORD MaximumDepth = 8;
+
+			//
+			// The crawl stops when the graph has this count of nodes.
+			//
+			DWORD MaximumNodeCount = 1 << 20;
+
+			//
+			// Size of pointers in the image.
+			//
+			DWORD PointerSize = 8;
+
+			//
+			// Count of worker threads, 0 means count of CPUs.
+			//
+			DWORD ThreadCount = 0;
+		};
+
+		struct Node
+		{
+			ULONGLONG Address;
+			const SYMBOL* Type;
+			DWORD Depth;
+		};
+
+		struct Edge
+		{
+			DWORD From;
+			DWORD To;
+
+			//
+			// Index of the pointer field in the layout of the source type.
+			//
+			DWORD FieldIndex;
+		};
+
+		PDBObjectGraph(
+			MemoryImage* Image,
+			Settings* GraphSettings = nullptr
+			);
+
+		//
+		// Adds the root object, returns false if the object
+		// is not readable.
+		//
+		bool
+		AddRoot(
+			ULONGLONG Address,
+			const SYMBOL* Type
+			);
+
+		void
+		Crawl();
+
+		const std::vector<Node>&
+		GetNodes() const
+		{
+			return m_Nodes;
+		}
+
+		const std::vector<Edge>&
+		GetEdges() const
+		{
+			return m_Edges;
+		}
+
+		const PDBFieldLayout&
+		GetLayout(
+			const SYMBOL* Type
+			) const
+		{
+			return *m_TypeInfos.at(Type).Layout;
+		}
+
+		//
+		// True if some objects were dropped because of MaximumNodeCount.
+		//
+		bool
+		IsTruncated() const
+		{
+			return m_Truncated;
+		}
+
+	private:
+		struct TypeInfo
+		{
+			std::unique_ptr<PDBFieldLayout> Layout;
+
+			//
+			// Indices of the pointer fields and their pointee UDTs.
+			//
+			std::vector<std::pair<DWORD, const SYMBOL*>> PointerFields;
+		};
+
+		struct Target
+		{
+			ULONGLONG Address;
+			const SYMBOL* Type;
+			DWORD From;
+			DWORD FieldIndex;
+		};
+
+		struct NodeKey
+		{
+			ULONGLONG Address;
+			const SYMBOL* Type;
+
+			bool
+			operator==(
+				const NodeKey& Other
+				) const
+			{
+				return Address == Other.Address && Type == Other.Type;
+			}
+		};
+
+		struct NodeKeyHash
+		{
+			size_t
+			operator()(
+				const NodeKey& Key
+				) const
+			{
+				return std::hash<ULONGLONG>()(Key.Address ^ (reinterpret_cast<ULONGLONG>(Key.Type) * 0x9e3779b97f4a7c15ULL));
+			}
+		};
+
+		void
+		PrepareType(
+			const SYMBOL* Type
+			);
+
+		bool
+		IsReadable(
+			ULONGLONG Address,
+			const SYMBOL* Type
+			) const;
+
+		void
+		ExpandRange(
+			DWORD Begin,
+			DWORD End,
+			std::vector<Target>& Targets
+			) const;
+
+		void
+		AddNode(
+			ULONGLONG Address,
+			const SYMBOL* Type,
+			DWORD Depth
+			);
+
+	private:
+		MemoryImage* m_Image;
+		Settings* m_Settings;
+
+		std::map<const SYMBOL*, TypeInfo> m_TypeInfos;
+
+		std::vector<Node> m_Nodes;
+		std::vector<Edge> m_Edges;
+
+		std::unordered_map<NodeKey, DWORD, NodeKeyHash> m_Visited;
+
+		bool m_Truncated = false;
+};
@@ -0,0 +1,136 @@
+#include "PDBObjectList.h"
+#include "PDBFieldLayout.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+PDBObjectList::PDBObjectList(
+	PDB* Pdb
+	)
+{
+	m_PDB = Pdb;
+}
+
+void
+PDBObjectList::AddObject(
+	ULONGLONG Address,
+	const SYMBOL* Type
+	)
+{
+	m_Objects.push_back({ Address, Type });
+}
+
+bool
+PDBObjectList::LoadBindings(
+	const char* Path
+	)
+{
+	std::ifstream BindingsFile(Path, std::ios::in);
+
+	if (!BindingsFile.is_open())
+	{
+		return false;
+	}
+
+	std::string Line;
+
+	while (std::getline(BindingsFile, Line))
+	{
+		std::string AddressString;
+		std::string TypeName;
+
+		std::istringstream(Line) >> AddressString >> TypeName;
+
+		if (AddressString.empty() || AddressString[0] == '#' || TypeName.empty())
+		{
+			continue;
+		}
+
+		//
+		// WinDbg separates the halves of 64-bit addresses by '`'.
+		//
+
+		AddressString.erase(std::remove(AddressString.begin(), AddressString.end(), '`'), AddressString.end());
+
+		char* AddressEnd;
+		ULONGLONG Address = _strtoui64(AddressString.c_str(), &AddressEnd, 16);
+
+		if (*AddressEnd != '\0')
+		{
+			continue;
+		}
+
+		const SYMBOL* Symbol = PDBFieldLayout::GetUnderlyingType(m_PDB->GetSymbolByName(TypeName.c_str()));
+
+		if (Symbol == nullptr || Symbol->Tag != SymTagUDT || Symbol->Size == 0)
+		{
+			m_UnknownBindingCount += 1;
+			continue;
+		}
+
+		m_Objects.push_back({ Address, Symbol });
+	}
+
+	return true;
+}
+
+bool
+PDBObjectList::WalkList(
+	MemoryImage* Image,
+	ULONGLONG Head,
+	const SYMBOL* Type,
+	const std::string& LinkPath,
+	DWORD PointerSize,
+	size_t MaximumCount
+	)
+{
+	PDBFieldLayout Layout(Type);
+
+	DWORD LinkIndex = Layout.FindFieldIndexByPath(LinkPath);
+
+	if (LinkIndex == PDBFieldLayout::None)
+	{
+		return false;
+	}
+
+	ULONGLONG LinkOffset = Layout.GetFields()[LinkIndex].Offset;
+
+	//
+	// Flink is the first field of the LIST_ENTRY.
+	//
+
+	ULONGLONG Entry;
+
+	if (!Image->ReadPointer(Head, PointerSize, Entry))
+	{
+		return true;
+	}
+
+	for (size_t Count = 0;
+	     Entry != Head && Entry != 0 && Count < MaximumCount;
+	     Count++)
+	{
+		m_Objects.push_back({ Entry - LinkOffset, Type });
+
+		if (!Image->ReadPointer(Entry, PointerSize, Entry))
+		{
+			break;
+		}
+	}
+
+	return true;
+}
+
+void
+PDBObjectList::Sort()
+{
+	std::sort(m_Objects.begin(), m_Objects.end(), [](const Object& Lhs, const Object& Rhs) {
+		return Lhs.Address < Rhs.Address || (Lhs.Address == Rhs.Address && Lhs.Type < Rhs.Type);
+	});
+
+	m_Objects.erase(std::unique(m_Objects.begin(), m_Objects.end(), [](const Object& Lhs, const Object& Rhs) {
+		return Lhs.Address == Rhs.Address && Lhs.Type == Rhs.Type;
+	}), m_Objects.end());
+}
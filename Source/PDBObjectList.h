@@ -0,0 +1,95 @@
+#pragma once
+#include "PDB.h"
+#include "MemoryImage.h"
+
+#include <string>
+#include <vector>
+
+//
+// List of typed objects in a memory image.
+//
+// Objects are either loaded from a bindings file
+// (the format of PDBFieldHeatmap, one object per line):
+//
+//   # base              type
+//   ffffa3014f2c6080    _EPROCESS
+//
+// or collected by walking a LIST_ENTRY list:
+//
+//   PsActiveProcessHead -> _EPROCESS.ActiveProcessLinks -> ...
+//
+class PDBObjectList
+{
+	public:
+		struct Object
+		{
+			ULONGLONG Address;
+			const SYMBOL* Type;
+		};
+
+		PDBObjectList(
+			PDB* Pdb
+			);
+
+		void
+		AddObject(
+			ULONGLONG Address,
+			const SYMBOL* Type
+			);
+
+		//
+		// Returns false if the file cannot be opened.
+		//
+		bool
+		LoadBindings(
+			const char* Path
+			);
+
+		//
+		// Walks the circular doubly linked list starting at the Head
+		// (address of the LIST_ENTRY), LinkPath is the path
+		// of the LIST_ENTRY field in the Type (e.g. "ActiveProcessLinks").
+		//
+		// The walk stops at the Head, at an unreadable entry
+		// or after MaximumCount objects.
+		//
+		// Returns false if the LinkPath is not a field of the Type.
+		//
+		bool
+		WalkList(
+			MemoryImage* Image,
+			ULONGLONG Head,
+			const SYMBOL* Type,
+			const std::string& LinkPath,
+			DWORD PointerSize,
+			size_t MaximumCount = 1 << 24
+			);
+
+		//
+		// Sorts the objects by their address and removes duplicates.
+		//
+		void
+		Sort();
+
+		const std::vector<Object>&
+		GetObjects() const
+		{
+			return m_Objects;
+		}
+
+		//
+		// Count of bindings which refer to unknown types.
+		//
+		ULONGLONG
+		GetUnknownBindingCount() const
+		{
+			return m_UnknownBindingCount;
+		}
+
+	private:
+		PDB* m_PDB;
+
+		std::vector<Object> m_Objects;
+
+		ULONGLONG m_UnknownBindingCount = 0;
+};
@@ -0,0 +1,854 @@
+#include "PDBObjectQuery.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace
+{
+	static PDBObjectQuery::Settings DefaultSettings;
+
+	//
+	// Column kernels, kept free of branches on the comparison
+	// so the compiler can vectorize them.
+	//
+
+	template <
+		typename T
+	>
+	void
+	GatherColumn(
+		const std::vector<const BYTE*>& Rows,
+		const std::vector<DWORD>& Selection,
+		DWORD Offset,
+		ULONGLONG* Column
+		)
+	{
+		for (size_t i = 0; i < Selection.size(); i++)
+		{
+			T Value;
+			memcpy(&Value, Rows[Selection[i]] + Offset, sizeof(Value));
+			Column[i] = Value;
+		}
+	}
+
+	template <
+		typename PredicateType
+	>
+	void
+	CompareColumn(
+		const ULONGLONG* Column,
+		size_t Count,
+		BYTE* Matched,
+		PredicateType Predicate
+		)
+	{
+		for (size_t i = 0; i < Count; i++)
+		{
+			Matched[i] |= static_cast<BYTE>(Predicate(Column[i]));
+		}
+	}
+
+	bool
+	IsSignedType(
+		const SYMBOL* Type
+		)
+	{
+		return Type != nullptr &&
+		       Type->Tag == SymTagBaseType &&
+		       (Type->BaseType == btInt || Type->BaseType == btLong || Type->BaseType == btChar);
+	}
+
+	ULONGLONG
+	SignExtend(
+		ULONGLONG Value,
+		DWORD Width
+		)
+	{
+		if (Width == 0 || Width >= 64)
+		{
+			return Value;
+		}
+
+		DWORD Shift = 64 - Width;
+
+		return static_cast<ULONGLONG>(static_cast<LONGLONG>(Value << Shift) >> Shift);
+	}
+
+	static const char* SYMBOLS[] = {
+		"&&", "||", "==", "!=", "<=", ">=", "^=", "<", ">", "&", "~", "-", "(", ")",
+	};
+}
+
+PDBObjectQuery::PDBObjectQuery(
+	const SYMBOL* Type,
+	Settings* QuerySettings
+	)
+	: m_Layout(Type)
+{
+	m_Settings = QuerySettings ? QuerySettings : &DefaultSettings;
+}
+
+bool
+PDBObjectQuery::Compile(
+	const std::string& Query,
+	const std::string& Select,
+	std::string& Error
+	)
+{
+	m_Clauses.clear();
+	m_Projections.clear();
+	m_ProjectionSize = 0;
+
+	std::vector<Token> Tokens;
+
+	if (!Tokenize(Query, Tokens, Error))
+	{
+		return false;
+	}
+
+	auto IsSymbol = [&Tokens](size_t Position, const char* Text) {
+		return Tokens[Position].TokenKind == Token::Kind::Symbol && Tokens[Position].Text == Text;
+	};
+
+	size_t Position = 0;
+
+	while (Tokens[Position].TokenKind != Token::Kind::End)
+	{
+		std::vector<Comparison> Clause;
+
+		if (IsSymbol(Position, "("))
+		{
+			Position++;
+
+			for (;;)
+			{
+				Comparison CurrentComparison;
+
+				if (!ParseComparison(Tokens, Position, CurrentComparison, Error))
+				{
+					return false;
+				}
+
+				Clause.push_back(CurrentComparison);
+
+				if (!IsSymbol(Position, "||"))
+				{
+					break;
+				}
+
+				Position++;
+			}
+
+			if (!IsSymbol(Position, ")"))
+			{
+				Error = "expected ')' or '||'";
+				return false;
+			}
+
+			Position++;
+		}
+		else
+		{
+			Comparison CurrentComparison;
+
+			if (!ParseComparison(Tokens, Position, CurrentComparison, Error))
+			{
+				return false;
+			}
+
+			Clause.push_back(CurrentComparison);
+		}
+
+		m_Clauses.push_back(Clause);
+
+		if (Tokens[Position].TokenKind == Token::Kind::End)
+		{
+			break;
+		}
+
+		if (!IsSymbol(Position, "&&"))
+		{
+			Error = "expected '&&' before '" + Tokens[Position].Text + "'";
+			return false;
+		}
+
+		Position++;
+	}
+
+	//
+	// Projected fields.
+	//
+
+	size_t Begin = 0;
+
+	while (Begin < Select.size())
+	{
+		size_t End = Select.find(',', Begin);
+
+		if (End == std::string::npos)
+		{
+			End = Select.size();
+		}
+
+		std::string Path = Select.substr(Begin, End - Begin);
+		Path.erase(std::remove_if(Path.begin(), Path.end(), isspace), Path.end());
+
+		Begin = End + 1;
+
+		if (Path.empty())
+		{
+			continue;
+		}
+
+		DWORD FieldIndex = m_Layout.FindFieldIndexByPath(Path);
+
+		if (FieldIndex == PDBFieldLayout::None)
+		{
+			Error = "unknown field '" + Path + "'";
+			return false;
+		}
+
+		m_Projections.push_back({ FieldIndex, m_ProjectionSize });
+		m_ProjectionSize += m_Layout.GetFields()[FieldIndex].Size;
+	}
+
+	//
+	// Only the window of the referenced fields is read.
+	//
+
+	m_WindowBegin = m_Layout.GetSymbol()->Size;
+	m_WindowEnd = 0;
+
+	for (auto&& Clause : m_Clauses)
+	{
+		for (auto&& CurrentComparison : Clause)
+		{
+			m_WindowBegin = (std::min)(m_WindowBegin, CurrentComparison.Offset);
+			m_WindowEnd = (std::max)(m_WindowEnd, CurrentComparison.Offset + CurrentComparison.Size);
+		}
+	}
+
+	for (auto&& CurrentProjection : m_Projections)
+	{
+		const PDBFieldLayout::Field& ProjectedField = m_Layout.GetFields()[CurrentProjection.FieldIndex];
+
+		m_WindowBegin = (std::min)(m_WindowBegin, ProjectedField.Offset);
+		m_WindowEnd = (std::max)(m_WindowEnd, ProjectedField.Offset + ProjectedField.Size);
+	}
+
+	if (m_WindowEnd < m_WindowBegin)
+	{
+		m_WindowBegin = m_WindowEnd = 0;
+	}
+
+	for (auto&& Clause : m_Clauses)
+	{
+		for (auto&& CurrentComparison : Clause)
+		{
+			CurrentComparison.Offset -= m_WindowBegin;
+		}
+	}
+
+	return true;
+}
+
+void
+PDBObjectQuery::Execute(
+	MemoryImage* Image,
+	const std::vector<ULONGLONG>& Addresses
+	)
+{
+	m_Matches.clear();
+	m_UnreadableCount = 0;
+
+	DWORD BatchSize = (std::max)(m_Settings->BatchSize, 1u);
+	DWORD WindowSize = m_WindowEnd - m_WindowBegin;
+
+	std::vector<BYTE> Buffer(static_cast<size_t>(BatchSize) * WindowSize);
+	std::vector<const BYTE*> Rows;
+	std::vector<ULONGLONG> RowAddresses;
+	std::vector<DWORD> Selection;
+	std::vector<MemoryImage::Range> Ranges;
+
+	for (size_t BatchBegin = 0; BatchBegin < Addresses.size(); BatchBegin += BatchSize)
+	{
+		size_t BatchEnd = (std::min)(BatchBegin + BatchSize, Addresses.size());
+
+		Rows.clear();
+		RowAddresses.clear();
+		Selection.clear();
+
+		//
+		// Live images fetch windows of the whole batch at once.
+		//
+
+		Ranges.clear();
+
+		for (size_t Index = BatchBegin; Index < BatchEnd; Index++)
+		{
+			Ranges.push_back({ Addresses[Index] + m_WindowBegin, WindowSize });
+		}
+
+		Image->Prefetch(Ranges);
+
+		for (size_t Index = BatchBegin; Index < BatchEnd; Index++)
+		{
+			ULONGLONG WindowAddress = Addresses[Index] + m_WindowBegin;
+			const BYTE* Row = Image->GetPointer(WindowAddress, WindowSize);
+
+			if (Row == nullptr)
+			{
+				BYTE* RowBuffer = Buffer.data() + (Index - BatchBegin) * WindowSize;
+
+				if (!Image->Read(WindowAddress, RowBuffer, WindowSize))
+				{
+					m_UnreadableCount += 1;
+					continue;
+				}
+
+				Row = RowBuffer;
+			}
+
+			Selection.push_back(static_cast<DWORD>(Rows.size()));
+			Rows.push_back(Row);
+			RowAddresses.push_back(Addresses[Index]);
+		}
+
+		FilterBatch(Rows, Selection);
+
+		for (auto&& RowIndex : Selection)
+		{
+			Match CurrentMatch;
+			CurrentMatch.Address = RowAddresses[RowIndex];
+			CurrentMatch.Values.resize(m_ProjectionSize);
+
+			for (auto&& CurrentProjection : m_Projections)
+			{
+				const PDBFieldLayout::Field& ProjectedField = m_Layout.GetFields()[CurrentProjection.FieldIndex];
+
+				memcpy(
+					CurrentMatch.Values.data() + CurrentProjection.ValueOffset,
+					Rows[RowIndex] + (ProjectedField.Offset - m_WindowBegin),
+					ProjectedField.Size
+					);
+			}
+
+			m_Matches.push_back(std::move(CurrentMatch));
+		}
+	}
+}
+
+ULONGLONG
+PDBObjectQuery::GetFieldValue(
+	const PDBFieldLayout::Field& CurrentField,
+	const BYTE* FieldData
+	)
+{
+	ULONGLONG Value = 0;
+	memcpy(&Value, FieldData, (std::min)(CurrentField.Size, static_cast<DWORD>(sizeof(Value))));
+
+	if (CurrentField.Bits != 0)
+	{
+		Value >>= CurrentField.BitPosition;
+
+		if (CurrentField.Bits < 64)
+		{
+			Value &= (1ULL << CurrentField.Bits) - 1;
+		}
+	}
+
+	return Value;
+}
+
+bool
+PDBObjectQuery::Tokenize(
+	const std::string& Query,
+	std::vector<Token>& Tokens,
+	std::string& Error
+	)
+{
+	size_t Position = 0;
+
+	while (Position < Query.size())
+	{
+		char Character = Query[Position];
+
+		if (isspace(static_cast<unsigned char>(Character)))
+		{
+			Position++;
+			continue;
+		}
+
+		size_t Begin = Position;
+
+		if (isalpha(static_cast<unsigned char>(Character)) || Character == '_')
+		{
+			while (Position < Query.size() &&
+			       (isalnum(static_cast<unsigned char>(Query[Position])) || strchr("_.[]", Query[Position]) != nullptr))
+			{
+				Position++;
+			}
+
+			Tokens.push_back({ Token::Kind::Path, Query.substr(Begin, Position - Begin) });
+		}
+		else if (isdigit(static_cast<unsigned char>(Character)))
+		{
+			//
+			// WinDbg separates the halves of 64-bit addresses by '`'.
+			//
+
+			while (Position < Query.size() &&
+			       (isxdigit(static_cast<unsigned char>(Query[Position])) || Query[Position] == 'x' || Query[Position] == 'X' || Query[Position] == '`'))
+			{
+				Position++;
+			}
+
+			Tokens.push_back({ Token::Kind::Number, Query.substr(Begin, Position - Begin) });
+		}
+		else if (Character == '"')
+		{
+			std::string String;
+
+			for (Position++; Position < Query.size() && Query[Position] != '"'; Position++)
+			{
+				if (Query[Position] == '\\' && Position + 1 < Query.size())
+				{
+					Position++;
+				}
+
+				String += Query[Position];
+			}
+
+			if (Position == Query.size())
+			{
+				Error = "unterminated string";
+				return false;
+			}
+
+			Position++;
+			Tokens.push_back({ Token::Kind::String, String });
+		}
+		else
+		{
+			const char* Symbol = nullptr;
+
+			for (auto&& CurrentSymbol : SYMBOLS)
+			{
+				if (Query.compare(Position, strlen(CurrentSymbol), CurrentSymbol) == 0)
+				{
+					Symbol = CurrentSymbol;
+					break;
+				}
+			}
+
+			if (Symbol == nullptr)
+			{
+				Error = std::string("unexpected character '") + Character + "'";
+				return false;
+			}
+
+			Position += strlen(Symbol);
+			Tokens.push_back({ Token::Kind::Symbol, Symbol });
+		}
+	}
+
+	Tokens.push_back({ Token::Kind::End, "end of query" });
+	return true;
+}
+
+bool
+PDBObjectQuery::ParseComparison(
+	const std::vector<Token>& Tokens,
+	size_t& Position,
+	Comparison& Result,
+	std::string& Error
+	)
+{
+	auto IsSymbol = [&Tokens, &Position](const char* Text) {
+		return Tokens[Position].TokenKind == Token::Kind::Symbol && Tokens[Position].Text == Text;
+	};
+
+	if (Tokens[Position].TokenKind != Token::Kind::Path)
+	{
+		Error = "expected field before '" + Tokens[Position].Text + "'";
+		return false;
+	}
+
+	DWORD FieldIndex = m_Layout.FindFieldIndexByPath(Tokens[Position].Text);
+
+	if (FieldIndex == PDBFieldLayout::None)
+	{
+		Error = "unknown field '" + Tokens[Position].Text + "'";
+		return false;
+	}
+
+	const PDBFieldLayout::Field& ComparedField = m_Layout.GetFields()[FieldIndex];
+
+	Result.Offset = ComparedField.Offset;
+	Result.Size = ComparedField.Size;
+	Result.Bits = ComparedField.Bits;
+	Result.BitPosition = ComparedField.BitPosition;
+	Result.IsString = false;
+	Result.Mask = ~0ULL;
+	Result.Value = 0;
+
+	Position++;
+
+	bool HasMask = false;
+
+	if (IsSymbol("&"))
+	{
+		Position++;
+
+		bool Invert = IsSymbol("~");
+
+		if (Invert)
+		{
+			Position++;
+		}
+
+		if (Tokens[Position].TokenKind != Token::Kind::Number ||
+		    !ParseNumber(Tokens[Position].Text, Result.Mask))
+		{
+			Error = "expected mask before '" + Tokens[Position].Text + "'";
+			return false;
+		}
+
+		if (Invert)
+		{
+			Result.Mask = ~Result.Mask;
+		}
+
+		HasMask = true;
+		Position++;
+	}
+
+	//
+	// Masked fields are compared as bits.
+	//
+
+	Result.IsSigned = !HasMask && IsSignedType(ComparedField.Type);
+
+	static const struct
+	{
+		const char* Text;
+		Operator CompareOperator;
+	} OPERATORS[] = {
+		{ "==", Operator::Equal          },
+		{ "!=", Operator::NotEqual       },
+		{ "<",  Operator::Less           },
+		{ "<=", Operator::LessOrEqual    },
+		{ ">",  Operator::Greater        },
+		{ ">=", Operator::GreaterOrEqual },
+		{ "^=", Operator::Prefix         },
+	};
+
+	bool FoundOperator = false;
+
+	for (auto&& CurrentOperator : OPERATORS)
+	{
+		if (IsSymbol(CurrentOperator.Text))
+		{
+			Result.CompareOperator = CurrentOperator.CompareOperator;
+			FoundOperator = true;
+			break;
+		}
+	}
+
+	if (!FoundOperator)
+	{
+		Error = "expected operator before '" + Tokens[Position].Text + "'";
+		return false;
+	}
+
+	Position++;
+
+	if (Tokens[Position].TokenKind == Token::Kind::String)
+	{
+		if (HasMask ||
+		    (Result.CompareOperator != Operator::Equal &&
+		     Result.CompareOperator != Operator::NotEqual &&
+		     Result.CompareOperator != Operator::Prefix))
+		{
+			Error = "strings can be compared only by ==, != and ^=";
+			return false;
+		}
+
+		if (Tokens[Position].Text.size() > Result.Size)
+		{
+			Error = "string \"" + Tokens[Position].Text + "\" is longer than the field";
+			return false;
+		}
+
+		Result.IsString = true;
+		Result.String = Tokens[Position].Text;
+
+		Position++;
+		return true;
+	}
+
+	if (Result.CompareOperator == Operator::Prefix)
+	{
+		Error = "^= expects a string";
+		return false;
+	}
+
+	if (Result.Size > sizeof(ULONGLONG))
+	{
+		Error = "field '" + ComparedField.Path + "' is larger than 8 bytes";
+		return false;
+	}
+
+	bool Negative = IsSymbol("-");
+
+	if (Negative)
+	{
+		Position++;
+	}
+
+	if (Tokens[Position].TokenKind != Token::Kind::Number ||
+	    !ParseNumber(Tokens[Position].Text, Result.Value))
+	{
+		Error = "expected value before '" + Tokens[Position].Text + "'";
+		return false;
+	}
+
+	if (Negative)
+	{
+		//
+		// Negative values of unsigned (or masked) fields
+		// are truncated to the width of the field.
+		//
+
+		DWORD Width = Result.Bits ? Result.Bits : Result.Size * 8;
+
+		Result.Value = static_cast<ULONGLONG>(0 - Result.Value);
+
+		if (!Result.IsSigned && Width < 64)
+		{
+			Result.Value &= (1ULL << Width) - 1;
+		}
+	}
+
+	Position++;
+	return true;
+}
+
+bool
+PDBObjectQuery::ParseNumber(
+	const std::string& Text,
+	ULONGLONG& Value
+	)
+{
+	std::string Number = Text;
+	Number.erase(std::remove(Number.begin(), Number.end(), '`'), Number.end());
+
+	char* NumberEnd;
+	Value = _strtoui64(Number.c_str(), &NumberEnd, 0);
+
+	return !Number.empty() && *NumberEnd == '\0';
+}
+
+void
+PDBObjectQuery::FilterBatch(
+	const std::vector<const BYTE*>& Rows,
+	std::vector<DWORD>& Selection
+	)
+{
+	for (auto&& Clause : m_Clauses)
+	{
+		if (Selection.empty())
+		{
+			break;
+		}
+
+		size_t Count = Selection.size();
+
+		m_Matched.assign(Count, 0);
+		m_Column.resize(Count);
+
+		ULONGLONG* Column = m_Column.data();
+		BYTE* Matched = m_Matched.data();
+
+		for (auto&& CurrentComparison : Clause)
+		{
+			if (CurrentComparison.IsString)
+			{
+				for (size_t i = 0; i < Count; i++)
+				{
+					Matched[i] |= static_cast<BYTE>(CompareString(CurrentComparison, Rows[Selection[i]]));
+				}
+
+				continue;
+			}
+
+			//
+			// Gather the column.
+			//
+
+			switch (CurrentComparison.Size)
+			{
+				case 1:  GatherColumn<BYTE>(Rows, Selection, CurrentComparison.Offset, Column);      break;
+				case 2:  GatherColumn<WORD>(Rows, Selection, CurrentComparison.Offset, Column);      break;
+				case 4:  GatherColumn<DWORD>(Rows, Selection, CurrentComparison.Offset, Column);     break;
+				case 8:  GatherColumn<ULONGLONG>(Rows, Selection, CurrentComparison.Offset, Column); break;
+
+				default:
+					for (size_t i = 0; i < Count; i++)
+					{
+						Column[i] = 0;
+						memcpy(&Column[i], Rows[Selection[i]] + CurrentComparison.Offset, CurrentComparison.Size);
+					}
+					break;
+			}
+
+			ULONGLONG Mask = CurrentComparison.Mask;
+
+			if (CurrentComparison.Bits != 0)
+			{
+				DWORD BitPosition = CurrentComparison.BitPosition;
+
+				if (CurrentComparison.Bits < 64)
+				{
+					Mask &= (1ULL << CurrentComparison.Bits) - 1;
+				}
+
+				for (size_t i = 0; i < Count; i++)
+				{
+					Column[i] >>= BitPosition;
+				}
+			}
+
+			if (Mask != ~0ULL)
+			{
+				for (size_t i = 0; i < Count; i++)
+				{
+					Column[i] &= Mask;
+				}
+			}
+
+			if (CurrentComparison.IsSigned)
+			{
+				DWORD Width = CurrentComparison.Bits ? CurrentComparison.Bits : CurrentComparison.Size * 8;
+
+				for (size_t i = 0; i < Count; i++)
+				{
+					Column[i] = SignExtend(Column[i], Width);
+				}
+			}
+
+			//
+			// Compare the column.
+			//
+
+			ULONGLONG Value = CurrentComparison.Value;
+
+			//
+			// Equality does not depend on the signedness
+			// of the sign-extended values.
+			//
+
+			if (CurrentComparison.IsSigned)
+			{
+				LONGLONG SignedValue = static_cast<LONGLONG>(Value);
+
+				switch (CurrentComparison.CompareOperator)
+				{
+					case Operator::Less:
+						CompareColumn(Column, Count, Matched, [SignedValue](ULONGLONG Lhs) { return static_cast<LONGLONG>(Lhs) < SignedValue; });
+						continue;
+
+					case Operator::LessOrEqual:
+						CompareColumn(Column, Count, Matched, [SignedValue](ULONGLONG Lhs) { return static_cast<LONGLONG>(Lhs) <= SignedValue; });
+						continue;
+
+					case Operator::Greater:
+						CompareColumn(Column, Count, Matched, [SignedValue](ULONGLONG Lhs) { return static_cast<LONGLONG>(Lhs) > SignedValue; });
+						continue;
+
+					case Operator::GreaterOrEqual:
+						CompareColumn(Column, Count, Matched, [SignedValue](ULONGLONG Lhs) { return static_cast<LONGLONG>(Lhs) >= SignedValue; });
+						continue;
+
+					default:
+						break;
+				}
+			}
+
+			switch (CurrentComparison.CompareOperator)
+			{
+				case Operator::Equal:
+					CompareColumn(Column, Count, Matched, [Value](ULONGLONG Lhs) { return Lhs == Value; });
+					break;
+
+				case Operator::NotEqual:
+					CompareColumn(Column, Count, Matched, [Value](ULONGLONG Lhs) { return Lhs != Value; });
+					break;
+
+				case Operator::Less:
+					CompareColumn(Column, Count, Matched, [Value](ULONGLONG Lhs) { return Lhs < Value; });
+					break;
+
+				case Operator::LessOrEqual:
+					CompareColumn(Column, Count, Matched, [Value](ULONGLONG Lhs) { return Lhs <= Value; });
+					break;
+
+				case Operator::Greater:
+					CompareColumn(Column, Count, Matched, [Value](ULONGLONG Lhs) { return Lhs > Value; });
+					break;
+
+				case Operator::GreaterOrEqual:
+					CompareColumn(Column, Count, Matched, [Value](ULONGLONG Lhs) { return Lhs >= Value; });
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		//
+		// Keep the matching instances.
+		//
+
+		size_t Kept = 0;
+
+		for (size_t i = 0; i < Count; i++)
+		{
+			Selection[Kept] = Selection[i];
+			Kept += Matched[i];
+		}
+
+		Selection.resize(Kept);
+	}
+}
+
+bool
+PDBObjectQuery::CompareString(
+	const Comparison& CurrentComparison,
+	const BYTE* Data
+	)
+{
+	const std::string& String = CurrentComparison.String;
+	const BYTE* FieldData = Data + CurrentComparison.Offset;
+
+	bool Equal = memcmp(FieldData, String.data(), String.size()) == 0;
+
+	if (CurrentComparison.CompareOperator == Operator::Prefix)
+	{
+		return Equal;
+	}
+
+	//
+	// Strings shorter than the field must be terminated.
+	//
+
+	if (Equal && String.size() < CurrentComparison.Size)
+	{
+		Equal = FieldData[String.size()] == 0;
+	}
+
+	return CurrentComparison.CompareOperator == Operator::Equal
+		? Equal
+		: !Equal;
+}
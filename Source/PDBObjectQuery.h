@@ -0,0 +1,232 @@
+#pragma once
+#include "PDB.h"
+#include "MemoryImage.h"
+#include "PDBFieldLayout.h"
+
+#include <string>
+#include <vector>
+
+//
+// Filters instances of one UDT by predicates over their fields.
+//
+// The query is a conjunction of clauses, every clause is a comparison
+// or a parenthesized disjunction of comparisons:
+//
+//   ImageFileName ^= "svc" && (Token.Value & ~0xf == 0xffffc001`23456780 || Flags > 3)
+//
+// Comparisons of integer fields (up to 8 bytes, bitfields are extracted)
+// use ==, !=, <, <=, >, >= and an optional mask. Fields of signed integer
+// types are compared as signed values, masked fields as unsigned bits.
+// Fields of any size can be compared with strings by ==, != and ^= (prefix).
+//
+// The query is compiled into a field program. Only the window of bytes
+// which covers the referenced fields is read from each instance and
+// the instances are filtered in batches: every comparison is evaluated
+// for all selected instances of the batch at once, over a column
+// of gathered field values, and the selection shrinks after every clause.
+//
+class PDBObjectQuery
+{
+	public:
+		struct Settings
+		{
+			//
+			// Count of instances filtered at once.
+			//
+			DWORD BatchSize = 256;
+		};
+
+		struct Projection
+		{
+			//
+			// Index of the field in the layout.
+			//
+			DWORD FieldIndex;
+
+			//
+			// Offset of the field value in Match::Values.
+			//
+			DWORD ValueOffset;
+		};
+
+		struct Match
+		{
+			ULONGLONG Address;
+
+			//
+			// Packed bytes of the projected fields.
+			//
+			std::vector<BYTE> Values;
+		};
+
+		PDBObjectQuery(
+			const SYMBOL* Type,
+			Settings* QuerySettings = nullptr
+			);
+
+		//
+		// Compiles the query and the comma separated list of projected fields.
+		// Returns false and describes the problem in Error if the query is invalid.
+		//
+		bool
+		Compile(
+			const std::string& Query,
+			const std::string& Select,
+			std::string& Error
+			);
+
+		void
+		Execute(
+			MemoryImage* Image,
+			const std::vector<ULONGLONG>& Addresses
+			);
+
+		const std::vector<Match>&
+		GetMatches() const
+		{
+			return m_Matches;
+		}
+
+		const std::vector<Projection>&
+		GetProjections() const
+		{
+			return m_Projections;
+		}
+
+		const PDBFieldLayout&
+		GetLayout() const
+		{
+			return m_Layout;
+		}
+
+		ULONGLONG
+		GetUnreadableCount() const
+		{
+			return m_UnreadableCount;
+		}
+
+		//
+		// Extracts the value of the field (up to 8 bytes) from the bytes
+		// of the field, bitfields are shifted and masked.
+		//
+		static
+		ULONGLONG
+		GetFieldValue(
+			const PDBFieldLayout::Field& CurrentField,
+			const BYTE* FieldData
+			);
+
+	private:
+		enum class Operator
+		{
+			Equal,
+			NotEqual,
+			Less,
+			LessOrEqual,
+			Greater,
+			GreaterOrEqual,
+			Prefix,
+		};
+
+		struct Comparison
+		{
+			//
+			// Offset relative to the window.
+			//
+			DWORD Offset;
+			DWORD Size;
+			DWORD Bits;
+			DWORD BitPosition;
+
+			Operator CompareOperator;
+
+			bool IsString;
+
+			//
+			// The field is signed and not masked, the column and the Value
+			// are sign-extended to 64 bits.
+			//
+			bool IsSigned;
+
+			ULONGLONG Mask;
+			ULONGLONG Value;
+			std::string String;
+		};
+
+		struct Token
+		{
+			enum class Kind
+			{
+				Path,
+				Number,
+				String,
+				Symbol,
+				End,
+			};
+
+			Kind TokenKind;
+			std::string Text;
+		};
+
+		bool
+		Tokenize(
+			const std::string& Query,
+			std::vector<Token>& Tokens,
+			std::string& Error
+			);
+
+		bool
+		ParseComparison(
+			const std::vector<Token>& Tokens,
+			size_t& Position,
+			Comparison& Result,
+			std::string& Error
+			);
+
+		bool
+		ParseNumber(
+			const std::string& Text,
+			ULONGLONG& Value
+			);
+
+		void
+		FilterBatch(
+			const std::vector<const BYTE*>& Rows,
+			std::vector<DWORD>& Selection
+			);
+
+		static
+		bool
+		CompareString(
+			const Comparison& CurrentComparison,
+			const BYTE* Data
+			);
+
+	private:
+		PDBFieldLayout m_Layout;
+		Settings* m_Settings;
+
+		//
+		// Conjunction of disjunctions of comparisons.
+		//
+		std::vector<std::vector<Comparison>> m_Clauses;
+
+		std::vector<Projection> m_Projections;
+		DWORD m_ProjectionSize = 0;
+
+		//
+		// Range of the bytes read from each instance.
+		//
+		DWORD m_WindowBegin = 0;
+		DWORD m_WindowEnd = 0;
+
+		std::vector<Match> m_Matches;
+
+		ULONGLONG m_UnreadableCount = 0;
+
+		//
+		// Column of gathered field values and the match flags.
+		//
+		std::vector<ULONGLONG> m_Column;
+		std::vector<BYTE> m_Matched;
+};
@@ -0,0 +1,316 @@
+#include "PDBOffsetPack.h"
+#include "PDBFieldLayout.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+	inline
+	void
+	AppendBytes(
+		std::vector<BYTE>& Pack,
+		const void* Data,
+		size_t Size
+		)
+	{
+		Pack.insert(Pack.end(), static_cast<const BYTE*>(Data), static_cast<const BYTE*>(Data) + Size);
+	}
+
+	inline
+	void
+	AlignPack(
+		std::vector<BYTE>& Pack
+		)
+	{
+		Pack.resize((Pack.size() + 3) & ~static_cast<size_t>(3));
+	}
+
+	inline
+	std::string
+	TrimLine(
+		const std::string& Line
+		)
+	{
+		size_t Begin = Line.find_first_not_of(" \t\r");
+		size_t End = Line.find_last_not_of(" \t\r");
+
+		return Begin == std::string::npos
+			? std::string()
+			: Line.substr(Begin, End - Begin + 1);
+	}
+}
+
+bool
+PDBOffsetPack::LoadFields(
+	const char* Path
+	)
+{
+	std::ifstream FieldsFile(Path);
+
+	if (!FieldsFile.is_open())
+	{
+		return false;
+	}
+
+	std::map<std::string, DWORD> GroupIndices;
+	std::string Line;
+
+	while (std::getline(FieldsFile, Line))
+	{
+		Line = TrimLine(Line);
+
+		if (Line.empty() || Line[0] == '#')
+		{
+			continue;
+		}
+
+		Field NewField;
+
+		size_t Separator = Line.find('.');
+		NewField.TypeName = Line.substr(0, Separator);
+		NewField.Path = Separator != std::string::npos
+			? Line.substr(Separator + 1)
+			: std::string();
+
+		auto GroupIterator = GroupIndices.find(NewField.TypeName);
+
+		if (GroupIterator == GroupIndices.end())
+		{
+			GroupIterator = GroupIndices.emplace(NewField.TypeName, static_cast<DWORD>(m_Groups.size())).first;
+
+			m_Groups.emplace_back();
+			m_Groups.back().TypeName = NewField.TypeName;
+		}
+
+		Group& FieldGroup = m_Groups[GroupIterator->second];
+
+		//
+		// Repeated fields share the slot of the group.
+		//
+
+		auto PathIterator = std::find(FieldGroup.Paths.begin(), FieldGroup.Paths.end(), NewField.Path);
+
+		NewField.Group = GroupIterator->second;
+		NewField.Index = static_cast<DWORD>(PathIterator - FieldGroup.Paths.begin());
+
+		if (PathIterator == FieldGroup.Paths.end())
+		{
+			FieldGroup.Paths.push_back(NewField.Path);
+		}
+
+		m_Fields.push_back(NewField);
+	}
+
+	return true;
+}
+
+bool
+PDBOffsetPack::AddBuild(
+	PDB* Pdb,
+	const char* PdbPath,
+	DWORD& MissingFieldCount
+	)
+{
+	GUID Guid;
+	DWORD Age;
+
+	if (!Pdb->GetSignature(Guid, Age))
+	{
+		return false;
+	}
+
+	//
+	// The consumer hashes the PDB name of the CodeView record,
+	// which is the name recorded in the PDB, not the name
+	// of the file on the disk.
+	//
+
+	std::string ModuleName;
+
+	if (!Pdb->GetName(ModuleName))
+	{
+		ModuleName = PdbPath;
+	}
+
+	Build NewBuild;
+
+	NewBuild.Key.ModuleHash = OffsetPackHashModuleName(ModuleName.c_str());
+	memcpy(NewBuild.Key.Guid, &Guid, sizeof(NewBuild.Key.Guid));
+	NewBuild.Key.Age = Age;
+
+	for (auto&& OtherBuild : m_Builds)
+	{
+		if (OffsetPackCompareBuild(&OtherBuild.Key, &NewBuild.Key) == 0)
+		{
+			return false;
+		}
+	}
+
+	//
+	// Compute the layouts first, the pack is not modified
+	// if any of the groups is full.
+	//
+
+	std::vector<std::vector<DWORD>> Layouts;
+
+	MissingFieldCount = 0;
+
+	for (auto&& FieldGroup : m_Groups)
+	{
+		std::vector<DWORD> Layout(FieldGroup.Paths.size(), OFFSET_PACK_MISSING);
+
+		const SYMBOL* Symbol = PDBFieldLayout::GetUnderlyingType(Pdb->GetSymbolByName(FieldGroup.TypeName.c_str()));
+
+		if (Symbol != nullptr && Symbol->Tag == SymTagUDT)
+		{
+			PDBFieldLayout FieldLayout(Symbol);
+
+			for (size_t i = 0; i < FieldGroup.Paths.size(); i++)
+			{
+				if (FieldGroup.Paths[i].empty())
+				{
+					Layout[i] = Symbol->Size;
+					continue;
+				}
+
+				DWORD FieldIndex = FieldLayout.FindFieldIndexByPath(FieldGroup.Paths[i]);
+
+				if (FieldIndex != PDBFieldLayout::None)
+				{
+					Layout[i] = FieldLayout.GetFields()[FieldIndex].Offset;
+				}
+			}
+		}
+
+		MissingFieldCount += static_cast<DWORD>(std::count(Layout.begin(), Layout.end(), OFFSET_PACK_MISSING));
+
+		if (FieldGroup.LayoutIndices.find(Layout) == FieldGroup.LayoutIndices.end() &&
+		    FieldGroup.Layouts.size() >= 0xFFFF)
+		{
+			return false;
+		}
+
+		Layouts.push_back(std::move(Layout));
+	}
+
+	for (size_t i = 0; i < m_Groups.size(); i++)
+	{
+		Group& FieldGroup = m_Groups[i];
+
+		auto LayoutIterator = FieldGroup.LayoutIndices.find(Layouts[i]);
+
+		if (LayoutIterator == FieldGroup.LayoutIndices.end())
+		{
+			LayoutIterator = FieldGroup.LayoutIndices.emplace(Layouts[i], static_cast<WORD>(FieldGroup.Layouts.size())).first;
+			FieldGroup.Layouts.push_back(Layouts[i]);
+		}
+
+		NewBuild.LayoutIndices.push_back(LayoutIterator->second);
+	}
+
+	m_Builds.push_back(std::move(NewBuild));
+
+	return true;
+}
+
+void
+PDBOffsetPack::Serialize(
+	std::vector<BYTE>& Pack
+	) const
+{
+	//
+	// The reader does a binary search on the keys.
+	//
+
+	std::vector<const Build*> SortedBuilds;
+
+	for (auto&& SortedBuild : m_Builds)
+	{
+		SortedBuilds.push_back(&SortedBuild);
+	}
+
+	std::sort(SortedBuilds.begin(), SortedBuilds.end(), [](const Build* Left, const Build* Right) {
+		return OffsetPackCompareBuild(&Left->Key, &Right->Key) < 0;
+	});
+
+	OFFSET_PACK_HEADER Header = { 0 };
+
+	Header.Magic = OFFSET_PACK_MAGIC;
+	Header.Version = OFFSET_PACK_VERSION;
+	Header.FieldCount = static_cast<uint32_t>(m_Fields.size());
+	Header.GroupCount = static_cast<uint32_t>(m_Groups.size());
+	Header.BuildCount = static_cast<uint32_t>(m_Builds.size());
+
+	Pack.clear();
+	Pack.resize(sizeof(Header));
+
+	Header.FieldsOffset = static_cast<uint32_t>(Pack.size());
+
+	for (auto&& PackedField : m_Fields)
+	{
+		OFFSET_PACK_FIELD FieldEntry = { PackedField.Group, PackedField.Index };
+		AppendBytes(Pack, &FieldEntry, sizeof(FieldEntry));
+	}
+
+	//
+	// Layouts follow all fixed-size parts, so their offsets
+	// are known before the groups are written.
+	//
+
+	Header.GroupsOffset = static_cast<uint32_t>(Pack.size());
+	Header.BuildsOffset = Header.GroupsOffset + Header.GroupCount * sizeof(OFFSET_PACK_GROUP);
+	Header.LayoutIndicesOffset = Header.BuildsOffset + Header.BuildCount * sizeof(OFFSET_PACK_BUILD);
+
+	uint32_t LayoutsOffset = (Header.LayoutIndicesOffset + Header.BuildCount * Header.GroupCount * sizeof(uint16_t) + 3) & ~3u;
+
+	for (auto&& FieldGroup : m_Groups)
+	{
+		OFFSET_PACK_GROUP GroupEntry;
+
+		GroupEntry.FieldCount = static_cast<uint32_t>(FieldGroup.Paths.size());
+		GroupEntry.LayoutCount = static_cast<uint32_t>(FieldGroup.Layouts.size());
+		GroupEntry.LayoutsOffset = LayoutsOffset;
+
+		AppendBytes(Pack, &GroupEntry, sizeof(GroupEntry));
+
+		LayoutsOffset += GroupEntry.FieldCount * GroupEntry.LayoutCount * sizeof(uint32_t);
+	}
+
+	for (auto&& SortedBuild : SortedBuilds)
+	{
+		AppendBytes(Pack, &SortedBuild->Key, sizeof(SortedBuild->Key));
+	}
+
+	for (auto&& SortedBuild : SortedBuilds)
+	{
+		AppendBytes(Pack, SortedBuild->LayoutIndices.data(), SortedBuild->LayoutIndices.size() * sizeof(WORD));
+	}
+
+	AlignPack(Pack);
+
+	for (auto&& FieldGroup : m_Groups)
+	{
+		for (auto&& Layout : FieldGroup.Layouts)
+		{
+			AppendBytes(Pack, Layout.data(), Layout.size() * sizeof(DWORD));
+		}
+	}
+
+	Header.Size = static_cast<uint32_t>(Pack.size());
+	memcpy(Pack.data(), &Header, sizeof(Header));
+}
+
+size_t
+PDBOffsetPack::GetLayoutCount() const
+{
+	size_t LayoutCount = 0;
+
+	for (auto&& FieldGroup : m_Groups)
+	{
+		LayoutCount += FieldGroup.Layouts.size();
+	}
+
+	return LayoutCount;
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include "PDB.h"
+#include "OffsetPack.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+//
+// Builds offset packs (see OffsetPack.h) of many builds of one
+// or more modules.
+//
+// Fields are loaded from a file, one per line, the type name
+// followed by the path of the field, or the type name alone for
+// the size of the type:
+//
+//   # type.path
+//   _EPROCESS.ActiveProcessLinks
+//   _EPROCESS.Pcb.DirectoryTableBase
+//   _KTHREAD.ApcState.Process
+//   _EPROCESS
+//
+// Position of the line is the index of the field in the pack.
+//
+// Fields of one type form a group. Offsets of a group are stored once
+// for every distinct layout of the type, builds only refer to them.
+//
+class PDBOffsetPack
+{
+	public:
+		struct Field
+		{
+			std::string TypeName;
+
+			//
+			// Empty for the size of the type.
+			//
+			std::string Path;
+
+			DWORD Group;
+			DWORD Index;
+		};
+
+		//
+		// Returns false if the file cannot be opened.
+		//
+		bool
+		LoadFields(
+			const char* Path
+			);
+
+		//
+		// Adds the build of the opened PDB. The module name is the name
+		// recorded in the PDB without the extension, the file name
+		// of the PdbPath is used only if the PDB has no name.
+		//
+		// Returns false if the PDB has no signature, the build is already
+		// in the pack or the pack is full (65535 layouts of a type).
+		//
+		bool
+		AddBuild(
+			PDB* Pdb,
+			const char* PdbPath,
+			DWORD& MissingFieldCount
+			);
+
+		void
+		Serialize(
+			std::vector<BYTE>& Pack
+			) const;
+
+		const std::vector<Field>&
+		GetFields() const
+		{
+			return m_Fields;
+		}
+
+		size_t
+		GetGroupCount() const
+		{
+			return m_Groups.size();
+		}
+
+		size_t
+		GetBuildCount() const
+		{
+			return m_Builds.size();
+		}
+
+		size_t
+		GetLayoutCount() const;
+
+	private:
+		struct Group
+		{
+			std::string TypeName;
+			std::vector<std::string> Paths;
+
+			//
+			// Distinct layouts in the order of insertion
+			// and their indices.
+			//
+			std::vector<std::vector<DWORD>> Layouts;
+			std::map<std::vector<DWORD>, WORD> LayoutIndices;
+		};
+
+		struct Build
+		{
+			OFFSET_PACK_BUILD Key;
+			std::vector<WORD> LayoutIndices;
+		};
+
+		std::vector<Field> m_Fields;
+		std::vector<Group> m_Groups;
+		std::vector<Build> m_Builds;
+};
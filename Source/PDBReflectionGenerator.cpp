@@ -0,0 +1,416 @@
+#include "PDBReflectionGenerator.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace
+{
+	static PDBReflectionGenerator::Settings DefaultSettings;
+
+	//
+	// Definitions shared by all generated tables.
+	//
+
+	static const char REFLECTION_DEFINITIONS[] =
+		"#ifndef PDBEX_REFLECTION_DEFINED\n"
+		"#define PDBEX_REFLECTION_DEFINED\n"
+		"\n"
+		"enum\n"
+		"{\n"
+		"  PDBEX_KIND_OTHER,\n"
+		"  PDBEX_KIND_VOID,\n"
+		"  PDBEX_KIND_CHAR,\n"
+		"  PDBEX_KIND_WCHAR,\n"
+		"  PDBEX_KIND_INT,\n"
+		"  PDBEX_KIND_UINT,\n"
+		"  PDBEX_KIND_FLOAT,\n"
+		"  PDBEX_KIND_BOOL,\n"
+		"  PDBEX_KIND_POINTER,\n"
+		"  PDBEX_KIND_ENUM,\n"
+		"  PDBEX_KIND_UDT,\n"
+		"  PDBEX_KIND_FUNCTION\n"
+		"};\n"
+		"\n"
+		"typedef struct _PDBEX_FIELD\n"
+		"{\n"
+		"  const char* Name;\n"
+		"  const char* TypeName;      /* type of the element, pointers end with '*' */\n"
+		"  unsigned int Offset;\n"
+		"  unsigned int Size;\n"
+		"  unsigned int ElementSize;\n"
+		"  unsigned int ElementCount; /* 1 if the field is not an array */\n"
+		"  int TypeIndex;             /* UDT of the element or pointed to, or -1 */\n"
+		"  unsigned char Kind;        /* PDBEX_KIND_* of the element */\n"
+		"  unsigned char Bits;        /* 0 if the field is not a bitfield */\n"
+		"  unsigned char BitPosition;\n"
+		"} PDBEX_FIELD;\n"
+		"\n"
+		"typedef struct _PDBEX_TYPE\n"
+		"{\n"
+		"  const char* Name;\n"
+		"  unsigned int Size;\n"
+		"  unsigned int FieldCount;\n"
+		"  const PDBEX_FIELD* Fields;\n"
+		"} PDBEX_TYPE;\n"
+		"\n"
+		"#endif\n"
+		"\n";
+
+	std::string
+	GetIdentifier(
+		const std::string& Name
+		)
+	{
+		std::string Identifier;
+
+		for (auto&& Character : Name)
+		{
+			Identifier += isalnum(static_cast<unsigned char>(Character))
+				? Character
+				: '_';
+		}
+
+		return Identifier;
+	}
+}
+
+PDBReflectionGenerator::PDBReflectionGenerator(
+	Settings* ReflectionSettings,
+	const PDBHeaderReconstructor* HeaderReconstructor
+	)
+	: m_HeaderReconstructor(HeaderReconstructor)
+{
+	m_Settings = ReflectionSettings ? ReflectionSettings : &DefaultSettings;
+}
+
+void
+PDBReflectionGenerator::Add(
+	const SYMBOL* Symbol,
+	const std::string& Name
+	)
+{
+	if (Symbol->Tag != SymTagUDT)
+	{
+		return;
+	}
+
+	if (m_CorrectedNameIndices.emplace(Name, m_Types.size()).second)
+	{
+		m_Types.push_back({ Symbol, Name });
+	}
+}
+
+void
+PDBReflectionGenerator::Write(
+	std::ostream& OutputFile
+	)
+{
+	if (m_Types.empty())
+	{
+		return;
+	}
+
+	std::sort(m_Types.begin(), m_Types.end(), [](const Type& Lhs, const Type& Rhs) {
+		return Lhs.Name < Rhs.Name;
+	});
+
+	m_TypeIndices.clear();
+	m_TypeNameIndices.clear();
+
+	for (size_t Index = 0; Index < m_Types.size(); Index++)
+	{
+		m_TypeIndices[m_Types[Index].Symbol] = Index;
+		m_CorrectedNameIndices[m_Types[Index].Name] = Index;
+
+		if (!PDB::IsUnnamedSymbol(m_Types[Index].Symbol))
+		{
+			m_TypeNameIndices.emplace(m_Types[Index].Symbol->Name, Index);
+		}
+	}
+
+	WriteDefinitions(OutputFile);
+
+	for (auto&& CurrentType : m_Types)
+	{
+		WriteFields(OutputFile, CurrentType);
+	}
+
+	WriteTypeIndex(OutputFile);
+}
+
+bool
+PDBReflectionGenerator::IsTableField(
+	const PDBFieldLayout::Field& CurrentField
+	)
+{
+	//
+	// Nested fields are described by the tables of their types,
+	// the padding at the end of the UDT is not a field of the type.
+	//
+
+	return CurrentField.ParentIndex == PDBFieldLayout::None &&
+	       !(CurrentField.UdtField->Name && strcmp(CurrentField.UdtField->Name, "__PADDING__") == 0);
+}
+
+void
+PDBReflectionGenerator::WriteDefinitions(
+	std::ostream& OutputFile
+	)
+{
+	OutputFile << REFLECTION_DEFINITIONS;
+}
+
+void
+PDBReflectionGenerator::WriteFields(
+	std::ostream& OutputFile,
+	const Type& CurrentType
+	)
+{
+	PDBFieldLayout Layout(CurrentType.Symbol);
+
+	bool HasFields = std::any_of(Layout.GetFields().begin(), Layout.GetFields().end(), IsTableField);
+
+	//
+	// Empty arrays are not allowed in C.
+	//
+
+	if (!HasFields)
+	{
+		return;
+	}
+
+	OutputFile << "static const PDBEX_FIELD " << GetIdentifier(CurrentType.Name) << "_Fields[] =" << std::endl;
+	OutputFile << "{" << std::endl;
+
+	for (auto&& CurrentField : Layout.GetFields())
+	{
+		if (!IsTableField(CurrentField))
+		{
+			continue;
+		}
+
+		const SYMBOL* ElementType = CurrentField.Type;
+		DWORD ElementCount = 1;
+
+		while (ElementType->Tag == SymTagArrayType)
+		{
+			ElementCount *= ElementType->u.Array.ElementCount;
+			ElementType = PDBFieldLayout::GetUnderlyingType(ElementType->u.Array.ElementType);
+		}
+
+		//
+		// Names of C++ types may be arbitrarily long.
+		//
+
+		OutputFile
+			<< "  { \"" << CurrentField.UdtField->Name << "\""
+			<< ", \"" << GetTypeName(ElementType) << "\""
+			<< std::hex
+			<< ", 0x" << CurrentField.Offset
+			<< ", 0x" << CurrentField.Size
+			<< ", 0x" << ElementType->Size
+			<< std::dec
+			<< ", " << ElementCount
+			<< ", " << GetTypeIndex(ElementType)
+			<< ", " << GetKindString(ElementType)
+			<< ", " << CurrentField.Bits
+			<< ", " << CurrentField.BitPosition
+			<< " }," << std::endl;
+	}
+
+	OutputFile << "};" << std::endl;
+	OutputFile << std::endl;
+}
+
+void
+PDBReflectionGenerator::WriteTypeIndex(
+	std::ostream& OutputFile
+	)
+{
+	const std::string& IndexName = m_Settings->TypeIndexName;
+
+	OutputFile << "static const PDBEX_TYPE " << IndexName << "[" << m_Types.size() << "] =" << std::endl;
+	OutputFile << "{" << std::endl;
+
+	for (auto&& CurrentType : m_Types)
+	{
+		PDBFieldLayout Layout(CurrentType.Symbol);
+
+		DWORD FieldCount = static_cast<DWORD>(std::count_if(Layout.GetFields().begin(), Layout.GetFields().end(), IsTableField));
+
+		OutputFile
+			<< "  { \"" << CurrentType.Name << "\""
+			<< ", 0x" << std::hex << CurrentType.Symbol->Size << std::dec
+			<< ", " << FieldCount
+			<< ", " << (FieldCount != 0 ? GetIdentifier(CurrentType.Name) + "_Fields" : "0")
+			<< " }," << std::endl;
+	}
+
+	OutputFile << "};" << std::endl;
+	OutputFile << std::endl;
+
+	//
+	// Binary search in the type index by the name.
+	//
+
+	OutputFile << "static __inline const PDBEX_TYPE* " << IndexName << "_Find(const char* Name)" << std::endl;
+	OutputFile << "{" << std::endl;
+	OutputFile << "  unsigned int Low = 0;" << std::endl;
+	OutputFile << "  unsigned int High = " << m_Types.size() << ";" << std::endl;
+	OutputFile << std::endl;
+	OutputFile << "  while (Low < High)" << std::endl;
+	OutputFile << "  {" << std::endl;
+	OutputFile << "    unsigned int Middle = (Low + High) / 2;" << std::endl;
+	OutputFile << "    const unsigned char* Lhs = (const unsigned char*)" << IndexName << "[Middle].Name;" << std::endl;
+	OutputFile << "    const unsigned char* Rhs = (const unsigned char*)Name;" << std::endl;
+	OutputFile << std::endl;
+	OutputFile << "    while (*Lhs && *Lhs == *Rhs)" << std::endl;
+	OutputFile << "    {" << std::endl;
+	OutputFile << "      Lhs++;" << std::endl;
+	OutputFile << "      Rhs++;" << std::endl;
+	OutputFile << "    }" << std::endl;
+	OutputFile << std::endl;
+	OutputFile << "    if (*Lhs == *Rhs)" << std::endl;
+	OutputFile << "      return &" << IndexName << "[Middle];" << std::endl;
+	OutputFile << "    else if (*Lhs < *Rhs)" << std::endl;
+	OutputFile << "      Low = Middle + 1;" << std::endl;
+	OutputFile << "    else" << std::endl;
+	OutputFile << "      High = Middle;" << std::endl;
+	OutputFile << "  }" << std::endl;
+	OutputFile << std::endl;
+	OutputFile << "  return 0;" << std::endl;
+	OutputFile << "}" << std::endl;
+	OutputFile << std::endl;
+}
+
+std::string
+PDBReflectionGenerator::GetTypeName(
+	const SYMBOL* Symbol
+	) const
+{
+	switch (Symbol->Tag)
+	{
+		case SymTagBaseType:
+		{
+			const CHAR* BasicTypeString = PDB::GetBasicTypeString(Symbol);
+			return BasicTypeString ? BasicTypeString : "";
+		}
+
+		case SymTagPointerType:
+			return GetTypeName(PDBFieldLayout::GetUnderlyingType(Symbol->u.Pointer.Type)) + "*";
+
+		case SymTagEnum:
+		case SymTagUDT:
+		{
+			int TypeIndex = GetTypeIndex(Symbol);
+
+			if (TypeIndex >= 0)
+			{
+				return m_Types[TypeIndex].Name;
+			}
+
+			return m_HeaderReconstructor
+				? m_HeaderReconstructor->GetCorrectedSymbolName(Symbol)
+				: Symbol->Name;
+		}
+
+		default:
+			return "";
+	}
+}
+
+int
+PDBReflectionGenerator::GetTypeIndex(
+	const SYMBOL* Symbol
+	) const
+{
+	if (Symbol->Tag == SymTagPointerType)
+	{
+		Symbol = PDBFieldLayout::GetUnderlyingType(Symbol->u.Pointer.Type);
+	}
+
+	if (Symbol->Tag != SymTagUDT)
+	{
+		return -1;
+	}
+
+	auto It = m_TypeIndices.find(Symbol);
+
+	if (It != m_TypeIndices.end())
+	{
+		return static_cast<int>(It->second);
+	}
+
+	//
+	// Other definitions of the type with the same name
+	// are represented by the first one.
+	//
+
+	if (!PDB::IsUnnamedSymbol(Symbol))
+	{
+		auto NameIt = m_TypeNameIndices.find(Symbol->Name);
+
+		if (NameIt != m_TypeNameIndices.end())
+		{
+			return static_cast<int>(NameIt->second);
+		}
+	}
+
+	return -1;
+}
+
+const CHAR*
+PDBReflectionGenerator::GetKindString(
+	const SYMBOL* Symbol
+	)
+{
+	switch (Symbol->Tag)
+	{
+		case SymTagBaseType:
+			switch (Symbol->BaseType)
+			{
+				case btVoid:
+					return "PDBEX_KIND_VOID";
+
+				case btChar:
+					return "PDBEX_KIND_CHAR";
+
+				case btWChar:
+					return "PDBEX_KIND_WCHAR";
+
+				case btInt:
+				case btLong:
+				case btHresult:
+					return "PDBEX_KIND_INT";
+
+				case btUInt:
+				case btULong:
+					return "PDBEX_KIND_UINT";
+
+				case btFloat:
+					return "PDBEX_KIND_FLOAT";
+
+				case btBool:
+					return "PDBEX_KIND_BOOL";
+
+				default:
+					return "PDBEX_KIND_OTHER";
+			}
+
+		case SymTagPointerType:
+			return "PDBEX_KIND_POINTER";
+
+		case SymTagEnum:
+			return "PDBEX_KIND_ENUM";
+
+		case SymTagUDT:
+			return "PDBEX_KIND_UDT";
+
+		case SymTagFunctionType:
+			return "PDBEX_KIND_FUNCTION";
+
+		default:
+			return "PDBEX_KIND_OTHER";
+	}
+}
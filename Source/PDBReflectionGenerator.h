@@ -0,0 +1,131 @@
+#pragma once
+#include "PDB.h"
+#include "PDBFieldLayout.h"
+#include "PDBHeaderReconstructor.h"
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+//
+// Generates static reflection tables of UDTs, so one data-driven
+// routine can print or serialize any type without per-type code:
+//
+//   static const PDBEX_FIELD _KPROCESS_Fields[] =
+//   {
+//     { "Header", "_DISPATCHER_HEADER", 0x0, 0x18, 0x18, 1, 3, PDBEX_KIND_UDT, 0, 0 },
+//     ...
+//   };
+//
+//   static const PDBEX_TYPE PdbexTypes[] =
+//   {
+//     { "_KPROCESS", 0x438, 41, _KPROCESS_Fields },
+//     ...
+//   };
+//
+// Fields are the top-level fields of PDBFieldLayout, without the
+// __PADDING__ fields added by pdbex. Types are sorted by their names
+// (byte-wise, as strcmp() does), TypeIndex of the field refers to
+// the type of the UDT element or of the UDT pointed to (-1 if there
+// is none), so nested types can be followed. Names of the types are
+// the corrected names of the HeaderReconstructor, if there is one.
+//
+class PDBReflectionGenerator
+{
+	public:
+		struct Settings
+		{
+			//
+			// Name of the type index.
+			//
+			std::string TypeIndexName = "PdbexTypes";
+		};
+
+		PDBReflectionGenerator(
+			Settings* ReflectionSettings = nullptr,
+			const PDBHeaderReconstructor* HeaderReconstructor = nullptr
+			);
+
+		//
+		// Adds UDT to the tables.
+		// Name is the (corrected) name of the UDT.
+		//
+		void
+		Add(
+			const SYMBOL* Symbol,
+			const std::string& Name
+			);
+
+		void
+		Write(
+			std::ostream& OutputFile
+			);
+
+	private:
+		struct Type
+		{
+			const SYMBOL* Symbol;
+			std::string Name;
+		};
+
+		//
+		// Returns true if the field is described by the table.
+		//
+		static
+		bool
+		IsTableField(
+			const PDBFieldLayout::Field& CurrentField
+			);
+
+		void
+		WriteDefinitions(
+			std::ostream& OutputFile
+			);
+
+		void
+		WriteFields(
+			std::ostream& OutputFile,
+			const Type& CurrentType
+			);
+
+		void
+		WriteTypeIndex(
+			std::ostream& OutputFile
+			);
+
+		//
+		// Returns the name of the type as referenced by the field.
+		//
+		std::string
+		GetTypeName(
+			const SYMBOL* Symbol
+			) const;
+
+		//
+		// Returns index of the UDT in the type index, or -1.
+		//
+		int
+		GetTypeIndex(
+			const SYMBOL* Symbol
+			) const;
+
+		static
+		const CHAR*
+		GetKindString(
+			const SYMBOL* Symbol
+			);
+
+	private:
+		Settings* m_Settings;
+		const PDBHeaderReconstructor* m_HeaderReconstructor;
+
+		std::vector<Type> m_Types;
+		std::map<const SYMBOL*, size_t> m_TypeIndices;
+		std::map<std::string, size_t> m_TypeNameIndices;
+
+		//
+		// Corrected name -> index of the type in the m_Types.
+		//
+		std::map<std::string, size_t> m_CorrectedNameIndices;
+};
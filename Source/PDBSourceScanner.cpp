@@ -0,0 +1,444 @@
+#include "PDBSourceScanner.h"
+#include "WorkerThreads.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+	static PDBSourceScanner::Settings DefaultSettings;
+
+	static const char* const SourceExtensions[] = {
+		".c", ".cc", ".cpp", ".cxx", ".h", ".hh", ".hpp", ".hxx", ".inl",
+	};
+
+	static const ULONGLONG FNV_OFFSET_BASIS = 14695981039346656037ull;
+	static const ULONGLONG FNV_PRIME        = 1099511628211ull;
+
+	inline
+	bool
+	IsIdentifierStart(
+		char Character
+		)
+	{
+		return (Character >= 'a' && Character <= 'z') ||
+		       (Character >= 'A' && Character <= 'Z') ||
+		       Character == '_' || Character == '$' ||
+		       static_cast<unsigned char>(Character) >= 0x80;
+	}
+
+	inline
+	bool
+	IsIdentifierCharacter(
+		char Character
+		)
+	{
+		return IsIdentifierStart(Character) || (Character >= '0' && Character <= '9');
+	}
+
+	inline
+	bool
+	IsSourceFile(
+		const std::string& FileName
+		)
+	{
+		size_t Dot = FileName.find_last_of('.');
+
+		if (Dot == std::string::npos)
+		{
+			return false;
+		}
+
+		for (auto&& Extension : SourceExtensions)
+		{
+			if (_stricmp(FileName.c_str() + Dot, Extension) == 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	//
+	// Skips the quoted literal, Position points to the opening quote.
+	//
+	inline
+	const char*
+	SkipLiteral(
+		const char* Position,
+		const char* End
+		)
+	{
+		char Quote = *Position++;
+
+		while (Position < End && *Position != Quote && *Position != '\n')
+		{
+			if (*Position == '\\' && Position + 1 < End)
+			{
+				Position++;
+			}
+
+			Position++;
+		}
+
+		return Position < End ? Position + 1 : End;
+	}
+
+	//
+	// Skips the raw string literal R"delimiter( ... )delimiter",
+	// Position points to the opening quote.
+	//
+	inline
+	const char*
+	SkipRawLiteral(
+		const char* Position,
+		const char* End
+		)
+	{
+		const char* DelimiterBegin = ++Position;
+
+		while (Position < End && *Position != '(' && *Position != '\n')
+		{
+			Position++;
+		}
+
+		if (Position >= End || *Position != '(')
+		{
+			return Position;
+		}
+
+		std::string Terminator = ")" + std::string(DelimiterBegin, Position) + "\"";
+
+		const char* Found = std::search(Position, End, Terminator.begin(), Terminator.end());
+
+		return Found < End ? Found + Terminator.size() : End;
+	}
+}
+
+const DWORD PDBSourceScanner::None;
+
+PDBSourceScanner::PDBSourceScanner(
+	PDB* Pdb,
+	Settings* ScannerSettings
+	)
+{
+	m_Settings = ScannerSettings ? ScannerSettings : &DefaultSettings;
+
+	Pdb->GetSymbolNameIndex().ForEach([this](const std::string& Name, const SYMBOL* Symbol) {
+		if ((Symbol->Tag != SymTagUDT && Symbol->Tag != SymTagEnum && Symbol->Tag != SymTagTypedef) ||
+		    PDB::IsUnnamedSymbol(Symbol))
+		{
+			return;
+		}
+
+		std::string CorrectedName = m_Settings->SymbolPrefix + Name + m_Settings->SymbolSuffix;
+
+		AddName(CorrectedName, Symbol);
+
+		if (m_Settings->MicrosoftTypedefs && CorrectedName[0] == '_' && Symbol->Tag != SymTagTypedef)
+		{
+			AddName(CorrectedName.substr(1), Symbol);
+			AddName("P" + CorrectedName.substr(1), Symbol);
+		}
+	});
+}
+
+bool
+PDBSourceScanner::AddPath(
+	const std::string& Path
+	)
+{
+	DWORD Attributes = GetFileAttributesA(Path.c_str());
+
+	if (Attributes == INVALID_FILE_ATTRIBUTES)
+	{
+		return false;
+	}
+
+	if (!(Attributes & FILE_ATTRIBUTE_DIRECTORY))
+	{
+		m_Files.push_back(Path);
+		return true;
+	}
+
+	WIN32_FIND_DATAA FindData;
+	HANDLE FindHandle = FindFirstFileA((Path + "\\*").c_str(), &FindData);
+
+	if (FindHandle == INVALID_HANDLE_VALUE)
+	{
+		return true;
+	}
+
+	do
+	{
+		std::string FileName = FindData.cFileName;
+
+		if (FileName == "." || FileName == "..")
+		{
+			continue;
+		}
+
+		if (FindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+		{
+			AddPath(Path + "\\" + FileName);
+		}
+		else if (IsSourceFile(FileName))
+		{
+			m_Files.push_back(Path + "\\" + FileName);
+		}
+	} while (FindNextFileA(FindHandle, &FindData));
+
+	FindClose(FindHandle);
+
+	return true;
+}
+
+bool
+PDBSourceScanner::Scan(
+	SymbolList& Symbols
+	) const
+{
+	DWORD ThreadCount = WorkerThreads::GetCount(m_Settings->ThreadCount);
+
+	ThreadCount = static_cast<DWORD>((std::min)(static_cast<size_t>(ThreadCount), m_Files.size()));
+
+	if (ThreadCount == 0)
+	{
+		ThreadCount = 1;
+	}
+
+	//
+	// Every worker marks referenced names of a contiguous range
+	// of the files into its own vector, they are merged afterwards.
+	//
+
+	std::vector<std::vector<char>> Referenced(ThreadCount, std::vector<char>(m_Names.size(), 0));
+	std::vector<char> Failed(ThreadCount, 0);
+
+	WorkerThreads::RunRanges(m_Files.size(), ThreadCount, [this, &Referenced, &Failed](DWORD ThreadIndex, size_t Begin, size_t End) {
+		std::vector<char> Buffer;
+
+		for (size_t i = Begin; i < End; i++)
+		{
+			std::ifstream SourceFile(m_Files[i], std::ios::in | std::ios::binary);
+
+			if (!SourceFile.is_open())
+			{
+				Failed[ThreadIndex] = 1;
+				continue;
+			}
+
+			Buffer.assign(std::istreambuf_iterator<char>(SourceFile), std::istreambuf_iterator<char>());
+
+			ScanSource(Buffer.data(), Buffer.data() + Buffer.size(), Referenced[ThreadIndex]);
+		}
+	});
+
+	//
+	// More names may refer to the same symbol (EPROCESS, PEPROCESS).
+	//
+
+	std::vector<const Name*> ReferencedNames;
+
+	for (size_t i = 0; i < m_Names.size(); i++)
+	{
+		bool IsReferenced = std::any_of(Referenced.begin(), Referenced.end(), [i](const std::vector<char>& ThreadReferenced) {
+			return ThreadReferenced[i] != 0;
+		});
+
+		if (IsReferenced)
+		{
+			ReferencedNames.push_back(&m_Names[i]);
+		}
+	}
+
+	std::sort(ReferencedNames.begin(), ReferencedNames.end(), [](const Name* Left, const Name* Right) {
+		return strcmp(Left->Symbol->Name, Right->Symbol->Name) < 0;
+	});
+
+	for (auto&& ReferencedName : ReferencedNames)
+	{
+		if (Symbols.empty() || Symbols.back() != ReferencedName->Symbol)
+		{
+			Symbols.push_back(ReferencedName->Symbol);
+		}
+	}
+
+	return std::find(Failed.begin(), Failed.end(), 1) == Failed.end();
+}
+
+void
+PDBSourceScanner::AddName(
+	const std::string& Text,
+	const SYMBOL* Symbol
+	)
+{
+	ULONGLONG Hash = FNV_OFFSET_BASIS;
+
+	for (auto&& Character : Text)
+	{
+		Hash = (Hash ^ static_cast<unsigned char>(Character)) * FNV_PRIME;
+	}
+
+	DWORD Index = static_cast<DWORD>(m_Names.size());
+	auto It = m_NameIndices.find(Hash);
+
+	m_Names.push_back({ Text, Symbol, It != m_NameIndices.end() ? It->second : None });
+	m_NameIndices[Hash] = Index;
+}
+
+void
+PDBSourceScanner::ScanSource(
+	const char* Begin,
+	const char* End,
+	std::vector<char>& Referenced
+	) const
+{
+	const char* Position = Begin;
+
+	//
+	// Preprocessor directive is recognized only at the beginning of the line.
+	//
+
+	bool LineStart = true;
+
+	while (Position < End)
+	{
+		char Character = *Position;
+
+		if (Character == '\n')
+		{
+			LineStart = true;
+			Position++;
+		}
+		else if (Character == ' ' || Character == '\t' || Character == '\r' || Character == '\f' || Character == '\v')
+		{
+			Position++;
+		}
+		else if (Character == '/' && Position + 1 < End && Position[1] == '/')
+		{
+			Position = std::find(Position, End, '\n');
+		}
+		else if (Character == '/' && Position + 1 < End && Position[1] == '*')
+		{
+			static const char CommentEnd[] = "*/";
+
+			const char* Found = std::search(Position + 2, End, CommentEnd, CommentEnd + 2);
+			Position = Found < End ? Found + 2 : End;
+		}
+		else if (Character == '"' || Character == '\'')
+		{
+			Position = SkipLiteral(Position, End);
+			LineStart = false;
+		}
+		else if (Character == '#' && LineStart)
+		{
+			//
+			// Names of included files are not identifiers.
+			//
+
+			const char* Directive = Position + 1;
+
+			while (Directive < End && (*Directive == ' ' || *Directive == '\t'))
+			{
+				Directive++;
+			}
+
+			if (End - Directive >= 7 && memcmp(Directive, "include", 7) == 0)
+			{
+				Position = std::find(Directive, End, '\n');
+			}
+			else
+			{
+				Position = Directive;
+			}
+
+			LineStart = false;
+		}
+		else if ((Character >= '0' && Character <= '9') ||
+		         (Character == '.' && Position + 1 < End && Position[1] >= '0' && Position[1] <= '9'))
+		{
+			//
+			// Numbers, including suffixes (0x1F, 1.5e+3f, 10'000ull).
+			//
+
+			char Previous = 0;
+
+			while (Position < End &&
+			       (IsIdentifierCharacter(*Position) || *Position == '.' || *Position == '\'' ||
+			        ((*Position == '+' || *Position == '-') &&
+			         (Previous == 'e' || Previous == 'E' || Previous == 'p' || Previous == 'P'))))
+			{
+				Previous = *Position++;
+			}
+
+			LineStart = false;
+		}
+		else if (IsIdentifierStart(Character))
+		{
+			const char* IdentifierBegin = Position;
+			ULONGLONG Hash = FNV_OFFSET_BASIS;
+
+			do
+			{
+				Hash = (Hash ^ static_cast<unsigned char>(*Position)) * FNV_PRIME;
+				Position++;
+			} while (Position < End && IsIdentifierCharacter(*Position));
+
+			//
+			// Encoding prefixes of literals (L"", u8"", R"(...)").
+			//
+
+			if (Position < End && (*Position == '"' || *Position == '\''))
+			{
+				bool IsRaw = Position[-1] == 'R' && *Position == '"';
+
+				Position = IsRaw
+					? SkipRawLiteral(Position, End)
+					: SkipLiteral(Position, End);
+			}
+			else
+			{
+				LookupIdentifier(IdentifierBegin, Position, Hash, Referenced);
+			}
+
+			LineStart = false;
+		}
+		else
+		{
+			Position++;
+			LineStart = false;
+		}
+	}
+}
+
+void
+PDBSourceScanner::LookupIdentifier(
+	const char* Begin,
+	const char* End,
+	ULONGLONG Hash,
+	std::vector<char>& Referenced
+	) const
+{
+	auto It = m_NameIndices.find(Hash);
+
+	if (It == m_NameIndices.end())
+	{
+		return;
+	}
+
+	size_t Length = static_cast<size_t>(End - Begin);
+
+	for (DWORD Index = It->second; Index != None; Index = m_Names[Index].Next)
+	{
+		const std::string& Text = m_Names[Index].Text;
+
+		if (Text.size() == Length && memcmp(Text.data(), Begin, Length) == 0)
+		{
+			Referenced[Index] = 1;
+		}
+	}
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include "PDB.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//
+// Finds types of the PDB which are referenced by C/C++ sources.
+//
+// Sources are not parsed, only tokenized: comments, string
+// and character literals, numbers and names of included files
+// are skipped, every other identifier is looked up in the table
+// of type names of the PDB.
+//
+// Names are matched as they are printed by the header reconstructor,
+// including the symbol prefix and suffix and the Microsoft typedefs:
+//
+//   _EPROCESS      struct _EPROCESS
+//   EPROCESS       typedef struct _EPROCESS { ... } EPROCESS, *PEPROCESS;
+//   PEPROCESS
+//
+class PDBSourceScanner
+{
+	public:
+		struct Settings
+		{
+			std::string SymbolPrefix;
+			std::string SymbolSuffix;
+
+			bool MicrosoftTypedefs = true;
+
+			//
+			// Count of worker threads, 0 means count of CPUs.
+			//
+			DWORD ThreadCount = 0;
+		};
+
+		PDBSourceScanner(
+			PDB* Pdb,
+			Settings* ScannerSettings = nullptr
+			);
+
+		//
+		// Adds the source file, or all C/C++ sources and headers
+		// of the directory and its subdirectories.
+		//
+		// Returns false if the path does not exist.
+		//
+		bool
+		AddPath(
+			const std::string& Path
+			);
+
+		//
+		// Returns referenced types sorted by their names.
+		//
+		// Returns false if any of the files cannot be read.
+		//
+		bool
+		Scan(
+			SymbolList& Symbols
+			) const;
+
+	private:
+		struct Name
+		{
+			std::string Text;
+			const SYMBOL* Symbol;
+
+			//
+			// Next name with the same hash, or None.
+			//
+			DWORD Next;
+		};
+
+		static const DWORD None = static_cast<DWORD>(-1);
+
+		void
+		AddName(
+			const std::string& Text,
+			const SYMBOL* Symbol
+			);
+
+		//
+		// Marks names referenced by the source.
+		//
+		void
+		ScanSource(
+			const char* Begin,
+			const char* End,
+			std::vector<char>& Referenced
+			) const;
+
+		void
+		LookupIdentifier(
+			const char* Begin,
+			const char* End,
+			ULONGLONG Hash,
+			std::vector<char>& Referenced
+			) const;
+
+	private:
+		Settings* m_Settings;
+
+		std::vector<Name> m_Names;
+
+		//
+		// Hash of the name -> index of the first name with the hash.
+		//
+		std::unordered_map<ULONGLONG, DWORD> m_NameIndices;
+
+		std::vector<std::string> m_Files;
+};
@@ -0,0 +1,142 @@
+#pragma once
+#include "PDBHeaderReconstructor.h"
+
+//
+// Traits which read the settings at runtime.
+// Used for combinations of settings which are not specialized.
+//
+struct PDBHeaderReconstructorRuntimeTraits
+{
+	using Settings = PDBHeaderReconstructor::Settings;
+	using MemberStructExpansionType = PDBHeaderReconstructor::MemberStructExpansionType;
+
+	static bool ShowOffsets(const Settings* VisitorSettings)             { return VisitorSettings->ShowOffsets; }
+	static bool CreatePaddingMembers(const Settings* VisitorSettings)    { return VisitorSettings->CreatePaddingMembers; }
+	static bool MicrosoftTypedefs(const Settings* VisitorSettings)       { return VisitorSettings->MicrosoftTypedefs; }
+	static bool AllowAnonymousDataTypes(const Settings* VisitorSettings) { return VisitorSettings->AllowAnonymousDataTypes; }
+
+	static MemberStructExpansionType MemberStructExpansion(const Settings* VisitorSettings) { return VisitorSettings->MemberStructExpansion; }
+};
+
+//
+// Traits with the settings fixed at compile time,
+// so the compiler can remove the branches depending on them.
+//
+template <
+	bool SHOW_OFFSETS,
+	bool CREATE_PADDING_MEMBERS,
+	bool MICROSOFT_TYPEDEFS,
+	bool ALLOW_ANONYMOUS_DATA_TYPES,
+	PDBHeaderReconstructor::MemberStructExpansionType MEMBER_STRUCT_EXPANSION
+>
+struct PDBHeaderReconstructorStaticTraits
+{
+	using Settings = PDBHeaderReconstructor::Settings;
+	using MemberStructExpansionType = PDBHeaderReconstructor::MemberStructExpansionType;
+
+	static bool ShowOffsets(const Settings*)             { return SHOW_OFFSETS; }
+	static bool CreatePaddingMembers(const Settings*)    { return CREATE_PADDING_MEMBERS; }
+	static bool MicrosoftTypedefs(const Settings*)       { return MICROSOFT_TYPEDEFS; }
+	static bool AllowAnonymousDataTypes(const Settings*) { return ALLOW_ANONYMOUS_DATA_TYPES; }
+
+	static MemberStructExpansionType MemberStructExpansion(const Settings*) { return MEMBER_STRUCT_EXPANSION; }
+};
+
+//
+// Implements callbacks of the PDBHeaderReconstructor which depend
+// on the settings described by the TRAITS.
+//
+// Use PDBHeaderReconstructor::Create() to instantiate it.
+//
+template <
+	typename TRAITS
+>
+class PDBSpecializedHeaderReconstructor
+	: public PDBHeaderReconstructor
+{
+	public:
+		PDBSpecializedHeaderReconstructor(
+			Settings* VisitorSettings = nullptr
+			);
+
+	protected:
+		bool
+		OnEnumType(
+			const SYMBOL* Symbol
+			) override;
+
+		void
+		OnEnumTypeBegin(
+			const SYMBOL* Symbol
+			) override;
+
+		void
+		OnEnumTypeEnd(
+			const SYMBOL* Symbol
+			) override;
+
+		bool
+		OnUdt(
+			const SYMBOL* Symbol
+			) override;
+
+		void
+		OnUdtBegin(
+			const SYMBOL* Symbol
+			) override;
+
+		void
+		OnUdtEnd(
+			const SYMBOL* Symbol
+			) override;
+
+		void
+		OnUdtFieldBegin(
+			const SYMBOL_UDT_FIELD* UdtField
+			) override;
+
+		void
+		OnAnonymousUdtEnd(
+			UdtKind Kind,
+			const SYMBOL_UDT_FIELD* FirstUdtField,
+			const SYMBOL_UDT_FIELD* LastUdtField,
+			DWORD Size
+			) override;
+
+		void
+		OnPaddingMember(
+			const SYMBOL_UDT_FIELD* UdtField,
+			BasicType PaddingBasicType,
+			DWORD PaddingBasicTypeSize,
+			DWORD PaddingSize
+			) override;
+
+	private:
+		void
+		WriteUnnamedDataType(
+			UdtKind Kind
+			);
+
+		void
+		WriteTypedefBegin(
+			const SYMBOL* Symbol
+			);
+
+		void
+		WriteTypedefEnd(
+			const SYMBOL* Symbol
+			);
+
+		void
+		WriteOffset(
+			const SYMBOL_UDT_FIELD* UdtField,
+			int PaddingOffset
+			);
+
+		bool
+		ShouldExpand(
+			const SYMBOL* Symbol
+			) const;
+};
+
+#include "PDBSpecializedHeaderReconstructor.inl"
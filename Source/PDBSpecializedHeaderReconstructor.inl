@@ -0,0 +1,419 @@
+#include "PDBSpecializedHeaderReconstructor.h"
+
+#pragma once
+#include "PDBHeaderReconstructor.h"
+
+#include <string>
+
+#include <cassert>
+
+template <
+	typename TRAITS
+>
+PDBSpecializedHeaderReconstructor<TRAITS>::PDBSpecializedHeaderReconstructor(
+	Settings* VisitorSettings
+	)
+	: PDBHeaderReconstructor(VisitorSettings)
+{
+
+}
+
+template <
+	typename TRAITS
+>
+bool
+PDBSpecializedHeaderReconstructor<TRAITS>::OnEnumType(
+	const SYMBOL* Symbol
+	)
+{
+	std::string CorrectedName = GetCorrectedSymbolName(Symbol);
+
+	bool Expand = ShouldExpand(Symbol);
+
+	MarkAsVisited(Symbol);
+
+	if (!Expand)
+	{
+		Write("enum %s", CorrectedName.c_str());
+	}
+
+	return Expand;
+}
+
+template <
+	typename TRAITS
+>
+void
+PDBSpecializedHeaderReconstructor<TRAITS>::OnEnumTypeBegin(
+	const SYMBOL* Symbol
+	)
+{
+	std::string CorrectedName = GetCorrectedSymbolName(Symbol);
+
+	//
+	// Handle begin of the typedef.
+	//
+
+	WriteTypedefBegin(Symbol);
+
+	Write("enum");
+
+	if (PDB::IsUnnamedSymbol(Symbol) && m_Depth != 0)
+	{
+		Write(" //");
+	}
+
+	Write(" %s", CorrectedName.c_str());
+	Write("\n");
+	
+	WriteIndent();
+	Write("{\n");
+	
+	m_Depth += 1;
+}
+
+template <
+	typename TRAITS
+>
+void
+PDBSpecializedHeaderReconstructor<TRAITS>::OnEnumTypeEnd(
+	const SYMBOL* Symbol
+	)
+{
+	m_Depth -= 1;
+	
+	WriteIndent();
+	Write("}");
+
+	//
+	// Handle end of the typedef.
+	//
+
+	WriteTypedefEnd(Symbol);
+
+	if (m_Depth == 0)
+	{
+		Write(";\n\n");
+	}
+}
+
+template <
+	typename TRAITS
+>
+bool
+PDBSpecializedHeaderReconstructor<TRAITS>::OnUdt(
+	const SYMBOL* Symbol
+	)
+{
+	bool Expand = ShouldExpand(Symbol);
+
+	//
+	// Nested UDTs expanded by InlineAll are written from the cache
+	// if they have been rendered before, otherwise they are recorded.
+	//
+
+	if (Expand &&
+	    TRAITS::MemberStructExpansion(m_Settings) == PDBHeaderReconstructor::MemberStructExpansionType::InlineAll &&
+	    CanCacheSubtree())
+	{
+		if (WriteCachedSubtree(Symbol))
+		{
+			return false;
+		}
+
+		BeginSubtree(Symbol);
+	}
+
+	MarkAsVisited(Symbol);
+
+	if (!Expand)
+	{
+		std::string CorrectedName = GetCorrectedSymbolName(Symbol);
+
+		WriteConstAndVolatile(Symbol);
+
+		Write("%s %s", PDB::GetUdtKindString(Symbol->u.Udt.Kind), CorrectedName.c_str());
+
+		//
+		// If we're not expanding the type at the root level,
+		// OnUdtEnd() won't be called, so print the semicolon here.
+		//
+
+		if (m_Depth == 0)
+		{
+			Write(";\n\n");
+		}
+	}
+
+	return Expand;
+}
+
+template <
+	typename TRAITS
+>
+void
+PDBSpecializedHeaderReconstructor<TRAITS>::OnUdtBegin(
+	const SYMBOL* Symbol
+	)
+{
+	//
+	// Handle begin of the typedef.
+	//
+
+	WriteTypedefBegin(Symbol);
+
+	WriteConstAndVolatile(Symbol);
+
+	Write("%s", PDB::GetUdtKindString(Symbol->u.Udt.Kind));
+	
+	if (PDB::IsUnnamedSymbol(Symbol) && m_Depth != 0)
+	{
+		Write(" //");
+	}
+
+	std::string CorrectedName = GetCorrectedSymbolName(Symbol);
+	Write(" %s", CorrectedName.c_str());
+
+	Write("\n");
+
+	WriteIndent();
+	Write("{\n");
+
+	m_Depth += 1;
+}
+
+template <
+	typename TRAITS
+>
+void
+PDBSpecializedHeaderReconstructor<TRAITS>::OnUdtEnd(
+	const SYMBOL* Symbol
+	)
+{
+	m_Depth -= 1;
+
+	WriteIndent();
+	Write("}");
+
+	//
+	// Handle end of the typedef.
+	//
+
+	WriteTypedefEnd(Symbol);
+
+	if (m_Depth == 0)
+	{
+		Write(";");
+	}
+
+	Write(" /* size: 0x%04x */", Symbol->Size);
+
+	if (m_Depth == 0)
+	{
+		Write("\n\n");
+	}
+
+	EndSubtree(Symbol);
+}
+
+template <
+	typename TRAITS
+>
+void
+PDBSpecializedHeaderReconstructor<TRAITS>::OnUdtFieldBegin(
+	const SYMBOL_UDT_FIELD* UdtField
+	)
+{
+	WriteIndent();
+
+	//
+	// Do not show offsets for members which will be expanded.
+	//
+
+	if (UdtField->Type->Tag != SymTagUDT ||
+	    ShouldExpand(UdtField->Type) == false)
+	{
+		if (TRAITS::ShowOffsets(m_Settings))
+		{
+			WriteFieldOffset(UdtField);
+		}
+	}
+
+	AppendToTest(UdtField);
+
+	//
+	// Push current offset in case we will be expanding
+	// some UDT field.
+	//
+
+	m_OffsetStack.push_back(UdtField->Offset);
+}
+
+template <
+	typename TRAITS
+>
+void
+PDBSpecializedHeaderReconstructor<TRAITS>::OnAnonymousUdtEnd(
+	UdtKind Kind,
+	const SYMBOL_UDT_FIELD* FirstUdtField,
+	const SYMBOL_UDT_FIELD* LastUdtField,
+	DWORD Size
+	)
+{
+	m_Depth -= 1;
+	WriteIndent();
+	Write("}");
+
+	WriteUnnamedDataType(Kind);
+
+	Write(";");
+
+	Write(" /* size: 0x%04x */", Size);
+
+	Write("\n");
+}
+
+template <
+	typename TRAITS
+>
+void
+PDBSpecializedHeaderReconstructor<TRAITS>::OnPaddingMember(
+	const SYMBOL_UDT_FIELD* UdtField,
+	BasicType PaddingBasicType,
+	DWORD PaddingBasicTypeSize,
+	DWORD PaddingSize
+	)
+{
+	if (TRAITS::CreatePaddingMembers(m_Settings))
+	{
+		WriteIndent();
+
+		WriteOffset(UdtField, -((int)PaddingSize * (int)PaddingBasicTypeSize));
+
+		Write("%s ", PDB::GetBasicTypeString(
+			PaddingBasicType,
+			PaddingBasicTypeSize,
+			m_Settings->UseStdInt,
+			m_Settings->UsePortableTypes
+			));
+		WritePaddingMemberName();
+
+		if (PaddingSize > 1)
+		{
+			Write("[%u]", PaddingSize);
+		}
+
+		Write(";\n");
+	}
+}
+
+template <
+	typename TRAITS
+>
+void
+PDBSpecializedHeaderReconstructor<TRAITS>::WriteUnnamedDataType(
+	UdtKind Kind
+	)
+{
+	if (TRAITS::AllowAnonymousDataTypes(m_Settings) == false)
+	{
+		switch (Kind)
+		{
+			case UdtStruct:
+			case UdtClass:
+				Write(" %s", m_Settings->AnonymousStructPrefix.c_str());
+				break;
+
+			case UdtUnion:
+				Write(" %s", m_Settings->AnonymousUnionPrefix.c_str());
+				break;
+
+			default:
+				assert(0);
+				break;
+		}
+
+		if (m_AnonymousDataTypeCounter++ > 0)
+		{
+			Write("%u", m_AnonymousDataTypeCounter);
+		}
+	}
+}
+
+template <
+	typename TRAITS
+>
+void
+PDBSpecializedHeaderReconstructor<TRAITS>::WriteTypedefBegin(
+	const SYMBOL* Symbol
+	)
+{
+	std::string CorrectedName = GetCorrectedSymbolName(Symbol);
+	bool UseTypedef = TRAITS::MicrosoftTypedefs(m_Settings) && CorrectedName[0] == '_';
+
+	if (UseTypedef && m_Depth == 0)
+	{
+		Write("typedef ");
+	}
+}
+
+template <
+	typename TRAITS
+>
+void
+PDBSpecializedHeaderReconstructor<TRAITS>::WriteTypedefEnd(
+	const SYMBOL* Symbol
+	)
+{
+	std::string CorrectedName = GetCorrectedSymbolName(Symbol);
+	bool UseTypedef = TRAITS::MicrosoftTypedefs(m_Settings) && CorrectedName[0] == '_';
+
+	if (UseTypedef && m_Depth == 0)
+	{
+		Write(" %s, *P%s", &CorrectedName[1], &CorrectedName[1]);
+	}
+}
+
+template <
+	typename TRAITS
+>
+void
+PDBSpecializedHeaderReconstructor<TRAITS>::WriteOffset(
+	const SYMBOL_UDT_FIELD* UdtField,
+	int PaddingOffset
+	)
+{
+	if (TRAITS::ShowOffsets(m_Settings))
+	{
+		Write("/* 0x%04x */ ", UdtField->Offset + PaddingOffset);
+	}
+}
+
+template <
+	typename TRAITS
+>
+bool
+PDBSpecializedHeaderReconstructor<TRAITS>::ShouldExpand(
+	const SYMBOL* Symbol
+	) const
+{
+	bool Expand = false;
+
+	switch (TRAITS::MemberStructExpansion(m_Settings))
+	{
+		default:
+		case PDBHeaderReconstructor::MemberStructExpansionType::None:
+			Expand = m_Depth == 0;
+			break;
+
+		case PDBHeaderReconstructor::MemberStructExpansionType::InlineUnnamed:
+			Expand = m_Depth == 0 || PDB::IsUnnamedSymbol(Symbol);
+			break;
+
+		case PDBHeaderReconstructor::MemberStructExpansionType::InlineAll:
+			Expand = !HasBeenVisited(Symbol);
+			break;
+	}
+
+	return Expand && Symbol->Size > 0;
+}
@@ -0,0 +1,539 @@
+#include "PDBStackUnwinder.h"
+#include "WorkerThreads.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+namespace
+{
+	static PDBStackUnwinder::Settings DefaultSettings;
+}
+
+const DWORD PDBStackUnwinder::None;
+const DWORD PDBStackUnwinder::MAXIMUM_STACK_DEPTH;
+
+PDBStackUnwinder::PDBStackUnwinder(
+	Settings* UnwinderSettings
+	)
+{
+	m_Settings = UnwinderSettings ? UnwinderSettings : &DefaultSettings;
+}
+
+bool
+PDBStackUnwinder::Build(
+	PDB* Pdb,
+	DWORD ModuleBase
+	)
+{
+	std::vector<SYMBOL_FRAME_DATA> FrameData;
+
+	if (!Pdb->GetFrameData(FrameData))
+	{
+		return false;
+	}
+
+	m_ModuleBase = ModuleBase;
+
+	m_Addresses.clear();
+	m_Records.clear();
+	m_Instructions.clear();
+	m_InvalidProgramCount = 0;
+
+	//
+	// If both streams describe the same range,
+	// the FrameData record is more precise.
+	//
+
+	std::stable_sort(FrameData.begin(), FrameData.end(), [](const SYMBOL_FRAME_DATA& Left, const SYMBOL_FRAME_DATA& Right) {
+		if (Left.RelativeVirtualAddress != Right.RelativeVirtualAddress)
+		{
+			return Left.RelativeVirtualAddress < Right.RelativeVirtualAddress;
+		}
+
+		return Left.Type == FrameTypeFrameData && Right.Type != FrameTypeFrameData;
+	});
+
+	//
+	// Most of the functions share a handful of programs.
+	//
+
+	std::unordered_map<std::string, std::pair<DWORD, DWORD>> CompiledPrograms;
+
+	for (auto&& Record : FrameData)
+	{
+		if (!m_Addresses.empty() && m_Addresses.back() == Record.RelativeVirtualAddress)
+		{
+			continue;
+		}
+
+		FrameRecord NewRecord;
+		NewRecord.End = Record.RelativeVirtualAddress + Record.Length;
+		NewRecord.LocalsLength = Record.LocalsLength;
+		NewRecord.ParamsLength = Record.ParamsLength;
+		NewRecord.SavedRegistersLength = Record.SavedRegistersLength;
+		NewRecord.Type = Record.Type;
+		NewRecord.AllocatesBasePointer = Record.AllocatesBasePointer;
+		NewRecord.ProgramBegin = None;
+		NewRecord.ProgramEnd = None;
+
+		if (!Record.Program.empty())
+		{
+			auto ProgramIterator = CompiledPrograms.find(Record.Program);
+
+			if (ProgramIterator == CompiledPrograms.end())
+			{
+				DWORD ProgramBegin = static_cast<DWORD>(m_Instructions.size());
+
+				if (CompileProgram(Record.Program))
+				{
+					ProgramIterator = CompiledPrograms.emplace(Record.Program, std::make_pair(ProgramBegin, static_cast<DWORD>(m_Instructions.size()))).first;
+				}
+				else
+				{
+					ProgramIterator = CompiledPrograms.emplace(Record.Program, std::make_pair(None, None)).first;
+				}
+			}
+
+			if (ProgramIterator->second.first == None)
+			{
+				m_InvalidProgramCount += 1;
+			}
+
+			NewRecord.ProgramBegin = ProgramIterator->second.first;
+			NewRecord.ProgramEnd = ProgramIterator->second.second;
+		}
+
+		m_Addresses.push_back(Record.RelativeVirtualAddress);
+		m_Records.push_back(NewRecord);
+	}
+
+	return true;
+}
+
+void
+PDBStackUnwinder::Unwind(
+	MemoryImage* Image,
+	const Context& Start,
+	std::vector<Context>& Frames
+	) const
+{
+	Frames.clear();
+	Frames.push_back(Start);
+
+	Context Caller;
+
+	while (Frames.size() < m_Settings->MaximumFrameCount &&
+	       UnwindFrame(Image, Frames.back(), Caller))
+	{
+		Frames.push_back(Caller);
+	}
+}
+
+void
+PDBStackUnwinder::UnwindBatch(
+	MemoryImage* Image,
+	const std::vector<Context>& Threads,
+	std::vector<std::vector<Context>>& Stacks
+	) const
+{
+	Stacks.clear();
+	Stacks.resize(Threads.size());
+
+	//
+	// Tops of all stacks are requested at once,
+	// so the image can merge them into few reads.
+	//
+
+	std::vector<MemoryImage::Range> Ranges;
+
+	for (auto&& Thread : Threads)
+	{
+		Ranges.push_back({ Thread.Esp, m_Settings->StackPrefetchSize });
+	}
+
+	Image->Prefetch(Ranges);
+
+	WorkerThreads::RunRanges(Threads.size(), m_Settings->ThreadCount, [this, Image, &Threads, &Stacks](DWORD, size_t Begin, size_t End) {
+		for (size_t Index = Begin; Index < End; Index++)
+		{
+			Unwind(Image, Threads[Index], Stacks[Index]);
+		}
+	});
+}
+
+bool
+PDBStackUnwinder::LoadContexts(
+	const char* Path,
+	std::vector<Context>& Contexts
+	)
+{
+	std::ifstream ContextsFile(Path, std::ios::in);
+
+	if (!ContextsFile.is_open())
+	{
+		return false;
+	}
+
+	std::string Line;
+
+	while (std::getline(ContextsFile, Line))
+	{
+		std::istringstream LineStream(Line);
+		std::string Value;
+
+		DWORD Registers[6] = { 0 };
+		size_t RegisterCount = 0;
+
+		while (RegisterCount < _countof(Registers) && LineStream >> Value && Value[0] != '#')
+		{
+			char* ValueEnd;
+			Registers[RegisterCount] = static_cast<DWORD>(_strtoui64(Value.c_str(), &ValueEnd, 16));
+
+			if (*ValueEnd != '\0')
+			{
+				break;
+			}
+
+			RegisterCount += 1;
+		}
+
+		//
+		// EIP, ESP and EBP are required.
+		//
+
+		if (RegisterCount < 3)
+		{
+			continue;
+		}
+
+		Contexts.push_back({ Registers[0], Registers[1], Registers[2], Registers[3], Registers[4], Registers[5] });
+	}
+
+	return true;
+}
+
+bool
+PDBStackUnwinder::CompileProgram(
+	const std::string& Program
+	)
+{
+	size_t ProgramBegin = m_Instructions.size();
+
+	//
+	// Instruction which produced every value
+	// of the stack during the execution.
+	//
+
+	std::vector<size_t> Producers;
+
+	std::istringstream ProgramStream(Program);
+	std::string Token;
+
+	auto Fail = [this, ProgramBegin]() {
+		m_Instructions.resize(ProgramBegin);
+		return false;
+	};
+
+	static const struct
+	{
+		const char* Name;
+		DWORD Slot;
+	} VariableNames[] = {
+		{ "$eip",           VariableEip                  },
+		{ "$esp",           VariableEsp                  },
+		{ "$ebp",           VariableEbp                  },
+		{ "$ebx",           VariableEbx                  },
+		{ "$esi",           VariableEsi                  },
+		{ "$edi",           VariableEdi                  },
+		{ ".raSearch",      VariableRaSearch             },
+		{ ".raSearchStart", VariableRaSearch             },
+		{ ".cbLocals",      VariableLocalsLength         },
+		{ ".cbParams",      VariableParamsLength         },
+		{ ".cbSavedRegs",   VariableSavedRegistersLength },
+	};
+
+	while (ProgramStream >> Token)
+	{
+		static const char BinaryOperators[] = "+-*/%@";
+		const char* BinaryOperator = Token.size() == 1 ? strchr(BinaryOperators, Token[0]) : nullptr;
+
+		if (BinaryOperator != nullptr && *BinaryOperator != '\0')
+		{
+			static const Operation BinaryOperations[] = {
+				Operation::Add,
+				Operation::Subtract,
+				Operation::Multiply,
+				Operation::Divide,
+				Operation::Modulo,
+				Operation::Align,
+			};
+
+			if (Producers.size() < 2)
+			{
+				return Fail();
+			}
+
+			Producers.pop_back();
+			Producers.back() = m_Instructions.size();
+
+			m_Instructions.push_back({ BinaryOperations[BinaryOperator - BinaryOperators], 0 });
+		}
+		else if (Token == "^")
+		{
+			if (Producers.empty())
+			{
+				return Fail();
+			}
+
+			Producers.back() = m_Instructions.size();
+
+			m_Instructions.push_back({ Operation::Dereference, 0 });
+		}
+		else if (Token == "=")
+		{
+			//
+			// Left side must be a variable.
+			//
+
+			if (Producers.size() < 2 || m_Instructions[Producers[Producers.size() - 2]].Op != Operation::Variable)
+			{
+				return Fail();
+			}
+
+			m_Instructions[Producers[Producers.size() - 2]].Op = Operation::Reference;
+
+			Producers.resize(Producers.size() - 2);
+
+			m_Instructions.push_back({ Operation::Assign, 0 });
+		}
+		else if (Token[0] == '$' || Token[0] == '.')
+		{
+			DWORD Slot = None;
+
+			if (Token.size() == 3 && Token[1] == 'T' && Token[2] >= '0' && Token[2] <= '9')
+			{
+				Slot = VariableT0 + (Token[2] - '0');
+			}
+
+			for (auto&& VariableName : VariableNames)
+			{
+				if (Token == VariableName.Name)
+				{
+					Slot = VariableName.Slot;
+				}
+			}
+
+			if (Slot == None)
+			{
+				return Fail();
+			}
+
+			Producers.push_back(m_Instructions.size());
+
+			m_Instructions.push_back({ Operation::Variable, Slot });
+		}
+		else
+		{
+			char* TokenEnd;
+			DWORD Value = static_cast<DWORD>(strtoul(Token.c_str(), &TokenEnd, 0));
+
+			if (*TokenEnd != '\0')
+			{
+				return Fail();
+			}
+
+			Producers.push_back(m_Instructions.size());
+
+			m_Instructions.push_back({ Operation::Constant, Value });
+		}
+
+		if (Producers.size() > MAXIMUM_STACK_DEPTH)
+		{
+			return Fail();
+		}
+	}
+
+	return true;
+}
+
+bool
+PDBStackUnwinder::ExecuteProgram(
+	MemoryImage* Image,
+	const FrameRecord& Record,
+	DWORD* Variables
+	) const
+{
+	//
+	// Depth of the stack was checked by CompileProgram().
+	//
+
+	DWORD Stack[MAXIMUM_STACK_DEPTH];
+	DWORD* Top = Stack;
+
+	const Instruction* End = m_Instructions.data() + Record.ProgramEnd;
+
+	for (const Instruction* Current = m_Instructions.data() + Record.ProgramBegin; Current != End; Current++)
+	{
+		switch (Current->Op)
+		{
+			case Operation::Constant:
+			case Operation::Reference:
+				*Top++ = Current->Operand;
+				break;
+
+			case Operation::Variable:
+				*Top++ = Variables[Current->Operand];
+				break;
+
+			case Operation::Dereference:
+				if (!Image->Read(Top[-1], &Top[-1], sizeof(DWORD)))
+				{
+					return false;
+				}
+				break;
+
+			case Operation::Assign:
+				Variables[Top[-2]] = Top[-1];
+				Top -= 2;
+				break;
+
+			default:
+				{
+					DWORD Right = *--Top;
+					DWORD& Left = Top[-1];
+
+					switch (Current->Op)
+					{
+						case Operation::Add:      Left += Right; break;
+						case Operation::Subtract: Left -= Right; break;
+						case Operation::Multiply: Left *= Right; break;
+
+						case Operation::Divide:
+						case Operation::Modulo:
+							if (Right == 0)
+							{
+								return false;
+							}
+
+							Left = Current->Op == Operation::Divide
+								? Left / Right
+								: Left % Right;
+							break;
+
+						case Operation::Align:
+							Left &= ~(Right - 1);
+							break;
+
+						default:
+							break;
+					}
+				}
+				break;
+		}
+	}
+
+	return true;
+}
+
+bool
+PDBStackUnwinder::UnwindFrame(
+	MemoryImage* Image,
+	const Context& Callee,
+	Context& Caller
+	) const
+{
+	const FrameRecord* Record = FindRecord(Callee.Eip);
+
+	Caller = Callee;
+
+	bool Unwound = false;
+
+	if (Record != nullptr && Record->ProgramBegin != None)
+	{
+		DWORD Variables[VariableCount] = { 0 };
+
+		Variables[VariableEip] = Callee.Eip;
+		Variables[VariableEsp] = Callee.Esp;
+		Variables[VariableEbp] = Callee.Ebp;
+		Variables[VariableEbx] = Callee.Ebx;
+		Variables[VariableEsi] = Callee.Esi;
+		Variables[VariableEdi] = Callee.Edi;
+		Variables[VariableRaSearch] = Callee.Esp + Record->LocalsLength + Record->SavedRegistersLength;
+		Variables[VariableLocalsLength] = Record->LocalsLength;
+		Variables[VariableParamsLength] = Record->ParamsLength;
+		Variables[VariableSavedRegistersLength] = Record->SavedRegistersLength;
+
+		if (ExecuteProgram(Image, *Record, Variables))
+		{
+			Caller.Eip = Variables[VariableEip];
+			Caller.Esp = Variables[VariableEsp];
+			Caller.Ebp = Variables[VariableEbp];
+			Caller.Ebx = Variables[VariableEbx];
+			Caller.Esi = Variables[VariableEsi];
+			Caller.Edi = Variables[VariableEdi];
+
+			Unwound = true;
+		}
+	}
+	else if (Record != nullptr && Record->Type == FrameTypeFPO && !Record->AllocatesBasePointer)
+	{
+		DWORD ReturnAddressLocation = Callee.Esp + Record->LocalsLength + Record->SavedRegistersLength;
+
+		if (!Image->Read(ReturnAddressLocation, &Caller.Eip, sizeof(DWORD)))
+		{
+			return false;
+		}
+
+		Caller.Esp = ReturnAddressLocation + sizeof(DWORD);
+
+		Unwound = true;
+	}
+
+	if (!Unwound)
+	{
+		DWORD SavedFrame[2];
+
+		if (!Image->Read(Callee.Ebp, SavedFrame, sizeof(SavedFrame)))
+		{
+			return false;
+		}
+
+		Caller.Ebp = SavedFrame[0];
+		Caller.Eip = SavedFrame[1];
+		Caller.Esp = Callee.Ebp + sizeof(SavedFrame);
+	}
+
+	//
+	// Stack grows down, the caller must be above the callee.
+	//
+
+	return Caller.Eip != 0 && Caller.Esp > Callee.Esp;
+}
+
+const PDBStackUnwinder::FrameRecord*
+PDBStackUnwinder::FindRecord(
+	DWORD Eip
+	) const
+{
+	if (Eip < m_ModuleBase)
+	{
+		return nullptr;
+	}
+
+	DWORD Address = Eip - m_ModuleBase;
+
+	auto AddressIterator = std::upper_bound(m_Addresses.begin(), m_Addresses.end(), Address);
+
+	if (AddressIterator == m_Addresses.begin())
+	{
+		return nullptr;
+	}
+
+	const FrameRecord* Record = &m_Records[AddressIterator - m_Addresses.begin() - 1];
+
+	return Address < Record->End ? Record : nullptr;
+}
@@ -0,0 +1,227 @@
+#pragma once
+#include "PDB.h"
+#include "MemoryImage.h"
+
+#include <string>
+#include <vector>
+
+//
+// Unwinds 32-bit x86 stacks of one module by its FPO and FrameData records.
+//
+// Records are sorted by their relative virtual address. Frame programs
+// (postfix expressions of the FrameData records) are compiled once
+// into instructions with resolved variable slots:
+//
+//   $T0 .raSearch = $eip $T0 ^ = $esp $T0 4 + =
+//
+//   Reference  $T0             Reference  $eip   ...
+//   Variable   .raSearch       Variable   $T0
+//   Assign                     Dereference
+//                              Assign
+//
+// Every frame is unwound by the first applicable rule:
+//
+//   - FrameData record: registers of the caller are computed
+//     by the program of the record,
+//   - FPO record without frame pointer: the return address follows
+//     the locals and the saved registers,
+//   - otherwise EBP is the frame pointer:
+//     [ebp] is the saved EBP and [ebp + 4] is the return address.
+//
+class PDBStackUnwinder
+{
+	public:
+		struct Settings
+		{
+			//
+			// Maximum count of frames of one stack.
+			//
+			DWORD MaximumFrameCount = 256;
+
+			//
+			// Bytes of every stack (from ESP up) requested
+			// from the memory image before the unwinding.
+			//
+			DWORD StackPrefetchSize = 0x2000;
+
+			//
+			// Count of worker threads, 0 means count of CPUs.
+			//
+			DWORD ThreadCount = 0;
+		};
+
+		struct Context
+		{
+			DWORD Eip;
+			DWORD Esp;
+			DWORD Ebp;
+			DWORD Ebx;
+			DWORD Esi;
+			DWORD Edi;
+		};
+
+		static const DWORD None = static_cast<DWORD>(-1);
+
+		PDBStackUnwinder(
+			Settings* UnwinderSettings = nullptr
+			);
+
+		//
+		// Returns false if the PDB has no frame data.
+		//
+		bool
+		Build(
+			PDB* Pdb,
+			DWORD ModuleBase
+			);
+
+		//
+		// Frames[0] is the Start context.
+		//
+		void
+		Unwind(
+			MemoryImage* Image,
+			const Context& Start,
+			std::vector<Context>& Frames
+			) const;
+
+		void
+		UnwindBatch(
+			MemoryImage* Image,
+			const std::vector<Context>& Threads,
+			std::vector<std::vector<Context>>& Stacks
+			) const;
+
+		//
+		// Count of frame programs which could not be compiled,
+		// their records are unwound by the frame pointer.
+		//
+		size_t
+		GetInvalidProgramCount() const
+		{
+			return m_InvalidProgramCount;
+		}
+
+		//
+		// Reads thread contexts, one per line, hexadecimal registers
+		// in the order eip esp ebp [ebx esi edi]:
+		//
+		//   # eip     esp       ebp
+		//   8284a1c2  8d7ffc40  8d7ffc88
+		//
+		// Returns false if the file cannot be opened.
+		//
+		static
+		bool
+		LoadContexts(
+			const char* Path,
+			std::vector<Context>& Contexts
+			);
+
+	private:
+		enum class Operation : BYTE
+		{
+			Constant,
+			Variable,
+
+			//
+			// Pushes the slot of the variable (left side of '=').
+			//
+			Reference,
+
+			Add,
+			Subtract,
+			Multiply,
+			Divide,
+			Modulo,
+			Align,
+			Dereference,
+			Assign,
+		};
+
+		struct Instruction
+		{
+			Operation Op;
+			DWORD Operand;
+		};
+
+		enum Variable
+		{
+			VariableEip,
+			VariableEsp,
+			VariableEbp,
+			VariableEbx,
+			VariableEsi,
+			VariableEdi,
+			VariableRaSearch,
+			VariableLocalsLength,
+			VariableParamsLength,
+			VariableSavedRegistersLength,
+			VariableT0,
+			VariableCount = VariableT0 + 10,
+		};
+
+		struct FrameRecord
+		{
+			DWORD End;
+			DWORD LocalsLength;
+			DWORD ParamsLength;
+			DWORD SavedRegistersLength;
+			DWORD Type;
+			BOOL AllocatesBasePointer;
+
+			//
+			// Range of m_Instructions, ProgramBegin is None
+			// if there is no program.
+			//
+			DWORD ProgramBegin;
+			DWORD ProgramEnd;
+		};
+
+		static const DWORD MAXIMUM_STACK_DEPTH = 32;
+
+		//
+		// Returns false if the program is not valid.
+		//
+		bool
+		CompileProgram(
+			const std::string& Program
+			);
+
+		bool
+		ExecuteProgram(
+			MemoryImage* Image,
+			const FrameRecord& Record,
+			DWORD* Variables
+			) const;
+
+		//
+		// Returns false at the end of the stack.
+		//
+		bool
+		UnwindFrame(
+			MemoryImage* Image,
+			const Context& Callee,
+			Context& Caller
+			) const;
+
+		const FrameRecord*
+		FindRecord(
+			DWORD Eip
+			) const;
+
+	private:
+		Settings* m_Settings;
+
+		DWORD m_ModuleBase = 0;
+
+		//
+		// Sorted relative virtual addresses of m_Records.
+		//
+		std::vector<DWORD> m_Addresses;
+		std::vector<FrameRecord> m_Records;
+
+		std::vector<Instruction> m_Instructions;
+
+		size_t m_InvalidProgramCount = 0;
+};
@@ -0,0 +1,314 @@
+#include "PDBStructureDiff.h"
+#include "WorkerThreads.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	static PDBStructureDiff::Settings DefaultSettings;
+
+	//
+	// Objects are not split between threads below this count.
+	//
+	static const size_t MINIMUM_OBJECTS_PER_THREAD = 1024;
+
+	//
+	// Count of objects passed to MemoryImage::Prefetch at once.
+	//
+	static const ptrdiff_t PREFETCH_OBJECT_COUNT = 256;
+}
+
+PDBStructureDiff::PDBStructureDiff(
+	MemoryImage* OldImage,
+	MemoryImage* NewImage,
+	Settings* DiffSettings
+	)
+{
+	m_OldImage = OldImage;
+	m_NewImage = NewImage;
+	m_Settings = DiffSettings ? DiffSettings : &DefaultSettings;
+}
+
+void
+PDBStructureDiff::Compare(
+	const std::vector<PDBObjectList::Object>& Objects
+	)
+{
+	m_Diffs.clear();
+	m_ComparedCount = 0;
+	m_ChangedCount = 0;
+	m_UnreadableCount = 0;
+
+	//
+	// Layouts are built before the threads start,
+	// the workers only read them.
+	//
+
+	for (auto&& CurrentObject : Objects)
+	{
+		PrepareType(CurrentObject.Type);
+	}
+
+	size_t ThreadCount = WorkerThreads::GetCount(m_Settings->ThreadCount);
+
+	ThreadCount = (std::max)((std::min)(ThreadCount, Objects.size() / MINIMUM_OBJECTS_PER_THREAD), static_cast<size_t>(1));
+
+	//
+	// Every thread compares a continuous range of the objects,
+	// so concatenated results keep the order of the objects.
+	//
+
+	std::vector<std::vector<ObjectDiff>> ThreadDiffs(ThreadCount);
+
+	const PDBObjectList::Object* Begin = Objects.data();
+
+	WorkerThreads::RunRanges(Objects.size(), static_cast<DWORD>(ThreadCount), [this, Begin, &ThreadDiffs](DWORD ThreadIndex, size_t RangeBegin, size_t RangeEnd) {
+		CompareRange(Begin + RangeBegin, Begin + RangeEnd, ThreadDiffs[ThreadIndex]);
+	});
+
+	for (auto&& Diffs : ThreadDiffs)
+	{
+		for (auto&& Diff : Diffs)
+		{
+			if (Diff.Readable)
+			{
+				m_ChangedCount += 1;
+			}
+			else
+			{
+				m_UnreadableCount += 1;
+			}
+
+			m_Diffs.push_back(std::move(Diff));
+		}
+	}
+
+	m_ComparedCount = Objects.size() - m_UnreadableCount;
+}
+
+void
+PDBStructureDiff::PrepareType(
+	const SYMBOL* Type
+	)
+{
+	if (m_TypeInfos.find(Type) != m_TypeInfos.end())
+	{
+		return;
+	}
+
+	TypeInfo& Info = m_TypeInfos[Type];
+	Info.Layout = std::make_unique<PDBFieldLayout>(Type);
+
+	const auto& Fields = Info.Layout->GetFields();
+
+	for (DWORD Index = 0; Index < Fields.size(); Index++)
+	{
+		if (Fields[Index].IsLeaf &&
+		    Fields[Index].Size != 0 &&
+		    Fields[Index].Offset + Fields[Index].Size <= Type->Size)
+		{
+			Info.Leaves.push_back(Index);
+		}
+	}
+
+	std::stable_sort(Info.Leaves.begin(), Info.Leaves.end(), [&Fields](DWORD Lhs, DWORD Rhs) {
+		return Fields[Lhs].Offset < Fields[Rhs].Offset;
+	});
+
+	//
+	// Leaves are sorted by their starts, but members of unions
+	// may span over the following leaves, therefore the range
+	// starts at the first leaf which ends behind the start of the line.
+	//
+
+	DWORD CacheLineSize = m_Settings->CacheLineSize;
+	DWORD CacheLineCount = (Type->Size + CacheLineSize - 1) / CacheLineSize;
+
+	for (DWORD Line = 0; Line < CacheLineCount; Line++)
+	{
+		DWORD LineBegin = Line * CacheLineSize;
+		DWORD LineEnd = LineBegin + CacheLineSize;
+
+		size_t RangeBegin = 0;
+
+		while (RangeBegin < Info.Leaves.size() &&
+		       Fields[Info.Leaves[RangeBegin]].Offset + Fields[Info.Leaves[RangeBegin]].Size <= LineBegin)
+		{
+			RangeBegin++;
+		}
+
+		size_t RangeEnd = RangeBegin;
+
+		while (RangeEnd < Info.Leaves.size() &&
+		       Fields[Info.Leaves[RangeEnd]].Offset < LineEnd)
+		{
+			RangeEnd++;
+		}
+
+		Info.CacheLineLeaves.push_back(std::make_pair(RangeBegin, RangeEnd));
+	}
+}
+
+void
+PDBStructureDiff::CompareRange(
+	const PDBObjectList::Object* Begin,
+	const PDBObjectList::Object* End,
+	std::vector<ObjectDiff>& Diffs
+	) const
+{
+	std::vector<BYTE> OldBuffer;
+	std::vector<BYTE> NewBuffer;
+	std::vector<MemoryImage::Range> Ranges;
+
+	for (const PDBObjectList::Object* CurrentObject = Begin; CurrentObject != End; CurrentObject++)
+	{
+		//
+		// Live images fetch the following objects at once.
+		//
+
+		if ((CurrentObject - Begin) % PREFETCH_OBJECT_COUNT == 0)
+		{
+			Ranges.clear();
+
+			for (const PDBObjectList::Object* PrefetchedObject = CurrentObject;
+			     PrefetchedObject != End && PrefetchedObject - CurrentObject < PREFETCH_OBJECT_COUNT;
+			     PrefetchedObject++)
+			{
+				Ranges.push_back({ PrefetchedObject->Address, PrefetchedObject->Type->Size });
+			}
+
+			m_OldImage->Prefetch(Ranges);
+			m_NewImage->Prefetch(Ranges);
+		}
+
+		DWORD Size = CurrentObject->Type->Size;
+
+		//
+		// Mapped images are compared in place.
+		//
+
+		const BYTE* OldData = m_OldImage->GetPointer(CurrentObject->Address, Size);
+		const BYTE* NewData = m_NewImage->GetPointer(CurrentObject->Address, Size);
+
+		if (OldData == nullptr)
+		{
+			OldBuffer.resize(Size);
+			OldData = m_OldImage->Read(CurrentObject->Address, OldBuffer.data(), Size)
+				? OldBuffer.data()
+				: nullptr;
+		}
+
+		if (NewData == nullptr)
+		{
+			NewBuffer.resize(Size);
+			NewData = m_NewImage->Read(CurrentObject->Address, NewBuffer.data(), Size)
+				? NewBuffer.data()
+				: nullptr;
+		}
+
+		if (OldData == nullptr || NewData == nullptr)
+		{
+			Diffs.push_back({ CurrentObject->Address, CurrentObject->Type, false });
+			continue;
+		}
+
+		if (memcmp(OldData, NewData, Size) == 0)
+		{
+			continue;
+		}
+
+		ObjectDiff Diff = { CurrentObject->Address, CurrentObject->Type, true };
+
+		CompareObject(m_TypeInfos.at(CurrentObject->Type), OldData, NewData, Size, Diff.Changes);
+
+		Diffs.push_back(std::move(Diff));
+	}
+}
+
+void
+PDBStructureDiff::CompareObject(
+	const TypeInfo& Info,
+	const BYTE* OldData,
+	const BYTE* NewData,
+	DWORD Size,
+	std::vector<FieldChange>& Changes
+	) const
+{
+	const auto& Fields = Info.Layout->GetFields();
+
+	DWORD CacheLineSize = m_Settings->CacheLineSize;
+	bool PreviousLineDiffers = false;
+
+	for (DWORD Line = 0; Line < Info.CacheLineLeaves.size(); Line++)
+	{
+		DWORD LineBegin = Line * CacheLineSize;
+		DWORD LineLength = (std::min)(CacheLineSize, Size - LineBegin);
+
+		bool LineDiffers = memcmp(OldData + LineBegin, NewData + LineBegin, LineLength) != 0;
+
+		if (LineDiffers)
+		{
+			for (size_t i = Info.CacheLineLeaves[Line].first; i < Info.CacheLineLeaves[Line].second; i++)
+			{
+				DWORD FieldIndex = Info.Leaves[i];
+				const PDBFieldLayout::Field& CurrentField = Fields[FieldIndex];
+
+				//
+				// Skip leaves which do not overlap this line
+				// and leaves already compared with the previous line.
+				//
+
+				if (CurrentField.Offset + CurrentField.Size <= LineBegin ||
+				    (PreviousLineDiffers && CurrentField.Offset < LineBegin))
+				{
+					continue;
+				}
+
+				ULONGLONG OldValue = 0;
+				ULONGLONG NewValue = 0;
+
+				if (CurrentField.Size <= sizeof(ULONGLONG))
+				{
+					OldValue = GetFieldValue(CurrentField, OldData);
+					NewValue = GetFieldValue(CurrentField, NewData);
+
+					if (OldValue == NewValue)
+					{
+						continue;
+					}
+				}
+				else if (memcmp(OldData + CurrentField.Offset, NewData + CurrentField.Offset, CurrentField.Size) == 0)
+				{
+					continue;
+				}
+
+				Changes.push_back({ FieldIndex, OldValue, NewValue });
+			}
+		}
+
+		PreviousLineDiffers = LineDiffers;
+	}
+}
+
+ULONGLONG
+PDBStructureDiff::GetFieldValue(
+	const PDBFieldLayout::Field& CurrentField,
+	const BYTE* Data
+	)
+{
+	ULONGLONG Value = 0;
+	memcpy(&Value, Data + CurrentField.Offset, CurrentField.Size);
+
+	if (CurrentField.Bits != 0)
+	{
+		Value >>= CurrentField.BitPosition;
+
+		if (CurrentField.Bits < 64)
+		{
+			Value &= (1ULL << CurrentField.Bits) - 1;
+		}
+	}
+
+	return Value;
+}
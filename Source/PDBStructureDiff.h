@@ -0,0 +1,170 @@
+#pragma once
+#include "PDB.h"
+#include "MemoryImage.h"
+#include "PDBFieldLayout.h"
+#include "PDBObjectList.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+//
+// Compares instances of UDTs in two memory images.
+//
+// Every object is compared as a whole block first (memcmp),
+// unchanged objects - the vast majority - cost one block compare.
+// Cache lines of the changed objects are compared next and only
+// the leaf fields which overlap the differing cache lines
+// are decoded into field-level changes.
+//
+// Objects are split between worker threads.
+//
+class PDBStructureDiff
+{
+	public:
+		struct Settings
+		{
+			//
+			// Size of the compared block in bytes.
+			//
+			DWORD CacheLineSize = 64;
+
+			//
+			// Count of worker threads, 0 means count of CPUs.
+			//
+			DWORD ThreadCount = 0;
+		};
+
+		struct FieldChange
+		{
+			//
+			// Index of the leaf field in the PDBFieldLayout of the type.
+			//
+			DWORD FieldIndex;
+
+			//
+			// Values of fields not larger than 8 bytes
+			// (bitfields are extracted), 0 for larger fields.
+			//
+			ULONGLONG OldValue;
+			ULONGLONG NewValue;
+		};
+
+		struct ObjectDiff
+		{
+			ULONGLONG Address;
+			const SYMBOL* Type;
+
+			//
+			// False if the object is not available in one of the images.
+			//
+			bool Readable;
+
+			std::vector<FieldChange> Changes;
+		};
+
+		PDBStructureDiff(
+			MemoryImage* OldImage,
+			MemoryImage* NewImage,
+			Settings* DiffSettings = nullptr
+			);
+
+		//
+		// Compares the objects, results of the previous
+		// comparison are discarded.
+		//
+		void
+		Compare(
+			const std::vector<PDBObjectList::Object>& Objects
+			);
+
+		//
+		// Changed and unreadable objects in the order of the compared objects.
+		//
+		const std::vector<ObjectDiff>&
+		GetDiffs() const
+		{
+			return m_Diffs;
+		}
+
+		const PDBFieldLayout&
+		GetLayout(
+			const SYMBOL* Type
+			) const
+		{
+			return *m_TypeInfos.at(Type).Layout;
+		}
+
+		ULONGLONG
+		GetComparedCount() const
+		{
+			return m_ComparedCount;
+		}
+
+		ULONGLONG
+		GetChangedCount() const
+		{
+			return m_ChangedCount;
+		}
+
+		ULONGLONG
+		GetUnreadableCount() const
+		{
+			return m_UnreadableCount;
+		}
+
+	private:
+		struct TypeInfo
+		{
+			std::unique_ptr<PDBFieldLayout> Layout;
+
+			//
+			// Indices of the leaves sorted by their offsets
+			// and the range of the leaves which overlap
+			// each cache line.
+			//
+			std::vector<DWORD> Leaves;
+			std::vector<std::pair<size_t, size_t>> CacheLineLeaves;
+		};
+
+		void
+		PrepareType(
+			const SYMBOL* Type
+			);
+
+		void
+		CompareRange(
+			const PDBObjectList::Object* Begin,
+			const PDBObjectList::Object* End,
+			std::vector<ObjectDiff>& Diffs
+			) const;
+
+		void
+		CompareObject(
+			const TypeInfo& Info,
+			const BYTE* OldData,
+			const BYTE* NewData,
+			DWORD Size,
+			std::vector<FieldChange>& Changes
+			) const;
+
+		static
+		ULONGLONG
+		GetFieldValue(
+			const PDBFieldLayout::Field& CurrentField,
+			const BYTE* Data
+			);
+
+	private:
+		MemoryImage* m_OldImage;
+		MemoryImage* m_NewImage;
+		Settings* m_Settings;
+
+		std::map<const SYMBOL*, TypeInfo> m_TypeInfos;
+
+		std::vector<ObjectDiff> m_Diffs;
+
+		ULONGLONG m_ComparedCount = 0;
+		ULONGLONG m_ChangedCount = 0;
+		ULONGLONG m_UnreadableCount = 0;
+};
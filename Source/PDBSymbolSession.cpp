@@ -0,0 +1,303 @@
+#include "PDBSymbolSession.h"
+#include "WorkerThreads.h"
+
+#include <algorithm>
+
+namespace
+{
+	//
+	// Smaller batches are not worth starting the threads.
+	//
+	static const size_t MINIMUM_THREAD_BATCH_SIZE = 64 * 1024;
+
+	//
+	// Index of the symbol before the first symbol of the module.
+	//
+	static const size_t NO_SYMBOL = static_cast<size_t>(-1);
+
+	static PDBSymbolSession::Settings DefaultSettings;
+}
+
+const DWORD PDBSymbolSession::None;
+
+PDBSymbolSession::PDBSymbolSession(
+	Settings* SessionSettings
+	)
+{
+	m_Settings = SessionSettings ? SessionSettings : &DefaultSettings;
+}
+
+bool
+PDBSymbolSession::AddModule(
+	const char* ModuleName,
+	ULONGLONG BaseAddress,
+	ULONGLONG Size,
+	const char* PdbPath
+	)
+{
+	//
+	// Symbols are indexed by 32-bit relative virtual addresses.
+	//
+
+	if (Size > 0xFFFFFFFF || BaseAddress + Size < BaseAddress)
+	{
+		return false;
+	}
+
+	std::unique_ptr<Module> NewModule(new Module);
+	NewModule->Name = ModuleName;
+	NewModule->BaseAddress = BaseAddress;
+
+	std::vector<SYMBOL_CODE> CodeSymbols;
+
+	if (!NewModule->Pdb.Open(PdbPath, m_Settings->ThreadCount) ||
+	    !NewModule->Pdb.GetCodeSymbols(CodeSymbols))
+	{
+		return false;
+	}
+
+	//
+	// The function and its public symbol share the address,
+	// only the function is kept.
+	//
+
+	std::stable_sort(CodeSymbols.begin(), CodeSymbols.end(), [](const SYMBOL_CODE& Left, const SYMBOL_CODE& Right) {
+		return Left.RelativeVirtualAddress < Right.RelativeVirtualAddress ||
+		       (Left.RelativeVirtualAddress == Right.RelativeVirtualAddress && !Left.IsPublic && Right.IsPublic);
+	});
+
+	CodeSymbols.erase(std::unique(CodeSymbols.begin(), CodeSymbols.end(), [](const SYMBOL_CODE& Left, const SYMBOL_CODE& Right) {
+		return Left.RelativeVirtualAddress == Right.RelativeVirtualAddress;
+	}), CodeSymbols.end());
+
+	//
+	// Without the size of the module, the module ends
+	// after the last byte of the known code.
+	//
+
+	ULONGLONG Extent = Size;
+
+	if (Extent == 0)
+	{
+		for (auto&& CodeSymbol : CodeSymbols)
+		{
+			Extent = (std::max)(Extent, static_cast<ULONGLONG>(CodeSymbol.RelativeVirtualAddress) + (std::max)(CodeSymbol.Length, static_cast<DWORD>(1)));
+		}
+
+		Extent = (std::min)(Extent, 0xFFFFFFFFull);
+	}
+
+	NewModule->End = BaseAddress + Extent;
+
+	//
+	// Modules must not overlap.
+	//
+
+	size_t Position = std::upper_bound(m_ModuleRangeBases.begin(), m_ModuleRangeBases.end(), BaseAddress) - m_ModuleRangeBases.begin();
+
+	if ((Position > 0 && m_Modules[m_ModuleRanges[Position - 1]]->End > BaseAddress) ||
+	    (Position < m_ModuleRanges.size() && m_ModuleRangeBases[Position] < NewModule->End))
+	{
+		return false;
+	}
+
+	NewModule->Addresses.reserve(CodeSymbols.size());
+	NewModule->Ends.reserve(CodeSymbols.size());
+	NewModule->Names.reserve(CodeSymbols.size());
+
+	for (size_t Index = 0; Index < CodeSymbols.size(); Index++)
+	{
+		const SYMBOL_CODE& CodeSymbol = CodeSymbols[Index];
+
+		if (CodeSymbol.RelativeVirtualAddress >= Extent)
+		{
+			break;
+		}
+
+		//
+		// Public symbols of unknown length reach up to the next symbol.
+		//
+
+		ULONGLONG SymbolEnd = CodeSymbol.Length != 0
+			? static_cast<ULONGLONG>(CodeSymbol.RelativeVirtualAddress) + CodeSymbol.Length
+			: Index + 1 < CodeSymbols.size()
+				? CodeSymbols[Index + 1].RelativeVirtualAddress
+				: Extent;
+
+		NewModule->Addresses.push_back(CodeSymbol.RelativeVirtualAddress);
+		NewModule->Ends.push_back(static_cast<DWORD>((std::min)(SymbolEnd, Extent)));
+		NewModule->Names.push_back(std::move(CodeSymbols[Index].Name));
+	}
+
+	m_ModuleRanges.insert(m_ModuleRanges.begin() + Position, static_cast<DWORD>(m_Modules.size()));
+	m_ModuleRangeBases.insert(m_ModuleRangeBases.begin() + Position, BaseAddress);
+	m_Modules.push_back(std::move(NewModule));
+
+	return true;
+}
+
+PDBSymbolSession::Symbol
+PDBSymbolSession::Resolve(
+	ULONGLONG Address
+	) const
+{
+	DWORD ModuleIndex = FindModule(Address);
+
+	if (ModuleIndex == None)
+	{
+		return { None, None, 0 };
+	}
+
+	const Module& CurrentModule = *m_Modules[ModuleIndex];
+	DWORD RelativeVirtualAddress = static_cast<DWORD>(Address - CurrentModule.BaseAddress);
+
+	size_t SymbolIndex = std::upper_bound(CurrentModule.Addresses.begin(), CurrentModule.Addresses.end(), RelativeVirtualAddress) - CurrentModule.Addresses.begin();
+
+	return GetSymbol(CurrentModule, ModuleIndex, SymbolIndex - 1, Address);
+}
+
+void
+PDBSymbolSession::ResolveBatch(
+	const std::vector<ULONGLONG>& Addresses,
+	std::vector<Symbol>& Symbols
+	) const
+{
+	Symbols.assign(Addresses.size(), { None, None, 0 });
+
+	std::vector<Key> Keys(Addresses.size());
+
+	for (size_t Index = 0; Index < Addresses.size(); Index++)
+	{
+		Keys[Index] = Key(Addresses[Index], Index);
+	}
+
+	std::sort(Keys.begin(), Keys.end());
+
+	//
+	// Addresses outside of all modules are left unresolved.
+	//
+
+	auto KeyLess = [](const Key& Left, ULONGLONG Address) {
+		return Left.first < Address;
+	};
+
+	std::vector<Group> Groups;
+
+	for (DWORD ModuleIndex : m_ModuleRanges)
+	{
+		const Module& CurrentModule = *m_Modules[ModuleIndex];
+
+		size_t Begin = std::lower_bound(Keys.begin(), Keys.end(), CurrentModule.BaseAddress, KeyLess) - Keys.begin();
+		size_t End = std::lower_bound(Keys.begin() + Begin, Keys.end(), CurrentModule.End, KeyLess) - Keys.begin();
+
+		if (Begin != End)
+		{
+			Groups.push_back({ ModuleIndex, Begin, End });
+		}
+	}
+
+	DWORD ThreadCount = WorkerThreads::GetCount(m_Settings->ThreadCount);
+
+	ThreadCount = static_cast<DWORD>((std::min)(
+		static_cast<size_t>(ThreadCount),
+		Keys.size() / MINIMUM_THREAD_BATCH_SIZE + 1
+		));
+
+	//
+	// Every worker resolves the parts of the groups
+	// which fall into its range of the sorted keys,
+	// every worker writes different Symbols.
+	//
+
+	WorkerThreads::RunRanges(Keys.size(), ThreadCount, [this, &Keys, &Groups, &Symbols](DWORD, size_t Begin, size_t End) {
+		for (auto&& CurrentGroup : Groups)
+		{
+			size_t GroupBegin = (std::max)(Begin, CurrentGroup.Begin);
+			size_t GroupEnd = (std::min)(End, CurrentGroup.End);
+
+			if (GroupBegin < GroupEnd)
+			{
+				ResolveGroup(CurrentGroup.ModuleIndex, Keys.data() + GroupBegin, Keys.data() + GroupEnd, Symbols);
+			}
+		}
+	});
+}
+
+DWORD
+PDBSymbolSession::FindModule(
+	ULONGLONG Address
+	) const
+{
+	size_t Position = std::upper_bound(m_ModuleRangeBases.begin(), m_ModuleRangeBases.end(), Address) - m_ModuleRangeBases.begin();
+
+	if (Position == 0 || Address >= m_Modules[m_ModuleRanges[Position - 1]]->End)
+	{
+		return None;
+	}
+
+	return m_ModuleRanges[Position - 1];
+}
+
+PDBSymbolSession::Symbol
+PDBSymbolSession::GetSymbol(
+	const Module& CurrentModule,
+	DWORD ModuleIndex,
+	size_t SymbolIndex,
+	ULONGLONG Address
+	) const
+{
+	ULONGLONG RelativeVirtualAddress = Address - CurrentModule.BaseAddress;
+
+	if (SymbolIndex == NO_SYMBOL || RelativeVirtualAddress >= CurrentModule.Ends[SymbolIndex])
+	{
+		return { ModuleIndex, None, RelativeVirtualAddress };
+	}
+
+	return { ModuleIndex, static_cast<DWORD>(SymbolIndex), RelativeVirtualAddress - CurrentModule.Addresses[SymbolIndex] };
+}
+
+void
+PDBSymbolSession::ResolveGroup(
+	DWORD ModuleIndex,
+	const Key* Begin,
+	const Key* End,
+	std::vector<Symbol>& Symbols
+	) const
+{
+	const Module& CurrentModule = *m_Modules[ModuleIndex];
+	const std::vector<DWORD>& ModuleAddresses = CurrentModule.Addresses;
+
+	size_t SymbolIndex = NO_SYMBOL;
+
+	for (const Key* CurrentKey = Begin; CurrentKey != End; CurrentKey++)
+	{
+		DWORD RelativeVirtualAddress = static_cast<DWORD>(CurrentKey->first - CurrentModule.BaseAddress);
+
+		if (SymbolIndex == NO_SYMBOL)
+		{
+			SymbolIndex = std::upper_bound(ModuleAddresses.begin(), ModuleAddresses.end(), RelativeVirtualAddress) - ModuleAddresses.begin() - 1;
+		}
+		else
+		{
+			//
+			// Addresses are sorted, gallop forward from the previous
+			// symbol and finish by the binary search of the last step.
+			//
+
+			size_t Low = SymbolIndex;
+			size_t Step = 1;
+
+			while (Low + Step < ModuleAddresses.size() && ModuleAddresses[Low + Step] <= RelativeVirtualAddress)
+			{
+				Low += Step;
+				Step *= 2;
+			}
+
+			auto High = ModuleAddresses.begin() + (std::min)(Low + Step, ModuleAddresses.size());
+
+			SymbolIndex = std::upper_bound(ModuleAddresses.begin() + Low, High, RelativeVirtualAddress) - ModuleAddresses.begin() - 1;
+		}
+
+		Symbols[CurrentKey->second] = GetSymbol(CurrentModule, ModuleIndex, SymbolIndex, CurrentKey->first);
+	}
+}
@@ -0,0 +1,194 @@
+#pragma once
+#include "PDB.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+//
+// Symbolizes absolute addresses of a whole process (or of the kernel)
+// by the PDBs of all loaded modules.
+//
+// Every module keeps its opened PDB and the index of its code symbols,
+// parallel arrays sorted by the address (functions take precedence
+// over the public symbols of the same address):
+//
+//   m_Addresses     relative virtual address of the symbol
+//   m_Ends          first byte after the code, or the next symbol
+//                   if the length is not known
+//   m_Names
+//
+// Address ranges of the modules form the sorted range index:
+//
+//   ntdll      [7ffb1c6a0000, 7ffb1c8a8000)   -> module 1
+//   kernel32   [7ffb1ca40000, 7ffb1cb02000)   -> module 0
+//
+// Batches are sorted first and split into groups of addresses
+// of the same module, the groups are resolved by one forward sweep
+// through the index of their module. The sorted batch is split between
+// worker threads, a group may therefore be shared by more workers.
+//
+class PDBSymbolSession
+{
+	public:
+		struct Settings
+		{
+			//
+			// Count of worker threads, 0 means count of CPUs.
+			//
+			DWORD ThreadCount = 0;
+		};
+
+		struct Symbol
+		{
+			//
+			// None if the address is not covered by any module.
+			//
+			DWORD ModuleIndex;
+
+			//
+			// None if the address is not covered by any symbol
+			// of the module.
+			//
+			DWORD SymbolIndex;
+
+			//
+			// Distance of the address from the symbol,
+			// or from the module if there is no symbol.
+			//
+			ULONGLONG Displacement;
+		};
+
+		static const DWORD None = static_cast<DWORD>(-1);
+
+		PDBSymbolSession(
+			Settings* SessionSettings = nullptr
+			);
+
+		//
+		// Opens the PDB of the module loaded at the BaseAddress and builds
+		// the index of its code symbols. Size 0 means the extent of the symbols.
+		// Modules are indexed in the order in which they are added.
+		//
+		// Returns false if the PDB cannot be opened, if it contains
+		// no code symbols or if the module overlaps another module.
+		//
+		bool
+		AddModule(
+			const char* ModuleName,
+			ULONGLONG BaseAddress,
+			ULONGLONG Size,
+			const char* PdbPath
+			);
+
+		Symbol
+		Resolve(
+			ULONGLONG Address
+			) const;
+
+		void
+		ResolveBatch(
+			const std::vector<ULONGLONG>& Addresses,
+			std::vector<Symbol>& Symbols
+			) const;
+
+		size_t
+		GetModuleCount() const
+		{
+			return m_Modules.size();
+		}
+
+		const std::string&
+		GetModuleName(
+			DWORD ModuleIndex
+			) const
+		{
+			return m_Modules[ModuleIndex]->Name;
+		}
+
+		PDB&
+		GetModulePdb(
+			DWORD ModuleIndex
+			)
+		{
+			return m_Modules[ModuleIndex]->Pdb;
+		}
+
+		const std::string&
+		GetSymbolName(
+			DWORD ModuleIndex,
+			DWORD SymbolIndex
+			) const
+		{
+			return m_Modules[ModuleIndex]->Names[SymbolIndex];
+		}
+
+	private:
+		struct Module
+		{
+			std::string Name;
+			ULONGLONG BaseAddress;
+			ULONGLONG End;
+
+			PDB Pdb;
+
+			std::vector<DWORD> Addresses;
+			std::vector<DWORD> Ends;
+			std::vector<std::string> Names;
+		};
+
+		//
+		// Addresses of the batch of one module,
+		// sorted keys between Begin and End.
+		//
+		struct Group
+		{
+			DWORD ModuleIndex;
+			size_t Begin;
+			size_t End;
+		};
+
+		//
+		// Sorted key: address and index into Symbols.
+		//
+		using Key = std::pair<ULONGLONG, size_t>;
+
+		//
+		// Returns index of the module which contains
+		// the Address, or None if there is no such module.
+		//
+		DWORD
+		FindModule(
+			ULONGLONG Address
+			) const;
+
+		Symbol
+		GetSymbol(
+			const Module& CurrentModule,
+			DWORD ModuleIndex,
+			size_t SymbolIndex,
+			ULONGLONG Address
+			) const;
+
+		//
+		// Resolves sorted keys of one module.
+		//
+		void
+		ResolveGroup(
+			DWORD ModuleIndex,
+			const Key* Begin,
+			const Key* End,
+			std::vector<Symbol>& Symbols
+			) const;
+
+	private:
+		Settings* m_Settings;
+
+		std::vector<std::unique_ptr<Module>> m_Modules;
+
+		//
+		// Indices of the modules sorted by their base addresses.
+		//
+		std::vector<DWORD> m_ModuleRanges;
+		std::vector<ULONGLONG> m_ModuleRangeBases;
+};
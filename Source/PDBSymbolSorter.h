@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 
 enum class ImageArchitecture
 {
@@ -30,13 +31,35 @@ class PDBSymbolSorter
 			return m_Architecture;
 		}
 
+		//
+		// Returns enums and UDTs which the provided UDT
+		// contains by value (directly or through typedefs and arrays).
+		// Pointers are not followed.
+		//
+		// Each dependency is sorted before its dependents.
+		//
+		const std::set<const SYMBOL*>&
+		GetDependencies(
+			const SYMBOL* Symbol
+			) const
+		{
+			static const std::set<const SYMBOL*> NoDependencies;
+
+			auto It = m_Dependencies.find(Symbol);
+
+			return It != m_Dependencies.end()
+				? It->second
+				: NoDependencies;
+		}
+
 		void
 		Clear()
 		{
-			ImageArchitecture m_Architecture = ImageArchitecture::None;
+			m_Architecture = ImageArchitecture::None;
 
 			m_VisitedUdts.clear();
 			m_SortedSymbols.clear();
+			m_Dependencies.clear();
 		}
 
 	protected:
@@ -45,7 +68,11 @@ class PDBSymbolSorter
 			const SYMBOL* Symbol
 			) override
 		{
-			if (HasBeenVisited(Symbol)) return;
+			bool Visited = HasBeenVisited(Symbol);
+
+			AddDependency(Symbol);
+
+			if (Visited) return;
 
 			AddSymbol(Symbol);
 		}
@@ -79,9 +106,15 @@ class PDBSymbolSorter
 			const SYMBOL* Symbol
 			) override
 		{
-			if (HasBeenVisited(Symbol)) return;
+			bool Visited = HasBeenVisited(Symbol);
+
+			AddDependency(Symbol);
+
+			if (Visited) return;
 
+			m_UdtStack.push_back(Symbol);
 			PDBSymbolVisitorBase::VisitUdt(Symbol);
+			m_UdtStack.pop_back();
 
 			AddSymbol(Symbol);
 		}
@@ -147,9 +180,38 @@ class PDBSymbolSorter
 			}
 		}
 
+		void
+		AddDependency(
+			const SYMBOL* Symbol
+			)
+		{
+			if (m_UdtStack.empty())
+			{
+				return;
+			}
+
+			//
+			// Named symbols depend on the first definition
+			// of the symbol with the same name (see HasBeenVisited()).
+			//
+
+			if (!PDB::IsUnnamedSymbol(Symbol))
+			{
+				Symbol = m_VisitedUdts[Symbol->Name];
+			}
+
+			m_Dependencies[m_UdtStack.back()].insert(Symbol);
+		}
+
 		ImageArchitecture m_Architecture = ImageArchitecture::None;
 
 		std::map<std::string, const SYMBOL*> m_VisitedUdts;
 		std::vector<const SYMBOL*> m_SortedSymbols;
+
+		//
+		// UDTs which are being visited and their dependencies.
+		//
+		std::vector<const SYMBOL*> m_UdtStack;
+		std::map<const SYMBOL*, std::set<const SYMBOL*>> m_Dependencies;
 };
 
@@ -0,0 +1,1281 @@
+#include "PDBTypeBrowser.h"
+#include "WorkerThreads.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <fstream>
+#include <functional>
+#include <sstream>
+
+namespace
+{
+	static const ULONGLONG FNV_OFFSET_BASIS = 14695981039346656037ull;
+	static const ULONGLONG FNV_PRIME        = 1099511628211ull;
+
+	//
+	// Smaller batches of pages are not worth starting the threads.
+	//
+	static const size_t MINIMUM_THREAD_PAGE_COUNT = 64;
+
+	//
+	// Longer names of the name pages are shortened.
+	//
+	static const size_t MAXIMUM_FILE_NAME_LENGTH = 64;
+
+	//
+	// Version of the rendered pages and of the manifests. The version
+	// is a part of the structural hash, when the rendering changes,
+	// the pages of the new version get new names.
+	//
+	static const DWORD GENERATOR_VERSION = 1;
+
+	static const char* MANIFEST_SIGNATURE = "pdbex-browse";
+	static const char* MANIFEST_FILE_NAME = "manifest.txt";
+
+	static const char* STYLE_SHEET =
+		"body { font-family: sans-serif; margin: 2em; }\n"
+		"table { border-collapse: collapse; }\n"
+		"th, td { padding: 0.1em 0.8em; text-align: left; font-family: monospace; }\n"
+		"th { border-bottom: 1px solid #888; }\n"
+		"tr:nth-child(even) { background: #f4f4f4; }\n"
+		"a { text-decoration: none; }\n"
+		".changed { color: #b00; }\n";
+
+	static PDBTypeBrowser::Settings DefaultSettings;
+
+	ULONGLONG
+	GetHash(
+		const std::string& Text
+		)
+	{
+		ULONGLONG Hash = FNV_OFFSET_BASIS;
+
+		for (char Character : Text)
+		{
+			Hash = (Hash ^ static_cast<unsigned char>(Character)) * FNV_PRIME;
+		}
+
+		return Hash;
+	}
+
+	//
+	// Lines of the manifests are tab separated, names
+	// of the types and paths may contain spaces.
+	//
+	std::vector<std::string>
+	SplitLine(
+		const std::string& Line
+		)
+	{
+		std::vector<std::string> Items;
+		size_t Begin = 0;
+
+		for (;;)
+		{
+			size_t End = Line.find('\t', Begin);
+
+			if (End == std::string::npos)
+			{
+				Items.push_back(Line.substr(Begin));
+				return Items;
+			}
+
+			Items.push_back(Line.substr(Begin, End - Begin));
+			Begin = End + 1;
+		}
+	}
+
+	bool
+	ParseNumber(
+		const std::string& Text,
+		int Base,
+		ULONGLONG& Value
+		)
+	{
+		char* End;
+		Value = _strtoui64(Text.c_str(), &End, Base);
+
+		return !Text.empty() && *End == '\0';
+	}
+
+	std::string
+	GetManifestHeader()
+	{
+		return std::string(MANIFEST_SIGNATURE) + "\t" + std::to_string(GENERATOR_VERSION);
+	}
+
+	bool
+	GetEnumValue(
+		const VARIANT* Value,
+		LONGLONG& Result
+		)
+	{
+		switch (Value->vt)
+		{
+			case VT_I1:   Result = Value->cVal;  return true;
+			case VT_UI1:  Result = Value->bVal;  return true;
+			case VT_I2:   Result = Value->iVal;  return true;
+			case VT_UI2:  Result = Value->uiVal; return true;
+
+			case VT_INT:
+			case VT_I4:   Result = Value->lVal;  return true;
+
+			case VT_UINT:
+			case VT_UI4:  Result = Value->ulVal; return true;
+
+			case VT_I8:
+			case VT_UI8:  Result = Value->llVal; return true;
+
+			default:      return false;
+		}
+	}
+
+	std::string
+	FormatHex(
+		ULONGLONG Value,
+		int Width = 0
+		)
+	{
+		char Buffer[32];
+		sprintf_s(Buffer, "0x%0*llX", Width, Value);
+
+		return Buffer;
+	}
+
+	void
+	BeginPage(
+		std::string& Html,
+		const std::string& Title,
+		const char* StyleSheetPath
+		)
+	{
+		Html += "<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n<title>";
+		Html += Title;
+		Html += "</title>\n<link rel=\"stylesheet\" href=\"";
+		Html += StyleSheetPath;
+		Html += "\">\n</head>\n<body>\n";
+	}
+
+	void
+	EndPage(
+		std::string& Html
+		)
+	{
+		Html += "</body>\n</html>\n";
+	}
+
+	bool
+	CreateDirectories(
+		const std::vector<std::string>& Directories
+		)
+	{
+		for (auto&& Directory : Directories)
+		{
+			if (CreateDirectoryA(Directory.c_str(), nullptr) == FALSE &&
+			    GetLastError() != ERROR_ALREADY_EXISTS)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	//
+	// Calls Callback(Index) for every index, split between the threads.
+	//
+	void
+	RunWorkers(
+		size_t Count,
+		DWORD ThreadCount,
+		const std::function<void(size_t)>& Callback
+		)
+	{
+		ThreadCount = static_cast<DWORD>((std::min)(
+			static_cast<size_t>(WorkerThreads::GetCount(ThreadCount)),
+			Count / MINIMUM_THREAD_PAGE_COUNT + 1
+			));
+
+		WorkerThreads::RunRanges(Count, ThreadCount, [&Callback](DWORD, size_t Begin, size_t End) {
+			for (size_t Index = Begin; Index < End; Index++)
+			{
+				Callback(Index);
+			}
+		});
+	}
+}
+
+const DWORD PDBTypeBrowser::None;
+
+PDBTypeBrowser::PDBTypeBrowser(
+	const std::string& Directory,
+	Settings* BrowserSettings
+	)
+	: m_Directory(Directory)
+{
+	m_Settings = BrowserSettings ? BrowserSettings : &DefaultSettings;
+}
+
+bool
+PDBTypeBrowser::AddBuild(
+	const std::string& ModuleName,
+	const std::string& BuildName,
+	const std::string& PdbPath,
+	PDBSymbolSorter* SymbolSorter
+	)
+{
+	Module& CurrentModule = GetModule(ModuleName);
+	CurrentModule.Changed = true;
+
+	std::string ModuleDirectory = m_Directory + "\\" + CurrentModule.Name;
+
+	if (!CreateDirectories({
+		m_Directory,
+		ModuleDirectory,
+		ModuleDirectory + "\\types",
+		ModuleDirectory + "\\names",
+		ModuleDirectory + "\\builds"
+		}))
+	{
+		return false;
+	}
+
+	//
+	// Dependencies are sorted before their dependents,
+	// their hashes are known when the dependent is hashed.
+	//
+
+	const std::vector<const SYMBOL*>& SortedSymbols = SymbolSorter->GetSortedSymbols();
+
+	BuildHashes Hashes;
+	std::vector<ULONGLONG> SymbolHashes(SortedSymbols.size());
+
+	for (size_t Index = 0; Index < SortedSymbols.size(); Index++)
+	{
+		const SYMBOL* Symbol = SortedSymbols[Index];
+		ULONGLONG Hash = GetHash(GetStructure(Symbol, Hashes));
+
+		SymbolHashes[Index] = Hash;
+
+		if (PDB::IsUnnamedSymbol(Symbol))
+		{
+			Hashes.Unnamed[Symbol] = Hash;
+		}
+		else
+		{
+			Hashes.Named.emplace(Symbol->Name, Hash);
+		}
+	}
+
+	Build NewBuild;
+	NewBuild.Name = BuildName;
+	NewBuild.PdbPath = PdbPath;
+
+	std::vector<size_t> NewPages;
+
+	for (size_t Index = 0; Index < SortedSymbols.size(); Index++)
+	{
+		const SYMBOL* Symbol = SortedSymbols[Index];
+		DWORD NameIndex = None;
+
+		if (!PDB::IsUnnamedSymbol(Symbol))
+		{
+			auto Inserted = CurrentModule.NameIndices.emplace(Symbol->Name, static_cast<DWORD>(CurrentModule.Names.size()));
+
+			if (Inserted.second)
+			{
+				CurrentModule.Names.push_back(Symbol->Name);
+			}
+
+			NameIndex = Inserted.first->second;
+			NewBuild.Types.emplace_back(NameIndex, SymbolHashes[Index]);
+		}
+
+		//
+		// Pages of the manifest are kept, the manifest is written
+		// after its pages, so they were written completely.
+		//
+
+		if (CurrentModule.Pages.emplace(SymbolHashes[Index], Page { NameIndex, Symbol->Size, {} }).second)
+		{
+			m_Statistics.PageCount++;
+			NewPages.push_back(Index);
+		}
+	}
+
+	std::sort(NewBuild.Types.begin(), NewBuild.Types.end(), [&CurrentModule](const std::pair<DWORD, ULONGLONG>& Left, const std::pair<DWORD, ULONGLONG>& Right) {
+		return CurrentModule.Names[Left.first] < CurrentModule.Names[Right.first];
+	});
+
+	//
+	// Backlinks lead to the named types, unnamed types pass
+	// their named owners to the types they contain. Dependents
+	// are sorted after their dependencies, so all owners
+	// of the unnamed type are known when it is reached.
+	//
+
+	std::map<const SYMBOL*, std::set<DWORD>> UnnamedOwners;
+
+	for (size_t Index = SortedSymbols.size(); Index-- > 0; )
+	{
+		const SYMBOL* Symbol = SortedSymbols[Index];
+		std::set<DWORD> Owners;
+
+		if (PDB::IsUnnamedSymbol(Symbol))
+		{
+			Owners.swap(UnnamedOwners[Symbol]);
+		}
+		else
+		{
+			Owners.insert(CurrentModule.NameIndices.at(Symbol->Name));
+		}
+
+		for (const SYMBOL* Dependency : SymbolSorter->GetDependencies(Symbol))
+		{
+			ULONGLONG DependencyHash;
+
+			if (PDB::IsUnnamedSymbol(Dependency))
+			{
+				UnnamedOwners[Dependency].insert(Owners.begin(), Owners.end());
+			}
+			else if (FindHash(Dependency, Hashes, DependencyHash))
+			{
+				CurrentModule.Pages[DependencyHash].Users.insert(Owners.begin(), Owners.end());
+			}
+		}
+	}
+
+	//
+	// Pages of the different hashes are different files.
+	//
+
+	std::atomic<bool> Success(true);
+
+	RunWorkers(NewPages.size(), m_Settings->ThreadCount, [&](size_t PageIndex) {
+		size_t Index = NewPages[PageIndex];
+		std::string PagePath = ModuleDirectory + "\\types\\" + GetHashString(SymbolHashes[Index]) + ".html";
+
+		if (!WritePage(PagePath, RenderTypePage(SortedSymbols[Index], Hashes)))
+		{
+			Success = false;
+		}
+	});
+
+	m_Statistics.BuildCount++;
+	m_Statistics.TypeCount += NewBuild.Types.size();
+	m_Statistics.WrittenPageCount += NewPages.size();
+
+	CurrentModule.Builds.push_back(std::move(NewBuild));
+
+	return Success;
+}
+
+bool
+PDBTypeBrowser::HasBuild(
+	const std::string& ModuleName,
+	const std::string& BuildName
+	)
+{
+	const Module& CurrentModule = GetModule(ModuleName);
+
+	return std::find_if(CurrentModule.Builds.begin(), CurrentModule.Builds.end(), [&BuildName](const Build& CurrentBuild) {
+		return CurrentBuild.Name == BuildName;
+	}) != CurrentModule.Builds.end();
+}
+
+bool
+PDBTypeBrowser::WriteIndex()
+{
+	//
+	// Modules without new builds are only listed in the index.
+	//
+
+	std::map<std::string, ModuleSummary> Modules;
+	std::ifstream SiteManifest(m_Directory + "\\" + MANIFEST_FILE_NAME);
+	std::string Line;
+
+	if (std::getline(SiteManifest, Line) && Line == GetManifestHeader())
+	{
+		while (std::getline(SiteManifest, Line))
+		{
+			std::vector<std::string> Items = SplitLine(Line);
+			ULONGLONG BuildCount;
+			ULONGLONG NameCount;
+
+			if (Items.size() == 4 && Items[0] == "module" &&
+			    ParseNumber(Items[2], 10, BuildCount) &&
+			    ParseNumber(Items[3], 10, NameCount))
+			{
+				Modules[Items[1]] = ModuleSummary { static_cast<size_t>(BuildCount), static_cast<size_t>(NameCount) };
+			}
+		}
+	}
+
+	SiteManifest.close();
+
+	for (auto&& e : m_Modules)
+	{
+		const Module& CurrentModule = e.second;
+
+		if (!CurrentModule.Changed)
+		{
+			continue;
+		}
+
+		Modules[CurrentModule.Name] = ModuleSummary { CurrentModule.Builds.size(), CurrentModule.Names.size() };
+
+		std::string ModuleDirectory = m_Directory + "\\" + CurrentModule.Name;
+
+		std::vector<VersionList> Versions(CurrentModule.Names.size());
+
+		for (size_t BuildIndex = 0; BuildIndex < CurrentModule.Builds.size(); BuildIndex++)
+		{
+			for (auto&& Type : CurrentModule.Builds[BuildIndex].Types)
+			{
+				VersionList& NameVersions = Versions[Type.first];
+
+				auto It = std::find_if(NameVersions.begin(), NameVersions.end(), [&Type](const std::pair<ULONGLONG, std::vector<size_t>>& Version) {
+					return Version.first == Type.second;
+				});
+
+				if (It == NameVersions.end())
+				{
+					NameVersions.emplace_back(Type.second, std::vector<size_t>());
+					It = NameVersions.end() - 1;
+				}
+
+				It->second.push_back(BuildIndex);
+			}
+		}
+
+		if (!WritePage(ModuleDirectory + "\\index.html", RenderModulePage(CurrentModule, Versions)))
+		{
+			return false;
+		}
+
+		std::atomic<bool> Success(true);
+
+		RunWorkers(CurrentModule.Builds.size(), m_Settings->ThreadCount, [&](size_t BuildIndex) {
+			std::string PagePath = ModuleDirectory + "\\builds\\" + CurrentModule.Builds[BuildIndex].Name + ".html";
+
+			if (!WritePage(PagePath, RenderBuildPage(CurrentModule, BuildIndex)))
+			{
+				Success = false;
+			}
+		});
+
+		RunWorkers(CurrentModule.Names.size(), m_Settings->ThreadCount, [&](size_t NameIndex) {
+			std::string PagePath = ModuleDirectory + "\\names\\" + GetNameFileName(CurrentModule.Names[NameIndex]) + ".html";
+
+			if (!WritePage(PagePath, RenderNamePage(CurrentModule, static_cast<DWORD>(NameIndex), Versions[NameIndex])))
+			{
+				Success = false;
+			}
+		});
+
+		//
+		// The manifest is written last, a failed run
+		// leaves the manifest of the previous one.
+		//
+
+		if (!Success ||
+		    !WritePage(ModuleDirectory + "\\" + MANIFEST_FILE_NAME, RenderManifest(CurrentModule)))
+		{
+			return false;
+		}
+	}
+
+	std::string ManifestContents = GetManifestHeader() + "\n";
+
+	for (auto&& e : Modules)
+	{
+		ManifestContents += "module\t" + e.first + "\t" + std::to_string(e.second.BuildCount) + "\t" + std::to_string(e.second.NameCount) + "\n";
+	}
+
+	return CreateDirectories({ m_Directory }) &&
+	       WritePage(m_Directory + "\\style.css", STYLE_SHEET) &&
+	       WritePage(m_Directory + "\\index.html", RenderIndexPage(Modules)) &&
+	       WritePage(m_Directory + "\\" + MANIFEST_FILE_NAME, ManifestContents);
+}
+
+PDBTypeBrowser::Module&
+PDBTypeBrowser::GetModule(
+	const std::string& ModuleName
+	)
+{
+	//
+	// Names of the directories are not case sensitive,
+	// modules are keyed by their lowercase names.
+	//
+
+	std::string ModuleKey = ModuleName;
+	std::transform(ModuleKey.begin(), ModuleKey.end(), ModuleKey.begin(), ::tolower);
+
+	auto Inserted = m_Modules.emplace(ModuleKey, Module());
+	Module& CurrentModule = Inserted.first->second;
+
+	if (!Inserted.second)
+	{
+		return CurrentModule;
+	}
+
+	std::string Path = m_Directory + "\\" + ModuleKey + "\\" + MANIFEST_FILE_NAME;
+
+	if (GetFileAttributesA(Path.c_str()) != INVALID_FILE_ATTRIBUTES)
+	{
+		if (LoadManifest(Path, CurrentModule))
+		{
+			m_Statistics.KeptBuildCount += CurrentModule.Builds.size();
+			m_Statistics.PageCount += CurrentModule.Pages.size();
+		}
+		else
+		{
+			CurrentModule = Module();
+			m_Statistics.IgnoredManifestCount++;
+		}
+	}
+
+	CurrentModule.Name = ModuleKey;
+
+	return CurrentModule;
+}
+
+bool
+PDBTypeBrowser::LoadManifest(
+	const std::string& Path,
+	Module& CurrentModule
+	)
+{
+	std::ifstream Manifest(Path);
+	std::string Line;
+
+	if (!std::getline(Manifest, Line) || Line != GetManifestHeader())
+	{
+		return false;
+	}
+
+	//
+	// Types of the build are the differences from the previous build.
+	//
+
+	std::map<DWORD, ULONGLONG> Types;
+
+	auto FinishBuild = [&CurrentModule, &Types]() {
+		if (!CurrentModule.Builds.empty())
+		{
+			Build& LastBuild = CurrentModule.Builds.back();
+
+			LastBuild.Types.assign(Types.begin(), Types.end());
+
+			std::sort(LastBuild.Types.begin(), LastBuild.Types.end(), [&CurrentModule](const std::pair<DWORD, ULONGLONG>& Left, const std::pair<DWORD, ULONGLONG>& Right) {
+				return CurrentModule.Names[Left.first] < CurrentModule.Names[Right.first];
+			});
+		}
+	};
+
+	while (std::getline(Manifest, Line))
+	{
+		std::vector<std::string> Items = SplitLine(Line);
+		const std::string& Kind = Items[0];
+
+		ULONGLONG Hash;
+		ULONGLONG Value;
+
+		if (Kind == "name" && Items.size() == 2)
+		{
+			CurrentModule.NameIndices.emplace(Items[1], static_cast<DWORD>(CurrentModule.Names.size()));
+			CurrentModule.Names.push_back(Items[1]);
+		}
+		else if (Kind == "page" && Items.size() == 5 && ParseNumber(Items[1], 16, Hash))
+		{
+			Page& NewPage = CurrentModule.Pages[Hash];
+
+			NewPage.NameIndex = None;
+
+			if (Items[2] != "-")
+			{
+				if (!ParseNumber(Items[2], 10, Value) || Value >= CurrentModule.Names.size())
+				{
+					return false;
+				}
+
+				NewPage.NameIndex = static_cast<DWORD>(Value);
+			}
+
+			if (!ParseNumber(Items[3], 10, Value))
+			{
+				return false;
+			}
+
+			NewPage.Size = static_cast<DWORD>(Value);
+
+			std::istringstream Users(Items[4]);
+			std::string User;
+
+			while (std::getline(Users, User, ','))
+			{
+				if (!ParseNumber(User, 10, Value) || Value >= CurrentModule.Names.size())
+				{
+					return false;
+				}
+
+				NewPage.Users.insert(static_cast<DWORD>(Value));
+			}
+		}
+		else if (Kind == "build" && Items.size() == 3)
+		{
+			FinishBuild();
+
+			CurrentModule.Builds.emplace_back();
+			CurrentModule.Builds.back().Name = Items[1];
+			CurrentModule.Builds.back().PdbPath = Items[2];
+		}
+		else if (Kind == "+" && Items.size() == 3 && !CurrentModule.Builds.empty() &&
+		         ParseNumber(Items[1], 10, Value) && Value < CurrentModule.Names.size() &&
+		         ParseNumber(Items[2], 16, Hash) && CurrentModule.Pages.count(Hash))
+		{
+			Types[static_cast<DWORD>(Value)] = Hash;
+		}
+		else if (Kind == "-" && Items.size() == 2 && !CurrentModule.Builds.empty() &&
+		         ParseNumber(Items[1], 10, Value))
+		{
+			Types.erase(static_cast<DWORD>(Value));
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	FinishBuild();
+
+	return true;
+}
+
+std::string
+PDBTypeBrowser::RenderManifest(
+	const Module& CurrentModule
+	)
+{
+	std::string Manifest = GetManifestHeader() + "\n";
+
+	for (auto&& Name : CurrentModule.Names)
+	{
+		Manifest += "name\t" + Name + "\n";
+	}
+
+	for (auto&& e : CurrentModule.Pages)
+	{
+		const Page& CurrentPage = e.second;
+
+		Manifest += "page\t" + GetHashString(e.first) + "\t";
+		Manifest += CurrentPage.NameIndex == None ? "-" : std::to_string(CurrentPage.NameIndex);
+		Manifest += "\t" + std::to_string(CurrentPage.Size) + "\t";
+
+		for (auto It = CurrentPage.Users.begin(); It != CurrentPage.Users.end(); ++It)
+		{
+			Manifest += (It == CurrentPage.Users.begin() ? "" : ",") + std::to_string(*It);
+		}
+
+		Manifest += "\n";
+	}
+
+	//
+	// Most of the types do not change between the builds,
+	// only the differences from the previous build are listed.
+	//
+
+	std::map<DWORD, ULONGLONG> PreviousTypes;
+
+	for (auto&& CurrentBuild : CurrentModule.Builds)
+	{
+		Manifest += "build\t" + CurrentBuild.Name + "\t" + CurrentBuild.PdbPath + "\n";
+
+		std::map<DWORD, ULONGLONG> Types(CurrentBuild.Types.begin(), CurrentBuild.Types.end());
+
+		for (auto&& Type : Types)
+		{
+			auto It = PreviousTypes.find(Type.first);
+
+			if (It == PreviousTypes.end() || It->second != Type.second)
+			{
+				Manifest += "+\t" + std::to_string(Type.first) + "\t" + GetHashString(Type.second) + "\n";
+			}
+		}
+
+		for (auto&& Type : PreviousTypes)
+		{
+			if (Types.find(Type.first) == Types.end())
+			{
+				Manifest += "-\t" + std::to_string(Type.first) + "\n";
+			}
+		}
+
+		PreviousTypes.swap(Types);
+	}
+
+	return Manifest;
+}
+
+bool
+PDBTypeBrowser::FindHash(
+	const SYMBOL* Symbol,
+	const BuildHashes& Hashes,
+	ULONGLONG& Hash
+	)
+{
+	if (PDB::IsUnnamedSymbol(Symbol))
+	{
+		auto It = Hashes.Unnamed.find(Symbol);
+
+		if (It == Hashes.Unnamed.end())
+		{
+			return false;
+		}
+
+		Hash = It->second;
+		return true;
+	}
+
+	auto It = Hashes.Named.find(Symbol->Name);
+
+	if (It == Hashes.Named.end())
+	{
+		return false;
+	}
+
+	Hash = It->second;
+	return true;
+}
+
+std::string
+PDBTypeBrowser::GetTypeString(
+	const SYMBOL* Symbol,
+	const BuildHashes& Hashes,
+	bool Html
+	)
+{
+	switch (Symbol->Tag)
+	{
+		case SymTagBaseType:
+		{
+			const CHAR* BasicTypeString = PDB::GetBasicTypeString(Symbol);
+			return BasicTypeString ? BasicTypeString : "?";
+		}
+
+		case SymTagPointerType:
+		{
+			//
+			// Pointed-to types are not dependencies, they lead
+			// to the name page, which does not change with the hash.
+			//
+
+			const SYMBOL* Type = Symbol->u.Pointer.Type;
+			const char* Suffix = Symbol->u.Pointer.IsReference ? "&" : "*";
+
+			if ((Type->Tag == SymTagUDT || Type->Tag == SymTagEnum) && !PDB::IsUnnamedSymbol(Type))
+			{
+				return Html
+					? "<a href=\"../names/" + GetNameFileName(Type->Name) + ".html\">" + Escape(Type->Name) + "</a>" + Suffix
+					: std::string(Type->Name) + Suffix;
+			}
+
+			return GetTypeString(Type, Hashes, Html) + Suffix;
+		}
+
+		case SymTagArrayType:
+		{
+			return GetTypeString(Symbol->u.Array.ElementType, Hashes, Html) + "[" + std::to_string(Symbol->u.Array.ElementCount) + "]";
+		}
+
+		case SymTagTypedef:
+		{
+			return Html ? Escape(Symbol->Name) : Symbol->Name;
+		}
+
+		case SymTagFunctionType:
+		{
+			return "function";
+		}
+
+		case SymTagEnum:
+		case SymTagUDT:
+		{
+			ULONGLONG Hash;
+
+			if (!FindHash(Symbol, Hashes, Hash))
+			{
+				return Html ? Escape(Symbol->Name) : Symbol->Name;
+			}
+
+			return Html
+				? "<a href=\"" + GetHashString(Hash) + ".html\">" + Escape(Symbol->Name) + "</a>"
+				: std::string(Symbol->Name) + "#" + GetHashString(Hash);
+		}
+
+		default:
+		{
+			return "?";
+		}
+	}
+}
+
+std::string
+PDBTypeBrowser::GetStructure(
+	const SYMBOL* Symbol,
+	const BuildHashes& Hashes
+	)
+{
+	std::ostringstream Structure;
+
+	//
+	// Pages of another version of the generator are different pages.
+	//
+
+	Structure << MANIFEST_SIGNATURE << " " << GENERATOR_VERSION << "\n";
+
+	if (Symbol->Tag == SymTagEnum)
+	{
+		Structure << "enum " << Symbol->Name << " " << Symbol->Size << "\n";
+
+		for (DWORD Index = 0; Index < Symbol->u.Enum.FieldCount; Index++)
+		{
+			const SYMBOL_ENUM_FIELD* EnumField = &Symbol->u.Enum.Fields[Index];
+			LONGLONG Value = 0;
+
+			Structure << EnumField->Name << " ";
+
+			if (GetEnumValue(&EnumField->Value, Value))
+			{
+				Structure << Value;
+			}
+
+			Structure << "\n";
+		}
+	}
+	else
+	{
+		Structure << PDB::GetUdtKindString(Symbol->u.Udt.Kind) << " " << Symbol->Name << " " << Symbol->Size << "\n";
+
+		for (DWORD Index = 0; Index < Symbol->u.Udt.FieldCount; Index++)
+		{
+			const SYMBOL_UDT_FIELD* UdtField = &Symbol->u.Udt.Fields[Index];
+
+			Structure << UdtField->Offset << " "
+			          << UdtField->Bits << " "
+			          << UdtField->BitPosition << " "
+			          << UdtField->Name << " "
+			          << GetTypeString(UdtField->Type, Hashes, false) << "\n";
+		}
+	}
+
+	return Structure.str();
+}
+
+std::string
+PDBTypeBrowser::RenderTypePage(
+	const SYMBOL* Symbol,
+	const BuildHashes& Hashes
+	)
+{
+	//
+	// Only the parts of GetStructure() are rendered,
+	// pages of the same hash are the same.
+	//
+
+	std::string Html;
+	std::string Name = Escape(Symbol->Name);
+	bool IsEnum = Symbol->Tag == SymTagEnum;
+
+	BeginPage(Html, Name, "../../style.css");
+
+	Html += "<h1>";
+	Html += IsEnum ? "enum" : PDB::GetUdtKindString(Symbol->u.Udt.Kind);
+	Html += " " + Name + "</h1>\n<p>Size " + FormatHex(Symbol->Size);
+
+	if (!PDB::IsUnnamedSymbol(Symbol))
+	{
+		Html += " &middot; <a href=\"../names/" + GetNameFileName(Symbol->Name) + ".html\">versions and users</a>";
+	}
+
+	Html += "</p>\n<table>\n";
+
+	if (IsEnum)
+	{
+		Html += "<tr><th>Value</th><th>Name</th></tr>\n";
+
+		for (DWORD Index = 0; Index < Symbol->u.Enum.FieldCount; Index++)
+		{
+			const SYMBOL_ENUM_FIELD* EnumField = &Symbol->u.Enum.Fields[Index];
+			LONGLONG Value = 0;
+
+			Html += "<tr><td>";
+
+			if (GetEnumValue(&EnumField->Value, Value))
+			{
+				Html += std::to_string(Value);
+			}
+
+			Html += "</td><td>" + Escape(EnumField->Name) + "</td></tr>\n";
+		}
+	}
+	else
+	{
+		Html += "<tr><th>Offset</th><th>Bits</th><th>Type</th><th>Name</th></tr>\n";
+
+		for (DWORD Index = 0; Index < Symbol->u.Udt.FieldCount; Index++)
+		{
+			const SYMBOL_UDT_FIELD* UdtField = &Symbol->u.Udt.Fields[Index];
+
+			Html += "<tr><td>" + FormatHex(UdtField->Offset, 4) + "</td><td>";
+
+			if (UdtField->Bits != 0)
+			{
+				Html += std::to_string(UdtField->BitPosition) + ":" + std::to_string(UdtField->Bits);
+			}
+
+			Html += "</td><td>" + GetTypeString(UdtField->Type, Hashes, true) + "</td>";
+			Html += "<td>" + Escape(UdtField->Name) + "</td></tr>\n";
+		}
+	}
+
+	Html += "</table>\n";
+
+	EndPage(Html);
+
+	return Html;
+}
+
+std::string
+PDBTypeBrowser::RenderModulePage(
+	const Module& CurrentModule,
+	const std::vector<VersionList>& Versions
+	) const
+{
+	std::string Html;
+	std::string ModuleName = Escape(CurrentModule.Name);
+
+	BeginPage(Html, ModuleName, "../style.css");
+
+	Html += "<p><a href=\"../index.html\">Modules</a></p>\n";
+	Html += "<h1>" + ModuleName + "</h1>\n<h2>Builds</h2>\n<table>\n";
+	Html += "<tr><th>Build</th><th>Types</th><th>PDB</th></tr>\n";
+
+	for (auto&& CurrentBuild : CurrentModule.Builds)
+	{
+		Html += "<tr><td><a href=\"builds/" + CurrentBuild.Name + ".html\">" + CurrentBuild.Name + "</a></td>";
+		Html += "<td>" + std::to_string(CurrentBuild.Types.size()) + "</td>";
+		Html += "<td>" + Escape(CurrentBuild.PdbPath) + "</td></tr>\n";
+	}
+
+	Html += "</table>\n<h2>Types</h2>\n<table>\n";
+	Html += "<tr><th>Name</th><th>Versions</th><th>Builds</th></tr>\n";
+
+	std::vector<DWORD> NameIndices(CurrentModule.Names.size());
+
+	for (DWORD Index = 0; Index < NameIndices.size(); Index++)
+	{
+		NameIndices[Index] = Index;
+	}
+
+	std::sort(NameIndices.begin(), NameIndices.end(), [&CurrentModule](DWORD Left, DWORD Right) {
+		return CurrentModule.Names[Left] < CurrentModule.Names[Right];
+	});
+
+	for (DWORD NameIndex : NameIndices)
+	{
+		size_t BuildCount = 0;
+
+		for (auto&& Version : Versions[NameIndex])
+		{
+			BuildCount += Version.second.size();
+		}
+
+		Html += "<tr><td><a href=\"names/" + GetNameFileName(CurrentModule.Names[NameIndex]) + ".html\">" + Escape(CurrentModule.Names[NameIndex]) + "</a></td>";
+		Html += "<td>" + std::to_string(Versions[NameIndex].size()) + "</td>";
+		Html += "<td>" + std::to_string(BuildCount) + "</td></tr>\n";
+	}
+
+	Html += "</table>\n";
+
+	EndPage(Html);
+
+	return Html;
+}
+
+std::string
+PDBTypeBrowser::RenderBuildPage(
+	const Module& CurrentModule,
+	size_t BuildIndex
+	) const
+{
+	const Build& CurrentBuild = CurrentModule.Builds[BuildIndex];
+
+	std::string Html;
+	std::string ModuleName = Escape(CurrentModule.Name);
+
+	BeginPage(Html, ModuleName + " " + CurrentBuild.Name, "../../style.css");
+
+	Html += "<p><a href=\"../index.html\">" + ModuleName + "</a>";
+
+	if (BuildIndex > 0)
+	{
+		Html += " &middot; <a href=\"" + CurrentModule.Builds[BuildIndex - 1].Name + ".html\">previous build</a>";
+	}
+
+	if (BuildIndex + 1 < CurrentModule.Builds.size())
+	{
+		Html += " &middot; <a href=\"" + CurrentModule.Builds[BuildIndex + 1].Name + ".html\">next build</a>";
+	}
+
+	Html += "</p>\n<h1>" + ModuleName + " " + CurrentBuild.Name + "</h1>\n";
+	Html += "<p>" + Escape(CurrentBuild.PdbPath) + "</p>\n<table>\n";
+	Html += "<tr><th>Type</th><th>Size</th><th>Since the previous build</th></tr>\n";
+
+	//
+	// Types are compared with the previous build of the list.
+	//
+
+	std::map<DWORD, ULONGLONG> PreviousTypes;
+
+	if (BuildIndex > 0)
+	{
+		PreviousTypes.insert(CurrentModule.Builds[BuildIndex - 1].Types.begin(), CurrentModule.Builds[BuildIndex - 1].Types.end());
+	}
+
+	for (auto&& Type : CurrentBuild.Types)
+	{
+		const char* Change = "";
+
+		if (BuildIndex > 0)
+		{
+			auto It = PreviousTypes.find(Type.first);
+
+			Change = It == PreviousTypes.end()
+				? "new"
+				: It->second != Type.second
+					? "changed"
+					: "";
+		}
+
+		Html += "<tr><td><a href=\"../types/" + GetHashString(Type.second) + ".html\">" + Escape(CurrentModule.Names[Type.first]) + "</a></td>";
+		Html += "<td>" + FormatHex(CurrentModule.Pages.at(Type.second).Size) + "</td>";
+		Html += "<td class=\"changed\">" + std::string(Change) + "</td></tr>\n";
+	}
+
+	Html += "</table>\n";
+
+	EndPage(Html);
+
+	return Html;
+}
+
+std::string
+PDBTypeBrowser::RenderNamePage(
+	const Module& CurrentModule,
+	DWORD NameIndex,
+	const VersionList& Versions
+	) const
+{
+	std::string Html;
+	std::string Name = Escape(CurrentModule.Names[NameIndex]);
+
+	BeginPage(Html, Name, "../../style.css");
+
+	Html += "<p><a href=\"../index.html\">" + Escape(CurrentModule.Name) + "</a></p>\n";
+	Html += "<h1>" + Name + "</h1>\n";
+
+	for (size_t VersionIndex = 0; VersionIndex < Versions.size(); VersionIndex++)
+	{
+		ULONGLONG Hash = Versions[VersionIndex].first;
+		const Page& CurrentPage = CurrentModule.Pages.at(Hash);
+
+		Html += "<h2><a href=\"../types/" + GetHashString(Hash) + ".html\">Version " + std::to_string(VersionIndex + 1) + "</a>";
+		Html += " (size " + FormatHex(CurrentPage.Size) + ")</h2>\n<p>Builds:";
+
+		for (size_t BuildIndex : Versions[VersionIndex].second)
+		{
+			const std::string& BuildName = CurrentModule.Builds[BuildIndex].Name;
+
+			Html += " <a href=\"../builds/" + BuildName + ".html\">" + BuildName + "</a>";
+		}
+
+		Html += "</p>\n";
+
+		if (CurrentPage.Users.empty())
+		{
+			continue;
+		}
+
+		//
+		// Users lead to their name pages, the version
+		// of the user may differ between the builds.
+		//
+
+		std::vector<const std::string*> Users;
+
+		for (DWORD UserNameIndex : CurrentPage.Users)
+		{
+			Users.push_back(&CurrentModule.Names[UserNameIndex]);
+		}
+
+		std::sort(Users.begin(), Users.end(), [](const std::string* Left, const std::string* Right) {
+			return *Left < *Right;
+		});
+
+		Html += "<p>Used by:";
+
+		for (const std::string* User : Users)
+		{
+			Html += " <a href=\"" + GetNameFileName(*User) + ".html\">" + Escape(*User) + "</a>";
+		}
+
+		Html += "</p>\n";
+	}
+
+	EndPage(Html);
+
+	return Html;
+}
+
+std::string
+PDBTypeBrowser::RenderIndexPage(
+	const std::map<std::string, ModuleSummary>& Modules
+	)
+{
+	std::string Html;
+
+	BeginPage(Html, "Modules", "style.css");
+
+	Html += "<h1>Modules</h1>\n<table>\n<tr><th>Module</th><th>Builds</th><th>Types</th></tr>\n";
+
+	for (auto&& e : Modules)
+	{
+		std::string ModuleName = Escape(e.first);
+
+		Html += "<tr><td><a href=\"" + ModuleName + "/index.html\">" + ModuleName + "</a></td>";
+		Html += "<td>" + std::to_string(e.second.BuildCount) + "</td>";
+		Html += "<td>" + std::to_string(e.second.NameCount) + "</td></tr>\n";
+	}
+
+	Html += "</table>\n";
+
+	EndPage(Html);
+
+	return Html;
+}
+
+bool
+PDBTypeBrowser::WritePage(
+	const std::string& Path,
+	const std::string& Contents
+	)
+{
+	//
+	// Unchanged pages keep their time stamps,
+	// so only the changed files are synchronized.
+	//
+
+	std::ifstream ExistingFile(Path, std::ios::in | std::ios::binary);
+
+	if (ExistingFile.is_open())
+	{
+		std::ostringstream ExistingContents;
+		ExistingContents << ExistingFile.rdbuf();
+
+		if (ExistingContents.str() == Contents)
+		{
+			return true;
+		}
+
+		ExistingFile.close();
+	}
+
+	std::ofstream File(Path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+	if (!File.is_open())
+	{
+		return false;
+	}
+
+	File.write(Contents.data(), Contents.size());
+
+	return File.good();
+}
+
+std::string
+PDBTypeBrowser::GetNameFileName(
+	const std::string& Name
+	)
+{
+	//
+	// Names which are not valid file names, or which could collide
+	// with other names on case-insensitive file systems, get
+	// the hash of the name as a suffix.
+	//
+
+	std::string FileName;
+	bool Exact = Name.size() <= MAXIMUM_FILE_NAME_LENGTH;
+
+	for (char Character : Name)
+	{
+		unsigned char Value = static_cast<unsigned char>(Character);
+
+		if (isalnum(Value) || Character == '_')
+		{
+			FileName += Character;
+			Exact = Exact && !islower(Value);
+		}
+		else
+		{
+			FileName += '_';
+			Exact = false;
+		}
+	}
+
+	if (!Exact)
+	{
+		char Suffix[16];
+		sprintf_s(Suffix, "_%08x", static_cast<unsigned>(GetHash(Name)));
+
+		FileName.resize((std::min)(FileName.size(), MAXIMUM_FILE_NAME_LENGTH));
+		FileName += Suffix;
+	}
+
+	return FileName;
+}
+
+std::string
+PDBTypeBrowser::GetHashString(
+	ULONGLONG Hash
+	)
+{
+	char Buffer[32];
+	sprintf_s(Buffer, "%016llx", Hash);
+
+	return Buffer;
+}
+
+std::string
+PDBTypeBrowser::Escape(
+	const std::string& Text
+	)
+{
+	std::string Result;
+	Result.reserve(Text.size());
+
+	for (char Character : Text)
+	{
+		switch (Character)
+		{
+			case '&':  Result += "&amp;";  break;
+			case '<':  Result += "&lt;";   break;
+			case '>':  Result += "&gt;";   break;
+			case '"':  Result += "&quot;"; break;
+			default:   Result += Character; break;
+		}
+	}
+
+	return Result;
+}
@@ -0,0 +1,320 @@
+#pragma once
+#include "PDB.h"
+#include "PDBSymbolSorter.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+//
+// Static HTML site of the types of many builds of the modules:
+//
+//   index.html                        modules
+//   style.css
+//   <module>\index.html               builds and names of the types
+//   <module>\builds\<GUIDAGE>.html    types of the build
+//   <module>\names\<name>.html        versions of the type, their builds
+//                                     and the types which contain them
+//   <module>\types\<hash>.html        layout of one version of the type
+//
+// Type pages are named by the structural hash of the type: version
+// of the generator, its name, size, fields (offsets, bits, names and
+// types) and hashes of the types it contains by value (dependency edges
+// of PDBSymbolSorter). Identical types of different builds share the page.
+//
+// Every module keeps its manifest.txt: names of the types, type pages
+// with their users and the builds (as the differences from the previous
+// build), the root manifest.txt lists the modules. A run loads manifests
+// of the modules it adds builds to, builds which are already there
+// are not opened again and only the pages of the new hashes are
+// written, so the site is extended by the new builds of the list.
+// Manifests of another generator version are ignored.
+//
+// Type pages link to the pages of the contained types and to the name
+// pages of the pointed-to types, "used by" backlinks and the navigation
+// between versions are on the name pages, as they change with every
+// build.
+//
+// New type pages of the build are rendered and written by the worker
+// threads.
+//
+class PDBTypeBrowser
+{
+	public:
+		struct Settings
+		{
+			//
+			// Count of worker threads, 0 means count of CPUs.
+			//
+			DWORD ThreadCount = 0;
+		};
+
+		struct Statistics
+		{
+			size_t BuildCount = 0;
+
+			//
+			// Types of all builds.
+			//
+			size_t TypeCount = 0;
+
+			//
+			// Distinct type pages of the modules with new builds
+			// and those written by this run.
+			//
+			size_t PageCount = 0;
+			size_t WrittenPageCount = 0;
+
+			//
+			// Builds of the previous runs loaded from the manifests.
+			//
+			size_t KeptBuildCount = 0;
+
+			//
+			// Manifests which were not valid or of another version.
+			//
+			size_t IgnoredManifestCount = 0;
+		};
+
+		PDBTypeBrowser(
+			const std::string& Directory,
+			Settings* BrowserSettings = nullptr
+			);
+
+		//
+		// Returns true if the build is in the site, added
+		// by this run or listed in the manifest of the module.
+		//
+		bool
+		HasBuild(
+			const std::string& ModuleName,
+			const std::string& BuildName
+			);
+
+		//
+		// Adds types of the sorted PDB as the build of the module.
+		// BuildName is the GUIDAGE of the PDB. Module names differing
+		// only in case are the same module.
+		//
+		// Returns false if a directory or a page cannot be written.
+		//
+		bool
+		AddBuild(
+			const std::string& ModuleName,
+			const std::string& BuildName,
+			const std::string& PdbPath,
+			PDBSymbolSorter* SymbolSorter
+			);
+
+		//
+		// Writes the index, the module, build and name pages and
+		// the manifests of the modules with new builds. Pages whose
+		// contents did not change are not written.
+		//
+		bool
+		WriteIndex();
+
+		const Statistics&
+		GetStatistics() const
+		{
+			return m_Statistics;
+		}
+
+	private:
+		struct Page
+		{
+			//
+			// Index into Module::Names, or None for unnamed types.
+			//
+			DWORD NameIndex;
+
+			DWORD Size;
+
+			//
+			// Name indices of the named types which contain the type
+			// (directly or through unnamed types) in any build.
+			//
+			std::set<DWORD> Users;
+		};
+
+		struct Build
+		{
+			std::string Name;
+			std::string PdbPath;
+
+			//
+			// Name index and hash of the named types, sorted by names.
+			//
+			std::vector<std::pair<DWORD, ULONGLONG>> Types;
+		};
+
+		struct Module
+		{
+			std::string Name;
+
+			std::vector<std::string> Names;
+			std::map<std::string, DWORD> NameIndices;
+
+			std::vector<Build> Builds;
+			std::map<ULONGLONG, Page> Pages;
+
+			//
+			// Builds were added by this run.
+			//
+			bool Changed = false;
+		};
+
+		//
+		// Line of the module in the root manifest and index.
+		//
+		struct ModuleSummary
+		{
+			size_t BuildCount;
+			size_t NameCount;
+		};
+
+		//
+		// Hashes of the types of the build being added. Named types
+		// are found by their names, as dependencies of PDBSymbolSorter
+		// refer to the first definition of the name.
+		//
+		struct BuildHashes
+		{
+			std::map<const SYMBOL*, ULONGLONG> Unnamed;
+			std::map<std::string, ULONGLONG> Named;
+		};
+
+		//
+		// Versions of one name: hash and indices of the builds
+		// in the order of the builds.
+		//
+		typedef std::vector<std::pair<ULONGLONG, std::vector<size_t>>> VersionList;
+
+		static const DWORD None = (DWORD)-1;
+
+		//
+		// Returns the module of the lowercase name,
+		// loads its manifest when it is used first.
+		//
+		Module&
+		GetModule(
+			const std::string& ModuleName
+			);
+
+		//
+		// Returns false if the manifest is not valid
+		// or it was written by another version.
+		//
+		static
+		bool
+		LoadManifest(
+			const std::string& Path,
+			Module& CurrentModule
+			);
+
+		static
+		std::string
+		RenderManifest(
+			const Module& CurrentModule
+			);
+
+		static
+		bool
+		FindHash(
+			const SYMBOL* Symbol,
+			const BuildHashes& Hashes,
+			ULONGLONG& Hash
+			);
+
+		//
+		// Describes the type of the field. Html adds links, otherwise
+		// the description is the input of the structural hash.
+		//
+		static
+		std::string
+		GetTypeString(
+			const SYMBOL* Symbol,
+			const BuildHashes& Hashes,
+			bool Html
+			);
+
+		//
+		// Describes the enum or UDT, everything rendered on its page
+		// is described.
+		//
+		static
+		std::string
+		GetStructure(
+			const SYMBOL* Symbol,
+			const BuildHashes& Hashes
+			);
+
+		static
+		std::string
+		RenderTypePage(
+			const SYMBOL* Symbol,
+			const BuildHashes& Hashes
+			);
+
+		std::string
+		RenderModulePage(
+			const Module& CurrentModule,
+			const std::vector<VersionList>& Versions
+			) const;
+
+		std::string
+		RenderBuildPage(
+			const Module& CurrentModule,
+			size_t BuildIndex
+			) const;
+
+		std::string
+		RenderNamePage(
+			const Module& CurrentModule,
+			DWORD NameIndex,
+			const VersionList& Versions
+			) const;
+
+		static
+		std::string
+		RenderIndexPage(
+			const std::map<std::string, ModuleSummary>& Modules
+			);
+
+		//
+		// Writes the file unless it has the same contents.
+		//
+		static
+		bool
+		WritePage(
+			const std::string& Path,
+			const std::string& Contents
+			);
+
+		static
+		std::string
+		GetNameFileName(
+			const std::string& Name
+			);
+
+		static
+		std::string
+		GetHashString(
+			ULONGLONG Hash
+			);
+
+		static
+		std::string
+		Escape(
+			const std::string& Text
+			);
+
+	private:
+		std::string m_Directory;
+		Settings* m_Settings;
+
+		std::map<std::string, Module> m_Modules;
+
+		Statistics m_Statistics;
+};
@@ -0,0 +1,322 @@
+#include "ProcessMemoryImage.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	static ProcessMemoryImage::Settings DefaultSettings;
+}
+
+ProcessMemoryImage::ProcessMemoryImage(
+	Settings* ImageSettings
+	)
+{
+	m_Settings = ImageSettings ? ImageSettings : &DefaultSettings;
+}
+
+ProcessMemoryImage::~ProcessMemoryImage()
+{
+	Close();
+}
+
+bool
+ProcessMemoryImage::Open(
+	DWORD ProcessId
+	)
+{
+	Close();
+
+	m_ProcessHandle = OpenProcess(PROCESS_VM_READ | PROCESS_QUERY_INFORMATION, FALSE, ProcessId);
+
+	if (m_ProcessHandle == nullptr)
+	{
+		return false;
+	}
+
+	SYSTEM_INFO SystemInfo;
+	GetSystemInfo(&SystemInfo);
+
+	m_PageSize = SystemInfo.dwPageSize;
+
+	return true;
+}
+
+void
+ProcessMemoryImage::Close()
+{
+	if (m_ProcessHandle != nullptr)
+	{
+		CloseHandle(m_ProcessHandle);
+		m_ProcessHandle = nullptr;
+	}
+
+	m_Pages.clear();
+	m_Regions.clear();
+}
+
+bool
+ProcessMemoryImage::Read(
+	ULONGLONG Address,
+	void* Buffer,
+	size_t Size
+	)
+{
+	if (Size == 0)
+	{
+		return true;
+	}
+
+	ULONGLONG FirstPage = Address / m_PageSize;
+	ULONGLONG LastPage = (Address + Size - 1) / m_PageSize;
+
+	std::lock_guard<std::mutex> Lock(m_Lock);
+
+	std::vector<ULONGLONG> PageNumbers;
+
+	for (ULONGLONG PageNumber = FirstPage; PageNumber <= LastPage; PageNumber++)
+	{
+		PageNumbers.push_back(PageNumber);
+	}
+
+	FetchPages(PageNumbers);
+
+	BYTE* Destination = static_cast<BYTE*>(Buffer);
+
+	for (ULONGLONG PageNumber = FirstPage; PageNumber <= LastPage; PageNumber++)
+	{
+		auto PageIterator = m_Pages.find(PageNumber);
+
+		if (PageIterator == m_Pages.end() || !PageIterator->second.Data)
+		{
+			return false;
+		}
+
+		ULONGLONG PageAddress = PageNumber * m_PageSize;
+		ULONGLONG CopyBegin = (std::max)(Address, PageAddress);
+		ULONGLONG CopyEnd = (std::min)(Address + Size, PageAddress + m_PageSize);
+
+		memcpy(
+			Destination + (CopyBegin - Address),
+			PageIterator->second.Data.get() + (CopyBegin - PageAddress),
+			static_cast<size_t>(CopyEnd - CopyBegin)
+			);
+	}
+
+	return true;
+}
+
+void
+ProcessMemoryImage::Prefetch(
+	const std::vector<Range>& Ranges
+	)
+{
+	std::vector<ULONGLONG> PageNumbers;
+
+	for (auto&& CurrentRange : Ranges)
+	{
+		if (CurrentRange.Size == 0)
+		{
+			continue;
+		}
+
+		ULONGLONG FirstPage = CurrentRange.Address / m_PageSize;
+		ULONGLONG LastPage = (CurrentRange.Address + CurrentRange.Size - 1) / m_PageSize;
+
+		for (ULONGLONG PageNumber = FirstPage; PageNumber <= LastPage; PageNumber++)
+		{
+			PageNumbers.push_back(PageNumber);
+		}
+	}
+
+	std::lock_guard<std::mutex> Lock(m_Lock);
+
+	FetchPages(PageNumbers);
+}
+
+void
+ProcessMemoryImage::Refresh()
+{
+	std::lock_guard<std::mutex> Lock(m_Lock);
+
+	DropUnstablePages();
+
+	//
+	// Allocations may have changed.
+	//
+
+	m_Regions.clear();
+}
+
+void
+ProcessMemoryImage::FetchPages(
+	std::vector<ULONGLONG>& PageNumbers
+	)
+{
+	PageNumbers.erase(std::remove_if(PageNumbers.begin(), PageNumbers.end(), [this](ULONGLONG PageNumber) {
+		return m_Pages.find(PageNumber) != m_Pages.end();
+	}), PageNumbers.end());
+
+	if (PageNumbers.empty())
+	{
+		return;
+	}
+
+	std::sort(PageNumbers.begin(), PageNumbers.end());
+	PageNumbers.erase(std::unique(PageNumbers.begin(), PageNumbers.end()), PageNumbers.end());
+
+	TrimCache();
+
+	//
+	// Merge the missing pages into runs, small gaps
+	// are cheaper to read than to request separately.
+	//
+
+	size_t RunBegin = 0;
+
+	for (size_t Index = 1; Index <= PageNumbers.size(); Index++)
+	{
+		if (Index < PageNumbers.size() &&
+		    PageNumbers[Index] - PageNumbers[Index - 1] <= 1 + m_Settings->MergeGapPageCount)
+		{
+			continue;
+		}
+
+		FetchRun(PageNumbers.data() + RunBegin, PageNumbers.data() + Index);
+
+		RunBegin = Index;
+	}
+}
+
+void
+ProcessMemoryImage::FetchRun(
+	const ULONGLONG* Begin,
+	const ULONGLONG* End
+	)
+{
+	ULONGLONG FirstPage = *Begin;
+	ULONGLONG PageCount = End[-1] - FirstPage + 1;
+
+	std::unique_ptr<BYTE[]> RunData(new BYTE[static_cast<size_t>(PageCount * m_PageSize)]);
+	SIZE_T BytesRead = 0;
+
+	m_RequestCount += 1;
+
+	BOOL Success = ReadProcessMemory(
+		m_ProcessHandle,
+		reinterpret_cast<LPCVOID>(static_cast<ULONG_PTR>(FirstPage * m_PageSize)),
+		RunData.get(),
+		static_cast<SIZE_T>(PageCount * m_PageSize),
+		&BytesRead
+		);
+
+	if (!Success && End - Begin > 1)
+	{
+		//
+		// Some page of the run is not readable,
+		// split the run to find it.
+		//
+
+		const ULONGLONG* Middle = Begin + (End - Begin) / 2;
+
+		FetchRun(Begin, Middle);
+		FetchRun(Middle, End);
+		return;
+	}
+
+	for (const ULONGLONG* PageNumber = Begin; PageNumber != End; PageNumber++)
+	{
+		Page& NewPage = m_Pages[*PageNumber];
+		NewPage.Stable = false;
+
+		if (Success)
+		{
+			NewPage.Data.reset(new BYTE[m_PageSize]);
+			memcpy(NewPage.Data.get(), RunData.get() + (*PageNumber - FirstPage) * m_PageSize, m_PageSize);
+
+			NewPage.Stable = IsStablePage(*PageNumber);
+		}
+	}
+}
+
+bool
+ProcessMemoryImage::IsStablePage(
+	ULONGLONG PageNumber
+	)
+{
+	ULONGLONG Address = PageNumber * m_PageSize;
+
+	auto RegionIterator = m_Regions.upper_bound(Address);
+
+	if (RegionIterator != m_Regions.begin())
+	{
+		--RegionIterator;
+
+		if (Address < RegionIterator->second.End)
+		{
+			return RegionIterator->second.Stable;
+		}
+	}
+
+	MEMORY_BASIC_INFORMATION MemoryInfo;
+
+	if (VirtualQueryEx(
+		m_ProcessHandle,
+		reinterpret_cast<LPCVOID>(static_cast<ULONG_PTR>(Address)),
+		&MemoryInfo,
+		sizeof(MemoryInfo)) == 0)
+	{
+		return false;
+	}
+
+	//
+	// Only sections of loaded images which cannot be written.
+	//
+
+	bool Stable =
+		MemoryInfo.State == MEM_COMMIT &&
+		MemoryInfo.Type == MEM_IMAGE &&
+		(MemoryInfo.Protect & PAGE_GUARD) == 0 &&
+		(MemoryInfo.Protect & (PAGE_READONLY | PAGE_EXECUTE | PAGE_EXECUTE_READ)) != 0;
+
+	ULONGLONG RegionBase = reinterpret_cast<ULONG_PTR>(MemoryInfo.BaseAddress);
+	m_Regions[RegionBase] = { RegionBase + MemoryInfo.RegionSize, Stable };
+
+	return Stable;
+}
+
+void
+ProcessMemoryImage::TrimCache()
+{
+	if (m_Pages.size() < m_Settings->MaximumCachedPageCount)
+	{
+		return;
+	}
+
+	//
+	// Changing pages go first.
+	//
+
+	DropUnstablePages();
+
+	if (m_Pages.size() >= m_Settings->MaximumCachedPageCount / 2)
+	{
+		m_Pages.clear();
+	}
+}
+
+void
+ProcessMemoryImage::DropUnstablePages()
+{
+	for (auto PageIterator = m_Pages.begin(); PageIterator != m_Pages.end(); )
+	{
+		if (PageIterator->second.Stable)
+		{
+			++PageIterator;
+		}
+		else
+		{
+			PageIterator = m_Pages.erase(PageIterator);
+		}
+	}
+}
@@ -0,0 +1,146 @@
+#pragma once
+#include "MemoryImage.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+//
+// Memory of a live process, read by ReadProcessMemory.
+//
+// Pages are cached, missing pages of every read (or of all ranges
+// passed to Prefetch) are merged into continuous runs and every run
+// is fetched by a single ReadProcessMemory call (runs which contain
+// unreadable pages are split).
+//
+// Pages of read-only image sections (code, constants of loaded DLLs)
+// are stable and stay cached across Refresh(), so repeated inspection
+// of the process - or of many processes - reads mostly the pages
+// which may have changed.
+//
+class ProcessMemoryImage
+	: public MemoryImage
+{
+	public:
+		struct Settings
+		{
+			//
+			// Maximum count of cached pages.
+			//
+			DWORD MaximumCachedPageCount = 65536;
+
+			//
+			// Runs of missing pages separated by at most this count
+			// of pages are fetched by one call.
+			//
+			DWORD MergeGapPageCount = 2;
+		};
+
+		ProcessMemoryImage(
+			Settings* ImageSettings = nullptr
+			);
+
+		~ProcessMemoryImage() override;
+
+		ProcessMemoryImage(const ProcessMemoryImage&) = delete;
+		ProcessMemoryImage& operator=(const ProcessMemoryImage&) = delete;
+
+		//
+		// Returns false if the process cannot be opened.
+		//
+		bool
+		Open(
+			DWORD ProcessId
+			);
+
+		void
+		Close();
+
+		bool
+		Read(
+			ULONGLONG Address,
+			void* Buffer,
+			size_t Size
+			) override;
+
+		void
+		Prefetch(
+			const std::vector<Range>& Ranges
+			) override;
+
+		//
+		// Drops cached pages which may have changed since they were read.
+		//
+		void
+		Refresh();
+
+		//
+		// Count of ReadProcessMemory calls.
+		//
+		ULONGLONG
+		GetRequestCount() const
+		{
+			return m_RequestCount;
+		}
+
+	private:
+		struct Page
+		{
+			//
+			// nullptr if the page is not readable.
+			//
+			std::unique_ptr<BYTE[]> Data;
+
+			bool Stable;
+		};
+
+		struct Region
+		{
+			ULONGLONG End;
+			bool Stable;
+		};
+
+		void
+		FetchPages(
+			std::vector<ULONGLONG>& PageNumbers
+			);
+
+		//
+		// Fetches the sorted missing pages by one call if possible.
+		//
+		void
+		FetchRun(
+			const ULONGLONG* Begin,
+			const ULONGLONG* End
+			);
+
+		bool
+		IsStablePage(
+			ULONGLONG PageNumber
+			);
+
+		void
+		TrimCache();
+
+		void
+		DropUnstablePages();
+
+	private:
+		Settings* m_Settings;
+
+		HANDLE m_ProcessHandle = nullptr;
+		DWORD m_PageSize = 0x1000;
+
+		std::mutex m_Lock;
+
+		std::unordered_map<ULONGLONG, Page> m_Pages;
+
+		//
+		// Regions of the address space by their base address.
+		//
+		std::map<ULONGLONG, Region> m_Regions;
+
+		ULONGLONG m_RequestCount = 0;
+};
@@ -0,0 +1,408 @@
+#include "SymbolNameIndex.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+const size_t SymbolNameIndex::BLOCK_SIZE;
+const size_t SymbolNameArena::CHUNK_SIZE;
+
+void
+SymbolNameIndex::Insert(
+	const std::string& Name,
+	SYMBOL* Symbol
+	)
+{
+	m_PendingSymbols[Name] = Symbol;
+}
+
+SYMBOL*
+SymbolNameIndex::Find(
+	const char* Name
+	) const
+{
+	if (!m_PendingSymbols.empty())
+	{
+		auto it = m_PendingSymbols.find(Name);
+
+		if (it != m_PendingSymbols.end())
+		{
+			return it->second;
+		}
+	}
+
+	if (m_BlockOffsets.empty())
+	{
+		return nullptr;
+	}
+
+	size_t NameLength = strlen(Name);
+
+	//
+	// Last block whose first name is not greater than the Name.
+	//
+
+	size_t Low = 0;
+	size_t High = m_BlockOffsets.size();
+
+	while (High - Low > 1)
+	{
+		size_t Middle = Low + (High - Low) / 2;
+
+		if (CompareBlock(Middle, Name, NameLength) <= 0)
+		{
+			Low = Middle;
+		}
+		else
+		{
+			High = Middle;
+		}
+	}
+
+	//
+	// Names of the block are sorted, the decoding stops
+	// at the first name which is not less than the Name.
+	//
+
+	std::string CurrentName;
+	const BYTE* Position = m_Data.data() + m_BlockOffsets[Low];
+
+	size_t Begin = Low * BLOCK_SIZE;
+	size_t End = (std::min)(Begin + BLOCK_SIZE, m_Symbols.size());
+
+	for (size_t Index = Begin; Index < End; Index++)
+	{
+		Position = DecodeEntry(Position, CurrentName);
+
+		int Result = CurrentName.compare(0, std::string::npos, Name, NameLength);
+
+		if (Result == 0)
+		{
+			return m_Symbols[Index];
+		}
+
+		if (Result > 0)
+		{
+			break;
+		}
+	}
+
+	return nullptr;
+}
+
+void
+SymbolNameIndex::Compact()
+{
+	if (m_PendingSymbols.empty())
+	{
+		return;
+	}
+
+	//
+	// Names which are already front-coded are decoded and merged
+	// with the inserted ones, the inserted symbols take precedence.
+	// The hash map is swapped out, it would keep its buckets otherwise.
+	//
+
+	std::vector<std::pair<std::string, SYMBOL*>> Names;
+	Names.reserve(m_Symbols.size() + m_PendingSymbols.size());
+
+	ForEach([this, &Names](const std::string& Name, SYMBOL* Symbol) {
+		if (m_PendingSymbols.find(Name) == m_PendingSymbols.end())
+		{
+			Names.emplace_back(Name, Symbol);
+		}
+	});
+
+	for (auto&& e : m_PendingSymbols)
+	{
+		Names.emplace_back(e.first, e.second);
+	}
+
+	std::unordered_map<std::string, SYMBOL*>().swap(m_PendingSymbols);
+
+	std::sort(Names.begin(), Names.end(), [](const std::pair<std::string, SYMBOL*>& Left, const std::pair<std::string, SYMBOL*>& Right) {
+		return Left.first < Right.first;
+	});
+
+	m_Data.clear();
+	m_BlockOffsets.clear();
+	m_Symbols.clear();
+
+	m_Symbols.reserve(Names.size());
+	m_BlockOffsets.reserve((Names.size() + BLOCK_SIZE - 1) / BLOCK_SIZE);
+
+	const std::string* PreviousName = nullptr;
+
+	for (size_t Index = 0; Index < Names.size(); Index++)
+	{
+		const std::string& Name = Names[Index].first;
+		size_t SharedLength = 0;
+
+		if (Index % BLOCK_SIZE == 0)
+		{
+			m_BlockOffsets.push_back(static_cast<DWORD>(m_Data.size()));
+		}
+		else
+		{
+			size_t MaximumLength = (std::min)(Name.size(), PreviousName->size());
+
+			while (SharedLength < MaximumLength && Name[SharedLength] == (*PreviousName)[SharedLength])
+			{
+				SharedLength++;
+			}
+		}
+
+		WriteLength(m_Data, SharedLength);
+		WriteLength(m_Data, Name.size() - SharedLength);
+		m_Data.insert(m_Data.end(), Name.begin() + SharedLength, Name.end());
+
+		m_Symbols.push_back(Names[Index].second);
+		PreviousName = &Name;
+	}
+
+	m_Data.shrink_to_fit();
+}
+
+void
+SymbolNameIndex::Clear()
+{
+	std::vector<BYTE>().swap(m_Data);
+	std::vector<DWORD>().swap(m_BlockOffsets);
+	std::vector<SYMBOL*>().swap(m_Symbols);
+	std::unordered_map<std::string, SYMBOL*>().swap(m_PendingSymbols);
+}
+
+size_t
+SymbolNameIndex::GetCount() const
+{
+	return m_Symbols.size() + m_PendingSymbols.size();
+}
+
+size_t
+SymbolNameIndex::GetCompactSize() const
+{
+	return m_Data.size() +
+	       m_BlockOffsets.size() * sizeof(DWORD) +
+	       m_Symbols.size() * sizeof(SYMBOL*);
+}
+
+void
+SymbolNameIndex::WriteLength(
+	std::vector<BYTE>& Data,
+	size_t Length
+	)
+{
+	while (Length >= 0x80)
+	{
+		Data.push_back(static_cast<BYTE>(Length | 0x80));
+		Length >>= 7;
+	}
+
+	Data.push_back(static_cast<BYTE>(Length));
+}
+
+size_t
+SymbolNameIndex::ReadLength(
+	const BYTE*& Position
+	)
+{
+	size_t Length = 0;
+	DWORD Shift = 0;
+
+	while (*Position & 0x80)
+	{
+		Length |= static_cast<size_t>(*Position++ & 0x7F) << Shift;
+		Shift += 7;
+	}
+
+	Length |= static_cast<size_t>(*Position++) << Shift;
+
+	return Length;
+}
+
+const BYTE*
+SymbolNameIndex::DecodeEntry(
+	const BYTE* Position,
+	std::string& Name
+	)
+{
+	size_t SharedLength = ReadLength(Position);
+	size_t SuffixLength = ReadLength(Position);
+
+	Name.resize(SharedLength);
+	Name.append(reinterpret_cast<const char*>(Position), SuffixLength);
+
+	return Position + SuffixLength;
+}
+
+int
+SymbolNameIndex::CompareBlock(
+	size_t BlockIndex,
+	const char* Name,
+	size_t NameLength
+	) const
+{
+	//
+	// The first name of the block is stored in full.
+	//
+
+	const BYTE* Position = m_Data.data() + m_BlockOffsets[BlockIndex];
+
+	ReadLength(Position);
+	size_t Length = ReadLength(Position);
+
+	int Result = memcmp(Position, Name, (std::min)(Length, NameLength));
+
+	if (Result != 0)
+	{
+		return Result;
+	}
+
+	return Length < NameLength ? -1 : Length > NameLength ? 1 : 0;
+}
+
+CHAR*
+SymbolNameArena::Add(
+	const char* Name,
+	size_t NameLength
+	)
+{
+	//
+	// The table is kept at most half full.
+	//
+
+	if ((m_Count + 1) * 2 > m_Table.size())
+	{
+		Grow();
+	}
+
+	size_t Mask = m_Table.size() - 1;
+	size_t Slot = Hash(Name, NameLength) & Mask;
+
+	while (m_Table[Slot] != nullptr)
+	{
+		if (strncmp(m_Table[Slot], Name, NameLength) == 0 && m_Table[Slot][NameLength] == '\0')
+		{
+			return m_Table[Slot];
+		}
+
+		Slot = (Slot + 1) & Mask;
+	}
+
+	//
+	// Names longer than the chunk get a chunk of their own,
+	// the rest of the current chunk is still used.
+	//
+
+	CHAR* Result;
+
+	if (NameLength + 1 > CHUNK_SIZE)
+	{
+		auto Position = m_Chunks.empty() ? m_Chunks.end() : m_Chunks.end() - 1;
+
+		Result = m_Chunks.emplace(Position, new CHAR[NameLength + 1])->get();
+		m_ChunkTotalSize += NameLength + 1;
+	}
+	else
+	{
+		if (m_ChunkUsed + NameLength + 1 > m_ChunkSize)
+		{
+			m_Chunks.emplace_back(new CHAR[CHUNK_SIZE]);
+			m_ChunkSize = CHUNK_SIZE;
+			m_ChunkUsed = 0;
+			m_ChunkTotalSize += CHUNK_SIZE;
+		}
+
+		Result = m_Chunks.back().get() + m_ChunkUsed;
+		m_ChunkUsed += NameLength + 1;
+	}
+
+	memcpy(Result, Name, NameLength);
+	Result[NameLength] = '\0';
+
+	m_Table[Slot] = Result;
+	m_Count++;
+
+	return Result;
+}
+
+CHAR*
+SymbolNameArena::Add(
+	const char* Name
+	)
+{
+	return Add(Name, strlen(Name));
+}
+
+void
+SymbolNameArena::Compact()
+{
+	std::vector<CHAR*>().swap(m_Table);
+	m_Count = 0;
+}
+
+void
+SymbolNameArena::Clear()
+{
+	std::vector<std::unique_ptr<CHAR[]>>().swap(m_Chunks);
+	m_ChunkSize = 0;
+	m_ChunkUsed = 0;
+	m_ChunkTotalSize = 0;
+
+	std::vector<CHAR*>().swap(m_Table);
+	m_Count = 0;
+}
+
+size_t
+SymbolNameArena::GetSize() const
+{
+	return m_ChunkTotalSize + m_Table.size() * sizeof(CHAR*);
+}
+
+size_t
+SymbolNameArena::Hash(
+	const char* Name,
+	size_t NameLength
+	)
+{
+	//
+	// FNV-1a.
+	//
+
+	ULONGLONG Result = 0xCBF29CE484222325ULL;
+
+	for (size_t Index = 0; Index < NameLength; Index++)
+	{
+		Result ^= static_cast<BYTE>(Name[Index]);
+		Result *= 0x100000001B3ULL;
+	}
+
+	return static_cast<size_t>(Result ^ (Result >> 32));
+}
+
+void
+SymbolNameArena::Grow()
+{
+	std::vector<CHAR*> Table((std::max)(m_Table.size() * 2, static_cast<size_t>(1024)), nullptr);
+	size_t Mask = Table.size() - 1;
+
+	for (CHAR* Name : m_Table)
+	{
+		if (Name == nullptr)
+		{
+			continue;
+		}
+
+		size_t Slot = Hash(Name, strlen(Name)) & Mask;
+
+		while (Table[Slot] != nullptr)
+		{
+			Slot = (Slot + 1) & Mask;
+		}
+
+		Table[Slot] = Name;
+	}
+
+	m_Table.swap(Table);
+}
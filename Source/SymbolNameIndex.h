@@ -0,0 +1,212 @@
+#pragma once
+#include <windows.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+typedef struct _SYMBOL SYMBOL, *PSYMBOL;
+
+//
+// Name -> symbol index with front-coded names.
+//
+// Names of C++ types are long and they mostly differ only in their
+// tails (template arguments), the sorted names are therefore stored
+// in blocks of BLOCK_SIZE names, every name keeps only the length
+// of the prefix shared with the previous name and the rest of the name:
+//
+//   block 0   [0]  [39] "std::vector<_FOO,std::allocator<_FOO> >"
+//             [12] [27] "_BAR,std::allocator<_BAR> >"
+//             ...
+//   block 1   [0]  ...
+//
+// Lengths are LEB128-encoded. The first names of the blocks share
+// nothing, the lookup is the binary search through the first names
+// of the blocks followed by the decoding of at most one block.
+//
+// Names inserted after the last Compact() are kept in the hash map
+// until the next Compact().
+//
+class SymbolNameIndex
+{
+	public:
+		SymbolNameIndex() = default;
+
+		//
+		// Inserts or replaces the symbol of the name.
+		//
+		void
+		Insert(
+			const std::string& Name,
+			SYMBOL* Symbol
+			);
+
+		//
+		// Returns nullptr if no symbol has the name.
+		//
+		SYMBOL*
+		Find(
+			const char* Name
+			) const;
+
+		//
+		// Moves the inserted names into the front-coded blocks.
+		//
+		void
+		Compact();
+
+		void
+		Clear();
+
+		size_t
+		GetCount() const;
+
+		//
+		// Size of the front-coded blocks and of the index in bytes.
+		//
+		size_t
+		GetCompactSize() const;
+
+		//
+		// Calls Callback(const std::string& Name, SYMBOL* Symbol)
+		// for every name (front-coded names in the sorted order first).
+		//
+		template <typename TCallback>
+		void
+		ForEach(
+			TCallback Callback
+			) const
+		{
+			std::string Name;
+			const BYTE* Position = m_Data.data();
+
+			for (size_t Index = 0; Index < m_Symbols.size(); Index++)
+			{
+				Position = DecodeEntry(Position, Name);
+
+				Callback(static_cast<const std::string&>(Name), m_Symbols[Index]);
+			}
+
+			for (auto&& e : m_PendingSymbols)
+			{
+				Callback(e.first, e.second);
+			}
+		}
+
+	private:
+		static const size_t BLOCK_SIZE = 16;
+
+		static
+		void
+		WriteLength(
+			std::vector<BYTE>& Data,
+			size_t Length
+			);
+
+		static
+		size_t
+		ReadLength(
+			const BYTE*& Position
+			);
+
+		//
+		// Decodes the entry at the Position, Name holds the previous
+		// name of the block. Returns the position of the next entry.
+		//
+		static
+		const BYTE*
+		DecodeEntry(
+			const BYTE* Position,
+			std::string& Name
+			);
+
+		//
+		// Compares the first name of the block with the Name
+		// (as std::string::compare does).
+		//
+		int
+		CompareBlock(
+			size_t BlockIndex,
+			const char* Name,
+			size_t NameLength
+			) const;
+
+	private:
+		std::vector<BYTE> m_Data;
+		std::vector<DWORD> m_BlockOffsets;
+		std::vector<SYMBOL*> m_Symbols;
+
+		std::unordered_map<std::string, SYMBOL*> m_PendingSymbols;
+};
+
+//
+// Storage of the names of the symbols (SYMBOL::Name, SYMBOL_UDT_FIELD::Name
+// and SYMBOL_ENUM_FIELD::Name).
+//
+// Names are copied once into chunks of CHUNK_SIZE bytes and equal names
+// share one copy (field names like "Flags" or "Reserved" repeat in most
+// of the structures). The open-addressing table holds only the pointers
+// to the copies, it is needed only while the symbols are loaded and
+// Compact() drops it. Names stay valid until Clear().
+//
+class SymbolNameArena
+{
+	public:
+		SymbolNameArena() = default;
+
+		SymbolNameArena(const SymbolNameArena&) = delete;
+		SymbolNameArena& operator=(const SymbolNameArena&) = delete;
+
+		//
+		// Returns the null-terminated copy of the Name.
+		//
+		CHAR*
+		Add(
+			const char* Name,
+			size_t NameLength
+			);
+
+		CHAR*
+		Add(
+			const char* Name
+			);
+
+		//
+		// Drops the table, names added later are not shared
+		// with the names added before.
+		//
+		void
+		Compact();
+
+		void
+		Clear();
+
+		//
+		// Size of the chunks and of the table in bytes.
+		//
+		size_t
+		GetSize() const;
+
+	private:
+		static const size_t CHUNK_SIZE = 64 * 1024;
+
+		static
+		size_t
+		Hash(
+			const char* Name,
+			size_t NameLength
+			);
+
+		void
+		Grow();
+
+	private:
+		std::vector<std::unique_ptr<CHAR[]>> m_Chunks;
+		size_t m_ChunkSize = 0;
+		size_t m_ChunkUsed = 0;
+		size_t m_ChunkTotalSize = 0;
+
+		std::vector<CHAR*> m_Table;
+		size_t m_Count = 0;
+};
@@ -10,6 +10,11 @@ class UdtFieldDefinition
 		struct Settings
 		{
 			bool UseStdInt = false;
+
+			//
+			// Set for ELF files, see PDB::GetBasicTypeString.
+			//
+			bool UsePortableTypes = false;
 		};
 
 		void
@@ -17,27 +22,7 @@ class UdtFieldDefinition
 			const SYMBOL* Symbol
 			) override
 		{
-			//
-			// BaseType:
-			// short/int/long/...
-			//
-
-			if (Symbol->BaseType == btFloat && Symbol->Size == 10)
-			{
-				m_Comment += " /* 80-bit float */";
-			}
-
-			if (Symbol->IsConst)
-			{
-				m_TypePrefix += "const ";
-			}
-
-			if (Symbol->IsVolatile)
-			{
-				m_TypePrefix += "volatile ";
-			}
-
-			m_TypePrefix += PDB::GetBasicTypeString(Symbol, m_Settings->UseStdInt);
+			AppendBaseType(Symbol, m_Settings->UseStdInt);
 		}
 
 		void
@@ -157,6 +142,36 @@ class UdtFieldDefinition
 			return &m_Settings;
 		}
 
+	protected:
+		void
+		AppendBaseType(
+			const SYMBOL* Symbol,
+			bool UseStdInt
+			)
+		{
+			//
+			// BaseType:
+			// short/int/long/...
+			//
+
+			if (Symbol->BaseType == btFloat && Symbol->Size == 10)
+			{
+				m_Comment += " /* 80-bit float */";
+			}
+
+			if (Symbol->IsConst)
+			{
+				m_TypePrefix += "const ";
+			}
+
+			if (Symbol->IsVolatile)
+			{
+				m_TypePrefix += "volatile ";
+			}
+
+			m_TypePrefix += PDB::GetBasicTypeString(Symbol, UseStdInt, m_Settings->UsePortableTypes);
+		}
+
 	private:
 		std::string m_TypePrefix; // "int*"
 		std::string m_MemberName; // "XYZ"
@@ -166,3 +181,21 @@ class UdtFieldDefinition
 		Settings* m_Settings;
 };
 
+//
+// Member definition with UseStdInt fixed at compile time.
+//
+template <
+	bool USE_STDINT
+>
+class UdtFieldDefinitionSpecialized
+	: public UdtFieldDefinition
+{
+	public:
+		void
+		VisitBaseType(
+			const SYMBOL* Symbol
+			) override
+		{
+			AppendBaseType(Symbol, USE_STDINT);
+		}
+};
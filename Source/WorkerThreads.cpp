@@ -0,0 +1,46 @@
+#include "WorkerThreads.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+DWORD
+WorkerThreads::GetCount(
+	DWORD ThreadCount
+	)
+{
+	return ThreadCount
+		? ThreadCount
+		: (std::max)(std::thread::hardware_concurrency(), 1u);
+}
+
+void
+WorkerThreads::RunRanges(
+	size_t Count,
+	DWORD ThreadCount,
+	const std::function<void(DWORD, size_t, size_t)>& Callback
+	)
+{
+	ThreadCount = static_cast<DWORD>((std::min)(static_cast<size_t>(GetCount(ThreadCount)), Count));
+
+	if (ThreadCount <= 1)
+	{
+		Callback(0, 0, Count);
+		return;
+	}
+
+	std::vector<std::thread> Workers;
+
+	for (DWORD i = 0; i < ThreadCount; i++)
+	{
+		size_t Begin = Count * i / ThreadCount;
+		size_t End = Count * (i + 1) / ThreadCount;
+
+		Workers.emplace_back(Callback, i, Begin, End);
+	}
+
+	for (auto&& Worker : Workers)
+	{
+		Worker.join();
+	}
+}
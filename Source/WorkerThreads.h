@@ -0,0 +1,38 @@
+#pragma once
+#include <windows.h>
+
+#include <functional>
+
+//
+// Splits the work between the worker threads.
+//
+
+class WorkerThreads
+{
+	public:
+		//
+		// Returns the count of worker threads,
+		// 0 means count of CPUs.
+		//
+		static
+		DWORD
+		GetCount(
+			DWORD ThreadCount
+			);
+
+		//
+		// Splits [0, Count) into contiguous ranges and calls
+		// Callback(ThreadIndex, Begin, End) for every range on its own
+		// thread. Ranges are ordered by ThreadIndex, there is at most
+		// GetCount(ThreadCount) of them and at least one (even when
+		// the Count is 0). A single range is processed on the calling
+		// thread.
+		//
+		static
+		void
+		RunRanges(
+			size_t Count,
+			DWORD ThreadCount,
+			const std::function<void(DWORD, size_t, size_t)>& Callback
+			);
+};